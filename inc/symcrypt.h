@@ -745,6 +745,30 @@ SymCryptHashResult(
     _Out_writes_( min( cbResult, pHash->resultSize ) )  PBYTE           pbResult,
                                                         SIZE_T          cbResult );
 
+//
+// SymCryptHashBatch
+//
+// Compute the hash of nMessages independent messages; message i is ppbData[i], pcbData[i].
+// The results are written one after the other to pbResult, which must be
+//      nMessages * SymCryptHashResultSize( pHash )
+// bytes long.
+// This is faster than separate SymCryptHash calls when there are many short messages.
+// For MD4, MD5, SHA-1, SHA-256, SHA-384, and SHA-512 each message is padded once in the scratch space
+// and the messages are run through the parallel hash code where it is available.
+// Other hash algorithms use SymCryptHash on each message.
+// The scratch space must be at least SYMCRYPT_HASH_BATCH_SCRATCH bytes; the parts that were used are wiped.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptHashBatch(
+    _In_                                            PCSYMCRYPT_HASH pHash,
+    _In_reads_( nMessages )                         const PCBYTE *  ppbData,
+    _In_reads_( nMessages )                         const SIZE_T *  pcbData,
+                                                    SIZE_T          nMessages,
+    _Out_writes_( nMessages * pHash->resultSize )   PBYTE           pbResult,
+    _Out_writes_( cbScratch )                       PBYTE           pbScratch,
+                                                    SIZE_T          cbScratch );
+
 
 ////////////////////////////////////////////////////////////////////////////
 //   MD2
@@ -1379,6 +1403,45 @@ SymCryptParallelSha512Process(
                                     SIZE_T                              cbScratch ); 
 
 
+//
+// Parallel SHA-1 and MD5 are provided for legacy protocols that still need high-throughput
+// hashing of many independent messages. New designs should not use these algorithms.
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1Init(
+    _Out_writes_( nStates ) PSYMCRYPT_SHA1_STATE   pStates,
+                            SIZE_T                 nStates );
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1Process(
+    _Inout_updates_( nStates )      PSYMCRYPT_SHA1_STATE                pStates,
+                                    SIZE_T                              nStates,
+    _Inout_updates_( nOperations )  PSYMCRYPT_PARALLEL_HASH_OPERATION   pOperations,
+                                    SIZE_T                              nOperations,
+    _Out_writes_( cbScratch )       PBYTE                               pbScratch,
+                                    SIZE_T                              cbScratch ); 
+
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5Init(
+    _Out_writes_( nStates ) PSYMCRYPT_MD5_STATE    pStates,
+                            SIZE_T                 nStates );
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5Process(
+    _Inout_updates_( nStates )      PSYMCRYPT_MD5_STATE                 pStates,
+                                    SIZE_T                              nStates,
+    _Inout_updates_( nOperations )  PSYMCRYPT_PARALLEL_HASH_OPERATION   pOperations,
+                                    SIZE_T                              nOperations,
+    _Out_writes_( cbScratch )       PBYTE                               pbScratch,
+                                    SIZE_T                              cbScratch ); 
+
+
 VOID
 SYMCRYPT_CALL
 SymCryptParallelSha256Selftest();
@@ -1391,6 +1454,110 @@ VOID
 SYMCRYPT_CALL
 SymCryptParallelSha512Selftest();
 
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1Selftest();
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5Selftest();
+
+
+////////////////////////////////////////////////////////////////////////////
+//   Tree hashing with SHA-256
+//
+// A tree hash (Merkle tree) splits the data into leaves of params.cbLeaf bytes; the last leaf
+// can be shorter. Empty data has a single empty leaf.
+// Each leaf is hashed, and then the nodes of each level are grouped, in order, into groups of
+// params.fanOut nodes; the last group of a level can be smaller.
+// A group is hashed to form a node of the next level, except that a group with a single
+// node is promoted to the next level unchanged. This repeats until a level has a single
+// node, which is the root.
+// For fanOut == 2 and non-empty data this is the tree shape of RFC 6962, and with
+// SYMCRYPT_FLAG_TREE_HASH_DOMAIN_PREFIX the root is the RFC 6962 Merkle tree hash of the leaves.
+// Empty data differs: its root is the hash of a single empty leaf, SHA-256( 0x00 ) with the
+// prefix, whereas RFC 6962 defines the hash of an empty tree as SHA-256 of the empty string.
+//
+// If params.flags contains SYMCRYPT_FLAG_TREE_HASH_DOMAIN_PREFIX then a leaf hash is
+// SHA-256( 0x00 || leaf ) and an interior node is SHA-256( 0x01 || child_1 || ... || child_k ).
+// This is the domain separation of RFC 6962 and prevents second-preimage attacks
+// where an interior node is presented as a leaf. Without the flag there is no prefix.
+//
+// The leaves and the nodes of each level are hashed with the parallel SHA-256 code.
+// The caller provides a scratch buffer of SYMCRYPT_SHA256_TREE_HASH_SCRATCH bytes.
+//
+
+#define SYMCRYPT_FLAG_TREE_HASH_DOMAIN_PREFIX   (0x01)
+
+//
+// SymCryptSha256TreeHashLevelsSize
+//
+// Returns the size of the buffer needed by SymCryptSha256TreeHashLevels for cbData bytes of data,
+// or 0 if the parameters are invalid.
+// The parameters are valid if cbLeaf > 0, 2 <= fanOut <= SYMCRYPT_SHA256_TREE_HASH_MAX_FANOUT (65536),
+// and flags has no unknown bits.
+//
+SIZE_T
+SYMCRYPT_CALL
+SymCryptSha256TreeHashLevelsSize(
+    _In_    PCSYMCRYPT_TREE_HASH_PARAMS     pParams,
+            SIZE_T                          cbData );
+
+//
+// SymCryptSha256TreeHashLevels
+//
+// Compute all the nodes of the tree hash of the data.
+// The nodes are written to pbLevels, one level after the other starting with the leaf hashes.
+// Each level lists its nodes in order, including the nodes that were promoted from the level below.
+// The last SYMCRYPT_SHA256_RESULT_SIZE bytes are the root.
+// Each level is hashed through SymCryptParallelSha256Process.
+// Returns SYMCRYPT_INVALID_ARGUMENT if the parameters are invalid, and SYMCRYPT_BUFFER_TOO_SMALL
+// if cbLevels < SymCryptSha256TreeHashLevelsSize( pParams, cbData ).
+//
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptSha256TreeHashLevels(
+    _In_                        PCSYMCRYPT_TREE_HASH_PARAMS     pParams,
+    _In_reads_( cbData )        PCBYTE                          pbData,
+                                SIZE_T                          cbData,
+    _Out_writes_( cbLevels )    PBYTE                           pbLevels,
+                                SIZE_T                          cbLevels,
+    _Out_writes_( cbScratch )   PBYTE                           pbScratch,
+                                SIZE_T                          cbScratch );
+
+//
+// Incremental tree hashing.
+//
+// SymCryptSha256TreeHashInit returns SYMCRYPT_INVALID_ARGUMENT if the parameters are invalid.
+// SymCryptSha256TreeHashAppend hashes the completed leaves in parallel. It returns
+// SYMCRYPT_INVALID_ARGUMENT, without changing the state, if the tree would need more than
+// SYMCRYPT_SHA256_TREE_HASH_MAX_LEVELS levels.
+// SymCryptSha256TreeHashResult returns the root of the tree of all the data appended so far.
+// It does not modify the state; the caller can append more data and ask for the new root.
+// This allows the root of a growing file or log to be updated by hashing only the appended tail.
+// The state is large; callers in kernel mode should not put it on the stack.
+//
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptSha256TreeHashInit(
+    _Out_   PSYMCRYPT_SHA256_TREE_HASH_STATE    pState,
+    _In_    PCSYMCRYPT_TREE_HASH_PARAMS         pParams );
+
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptSha256TreeHashAppend(
+    _Inout_                     PSYMCRYPT_SHA256_TREE_HASH_STATE    pState,
+    _In_reads_( cbData )        PCBYTE                              pbData,
+                                SIZE_T                              cbData,
+    _Out_writes_( cbScratch )   PBYTE                               pbScratch,
+                                SIZE_T                              cbScratch );
+
+VOID
+SYMCRYPT_CALL
+SymCryptSha256TreeHashResult(
+    _In_                                        PCSYMCRYPT_SHA256_TREE_HASH_STATE   pState,
+    _Out_writes_( SYMCRYPT_SHA256_RESULT_SIZE ) PBYTE                               pbResult );
+
 
 
 //==========================================================================
@@ -1909,6 +2076,66 @@ SymCryptHmacSha512Selftest();
 
 extern const PCSYMCRYPT_MAC  SymCryptHmacSha512Algorithm;
 
+////////////////////////////////////////////////////////////////////////////
+//   Parallel HMAC-SHA-256, HMAC-SHA-384, HMAC-SHA-512
+//
+// SymCryptParallelHmacXxx
+//
+// Compute the HMAC of several independent messages.
+// The inner and outer hash computations of all the messages are run through the parallel
+// hash code (SymCryptParallelXxxProcess), starting from the precomputed ipad/opad chaining
+// states in the expanded keys. This is much faster than computing the HMACs one at a time
+// when there are many short messages, such as when verifying tokens or request signatures.
+// Each operation specifies its own expanded key; operations can share a key.
+// The result is the same as calling
+//      for( i=0; i<nOperations; i++ ) {
+//          SymCryptHmacXxx( pOperations[i].pExpandedKey, pOperations[i].pbData, pOperations[i].cbData, pOperations[i].pbResult );
+//      }
+// The result buffers must not overlap any other buffer in the operations.
+//
+// The pbScratch buffer must be at least
+//      SYMCRYPT_PARALLEL_HMAC_XXX_FIXED_SCRATCH + nOperations * SYMCRYPT_PARALLEL_HMAC_XXX_PER_OPERATION_SCRATCH
+// bytes in size.
+// As with the parallel hash functions, the scratch buffer and the result buffers cannot be shared
+// between threads.
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelHmacSha256(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_HMAC_SHA256_OPERATION   pOperations,
+                                SIZE_T                                      nOperations,
+    _Out_writes_( cbScratch )   PBYTE                                       pbScratch,
+                                SIZE_T                                      cbScratch );
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelHmacSha384(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_HMAC_SHA384_OPERATION   pOperations,
+                                SIZE_T                                      nOperations,
+    _Out_writes_( cbScratch )   PBYTE                                       pbScratch,
+                                SIZE_T                                      cbScratch );
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelHmacSha512(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_HMAC_SHA512_OPERATION   pOperations,
+                                SIZE_T                                      nOperations,
+    _Out_writes_( cbScratch )   PBYTE                                       pbScratch,
+                                SIZE_T                                      cbScratch );
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelHmacSha256Selftest();
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelHmacSha384Selftest();
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelHmacSha512Selftest();
+
 ////////////////////////////////////////////////////////////////////////////
 //   AES-CMAC
 //
@@ -1970,6 +2197,29 @@ SymCryptAesCmacResult(
     _Inout_                                         PSYMCRYPT_AES_CMAC_STATE    pState,
     _Out_writes_( SYMCRYPT_AES_CMAC_RESULT_SIZE )   PBYTE                       pbResult );
 
+//
+// SymCryptParallelAesCmac
+//
+// Compute the AES-CMAC of several independent messages.
+// A single CMAC computation is a serial CBC chain, which uses only a fraction of the
+// throughput of the AES hardware. This function interleaves the chains of up to
+// SYMCRYPT_PARALLEL_AES_CMAC_MAX_PARALLELISM messages, which is much faster for
+// the short messages of KDFs and packet authentication.
+// Each operation specifies its own expanded key; operations can share a key, in which
+// case the K1/K2 subkeys are shared too.
+// The result is the same as calling
+//      for( i=0; i<nOperations; i++ ) {
+//          SymCryptAesCmac( pOperations[i].pExpandedKey, pOperations[i].pbData, pOperations[i].cbData, pOperations[i].pbResult );
+//      }
+// The result buffers must not overlap any other buffer in the operations.
+// There is no speed gain with fewer than SYMCRYPT_PARALLEL_AES_CMAC_MIN_PARALLELISM operations.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptParallelAesCmac(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_AES_CMAC_OPERATION  pOperations,
+                                SIZE_T                                  nOperations );
+
 VOID
 SYMCRYPT_CALL
 SymCryptAesCmacSelftest();
@@ -2341,9 +2591,20 @@ SymCryptAesExpandKey(
                         SIZE_T                      cbKey );
 
 //
-// The SymCryptAesExpandKeyEncryptOnly creates an AES-expanded key that can ONLY be used
-// for AES encryption operations. There are no safeguards when you use it for decryption; you get the wrong
-// result if you try.
+// On x86 and AMD64 SymCryptAesExpandKey only computes the encryption round keys.
+// The decryption round keys are created by the first decryption that uses the key, and stored in
+// the expanded key. This is thread-safe; an expanded key can be used by multiple threads
+// at the same time as before.
+// Keys that are only used for encryption (e.g. for GCM, CCM, or CTR mode) never pay for the
+// decryption round keys.
+//
+
+//
+// The SymCryptAesExpandKeyEncryptOnly creates an AES-expanded key that is intended to be used
+// only for AES encryption operations. 
+// On x86 and AMD64 this is the same as SymCryptAesExpandKey.
+// On other CPUs the decryption round keys are created by the first decryption, but that first 
+// decryption must not run concurrently with any other use of the key.
 //
 _Success_(return == SYMCRYPT_NO_ERROR)
 SYMCRYPT_ERROR
@@ -2353,6 +2614,30 @@ SymCryptAesExpandKeyEncryptOnly(
     _In_reads_(cbKey)   PCBYTE                      pbKey,
                         SIZE_T                      cbKey );
 
+//
+// Compact AES keys
+//
+// A SYMCRYPT_AES_COMPACT_EXPANDED_KEY holds only the encryption round keys, and is about
+// half the size of an expanded key. It is intended for servers that keep a very large
+// number of AES keys in memory (e.g. per-session ticket or record keys).
+// A compact key cannot be used directly. SymCryptAesCompactKeyLoad copies it into an 
+// expanded key, which is much cheaper than a full key expansion.
+// The expanded key can be used for both encryption and decryption.
+//
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptAesExpandKeyCompact(
+    _Out_               PSYMCRYPT_AES_COMPACT_EXPANDED_KEY  pCompactKey,
+    _In_reads_(cbKey)   PCBYTE                              pbKey,
+                        SIZE_T                              cbKey );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCompactKeyLoad(
+    _In_    PCSYMCRYPT_AES_COMPACT_EXPANDED_KEY pCompactKey,
+    _Out_   PSYMCRYPT_AES_EXPANDED_KEY          pExpandedKey );
+
 VOID
 SYMCRYPT_CALL
 SymCryptAesKeyCopy( _In_ PCSYMCRYPT_AES_EXPANDED_KEY pSrc, 
@@ -2414,6 +2699,55 @@ SymCryptAesCbcMac(
         _In_reads_( cbData )                        PCBYTE                      pbData,
                                                     SIZE_T                      cbData );
 
+//
+// AES in CFB mode, with the same semantics as SymCryptCfbEncrypt/SymCryptCfbDecrypt on
+// SymCryptAesBlockCipher. cbShift must be 1 (CFB8) or SYMCRYPT_AES_BLOCK_SIZE (CFB128).
+// CFB decryption processes multiple blocks in parallel and is much faster than CFB encryption.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptAesCfbEncrypt(
+        _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+                                                    SIZE_T                      cbShift,
+        _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+        _In_reads_( cbData )                        PCBYTE                      pbSrc,
+        _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                    SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCfbDecrypt(
+        _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+                                                    SIZE_T                      cbShift,
+        _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+        _In_reads_( cbData )                        PCBYTE                      pbSrc,
+        _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                    SIZE_T                      cbData );
+
+//
+// SymCryptParallelAesCbcEncrypt
+//
+// CBC encryption of a message is inherently serial, so a single CBC encryption cannot
+// use the full throughput of the AES hardware.
+// This function encrypts several independent messages, interleaving the CBC chains of up to
+// SYMCRYPT_PARALLEL_AES_CBC_MAX_PARALLELISM messages.
+// Each operation specifies its own key, chaining value, source, destination and length.
+// The result is the same as calling
+//      for( i=0; i<nOperations; i++ ) {
+//          SymCryptAesCbcEncrypt( pOperations[i].pExpandedKey, pOperations[i].pbChainingValue,
+//                                 pOperations[i].pbSrc, pOperations[i].pbDst, pOperations[i].cbData );
+//      }
+// The operations must not overlap, except that an operation's pbSrc and pbDst may be the same buffer.
+// The pOperations array itself is not modified.
+// There is no speed gain with fewer than SYMCRYPT_PARALLEL_AES_CBC_MIN_PARALLELISM operations.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptParallelAesCbcEncrypt(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_AES_CBC_OPERATION   pOperations,
+                                SIZE_T                                  nOperations );
+
+
 VOID
 SYMCRYPT_CALL
 SymCryptAesCtrMsb64( 
@@ -2423,6 +2757,38 @@ SymCryptAesCtrMsb64(
         _Out_writes_( cbData )                      PBYTE                       pbDst,
                                                     SIZE_T                      cbData );
 
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb32( 
+        _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+        _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+        _In_reads_( cbData )                        PCBYTE                      pbSrc,
+        _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                    SIZE_T                      cbData );
+//
+// Same as SymCryptAesCtrMsb64, except that only the last 4 bytes of the pbChainingValue are incremented
+// as a 32-bit MSBfirst integer, which wraps around modulo 2^32. This is the counter increment used by GCM.
+// The wrap-around is handled in constant time, so the counter value may be secret.
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb64Iovec( 
+        _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+        _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+        _In_reads_( nSrc )                          PCSYMCRYPT_IOVEC            pSrc,
+                                                    SIZE_T                      nSrc,
+        _In_reads_( nDst )                          PCSYMCRYPT_IOVEC            pDst,
+                                                    SIZE_T                      nDst );
+//
+// Scatter/gather version of SymCryptAesCtrMsb64.
+// The data is read from the pSrc fragments and written to the pDst fragments. The source and destination
+// lists must have the same total length, which must be a multiple of the block size, but the
+// fragments can have any size. Blocks that straddle fragment boundaries are handled internally,
+// so the result is the same as for the concatenated data.
+// The source and destination lists may describe the same buffers, or non-overlapping buffers.
+//
+
 //
 // There are many optimized implementations for various AES modes.
 // To test them all would pull in all the code for these modes.
@@ -2547,6 +2913,28 @@ SymCrypt3DesDecrypt(
     _In_reads_( SYMCRYPT_3DES_BLOCK_SIZE )  PCBYTE                          pbSrc,
     _Out_writes_( SYMCRYPT_3DES_BLOCK_SIZE )PBYTE                           pbDst );
 
+VOID
+SYMCRYPT_CALL
+SymCrypt3DesEcbEncrypt(
+    _In_                    PCSYMCRYPT_3DES_EXPANDED_KEY    pExpandedKey,
+    _In_reads_( cbData )    PCBYTE                          pbSrc,
+    _Out_writes_( cbData )  PBYTE                           pbDst,
+                            SIZE_T                          cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCrypt3DesEcbDecrypt(
+    _In_                    PCSYMCRYPT_3DES_EXPANDED_KEY    pExpandedKey,
+    _In_reads_( cbData )    PCBYTE                          pbSrc,
+    _Out_writes_( cbData )  PBYTE                           pbDst,
+                            SIZE_T                          cbData );
+//
+// ECB encryption and decryption of multiple blocks.
+// cbData is rounded down to a multiple of the block size.
+// The ECB and CBC decryption functions process several blocks at once, which is significantly
+// faster than one block at a time.
+//
+
 VOID
 SYMCRYPT_CALL
 SymCrypt3DesCbcEncrypt(
@@ -2849,6 +3237,25 @@ SymCryptCtrMsb64(
 //      buffers may be the same or non-overlapping, but may not partially overlap.
 //
 
+VOID
+SYMCRYPT_CALL
+SymCryptCtrMsb32( 
+    _In_                        PCSYMCRYPT_BLOCKCIPHER  pBlockCipher,
+    _In_                        PCVOID                  pExpandedKey,
+    _Inout_updates_( pBlockCipher->blockSize ) 
+                                PBYTE                   pbChainingValue,
+    _In_reads_( cbData )        PCBYTE                  pbSrc,
+    _Out_writes_( cbData )      PBYTE                   pbDst,
+                                SIZE_T                  cbData );
+//
+// This function is the same as SymCryptCtrMsb64, except that the increment function 
+// treats the last 4 bytes of pbChainingValue as a MSBfirst integer, and increments it
+// modulo 2^32. The other bytes of pbChainingValue are never modified.
+// This is the counter function of GCM. The increment does not depend on the counter value
+// in any data-dependent way, so it is safe to use when the counter value is secret, as it
+// is for GCM with nonces that are not 12 bytes long.
+//
+
 
 VOID
 SYMCRYPT_CALL
@@ -2986,6 +3393,80 @@ SymCryptCcmDecrypt(
 // to not reveal the pbDst buffer until this function returns (e.g. through other threads or sharing memory).
 //
 
+VOID
+SYMCRYPT_CALL
+SymCryptCcmEncryptIovec(
+    _In_                            PCSYMCRYPT_BLOCKCIPHER      pBlockCipher,
+    _In_                            PCVOID                      pExpandedKey,
+    _In_reads_( cbNonce )           PCBYTE                      pbNonce,
+                                    SIZE_T                      cbNonce,
+    _In_reads_opt_( cbAuthData )    PCBYTE                      pbAuthData,
+                                    SIZE_T                      cbAuthData,
+    _In_reads_( nSrc )              PCSYMCRYPT_IOVEC            pSrc,
+                                    SIZE_T                      nSrc,
+    _In_reads_( nDst )              PCSYMCRYPT_IOVEC            pDst,
+                                    SIZE_T                      nDst,
+    _Out_writes_( cbTag )           PBYTE                       pbTag,
+                                    SIZE_T                      cbTag );
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptCcmDecryptIovec(
+    _In_                            PCSYMCRYPT_BLOCKCIPHER      pBlockCipher,
+    _In_                            PCVOID                      pExpandedKey,
+    _In_reads_( cbNonce )           PCBYTE                      pbNonce,
+                                    SIZE_T                      cbNonce,
+    _In_reads_opt_( cbAuthData )    PCBYTE                      pbAuthData,
+                                    SIZE_T                      cbAuthData,
+    _In_reads_( nSrc )              PCSYMCRYPT_IOVEC            pSrc,
+                                    SIZE_T                      nSrc,
+    _In_reads_( nDst )              PCSYMCRYPT_IOVEC            pDst,
+                                    SIZE_T                      nDst,
+    _In_reads_( cbTag )             PCBYTE                      pbTag,
+                                    SIZE_T                      cbTag );
+//
+// Scatter/gather versions of SymCryptCcmEncrypt and SymCryptCcmDecrypt.
+// The data length is the total length of the pSrc fragments.
+// See SymCryptGcmEncryptIovec for the rules on the fragment lists.
+// If the decryption fails authentication, all the pDst fragments are wiped.
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptCcmEncryptBatch(
+    _In_                            PCSYMCRYPT_BLOCKCIPHER      pBlockCipher,
+    _In_                            PCVOID                      pExpandedKey,
+    _In_reads_( nRecords )          PCSYMCRYPT_AUTHENC_RECORD   pRecords,
+                                    SIZE_T                      nRecords );
+//
+// Encrypt a batch of independent records with the same key.
+// Each record is encrypted exactly as SymCryptCcmEncrypt would with the record's nonce, 
+// authenticated data, plaintext, ciphertext buffer and tag buffer; see SymCryptCcmEncrypt for
+// the restrictions on each field.
+// The CBC-MAC of a single message is serial; this function runs the CBC-MAC of up to 8 records 
+// side by side so that the block cipher implementation can process them in parallel.
+// The buffers of different records must not overlap.
+//
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptCcmDecryptBatch(
+    _In_                            PCSYMCRYPT_BLOCKCIPHER      pBlockCipher,
+    _In_                            PCVOID                      pExpandedKey,
+    _In_reads_( nRecords )          PCSYMCRYPT_AUTHENC_RECORD   pRecords,
+                                    SIZE_T                      nRecords,
+    _Out_writes_opt_( nRecords )    SYMCRYPT_ERROR *            pResults );
+//
+// Decrypt a batch of independent records with the same key.
+// Each record is decrypted and verified as SymCryptCcmDecrypt would, with pbTag holding the tag to verify.
+// Returns SYMCRYPT_NO_ERROR if all records are authentic, and SYMCRYPT_AUTHENTICATION_FAILURE
+// if one or more records fail the authentication. The pbDst buffer of each failing record is wiped.
+// If pResults is not NULL, pResults[i] receives the result for record i.
+// The same warning about revealing unauthenticated plaintext as for SymCryptCcmDecrypt applies.
+//
+
 //
 // We also provide functions for incremental computation of CCM encryption and decryption. See the functions
 // above for a description of the parameters and restrictions.
@@ -3125,9 +3606,11 @@ SymCryptGcmEncrypt(
 //      - pExpandedKey points to the expanded key for GCM.
 //      - pbNonce: Pointer to the nonce for this encryption. For a single key, each nonce
 //          value may be used at most once to encrypt data. Re-using nonce values leads
-//          to catastrophic loss of security. Only 12-byte nonces are supported,
-//          per the SP800-38D section 5.2.1.1 recommendation.
-//      - cbNonce: number of bytes in the nonce, must be 12.
+//          to catastrophic loss of security. 12-byte nonces are recommended per 
+//          SP800-38D section 5.2.1.1, and are the most efficient.
+//      - cbNonce: number of bytes in the nonce, must be at least 1 and less than 2^61.
+//          Nonces that are not 12 bytes long are hashed with GHASH to form the initial 
+//          counter block, per SP800-38D section 7.1.
 //      - pbAuthData: pointer to the associated authentication data. This data is not encrypted
 //          but it is included in the authentication. Use NULL if not used.
 //      - cbAuthData: # bytes of associated authentication data. (0 if not used)
@@ -3167,6 +3650,129 @@ SymCryptGcmDecrypt(
 // to not reveal the pbDst buffer until this function returns (e.g. through other threads or sharing memory).
 //
 
+VOID
+SYMCRYPT_CALL
+SymCryptGcmEncryptIovec(
+    _In_                            PCSYMCRYPT_GCM_EXPANDED_KEY pExpandedKey,
+    _In_reads_( cbNonce )           PCBYTE                      pbNonce,
+                                    SIZE_T                      cbNonce,
+    _In_reads_opt_( cbAuthData )    PCBYTE                      pbAuthData,
+                                    SIZE_T                      cbAuthData,
+    _In_reads_( nSrc )              PCSYMCRYPT_IOVEC            pSrc,
+                                    SIZE_T                      nSrc,
+    _In_reads_( nDst )              PCSYMCRYPT_IOVEC            pDst,
+                                    SIZE_T                      nDst,
+    _Out_writes_( cbTag )           PBYTE                       pbTag,
+                                    SIZE_T                      cbTag );
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptGcmDecryptIovec(
+    _In_                            PCSYMCRYPT_GCM_EXPANDED_KEY pExpandedKey,
+    _In_reads_( cbNonce )           PCBYTE                      pbNonce,
+                                    SIZE_T                      cbNonce,
+    _In_reads_opt_( cbAuthData )    PCBYTE                      pbAuthData,
+                                    SIZE_T                      cbAuthData,
+    _In_reads_( nSrc )              PCSYMCRYPT_IOVEC            pSrc,
+                                    SIZE_T                      nSrc,
+    _In_reads_( nDst )              PCSYMCRYPT_IOVEC            pDst,
+                                    SIZE_T                      nDst,
+    _In_reads_( cbTag )             PCBYTE                      pbTag,
+                                    SIZE_T                      cbTag );
+//
+// Scatter/gather versions of SymCryptGcmEncrypt and SymCryptGcmDecrypt.
+// The plaintext/ciphertext is read from the pSrc fragments and written to the pDst fragments.
+// The source and destination lists must have the same total length but can be fragmented differently.
+// Fragments can have any size; blocks that straddle fragment boundaries are handled internally so that
+// the bulk of the data is processed by the fast whole-block code.
+// The source and destination lists may describe the same buffers, or non-overlapping buffers.
+// If the decryption fails authentication, all the pDst fragments are wiped.
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptGcmEncryptBatch(
+    _In_                            PCSYMCRYPT_GCM_EXPANDED_KEY pExpandedKey,
+    _In_reads_( nRecords )          PCSYMCRYPT_AUTHENC_RECORD   pRecords,
+                                    SIZE_T                      nRecords );
+//
+// Encrypt a batch of independent records with the same key, as done by a TLS or QUIC record layer.
+// Each record is encrypted exactly as SymCryptGcmEncrypt would with the record's nonce, 
+// authenticated data, plaintext, ciphertext buffer and tag buffer; see SymCryptGcmEncrypt for
+// the restrictions on each field.
+// For short records this is faster than separate calls, as the per-record block cipher work
+// (the tag mask and the data blocks that do not fill a full 8-block chunk) of several records is done together.
+// The buffers of different records must not overlap.
+//
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptGcmDecryptBatch(
+    _In_                            PCSYMCRYPT_GCM_EXPANDED_KEY pExpandedKey,
+    _In_reads_( nRecords )          PCSYMCRYPT_AUTHENC_RECORD   pRecords,
+                                    SIZE_T                      nRecords,
+    _Out_writes_opt_( nRecords )    SYMCRYPT_ERROR *            pResults );
+//
+// Decrypt a batch of independent records with the same key.
+// Each record is decrypted and verified as SymCryptGcmDecrypt would, with pbTag holding the tag to verify.
+// Returns SYMCRYPT_NO_ERROR if all records are authentic, and SYMCRYPT_AUTHENTICATION_FAILURE
+// if one or more records fail the authentication. The pbDst buffer of each failing record is wiped.
+// If pResults is not NULL, pResults[i] receives the result for record i.
+// The same warning about revealing unauthenticated plaintext as for SymCryptGcmDecrypt applies.
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptGcmEncryptParallel(
+    _In_                            PCSYMCRYPT_GCM_EXPANDED_KEY     pExpandedKey,
+    _In_reads_( cbNonce )           PCBYTE                          pbNonce,
+                                    SIZE_T                          cbNonce,
+    _In_reads_opt_( cbAuthData )    PCBYTE                          pbAuthData,
+                                    SIZE_T                          cbAuthData,
+    _In_reads_( cbData )            PCBYTE                          pbSrc,
+    _Out_writes_( cbData )          PBYTE                           pbDst,
+                                    SIZE_T                          cbData,
+    _Out_writes_( cbTag )           PBYTE                           pbTag,
+                                    SIZE_T                          cbTag,
+                                    SIZE_T                          nSegments,
+                                    PSYMCRYPT_DISPATCH_WORK_FUNC    pfnDispatch,
+    _In_opt_                        PVOID                           pDispatchContext );
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptGcmDecryptParallel(
+    _In_                            PCSYMCRYPT_GCM_EXPANDED_KEY     pExpandedKey,
+    _In_reads_( cbNonce )           PCBYTE                          pbNonce,
+                                    SIZE_T                          cbNonce,
+    _In_reads_opt_( cbAuthData )    PCBYTE                          pbAuthData,
+                                    SIZE_T                          cbAuthData,
+    _In_reads_( cbData )            PCBYTE                          pbSrc,
+    _Out_writes_( cbData )          PBYTE                           pbDst,
+                                    SIZE_T                          cbData,
+    _In_reads_( cbTag )             PCBYTE                          pbTag,
+                                    SIZE_T                          cbTag,
+                                    SIZE_T                          nSegments,
+                                    PSYMCRYPT_DISPATCH_WORK_FUNC    pfnDispatch,
+    _In_opt_                        PVOID                           pDispatchContext );
+//
+// Multi-threaded versions of SymCryptGcmEncrypt and SymCryptGcmDecrypt for large buffers.
+// The result is identical to that of SymCryptGcmEncrypt/SymCryptGcmDecrypt.
+// The data is split into at most nSegments segments which are encrypted and authenticated
+// independently, and the GHASH values of the segments are then combined.
+// The library does not create threads; the work items are passed to pfnDispatch which 
+// runs them on threads of the caller's choice, see PSYMCRYPT_DISPATCH_WORK_FUNC.
+// pDispatchContext is passed to pfnDispatch unchanged.
+// - nSegments: typically the number of threads available. It is limited to 
+//      SYMCRYPT_GCM_MAX_PARALLEL_SEGMENTS, and each segment is at least 
+//      SYMCRYPT_GCM_MIN_PARALLEL_SEGMENT_SIZE bytes. If that leaves only one segment 
+//      the work is done on the calling thread and pfnDispatch is not called.
+// The plaintext must not be revealed to other threads before the decryption returns,
+// see SymCryptGcmDecrypt; the worker threads only write to the caller's pbDst buffer.
+//
+
 //
 // We also provide functions for incremental computation of GCM encryption and decryption. See the functions
 // above for a description of the parameters and restrictions.
@@ -3377,11 +3983,153 @@ SymCryptChaCha20Crypt(
 // Any attempt to use the key stream at offset >= 2^38 will result in a fatal error.
 // 
 
+VOID
+SYMCRYPT_CALL
+SymCryptChaCha20CryptIovec(
+    _Inout_                 PSYMCRYPT_CHACHA20_STATE    pState,
+    _In_reads_( nSrc )      PCSYMCRYPT_IOVEC            pSrc,
+                            SIZE_T                      nSrc,
+    _In_reads_( nDst )      PCSYMCRYPT_IOVEC            pDst,
+                            SIZE_T                      nDst );
+//
+// Scatter/gather version of SymCryptChaCha20Crypt, see SymCryptAesCtrMsb64Iovec for the
+// rules on the fragment lists. The data can have any length.
+//
+
 VOID
 SYMCRYPT_CALL
 SymCryptChaCha20Selftest();
 
 
+////////////////////////////////////////////////////////////////////////////
+//   Key stream buffers
+//
+// A key stream buffer holds precomputed key stream for AES-CTR (with a 64-bit counter as in
+// SymCryptAesCtrMsb64) or ChaCha20.
+// For short messages most of the time of an encryption is spent generating the key stream.
+// With a key stream buffer the caller can generate the key stream ahead of time, for example
+// while a connection is idle, and the encryption of the next message only has to xor the
+// data with the buffered key stream.
+//
+// A key stream buffer produces exactly the same key stream as the underlying mode; encrypting
+// a sequence of messages with SymCryptKeystreamBufferCrypt gives the same result as encrypting
+// their concatenation with SymCryptAesCtrMsb64 (or SymCryptChaCha20Crypt), except that the
+// messages need not be a multiple of the block size.
+//
+// The buffer object contains unused key stream and a copy of the key, and callers must
+// wipe it when it is no longer needed. Key stream is wiped from the buffer as it is used.
+// The object contains pointers to itself and must not be moved or copied with memcpy.
+// As the object is updated, two threads cannot use the same buffer at the same time.
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptKeystreamBufferInitAesCtrMsb64(
+    _Out_                                   PSYMCRYPT_KEYSTREAM_BUFFER  pBuffer,
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _In_reads_( SYMCRYPT_AES_BLOCK_SIZE )   PCBYTE                      pbChainingValue );
+//
+// Initialize a key stream buffer for AES-CTR with the specified key and initial counter block.
+// The key is copied into the buffer object. The buffer starts empty.
+//
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptKeystreamBufferInitChaCha20(
+    _Out_                   PSYMCRYPT_KEYSTREAM_BUFFER  pBuffer,
+    _In_reads_( cbKey )     PCBYTE                      pbKey,
+                            SIZE_T                      cbKey,
+    _In_reads_( cbNonce )   PCBYTE                      pbNonce,
+                            SIZE_T                      cbNonce,
+                            UINT64                      offset );
+//
+// Initialize a key stream buffer for ChaCha20. The parameters and error returns are the same
+// as for SymCryptChaCha20Init. The buffer starts empty.
+// Note that the buffer generates key stream ahead of the data; it is a fatal error if the
+// generated key stream would go beyond the 2^38 byte limit of the ChaCha20 key stream.
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptKeystreamBufferRefill(
+    _Inout_ PSYMCRYPT_KEYSTREAM_BUFFER  pBuffer );
+//
+// Fill the buffer with key stream; after this call (nearly) SYMCRYPT_KEYSTREAM_BUFFER_SIZE bytes
+// of key stream are available. Unused key stream in the buffer is kept.
+//
+
+SIZE_T
+SYMCRYPT_CALL
+SymCryptKeystreamBufferAvailable(
+    _In_    PCSYMCRYPT_KEYSTREAM_BUFFER pBuffer );
+//
+// Returns the number of bytes of precomputed key stream in the buffer.
+// Callers can use this to decide when to call SymCryptKeystreamBufferRefill.
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptKeystreamBufferCrypt(
+    _Inout_                 PSYMCRYPT_KEYSTREAM_BUFFER  pBuffer,
+    _In_reads_( cbData )    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )  PBYTE                       pbDst,
+                            SIZE_T                      cbData );
+//
+// Encrypt or decrypt data with the next cbData bytes of key stream.
+// The Src and Dst buffers can be identical or non-overlapping; partial overlaps are not supported.
+// The buffered key stream is used first. When the buffer runs out it is refilled automatically,
+// except that long messages are processed directly without going through the buffer.
+// This function never refills a buffer that still has key stream; call SymCryptKeystreamBufferRefill
+// for that, ideally at a time when latency is not important.
+//
+
+////////////////////////////////////////////////////////////////////////////
+//   QUIC header protection
+//
+// QUIC (RFC 9001) protects packet headers with a 5-byte mask derived from a 16-byte sample of the
+// packet ciphertext. With AES the mask is the first 5 bytes of the AES encryption of the sample;
+// with ChaCha20 the sample provides the block counter and nonce and the mask is the first 5 bytes
+// of that key stream block.
+// Generating the masks one packet at a time is dominated by per-call overhead and by the latency of
+// a single block computation. These functions compute the masks for a batch of packets in one call.
+//
+// The samples are passed as a contiguous array of nSamples * SYMCRYPT_QUIC_HP_SAMPLE_SIZE bytes,
+// and mask i is written to pbMasks[ i * SYMCRYPT_QUIC_HP_MASK_SIZE ].
+//
+
+#define SYMCRYPT_QUIC_HP_SAMPLE_SIZE    (16)
+#define SYMCRYPT_QUIC_HP_MASK_SIZE      (5)
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesQuicHeaderProtectionMasks(
+    _In_                                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _In_reads_( nSamples * SYMCRYPT_QUIC_HP_SAMPLE_SIZE )       PCBYTE                      pbSamples,
+    _Out_writes_( nSamples * SYMCRYPT_QUIC_HP_MASK_SIZE )       PBYTE                       pbMasks,
+                                                                SIZE_T                      nSamples );
+//
+// Compute the AES header protection masks for nSamples samples.
+// The AES-NI code processes 8 samples in parallel.
+//
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptChaCha20QuicHeaderProtectionMasks(
+    _In_reads_( cbKey )                                     PCBYTE  pbKey,
+                                                            SIZE_T  cbKey,
+    _In_reads_( nSamples * SYMCRYPT_QUIC_HP_SAMPLE_SIZE )   PCBYTE  pbSamples,
+    _Out_writes_( nSamples * SYMCRYPT_QUIC_HP_MASK_SIZE )   PBYTE   pbMasks,
+                                                            SIZE_T  nSamples );
+//
+// Compute the ChaCha20 header protection masks for nSamples samples using the 32-byte
+// header protection key.
+// Returns SYMCRYPT_WRONG_KEY_SIZE if cbKey != 32.
+// On x86/x64 CPUs with SSSE3 four samples are processed in parallel.
+//
+
+
 
 
 //==========================================================================
@@ -3447,6 +4195,104 @@ VOID
 SYMCRYPT_CALL
 SymCryptPbkdf2_HmacSha256SelfTest();
 
+//
+// Parallel PBKDF2
+//
+// Each output block of a PBKDF2 derivation is an independent chain of iterationCnt HMAC computations.
+// These functions run the chains of a batch of derivations as lanes of the parallel hash code,
+// which speeds up both multi-block outputs (e.g. a 64-byte key from PBKDF2-HMAC-SHA256) and
+// the checking of many passwords.
+//
+// Each operation specifies the password, salt, iteration count, and result buffer of one
+// PBKDF2 derivation; the result is the same as SymCryptPbkdf2 with the corresponding HMAC algorithm.
+// The operations can have different passwords, salts, iteration counts, and result sizes.
+//
+// The scratch space must be at least SYMCRYPT_PARALLEL_PBKDF2_HMAC_XXX_FIXED_SCRATCH + 
+// nLanes * SYMCRYPT_PARALLEL_PBKDF2_HMAC_XXX_PER_LANE_SCRATCH bytes, for some nLanes >= 1, and the function
+// computes up to nLanes output blocks at the same time. Lanes beyond SYMCRYPT_PARALLEL_PBKDF2_LANES are not used,
+// so SYMCRYPT_PARALLEL_PBKDF2_HMAC_XXX_SCRATCH bytes give the best speed. The scratch space is wiped
+// before the function returns.
+// Returns SYMCRYPT_WRONG_ITERATION_COUNT, without computing anything, if any iteration count is 0.
+//
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptParallelPbkdf2HmacSha1(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_PBKDF2_OPERATION    pOperations,
+                                SIZE_T                                  nOperations,
+    _Out_writes_( cbScratch )   PBYTE                                   pbScratch,
+                                SIZE_T                                  cbScratch );
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptParallelPbkdf2HmacSha256(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_PBKDF2_OPERATION    pOperations,
+                                SIZE_T                                  nOperations,
+    _Out_writes_( cbScratch )   PBYTE                                   pbScratch,
+                                SIZE_T                                  cbScratch );
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptParallelPbkdf2HmacSha512(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_PBKDF2_OPERATION    pOperations,
+                                SIZE_T                                  nOperations,
+    _Out_writes_( cbScratch )   PBYTE                                   pbScratch,
+                                SIZE_T                                  cbScratch );
+
+//
+// Batch password verification.
+// The pbResult/cbResult fields of each operation contain the expected PBKDF2 output; they are only read.
+// Returns SYMCRYPT_NO_ERROR if all derivations match, and SYMCRYPT_AUTHENTICATION_FAILURE if one or more
+// do not. If pResults is not NULL, pResults[i] receives the result for operation i; if any iteration
+// count is 0 all of them receive SYMCRYPT_WRONG_ITERATION_COUNT.
+// The comparison is done in constant time.
+//
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptParallelPbkdf2HmacSha1Verify(
+    _In_reads_( nOperations )       PCSYMCRYPT_PARALLEL_PBKDF2_OPERATION    pOperations,
+                                    SIZE_T                                  nOperations,
+    _Out_writes_opt_( nOperations ) SYMCRYPT_ERROR *                        pResults,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch );
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptParallelPbkdf2HmacSha256Verify(
+    _In_reads_( nOperations )       PCSYMCRYPT_PARALLEL_PBKDF2_OPERATION    pOperations,
+                                    SIZE_T                                  nOperations,
+    _Out_writes_opt_( nOperations ) SYMCRYPT_ERROR *                        pResults,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch );
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptParallelPbkdf2HmacSha512Verify(
+    _In_reads_( nOperations )       PCSYMCRYPT_PARALLEL_PBKDF2_OPERATION    pOperations,
+                                    SIZE_T                                  nOperations,
+    _Out_writes_opt_( nOperations ) SYMCRYPT_ERROR *                        pResults,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch );
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelPbkdf2HmacSha1Selftest();
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelPbkdf2HmacSha256Selftest();
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelPbkdf2HmacSha512Selftest();
+
 ////////////////////////////////////////////////////////////////////////////
 // SP800-108 Counter mode
 //
@@ -3979,6 +4825,37 @@ SymCryptXtsAesDecrypt(
     _Out_writes_( cbData )  PBYTE                           pbDst,
                             SIZE_T                          cbData );           // must be a multiple of cbDataUnit
 
+//
+// Scatter-list versions of the XTS-AES encryption and decryption.
+// Each element of pDataUnits specifies one data unit of cbDataUnit bytes with its own tweak value
+// and its own source and destination buffer. Tweak values do not have to be consecutive.
+// This is equivalent to
+//      for( i=0; i<nDataUnits; i++ ) {
+//          SymCryptXtsAesEncrypt( pExpandedKey, cbDataUnit, pDataUnits[i].tweak, pDataUnits[i].pbSrc, pDataUnits[i].pbDst, cbDataUnit );
+//      }
+// but is faster as blocks from several data units are processed in parallel.
+// The source and destination of a data unit may be the same buffer, but data units must not otherwise overlap.
+// Returns SYMCRYPT_WRONG_DATA_SIZE, without writing any output, if cbDataUnit is not a non-zero
+// multiple of the AES block size.
+//
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptXtsAesEncryptDataUnits(
+    _In_                            PCSYMCRYPT_XTS_AES_EXPANDED_KEY pExpandedKey,
+                                    SIZE_T                          cbDataUnit,         // must be a non-zero multiple of the AES block size.
+    _In_reads_( nDataUnits )        PCSYMCRYPT_XTS_AES_DATA_UNIT    pDataUnits,
+                                    SIZE_T                          nDataUnits );
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptXtsAesDecryptDataUnits(
+    _In_                            PCSYMCRYPT_XTS_AES_EXPANDED_KEY pExpandedKey,
+                                    SIZE_T                          cbDataUnit,         // must be a non-zero multiple of the AES block size.
+    _In_reads_( nDataUnits )        PCSYMCRYPT_XTS_AES_DATA_UNIT    pDataUnits,
+                                    SIZE_T                          nDataUnits );
+
 VOID
 SYMCRYPT_CALL
 SymCryptXtsAesSelftest();
@@ -240,6 +240,9 @@ C_ASSERT( (SYMCRYPT_ALIGN_VALUE & (SYMCRYPT_ALIGN_VALUE - 1 )) == 0 );
 #define SYMCRYPT_CPU_FEATURE_ADX                0x0100          // ADCX, ADOX
 #define SYMCRYPT_CPU_FEATURE_RDRAND             0x0200
 #define SYMCRYPT_CPU_FEATURE_RDSEED             0x0400
+#define SYMCRYPT_CPU_FEATURE_VAES               0x0800          // VAES on YMM registers; ZMM use also requires AVX512
+#define SYMCRYPT_CPU_FEATURE_VPCLMULQDQ         0x1000          // VPCLMULQDQ on YMM registers; ZMM use also requires AVX512
+#define SYMCRYPT_CPU_FEATURE_AVX512             0x2000          // AVX512F, AVX512VL, AVX512BW, AVX512DQ, and OS support for the ZMM state
 
 #endif
 
@@ -648,11 +651,29 @@ typedef SYMCRYPT_ALIGN struct _SYMCRYPT_HASH
 #if SYMCRYPT_CPU_ARM
 #define SYMCRYPT_PARALLEL_SHA256_MIN_PARALLELISM    (3)
 #define SYMCRYPT_PARALLEL_SHA256_MAX_PARALLELISM    (4)
+#elif SYMCRYPT_CPU_AMD64
+#define SYMCRYPT_PARALLEL_SHA256_MIN_PARALLELISM    (2)
+#define SYMCRYPT_PARALLEL_SHA256_MAX_PARALLELISM    (16)
 #else
 #define SYMCRYPT_PARALLEL_SHA256_MIN_PARALLELISM    (2)
 #define SYMCRYPT_PARALLEL_SHA256_MAX_PARALLELISM    (8)
 #endif
 
+//
+// Parallel SHA-1 and MD5 have SSE2 and AVX2 implementations only; other CPUs run the states serially.
+//
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+#define SYMCRYPT_PARALLEL_SHA1_MIN_PARALLELISM      (2)
+#define SYMCRYPT_PARALLEL_SHA1_MAX_PARALLELISM      (8)
+#define SYMCRYPT_PARALLEL_MD5_MIN_PARALLELISM       (2)
+#define SYMCRYPT_PARALLEL_MD5_MAX_PARALLELISM       (8)
+#else
+#define SYMCRYPT_PARALLEL_SHA1_MIN_PARALLELISM      (1)
+#define SYMCRYPT_PARALLEL_SHA1_MAX_PARALLELISM      (1)
+#define SYMCRYPT_PARALLEL_MD5_MIN_PARALLELISM       (1)
+#define SYMCRYPT_PARALLEL_MD5_MAX_PARALLELISM       (1)
+#endif
+
 typedef enum _SYMCRYPT_HASH_OPERATION_TYPE {
     SYMCRYPT_HASH_OPERATION_APPEND = 1,
     SYMCRYPT_HASH_OPERATION_RESULT = 2,
@@ -690,9 +711,12 @@ typedef SYMCRYPT_ALIGN struct _SYMCRYPT_PARALLEL_HASH_SCRATCH_STATE {
 // - an array of SYMCRYPT_PARALLEL_HASH_SCRATCH_STATE structures, aligned to SYMCRYPT_ALIGN_VALUE.
 // - the work array, an array of pointers to SYMCRYPT_PARALLEL_HASH_SCRATCH_STATEs.
 // - an array of 4 + 8 + 64 SIMD vector elements, aligned to the size of those elements.
-// 
+//   (SHA-384 and SHA-512 use 4 + 8 + 80 elements, SHA-1 uses 5 + 80, and MD5 uses 4 + 16.)
+// On AMD64 the elements are ZMM-sized so that the AVX-512 code can use the same scratch layout.
 //
-#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+#if SYMCRYPT_CPU_AMD64
+#define SYMCRYPT_SIMD_ELEMENT_SIZE  64
+#elif SYMCRYPT_CPU_X86
 #define SYMCRYPT_SIMD_ELEMENT_SIZE  32
 #elif SYMCRYPT_CPU_ARM | SYMCRYPT_CPU_ARM64
 #define SYMCRYPT_SIMD_ELEMENT_SIZE  16
@@ -705,8 +729,30 @@ typedef SYMCRYPT_ALIGN struct _SYMCRYPT_PARALLEL_HASH_SCRATCH_STATE {
 #define SYMCRYPT_PARALLEL_SHA256_FIXED_SCRATCH  ( (4 + 8 + 64) * SYMCRYPT_SIMD_ELEMENT_SIZE + SYMCRYPT_SIMD_ELEMENT_SIZE - 1  + SYMCRYPT_ALIGN_VALUE - 1 )
 #define SYMCRYPT_PARALLEL_SHA384_FIXED_SCRATCH  ( (4 + 8 + 80) * SYMCRYPT_SIMD_ELEMENT_SIZE + SYMCRYPT_SIMD_ELEMENT_SIZE - 1  + SYMCRYPT_ALIGN_VALUE - 1 )
 #define SYMCRYPT_PARALLEL_SHA512_FIXED_SCRATCH  ( (4 + 8 + 80) * SYMCRYPT_SIMD_ELEMENT_SIZE + SYMCRYPT_SIMD_ELEMENT_SIZE - 1  + SYMCRYPT_ALIGN_VALUE - 1 )
+#define SYMCRYPT_PARALLEL_SHA1_FIXED_SCRATCH    ( (5 + 80)     * SYMCRYPT_SIMD_ELEMENT_SIZE + SYMCRYPT_SIMD_ELEMENT_SIZE - 1  + SYMCRYPT_ALIGN_VALUE - 1 )
+#define SYMCRYPT_PARALLEL_MD5_FIXED_SCRATCH     ( (4 + 16)     * SYMCRYPT_SIMD_ELEMENT_SIZE + SYMCRYPT_SIMD_ELEMENT_SIZE - 1  + SYMCRYPT_ALIGN_VALUE - 1 )
 #define SYMCRYPT_PARALLEL_HASH_PER_STATE_SCRATCH  (sizeof( SYMCRYPT_PARALLEL_HASH_SCRATCH_STATE ) + sizeof( PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE ) )
 
+//
+// SymCryptHashBatch hashes up to SYMCRYPT_HASH_BATCH_LANES messages at the same time.
+// Each lane has a hash state, a parallel hash scratch state, and the following bookkeeping.
+// The padded tail of a message is at most two blocks of the largest (SHA-512) block size.
+// The fixed scratch is that of SHA-512, the largest of the parallel hash functions.
+//
+#define SYMCRYPT_HASH_BATCH_LANES   (16)
+
+typedef SYMCRYPT_ALIGN struct _SYMCRYPT_HASH_BATCH_LANE {
+    SIZE_T                  iMessage;           // message this lane works on
+    PCBYTE                  pbData;             // whole input blocks of the message that remain to be processed
+    SIZE_T                  cbData;
+    SIZE_T                  cbTail;             // size of the padded tail
+    SIZE_T                  cbTailDone;         // # bytes of the tail already processed
+    SYMCRYPT_ALIGN BYTE     rbTail[2 * 128];    // last partial block of the message followed by the padding
+} SYMCRYPT_HASH_BATCH_LANE, *PSYMCRYPT_HASH_BATCH_LANE;
+
+#define SYMCRYPT_HASH_BATCH_SCRATCH     ( SYMCRYPT_ALIGN_VALUE - 1 + SYMCRYPT_PARALLEL_SHA512_FIXED_SCRATCH + \
+    SYMCRYPT_HASH_BATCH_LANES * ( sizeof( SYMCRYPT_HASH_STATE ) + sizeof( SYMCRYPT_HASH_BATCH_LANE ) + SYMCRYPT_PARALLEL_HASH_PER_STATE_SCRATCH ) )
+
 typedef SYMCRYPT_ALIGN struct _SYMCRYPT_PARALLEL_HASH SYMCRYPT_PARALLEL_HASH, *PSYMCRYPT_PARALLEL_HASH;
 typedef const SYMCRYPT_PARALLEL_HASH  *PCSYMCRYPT_PARALLEL_HASH;
 
@@ -870,6 +916,88 @@ typedef SYMCRYPT_ALIGN struct _SYMCRYPT_HMAC_SHA512_STATE
 typedef const SYMCRYPT_HMAC_SHA512_STATE *PCSYMCRYPT_HMAC_SHA512_STATE;
 
 
+//
+// SYMCRYPT_PARALLEL_HMAC_XXX_OPERATION
+//
+// One message to be processed by SymCryptParallelHmacXxx.
+// The scratch space consists of one hash state and two parallel hash operations per message,
+// followed by the scratch space of the parallel hash function.
+//
+typedef struct _SYMCRYPT_PARALLEL_HMAC_SHA256_OPERATION {
+                                    PCSYMCRYPT_HMAC_SHA256_EXPANDED_KEY pExpandedKey;   // key for this message
+    _Field_size_( cbData )          PCBYTE                              pbData;
+                                    SIZE_T                              cbData;
+    _Field_size_( 32 )              PBYTE                               pbResult;       // SYMCRYPT_HMAC_SHA256_RESULT_SIZE bytes
+} SYMCRYPT_PARALLEL_HMAC_SHA256_OPERATION, *PSYMCRYPT_PARALLEL_HMAC_SHA256_OPERATION;
+typedef const SYMCRYPT_PARALLEL_HMAC_SHA256_OPERATION *PCSYMCRYPT_PARALLEL_HMAC_SHA256_OPERATION;
+
+typedef struct _SYMCRYPT_PARALLEL_HMAC_SHA384_OPERATION {
+                                    PCSYMCRYPT_HMAC_SHA384_EXPANDED_KEY pExpandedKey;
+    _Field_size_( cbData )          PCBYTE                              pbData;
+                                    SIZE_T                              cbData;
+    _Field_size_( 48 )              PBYTE                               pbResult;       // SYMCRYPT_HMAC_SHA384_RESULT_SIZE bytes
+} SYMCRYPT_PARALLEL_HMAC_SHA384_OPERATION, *PSYMCRYPT_PARALLEL_HMAC_SHA384_OPERATION;
+typedef const SYMCRYPT_PARALLEL_HMAC_SHA384_OPERATION *PCSYMCRYPT_PARALLEL_HMAC_SHA384_OPERATION;
+
+typedef struct _SYMCRYPT_PARALLEL_HMAC_SHA512_OPERATION {
+                                    PCSYMCRYPT_HMAC_SHA512_EXPANDED_KEY pExpandedKey;
+    _Field_size_( cbData )          PCBYTE                              pbData;
+                                    SIZE_T                              cbData;
+    _Field_size_( 64 )              PBYTE                               pbResult;       // SYMCRYPT_HMAC_SHA512_RESULT_SIZE bytes
+} SYMCRYPT_PARALLEL_HMAC_SHA512_OPERATION, *PSYMCRYPT_PARALLEL_HMAC_SHA512_OPERATION;
+typedef const SYMCRYPT_PARALLEL_HMAC_SHA512_OPERATION *PCSYMCRYPT_PARALLEL_HMAC_SHA512_OPERATION;
+
+#define SYMCRYPT_PARALLEL_HMAC_SHA256_FIXED_SCRATCH         ( SYMCRYPT_PARALLEL_SHA256_FIXED_SCRATCH + SYMCRYPT_ALIGN_VALUE - 1 )
+#define SYMCRYPT_PARALLEL_HMAC_SHA384_FIXED_SCRATCH         ( SYMCRYPT_PARALLEL_SHA384_FIXED_SCRATCH + SYMCRYPT_ALIGN_VALUE - 1 )
+#define SYMCRYPT_PARALLEL_HMAC_SHA512_FIXED_SCRATCH         ( SYMCRYPT_PARALLEL_SHA512_FIXED_SCRATCH + SYMCRYPT_ALIGN_VALUE - 1 )
+
+#define SYMCRYPT_PARALLEL_HMAC_SHA256_PER_OPERATION_SCRATCH ( sizeof( SYMCRYPT_SHA256_STATE ) + 2 * sizeof( SYMCRYPT_PARALLEL_HASH_OPERATION ) + SYMCRYPT_PARALLEL_HASH_PER_STATE_SCRATCH )
+#define SYMCRYPT_PARALLEL_HMAC_SHA384_PER_OPERATION_SCRATCH ( sizeof( SYMCRYPT_SHA384_STATE ) + 2 * sizeof( SYMCRYPT_PARALLEL_HASH_OPERATION ) + SYMCRYPT_PARALLEL_HASH_PER_STATE_SCRATCH )
+#define SYMCRYPT_PARALLEL_HMAC_SHA512_PER_OPERATION_SCRATCH ( sizeof( SYMCRYPT_SHA512_STATE ) + 2 * sizeof( SYMCRYPT_PARALLEL_HASH_OPERATION ) + SYMCRYPT_PARALLEL_HASH_PER_STATE_SCRATCH )
+
+
+//
+// SYMCRYPT_TREE_HASH_PARAMS, SYMCRYPT_SHA256_TREE_HASH_STATE
+//
+// Tree (Merkle) hashing on top of SHA-256.
+// The state keeps the hash of the current partial leaf, and for each level of the tree
+// the running hash of the node that is being built from the completed nodes of the level below.
+// The first child of each running node is kept so that a node with a single child can be
+// promoted to the next level unchanged.
+//
+#define SYMCRYPT_SHA256_TREE_HASH_MAX_LEVELS    (32)
+#define SYMCRYPT_SHA256_TREE_HASH_MAX_FANOUT    (1 << 16)
+#define SYMCRYPT_SHA256_TREE_HASH_BATCH         (16)    // # nodes hashed per call to the parallel hash code
+
+typedef struct _SYMCRYPT_TREE_HASH_PARAMS {
+    SIZE_T  cbLeaf;         // leaf size in bytes; the last leaf can be shorter
+    UINT32  fanOut;         // maximum number of children of an interior node
+    UINT32  flags;          // SYMCRYPT_FLAG_TREE_HASH_*
+} SYMCRYPT_TREE_HASH_PARAMS, *PSYMCRYPT_TREE_HASH_PARAMS;
+typedef const SYMCRYPT_TREE_HASH_PARAMS * PCSYMCRYPT_TREE_HASH_PARAMS;
+
+typedef SYMCRYPT_ALIGN struct _SYMCRYPT_SHA256_TREE_HASH_LEVEL {
+    SYMCRYPT_SHA256_STATE   node;               // running hash of the node being built
+    BYTE                    firstChild[32];     // SYMCRYPT_SHA256_RESULT_SIZE
+    UINT32                  nChildren;
+} SYMCRYPT_SHA256_TREE_HASH_LEVEL;
+
+typedef SYMCRYPT_ALIGN struct _SYMCRYPT_SHA256_TREE_HASH_STATE {
+    SYMCRYPT_TREE_HASH_PARAMS       params;
+    SYMCRYPT_SHA256_STATE           leaf;           // running hash of the current leaf
+    SIZE_T                          cbLeafData;     // # bytes in the current leaf
+    UINT64                          nLeaves;        // # completed leaves
+    UINT32                          nLevels;        // # levels that have been used
+    SYMCRYPT_SHA256_TREE_HASH_LEVEL level[SYMCRYPT_SHA256_TREE_HASH_MAX_LEVELS];
+    SYMCRYPT_MAGIC_FIELD
+} SYMCRYPT_SHA256_TREE_HASH_STATE, *PSYMCRYPT_SHA256_TREE_HASH_STATE;
+typedef const SYMCRYPT_SHA256_TREE_HASH_STATE * PCSYMCRYPT_SHA256_TREE_HASH_STATE;
+
+#define SYMCRYPT_SHA256_TREE_HASH_SCRATCH   ( SYMCRYPT_ALIGN_VALUE - 1 + \
+                                              SYMCRYPT_SHA256_TREE_HASH_BATCH * ( sizeof( SYMCRYPT_SHA256_STATE ) + 2 * sizeof( SYMCRYPT_PARALLEL_HASH_OPERATION ) + SYMCRYPT_PARALLEL_HASH_PER_STATE_SCRATCH ) + \
+                                              SYMCRYPT_PARALLEL_SHA256_FIXED_SCRATCH )
+
+
 //
 // SYMCRYPT_AES_EXPANDED_KEY
 //
@@ -882,14 +1010,56 @@ typedef SYMCRYPT_ALIGN struct _SYMCRYPT_AES_EXPANDED_KEY {
         // The first decryption round key is the last encryption round key.
         // AES-256 has 14 rounds and thus 15 round keys for encryption and 15
         // for decryption. As they share one round key, we need room for 29.
+        // The decryption round keys are created on first use.
     BYTE   (*lastEncRoundKey)[4][4];    // Pointer to last encryption round key
                                         // also the first round key for decryption
     BYTE   (*lastDecRoundKey)[4][4];    // Pointer to last decryption round key.
+                                        // NULL if the decryption round keys have not been created yet.
     
     SYMCRYPT_MAGIC_FIELD
 } SYMCRYPT_AES_EXPANDED_KEY, *PSYMCRYPT_AES_EXPANDED_KEY;
 typedef const SYMCRYPT_AES_EXPANDED_KEY * PCSYMCRYPT_AES_EXPANDED_KEY;
 
+//
+// SYMCRYPT_AES_COMPACT_EXPANDED_KEY
+//
+// Storage-only form of an AES key with just the encryption round keys.
+// About half the size of SYMCRYPT_AES_EXPANDED_KEY, for callers that keep a very large
+// number of keys in memory.
+// It contains no pointers, but like all SymCrypt structures it carries an address-based
+// magic value in checked builds, so it may not be moved or copied with memcpy.
+//
+typedef SYMCRYPT_ALIGN struct _SYMCRYPT_AES_COMPACT_EXPANDED_KEY {
+    SYMCRYPT_ALIGN BYTE RoundKey[15][4][4];     // Encryption round keys
+    UINT32  nRounds;
+
+    SYMCRYPT_MAGIC_FIELD
+} SYMCRYPT_AES_COMPACT_EXPANDED_KEY, *PSYMCRYPT_AES_COMPACT_EXPANDED_KEY;
+typedef const SYMCRYPT_AES_COMPACT_EXPANDED_KEY * PCSYMCRYPT_AES_COMPACT_EXPANDED_KEY;
+
+//
+// Parallel AES-CBC encryption
+//
+
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+#define SYMCRYPT_PARALLEL_AES_CBC_MIN_PARALLELISM   (2)
+#define SYMCRYPT_PARALLEL_AES_CBC_MAX_PARALLELISM   (8)
+#else
+#define SYMCRYPT_PARALLEL_AES_CBC_MIN_PARALLELISM   (1)
+#define SYMCRYPT_PARALLEL_AES_CBC_MAX_PARALLELISM   (1)
+#endif
+
+typedef struct _SYMCRYPT_PARALLEL_AES_CBC_OPERATION    SYMCRYPT_PARALLEL_AES_CBC_OPERATION, *PSYMCRYPT_PARALLEL_AES_CBC_OPERATION;
+typedef const SYMCRYPT_PARALLEL_AES_CBC_OPERATION *PCSYMCRYPT_PARALLEL_AES_CBC_OPERATION;
+
+struct _SYMCRYPT_PARALLEL_AES_CBC_OPERATION {
+                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey;       // key for this message
+    _Field_size_( 16 )              PBYTE                       pbChainingValue;    // IV on input, updated chaining value on output
+    _Field_size_( cbData )          PCBYTE                      pbSrc;
+    _Field_size_( cbData )          PBYTE                       pbDst;
+                                    SIZE_T                      cbData;             // must be a multiple of the block size
+};
+
 //
 // AES-CMAC
 //
@@ -916,6 +1086,24 @@ typedef SYMCRYPT_ALIGN struct _SYMCRYPT_AES_CMAC_STATE
 } SYMCRYPT_AES_CMAC_STATE, *PSYMCRYPT_AES_CMAC_STATE;
 typedef const SYMCRYPT_AES_CMAC_STATE * PCSYMCRYPT_AES_CMAC_STATE;
 
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+#define SYMCRYPT_PARALLEL_AES_CMAC_MIN_PARALLELISM  (2)
+#define SYMCRYPT_PARALLEL_AES_CMAC_MAX_PARALLELISM  (8)
+#else
+#define SYMCRYPT_PARALLEL_AES_CMAC_MIN_PARALLELISM  (1)
+#define SYMCRYPT_PARALLEL_AES_CMAC_MAX_PARALLELISM  (1)
+#endif
+
+typedef struct _SYMCRYPT_PARALLEL_AES_CMAC_OPERATION   SYMCRYPT_PARALLEL_AES_CMAC_OPERATION, *PSYMCRYPT_PARALLEL_AES_CMAC_OPERATION;
+typedef const SYMCRYPT_PARALLEL_AES_CMAC_OPERATION *PCSYMCRYPT_PARALLEL_AES_CMAC_OPERATION;
+
+struct _SYMCRYPT_PARALLEL_AES_CMAC_OPERATION {
+                                    PCSYMCRYPT_AES_CMAC_EXPANDED_KEY    pExpandedKey;   // key for this message
+    _Field_size_( cbData )          PCBYTE                              pbData;
+                                    SIZE_T                              cbData;
+    _Field_size_( 16 )              PBYTE                               pbResult;       // SYMCRYPT_AES_CMAC_RESULT_SIZE bytes
+};
+
 //
 // POLY1305
 //
@@ -942,6 +1130,18 @@ typedef SYMCRYPT_ALIGN struct _SYMCRYPT_XTS_AES_EXPANDED_KEY
 } SYMCRYPT_XTS_AES_EXPANDED_KEY, *PSYMCRYPT_XTS_AES_EXPANDED_KEY;
 typedef const SYMCRYPT_XTS_AES_EXPANDED_KEY * PCSYMCRYPT_XTS_AES_EXPANDED_KEY;
 
+//
+// One data unit (e.g. a disk sector) of a scatter-list XTS-AES request.
+// The size of the data unit is passed separately and is the same for all units of a request.
+//
+typedef struct _SYMCRYPT_XTS_AES_DATA_UNIT
+{
+    UINT64  tweak;          // Tweak value of this data unit (e.g. the sector number)
+    PCBYTE  pbSrc;
+    PBYTE   pbDst;
+} SYMCRYPT_XTS_AES_DATA_UNIT, *PSYMCRYPT_XTS_AES_DATA_UNIT;
+typedef const SYMCRYPT_XTS_AES_DATA_UNIT * PCSYMCRYPT_XTS_AES_DATA_UNIT;
+
 
 //-----------------------------------------------------------------
 //     Mac description table
@@ -1145,6 +1345,47 @@ typedef SYMCRYPT_ALIGN struct _SYMCRYPT_GCM_STATE {
 } SYMCRYPT_GCM_STATE, * PSYMCRYPT_GCM_STATE;
 typedef const SYMCRYPT_GCM_STATE * PCSYMCRYPT_GCM_STATE;
 
+//
+// Buffer fragment for the scatter/gather (iovec) functions.
+// Source fragments are only read.
+//
+typedef struct _SYMCRYPT_IOVEC {
+    _Field_size_( cb )  PBYTE       pb;
+                        SIZE_T      cb;
+} SYMCRYPT_IOVEC, *PSYMCRYPT_IOVEC;
+typedef const SYMCRYPT_IOVEC * PCSYMCRYPT_IOVEC;
+
+//
+// Record descriptor for the batched GCM and CCM functions.
+// For encryption pbTag receives the tag, for decryption it holds the tag to verify.
+//
+typedef struct _SYMCRYPT_AUTHENC_RECORD     SYMCRYPT_AUTHENC_RECORD, *PSYMCRYPT_AUTHENC_RECORD;
+typedef const SYMCRYPT_AUTHENC_RECORD *PCSYMCRYPT_AUTHENC_RECORD;
+
+struct _SYMCRYPT_AUTHENC_RECORD {
+    _Field_size_( cbNonce )         PCBYTE      pbNonce;
+                                    SIZE_T      cbNonce;
+    _Field_size_opt_( cbAuthData )  PCBYTE      pbAuthData;
+                                    SIZE_T      cbAuthData;
+    _Field_size_( cbData )          PCBYTE      pbSrc;
+    _Field_size_( cbData )          PBYTE       pbDst;
+                                    SIZE_T      cbData;
+    _Field_size_( cbTag )           PBYTE       pbTag;
+                                    SIZE_T      cbTag;
+};
+
+//
+// Work dispatch callback for the multi-threaded functions.
+// The library splits the work into nWorkItems independent items. The dispatch function has to call
+// pfnWorkItem( ppWorkItems[i] ) exactly once for each i, in any order and on any thread,
+// and return only when all of these calls have completed.
+//
+typedef VOID (SYMCRYPT_CALL * PSYMCRYPT_WORK_ITEM_FUNC)( PVOID pWorkItem );
+typedef VOID (SYMCRYPT_CALL * PSYMCRYPT_DISPATCH_WORK_FUNC)( PVOID pDispatchContext, PSYMCRYPT_WORK_ITEM_FUNC pfnWorkItem, PVOID * ppWorkItems, SIZE_T nWorkItems );
+
+#define SYMCRYPT_GCM_MAX_PARALLEL_SEGMENTS      (16)
+#define SYMCRYPT_GCM_MIN_PARALLEL_SEGMENT_SIZE  (1 << 16)
+
 
 //
 // Block ciphers
@@ -1157,7 +1398,9 @@ typedef VOID( SYMCRYPT_CALL * PSYMCRYPT_BLOCKCIPHER_CRYPT )     (PCVOID pExpande
 typedef VOID( SYMCRYPT_CALL * PSYMCRYPT_BLOCKCIPHER_CRYPT_ECB ) (PCVOID pExpandedKey, PCBYTE pbSrc, PBYTE pbDst, SIZE_T cbData);
 typedef VOID( SYMCRYPT_CALL * PSYMCRYPT_BLOCKCIPHER_CRYPT_MODE )(PCVOID pExpandedKey, PBYTE pbChainingValue, PCBYTE pbSrc, PBYTE pbDst, SIZE_T cbData);
 typedef VOID( SYMCRYPT_CALL * PSYMCRYPT_BLOCKCIPHER_MAC_MODE )  (PCVOID pExpandedKey, PBYTE pbChainingValue, PCBYTE pbSrc, SIZE_T cbData);
+typedef VOID( SYMCRYPT_CALL * PSYMCRYPT_BLOCKCIPHER_CRYPT_CFB ) (PCVOID pExpandedKey, SIZE_T cbShift, PBYTE pbChainingValue, PCBYTE pbSrc, PBYTE pbDst, SIZE_T cbData);
 typedef VOID( SYMCRYPT_CALL * PSYMCRYPT_BLOCKCIPHER_CRYPT_XTS ) (PCVOID pExpandedKey, PBYTE pbTweakBlock, PCBYTE pbSrc, PBYTE pbDst, SIZE_T cbData);
+typedef VOID( SYMCRYPT_CALL * PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE ) (PVOID pState, PCBYTE pbSrc, PBYTE pbDst, SIZE_T cbData);
 
 struct _SYMCRYPT_BLOCKCIPHER {
                                                 PSYMCRYPT_BLOCKCIPHER_EXPAND_KEY    expandKeyFunc;      // mandatory
@@ -1169,8 +1412,15 @@ struct _SYMCRYPT_BLOCKCIPHER {
                                                 PSYMCRYPT_BLOCKCIPHER_CRYPT_MODE    cbcDecryptFunc;     // NULL if no optimized version available
                                                 PSYMCRYPT_BLOCKCIPHER_MAC_MODE      cbcMacFunc;         // NULL if no optimized version available
                                                 PSYMCRYPT_BLOCKCIPHER_CRYPT_MODE    ctrMsb64Func;       // NULL if no optimized version available
+                                                PSYMCRYPT_BLOCKCIPHER_CRYPT_MODE    ctrMsb32Func;       // NULL if no optimized version available
+                                                PSYMCRYPT_BLOCKCIPHER_CRYPT_CFB     cfbEncryptFunc;     // NULL if no optimized version available
+                                                PSYMCRYPT_BLOCKCIPHER_CRYPT_CFB     cfbDecryptFunc;     // NULL if no optimized version available
                                                 PSYMCRYPT_BLOCKCIPHER_CRYPT_XTS     xtsEncFunc;
                                                 PSYMCRYPT_BLOCKCIPHER_CRYPT_XTS     xtsDecFunc;
+                                                PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE gcmEncryptPartFunc; // NULL if no optimized version available
+                                                PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE gcmDecryptPartFunc; // NULL if no optimized version available
+                                                PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE ccmEncryptPartFunc; // NULL if no optimized version available
+                                                PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE ccmDecryptPartFunc; // NULL if no optimized version available
     _Field_range_( 0, SYMCRYPT_MAX_BLOCK_SIZE ) SIZE_T                              blockSize;          // = SYMCRYPT_XXX_BLOCK_SIZE, power of 2, value <= 32.
                                                 SIZE_T                              expandedKeySize;    // = sizeof( SYMCRYPT_XXX_EXPANDED_KEY )
 };
@@ -1211,6 +1461,33 @@ typedef SYMCRYPT_ALIGN struct _SYMCRYPT_CHACHA20_STATE {
 } SYMCRYPT_CHACHA20_STATE, *PSYMCRYPT_CHACHA20_STATE;
 
 
+//
+// Key stream buffer
+//
+// Holds precomputed AES-CTR or ChaCha20 key stream.
+// buffer[iStart..iEnd-1] is the unused key stream; the AES counter block or ChaCha20 offset
+// in the source corresponds to the key stream position at iEnd.
+//
+
+#define SYMCRYPT_KEYSTREAM_BUFFER_SIZE      (1024)
+
+typedef SYMCRYPT_ALIGN struct _SYMCRYPT_KEYSTREAM_BUFFER {
+    SYMCRYPT_ALIGN BYTE buffer[SYMCRYPT_KEYSTREAM_BUFFER_SIZE];
+    SIZE_T              iStart;
+    SIZE_T              iEnd;
+    UINT32              type;
+    union {
+        struct {
+            SYMCRYPT_AES_EXPANDED_KEY   key;
+            BYTE                        counterBlock[16];   // SYMCRYPT_AES_BLOCK_SIZE is not yet defined
+        } aesCtr;
+        SYMCRYPT_CHACHA20_STATE         chaCha20;
+    } source;
+    SYMCRYPT_MAGIC_FIELD
+} SYMCRYPT_KEYSTREAM_BUFFER, *PSYMCRYPT_KEYSTREAM_BUFFER;
+typedef const SYMCRYPT_KEYSTREAM_BUFFER * PCSYMCRYPT_KEYSTREAM_BUFFER;
+
+
 //
 // AES_CTR_DRBG 
 //
@@ -1284,6 +1561,55 @@ typedef struct _SYMCRYPT_PBKDF2_EXPANDED_KEY {
 } SYMCRYPT_PBKDF2_EXPANDED_KEY, *PSYMCRYPT_PBKDF2_EXPANDED_KEY;
 typedef const SYMCRYPT_PBKDF2_EXPANDED_KEY *PCSYMCRYPT_PBKDF2_EXPANDED_KEY;
 
+//
+// SYMCRYPT_PARALLEL_PBKDF2_OPERATION
+//
+// One PBKDF2 derivation in a batch of parallel PBKDF2 derivations or verifications.
+//
+typedef struct _SYMCRYPT_PARALLEL_PBKDF2_OPERATION {
+    PCBYTE  pbPassword;
+    SIZE_T  cbPassword;
+    PCBYTE  pbSalt;
+    SIZE_T  cbSalt;
+    UINT64  iterationCnt;
+    PBYTE   pbResult;
+    SIZE_T  cbResult;
+} SYMCRYPT_PARALLEL_PBKDF2_OPERATION, *PSYMCRYPT_PARALLEL_PBKDF2_OPERATION;
+typedef const SYMCRYPT_PARALLEL_PBKDF2_OPERATION *PCSYMCRYPT_PARALLEL_PBKDF2_OPERATION;
+
+//
+// The parallel PBKDF2 code computes up to SYMCRYPT_PARALLEL_PBKDF2_LANES output blocks at the same time.
+// Each lane has a hash state whose buffer holds the pre-padded message block, an HMAC expanded key,
+// and the following bookkeeping.
+//
+#define SYMCRYPT_PARALLEL_PBKDF2_LANES      (16)
+
+typedef SYMCRYPT_ALIGN struct _SYMCRYPT_PARALLEL_PBKDF2_LANE {
+    SIZE_T  iOperation;             // operation this lane works on
+    SIZE_T  cbOffset;               // offset of the lane's output block in pbResult
+    UINT64  iterationsLeft;         // 0 if the lane is idle
+    BYTE    rbBlockResult[64];      // XOR of the U values so far; SYMCRYPT_HASH_MAX_RESULT_SIZE
+} SYMCRYPT_PARALLEL_PBKDF2_LANE, *PSYMCRYPT_PARALLEL_PBKDF2_LANE;
+
+#define SYMCRYPT_PARALLEL_PBKDF2_PER_LANE_SCRATCH( _hashState, _hmacKey ) \
+    ( sizeof( _hashState ) + sizeof( _hmacKey ) + sizeof( SYMCRYPT_PARALLEL_PBKDF2_LANE ) + \
+      sizeof( SYMCRYPT_PARALLEL_HASH_SCRATCH_STATE ) + sizeof( PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE ) )
+
+#define SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA1_FIXED_SCRATCH       ( SYMCRYPT_ALIGN_VALUE - 1 + SYMCRYPT_PARALLEL_SHA1_FIXED_SCRATCH )
+#define SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA256_FIXED_SCRATCH     ( SYMCRYPT_ALIGN_VALUE - 1 + SYMCRYPT_PARALLEL_SHA256_FIXED_SCRATCH )
+#define SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA512_FIXED_SCRATCH     ( SYMCRYPT_ALIGN_VALUE - 1 + SYMCRYPT_PARALLEL_SHA512_FIXED_SCRATCH )
+
+#define SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA1_PER_LANE_SCRATCH    SYMCRYPT_PARALLEL_PBKDF2_PER_LANE_SCRATCH( SYMCRYPT_SHA1_STATE, SYMCRYPT_HMAC_SHA1_EXPANDED_KEY )
+#define SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA256_PER_LANE_SCRATCH  SYMCRYPT_PARALLEL_PBKDF2_PER_LANE_SCRATCH( SYMCRYPT_SHA256_STATE, SYMCRYPT_HMAC_SHA256_EXPANDED_KEY )
+#define SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA512_PER_LANE_SCRATCH  SYMCRYPT_PARALLEL_PBKDF2_PER_LANE_SCRATCH( SYMCRYPT_SHA512_STATE, SYMCRYPT_HMAC_SHA512_EXPANDED_KEY )
+
+#define SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA1_SCRATCH      ( SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA1_FIXED_SCRATCH + \
+    SYMCRYPT_PARALLEL_PBKDF2_LANES * SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA1_PER_LANE_SCRATCH )
+#define SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA256_SCRATCH    ( SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA256_FIXED_SCRATCH + \
+    SYMCRYPT_PARALLEL_PBKDF2_LANES * SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA256_PER_LANE_SCRATCH )
+#define SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA512_SCRATCH    ( SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA512_FIXED_SCRATCH + \
+    SYMCRYPT_PARALLEL_PBKDF2_LANES * SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA512_PER_LANE_SCRATCH )
+
 //
 // SP 800-108
 //
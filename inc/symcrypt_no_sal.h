@@ -40,6 +40,7 @@
 #define _Inout_updates_opt_(x)
 
 #define _Field_size_(x)
+#define _Field_size_opt_(x)
 #define _Field_range_(x,y)
 
 #define _Ret_range_(x,y)
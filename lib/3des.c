@@ -36,22 +36,30 @@
 //
 // Tables to describe the DES and 3DES block ciphers so that the generic
 // chaining mode functions can use them.
-// We have no optimized mode-specific code as the DES block is so slow that there is
-// very little to be gained.
+// 3DES has multi-block ECB and CBC decryption code that processes several blocks at once;
+// the other modes are inherently serial and use the generic code.
+// DES is only provided for compatibility and uses the generic code for all modes.
 //
 
 const SYMCRYPT_BLOCKCIPHER SymCrypt3DesBlockCipher_default = {
     SymCrypt3DesExpandKey,  // PSYMCRYPT_BLOCKCIPHER_EXPAND_KEY    expandKeyFunc;
     SymCrypt3DesEncrypt,    // PSYMCRYPT_BLOCKCIPHER_CRYPT         encryptFunc;
     SymCrypt3DesDecrypt,    // PSYMCRYPT_BLOCKCIPHER_CRYPT         decryptFunc;
-    NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_ECB     ecbEncryptFunc;
-    NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_ECB     ecbDecryptFunc;
+    SymCrypt3DesEcbEncrypt, // PSYMCRYPT_BLOCKCIPHER_CRYPT_ECB     ecbEncryptFunc;
+    SymCrypt3DesEcbDecrypt, // PSYMCRYPT_BLOCKCIPHER_CRYPT_ECB     ecbDecryptFunc;
     NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_MODE    cbcEncryptFunc;
-    NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_MODE    cbcDecryptFunc; 
+    SymCrypt3DesCbcDecryptMultiBlock,   // PSYMCRYPT_BLOCKCIPHER_CRYPT_MODE    cbcDecryptFunc; 
     NULL,                   // PSYMCRYPT_BLOCKCIPHER_MAC_MODE      cbcMacFunc;
     NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_MODE    ctrMsbFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_MODE    ctrMsb32Func;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_CFB     cfbEncryptFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_CFB     cfbDecryptFunc;
     NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_XTS     xtsEncFunc;
     NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_XTS     xtsDecFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE gcmEncryptPartFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE gcmDecryptPartFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE ccmEncryptPartFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE ccmDecryptPartFunc;
     8,                      // SIZE_T                              blockSize;
     sizeof( SYMCRYPT_3DES_EXPANDED_KEY ), // SIZE_T  expandedKeySize;    // = sizeof( SYMCRYPT_XXX_EXPANDED_KEY )
 };
@@ -66,8 +74,15 @@ const SYMCRYPT_BLOCKCIPHER SymCryptDesBlockCipher_default = {
     NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_MODE    cbcDecryptFunc; 
     NULL,                   // PSYMCRYPT_BLOCKCIPHER_MAC_MODE      cbcMacFunc;
     NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_MODE    ctrMsbFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_MODE    ctrMsb32Func;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_CFB     cfbEncryptFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_CFB     cfbDecryptFunc;
     NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_XTS     xtsEncFunc;
     NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_XTS     xtsDecFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE gcmEncryptPartFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE gcmDecryptPartFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE ccmEncryptPartFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE ccmDecryptPartFunc;
     8,                      // SIZE_T                              blockSize;
     sizeof( SYMCRYPT_DES_EXPANDED_KEY ), // SIZE_T  expandedKeySize;    // = sizeof( SYMCRYPT_XXX_EXPANDED_KEY )
 };
@@ -573,6 +588,256 @@ SymCrypt3DesDecrypt(
 }
 
 
+//
+// Multi-block 3DES
+//
+// A single DES round is a chain of dependent table lookups, so the single-block code is
+// limited by the latency of the round function rather than by the throughput of the CPU.
+// For ECB and CBC decryption the blocks are independent, and we process 4 blocks at a time
+// with the lookups of the blocks interleaved. This keeps more loads in flight per round.
+//
+// The initial and final permutations are the same as in SymCrypt3DesEncrypt.
+//
+#define DES_IP( L, R, T ) { \
+    R = ROL32(R, 4);                    \
+    T = (L ^ R) & 0xf0f0f0f0; L ^= T; R ^= T; \
+    L = ROL32(L, 20);                   \
+    T = (L ^ R) & 0xfff0000f; L ^= T; R ^= T; \
+    L = ROL32(L, 14);                   \
+    T = (L ^ R) & 0x33333333; L ^= T; R ^= T; \
+    R = ROL32(R, 22);                   \
+    T = (L ^ R) & 0x03fc03fc; L ^= T; R ^= T; \
+    R = ROL32(R, 9);                    \
+    T = (L ^ R) & 0xaaaaaaaa; L ^= T; R ^= T; \
+    L = ROL32(L, 1); }
+
+#define DES_FP( L, R, T ) { \
+    R = ROR32(R, 1);                    \
+    T = (L ^ R) & 0xaaaaaaaa; L ^= T; R ^= T; \
+    L = ROR32(L, 9);                    \
+    T = (L ^ R) & 0x03fc03fc; L ^= T; R ^= T; \
+    L = ROR32(L, 22);                   \
+    T = (L ^ R) & 0x33333333; L ^= T; R ^= T; \
+    R = ROR32(R, 14);                   \
+    T = (L ^ R) & 0xfff0000f; L ^= T; R ^= T; \
+    R = ROR32(R, 20);                   \
+    T = (L ^ R) & 0xf0f0f0f0; L ^= T; R ^= T; \
+    L = ROR32(L, 4); }
+
+#define DES_SPBOX( i, T, s )    (*(UINT32 *)((PBYTE)SymCryptDesSpbox[i] + (((T) >> (s)) & 0xfc)))
+
+//
+// The DES round function F on two blocks at once; the lookups of the two blocks alternate.
+//
+#define F2( L0, R0, L1, R1, keyptr ) { \
+    Ta0 = keyptr[0] ^ R0; \
+    Ta1 = keyptr[0] ^ R1; \
+    Tb0 = keyptr[1] ^ R0; \
+    Tb1 = keyptr[1] ^ R1; \
+    Tb0 = ROR32(Tb0, 4); \
+    Tb1 = ROR32(Tb1, 4); \
+    L0 ^= DES_SPBOX( 0, Ta0,  0 ); L1 ^= DES_SPBOX( 0, Ta1,  0 ); \
+    L0 ^= DES_SPBOX( 1, Tb0,  0 ); L1 ^= DES_SPBOX( 1, Tb1,  0 ); \
+    L0 ^= DES_SPBOX( 2, Ta0,  8 ); L1 ^= DES_SPBOX( 2, Ta1,  8 ); \
+    L0 ^= DES_SPBOX( 3, Tb0,  8 ); L1 ^= DES_SPBOX( 3, Tb1,  8 ); \
+    L0 ^= DES_SPBOX( 4, Ta0, 16 ); L1 ^= DES_SPBOX( 4, Ta1, 16 ); \
+    L0 ^= DES_SPBOX( 5, Tb0, 16 ); L1 ^= DES_SPBOX( 5, Tb1, 16 ); \
+    L0 ^= DES_SPBOX( 6, Ta0, 24 ); L1 ^= DES_SPBOX( 6, Ta1, 24 ); \
+    L0 ^= DES_SPBOX( 7, Tb0, 24 ); L1 ^= DES_SPBOX( 7, Tb1, 24 ); }
+
+#define SYMCRYPT_3DES_PARALLEL_BLOCKS   (4)
+
+//
+// Encrypt or decrypt 4 blocks.
+// Encryption is E(k0) D(k1) E(k2) and decryption is D(k2) E(k1) D(k0). Both have the same
+// structure of 3 times 16 rounds where the roles of the two halves swap between the DES operations;
+// they only differ in the order in which the round keys are used.
+//
+static
+VOID
+SYMCRYPT_CALL
+SymCrypt3DesCryptParallel(
+    _In_                                                                    PCSYMCRYPT_3DES_EXPANDED_KEY    pExpandedKey,
+                                                                            BOOLEAN                         bEncrypt,
+    _In_reads_( SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE )  PCBYTE                          pbSrc,
+    _Out_writes_( SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE )PBYTE                           pbDst )
+{
+    UINT32  L0, R0, L1, R1, L2, R2, L3, R3;
+    UINT32  Ta0, Tb0, Ta1, Tb1;
+    UINT32  T;
+    const UINT32 (*pRoundKeys)[2];
+    int     step;
+    int     i;
+    int     r;
+
+    R0 = SYMCRYPT_LOAD_LSBFIRST32( pbSrc      ); L0 = SYMCRYPT_LOAD_LSBFIRST32( pbSrc +  4 );
+    R1 = SYMCRYPT_LOAD_LSBFIRST32( pbSrc +  8 ); L1 = SYMCRYPT_LOAD_LSBFIRST32( pbSrc + 12 );
+    R2 = SYMCRYPT_LOAD_LSBFIRST32( pbSrc + 16 ); L2 = SYMCRYPT_LOAD_LSBFIRST32( pbSrc + 20 );
+    R3 = SYMCRYPT_LOAD_LSBFIRST32( pbSrc + 24 ); L3 = SYMCRYPT_LOAD_LSBFIRST32( pbSrc + 28 );
+
+    DES_IP( L0, R0, T );
+    DES_IP( L1, R1, T );
+    DES_IP( L2, R2, T );
+    DES_IP( L3, R3, T );
+
+    for( i=0; i<3; i++ )
+    {
+        //
+        // Select the key and the direction of this DES operation.
+        // pRoundKeys points to the first round key used, and step is the distance to the next one.
+        //
+        if( (i == 1) ? !bEncrypt : bEncrypt )
+        {
+            pRoundKeys = &pExpandedKey->roundKey[ bEncrypt ? i : 2 - i ][0];
+            step = 1;
+        } else {
+            pRoundKeys = &pExpandedKey->roundKey[ bEncrypt ? i : 2 - i ][15];
+            step = -1;
+        }
+
+        for( r=0; r<16; r += 2 )
+        {
+            F2( L0, R0, L1, R1, pRoundKeys[0] );
+            F2( L2, R2, L3, R3, pRoundKeys[0] );
+            pRoundKeys += step;
+            F2( R0, L0, R1, L1, pRoundKeys[0] );
+            F2( R2, L2, R3, L3, pRoundKeys[0] );
+            pRoundKeys += step;
+        }
+
+        if( i < 2 )
+        {
+            //
+            // The next DES operation starts with the halves in swapped roles.
+            //
+            T = L0; L0 = R0; R0 = T;
+            T = L1; L1 = R1; R1 = T;
+            T = L2; L2 = R2; R2 = T;
+            T = L3; L3 = R3; R3 = T;
+        }
+    }
+
+    DES_FP( L0, R0, T );
+    DES_FP( L1, R1, T );
+    DES_FP( L2, R2, T );
+    DES_FP( L3, R3, T );
+
+    SYMCRYPT_STORE_LSBFIRST32( pbDst     , L0 ); SYMCRYPT_STORE_LSBFIRST32( pbDst +  4, R0 );
+    SYMCRYPT_STORE_LSBFIRST32( pbDst +  8, L1 ); SYMCRYPT_STORE_LSBFIRST32( pbDst + 12, R1 );
+    SYMCRYPT_STORE_LSBFIRST32( pbDst + 16, L2 ); SYMCRYPT_STORE_LSBFIRST32( pbDst + 20, R2 );
+    SYMCRYPT_STORE_LSBFIRST32( pbDst + 24, L3 ); SYMCRYPT_STORE_LSBFIRST32( pbDst + 28, R3 );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCrypt3DesEcbEncrypt(
+    _In_                    PCSYMCRYPT_3DES_EXPANDED_KEY    pExpandedKey,
+    _In_reads_( cbData )    PCBYTE                          pbSrc,
+    _Out_writes_( cbData )  PBYTE                           pbDst,
+                            SIZE_T                          cbData )
+{
+    SYMCRYPT_CHECK_MAGIC( pExpandedKey );
+
+    while( cbData >= SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE )
+    {
+        SymCrypt3DesCryptParallel( pExpandedKey, TRUE, pbSrc, pbDst );
+        pbSrc += SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE;
+        pbDst += SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE;
+        cbData -= SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE;
+    }
+
+    while( cbData >= SYMCRYPT_3DES_BLOCK_SIZE )
+    {
+        SymCrypt3DesEncrypt( pExpandedKey, pbSrc, pbDst );
+        pbSrc += SYMCRYPT_3DES_BLOCK_SIZE;
+        pbDst += SYMCRYPT_3DES_BLOCK_SIZE;
+        cbData -= SYMCRYPT_3DES_BLOCK_SIZE;
+    }
+}
+
+VOID
+SYMCRYPT_CALL
+SymCrypt3DesEcbDecrypt(
+    _In_                    PCSYMCRYPT_3DES_EXPANDED_KEY    pExpandedKey,
+    _In_reads_( cbData )    PCBYTE                          pbSrc,
+    _Out_writes_( cbData )  PBYTE                           pbDst,
+                            SIZE_T                          cbData )
+{
+    SYMCRYPT_CHECK_MAGIC( pExpandedKey );
+
+    while( cbData >= SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE )
+    {
+        SymCrypt3DesCryptParallel( pExpandedKey, FALSE, pbSrc, pbDst );
+        pbSrc += SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE;
+        pbDst += SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE;
+        cbData -= SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE;
+    }
+
+    while( cbData >= SYMCRYPT_3DES_BLOCK_SIZE )
+    {
+        SymCrypt3DesDecrypt( pExpandedKey, pbSrc, pbDst );
+        pbSrc += SYMCRYPT_3DES_BLOCK_SIZE;
+        pbDst += SYMCRYPT_3DES_BLOCK_SIZE;
+        cbData -= SYMCRYPT_3DES_BLOCK_SIZE;
+    }
+}
+//
+// CBC decryption, 4 blocks at a time where possible.
+// This is the cbcDecryptFunc of the 3DES block cipher, so SymCrypt3DesCbcDecrypt also uses it.
+//
+VOID
+SYMCRYPT_CALL
+SymCrypt3DesCbcDecryptMultiBlock(
+    _In_                                        PCSYMCRYPT_3DES_EXPANDED_KEY    pExpandedKey,
+    _Inout_updates_( SYMCRYPT_3DES_BLOCK_SIZE ) PBYTE                           pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                          pbSrc,
+    _Out_writes_( cbData )                      PBYTE                           pbDst,
+                                                SIZE_T                          cbData )
+{
+    SYMCRYPT_ALIGN BYTE buf[SYMCRYPT_3DES_BLOCK_SIZE + 2 * SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE];
+    PBYTE   chain = &buf[0];                                // directly followed by the ciphertext
+    PBYTE   ciphertext = &buf[SYMCRYPT_3DES_BLOCK_SIZE];
+    PBYTE   plaintext = &buf[SYMCRYPT_3DES_BLOCK_SIZE + SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE];
+    SIZE_T  cbChunk;
+
+    SYMCRYPT_CHECK_MAGIC( pExpandedKey );
+
+    cbData &= ~(SIZE_T)(SYMCRYPT_3DES_BLOCK_SIZE - 1);
+
+    memcpy( chain, pbChainingValue, SYMCRYPT_3DES_BLOCK_SIZE );
+
+    //
+    // We copy the ciphertext before decrypting to obey the read-once/write-once rule
+    // and to support in-place decryption.
+    // As the chaining value is stored just before the ciphertext, the value to xor into
+    // each decrypted block is found at the same offset from chain.
+    //
+    while( cbData > 0 )
+    {
+        if( cbData >= SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE )
+        {
+            cbChunk = SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE;
+            memcpy( ciphertext, pbSrc, cbChunk );
+            SymCrypt3DesCryptParallel( pExpandedKey, FALSE, ciphertext, plaintext );
+        } else {
+            cbChunk = SYMCRYPT_3DES_BLOCK_SIZE;
+            memcpy( ciphertext, pbSrc, cbChunk );
+            SymCrypt3DesDecrypt( pExpandedKey, ciphertext, plaintext );
+        }
+
+        SymCryptXorBytes( plaintext, chain, pbDst, cbChunk );
+        memcpy( chain, &ciphertext[cbChunk - SYMCRYPT_3DES_BLOCK_SIZE], SYMCRYPT_3DES_BLOCK_SIZE );
+
+        pbSrc += cbChunk;
+        pbDst += cbChunk;
+        cbData -= cbChunk;
+    }
+
+    memcpy( pbChainingValue, chain, SYMCRYPT_3DES_BLOCK_SIZE );
+
+    SymCryptWipeKnownSize( buf, sizeof( buf ) );
+}
+
 
 VOID
 SYMCRYPT_CALL
@@ -658,7 +923,10 @@ SYMCRYPT_CALL
 SymCrypt3DesSelftest()
 {
     BYTE                        buf[SYMCRYPT_3DES_BLOCK_SIZE];
+    BYTE                        bufPar[SYMCRYPT_3DES_PARALLEL_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE];
+    BYTE                        blocks[(SYMCRYPT_3DES_PARALLEL_BLOCKS + 1) * SYMCRYPT_3DES_BLOCK_SIZE];
     SYMCRYPT_3DES_EXPANDED_KEY  key;
+    SIZE_T                      i;
 
     if( SymCrypt3DesExpandKey( &key, SP800_67Key, 24 ) != SYMCRYPT_NO_ERROR )
     {
@@ -682,6 +950,36 @@ SymCrypt3DesSelftest()
     {
         SymCryptFatal( 'des5' );
     }
+
+    //
+    // The multi-block code is a separate implementation of the block cipher, test it too.
+    // Each lane gets a different block: block i+1 is the single-block encryption of block i,
+    // starting from the known plaintext whose encryption was verified above.
+    // A parallel encryption of blocks 0..3 must then produce blocks 1..4.
+    //
+    memcpy( &blocks[0], des3KnownPlaintext, SYMCRYPT_3DES_BLOCK_SIZE );
+    for( i=0; i<SYMCRYPT_3DES_PARALLEL_BLOCKS; i++ )
+    {
+        SymCrypt3DesEncrypt( &key, &blocks[i * SYMCRYPT_3DES_BLOCK_SIZE], &blocks[(i + 1) * SYMCRYPT_3DES_BLOCK_SIZE] );
+    }
+
+    SymCrypt3DesEcbEncrypt( &key, &blocks[0], bufPar, sizeof( bufPar ) );
+
+    SymCryptInjectError( bufPar, sizeof( bufPar ) );
+
+    if( memcmp( bufPar, &blocks[SYMCRYPT_3DES_BLOCK_SIZE], sizeof( bufPar ) ) != 0 )
+    {
+        SymCryptFatal( 'des6' );
+    }
+
+    SymCrypt3DesEcbDecrypt( &key, &blocks[SYMCRYPT_3DES_BLOCK_SIZE], bufPar, sizeof( bufPar ) );
+
+    SymCryptInjectError( bufPar, sizeof( bufPar ) );
+
+    if( memcmp( bufPar, &blocks[0], sizeof( bufPar ) ) != 0 )
+    {
+        SymCryptFatal( 'des7' );
+    }
 }
 
 
@@ -0,0 +1,708 @@
+//
+// aes-bitslice.c   Bitsliced AES implementation
+//
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+// Constant-time multi-block AES for CPUs without AES-NI.
+//
+// The T-table code in aes-c.c and aes-asm.c uses key- and data-dependent table lookups,
+// which leak through the cache, and it processes only one block at a time.
+// This code processes 8 blocks at a time in bitsliced form, using the representation of
+// Kaesper and Schwabe, "Faster and Timing-Attack Resistant AES-GCM" (CHES 2009), and the S-box
+// circuit of Boyar and Peralta.
+//
+// The state of 8 blocks is held in 8 XMM registers. Register k holds bit k of every state byte;
+// byte j of the register holds bit k of byte j of each of the 8 blocks, one block per bit.
+// The byte positions are the same as in a normal AES state, so ShiftRows and the row rotations
+// in MixColumns are byte shuffles (PSHUFB), and the S-box is a circuit of logical operations.
+// Converting to and from the bitsliced form is an 8x8 bit matrix transpose at each byte position.
+//
+// There are no memory accesses that depend on the key or the data.
+//
+// Only the encryption round keys of the expanded key are used; decryption uses the
+// straightforward inverse cipher rather than the equivalent inverse cipher.
+// The round keys are converted to the bitsliced form once per call.
+//
+
+#include "precomp.h"
+
+#if SYMCRYPT_CPU_AMD64
+
+#define BS_XOR( a, b )      _mm_xor_si128( (a), (b) )
+#define BS_XOR3( a, b, c )  BS_XOR( BS_XOR( a, b ), c )
+#define BS_AND( a, b )      _mm_and_si128( (a), (b) )
+#define BS_OR( a, b )       _mm_or_si128( (a), (b) )
+
+//
+// Exchange the bits selected by cl in y with the bits selected by ch in x; s is the distance between them.
+//
+#define BS_SWAPN( cl, ch, s, x, y ) \
+{ \
+    __m128i _a = (x); \
+    __m128i _b = (y); \
+    (x) = BS_OR( BS_AND( _a, cl ), _mm_slli_epi64( BS_AND( _b, cl ), s ) ); \
+    (y) = BS_OR( _mm_srli_epi64( BS_AND( _a, ch ), s ), BS_AND( _b, ch ) ); \
+}
+
+//
+// Transpose the 8x8 bit matrix at each byte position of the 8 registers.
+// This converts 8 blocks to the bitsliced form and back; the transform is its own inverse.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceTranspose( _Inout_updates_( 8 ) __m128i * q )
+{
+    const __m128i m1l = _mm_set1_epi8( 0x55 );
+    const __m128i m1h = _mm_set1_epi8( (char) 0xaa );
+    const __m128i m2l = _mm_set1_epi8( 0x33 );
+    const __m128i m2h = _mm_set1_epi8( (char) 0xcc );
+    const __m128i m4l = _mm_set1_epi8( 0x0f );
+    const __m128i m4h = _mm_set1_epi8( (char) 0xf0 );
+
+    BS_SWAPN( m1l, m1h, 1, q[0], q[1] );
+    BS_SWAPN( m1l, m1h, 1, q[2], q[3] );
+    BS_SWAPN( m1l, m1h, 1, q[4], q[5] );
+    BS_SWAPN( m1l, m1h, 1, q[6], q[7] );
+
+    BS_SWAPN( m2l, m2h, 2, q[0], q[2] );
+    BS_SWAPN( m2l, m2h, 2, q[1], q[3] );
+    BS_SWAPN( m2l, m2h, 2, q[4], q[6] );
+    BS_SWAPN( m2l, m2h, 2, q[5], q[7] );
+
+    BS_SWAPN( m4l, m4h, 4, q[0], q[4] );
+    BS_SWAPN( m4l, m4h, 4, q[1], q[5] );
+    BS_SWAPN( m4l, m4h, 4, q[2], q[6] );
+    BS_SWAPN( m4l, m4h, 4, q[3], q[7] );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceLoad(
+    _Out_writes_( 8 )                                                       __m128i *   q,
+    _In_reads_( SYMCRYPT_AES_BITSLICE_BLOCKS * SYMCRYPT_AES_BLOCK_SIZE )    PCBYTE      pbSrc )
+{
+    int i;
+
+    for( i=0; i<SYMCRYPT_AES_BITSLICE_BLOCKS; i++ )
+    {
+        q[i] = _mm_loadu_si128( (__m128i *) (pbSrc + i * SYMCRYPT_AES_BLOCK_SIZE) );
+    }
+
+    SymCryptAesBitsliceTranspose( q );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceStore(
+    _Inout_updates_( 8 )                                                    __m128i *   q,
+    _Out_writes_( SYMCRYPT_AES_BITSLICE_BLOCKS * SYMCRYPT_AES_BLOCK_SIZE )  PBYTE       pbDst )
+{
+    int i;
+
+    SymCryptAesBitsliceTranspose( q );
+
+    for( i=0; i<SYMCRYPT_AES_BITSLICE_BLOCKS; i++ )
+    {
+        _mm_storeu_si128( (__m128i *) (pbDst + i * SYMCRYPT_AES_BLOCK_SIZE), q[i] );
+    }
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceExpandKey(
+    _In_    PCSYMCRYPT_AES_EXPANDED_KEY     pExpandedKey,
+    _Out_   PSYMCRYPT_AES_BITSLICE_KEY      pBitsliceKey )
+{
+    __m128i rk;
+    __m128i bit;
+    SIZE_T  r;
+    int     i;
+
+    pBitsliceKey->nRounds = pExpandedKey->lastEncRoundKey - &pExpandedKey->RoundKey[0];
+
+    for( r=0; r<=pBitsliceKey->nRounds; r++ )
+    {
+        //
+        // The same round key is used for all blocks, so each byte of the bitsliced round key
+        // is either all zeroes or all ones.
+        //
+        rk = _mm_loadu_si128( (__m128i *) &pExpandedKey->RoundKey[r][0][0] );
+        for( i=0; i<8; i++ )
+        {
+            bit = _mm_set1_epi8( (char) (1 << i) );
+            pBitsliceKey->roundKey[r][i] = _mm_cmpeq_epi8( BS_AND( rk, bit ), bit );
+        }
+    }
+}
+
+//
+// The AES S-box as a circuit of 113 gates, computed on all bytes in parallel.
+// q[7] holds the most significant bit of each byte.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceSbox( _Inout_updates_( 8 ) __m128i * q )
+{
+    const __m128i ones = _mm_set1_epi32( -1 );
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7;
+    __m128i y1, y2, y3, y4, y5, y6, y7, y8, y9;
+    __m128i y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+    __m128i y20, y21;
+    __m128i z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+    __m128i z10, z11, z12, z13, z14, z15, z16, z17;
+    __m128i t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    __m128i t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    __m128i t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    __m128i t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    __m128i t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+    __m128i t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+    __m128i t60, t61, t62, t63, t64, t65, t66, t67;
+    __m128i s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7];
+    x1 = q[6];
+    x2 = q[5];
+    x3 = q[4];
+    x4 = q[3];
+    x5 = q[2];
+    x6 = q[1];
+    x7 = q[0];
+
+    //
+    // Top linear transformation
+    //
+    y14 = BS_XOR( x3, x5 );
+    y13 = BS_XOR( x0, x6 );
+    y9  = BS_XOR( x0, x3 );
+    y8  = BS_XOR( x0, x5 );
+    t0  = BS_XOR( x1, x2 );
+    y1  = BS_XOR( t0, x7 );
+    y4  = BS_XOR( y1, x3 );
+    y12 = BS_XOR( y13, y14 );
+    y2  = BS_XOR( y1, x0 );
+    y5  = BS_XOR( y1, x6 );
+    y3  = BS_XOR( y5, y8 );
+    t1  = BS_XOR( x4, y12 );
+    y15 = BS_XOR( t1, x5 );
+    y20 = BS_XOR( t1, x1 );
+    y6  = BS_XOR( y15, x7 );
+    y10 = BS_XOR( y15, t0 );
+    y11 = BS_XOR( y20, y9 );
+    y7  = BS_XOR( x7, y11 );
+    y17 = BS_XOR( y10, y11 );
+    y19 = BS_XOR( y10, y8 );
+    y16 = BS_XOR( t0, y11 );
+    y21 = BS_XOR( y13, y16 );
+    y18 = BS_XOR( x0, y16 );
+
+    //
+    // Non-linear section
+    //
+    t2  = BS_AND( y12, y15 );
+    t3  = BS_AND( y3, y6 );
+    t4  = BS_XOR( t3, t2 );
+    t5  = BS_AND( y4, x7 );
+    t6  = BS_XOR( t5, t2 );
+    t7  = BS_AND( y13, y16 );
+    t8  = BS_AND( y5, y1 );
+    t9  = BS_XOR( t8, t7 );
+    t10 = BS_AND( y2, y7 );
+    t11 = BS_XOR( t10, t7 );
+    t12 = BS_AND( y9, y11 );
+    t13 = BS_AND( y14, y17 );
+    t14 = BS_XOR( t13, t12 );
+    t15 = BS_AND( y8, y10 );
+    t16 = BS_XOR( t15, t12 );
+    t17 = BS_XOR( t4, t14 );
+    t18 = BS_XOR( t6, t16 );
+    t19 = BS_XOR( t9, t14 );
+    t20 = BS_XOR( t11, t16 );
+    t21 = BS_XOR( t17, y20 );
+    t22 = BS_XOR( t18, y19 );
+    t23 = BS_XOR( t19, y21 );
+    t24 = BS_XOR( t20, y18 );
+
+    t25 = BS_XOR( t21, t22 );
+    t26 = BS_AND( t21, t23 );
+    t27 = BS_XOR( t24, t26 );
+    t28 = BS_AND( t25, t27 );
+    t29 = BS_XOR( t28, t22 );
+    t30 = BS_XOR( t23, t24 );
+    t31 = BS_XOR( t22, t26 );
+    t32 = BS_AND( t31, t30 );
+    t33 = BS_XOR( t32, t24 );
+    t34 = BS_XOR( t23, t33 );
+    t35 = BS_XOR( t27, t33 );
+    t36 = BS_AND( t24, t35 );
+    t37 = BS_XOR( t36, t34 );
+    t38 = BS_XOR( t27, t36 );
+    t39 = BS_AND( t29, t38 );
+    t40 = BS_XOR( t25, t39 );
+
+    t41 = BS_XOR( t40, t37 );
+    t42 = BS_XOR( t29, t33 );
+    t43 = BS_XOR( t29, t40 );
+    t44 = BS_XOR( t33, t37 );
+    t45 = BS_XOR( t42, t41 );
+    z0  = BS_AND( t44, y15 );
+    z1  = BS_AND( t37, y6 );
+    z2  = BS_AND( t33, x7 );
+    z3  = BS_AND( t43, y16 );
+    z4  = BS_AND( t40, y1 );
+    z5  = BS_AND( t29, y7 );
+    z6  = BS_AND( t42, y11 );
+    z7  = BS_AND( t45, y17 );
+    z8  = BS_AND( t41, y10 );
+    z9  = BS_AND( t44, y12 );
+    z10 = BS_AND( t37, y3 );
+    z11 = BS_AND( t33, y4 );
+    z12 = BS_AND( t43, y13 );
+    z13 = BS_AND( t40, y5 );
+    z14 = BS_AND( t29, y2 );
+    z15 = BS_AND( t42, y9 );
+    z16 = BS_AND( t45, y14 );
+    z17 = BS_AND( t41, y8 );
+
+    //
+    // Bottom linear transformation
+    //
+    t46 = BS_XOR( z15, z16 );
+    t47 = BS_XOR( z10, z11 );
+    t48 = BS_XOR( z5, z13 );
+    t49 = BS_XOR( z9, z10 );
+    t50 = BS_XOR( z2, z12 );
+    t51 = BS_XOR( z2, z5 );
+    t52 = BS_XOR( z7, z8 );
+    t53 = BS_XOR( z0, z3 );
+    t54 = BS_XOR( z6, z7 );
+    t55 = BS_XOR( z16, z17 );
+    t56 = BS_XOR( z12, t48 );
+    t57 = BS_XOR( t50, t53 );
+    t58 = BS_XOR( z4, t46 );
+    t59 = BS_XOR( z3, t54 );
+    t60 = BS_XOR( t46, t57 );
+    t61 = BS_XOR( z14, t57 );
+    t62 = BS_XOR( t52, t58 );
+    t63 = BS_XOR( t49, t58 );
+    t64 = BS_XOR( z4, t59 );
+    t65 = BS_XOR( t61, t62 );
+    t66 = BS_XOR( z1, t63 );
+    s0  = BS_XOR( t59, t63 );
+    s6  = BS_XOR( BS_XOR( t56, t62 ), ones );
+    s7  = BS_XOR( BS_XOR( t48, t60 ), ones );
+    t67 = BS_XOR( t64, t65 );
+    s3  = BS_XOR( t53, t66 );
+    s4  = BS_XOR( t51, t66 );
+    s5  = BS_XOR( t47, t65 );
+    s1  = BS_XOR( BS_XOR( t64, s3 ), ones );
+    s2  = BS_XOR( BS_XOR( t55, t67 ), ones );
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+//
+// The inverse S-box is the forward S-box surrounded by the inverse of its affine transform.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceInvAffine( _Inout_updates_( 8 ) __m128i * q )
+{
+    const __m128i ones = _mm_set1_epi32( -1 );
+    __m128i q0, q1, q2, q3, q4, q5, q6, q7;
+
+    q0 = BS_XOR( q[0], ones );
+    q1 = BS_XOR( q[1], ones );
+    q2 = q[2];
+    q3 = q[3];
+    q4 = q[4];
+    q5 = BS_XOR( q[5], ones );
+    q6 = BS_XOR( q[6], ones );
+    q7 = q[7];
+
+    q[7] = BS_XOR( BS_XOR( q1, q4 ), q6 );
+    q[6] = BS_XOR( BS_XOR( q0, q3 ), q5 );
+    q[5] = BS_XOR( BS_XOR( q7, q2 ), q4 );
+    q[4] = BS_XOR( BS_XOR( q6, q1 ), q3 );
+    q[3] = BS_XOR( BS_XOR( q5, q0 ), q2 );
+    q[2] = BS_XOR( BS_XOR( q4, q7 ), q1 );
+    q[1] = BS_XOR( BS_XOR( q3, q6 ), q0 );
+    q[0] = BS_XOR( BS_XOR( q2, q5 ), q7 );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceInvSbox( _Inout_updates_( 8 ) __m128i * q )
+{
+    SymCryptAesBitsliceInvAffine( q );
+    SymCryptAesBitsliceSbox( q );
+    SymCryptAesBitsliceInvAffine( q );
+}
+
+//
+// ShiftRows, and the rotation of each column by one and two rows, are byte shuffles.
+//
+#define BS_SHUFFLE( x, c )  _mm_shuffle_epi8( (x), (c) )
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceShiftRows(
+    _Inout_updates_( 8 )    __m128i *   q,
+                            __m128i     shuffle )
+{
+    int i;
+
+    for( i=0; i<8; i++ )
+    {
+        q[i] = BS_SHUFFLE( q[i], shuffle );
+    }
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceMixColumns( _Inout_updates_( 8 ) __m128i * q )
+{
+    const __m128i rot1 = _mm_setr_epi8( 1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12 );
+    const __m128i rot2 = _mm_setr_epi8( 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13 );
+    __m128i q0, q1, q2, q3, q4, q5, q6, q7;
+    __m128i r0, r1, r2, r3, r4, r5, r6, r7;
+
+    q0 = q[0]; q1 = q[1]; q2 = q[2]; q3 = q[3];
+    q4 = q[4]; q5 = q[5]; q6 = q[6]; q7 = q[7];
+
+    r0 = BS_SHUFFLE( q0, rot1 ); r1 = BS_SHUFFLE( q1, rot1 ); r2 = BS_SHUFFLE( q2, rot1 ); r3 = BS_SHUFFLE( q3, rot1 );
+    r4 = BS_SHUFFLE( q4, rot1 ); r5 = BS_SHUFFLE( q5, rot1 ); r6 = BS_SHUFFLE( q6, rot1 ); r7 = BS_SHUFFLE( q7, rot1 );
+
+    q[0] = BS_XOR3( BS_XOR( q7, r7 ), r0, BS_SHUFFLE( BS_XOR( q0, r0 ), rot2 ) );
+    q[1] = BS_XOR3( BS_XOR3( q0, r0, q7 ), BS_XOR( r7, r1 ), BS_SHUFFLE( BS_XOR( q1, r1 ), rot2 ) );
+    q[2] = BS_XOR3( BS_XOR( q1, r1 ), r2, BS_SHUFFLE( BS_XOR( q2, r2 ), rot2 ) );
+    q[3] = BS_XOR3( BS_XOR3( q2, r2, q7 ), BS_XOR( r7, r3 ), BS_SHUFFLE( BS_XOR( q3, r3 ), rot2 ) );
+    q[4] = BS_XOR3( BS_XOR3( q3, r3, q7 ), BS_XOR( r7, r4 ), BS_SHUFFLE( BS_XOR( q4, r4 ), rot2 ) );
+    q[5] = BS_XOR3( BS_XOR( q4, r4 ), r5, BS_SHUFFLE( BS_XOR( q5, r5 ), rot2 ) );
+    q[6] = BS_XOR3( BS_XOR( q5, r5 ), r6, BS_SHUFFLE( BS_XOR( q6, r6 ), rot2 ) );
+    q[7] = BS_XOR3( BS_XOR( q6, r6 ), r7, BS_SHUFFLE( BS_XOR( q7, r7 ), rot2 ) );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceInvMixColumns( _Inout_updates_( 8 ) __m128i * q )
+{
+    const __m128i rot1 = _mm_setr_epi8( 1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12 );
+    const __m128i rot2 = _mm_setr_epi8( 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13 );
+    __m128i q0, q1, q2, q3, q4, q5, q6, q7;
+    __m128i r0, r1, r2, r3, r4, r5, r6, r7;
+
+    q0 = q[0]; q1 = q[1]; q2 = q[2]; q3 = q[3];
+    q4 = q[4]; q5 = q[5]; q6 = q[6]; q7 = q[7];
+
+    r0 = BS_SHUFFLE( q0, rot1 ); r1 = BS_SHUFFLE( q1, rot1 ); r2 = BS_SHUFFLE( q2, rot1 ); r3 = BS_SHUFFLE( q3, rot1 );
+    r4 = BS_SHUFFLE( q4, rot1 ); r5 = BS_SHUFFLE( q5, rot1 ); r6 = BS_SHUFFLE( q6, rot1 ); r7 = BS_SHUFFLE( q7, rot1 );
+
+    q[0] = BS_XOR(  BS_XOR( BS_XOR3( q5, q6, q7 ), BS_XOR3( r0, r5, r7 ) ),
+                    BS_SHUFFLE( BS_XOR( BS_XOR3( q0, q5, q6 ), BS_XOR( r0, r5 ) ), rot2 ) );
+    q[1] = BS_XOR(  BS_XOR3( BS_XOR3( q0, q5, r0 ), BS_XOR3( r1, r5, r6 ), r7 ),
+                    BS_SHUFFLE( BS_XOR( BS_XOR3( q1, q5, q7 ), BS_XOR3( r1, r5, r6 ) ), rot2 ) );
+    q[2] = BS_XOR(  BS_XOR3( BS_XOR3( q0, q1, q6 ), BS_XOR3( r1, r2, r6 ), r7 ),
+                    BS_SHUFFLE( BS_XOR( BS_XOR3( q0, q2, q6 ), BS_XOR3( r2, r6, r7 ) ), rot2 ) );
+    q[3] = BS_XOR(  BS_XOR3( BS_XOR3( q0, q1, q2 ), BS_XOR3( q5, q6, r0 ), BS_XOR3( r2, r3, r5 ) ),
+                    BS_SHUFFLE( BS_XOR( BS_XOR3( BS_XOR3( q0, q1, q3 ), BS_XOR3( q5, q6, q7 ), BS_XOR3( r0, r3, r5 ) ), r7 ), rot2 ) );
+    q[4] = BS_XOR(  BS_XOR( BS_XOR3( BS_XOR3( q1, q2, q3 ), BS_XOR3( q5, r1, r3 ), BS_XOR3( r4, r5, r6 ) ), r7 ),
+                    BS_SHUFFLE( BS_XOR3( BS_XOR3( q1, q2, q4 ), BS_XOR3( q5, q7, r1 ), BS_XOR3( r4, r5, r6 ) ), rot2 ) );
+    q[5] = BS_XOR(  BS_XOR3( BS_XOR3( q2, q3, q4 ), BS_XOR3( q6, r2, r4 ), BS_XOR3( r5, r6, r7 ) ),
+                    BS_SHUFFLE( BS_XOR3( BS_XOR3( q2, q3, q5 ), BS_XOR3( q6, r2, r5 ), BS_XOR( r6, r7 ) ), rot2 ) );
+    q[6] = BS_XOR(  BS_XOR3( BS_XOR3( q3, q4, q5 ), BS_XOR3( q7, r3, r5 ), BS_XOR( r6, r7 ) ),
+                    BS_SHUFFLE( BS_XOR3( BS_XOR3( q3, q4, q6 ), BS_XOR3( q7, r3, r6 ), r7 ), rot2 ) );
+    q[7] = BS_XOR(  BS_XOR( BS_XOR3( q4, q5, q6 ), BS_XOR3( r4, r6, r7 ) ),
+                    BS_SHUFFLE( BS_XOR3( BS_XOR3( q4, q5, q7 ), r4, r7 ), rot2 ) );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceAddRoundKey(
+    _Inout_updates_( 8 )    __m128i *       q,
+    _In_reads_( 8 )         const __m128i * pRoundKey )
+{
+    int i;
+
+    for( i=0; i<8; i++ )
+    {
+        q[i] = BS_XOR( q[i], pRoundKey[i] );
+    }
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceEncrypt(
+    _In_                    PCSYMCRYPT_AES_BITSLICE_KEY pBitsliceKey,
+    _Inout_updates_( 8 )    __m128i *                   q )
+{
+    const __m128i shiftRows = _mm_setr_epi8( 0, 5, 10, 15, 4, 9, 14, 3, 8, 13, 2, 7, 12, 1, 6, 11 );
+    SIZE_T r;
+
+    SymCryptAesBitsliceAddRoundKey( q, pBitsliceKey->roundKey[0] );
+
+    for( r=1; r<pBitsliceKey->nRounds; r++ )
+    {
+        SymCryptAesBitsliceSbox( q );
+        SymCryptAesBitsliceShiftRows( q, shiftRows );
+        SymCryptAesBitsliceMixColumns( q );
+        SymCryptAesBitsliceAddRoundKey( q, pBitsliceKey->roundKey[r] );
+    }
+
+    SymCryptAesBitsliceSbox( q );
+    SymCryptAesBitsliceShiftRows( q, shiftRows );
+    SymCryptAesBitsliceAddRoundKey( q, pBitsliceKey->roundKey[r] );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceDecrypt(
+    _In_                    PCSYMCRYPT_AES_BITSLICE_KEY pBitsliceKey,
+    _Inout_updates_( 8 )    __m128i *                   q )
+{
+    const __m128i invShiftRows = _mm_setr_epi8( 0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3 );
+    SIZE_T r;
+
+    SymCryptAesBitsliceAddRoundKey( q, pBitsliceKey->roundKey[pBitsliceKey->nRounds] );
+
+    for( r=pBitsliceKey->nRounds - 1; r>0; r-- )
+    {
+        SymCryptAesBitsliceShiftRows( q, invShiftRows );
+        SymCryptAesBitsliceInvSbox( q );
+        SymCryptAesBitsliceAddRoundKey( q, pBitsliceKey->roundKey[r] );
+        SymCryptAesBitsliceInvMixColumns( q );
+    }
+
+    SymCryptAesBitsliceShiftRows( q, invShiftRows );
+    SymCryptAesBitsliceInvSbox( q );
+    SymCryptAesBitsliceAddRoundKey( q, pBitsliceKey->roundKey[0] );
+}
+
+//
+// ECB on a bitsliced key. A partial group of blocks at the end is processed through a buffer.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceEcbEncrypt(
+    _In_                    PCSYMCRYPT_AES_BITSLICE_KEY pBitsliceKey,
+    _In_reads_( cbData )    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )  PBYTE                       pbDst,
+                            SIZE_T                      cbData )
+{
+    __m128i q[8];
+    BYTE    buf[SYMCRYPT_AES_BITSLICE_BLOCKS * SYMCRYPT_AES_BLOCK_SIZE];
+
+    cbData &= ~(SIZE_T)(SYMCRYPT_AES_BLOCK_SIZE - 1);
+
+    while( cbData >= sizeof( buf ) )
+    {
+        SymCryptAesBitsliceLoad( q, pbSrc );
+        SymCryptAesBitsliceEncrypt( pBitsliceKey, q );
+        SymCryptAesBitsliceStore( q, pbDst );
+
+        pbSrc += sizeof( buf );
+        pbDst += sizeof( buf );
+        cbData -= sizeof( buf );
+    }
+
+    if( cbData > 0 )
+    {
+        memcpy( buf, pbSrc, cbData );
+        SymCryptAesBitsliceLoad( q, buf );
+        SymCryptAesBitsliceEncrypt( pBitsliceKey, q );
+        SymCryptAesBitsliceStore( q, buf );
+        memcpy( pbDst, buf, cbData );
+
+        SymCryptWipeKnownSize( buf, sizeof( buf ) );
+    }
+
+    SymCryptWipeKnownSize( q, sizeof( q ) );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceEcbDecrypt(
+    _In_                    PCSYMCRYPT_AES_BITSLICE_KEY pBitsliceKey,
+    _In_reads_( cbData )    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )  PBYTE                       pbDst,
+                            SIZE_T                      cbData )
+{
+    __m128i q[8];
+    BYTE    buf[SYMCRYPT_AES_BITSLICE_BLOCKS * SYMCRYPT_AES_BLOCK_SIZE];
+
+    cbData &= ~(SIZE_T)(SYMCRYPT_AES_BLOCK_SIZE - 1);
+
+    while( cbData >= sizeof( buf ) )
+    {
+        SymCryptAesBitsliceLoad( q, pbSrc );
+        SymCryptAesBitsliceDecrypt( pBitsliceKey, q );
+        SymCryptAesBitsliceStore( q, pbDst );
+
+        pbSrc += sizeof( buf );
+        pbDst += sizeof( buf );
+        cbData -= sizeof( buf );
+    }
+
+    if( cbData > 0 )
+    {
+        memcpy( buf, pbSrc, cbData );
+        SymCryptAesBitsliceLoad( q, buf );
+        SymCryptAesBitsliceDecrypt( pBitsliceKey, q );
+        SymCryptAesBitsliceStore( q, buf );
+        memcpy( pbDst, buf, cbData );
+
+        SymCryptWipeKnownSize( buf, sizeof( buf ) );
+    }
+
+    SymCryptWipeKnownSize( q, sizeof( q ) );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesEcbEncryptBitslice(
+    _In_                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _In_reads_( cbData )    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )  PBYTE                       pbDst,
+                            SIZE_T                      cbData )
+{
+    SYMCRYPT_AES_BITSLICE_KEY bsKey;
+
+    SymCryptAesBitsliceExpandKey( pExpandedKey, &bsKey );
+    SymCryptAesBitsliceEcbEncrypt( &bsKey, pbSrc, pbDst, cbData );
+
+    SymCryptWipeKnownSize( &bsKey, sizeof( bsKey ) );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCbcDecryptBitslice(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData )
+{
+    SYMCRYPT_AES_BITSLICE_KEY   bsKey;
+    __m128i                     q[8];
+    BYTE                        ciphertext[SYMCRYPT_AES_BITSLICE_BLOCKS * SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                        buf[SYMCRYPT_AES_BITSLICE_BLOCKS * SYMCRYPT_AES_BLOCK_SIZE];
+    SIZE_T                      cbChunk;
+
+    SymCryptAesBitsliceExpandKey( pExpandedKey, &bsKey );
+
+    cbData &= ~(SIZE_T)(SYMCRYPT_AES_BLOCK_SIZE - 1);
+
+    while( cbData > 0 )
+    {
+        //
+        // Keep a copy of the ciphertext as pbSrc and pbDst may be the same buffer.
+        //
+        cbChunk = min( cbData, sizeof( buf ) );
+        memcpy( ciphertext, pbSrc, cbChunk );
+
+        SymCryptAesBitsliceLoad( q, ciphertext );
+        SymCryptAesBitsliceDecrypt( &bsKey, q );
+        SymCryptAesBitsliceStore( q, buf );
+
+        SymCryptXorBytes( buf, pbChainingValue, pbDst, SYMCRYPT_AES_BLOCK_SIZE );
+        SymCryptXorBytes( buf + SYMCRYPT_AES_BLOCK_SIZE, ciphertext, pbDst + SYMCRYPT_AES_BLOCK_SIZE, cbChunk - SYMCRYPT_AES_BLOCK_SIZE );
+        memcpy( pbChainingValue, ciphertext + cbChunk - SYMCRYPT_AES_BLOCK_SIZE, SYMCRYPT_AES_BLOCK_SIZE );
+
+        pbSrc += cbChunk;
+        pbDst += cbChunk;
+        cbData -= cbChunk;
+    }
+
+    SymCryptWipeKnownSize( &bsKey, sizeof( bsKey ) );
+    SymCryptWipeKnownSize( q, sizeof( q ) );
+    SymCryptWipeKnownSize( buf, sizeof( buf ) );
+}
+
+//
+// CTR mode for both counter widths.
+// The last 8 bytes of the chaining value are handled as a 64-bit integer; only the bits
+// in ctrMask are incremented, so the carry stops at the top of the counter.
+//
+static
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceCtrMsb(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData,
+                                                UINT64                      ctrMask )
+{
+    SYMCRYPT_AES_BITSLICE_KEY   bsKey;
+    __m128i                     q[8];
+    BYTE                        buf[SYMCRYPT_AES_BITSLICE_BLOCKS * SYMCRYPT_AES_BLOCK_SIZE];
+    SIZE_T                      cbChunk;
+    UINT64                      ctr;
+    SIZE_T                      i;
+
+    SymCryptAesBitsliceExpandKey( pExpandedKey, &bsKey );
+
+    cbData &= ~(SIZE_T)(SYMCRYPT_AES_BLOCK_SIZE - 1);
+    ctr = SYMCRYPT_LOAD_MSBFIRST64( pbChainingValue + 8 );
+
+    while( cbData > 0 )
+    {
+        cbChunk = min( cbData, sizeof( buf ) );
+
+        for( i=0; i<SYMCRYPT_AES_BITSLICE_BLOCKS; i++ )
+        {
+            memcpy( &buf[i * SYMCRYPT_AES_BLOCK_SIZE], pbChainingValue, 8 );
+            SYMCRYPT_STORE_MSBFIRST64( &buf[i * SYMCRYPT_AES_BLOCK_SIZE + 8], (ctr & ~ctrMask) | ((ctr + i) & ctrMask) );
+        }
+
+        SymCryptAesBitsliceLoad( q, buf );
+        SymCryptAesBitsliceEncrypt( &bsKey, q );
+        SymCryptAesBitsliceStore( q, buf );
+
+        SymCryptXorBytes( pbSrc, buf, pbDst, cbChunk );
+
+        ctr = (ctr & ~ctrMask) | ((ctr + cbChunk / SYMCRYPT_AES_BLOCK_SIZE) & ctrMask);
+        pbSrc += cbChunk;
+        pbDst += cbChunk;
+        cbData -= cbChunk;
+    }
+
+    SYMCRYPT_STORE_MSBFIRST64( pbChainingValue + 8, ctr );
+
+    SymCryptWipeKnownSize( &bsKey, sizeof( bsKey ) );
+    SymCryptWipeKnownSize( q, sizeof( q ) );
+    SymCryptWipeKnownSize( buf, sizeof( buf ) );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb64Bitslice(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData )
+{
+    SymCryptAesBitsliceCtrMsb( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData, (UINT64) -1 );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb32Bitslice(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData )
+{
+    SymCryptAesBitsliceCtrMsb( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData, 0xffffffff );
+}
+
+#endif
@@ -69,9 +69,39 @@ const SYMCRYPT_BLOCKCIPHER SymCryptAesBlockCipher_Fast = {
     NULL,                
 #endif 
 
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64 | SYMCRYPT_CPU_ARM64
+    &SymCryptAesCtrMsb32,
+#else
+    NULL,                
+#endif 
+
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+    &SymCryptAesCfbEncrypt,
+    &SymCryptAesCfbDecrypt,
+#else
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_CFB     cfbEncryptFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_CFB     cfbDecryptFunc;
+#endif
+
     NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_XTS     xtsEncFunc;
     NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_XTS     xtsDecFunc;
 
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+    &SymCryptAesGcmEncryptPart,
+    &SymCryptAesGcmDecryptPart,
+#else
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE gcmEncryptPartFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE gcmDecryptPartFunc;
+#endif
+
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+    &SymCryptAesCcmEncryptPart,
+    &SymCryptAesCcmDecryptPart,
+#else
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE ccmEncryptPartFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE ccmDecryptPartFunc;
+#endif
+
     SYMCRYPT_AES_BLOCK_SIZE,         
     sizeof( SYMCRYPT_AES_EXPANDED_KEY ),
 };
@@ -32,8 +32,15 @@ const SYMCRYPT_BLOCKCIPHER SymCryptAesBlockCipherNoOpt = {
     NULL,
     NULL,
     NULL,                
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_MODE    ctrMsb32Func;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_CFB     cfbEncryptFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_CFB     cfbDecryptFunc;
     NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_XTS     xtsEncFunc;
     NULL,                   // PSYMCRYPT_BLOCKCIPHER_CRYPT_XTS     xtsDecFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE gcmEncryptPartFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE gcmDecryptPartFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE ccmEncryptPartFunc;
+    NULL,                   // PSYMCRYPT_BLOCKCIPHER_AEADPART_MODE ccmDecryptPartFunc;
 
     SYMCRYPT_AES_BLOCK_SIZE,         
     sizeof( SYMCRYPT_AES_EXPANDED_KEY ),
@@ -136,6 +143,8 @@ SymCryptAesDecrypt(
     _In_reads_(SYMCRYPT_AES_BLOCK_SIZE)     PCBYTE                      pbSrc,
     _Out_writes_(SYMCRYPT_AES_BLOCK_SIZE)   PBYTE                       pbDst )
 {
+    SymCryptAesEnsureDecryptionRoundKeys( pExpandedKey );
+
 #if SYMCRYPT_CPU_AMD64
     if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
     {
@@ -218,10 +227,30 @@ SymCryptAesCbcDecrypt(
     _Out_writes_( cbData )                      PBYTE                       pbDst,
                                                 SIZE_T                      cbData )
 {
+    SymCryptAesEnsureDecryptionRoundKeys( pExpandedKey );
+
 #if SYMCRYPT_CPU_AMD64
-    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
+    SYMCRYPT_EXTENDED_SAVE_DATA  SaveData;
+
+    if( cbData >= SYMCRYPT_AES_VAES_512_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_VAES_512_CODE ) &&
+        SymCryptSaveYmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesCbcDecryptZmm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+        SymCryptRestoreYmm( &SaveData );
+    } else if( cbData >= SYMCRYPT_AES_VAES_256_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_VAES_256_CODE ) &&
+        SymCryptSaveYmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesCbcDecryptYmm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+        SymCryptRestoreYmm( &SaveData );
+    } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
     {
         SymCryptAesCbcDecryptXmm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    } else if( cbData >= SYMCRYPT_AES_BITSLICE_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AES_BITSLICE_CODE ) )
+    {
+        SymCryptAesCbcDecryptBitslice( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
     } else {
         SymCryptAesCbcDecryptAsm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
     }
@@ -259,9 +288,27 @@ SymCryptAesEcbEncrypt(
                                                 SIZE_T                      cbData )
 {
 #if SYMCRYPT_CPU_AMD64
-    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
+    SYMCRYPT_EXTENDED_SAVE_DATA  SaveData;
+
+    if( cbData >= SYMCRYPT_AES_VAES_512_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_VAES_512_CODE ) &&
+        SymCryptSaveYmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesEcbEncryptZmm( pExpandedKey, pbSrc, pbDst, cbData );
+        SymCryptRestoreYmm( &SaveData );
+    } else if( cbData >= SYMCRYPT_AES_VAES_256_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_VAES_256_CODE ) &&
+        SymCryptSaveYmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesEcbEncryptYmm( pExpandedKey, pbSrc, pbDst, cbData );
+        SymCryptRestoreYmm( &SaveData );
+    } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
     {
         SymCryptAesEcbEncryptXmm( pExpandedKey, pbSrc, pbDst, cbData );
+    } else if( cbData >= SYMCRYPT_AES_BITSLICE_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AES_BITSLICE_CODE ) )
+    {
+        SymCryptAesEcbEncryptBitslice( pExpandedKey, pbSrc, pbDst, cbData );
     } else {
         SymCryptAesEcbEncryptAsm( pExpandedKey, pbSrc, pbDst, cbData );
     }
@@ -290,6 +337,45 @@ SymCryptAesEcbEncrypt(
 #endif
 }
 
+#define SYMCRYPT_QUIC_HP_MASK_BATCH     (32)
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesQuicHeaderProtectionMasks(
+    _In_                                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _In_reads_( nSamples * SYMCRYPT_QUIC_HP_SAMPLE_SIZE )       PCBYTE                      pbSamples,
+    _Out_writes_( nSamples * SYMCRYPT_QUIC_HP_MASK_SIZE )       PBYTE                       pbMasks,
+                                                                SIZE_T                      nSamples )
+{
+    SYMCRYPT_ALIGN BYTE buf[SYMCRYPT_QUIC_HP_MASK_BATCH * SYMCRYPT_AES_BLOCK_SIZE];
+    SIZE_T  nBatch;
+    SIZE_T  i;
+
+    C_ASSERT( SYMCRYPT_QUIC_HP_SAMPLE_SIZE == SYMCRYPT_AES_BLOCK_SIZE );
+
+    //
+    // The samples are contiguous, so a batch of them is a single ECB request and
+    // gets the parallel AES-NI (or VAES) code. We only dispatch once per batch.
+    //
+    while( nSamples > 0 )
+    {
+        nBatch = min( nSamples, SYMCRYPT_QUIC_HP_MASK_BATCH );
+
+        SymCryptAesEcbEncrypt( pExpandedKey, pbSamples, buf, nBatch * SYMCRYPT_AES_BLOCK_SIZE );
+
+        for( i=0; i<nBatch; i++ )
+        {
+            memcpy( pbMasks + i * SYMCRYPT_QUIC_HP_MASK_SIZE, &buf[i * SYMCRYPT_AES_BLOCK_SIZE], SYMCRYPT_QUIC_HP_MASK_SIZE );
+        }
+
+        pbSamples += nBatch * SYMCRYPT_AES_BLOCK_SIZE;
+        pbMasks += nBatch * SYMCRYPT_QUIC_HP_MASK_SIZE;
+        nSamples -= nBatch;
+    }
+
+    SymCryptWipeKnownSize( buf, sizeof( buf ) );
+}
+
 VOID
 SYMCRYPT_CALL
 SymCryptAesEcbDecrypt( 
@@ -301,6 +387,8 @@ SymCryptAesEcbDecrypt(
     SIZE_T cbToDo = cbData & ~(SYMCRYPT_AES_BLOCK_SIZE - 1);
     SIZE_T i;
 
+    SymCryptAesEnsureDecryptionRoundKeys( pExpandedKey );
+
     //
     // This loop condition is slightly strange.
     // If I use i < cbToDo (which is correct) then Prefast complains about buffer overflows.
@@ -358,8 +446,42 @@ SymCryptAesCbcMac(
 
 VOID
 SYMCRYPT_CALL
-SymCryptAesCtrMsb64( 
+SymCryptAesCfbEncrypt(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+                                                SIZE_T                      cbShift,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData )
+{
+#if SYMCRYPT_CPU_AMD64
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
+    {
+        SymCryptAesCfbEncryptXmm( pExpandedKey, cbShift, pbChainingValue, pbSrc, pbDst, cbData );
+    } else {
+        SymCryptCfbEncrypt( &SymCryptAesBlockCipherNoOpt, cbShift, pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    }
+#elif SYMCRYPT_CPU_X86
+    SYMCRYPT_EXTENDED_SAVE_DATA  SaveData;
+
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) &&
+        SymCryptSaveXmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesCfbEncryptXmm( pExpandedKey, cbShift, pbChainingValue, pbSrc, pbDst, cbData );
+        SymCryptRestoreXmm( &SaveData );
+    } else {
+        SymCryptCfbEncrypt( &SymCryptAesBlockCipherNoOpt, cbShift, pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    }
+#else
+    SymCryptCfbEncrypt( &SymCryptAesBlockCipherNoOpt, cbShift, pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+#endif
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCfbDecrypt(
     _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+                                                SIZE_T                      cbShift,
     _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
     _In_reads_( cbData )                        PCBYTE                      pbSrc,
     _Out_writes_( cbData )                      PBYTE                       pbDst,
@@ -367,8 +489,58 @@ SymCryptAesCtrMsb64(
 {
 #if SYMCRYPT_CPU_AMD64
     if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
+    {
+        SymCryptAesCfbDecryptXmm( pExpandedKey, cbShift, pbChainingValue, pbSrc, pbDst, cbData );
+    } else {
+        SymCryptCfbDecrypt( &SymCryptAesBlockCipherNoOpt, cbShift, pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    }
+#elif SYMCRYPT_CPU_X86
+    SYMCRYPT_EXTENDED_SAVE_DATA  SaveData;
+
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) &&
+        SymCryptSaveXmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesCfbDecryptXmm( pExpandedKey, cbShift, pbChainingValue, pbSrc, pbDst, cbData );
+        SymCryptRestoreXmm( &SaveData );
+    } else {
+        SymCryptCfbDecrypt( &SymCryptAesBlockCipherNoOpt, cbShift, pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    }
+#else
+    SymCryptCfbDecrypt( &SymCryptAesBlockCipherNoOpt, cbShift, pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+#endif
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb64( 
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData )
+{
+#if SYMCRYPT_CPU_AMD64
+    SYMCRYPT_EXTENDED_SAVE_DATA  SaveData;
+
+    if( cbData >= SYMCRYPT_AES_VAES_512_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_VAES_512_CODE ) &&
+        SymCryptSaveYmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesCtrMsb64Zmm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+        SymCryptRestoreYmm( &SaveData );
+    } else if( cbData >= SYMCRYPT_AES_VAES_256_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_VAES_256_CODE ) &&
+        SymCryptSaveYmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesCtrMsb64Ymm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+        SymCryptRestoreYmm( &SaveData );
+    } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
     {
         SymCryptAesCtrMsb64Xmm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    } else if( cbData >= SYMCRYPT_AES_BITSLICE_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AES_BITSLICE_CODE ) )
+    {
+        SymCryptAesCtrMsb64Bitslice( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
     } else {
         SymCryptAesCtrMsb64Asm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
     }
@@ -402,6 +574,332 @@ SymCryptAesCtrMsb64(
 #endif
 }
 
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb32( 
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData )
+{
+#if SYMCRYPT_CPU_AMD64
+    SYMCRYPT_EXTENDED_SAVE_DATA  SaveData;
+
+    if( cbData >= SYMCRYPT_AES_VAES_512_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_VAES_512_CODE ) &&
+        SymCryptSaveYmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesCtrMsb32Zmm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+        SymCryptRestoreYmm( &SaveData );
+    } else if( cbData >= SYMCRYPT_AES_VAES_256_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_VAES_256_CODE ) &&
+        SymCryptSaveYmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesCtrMsb32Ymm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+        SymCryptRestoreYmm( &SaveData );
+    } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
+    {
+        SymCryptAesCtrMsb32Xmm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    } else if( cbData >= SYMCRYPT_AES_BITSLICE_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AES_BITSLICE_CODE ) )
+    {
+        SymCryptAesCtrMsb32Bitslice( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    } else {
+        SYMCRYPT_ASSERT( SymCryptAesBlockCipherNoOpt.blockSize == SYMCRYPT_AES_BLOCK_SIZE );
+        SymCryptCtrMsb32( &SymCryptAesBlockCipherNoOpt, pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    }
+
+#elif SYMCRYPT_CPU_X86
+    SYMCRYPT_EXTENDED_SAVE_DATA  SaveData;
+
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) &&
+        SymCryptSaveXmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesCtrMsb32Xmm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+        SymCryptRestoreXmm( &SaveData );
+    } else {
+        SYMCRYPT_ASSERT( SymCryptAesBlockCipherNoOpt.blockSize == SYMCRYPT_AES_BLOCK_SIZE );
+        SymCryptCtrMsb32( &SymCryptAesBlockCipherNoOpt, pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    }
+
+#elif SYMCRYPT_CPU_ARM64
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_NEON_AES ) )
+    {
+        SymCryptAesCtrMsb32Neon( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    } else {
+        SymCryptCtrMsb32( &SymCryptAesBlockCipherNoOpt, pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    }
+
+#else
+    SYMCRYPT_ASSERT( SymCryptAesBlockCipherNoOpt.blockSize == SYMCRYPT_AES_BLOCK_SIZE );        // keep Prefast happy
+    SymCryptCtrMsb32( &SymCryptAesBlockCipherNoOpt, pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+#endif
+}
+
+typedef struct _SYMCRYPT_AES_CTR_IOVEC_CONTEXT {
+    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey;
+    PBYTE                       pbChainingValue;
+} SYMCRYPT_AES_CTR_IOVEC_CONTEXT, *PSYMCRYPT_AES_CTR_IOVEC_CONTEXT;
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb64IovecFunc( PVOID pContext, PCBYTE pbSrc, PBYTE pbDst, SIZE_T cbData )
+{
+    PSYMCRYPT_AES_CTR_IOVEC_CONTEXT pCtx = (PSYMCRYPT_AES_CTR_IOVEC_CONTEXT) pContext;
+
+    SymCryptAesCtrMsb64( pCtx->pExpandedKey, pCtx->pbChainingValue, pbSrc, pbDst, cbData );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb64Iovec( 
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( nSrc )                          PCSYMCRYPT_IOVEC            pSrc,
+                                                SIZE_T                      nSrc,
+    _In_reads_( nDst )                          PCSYMCRYPT_IOVEC            pDst,
+                                                SIZE_T                      nDst )
+{
+    SYMCRYPT_AES_CTR_IOVEC_CONTEXT ctx;
+
+    SYMCRYPT_ASSERT( (SymCryptIovecLength( pSrc, nSrc ) & (SYMCRYPT_AES_BLOCK_SIZE - 1)) == 0 );
+
+    ctx.pExpandedKey = pExpandedKey;
+    ctx.pbChainingValue = pbChainingValue;
+
+    SymCryptIovecCrypt( pSrc, nSrc, pDst, nDst, SYMCRYPT_AES_BLOCK_SIZE, &SymCryptAesCtrMsb64IovecFunc, &ctx );
+}
+
+
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+
+#define SYMCRYPT_CPU_FEATURES_FOR_AES_GCM_STITCHED_CODE  (SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE | SYMCRYPT_CPU_FEATURES_FOR_PCLMULQDQ_CODE)
+
+//
+// With VAES and VPCLMULQDQ the 512-bit CTR and GHASH code is faster than the stitched Xmm kernel,
+// even as two separate passes. We run the passes on chunks of SYMCRYPT_AES_GCM_WIDE_CHUNK bytes
+// so that the second pass finds the data in the L1 cache.
+// Requests smaller than SYMCRYPT_AES_VAES_512_MIN_BYTES don't pay for the YMM save and use the stitched kernel.
+//
+#define SYMCRYPT_CPU_FEATURES_FOR_AES_GCM_WIDE_CODE     (SYMCRYPT_CPU_FEATURES_FOR_VAES_512_CODE | SYMCRYPT_CPU_FEATURES_FOR_VPCLMULQDQ_CODE)
+#define SYMCRYPT_AES_GCM_WIDE_CHUNK                     (4096)
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesGcmEncryptPart(
+    _Inout_                 PVOID   pState,
+    _In_reads_( cbData )    PCBYTE  pbSrc,
+    _Out_writes_( cbData )  PBYTE   pbDst,
+                            SIZE_T  cbData )
+{
+    PSYMCRYPT_GCM_STATE         pGcmState = (PSYMCRYPT_GCM_STATE) pState;
+    PCSYMCRYPT_GCM_EXPANDED_KEY pKey = pGcmState->pKey;
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+    SYMCRYPT_EXTENDED_SAVE_DATA SaveData;
+#endif
+#if SYMCRYPT_CPU_AMD64
+    SIZE_T                      cbChunk;
+#endif
+
+    SYMCRYPT_ASSERT( (cbData & (SYMCRYPT_GCM_BLOCK_SIZE - 1)) == 0 && pGcmState->bytesInMacBlock == 0 );
+
+#if SYMCRYPT_CPU_AMD64
+    if( cbData >= SYMCRYPT_AES_VAES_512_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AES_GCM_WIDE_CODE ) &&
+        SymCryptSaveYmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        while( cbData > 0 )
+        {
+            cbChunk = SYMCRYPT_MIN( cbData, SYMCRYPT_AES_GCM_WIDE_CHUNK );
+            SymCryptAesCtrMsb32Zmm( &pKey->blockcipherKey.aes, &pGcmState->counterBlock[0], pbSrc, pbDst, cbChunk );
+            SymCryptGHashAppendDataVpclmulqdq( &pKey->ghashKey.table[0], &pGcmState->ghashState, pbDst, cbChunk );
+            pbSrc += cbChunk;
+            pbDst += cbChunk;
+            cbData -= cbChunk;
+        }
+        SymCryptRestoreYmm( &SaveData );
+    } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AES_GCM_STITCHED_CODE ) )
+    {
+        SymCryptAesGcmEncryptStitchedXmm(   &pKey->blockcipherKey.aes,
+                                            &pGcmState->counterBlock[0],
+                                            &pKey->ghashKey.table[0],
+                                            &pGcmState->ghashState,
+                                            pbSrc,
+                                            pbDst,
+                                            cbData );
+    } else {
+        SymCryptAesCtrMsb32( &pKey->blockcipherKey.aes, &pGcmState->counterBlock[0], pbSrc, pbDst, cbData );
+        SymCryptGHashAppendData( &pKey->ghashKey, &pGcmState->ghashState, pbDst, cbData );
+    }
+
+#else   // SYMCRYPT_CPU_X86
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AES_GCM_STITCHED_CODE ) &&
+        SymCryptSaveXmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesGcmEncryptStitchedXmm(   &pKey->blockcipherKey.aes,
+                                            &pGcmState->counterBlock[0],
+                                            (PCSYMCRYPT_GF128_ELEMENT) &pKey->ghashKey.tableSpace[pKey->ghashKey.tableOffset],
+                                            &pGcmState->ghashState,
+                                            pbSrc,
+                                            pbDst,
+                                            cbData );
+        SymCryptRestoreXmm( &SaveData );
+    } else {
+        SymCryptAesCtrMsb32( &pKey->blockcipherKey.aes, &pGcmState->counterBlock[0], pbSrc, pbDst, cbData );
+        SymCryptGHashAppendData( &pKey->ghashKey, &pGcmState->ghashState, pbDst, cbData );
+    }
+#endif
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesGcmDecryptPart(
+    _Inout_                 PVOID   pState,
+    _In_reads_( cbData )    PCBYTE  pbSrc,
+    _Out_writes_( cbData )  PBYTE   pbDst,
+                            SIZE_T  cbData )
+{
+    PSYMCRYPT_GCM_STATE         pGcmState = (PSYMCRYPT_GCM_STATE) pState;
+    PCSYMCRYPT_GCM_EXPANDED_KEY pKey = pGcmState->pKey;
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+    SYMCRYPT_EXTENDED_SAVE_DATA SaveData;
+#endif
+#if SYMCRYPT_CPU_AMD64
+    SIZE_T                      cbChunk;
+#endif
+
+    SYMCRYPT_ASSERT( (cbData & (SYMCRYPT_GCM_BLOCK_SIZE - 1)) == 0 && pGcmState->bytesInMacBlock == 0 );
+
+#if SYMCRYPT_CPU_AMD64
+    if( cbData >= SYMCRYPT_AES_VAES_512_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AES_GCM_WIDE_CODE ) &&
+        SymCryptSaveYmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        while( cbData > 0 )
+        {
+            cbChunk = SYMCRYPT_MIN( cbData, SYMCRYPT_AES_GCM_WIDE_CHUNK );
+            SymCryptGHashAppendDataVpclmulqdq( &pKey->ghashKey.table[0], &pGcmState->ghashState, pbSrc, cbChunk );
+            SymCryptAesCtrMsb32Zmm( &pKey->blockcipherKey.aes, &pGcmState->counterBlock[0], pbSrc, pbDst, cbChunk );
+            pbSrc += cbChunk;
+            pbDst += cbChunk;
+            cbData -= cbChunk;
+        }
+        SymCryptRestoreYmm( &SaveData );
+    } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AES_GCM_STITCHED_CODE ) )
+    {
+        SymCryptAesGcmDecryptStitchedXmm(   &pKey->blockcipherKey.aes,
+                                            &pGcmState->counterBlock[0],
+                                            &pKey->ghashKey.table[0],
+                                            &pGcmState->ghashState,
+                                            pbSrc,
+                                            pbDst,
+                                            cbData );
+    } else {
+        SymCryptGHashAppendData( &pKey->ghashKey, &pGcmState->ghashState, pbSrc, cbData );
+        SymCryptAesCtrMsb32( &pKey->blockcipherKey.aes, &pGcmState->counterBlock[0], pbSrc, pbDst, cbData );
+    }
+
+#else   // SYMCRYPT_CPU_X86
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AES_GCM_STITCHED_CODE ) &&
+        SymCryptSaveXmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesGcmDecryptStitchedXmm(   &pKey->blockcipherKey.aes,
+                                            &pGcmState->counterBlock[0],
+                                            (PCSYMCRYPT_GF128_ELEMENT) &pKey->ghashKey.tableSpace[pKey->ghashKey.tableOffset],
+                                            &pGcmState->ghashState,
+                                            pbSrc,
+                                            pbDst,
+                                            cbData );
+        SymCryptRestoreXmm( &SaveData );
+    } else {
+        SymCryptGHashAppendData( &pKey->ghashKey, &pGcmState->ghashState, pbSrc, cbData );
+        SymCryptAesCtrMsb32( &pKey->blockcipherKey.aes, &pGcmState->counterBlock[0], pbSrc, pbDst, cbData );
+    }
+#endif
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCcmEncryptPart(
+    _Inout_                 PVOID   pState,
+    _In_reads_( cbData )    PCBYTE  pbSrc,
+    _Out_writes_( cbData )  PBYTE   pbDst,
+                            SIZE_T  cbData )
+{
+    PSYMCRYPT_CCM_STATE         pCcmState = (PSYMCRYPT_CCM_STATE) pState;
+    PCSYMCRYPT_AES_EXPANDED_KEY pKey = (PCSYMCRYPT_AES_EXPANDED_KEY) pCcmState->pExpandedKey;
+#if SYMCRYPT_CPU_X86
+    SYMCRYPT_EXTENDED_SAVE_DATA SaveData;
+#endif
+
+    SYMCRYPT_ASSERT( (cbData & (SYMCRYPT_CCM_BLOCK_SIZE - 1)) == 0 && pCcmState->bytesInMacBlock == 0 );
+
+#if SYMCRYPT_CPU_AMD64
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
+    {
+        SymCryptAesCcmEncryptStitchedXmm( pKey, &pCcmState->counterBlock[0], &pCcmState->macBlock[0], pbSrc, pbDst, cbData );
+    } else {
+        SymCryptAesCbcMac( pKey, &pCcmState->macBlock[0], pbSrc, cbData );
+        SymCryptAesCtrMsb64( pKey, &pCcmState->counterBlock[0], pbSrc, pbDst, cbData );
+    }
+
+#else   // SYMCRYPT_CPU_X86
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) &&
+        SymCryptSaveXmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesCcmEncryptStitchedXmm( pKey, &pCcmState->counterBlock[0], &pCcmState->macBlock[0], pbSrc, pbDst, cbData );
+        SymCryptRestoreXmm( &SaveData );
+    } else {
+        SymCryptAesCbcMac( pKey, &pCcmState->macBlock[0], pbSrc, cbData );
+        SymCryptAesCtrMsb64( pKey, &pCcmState->counterBlock[0], pbSrc, pbDst, cbData );
+    }
+#endif
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCcmDecryptPart(
+    _Inout_                 PVOID   pState,
+    _In_reads_( cbData )    PCBYTE  pbSrc,
+    _Out_writes_( cbData )  PBYTE   pbDst,
+                            SIZE_T  cbData )
+{
+    PSYMCRYPT_CCM_STATE         pCcmState = (PSYMCRYPT_CCM_STATE) pState;
+    PCSYMCRYPT_AES_EXPANDED_KEY pKey = (PCSYMCRYPT_AES_EXPANDED_KEY) pCcmState->pExpandedKey;
+#if SYMCRYPT_CPU_X86
+    SYMCRYPT_EXTENDED_SAVE_DATA SaveData;
+#endif
+
+    SYMCRYPT_ASSERT( (cbData & (SYMCRYPT_CCM_BLOCK_SIZE - 1)) == 0 && pCcmState->bytesInMacBlock == 0 );
+
+    //
+    // The fallback reads the plaintext back from pbDst for the MAC; 
+    // see the comment in SymCryptCcmDecryptPart on why this is safe.
+    //
+#if SYMCRYPT_CPU_AMD64
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
+    {
+        SymCryptAesCcmDecryptStitchedXmm( pKey, &pCcmState->counterBlock[0], &pCcmState->macBlock[0], pbSrc, pbDst, cbData );
+    } else {
+        SymCryptAesCtrMsb64( pKey, &pCcmState->counterBlock[0], pbSrc, pbDst, cbData );
+        SymCryptAesCbcMac( pKey, &pCcmState->macBlock[0], pbDst, cbData );
+    }
+
+#else   // SYMCRYPT_CPU_X86
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) &&
+        SymCryptSaveXmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesCcmDecryptStitchedXmm( pKey, &pCcmState->counterBlock[0], &pCcmState->macBlock[0], pbSrc, pbDst, cbData );
+        SymCryptRestoreXmm( &SaveData );
+    } else {
+        SymCryptAesCtrMsb64( pKey, &pCcmState->counterBlock[0], pbSrc, pbDst, cbData );
+        SymCryptAesCbcMac( pKey, &pCcmState->macBlock[0], pbDst, cbData );
+    }
+#endif
+}
+
+#endif  // CPU_X86 | CPU_AMD64
 
 PSYMCRYPT_BLOCKCIPHER_CRYPT_XTS
 SYMCRYPT_CALL
@@ -36,12 +36,10 @@ SYMCRYPT_CALL
 SymCryptAesExpandKeyInternal(   
     _Out_               PSYMCRYPT_AES_EXPANDED_KEY  pExpandedKey,
     _In_reads_(cbKey)   PCBYTE                      pbKey,
-                        SIZE_T                      cbKey,
-                        BOOLEAN                     fCreateDecryptionKeys )
+                        SIZE_T                      cbKey )
 {
     UINT32  nRounds;
     BYTE *  p;
-    BYTE *  q;
     UINT32  i;
     UINT32  t;
 
@@ -81,7 +79,7 @@ SymCryptAesExpandKeyInternal(
     case 16:
         nRounds = 10;
         pExpandedKey->lastEncRoundKey = &pExpandedKey->RoundKey[nRounds];
-        pExpandedKey->lastDecRoundKey = &pExpandedKey->RoundKey[2*nRounds];
+        pExpandedKey->lastDecRoundKey = NULL;
 
         memcpy( &pExpandedKey->RoundKey[0], pbKey, 16 );
 
@@ -105,7 +103,7 @@ SymCryptAesExpandKeyInternal(
     case 24:
         nRounds = 12;
         pExpandedKey->lastEncRoundKey = &pExpandedKey->RoundKey[nRounds];
-        pExpandedKey->lastDecRoundKey = &pExpandedKey->RoundKey[2*nRounds];
+        pExpandedKey->lastDecRoundKey = NULL;
 
         memcpy( &pExpandedKey->RoundKey[0], pbKey, 24 );
 
@@ -136,7 +134,7 @@ SymCryptAesExpandKeyInternal(
     case 32:
         nRounds = 14;
         pExpandedKey->lastEncRoundKey = &pExpandedKey->RoundKey[nRounds];
-        pExpandedKey->lastDecRoundKey = &pExpandedKey->RoundKey[2*nRounds];
+        pExpandedKey->lastDecRoundKey = NULL;
 
         memcpy( &pExpandedKey->RoundKey[0], pbKey, 32 );
 
@@ -185,25 +183,94 @@ SymCryptAesExpandKeyInternal(
     }
 
 
-    if( fCreateDecryptionKeys )
+cleanup:
+
+#if SYMCRYPT_CPU_X86
+    if( UseSimd )
     {
-        p = &pExpandedKey->RoundKey[0][0][0];
-        q = (PBYTE)(pExpandedKey->lastDecRoundKey);
-    
-        // The first encryption round key is the last decryption round key
-        memcpy( q, p, SYMCRYPT_AES_BLOCK_SIZE );
-        p += 16;
-        q -= 16;
+        SymCryptRestoreXmm( &SaveData );
+    }
+#endif
+
+    return status;
+}
 
-        while( p < (PBYTE) pExpandedKey->lastEncRoundKey )
+//
+// The decryption round keys are created lazily by the first decryption that uses the key.
+// Many keys (e.g. for GCM and CTR) are never used for decryption, and the AESIMC work is
+// a significant part of the key expansion.
+//
+// The decryption round keys are a cache of values derived from the encryption round keys, 
+// so we write them into the otherwise const key. Several threads can get here at the same time.
+// Each builds the round keys in a local buffer, and only the thread that moves lastDecRoundKey
+// from NULL to the claim value &RoundKey[0] copies them into the key. It then sets lastDecRoundKey
+// to its final value, after a memory barrier, so a thread that sees the final pointer also sees
+// the round keys. The other threads wait for that store; it follows the claim after a short memcpy.
+// On x86 and AMD64 a reader needs no barrier of its own as loads are not reordered with other loads.
+// Other CPUs would need a barrier in every decryption, so there the decryption round keys are
+// created immediately by SymCryptAesExpandKey and SymCryptAesCompactKeyLoad, and lazy creation only 
+// happens for keys from SymCryptAesExpandKeyEncryptOnly.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptAesCreateDecryptionRoundKeys( _In_ PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey )
+{
+    PSYMCRYPT_AES_EXPANDED_KEY  pKey = (PSYMCRYPT_AES_EXPANDED_KEY) pExpandedKey;
+    SYMCRYPT_ALIGN BYTE decRoundKeys[14][SYMCRYPT_AES_BLOCK_SIZE];    // up to 14 decryption round keys not shared with encryption
+    SIZE_T  nRounds;
+    SIZE_T  i;
+    BOOL    UseSimd = FALSE;
+
+#if SYMCRYPT_CPU_X86
+    SYMCRYPT_EXTENDED_SAVE_DATA  SaveData;
+
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
+    {
+        if( SymCryptSaveXmm( &SaveData ) == SYMCRYPT_NO_ERROR )
         {
-            SymCryptAesCreateDecryptionRoundKey( p, q, UseSimd );
-            q -= 16;
-            p += 16;
+            UseSimd = TRUE;
         }
     }
+#elif SYMCRYPT_CPU_AMD64
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
+    {
+        UseSimd = TRUE;
+    }
+#elif SYMCRYPT_CPU_ARM64
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_NEON_AES ) )
+    {
+        UseSimd = TRUE;
+    }
+#endif
 
-cleanup:
+    SYMCRYPT_CHECK_MAGIC( pKey );
+
+    nRounds = pKey->lastEncRoundKey - &pKey->RoundKey[0];
+    SYMCRYPT_ASSERT( nRounds <= SYMCRYPT_ARRAY_SIZE( decRoundKeys ) );
+
+    if( *(BYTE (* volatile *)[4][4]) &pKey->lastDecRoundKey == NULL )
+    {
+        //
+        // decRoundKeys[i] becomes RoundKey[nRounds + 1 + i].
+        // The first encryption round key is the last decryption round key.
+        //
+        memcpy( &decRoundKeys[nRounds - 1][0], &pKey->RoundKey[0], SYMCRYPT_AES_BLOCK_SIZE );
+        for( i = 1; i < nRounds; i++ )
+        {
+            SymCryptAesCreateDecryptionRoundKey( &pKey->RoundKey[i][0][0], &decRoundKeys[nRounds - 1 - i][0], UseSimd );
+        }
+
+        if( ATOMIC_CAS_PTR( &pKey->lastDecRoundKey, &pKey->RoundKey[0], NULL ) )
+        {
+            memcpy( &pKey->RoundKey[nRounds + 1], &decRoundKeys[0][0], nRounds * SYMCRYPT_AES_BLOCK_SIZE );
+
+            SYMCRYPT_MEMORY_BARRIER();
+
+            *(BYTE (* volatile *)[4][4]) &pKey->lastDecRoundKey = &pKey->RoundKey[2*nRounds];
+        }
+
+        SymCryptWipeKnownSize( &decRoundKeys[0][0], sizeof( decRoundKeys ) );
+    }
 
 #if SYMCRYPT_CPU_X86
     if( UseSimd )
@@ -212,7 +279,10 @@ cleanup:
     }
 #endif
 
-    return status;
+    while( *(BYTE (* volatile *)[4][4]) &pKey->lastDecRoundKey == &pKey->RoundKey[0] )
+    {
+        SYMCRYPT_MEMORY_BARRIER();
+    }
 }
 
 _Success_(return == SYMCRYPT_NO_ERROR)
@@ -224,7 +294,18 @@ SymCryptAesExpandKey(
                         SIZE_T                      cbKey )
  
 {
-    return SymCryptAesExpandKeyInternal( pExpandedKey, pbKey, cbKey, TRUE );
+    SYMCRYPT_ERROR scError;
+
+    scError = SymCryptAesExpandKeyInternal( pExpandedKey, pbKey, cbKey );
+
+#if !(SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64)
+    if( scError == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptAesCreateDecryptionRoundKeys( pExpandedKey );
+    }
+#endif
+
+    return scError;
 }
 
 _Success_(return == SYMCRYPT_NO_ERROR)
@@ -235,7 +316,54 @@ SymCryptAesExpandKeyEncryptOnly(
     _In_reads_(cbKey)   PCBYTE                      pbKey,
                         SIZE_T                      cbKey )
 {
-    return SymCryptAesExpandKeyInternal( pExpandedKey, pbKey, cbKey, FALSE );
+    return SymCryptAesExpandKeyInternal( pExpandedKey, pbKey, cbKey );
+}
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptAesExpandKeyCompact(
+    _Out_               PSYMCRYPT_AES_COMPACT_EXPANDED_KEY  pCompactKey,
+    _In_reads_(cbKey)   PCBYTE                              pbKey,
+                        SIZE_T                              cbKey )
+{
+    SYMCRYPT_AES_EXPANDED_KEY   key;
+    SYMCRYPT_ERROR              scError;
+
+    scError = SymCryptAesExpandKeyInternal( &key, pbKey, cbKey );
+    if( scError != SYMCRYPT_NO_ERROR )
+    {
+        goto cleanup;
+    }
+
+    pCompactKey->nRounds = (UINT32)(key.lastEncRoundKey - &key.RoundKey[0]);
+    memcpy( &pCompactKey->RoundKey[0], &key.RoundKey[0], (pCompactKey->nRounds + 1) * SYMCRYPT_AES_BLOCK_SIZE );
+
+    SYMCRYPT_SET_MAGIC( pCompactKey );
+
+cleanup:
+    SymCryptWipeKnownSize( &key, sizeof( key ) );
+
+    return scError;
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCompactKeyLoad(
+    _In_    PCSYMCRYPT_AES_COMPACT_EXPANDED_KEY pCompactKey,
+    _Out_   PSYMCRYPT_AES_EXPANDED_KEY          pExpandedKey )
+{
+    SYMCRYPT_CHECK_MAGIC( pCompactKey );
+
+    memcpy( &pExpandedKey->RoundKey[0], &pCompactKey->RoundKey[0], (pCompactKey->nRounds + 1) * SYMCRYPT_AES_BLOCK_SIZE );
+    pExpandedKey->lastEncRoundKey = &pExpandedKey->RoundKey[pCompactKey->nRounds];
+    pExpandedKey->lastDecRoundKey = NULL;
+
+    SYMCRYPT_SET_MAGIC( pExpandedKey );
+
+#if !(SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64)
+    SymCryptAesCreateDecryptionRoundKeys( pExpandedKey );
+#endif
 }
 
 VOID
@@ -243,11 +371,31 @@ SYMCRYPT_CALL
 SymCryptAesKeyCopy( _In_    PCSYMCRYPT_AES_EXPANDED_KEY pSrc, 
                     _Out_   PSYMCRYPT_AES_EXPANDED_KEY  pDst )
 {
+    SIZE_T  nRounds;
+
     SYMCRYPT_CHECK_MAGIC( pSrc );
 
-    *pDst = *pSrc;
-    pDst->lastEncRoundKey = &pDst->RoundKey[0] + (pSrc->lastEncRoundKey - &pSrc->RoundKey[0]);
-    pDst->lastDecRoundKey = &pDst->RoundKey[0] + (pSrc->lastDecRoundKey - &pSrc->RoundKey[0]);
+    //
+    // Another thread might be creating the decryption round keys of the source while we copy,
+    // so we only copy the encryption round keys and the destination creates its own decryption 
+    // round keys when it needs them.
+    //
+    nRounds = pSrc->lastEncRoundKey - &pSrc->RoundKey[0];
+    memcpy( &pDst->RoundKey[0], &pSrc->RoundKey[0], (nRounds + 1) * SYMCRYPT_AES_BLOCK_SIZE );
+    pDst->lastEncRoundKey = &pDst->RoundKey[nRounds];
+    pDst->lastDecRoundKey = NULL;
+
+#if !(SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64)
+    //
+    // On these CPUs the decryption round keys are never created concurrently with another use of the key,
+    // see SymCryptAesExpandKeyEncryptOnly.
+    //
+    if( pSrc->lastDecRoundKey != NULL )
+    {
+        memcpy( &pDst->RoundKey[nRounds + 1], &pSrc->RoundKey[nRounds + 1], nRounds * SYMCRYPT_AES_BLOCK_SIZE );
+        pDst->lastDecRoundKey = &pDst->RoundKey[2*nRounds];
+    }
+#endif
 
     SYMCRYPT_SET_MAGIC( pDst );
 }
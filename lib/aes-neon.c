@@ -631,179 +631,37 @@ SymCryptAesEcbEncryptNeon(
 }
 #pragma warning( pop )
 
-#pragma warning(push)
-#pragma warning( disable:4701 ) // "Use of uninitialized variable"
-
-
-VOID
-SYMCRYPT_CALL
-SymCryptAesCtrMsb64Neon( 
-    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
-    _In_reads_( SYMCRYPT_AES_BLOCK_SIZE )   PBYTE                       pbChainingValue,
-    _In_reads_( cbData )                    PCBYTE                      pbSrc,
-    _Out_writes_( cbData )                  PBYTE                       pbDst,
-                                            SIZE_T                      cbData )
-{
-    __n128          chain = *(__n128 *)pbChainingValue;
-    const __n128 *  pSrc = (const __n128 *) pbSrc;
-    __n128 *        pDst = (__n128 *) pbDst;
-
-    __prefetch( &pSrc[0] );
-    __prefetch( &pSrc[2] );
-    __prefetch( &pSrc[4] );
-    __prefetch( &pSrc[6] );
-
-
-    // See section 6.7.8 of the C standard for details on this initializer usage.
-    const __n128 chainIncrement1 = (__n128) {.n128_u64 = {0, 1}};   // use {0,1} to initialize the n128_u64 element of the __n128 union.
-    const __n128 chainIncrement2 = (__n128) {.n128_u64 = {0, 2}};
-    const __n128 chainIncrement3 = (__n128) {.n128_u64 = {0, 3}};
-
-    __n128 c0, c1, c2, c3, c4, c5, c6, c7;
-
-    cbData &= ~(SYMCRYPT_AES_BLOCK_SIZE - 1);
-
-    // Our chain variable is in integer format, not the MSBfirst format loaded from memory.
-    chain = vrev64q_u8( chain );
-
-/*
-    while cbData >= 5 * block
-        generate 8 blocks of key stream
-        if cbData < 8 * block
-            break;
-        process 8 blocks
-    if cbData >= 5 * block
-        process 5-7 blocks
-        done
-    if cbData > 1 block
-        generate 4 blocks of key stream
-        process 2-4 blocks
-        done
-    if cbData >= 1 block
-        generate 1 block of key stream
-        process block
-*/
-    while( cbData >= 5 * SYMCRYPT_AES_BLOCK_SIZE )
-    {
-        c0 = chain;
-        c1 = vaddq_u64( chain, chainIncrement1 );
-        c2 = vaddq_u64( chain, chainIncrement2 );
-        c3 = vaddq_u64( c1, chainIncrement2 );
-        c4 = vaddq_u64( c2, chainIncrement2 );
-        c5 = vaddq_u64( c3, chainIncrement2 );
-        c6 = vaddq_u64( c4, chainIncrement2 );
-        c7 = vaddq_u64( c5, chainIncrement2 );
-        chain = vaddq_u64( c6, chainIncrement2 );
-
-        c0 = vrev64q_u8( c0 );
-        c1 = vrev64q_u8( c1 );
-        c2 = vrev64q_u8( c2 );
-        c3 = vrev64q_u8( c3 );
-        c4 = vrev64q_u8( c4 );
-        c5 = vrev64q_u8( c5 );
-        c6 = vrev64q_u8( c6 );
-        c7 = vrev64q_u8( c7 );
-
-        AES_ENCRYPT_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );
-
-        if( cbData < 8 * SYMCRYPT_AES_BLOCK_SIZE )
-        {
-            break;
-        }
-
-        pDst[0] = veorq_u64( pSrc[0], c0 ); __prefetch( &pSrc[ 8] );
-        pDst[1] = veorq_u64( pSrc[1], c1 ); 
-        pDst[2] = veorq_u64( pSrc[2], c2 ); __prefetch( &pSrc[10] );
-        pDst[3] = veorq_u64( pSrc[3], c3 );
-        pDst[4] = veorq_u64( pSrc[4], c4 ); __prefetch( &pSrc[12] );
-        pDst[5] = veorq_u64( pSrc[5], c5 );
-        pDst[6] = veorq_u64( pSrc[6], c6 ); __prefetch( &pSrc[14] );
-        pDst[7] = veorq_u64( pSrc[7], c7 );
-
-        pDst  += 8;
-        pSrc  += 8;
-        cbData -= 8 * SYMCRYPT_AES_BLOCK_SIZE;
-    }
-
-    //
-    // At this point we have one of the two following cases:
-    // - cbData >= 5 * 16 and we have 8 blocks of key stream in c0-c7. chain is set to c7 + 1
-    // - cbData < 5 * 16 and we have no blocks of key stream, with chain the next value to use
-    //
-
-    if( cbData >= SYMCRYPT_AES_BLOCK_SIZE ) // quick exit of function if the request was a multiple of 8 blocks
-    {
-        if( cbData >= 5 * SYMCRYPT_AES_BLOCK_SIZE )
-        {
-            //
-            // We already have the key stream
-            //
-            pDst[0] = veorq_u64( pSrc[0], c0 );
-            pDst[1] = veorq_u64( pSrc[1], c1 );
-            pDst[2] = veorq_u64( pSrc[2], c2 );
-            pDst[3] = veorq_u64( pSrc[3], c3 );
-            pDst[4] = veorq_u64( pSrc[4], c4 );
-            chain = vsubq_u64( chain, chainIncrement3 );
-
-            if( cbData >= 96 )
-            {
-            chain = vaddq_u64( chain, chainIncrement1 );
-            pDst[5] = veorq_u64( pSrc[5], c5 );
-                if( cbData >= 112 )
-                {
-            chain = vaddq_u64( chain, chainIncrement1 );
-            pDst[6] = veorq_u64( pSrc[6], c6 );
-                }
-            }
-        } 
-        else if( cbData >= 2 * SYMCRYPT_AES_BLOCK_SIZE )
-        {
-            // Produce 4 blocks of key stream
-
-            c0 = chain;
-            c1 = vaddq_u64( chain, chainIncrement1 );
-            c2 = vaddq_u64( chain, chainIncrement2 );
-            c3 = vaddq_u64( c1, chainIncrement2 );
-            chain = c2;             // chain is only incremented by 2 for now
-
-            c0 = vrev64q_u8( c0 );
-            c1 = vrev64q_u8( c1 );
-            c2 = vrev64q_u8( c2 );
-            c3 = vrev64q_u8( c3 );
-
-            AES_ENCRYPT_4( pExpandedKey, c0, c1, c2, c3 );
-
-            pDst[0] = veorq_u64( pSrc[0], c0 );
-            pDst[1] = veorq_u64( pSrc[1], c1 );
-            if( cbData >= 48 )
-            {
-            chain = vaddq_u64( chain, chainIncrement1 );
-            pDst[2] = veorq_u64( pSrc[2], c2 );
-                if( cbData >= 64 )
-                {
-            chain = vaddq_u64( chain, chainIncrement1 );
-            pDst[3] = veorq_u64( pSrc[3], c3 );
-                }
-            }
-        }
-        else 
-        {
-            // Exactly 1 block to process
-            c0 = chain;
-            chain = vaddq_u64( chain, chainIncrement1 );
-
-            c0 = vrev64q_u8( c0 );
-
-            AES_ENCRYPT_1( pExpandedKey, c0 );
-            pDst[0] = veorq_u64( pSrc[0], c0 );
-        }
-    }
-
-    chain = vrev64q_u8( chain );
-    *(__n128 *)pbChainingValue = chain;
-}
-
-#pragma warning(pop)
+//
+// The AES-CTR code is shared between the 64-bit and 32-bit counter versions.
+// See section 6.7.8 of the C standard for details on the initializer usage in CHAIN_INCREMENT_XX.
+//
+#define SYMCRYPT_AesCtrMsbXxNeon    SymCryptAesCtrMsb64Neon
+#define VADDQ_UXX                   vaddq_u64
+#define VSUBQ_UXX                   vsubq_u64
+#define VREVQ_U8_XX                 vrev64q_u8
+#define CHAIN_INCREMENT_XX( n )     ((__n128) {.n128_u64 = {0, n}})
+
+#include "aes-pattern.c"
+
+#undef CHAIN_INCREMENT_XX
+#undef VREVQ_U8_XX
+#undef VSUBQ_UXX
+#undef VADDQ_UXX
+#undef SYMCRYPT_AesCtrMsbXxNeon
+
+#define SYMCRYPT_AesCtrMsbXxNeon    SymCryptAesCtrMsb32Neon
+#define VADDQ_UXX                   vaddq_u32
+#define VSUBQ_UXX                   vsubq_u32
+#define VREVQ_U8_XX                 vrev32q_u8
+#define CHAIN_INCREMENT_XX( n )     ((__n128) {.n128_u32 = {0, 0, 0, n}})
+
+#include "aes-pattern.c"
+
+#undef CHAIN_INCREMENT_XX
+#undef VREVQ_U8_XX
+#undef VSUBQ_UXX
+#undef VADDQ_UXX
+#undef SYMCRYPT_AesCtrMsbXxNeon
 
 
 //
@@ -0,0 +1,366 @@
+//
+// aes-pattern.c
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+
+//
+// This is a file that is #included to define the AES-CTR functions.
+// The same code implements the CtrMsb64 and CtrMsb32 variants; the only difference
+// is the width of the counter addition, which determines where the carry stops.
+//
+// The including file defines
+//  SYMCRYPT_AesCtrMsbXxXmm     the name of the Xmm function to define, and
+//  MM_ADD_EPIXX, MM_SUB_EPIXX  the SSE2 lane-wise add and subtract for the counter width
+// or
+//  SYMCRYPT_AesCtrMsbXxNeon    the name of the Neon function to define, and
+//  VADDQ_UXX, VSUBQ_UXX        the Neon lane-wise add and subtract for the counter width
+//  VREVQ_U8_XX                 the byte reversal within each counter-width lane
+//  CHAIN_INCREMENT_XX( n )     a constant that increments the last counter lane by n
+//
+
+#if defined( SYMCRYPT_AesCtrMsbXxXmm )
+
+#pragma warning(push)
+#pragma warning( disable:4701 ) // "Use of uninitialized variable"
+
+VOID
+SYMCRYPT_CALL
+SYMCRYPT_AesCtrMsbXxXmm( 
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData )
+{
+    __m128i chain = _mm_loadu_si128( (__m128i *) pbChainingValue );
+
+    __m128i BYTE_REVERSE_ORDER = _mm_set_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
+
+    __m128i chainIncrement1 = _mm_set_epi32( 0, 0, 0, 1 );
+    __m128i chainIncrement2 = _mm_set_epi32( 0, 0, 0, 2 );
+    __m128i chainIncrement3 = _mm_set_epi32( 0, 0, 0, 3 );
+    //__m128i chainIncrement8 = _mm_set_epi32( 0, 0, 0, 8 );
+
+    __m128i c0, c1, c2, c3, c4, c5, c6, c7;
+
+    cbData &= ~(SYMCRYPT_AES_BLOCK_SIZE - 1);
+
+    chain = _mm_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+
+/*
+    while cbData >= 5 * block
+        generate 8 blocks of key stream
+        if cbData < 8 * block
+            break;
+        process 8 blocks
+    if cbData >= 5 * block
+        process 5-7 blocks
+        done
+    if cbData > 1 block
+        generate 4 blocks of key stream
+        process 2-4 blocks
+        done
+    if cbData >= 1 block
+        generate 1 block of key stream
+        process block
+*/
+    while( cbData >= 5 * SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        c0 = chain;
+        c1 = MM_ADD_EPIXX( chain, chainIncrement1 );
+        c2 = MM_ADD_EPIXX( chain, chainIncrement2 );
+        c3 = MM_ADD_EPIXX( c1, chainIncrement2 );
+        c4 = MM_ADD_EPIXX( c2, chainIncrement2 );
+        c5 = MM_ADD_EPIXX( c3, chainIncrement2 );
+        c6 = MM_ADD_EPIXX( c4, chainIncrement2 );
+        c7 = MM_ADD_EPIXX( c5, chainIncrement2 );
+        chain = MM_ADD_EPIXX( c6, chainIncrement2 );
+
+        c0 = _mm_shuffle_epi8( c0, BYTE_REVERSE_ORDER );
+        c1 = _mm_shuffle_epi8( c1, BYTE_REVERSE_ORDER );
+        c2 = _mm_shuffle_epi8( c2, BYTE_REVERSE_ORDER );
+        c3 = _mm_shuffle_epi8( c3, BYTE_REVERSE_ORDER );
+        c4 = _mm_shuffle_epi8( c4, BYTE_REVERSE_ORDER );
+        c5 = _mm_shuffle_epi8( c5, BYTE_REVERSE_ORDER );
+        c6 = _mm_shuffle_epi8( c6, BYTE_REVERSE_ORDER );
+        c7 = _mm_shuffle_epi8( c7, BYTE_REVERSE_ORDER );
+
+        AES_ENCRYPT_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );
+
+        if( cbData < 8 * SYMCRYPT_AES_BLOCK_SIZE )
+        {
+            break;
+        }
+
+        _mm_storeu_si128( (__m128i *) (pbDst +  0), _mm_xor_si128( c0, _mm_loadu_si128( ( __m128i * ) (pbSrc +  0 ) ) ) );
+        _mm_storeu_si128( (__m128i *) (pbDst + 16), _mm_xor_si128( c1, _mm_loadu_si128( ( __m128i * ) (pbSrc + 16 ) ) ) );
+        _mm_storeu_si128( (__m128i *) (pbDst + 32), _mm_xor_si128( c2, _mm_loadu_si128( ( __m128i * ) (pbSrc + 32 ) ) ) );
+        _mm_storeu_si128( (__m128i *) (pbDst + 48), _mm_xor_si128( c3, _mm_loadu_si128( ( __m128i * ) (pbSrc + 48 ) ) ) );
+        _mm_storeu_si128( (__m128i *) (pbDst + 64), _mm_xor_si128( c4, _mm_loadu_si128( ( __m128i * ) (pbSrc + 64 ) ) ) );
+        _mm_storeu_si128( (__m128i *) (pbDst + 80), _mm_xor_si128( c5, _mm_loadu_si128( ( __m128i * ) (pbSrc + 80 ) ) ) );
+        _mm_storeu_si128( (__m128i *) (pbDst + 96), _mm_xor_si128( c6, _mm_loadu_si128( ( __m128i * ) (pbSrc + 96 ) ) ) );
+        _mm_storeu_si128( (__m128i *) (pbDst +112), _mm_xor_si128( c7, _mm_loadu_si128( ( __m128i * ) (pbSrc +112 ) ) ) );
+        pbDst  += 8 * SYMCRYPT_AES_BLOCK_SIZE ;
+        pbSrc  += 8 * SYMCRYPT_AES_BLOCK_SIZE;
+        cbData -= 8 * SYMCRYPT_AES_BLOCK_SIZE;
+    }
+
+    //
+    // At this point we have one of the two following cases:
+    // - cbData >= 5 * 16 and we have 8 blocks of key stream in c0-c7. chain is set to c7 + 1
+    // - cbData < 5 * 16 and we have no blocks of key stream, with chain the next value to use
+    //
+
+    if( cbData >= SYMCRYPT_AES_BLOCK_SIZE ) // quick exit of function if the request was a multiple of 8 blocks
+    {
+        if( cbData >= 5 * SYMCRYPT_AES_BLOCK_SIZE )
+        {
+            //
+            // We already have the key stream
+            //
+            _mm_storeu_si128( (__m128i *) (pbDst +  0), _mm_xor_si128( c0, _mm_loadu_si128( ( __m128i * ) (pbSrc +  0 ) ) ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 16), _mm_xor_si128( c1, _mm_loadu_si128( ( __m128i * ) (pbSrc + 16 ) ) ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 32), _mm_xor_si128( c2, _mm_loadu_si128( ( __m128i * ) (pbSrc + 32 ) ) ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 48), _mm_xor_si128( c3, _mm_loadu_si128( ( __m128i * ) (pbSrc + 48 ) ) ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 64), _mm_xor_si128( c4, _mm_loadu_si128( ( __m128i * ) (pbSrc + 64 ) ) ) );
+            chain = MM_SUB_EPIXX( chain, chainIncrement3 );
+
+            if( cbData >= 96 )
+            {
+            chain = MM_ADD_EPIXX( chain, chainIncrement1 );
+            _mm_storeu_si128( (__m128i *) (pbDst + 80), _mm_xor_si128( c5, _mm_loadu_si128( ( __m128i * ) (pbSrc + 80 ) ) ) );
+                if( cbData >= 112 )
+                {
+            chain = MM_ADD_EPIXX( chain, chainIncrement1 );
+            _mm_storeu_si128( (__m128i *) (pbDst + 96), _mm_xor_si128( c6, _mm_loadu_si128( ( __m128i * ) (pbSrc + 96 ) ) ) );
+                }
+            }
+        } 
+        else if( cbData >= 2 * SYMCRYPT_AES_BLOCK_SIZE )
+        {
+            // Produce 4 blocks of key stream
+
+            c0 = chain;
+            c1 = MM_ADD_EPIXX( chain, chainIncrement1 );
+            c2 = MM_ADD_EPIXX( chain, chainIncrement2 );
+            c3 = MM_ADD_EPIXX( c1, chainIncrement2 );
+            chain = c2;             // chain is only incremented by 2 for now
+
+            c0 = _mm_shuffle_epi8( c0, BYTE_REVERSE_ORDER );
+            c1 = _mm_shuffle_epi8( c1, BYTE_REVERSE_ORDER );
+            c2 = _mm_shuffle_epi8( c2, BYTE_REVERSE_ORDER );
+            c3 = _mm_shuffle_epi8( c3, BYTE_REVERSE_ORDER );
+
+            AES_ENCRYPT_4( pExpandedKey, c0, c1, c2, c3 );
+
+            _mm_storeu_si128( (__m128i *) (pbDst +  0), _mm_xor_si128( c0, _mm_loadu_si128( ( __m128i * ) (pbSrc +  0 ) ) ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 16), _mm_xor_si128( c1, _mm_loadu_si128( ( __m128i * ) (pbSrc + 16 ) ) ) );
+            if( cbData >= 48 )
+            {
+            chain = MM_ADD_EPIXX( chain, chainIncrement1 );
+            _mm_storeu_si128( (__m128i *) (pbDst + 32), _mm_xor_si128( c2, _mm_loadu_si128( ( __m128i * ) (pbSrc + 32 ) ) ) );
+                if( cbData >= 64 )
+                {
+            chain = MM_ADD_EPIXX( chain, chainIncrement1 );
+            _mm_storeu_si128( (__m128i *) (pbDst + 48), _mm_xor_si128( c3, _mm_loadu_si128( ( __m128i * ) (pbSrc + 48 ) ) ) );
+                }
+            }
+        }
+        else 
+        {
+            // Exactly 1 block to process
+            c0 = chain;
+            chain = MM_ADD_EPIXX( chain, chainIncrement1 );
+
+            c0 = _mm_shuffle_epi8( c0, BYTE_REVERSE_ORDER );
+
+            AES_ENCRYPT_1( pExpandedKey, c0 );
+            _mm_storeu_si128( (__m128i *) (pbDst +  0), _mm_xor_si128( c0, _mm_loadu_si128( ( __m128i * ) (pbSrc +  0 ) ) ) );
+        }
+    }
+
+    chain = _mm_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+    _mm_storeu_si128( (__m128i *) pbChainingValue, chain );
+}
+
+#pragma warning(pop)
+
+#endif
+
+#if defined( SYMCRYPT_AesCtrMsbXxNeon )
+
+#pragma warning(push)
+#pragma warning( disable:4701 ) // "Use of uninitialized variable"
+
+
+VOID
+SYMCRYPT_CALL
+SYMCRYPT_AesCtrMsbXxNeon( 
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData )
+{
+    __n128          chain = *(__n128 *)pbChainingValue;
+    const __n128 *  pSrc = (const __n128 *) pbSrc;
+    __n128 *        pDst = (__n128 *) pbDst;
+
+    __prefetch( &pSrc[0] );
+    __prefetch( &pSrc[2] );
+    __prefetch( &pSrc[4] );
+    __prefetch( &pSrc[6] );
+
+
+    const __n128 chainIncrement1 = CHAIN_INCREMENT_XX( 1 );
+    const __n128 chainIncrement2 = CHAIN_INCREMENT_XX( 2 );
+    const __n128 chainIncrement3 = CHAIN_INCREMENT_XX( 3 );
+
+    __n128 c0, c1, c2, c3, c4, c5, c6, c7;
+
+    cbData &= ~(SYMCRYPT_AES_BLOCK_SIZE - 1);
+
+    // Our chain variable is in integer format, not the MSBfirst format loaded from memory.
+    chain = VREVQ_U8_XX( chain );
+
+/*
+    while cbData >= 5 * block
+        generate 8 blocks of key stream
+        if cbData < 8 * block
+            break;
+        process 8 blocks
+    if cbData >= 5 * block
+        process 5-7 blocks
+        done
+    if cbData > 1 block
+        generate 4 blocks of key stream
+        process 2-4 blocks
+        done
+    if cbData >= 1 block
+        generate 1 block of key stream
+        process block
+*/
+    while( cbData >= 5 * SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        c0 = chain;
+        c1 = VADDQ_UXX( chain, chainIncrement1 );
+        c2 = VADDQ_UXX( chain, chainIncrement2 );
+        c3 = VADDQ_UXX( c1, chainIncrement2 );
+        c4 = VADDQ_UXX( c2, chainIncrement2 );
+        c5 = VADDQ_UXX( c3, chainIncrement2 );
+        c6 = VADDQ_UXX( c4, chainIncrement2 );
+        c7 = VADDQ_UXX( c5, chainIncrement2 );
+        chain = VADDQ_UXX( c6, chainIncrement2 );
+
+        c0 = VREVQ_U8_XX( c0 );
+        c1 = VREVQ_U8_XX( c1 );
+        c2 = VREVQ_U8_XX( c2 );
+        c3 = VREVQ_U8_XX( c3 );
+        c4 = VREVQ_U8_XX( c4 );
+        c5 = VREVQ_U8_XX( c5 );
+        c6 = VREVQ_U8_XX( c6 );
+        c7 = VREVQ_U8_XX( c7 );
+
+        AES_ENCRYPT_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );
+
+        if( cbData < 8 * SYMCRYPT_AES_BLOCK_SIZE )
+        {
+            break;
+        }
+
+        pDst[0] = veorq_u64( pSrc[0], c0 ); __prefetch( &pSrc[ 8] );
+        pDst[1] = veorq_u64( pSrc[1], c1 ); 
+        pDst[2] = veorq_u64( pSrc[2], c2 ); __prefetch( &pSrc[10] );
+        pDst[3] = veorq_u64( pSrc[3], c3 );
+        pDst[4] = veorq_u64( pSrc[4], c4 ); __prefetch( &pSrc[12] );
+        pDst[5] = veorq_u64( pSrc[5], c5 );
+        pDst[6] = veorq_u64( pSrc[6], c6 ); __prefetch( &pSrc[14] );
+        pDst[7] = veorq_u64( pSrc[7], c7 );
+
+        pDst  += 8;
+        pSrc  += 8;
+        cbData -= 8 * SYMCRYPT_AES_BLOCK_SIZE;
+    }
+
+    //
+    // At this point we have one of the two following cases:
+    // - cbData >= 5 * 16 and we have 8 blocks of key stream in c0-c7. chain is set to c7 + 1
+    // - cbData < 5 * 16 and we have no blocks of key stream, with chain the next value to use
+    //
+
+    if( cbData >= SYMCRYPT_AES_BLOCK_SIZE ) // quick exit of function if the request was a multiple of 8 blocks
+    {
+        if( cbData >= 5 * SYMCRYPT_AES_BLOCK_SIZE )
+        {
+            //
+            // We already have the key stream
+            //
+            pDst[0] = veorq_u64( pSrc[0], c0 );
+            pDst[1] = veorq_u64( pSrc[1], c1 );
+            pDst[2] = veorq_u64( pSrc[2], c2 );
+            pDst[3] = veorq_u64( pSrc[3], c3 );
+            pDst[4] = veorq_u64( pSrc[4], c4 );
+            chain = VSUBQ_UXX( chain, chainIncrement3 );
+
+            if( cbData >= 96 )
+            {
+            chain = VADDQ_UXX( chain, chainIncrement1 );
+            pDst[5] = veorq_u64( pSrc[5], c5 );
+                if( cbData >= 112 )
+                {
+            chain = VADDQ_UXX( chain, chainIncrement1 );
+            pDst[6] = veorq_u64( pSrc[6], c6 );
+                }
+            }
+        } 
+        else if( cbData >= 2 * SYMCRYPT_AES_BLOCK_SIZE )
+        {
+            // Produce 4 blocks of key stream
+
+            c0 = chain;
+            c1 = VADDQ_UXX( chain, chainIncrement1 );
+            c2 = VADDQ_UXX( chain, chainIncrement2 );
+            c3 = VADDQ_UXX( c1, chainIncrement2 );
+            chain = c2;             // chain is only incremented by 2 for now
+
+            c0 = VREVQ_U8_XX( c0 );
+            c1 = VREVQ_U8_XX( c1 );
+            c2 = VREVQ_U8_XX( c2 );
+            c3 = VREVQ_U8_XX( c3 );
+
+            AES_ENCRYPT_4( pExpandedKey, c0, c1, c2, c3 );
+
+            pDst[0] = veorq_u64( pSrc[0], c0 );
+            pDst[1] = veorq_u64( pSrc[1], c1 );
+            if( cbData >= 48 )
+            {
+            chain = VADDQ_UXX( chain, chainIncrement1 );
+            pDst[2] = veorq_u64( pSrc[2], c2 );
+                if( cbData >= 64 )
+                {
+            chain = VADDQ_UXX( chain, chainIncrement1 );
+            pDst[3] = veorq_u64( pSrc[3], c3 );
+                }
+            }
+        }
+        else 
+        {
+            // Exactly 1 block to process
+            c0 = chain;
+            chain = VADDQ_UXX( chain, chainIncrement1 );
+
+            c0 = VREVQ_U8_XX( c0 );
+
+            AES_ENCRYPT_1( pExpandedKey, c0 );
+            pDst[0] = veorq_u64( pSrc[0], c0 );
+        }
+    }
+
+    chain = VREVQ_U8_XX( chain );
+    *(__n128 *)pbChainingValue = chain;
+}
+
+#pragma warning(pop)
+
+#endif
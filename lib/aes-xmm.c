@@ -7,6 +7,7 @@
 //
 
 #include "precomp.h"
+#include "ghash_definitions.h"
 
 #if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
 
@@ -468,6 +469,210 @@ SymCryptAesCbcEncryptXmm(
     _mm_storeu_si128( (__m128i *) pbChainingValue, c );
 }
 
+//
+// Encrypt 8 independent CBC chains in parallel.
+// Each CBC chain is serial, but 8 chains keep the AES pipeline full.
+//
+#define AES_CBC_LANE_XOR( j ) \
+    c##j = _mm_xor_si128( c##j, _mm_xor_si128( _mm_loadu_si128( (__m128i *) (pbSrc[j] + i) ), _mm_loadu_si128( (__m128i *) &pKey[j][0] ) ) )
+
+#define AES_CBC_LANE_ROUND( j, r ) \
+    c##j = _mm_aesenc_si128( c##j, _mm_loadu_si128( (__m128i *) &pKey[j][r] ) )
+
+#define AES_CBC_LANE_LAST( j, r ) \
+    c##j = _mm_aesenclast_si128( c##j, _mm_loadu_si128( (__m128i *) &pKey[j][r] ) ); \
+    _mm_storeu_si128( (__m128i *) (pbDst[j] + i), c##j )
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelAesCbcEncryptXmm(
+    _Inout_updates_( nLanes )   PSYMCRYPT_PARALLEL_AES_CBC_OPERATION    pLanes,
+                                SIZE_T                                  nLanes,
+                                SIZE_T                                  cbData )
+{
+    const BYTE (*pKey[8])[4][4];
+    PCBYTE  pbSrc[8];
+    PBYTE   pbDst[8];
+    PBYTE   pbChain[8];
+    SIZE_T  nRounds;
+    SIZE_T  i;
+    SIZE_T  j;
+    SIZE_T  r;
+    __m128i c0, c1, c2, c3, c4, c5, c6, c7;
+
+    SYMCRYPT_ASSERT( nLanes >= 1 && nLanes <= 8 );
+
+    //
+    // All lanes must use the same number of rounds.
+    // Unused lanes duplicate lane 0; they compute and store the same values as lane 0,
+    // which is harmless and avoids any per-lane branches in the inner loop.
+    //
+    nRounds = pLanes[0].pExpandedKey->lastEncRoundKey - &pLanes[0].pExpandedKey->RoundKey[0];
+
+    for( j=0; j<8; j++ )
+    {
+        PCSYMCRYPT_PARALLEL_AES_CBC_OPERATION pLane = &pLanes[ j < nLanes ? j : 0 ];
+
+        SYMCRYPT_ASSERT( (SIZE_T)(pLane->pExpandedKey->lastEncRoundKey - &pLane->pExpandedKey->RoundKey[0]) == nRounds );
+        pKey[j]     = &pLane->pExpandedKey->RoundKey[0];
+        pbSrc[j]    = pLane->pbSrc;
+        pbDst[j]    = pLane->pbDst;
+        pbChain[j]  = pLane->pbChainingValue;
+    }
+
+    c0 = _mm_loadu_si128( (__m128i *) pbChain[0] );
+    c1 = _mm_loadu_si128( (__m128i *) pbChain[1] );
+    c2 = _mm_loadu_si128( (__m128i *) pbChain[2] );
+    c3 = _mm_loadu_si128( (__m128i *) pbChain[3] );
+    c4 = _mm_loadu_si128( (__m128i *) pbChain[4] );
+    c5 = _mm_loadu_si128( (__m128i *) pbChain[5] );
+    c6 = _mm_loadu_si128( (__m128i *) pbChain[6] );
+    c7 = _mm_loadu_si128( (__m128i *) pbChain[7] );
+
+    for( i=0; i + SYMCRYPT_AES_BLOCK_SIZE <= cbData; i += SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        AES_CBC_LANE_XOR( 0 );
+        AES_CBC_LANE_XOR( 1 );
+        AES_CBC_LANE_XOR( 2 );
+        AES_CBC_LANE_XOR( 3 );
+        AES_CBC_LANE_XOR( 4 );
+        AES_CBC_LANE_XOR( 5 );
+        AES_CBC_LANE_XOR( 6 );
+        AES_CBC_LANE_XOR( 7 );
+
+        for( r=1; r<nRounds; r++ )
+        {
+            AES_CBC_LANE_ROUND( 0, r );
+            AES_CBC_LANE_ROUND( 1, r );
+            AES_CBC_LANE_ROUND( 2, r );
+            AES_CBC_LANE_ROUND( 3, r );
+            AES_CBC_LANE_ROUND( 4, r );
+            AES_CBC_LANE_ROUND( 5, r );
+            AES_CBC_LANE_ROUND( 6, r );
+            AES_CBC_LANE_ROUND( 7, r );
+        }
+
+        AES_CBC_LANE_LAST( 0, nRounds );
+        AES_CBC_LANE_LAST( 1, nRounds );
+        AES_CBC_LANE_LAST( 2, nRounds );
+        AES_CBC_LANE_LAST( 3, nRounds );
+        AES_CBC_LANE_LAST( 4, nRounds );
+        AES_CBC_LANE_LAST( 5, nRounds );
+        AES_CBC_LANE_LAST( 6, nRounds );
+        AES_CBC_LANE_LAST( 7, nRounds );
+    }
+
+    _mm_storeu_si128( (__m128i *) pbChain[0], c0 );
+    _mm_storeu_si128( (__m128i *) pbChain[1], c1 );
+    _mm_storeu_si128( (__m128i *) pbChain[2], c2 );
+    _mm_storeu_si128( (__m128i *) pbChain[3], c3 );
+    _mm_storeu_si128( (__m128i *) pbChain[4], c4 );
+    _mm_storeu_si128( (__m128i *) pbChain[5], c5 );
+    _mm_storeu_si128( (__m128i *) pbChain[6], c6 );
+    _mm_storeu_si128( (__m128i *) pbChain[7], c7 );
+
+    for( j=0; j<nLanes; j++ )
+    {
+        pLanes[j].pbSrc += i;
+        pLanes[j].pbDst += i;
+        pLanes[j].cbData -= i;
+    }
+}
+
+#define AES_CBC_MAC_LANE_LAST( j, r ) \
+    c##j = _mm_aesenclast_si128( c##j, _mm_loadu_si128( (__m128i *) &pKey[j][r] ) )
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelAesCbcMacXmm(
+    _Inout_updates_( nLanes )   PSYMCRYPT_PARALLEL_AES_CBC_OPERATION    pLanes,
+                                SIZE_T                                  nLanes,
+                                SIZE_T                                  cbData )
+{
+    const BYTE (*pKey[8])[4][4];
+    PCBYTE  pbSrc[8];
+    PBYTE   pbChain[8];
+    SIZE_T  nRounds;
+    SIZE_T  i;
+    SIZE_T  j;
+    SIZE_T  r;
+    __m128i c0, c1, c2, c3, c4, c5, c6, c7;
+
+    SYMCRYPT_ASSERT( nLanes >= 1 && nLanes <= 8 );
+
+    //
+    // Unused lanes duplicate lane 0, as in SymCryptParallelAesCbcEncryptXmm.
+    //
+    nRounds = pLanes[0].pExpandedKey->lastEncRoundKey - &pLanes[0].pExpandedKey->RoundKey[0];
+
+    for( j=0; j<8; j++ )
+    {
+        PCSYMCRYPT_PARALLEL_AES_CBC_OPERATION pLane = &pLanes[ j < nLanes ? j : 0 ];
+
+        SYMCRYPT_ASSERT( (SIZE_T)(pLane->pExpandedKey->lastEncRoundKey - &pLane->pExpandedKey->RoundKey[0]) == nRounds );
+        pKey[j]     = &pLane->pExpandedKey->RoundKey[0];
+        pbSrc[j]    = pLane->pbSrc;
+        pbChain[j]  = pLane->pbChainingValue;
+    }
+
+    c0 = _mm_loadu_si128( (__m128i *) pbChain[0] );
+    c1 = _mm_loadu_si128( (__m128i *) pbChain[1] );
+    c2 = _mm_loadu_si128( (__m128i *) pbChain[2] );
+    c3 = _mm_loadu_si128( (__m128i *) pbChain[3] );
+    c4 = _mm_loadu_si128( (__m128i *) pbChain[4] );
+    c5 = _mm_loadu_si128( (__m128i *) pbChain[5] );
+    c6 = _mm_loadu_si128( (__m128i *) pbChain[6] );
+    c7 = _mm_loadu_si128( (__m128i *) pbChain[7] );
+
+    for( i=0; i + SYMCRYPT_AES_BLOCK_SIZE <= cbData; i += SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        AES_CBC_LANE_XOR( 0 );
+        AES_CBC_LANE_XOR( 1 );
+        AES_CBC_LANE_XOR( 2 );
+        AES_CBC_LANE_XOR( 3 );
+        AES_CBC_LANE_XOR( 4 );
+        AES_CBC_LANE_XOR( 5 );
+        AES_CBC_LANE_XOR( 6 );
+        AES_CBC_LANE_XOR( 7 );
+
+        for( r=1; r<nRounds; r++ )
+        {
+            AES_CBC_LANE_ROUND( 0, r );
+            AES_CBC_LANE_ROUND( 1, r );
+            AES_CBC_LANE_ROUND( 2, r );
+            AES_CBC_LANE_ROUND( 3, r );
+            AES_CBC_LANE_ROUND( 4, r );
+            AES_CBC_LANE_ROUND( 5, r );
+            AES_CBC_LANE_ROUND( 6, r );
+            AES_CBC_LANE_ROUND( 7, r );
+        }
+
+        AES_CBC_MAC_LANE_LAST( 0, nRounds );
+        AES_CBC_MAC_LANE_LAST( 1, nRounds );
+        AES_CBC_MAC_LANE_LAST( 2, nRounds );
+        AES_CBC_MAC_LANE_LAST( 3, nRounds );
+        AES_CBC_MAC_LANE_LAST( 4, nRounds );
+        AES_CBC_MAC_LANE_LAST( 5, nRounds );
+        AES_CBC_MAC_LANE_LAST( 6, nRounds );
+        AES_CBC_MAC_LANE_LAST( 7, nRounds );
+    }
+
+    _mm_storeu_si128( (__m128i *) pbChain[0], c0 );
+    _mm_storeu_si128( (__m128i *) pbChain[1], c1 );
+    _mm_storeu_si128( (__m128i *) pbChain[2], c2 );
+    _mm_storeu_si128( (__m128i *) pbChain[3], c3 );
+    _mm_storeu_si128( (__m128i *) pbChain[4], c4 );
+    _mm_storeu_si128( (__m128i *) pbChain[5], c5 );
+    _mm_storeu_si128( (__m128i *) pbChain[6], c6 );
+    _mm_storeu_si128( (__m128i *) pbChain[7], c7 );
+
+    for( j=0; j<nLanes; j++ )
+    {
+        pLanes[j].pbSrc += i;
+        pLanes[j].cbData -= i;
+    }
+}
+
 #pragma warning( push )
 #pragma warning( disable: 6001 4701 ) // use of uninitialized values, but that is by designs
 VOID
@@ -648,173 +853,738 @@ SymCryptAesCbcMacXmm(
 
 }
 
+//
+// AES-CFB
+//
+// CFB encryption is serial; the Xmm code just avoids the per-block overhead of the generic code.
+// CFB decryption is parallel, as all the block cipher inputs are ciphertext values.
+// For the full-block (CFB128) mode we encrypt 8 blocks at a time.
+// For the 1-byte shift (CFB8) mode, the block cipher input for byte i is the 16 ciphertext bytes
+// preceding it, so we can also encrypt 8 inputs in parallel and produce 8 bytes at a time.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptAesCfbEncryptXmm(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+                                                SIZE_T                      cbShift,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData )
+{
+    __m128i chain = _mm_loadu_si128( (__m128i *) pbChainingValue );
+    __m128i c;
+    __m128i d;
+    BYTE    b;
+
+    SYMCRYPT_ASSERT( cbShift == 1 || cbShift == SYMCRYPT_AES_BLOCK_SIZE );
 
-#pragma warning(push)
-#pragma warning( disable:4701 ) // "Use of uninitialized variable"
+    if( cbShift == SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        while( cbData >= SYMCRYPT_AES_BLOCK_SIZE )
+        {
+            AES_ENCRYPT_1( pExpandedKey, chain );
+            d = _mm_loadu_si128( (__m128i *) pbSrc );
+            chain = _mm_xor_si128( chain, d );
+            _mm_storeu_si128( (__m128i *) pbDst, chain );
+
+            pbSrc += SYMCRYPT_AES_BLOCK_SIZE;
+            pbDst += SYMCRYPT_AES_BLOCK_SIZE;
+            cbData -= SYMCRYPT_AES_BLOCK_SIZE;
+        }
+    } else {
+        while( cbData > 0 )
+        {
+            c = chain;
+            AES_ENCRYPT_1( pExpandedKey, c );
+            b = *pbSrc ^ (BYTE) _mm_cvtsi128_si32( c );
+            *pbDst = b;
+
+            // Shift the chaining value one byte and append the ciphertext byte
+            chain = _mm_or_si128( _mm_srli_si128( chain, 1 ), _mm_slli_si128( _mm_cvtsi32_si128( b ), 15 ) );
+
+            pbSrc++;
+            pbDst++;
+            cbData--;
+        }
+    }
+
+    _mm_storeu_si128( (__m128i *) pbChainingValue, chain );
+}
 
 VOID
 SYMCRYPT_CALL
-SymCryptAesCtrMsb64Xmm( 
+SymCryptAesCfbDecryptXmm(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+                                                SIZE_T                      cbShift,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData )
+{
+    __m128i chain = _mm_loadu_si128( (__m128i *) pbChainingValue );
+    __m128i c0, c1, c2, c3, c4, c5, c6, c7;
+    __m128i d0, d1, d2, d3, d4, d5, d6, d7;
+    BYTE    b;
+
+    SYMCRYPT_ASSERT( cbShift == 1 || cbShift == SYMCRYPT_AES_BLOCK_SIZE );
+
+    if( cbShift == SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        while( cbData >= 8 * SYMCRYPT_AES_BLOCK_SIZE )
+        {
+            c0 = chain;
+            c1 = d0 = _mm_loadu_si128( (__m128i *) (pbSrc + 0 * SYMCRYPT_AES_BLOCK_SIZE ) );
+            c2 = d1 = _mm_loadu_si128( (__m128i *) (pbSrc + 1 * SYMCRYPT_AES_BLOCK_SIZE ) );
+            c3 = d2 = _mm_loadu_si128( (__m128i *) (pbSrc + 2 * SYMCRYPT_AES_BLOCK_SIZE ) );
+            c4 = d3 = _mm_loadu_si128( (__m128i *) (pbSrc + 3 * SYMCRYPT_AES_BLOCK_SIZE ) );
+            c5 = d4 = _mm_loadu_si128( (__m128i *) (pbSrc + 4 * SYMCRYPT_AES_BLOCK_SIZE ) );
+            c6 = d5 = _mm_loadu_si128( (__m128i *) (pbSrc + 5 * SYMCRYPT_AES_BLOCK_SIZE ) );
+            c7 = d6 = _mm_loadu_si128( (__m128i *) (pbSrc + 6 * SYMCRYPT_AES_BLOCK_SIZE ) );
+            chain = d7 = _mm_loadu_si128( (__m128i *) (pbSrc + 7 * SYMCRYPT_AES_BLOCK_SIZE ) );
+
+            AES_ENCRYPT_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );
+
+            _mm_storeu_si128( (__m128i *) (pbDst + 0 * SYMCRYPT_AES_BLOCK_SIZE ), _mm_xor_si128( c0, d0 ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 1 * SYMCRYPT_AES_BLOCK_SIZE ), _mm_xor_si128( c1, d1 ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 2 * SYMCRYPT_AES_BLOCK_SIZE ), _mm_xor_si128( c2, d2 ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 3 * SYMCRYPT_AES_BLOCK_SIZE ), _mm_xor_si128( c3, d3 ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 4 * SYMCRYPT_AES_BLOCK_SIZE ), _mm_xor_si128( c4, d4 ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 5 * SYMCRYPT_AES_BLOCK_SIZE ), _mm_xor_si128( c5, d5 ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 6 * SYMCRYPT_AES_BLOCK_SIZE ), _mm_xor_si128( c6, d6 ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 7 * SYMCRYPT_AES_BLOCK_SIZE ), _mm_xor_si128( c7, d7 ) );
+
+            pbSrc  += 8 * SYMCRYPT_AES_BLOCK_SIZE;
+            pbDst  += 8 * SYMCRYPT_AES_BLOCK_SIZE;
+            cbData -= 8 * SYMCRYPT_AES_BLOCK_SIZE;
+        }
+
+        if( cbData >= 4 * SYMCRYPT_AES_BLOCK_SIZE )
+        {
+            c0 = chain;
+            c1 = d0 = _mm_loadu_si128( (__m128i *) (pbSrc + 0 * SYMCRYPT_AES_BLOCK_SIZE ) );
+            c2 = d1 = _mm_loadu_si128( (__m128i *) (pbSrc + 1 * SYMCRYPT_AES_BLOCK_SIZE ) );
+            c3 = d2 = _mm_loadu_si128( (__m128i *) (pbSrc + 2 * SYMCRYPT_AES_BLOCK_SIZE ) );
+            chain = d3 = _mm_loadu_si128( (__m128i *) (pbSrc + 3 * SYMCRYPT_AES_BLOCK_SIZE ) );
+
+            AES_ENCRYPT_4( pExpandedKey, c0, c1, c2, c3 );
+
+            _mm_storeu_si128( (__m128i *) (pbDst + 0 * SYMCRYPT_AES_BLOCK_SIZE ), _mm_xor_si128( c0, d0 ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 1 * SYMCRYPT_AES_BLOCK_SIZE ), _mm_xor_si128( c1, d1 ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 2 * SYMCRYPT_AES_BLOCK_SIZE ), _mm_xor_si128( c2, d2 ) );
+            _mm_storeu_si128( (__m128i *) (pbDst + 3 * SYMCRYPT_AES_BLOCK_SIZE ), _mm_xor_si128( c3, d3 ) );
+
+            pbSrc  += 4 * SYMCRYPT_AES_BLOCK_SIZE;
+            pbDst  += 4 * SYMCRYPT_AES_BLOCK_SIZE;
+            cbData -= 4 * SYMCRYPT_AES_BLOCK_SIZE;
+        }
+
+        while( cbData >= SYMCRYPT_AES_BLOCK_SIZE )
+        {
+            c0 = chain;
+            chain = d0 = _mm_loadu_si128( (__m128i *) pbSrc );
+
+            AES_ENCRYPT_1( pExpandedKey, c0 );
+
+            _mm_storeu_si128( (__m128i *) pbDst, _mm_xor_si128( c0, d0 ) );
+
+            pbSrc  += SYMCRYPT_AES_BLOCK_SIZE;
+            pbDst  += SYMCRYPT_AES_BLOCK_SIZE;
+            cbData -= SYMCRYPT_AES_BLOCK_SIZE;
+        }
+    } else {
+        while( cbData >= 8 )
+        {
+            //
+            // The block cipher input for byte i is bytes i..i+15 of chain || ciphertext.
+            //
+            d0 = _mm_loadl_epi64( (__m128i *) pbSrc );
+
+            c0 = chain;
+            c1 = _mm_alignr_epi8( d0, chain, 1 );
+            c2 = _mm_alignr_epi8( d0, chain, 2 );
+            c3 = _mm_alignr_epi8( d0, chain, 3 );
+            c4 = _mm_alignr_epi8( d0, chain, 4 );
+            c5 = _mm_alignr_epi8( d0, chain, 5 );
+            c6 = _mm_alignr_epi8( d0, chain, 6 );
+            c7 = _mm_alignr_epi8( d0, chain, 7 );
+            chain = _mm_alignr_epi8( d0, chain, 8 );
+
+            AES_ENCRYPT_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );
+
+            //
+            // Gather the first byte of each result into the low 8 bytes of c0
+            //
+            c0 = _mm_unpacklo_epi8( c0, c1 );
+            c2 = _mm_unpacklo_epi8( c2, c3 );
+            c4 = _mm_unpacklo_epi8( c4, c5 );
+            c6 = _mm_unpacklo_epi8( c6, c7 );
+            c0 = _mm_unpacklo_epi16( c0, c2 );
+            c4 = _mm_unpacklo_epi16( c4, c6 );
+            c0 = _mm_unpacklo_epi32( c0, c4 );
+
+            _mm_storel_epi64( (__m128i *) pbDst, _mm_xor_si128( c0, d0 ) );
+
+            pbSrc  += 8;
+            pbDst  += 8;
+            cbData -= 8;
+        }
+
+        while( cbData > 0 )
+        {
+            c0 = chain;
+            AES_ENCRYPT_1( pExpandedKey, c0 );
+
+            b = *pbSrc;
+            *pbDst = b ^ (BYTE) _mm_cvtsi128_si32( c0 );
+
+            chain = _mm_or_si128( _mm_srli_si128( chain, 1 ), _mm_slli_si128( _mm_cvtsi32_si128( b ), 15 ) );
+
+            pbSrc++;
+            pbDst++;
+            cbData--;
+        }
+    }
+
+    _mm_storeu_si128( (__m128i *) pbChainingValue, chain );
+}
+
+
+//
+// The AES-CTR code is shared between the 64-bit and 32-bit counter versions.
+// The 32-bit version is used by GCM; the carry never propagates beyond the last 4 bytes,
+// independent of the (possibly secret) counter value.
+//
+#define SYMCRYPT_AesCtrMsbXxXmm     SymCryptAesCtrMsb64Xmm
+#define MM_ADD_EPIXX                _mm_add_epi64
+#define MM_SUB_EPIXX                _mm_sub_epi64
+
+#include "aes-pattern.c"
+
+#undef MM_SUB_EPIXX
+#undef MM_ADD_EPIXX
+#undef SYMCRYPT_AesCtrMsbXxXmm
+
+#define SYMCRYPT_AesCtrMsbXxXmm     SymCryptAesCtrMsb32Xmm
+#define MM_ADD_EPIXX                _mm_add_epi32
+#define MM_SUB_EPIXX                _mm_sub_epi32
+
+#include "aes-pattern.c"
+
+#undef MM_SUB_EPIXX
+#undef MM_ADD_EPIXX
+#undef SYMCRYPT_AesCtrMsbXxXmm
+
+//
+// AES-GCM stitched implementation
+//
+// AES-CTR and GHASH are both limited by the latency of a single instruction
+// (AESENC and PCLMULQDQ), and they use different execution units.
+// By interleaving the AES rounds of 8 counter blocks with the GHASH
+// multiply-accumulate of 8 data blocks we keep both units busy and
+// hide most of the GHASH cost.
+//
+// Like SymCryptGHashAppendDataPclmulqdq we aggregate 16 blocks with H^16, ..., H^1 and do
+// a single modulo reduction per 16 blocks. Each 16-block chunk is processed as two
+// halves of 8 AES blocks; the first half multiplies its data with H^16..H^9, the second
+// with H^8..H^1. Each of the first 8 AES rounds of a half is paired with one CLMUL_ACC_3.
+// All AES key sizes have at least 9 full rounds, so the GHASH work always fits inside the round loop.
+// The state is multiplied by H^16 on its own rather than xorred into the first data block;
+// that keeps the two halves identical at the cost of one extra multiplication per 16 blocks.
+//
+// The GHASH expanded key table must be in the PCLMULQDQ format; the callers
+// check the CPU features that guarantee this.
+//
+
+#define AES_GCM_STITCHED_CHUNK  (16 * SYMCRYPT_AES_BLOCK_SIZE)
+
+//
+// Generate the next 8 counter blocks from the (byte-reversed) chain value and
+// increment chain by 8. GCM uses a 32-bit counter, so only the last 32 bits are incremented.
+// Uses the BYTE_REVERSE_ORDER, chainIncrement1 and chainIncrement2 variables of the calling function.
+//
+#define AES_GCM_CTR_8( chain, c0, c1, c2, c3, c4, c5, c6, c7 ) \
+{ \
+    c0 = chain; \
+    c1 = _mm_add_epi32( chain, chainIncrement1 ); \
+    c2 = _mm_add_epi32( chain, chainIncrement2 ); \
+    c3 = _mm_add_epi32( c1, chainIncrement2 ); \
+    c4 = _mm_add_epi32( c2, chainIncrement2 ); \
+    c5 = _mm_add_epi32( c3, chainIncrement2 ); \
+    c6 = _mm_add_epi32( c4, chainIncrement2 ); \
+    c7 = _mm_add_epi32( c5, chainIncrement2 ); \
+    chain = _mm_add_epi32( c6, chainIncrement2 ); \
+\
+    c0 = _mm_shuffle_epi8( c0, BYTE_REVERSE_ORDER ); \
+    c1 = _mm_shuffle_epi8( c1, BYTE_REVERSE_ORDER ); \
+    c2 = _mm_shuffle_epi8( c2, BYTE_REVERSE_ORDER ); \
+    c3 = _mm_shuffle_epi8( c3, BYTE_REVERSE_ORDER ); \
+    c4 = _mm_shuffle_epi8( c4, BYTE_REVERSE_ORDER ); \
+    c5 = _mm_shuffle_epi8( c5, BYTE_REVERSE_ORDER ); \
+    c6 = _mm_shuffle_epi8( c6, BYTE_REVERSE_ORDER ); \
+    c7 = _mm_shuffle_epi8( c7, BYTE_REVERSE_ORDER ); \
+};
+
+#define AES_GCM_XOR_STORE_8( pbSrc, pbDst, c0, c1, c2, c3, c4, c5, c6, c7 ) \
+{ \
+    _mm_storeu_si128( (__m128i *) (pbDst +  0), _mm_xor_si128( c0, _mm_loadu_si128( ( __m128i * ) (pbSrc +  0 ) ) ) ); \
+    _mm_storeu_si128( (__m128i *) (pbDst + 16), _mm_xor_si128( c1, _mm_loadu_si128( ( __m128i * ) (pbSrc + 16 ) ) ) ); \
+    _mm_storeu_si128( (__m128i *) (pbDst + 32), _mm_xor_si128( c2, _mm_loadu_si128( ( __m128i * ) (pbSrc + 32 ) ) ) ); \
+    _mm_storeu_si128( (__m128i *) (pbDst + 48), _mm_xor_si128( c3, _mm_loadu_si128( ( __m128i * ) (pbSrc + 48 ) ) ) ); \
+    _mm_storeu_si128( (__m128i *) (pbDst + 64), _mm_xor_si128( c4, _mm_loadu_si128( ( __m128i * ) (pbSrc + 64 ) ) ) ); \
+    _mm_storeu_si128( (__m128i *) (pbDst + 80), _mm_xor_si128( c5, _mm_loadu_si128( ( __m128i * ) (pbSrc + 80 ) ) ) ); \
+    _mm_storeu_si128( (__m128i *) (pbDst + 96), _mm_xor_si128( c6, _mm_loadu_si128( ( __m128i * ) (pbSrc + 96 ) ) ) ); \
+    _mm_storeu_si128( (__m128i *) (pbDst +112), _mm_xor_si128( c7, _mm_loadu_si128( ( __m128i * ) (pbSrc +112 ) ) ) ); \
+};
+
+//
+// One full AES round on 8 blocks, using the keyPtr and roundkey variables of AES_ENCRYPT_8_GHASH_8
+//
+#define AES_GCM_ROUND_8( c0, c1, c2, c3, c4, c5, c6, c7 ) \
+{ \
+    roundkey = _mm_loadu_si128( (__m128i *) keyPtr ); \
+    keyPtr ++; \
+    c0 = _mm_aesenc_si128( c0, roundkey ); \
+    c1 = _mm_aesenc_si128( c1, roundkey ); \
+    c2 = _mm_aesenc_si128( c2, roundkey ); \
+    c3 = _mm_aesenc_si128( c3, roundkey ); \
+    c4 = _mm_aesenc_si128( c4, roundkey ); \
+    c5 = _mm_aesenc_si128( c5, roundkey ); \
+    c6 = _mm_aesenc_si128( c6, roundkey ); \
+    c7 = _mm_aesenc_si128( c7, roundkey ); \
+};
+
+//
+// One full AES round on 8 blocks, followed by a multiply-accumulate of data block i
+// with H^(nPower-i).
+//
+#define AES_GCM_ROUND_GHASH_STEP( c0, c1, c2, c3, c4, c5, c6, c7, pbGhashData, i, nPower, expandedKeyTable, resl, resm, resh ) \
+{ \
+    __m128i _ghData; \
+    AES_GCM_ROUND_8( c0, c1, c2, c3, c4, c5, c6, c7 ); \
+\
+    _ghData = _mm_loadu_si128( (__m128i *) ((pbGhashData) + 16*(i)) ); \
+    _ghData = _mm_shuffle_epi8( _ghData, BYTE_REVERSE_ORDER ); \
+    CLMUL_ACC_3( _ghData, expandedKeyTable[2*((nPower)-1-(i))].m128i, expandedKeyTable[2*((nPower)-1-(i)) + 1].m128i, resl, resm, resh ); \
+};
+
+//
+// Encrypt 8 counter blocks while accumulating the product of the 8 blocks of data at pbGhashData
+// and H^nPower, ..., H^(nPower-7) into resl, resm, resh. No reduction is done.
+//
+#define AES_ENCRYPT_8_GHASH_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7, pbGhashData, nPower, expandedKeyTable, resl, resm, resh ) \
+{ \
+    const BYTE (*keyPtr)[4][4]; \
+    const BYTE (*keyLimit)[4][4]; \
+    __m128i roundkey; \
+\
+    keyPtr = &pExpandedKey->RoundKey[0]; \
+    keyLimit = pExpandedKey->lastEncRoundKey; \
+\
+    roundkey = _mm_loadu_si128( (__m128i *) keyPtr ); \
+    keyPtr ++; \
+\
+    c0 = _mm_xor_si128( c0, roundkey ); \
+    c1 = _mm_xor_si128( c1, roundkey ); \
+    c2 = _mm_xor_si128( c2, roundkey ); \
+    c3 = _mm_xor_si128( c3, roundkey ); \
+    c4 = _mm_xor_si128( c4, roundkey ); \
+    c5 = _mm_xor_si128( c5, roundkey ); \
+    c6 = _mm_xor_si128( c6, roundkey ); \
+    c7 = _mm_xor_si128( c7, roundkey ); \
+\
+    AES_GCM_ROUND_GHASH_STEP( c0, c1, c2, c3, c4, c5, c6, c7, pbGhashData, 0, nPower, expandedKeyTable, resl, resm, resh ); \
+    AES_GCM_ROUND_GHASH_STEP( c0, c1, c2, c3, c4, c5, c6, c7, pbGhashData, 1, nPower, expandedKeyTable, resl, resm, resh ); \
+    AES_GCM_ROUND_GHASH_STEP( c0, c1, c2, c3, c4, c5, c6, c7, pbGhashData, 2, nPower, expandedKeyTable, resl, resm, resh ); \
+    AES_GCM_ROUND_GHASH_STEP( c0, c1, c2, c3, c4, c5, c6, c7, pbGhashData, 3, nPower, expandedKeyTable, resl, resm, resh ); \
+    AES_GCM_ROUND_GHASH_STEP( c0, c1, c2, c3, c4, c5, c6, c7, pbGhashData, 4, nPower, expandedKeyTable, resl, resm, resh ); \
+    AES_GCM_ROUND_GHASH_STEP( c0, c1, c2, c3, c4, c5, c6, c7, pbGhashData, 5, nPower, expandedKeyTable, resl, resm, resh ); \
+    AES_GCM_ROUND_GHASH_STEP( c0, c1, c2, c3, c4, c5, c6, c7, pbGhashData, 6, nPower, expandedKeyTable, resl, resm, resh ); \
+    AES_GCM_ROUND_GHASH_STEP( c0, c1, c2, c3, c4, c5, c6, c7, pbGhashData, 7, nPower, expandedKeyTable, resl, resm, resh ); \
+\
+    while( keyPtr < keyLimit ) \
+    { \
+        AES_GCM_ROUND_8( c0, c1, c2, c3, c4, c5, c6, c7 ); \
+    } \
+\
+    roundkey = _mm_loadu_si128( (__m128i *) keyPtr ); \
+\
+    c0 = _mm_aesenclast_si128( c0, roundkey ); \
+    c1 = _mm_aesenclast_si128( c1, roundkey ); \
+    c2 = _mm_aesenclast_si128( c2, roundkey ); \
+    c3 = _mm_aesenclast_si128( c3, roundkey ); \
+    c4 = _mm_aesenclast_si128( c4, roundkey ); \
+    c5 = _mm_aesenclast_si128( c5, roundkey ); \
+    c6 = _mm_aesenclast_si128( c6, roundkey ); \
+    c7 = _mm_aesenclast_si128( c7, roundkey ); \
+};
+
+//
+// Encrypt the 16 counter blocks of a chunk from pbSrc to pbDst while folding the 16 blocks of data at
+// pbGhashData into the GHASH state.
+//
+#define AES_GCM_STITCHED_CHUNK_16( pExpandedKey, chain, pbSrc, pbDst, pbGhashData, expandedKeyTable, state ) \
+{ \
+    __m128i _a0, _a1, _a2; \
+\
+    CLMUL_3( state, expandedKeyTable[30].m128i, expandedKeyTable[31].m128i, _a0, _a1, _a2 ); \
+\
+    AES_GCM_CTR_8( chain, c0, c1, c2, c3, c4, c5, c6, c7 ); \
+    AES_ENCRYPT_8_GHASH_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7, pbGhashData, 16, expandedKeyTable, _a0, _a1, _a2 ); \
+    AES_GCM_XOR_STORE_8( (pbSrc), (pbDst), c0, c1, c2, c3, c4, c5, c6, c7 ); \
+\
+    AES_GCM_CTR_8( chain, c0, c1, c2, c3, c4, c5, c6, c7 ); \
+    AES_ENCRYPT_8_GHASH_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7, (pbGhashData) + 8 * SYMCRYPT_AES_BLOCK_SIZE, 8, expandedKeyTable, _a0, _a1, _a2 ); \
+    AES_GCM_XOR_STORE_8( (pbSrc) + 8 * SYMCRYPT_AES_BLOCK_SIZE, (pbDst) + 8 * SYMCRYPT_AES_BLOCK_SIZE, c0, c1, c2, c3, c4, c5, c6, c7 ); \
+\
+    CLMUL_3_POST( _a0, _a1, _a2 ); \
+    MODREDUCE( _a0, _a1, _a2, state ); \
+};
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesGcmEncryptStitchedXmm(
     _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
-    _In_reads_( SYMCRYPT_AES_BLOCK_SIZE )   PBYTE                       pbChainingValue,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( SYMCRYPT_GF128_FIELD_SIZE ) PCSYMCRYPT_GF128_ELEMENT    expandedKeyTable,
+    _Inout_                                 PSYMCRYPT_GF128_ELEMENT     pState,
     _In_reads_( cbData )                    PCBYTE                      pbSrc,
     _Out_writes_( cbData )                  PBYTE                       pbDst,
                                             SIZE_T                      cbData )
 {
-    __m128i chain = _mm_loadu_si128( (__m128i *) pbChainingValue );
+    __m128i chain;
+    __m128i state;
+
+    __m128i BYTE_REVERSE_ORDER = _mm_set_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
+
+    __m128i chainIncrement1 = _mm_set_epi32( 0, 0, 0, 1 );
+    __m128i chainIncrement2 = _mm_set_epi32( 0, 0, 0, 2 );
+
+    __m128i c0, c1, c2, c3, c4, c5, c6, c7;
+
+    C_ASSERT( SYMCRYPT_GHASH_PCLMULQDQ_HPOWERS == 16 );
+
+    cbData &= ~(SYMCRYPT_AES_BLOCK_SIZE - 1);
+
+    if( cbData >= AES_GCM_STITCHED_CHUNK )
+    {
+        chain = _mm_loadu_si128( (__m128i *) pbChainingValue );
+        chain = _mm_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+        state = _mm_loadu_si128( (__m128i *) pState );
+
+        //
+        // The GHASH needs the ciphertext, so it runs one 16-block chunk behind the encryption.
+        // The first chunk is encrypted on its own.
+        //
+        AES_GCM_CTR_8( chain, c0, c1, c2, c3, c4, c5, c6, c7 );
+        AES_ENCRYPT_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );
+        AES_GCM_XOR_STORE_8( pbSrc, pbDst, c0, c1, c2, c3, c4, c5, c6, c7 );
+
+        AES_GCM_CTR_8( chain, c0, c1, c2, c3, c4, c5, c6, c7 );
+        AES_ENCRYPT_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );
+        AES_GCM_XOR_STORE_8( pbSrc + 8 * SYMCRYPT_AES_BLOCK_SIZE, pbDst + 8 * SYMCRYPT_AES_BLOCK_SIZE, c0, c1, c2, c3, c4, c5, c6, c7 );
+
+        pbSrc  += AES_GCM_STITCHED_CHUNK;
+        pbDst  += AES_GCM_STITCHED_CHUNK;
+        cbData -= AES_GCM_STITCHED_CHUNK;
+
+        while( cbData >= AES_GCM_STITCHED_CHUNK )
+        {
+            //
+            // We read back the ciphertext of the previous chunk from pbDst; 
+            // see the comment in SymCryptGcmEncryptPart on why this is safe.
+            //
+            AES_GCM_STITCHED_CHUNK_16( pExpandedKey, chain, pbSrc, pbDst, pbDst - AES_GCM_STITCHED_CHUNK, expandedKeyTable, state );
+
+            pbSrc  += AES_GCM_STITCHED_CHUNK;
+            pbDst  += AES_GCM_STITCHED_CHUNK;
+            cbData -= AES_GCM_STITCHED_CHUNK;
+        }
+
+        chain = _mm_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+        _mm_storeu_si128( (__m128i *) pbChainingValue, chain );
+        _mm_storeu_si128( (__m128i *) pState, state );
+
+        //
+        // GHASH of the last full chunk
+        //
+        SymCryptGHashAppendDataPclmulqdq( expandedKeyTable, pState, pbDst - AES_GCM_STITCHED_CHUNK, AES_GCM_STITCHED_CHUNK );
+    }
+
+    if( cbData > 0 )
+    {
+        //
+        // Fewer than 16 blocks left; the separate CTR and GHASH code handles these.
+        //
+        SymCryptAesCtrMsb32Xmm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+        SymCryptGHashAppendDataPclmulqdq( expandedKeyTable, pState, pbDst, cbData );
+    }
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesGcmDecryptStitchedXmm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( SYMCRYPT_GF128_FIELD_SIZE ) PCSYMCRYPT_GF128_ELEMENT    expandedKeyTable,
+    _Inout_                                 PSYMCRYPT_GF128_ELEMENT     pState,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData )
+{
+    __m128i chain;
+    __m128i state;
 
     __m128i BYTE_REVERSE_ORDER = _mm_set_epi8(
             0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
 
     __m128i chainIncrement1 = _mm_set_epi32( 0, 0, 0, 1 );
     __m128i chainIncrement2 = _mm_set_epi32( 0, 0, 0, 2 );
-    __m128i chainIncrement3 = _mm_set_epi32( 0, 0, 0, 3 );
-    //__m128i chainIncrement8 = _mm_set_epi32( 0, 0, 0, 8 );
 
     __m128i c0, c1, c2, c3, c4, c5, c6, c7;
 
+    C_ASSERT( SYMCRYPT_GHASH_PCLMULQDQ_HPOWERS == 16 );
+
     cbData &= ~(SYMCRYPT_AES_BLOCK_SIZE - 1);
 
+    if( cbData >= AES_GCM_STITCHED_CHUNK )
+    {
+        chain = _mm_loadu_si128( (__m128i *) pbChainingValue );
+        chain = _mm_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+        state = _mm_loadu_si128( (__m128i *) pState );
+
+        //
+        // The GHASH input is the ciphertext which we already have, so we process
+        // the same chunk in both computations.
+        // Each half reads its GHASH data from pbSrc before storing to the same half of pbDst,
+        // and the second half of pbSrc is not touched by the stores of the first half,
+        // so in-place decryption works.
+        //
+        while( cbData >= AES_GCM_STITCHED_CHUNK )
+        {
+            AES_GCM_STITCHED_CHUNK_16( pExpandedKey, chain, pbSrc, pbDst, pbSrc, expandedKeyTable, state );
+
+            pbSrc  += AES_GCM_STITCHED_CHUNK;
+            pbDst  += AES_GCM_STITCHED_CHUNK;
+            cbData -= AES_GCM_STITCHED_CHUNK;
+        }
+
+        chain = _mm_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+        _mm_storeu_si128( (__m128i *) pbChainingValue, chain );
+        _mm_storeu_si128( (__m128i *) pState, state );
+    }
+
+    if( cbData > 0 )
+    {
+        SymCryptGHashAppendDataPclmulqdq( expandedKeyTable, pState, pbSrc, cbData );
+        SymCryptAesCtrMsb32Xmm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    }
+}
+
+//
+// AES-CCM stitched implementation
+//
+// The CBC-MAC of CCM is a serial chain; each block has to wait for the full AES latency of
+// the previous one, which leaves the AES unit mostly idle. The CTR encryption of a block does
+// not depend on the chain, so we run its rounds alongside the MAC rounds and get the
+// encryption almost for free.
+// On decryption the MAC input is the plaintext, which needs the key stream first. There the
+// key stream of the next block is computed together with the MAC of the current block.
+//
+// Only one CTR block is paired with each MAC block. The chain latency limits the speed,
+// and computing key stream further ahead does not make the chain any shorter.
+// To shorten the chain we merge the XOR of the next data block and the first round key into
+// the last round key of the previous MAC block. AESENCLAST ends with an XOR of its key, so
+//      AESENCLAST( x, lastKey ) ^ data ^ firstKey == AESENCLAST( x, lastKey ^ data ^ firstKey )
+// and the chain consists of AES rounds only.
+//
+// CCM uses the 64-bit counter increment, like SymCryptAesCtrMsb64Xmm.
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCcmEncryptStitchedXmm(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbMacBlock,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData )
+{
+    const BYTE (*keyPtr)[4][4];
+    const BYTE (*keyLimit)[4][4] = pExpandedKey->lastEncRoundKey;
+
+    __m128i BYTE_REVERSE_ORDER = _mm_set_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
+
+    __m128i chainIncrement1 = _mm_set_epi32( 0, 0, 0, 1 );
+
+    __m128i firstRoundKey = _mm_loadu_si128( (__m128i *) &pExpandedKey->RoundKey[0] );
+    __m128i lastRoundKey = _mm_loadu_si128( (__m128i *) keyLimit );
+    __m128i roundkey;
+    __m128i chain;
+    __m128i mac;
+    __m128i c;
+    __m128i d;
+
+    if( cbData < SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        return;
+    }
+
+    chain = _mm_loadu_si128( (__m128i *) pbChainingValue );
     chain = _mm_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+    mac = _mm_loadu_si128( (__m128i *) pbMacBlock );
 
-/*
-    while cbData >= 5 * block
-        generate 8 blocks of key stream
-        if cbData < 8 * block
-            break;
-        process 8 blocks
-    if cbData >= 5 * block
-        process 5-7 blocks
-        done
-    if cbData > 1 block
-        generate 4 blocks of key stream
-        process 2-4 blocks
-        done
-    if cbData >= 1 block
-        generate 1 block of key stream
-        process block
-*/
-    while( cbData >= 5 * SYMCRYPT_AES_BLOCK_SIZE )
+    d = _mm_loadu_si128( (__m128i *) pbSrc );
+    mac = _mm_xor_si128( mac, _mm_xor_si128( d, firstRoundKey ) );
+
+#pragma warning( suppress: 4127 )       // conditional expression is constant
+    while( TRUE )
     {
-        c0 = chain;
-        c1 = _mm_add_epi64( chain, chainIncrement1 );
-        c2 = _mm_add_epi64( chain, chainIncrement2 );
-        c3 = _mm_add_epi64( c1, chainIncrement2 );
-        c4 = _mm_add_epi64( c2, chainIncrement2 );
-        c5 = _mm_add_epi64( c3, chainIncrement2 );
-        c6 = _mm_add_epi64( c4, chainIncrement2 );
-        c7 = _mm_add_epi64( c5, chainIncrement2 );
-        chain = _mm_add_epi64( c6, chainIncrement2 );
-
-        c0 = _mm_shuffle_epi8( c0, BYTE_REVERSE_ORDER );
-        c1 = _mm_shuffle_epi8( c1, BYTE_REVERSE_ORDER );
-        c2 = _mm_shuffle_epi8( c2, BYTE_REVERSE_ORDER );
-        c3 = _mm_shuffle_epi8( c3, BYTE_REVERSE_ORDER );
-        c4 = _mm_shuffle_epi8( c4, BYTE_REVERSE_ORDER );
-        c5 = _mm_shuffle_epi8( c5, BYTE_REVERSE_ORDER );
-        c6 = _mm_shuffle_epi8( c6, BYTE_REVERSE_ORDER );
-        c7 = _mm_shuffle_epi8( c7, BYTE_REVERSE_ORDER );
+        //
+        // mac has had its first round; d is the data block it contains.
+        //
+        c = _mm_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+        chain = _mm_add_epi64( chain, chainIncrement1 );
+        c = _mm_xor_si128( c, firstRoundKey );
 
-        AES_ENCRYPT_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );
+        keyPtr = &pExpandedKey->RoundKey[1];
+        while( keyPtr < keyLimit )
+        {
+            roundkey = _mm_loadu_si128( (__m128i *) keyPtr );
+            keyPtr ++;
+            mac = _mm_aesenc_si128( mac, roundkey );
+            c = _mm_aesenc_si128( c, roundkey );
+        }
+        c = _mm_aesenclast_si128( c, lastRoundKey );
 
-        if( cbData < 8 * SYMCRYPT_AES_BLOCK_SIZE )
+        _mm_storeu_si128( (__m128i *) pbDst, _mm_xor_si128( c, d ) );
+
+        pbSrc  += SYMCRYPT_AES_BLOCK_SIZE;
+        pbDst  += SYMCRYPT_AES_BLOCK_SIZE;
+        cbData -= SYMCRYPT_AES_BLOCK_SIZE;
+
+        if( cbData < SYMCRYPT_AES_BLOCK_SIZE )
         {
             break;
         }
 
-        _mm_storeu_si128( (__m128i *) (pbDst +  0), _mm_xor_si128( c0, _mm_loadu_si128( ( __m128i * ) (pbSrc +  0 ) ) ) );
-        _mm_storeu_si128( (__m128i *) (pbDst + 16), _mm_xor_si128( c1, _mm_loadu_si128( ( __m128i * ) (pbSrc + 16 ) ) ) );
-        _mm_storeu_si128( (__m128i *) (pbDst + 32), _mm_xor_si128( c2, _mm_loadu_si128( ( __m128i * ) (pbSrc + 32 ) ) ) );
-        _mm_storeu_si128( (__m128i *) (pbDst + 48), _mm_xor_si128( c3, _mm_loadu_si128( ( __m128i * ) (pbSrc + 48 ) ) ) );
-        _mm_storeu_si128( (__m128i *) (pbDst + 64), _mm_xor_si128( c4, _mm_loadu_si128( ( __m128i * ) (pbSrc + 64 ) ) ) );
-        _mm_storeu_si128( (__m128i *) (pbDst + 80), _mm_xor_si128( c5, _mm_loadu_si128( ( __m128i * ) (pbSrc + 80 ) ) ) );
-        _mm_storeu_si128( (__m128i *) (pbDst + 96), _mm_xor_si128( c6, _mm_loadu_si128( ( __m128i * ) (pbSrc + 96 ) ) ) );
-        _mm_storeu_si128( (__m128i *) (pbDst +112), _mm_xor_si128( c7, _mm_loadu_si128( ( __m128i * ) (pbSrc +112 ) ) ) );
-        pbDst  += 8 * SYMCRYPT_AES_BLOCK_SIZE ;
-        pbSrc  += 8 * SYMCRYPT_AES_BLOCK_SIZE;
-        cbData -= 8 * SYMCRYPT_AES_BLOCK_SIZE;
+        d = _mm_loadu_si128( (__m128i *) pbSrc );
+        mac = _mm_aesenclast_si128( mac, _mm_xor_si128( lastRoundKey, _mm_xor_si128( d, firstRoundKey ) ) );
+    }
+
+    mac = _mm_aesenclast_si128( mac, lastRoundKey );
+
+    chain = _mm_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+    _mm_storeu_si128( (__m128i *) pbChainingValue, chain );
+    _mm_storeu_si128( (__m128i *) pbMacBlock, mac );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCcmDecryptStitchedXmm(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbMacBlock,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData )
+{
+    const BYTE (*keyPtr)[4][4];
+    const BYTE (*keyLimit)[4][4] = pExpandedKey->lastEncRoundKey;
+
+    __m128i BYTE_REVERSE_ORDER = _mm_set_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
+
+    __m128i chainIncrement1 = _mm_set_epi32( 0, 0, 0, 1 );
+
+    __m128i firstRoundKey = _mm_loadu_si128( (__m128i *) &pExpandedKey->RoundKey[0] );
+    __m128i lastRoundKey = _mm_loadu_si128( (__m128i *) keyLimit );
+    __m128i roundkey;
+    __m128i chain;
+    __m128i mac;
+    __m128i c;
+    __m128i d;
+
+    if( cbData < SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        return;
     }
 
+    chain = _mm_loadu_si128( (__m128i *) pbChainingValue );
+    chain = _mm_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+    mac = _mm_loadu_si128( (__m128i *) pbMacBlock );
+
     //
-    // At this point we have one of the two following cases:
-    // - cbData >= 5 * 16 and we have 8 blocks of key stream in c0-c7. chain is set to c7 + 1
-    // - cbData < 5 * 16 and we have no blocks of key stream, with chain the next value to use
+    // The first block has no MAC work to pair with.
     //
+    c = _mm_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+    chain = _mm_add_epi64( chain, chainIncrement1 );
+    c = _mm_xor_si128( c, firstRoundKey );
 
-    if( cbData >= SYMCRYPT_AES_BLOCK_SIZE ) // quick exit of function if the request was a multiple of 8 blocks
+    keyPtr = &pExpandedKey->RoundKey[1];
+    while( keyPtr < keyLimit )
     {
-        if( cbData >= 5 * SYMCRYPT_AES_BLOCK_SIZE )
-        {
-            //
-            // We already have the key stream
-            //
-            _mm_storeu_si128( (__m128i *) (pbDst +  0), _mm_xor_si128( c0, _mm_loadu_si128( ( __m128i * ) (pbSrc +  0 ) ) ) );
-            _mm_storeu_si128( (__m128i *) (pbDst + 16), _mm_xor_si128( c1, _mm_loadu_si128( ( __m128i * ) (pbSrc + 16 ) ) ) );
-            _mm_storeu_si128( (__m128i *) (pbDst + 32), _mm_xor_si128( c2, _mm_loadu_si128( ( __m128i * ) (pbSrc + 32 ) ) ) );
-            _mm_storeu_si128( (__m128i *) (pbDst + 48), _mm_xor_si128( c3, _mm_loadu_si128( ( __m128i * ) (pbSrc + 48 ) ) ) );
-            _mm_storeu_si128( (__m128i *) (pbDst + 64), _mm_xor_si128( c4, _mm_loadu_si128( ( __m128i * ) (pbSrc + 64 ) ) ) );
-            chain = _mm_sub_epi64( chain, chainIncrement3 );
-
-            if( cbData >= 96 )
-            {
-            chain = _mm_add_epi64( chain, chainIncrement1 );
-            _mm_storeu_si128( (__m128i *) (pbDst + 80), _mm_xor_si128( c5, _mm_loadu_si128( ( __m128i * ) (pbSrc + 80 ) ) ) );
-                if( cbData >= 112 )
-                {
-            chain = _mm_add_epi64( chain, chainIncrement1 );
-            _mm_storeu_si128( (__m128i *) (pbDst + 96), _mm_xor_si128( c6, _mm_loadu_si128( ( __m128i * ) (pbSrc + 96 ) ) ) );
-                }
-            }
-        } 
-        else if( cbData >= 2 * SYMCRYPT_AES_BLOCK_SIZE )
-        {
-            // Produce 4 blocks of key stream
+        roundkey = _mm_loadu_si128( (__m128i *) keyPtr );
+        keyPtr ++;
+        c = _mm_aesenc_si128( c, roundkey );
+    }
+    c = _mm_aesenclast_si128( c, lastRoundKey );
 
-            c0 = chain;
-            c1 = _mm_add_epi64( chain, chainIncrement1 );
-            c2 = _mm_add_epi64( chain, chainIncrement2 );
-            c3 = _mm_add_epi64( c1, chainIncrement2 );
-            chain = c2;             // chain is only incremented by 2 for now
+    d = _mm_xor_si128( c, _mm_loadu_si128( (__m128i *) pbSrc ) );
+    _mm_storeu_si128( (__m128i *) pbDst, d );
 
-            c0 = _mm_shuffle_epi8( c0, BYTE_REVERSE_ORDER );
-            c1 = _mm_shuffle_epi8( c1, BYTE_REVERSE_ORDER );
-            c2 = _mm_shuffle_epi8( c2, BYTE_REVERSE_ORDER );
-            c3 = _mm_shuffle_epi8( c3, BYTE_REVERSE_ORDER );
+    pbSrc  += SYMCRYPT_AES_BLOCK_SIZE;
+    pbDst  += SYMCRYPT_AES_BLOCK_SIZE;
+    cbData -= SYMCRYPT_AES_BLOCK_SIZE;
 
-            AES_ENCRYPT_4( pExpandedKey, c0, c1, c2, c3 );
+    mac = _mm_xor_si128( mac, _mm_xor_si128( d, firstRoundKey ) );
 
-            _mm_storeu_si128( (__m128i *) (pbDst +  0), _mm_xor_si128( c0, _mm_loadu_si128( ( __m128i * ) (pbSrc +  0 ) ) ) );
-            _mm_storeu_si128( (__m128i *) (pbDst + 16), _mm_xor_si128( c1, _mm_loadu_si128( ( __m128i * ) (pbSrc + 16 ) ) ) );
-            if( cbData >= 48 )
-            {
-            chain = _mm_add_epi64( chain, chainIncrement1 );
-            _mm_storeu_si128( (__m128i *) (pbDst + 32), _mm_xor_si128( c2, _mm_loadu_si128( ( __m128i * ) (pbSrc + 32 ) ) ) );
-                if( cbData >= 64 )
-                {
-            chain = _mm_add_epi64( chain, chainIncrement1 );
-            _mm_storeu_si128( (__m128i *) (pbDst + 48), _mm_xor_si128( c3, _mm_loadu_si128( ( __m128i * ) (pbSrc + 48 ) ) ) );
-                }
-            }
-        }
-        else 
+    while( cbData >= SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        //
+        // mac has had its first round with the previous plaintext block.
+        //
+        c = _mm_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+        chain = _mm_add_epi64( chain, chainIncrement1 );
+        c = _mm_xor_si128( c, firstRoundKey );
+
+        keyPtr = &pExpandedKey->RoundKey[1];
+        while( keyPtr < keyLimit )
         {
-            // Exactly 1 block to process
-            c0 = chain;
-            chain = _mm_add_epi64( chain, chainIncrement1 );
+            roundkey = _mm_loadu_si128( (__m128i *) keyPtr );
+            keyPtr ++;
+            mac = _mm_aesenc_si128( mac, roundkey );
+            c = _mm_aesenc_si128( c, roundkey );
+        }
+        c = _mm_aesenclast_si128( c, lastRoundKey );
 
-            c0 = _mm_shuffle_epi8( c0, BYTE_REVERSE_ORDER );
+        d = _mm_xor_si128( c, _mm_loadu_si128( (__m128i *) pbSrc ) );
+        _mm_storeu_si128( (__m128i *) pbDst, d );
 
-            AES_ENCRYPT_1( pExpandedKey, c0 );
-            _mm_storeu_si128( (__m128i *) (pbDst +  0), _mm_xor_si128( c0, _mm_loadu_si128( ( __m128i * ) (pbSrc +  0 ) ) ) );
-        }
+        mac = _mm_aesenclast_si128( mac, _mm_xor_si128( lastRoundKey, _mm_xor_si128( d, firstRoundKey ) ) );
+
+        pbSrc  += SYMCRYPT_AES_BLOCK_SIZE;
+        pbDst  += SYMCRYPT_AES_BLOCK_SIZE;
+        cbData -= SYMCRYPT_AES_BLOCK_SIZE;
     }
 
+    keyPtr = &pExpandedKey->RoundKey[1];
+    while( keyPtr < keyLimit )
+    {
+        roundkey = _mm_loadu_si128( (__m128i *) keyPtr );
+        keyPtr ++;
+        mac = _mm_aesenc_si128( mac, roundkey );
+    }
+    mac = _mm_aesenclast_si128( mac, lastRoundKey );
+
     chain = _mm_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
     _mm_storeu_si128( (__m128i *) pbChainingValue, chain );
+    _mm_storeu_si128( (__m128i *) pbMacBlock, mac );
 }
 
-#pragma warning(pop)
-
 /*
     if( cbData >= 16 )
     {
@@ -1118,6 +1888,81 @@ SymCryptXtsAesDecryptDataUnitXmm(
 
 }
 
+//
+// Process 8 data units in parallel, one block of each data unit per iteration.
+// The 8 tweak sequences are independent, so the alpha multiplications run in parallel
+// rather than as one serial chain, and the AES pipeline does not drain at data unit boundaries.
+// Encryption and decryption differ only in the AES_ENCRYPT_8/AES_DECRYPT_8 macro passed as AesOp8.
+//
+#define XTS_AES_8_DATA_UNITS_XMM( AesOp8 ) \
+{\
+    __m128i t0, t1, t2, t3, t4, t5, t6, t7;\
+    __m128i c0, c1, c2, c3, c4, c5, c6, c7;\
+    __m128i XTS_ALPHA_MASK = _mm_set_epi32( 1, 1, 1, 0x87 );\
+    SIZE_T  i;\
+\
+    t0 = _mm_loadu_si128( (__m128i *) (pbTweakBlocks +   0 ) );\
+    t1 = _mm_loadu_si128( (__m128i *) (pbTweakBlocks +  16 ) );\
+    t2 = _mm_loadu_si128( (__m128i *) (pbTweakBlocks +  32 ) );\
+    t3 = _mm_loadu_si128( (__m128i *) (pbTweakBlocks +  48 ) );\
+    t4 = _mm_loadu_si128( (__m128i *) (pbTweakBlocks +  64 ) );\
+    t5 = _mm_loadu_si128( (__m128i *) (pbTweakBlocks +  80 ) );\
+    t6 = _mm_loadu_si128( (__m128i *) (pbTweakBlocks +  96 ) );\
+    t7 = _mm_loadu_si128( (__m128i *) (pbTweakBlocks + 112 ) );\
+\
+    for( i=0; i + SYMCRYPT_AES_BLOCK_SIZE <= cbDataUnit; i += SYMCRYPT_AES_BLOCK_SIZE )\
+    {\
+        c0 = _mm_xor_si128( t0, _mm_loadu_si128( ( __m128i * ) (pDataUnits[0].pbSrc + i) ) );\
+        c1 = _mm_xor_si128( t1, _mm_loadu_si128( ( __m128i * ) (pDataUnits[1].pbSrc + i) ) );\
+        c2 = _mm_xor_si128( t2, _mm_loadu_si128( ( __m128i * ) (pDataUnits[2].pbSrc + i) ) );\
+        c3 = _mm_xor_si128( t3, _mm_loadu_si128( ( __m128i * ) (pDataUnits[3].pbSrc + i) ) );\
+        c4 = _mm_xor_si128( t4, _mm_loadu_si128( ( __m128i * ) (pDataUnits[4].pbSrc + i) ) );\
+        c5 = _mm_xor_si128( t5, _mm_loadu_si128( ( __m128i * ) (pDataUnits[5].pbSrc + i) ) );\
+        c6 = _mm_xor_si128( t6, _mm_loadu_si128( ( __m128i * ) (pDataUnits[6].pbSrc + i) ) );\
+        c7 = _mm_xor_si128( t7, _mm_loadu_si128( ( __m128i * ) (pDataUnits[7].pbSrc + i) ) );\
+\
+        AesOp8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );\
+\
+        _mm_storeu_si128( (__m128i *) (pDataUnits[0].pbDst + i), _mm_xor_si128( c0, t0 ) );\
+        _mm_storeu_si128( (__m128i *) (pDataUnits[1].pbDst + i), _mm_xor_si128( c1, t1 ) );\
+        _mm_storeu_si128( (__m128i *) (pDataUnits[2].pbDst + i), _mm_xor_si128( c2, t2 ) );\
+        _mm_storeu_si128( (__m128i *) (pDataUnits[3].pbDst + i), _mm_xor_si128( c3, t3 ) );\
+        _mm_storeu_si128( (__m128i *) (pDataUnits[4].pbDst + i), _mm_xor_si128( c4, t4 ) );\
+        _mm_storeu_si128( (__m128i *) (pDataUnits[5].pbDst + i), _mm_xor_si128( c5, t5 ) );\
+        _mm_storeu_si128( (__m128i *) (pDataUnits[6].pbDst + i), _mm_xor_si128( c6, t6 ) );\
+        _mm_storeu_si128( (__m128i *) (pDataUnits[7].pbDst + i), _mm_xor_si128( c7, t7 ) );\
+\
+        XTS_MUL_ALPHA( t0, t0 );\
+        XTS_MUL_ALPHA( t1, t1 );\
+        XTS_MUL_ALPHA( t2, t2 );\
+        XTS_MUL_ALPHA( t3, t3 );\
+        XTS_MUL_ALPHA( t4, t4 );\
+        XTS_MUL_ALPHA( t5, t5 );\
+        XTS_MUL_ALPHA( t6, t6 );\
+        XTS_MUL_ALPHA( t7, t7 );\
+    }\
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptXtsAesEncrypt8DataUnitsXmm(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY     pExpandedKey,
+    _In_reads_( 8 * SYMCRYPT_AES_BLOCK_SIZE )   PCBYTE                          pbTweakBlocks,
+    _In_reads_( 8 )                             PCSYMCRYPT_XTS_AES_DATA_UNIT    pDataUnits,
+                                                SIZE_T                          cbDataUnit )
+XTS_AES_8_DATA_UNITS_XMM( AES_ENCRYPT_8 )
+
+VOID
+SYMCRYPT_CALL
+SymCryptXtsAesDecrypt8DataUnitsXmm(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY     pExpandedKey,
+    _In_reads_( 8 * SYMCRYPT_AES_BLOCK_SIZE )   PCBYTE                          pbTweakBlocks,
+    _In_reads_( 8 )                             PCSYMCRYPT_XTS_AES_DATA_UNIT    pDataUnits,
+                                                SIZE_T                          cbDataUnit )
+XTS_AES_8_DATA_UNITS_XMM( AES_DECRYPT_8 )
+
+#undef XTS_AES_8_DATA_UNITS_XMM
+
 
 
 #endif // CPU_X86 | CPU_AMD64
@@ -0,0 +1,168 @@
+//
+// aes-ymm-pattern.c
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+
+//
+// This is a file that is #included to define the VAES AES-CTR functions.
+// As in aes-pattern.c, the CtrMsb64 and CtrMsb32 variants differ only in the width
+// of the counter addition.
+// The increment constants only set the lowest 32 bits of each counter, so they work for both widths.
+//
+// The including file defines
+//  SYMCRYPT_AesCtrMsbXxYmm         the name of the Ymm function to define
+//  SYMCRYPT_AesCtrMsbXxZmm         the name of the Zmm function to define
+//  SYMCRYPT_AesCtrMsbXxXmm         the Xmm function that handles the tail of a Ymm request
+//  MM256_ADD_EPIXX, MM512_ADD_EPIXX    the lane-wise add for the counter width
+//
+
+VOID
+SYMCRYPT_CALL
+SYMCRYPT_AesCtrMsbXxYmm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData )
+{
+    __m256i chain;
+    __m256i c0, c1, c2, c3, c4, c5, c6, c7;
+
+    __m256i BYTE_REVERSE_ORDER = _mm256_set_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
+
+    //
+    // Each register holds two consecutive counter values; only the lower counter-width
+    // bits of each 128-bit lane are incremented.
+    //
+    __m256i chainIncrement2  = _mm256_set_epi64x( 0, 2, 0, 2 );
+    __m256i chainIncrement4  = _mm256_set_epi64x( 0, 4, 0, 4 );
+
+    chain = _mm256_broadcastsi128_si256( _mm_loadu_si128( (__m128i *) pbChainingValue ) );
+    chain = _mm256_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+    chain = MM256_ADD_EPIXX( chain, _mm256_set_epi64x( 0, 1, 0, 0 ) );
+
+    while( cbData >= 16 * SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        c0 = chain;
+        c1 = MM256_ADD_EPIXX( chain, chainIncrement2 );
+        c2 = MM256_ADD_EPIXX( chain, chainIncrement4 );
+        c3 = MM256_ADD_EPIXX( c1, chainIncrement4 );
+        c4 = MM256_ADD_EPIXX( c2, chainIncrement4 );
+        c5 = MM256_ADD_EPIXX( c3, chainIncrement4 );
+        c6 = MM256_ADD_EPIXX( c4, chainIncrement4 );
+        c7 = MM256_ADD_EPIXX( c5, chainIncrement4 );
+        chain = MM256_ADD_EPIXX( c6, chainIncrement4 );
+
+        c0 = _mm256_shuffle_epi8( c0, BYTE_REVERSE_ORDER );
+        c1 = _mm256_shuffle_epi8( c1, BYTE_REVERSE_ORDER );
+        c2 = _mm256_shuffle_epi8( c2, BYTE_REVERSE_ORDER );
+        c3 = _mm256_shuffle_epi8( c3, BYTE_REVERSE_ORDER );
+        c4 = _mm256_shuffle_epi8( c4, BYTE_REVERSE_ORDER );
+        c5 = _mm256_shuffle_epi8( c5, BYTE_REVERSE_ORDER );
+        c6 = _mm256_shuffle_epi8( c6, BYTE_REVERSE_ORDER );
+        c7 = _mm256_shuffle_epi8( c7, BYTE_REVERSE_ORDER );
+
+        AES_ENCRYPT_YMM_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );
+
+        _mm256_storeu_si256( (__m256i *) (pbDst +   0), _mm256_xor_si256( c0, _mm256_loadu_si256( (__m256i *) (pbSrc +   0 ) ) ) );
+        _mm256_storeu_si256( (__m256i *) (pbDst +  32), _mm256_xor_si256( c1, _mm256_loadu_si256( (__m256i *) (pbSrc +  32 ) ) ) );
+        _mm256_storeu_si256( (__m256i *) (pbDst +  64), _mm256_xor_si256( c2, _mm256_loadu_si256( (__m256i *) (pbSrc +  64 ) ) ) );
+        _mm256_storeu_si256( (__m256i *) (pbDst +  96), _mm256_xor_si256( c3, _mm256_loadu_si256( (__m256i *) (pbSrc +  96 ) ) ) );
+        _mm256_storeu_si256( (__m256i *) (pbDst + 128), _mm256_xor_si256( c4, _mm256_loadu_si256( (__m256i *) (pbSrc + 128 ) ) ) );
+        _mm256_storeu_si256( (__m256i *) (pbDst + 160), _mm256_xor_si256( c5, _mm256_loadu_si256( (__m256i *) (pbSrc + 160 ) ) ) );
+        _mm256_storeu_si256( (__m256i *) (pbDst + 192), _mm256_xor_si256( c6, _mm256_loadu_si256( (__m256i *) (pbSrc + 192 ) ) ) );
+        _mm256_storeu_si256( (__m256i *) (pbDst + 224), _mm256_xor_si256( c7, _mm256_loadu_si256( (__m256i *) (pbSrc + 224 ) ) ) );
+
+        pbSrc   += 16 * SYMCRYPT_AES_BLOCK_SIZE;
+        pbDst   += 16 * SYMCRYPT_AES_BLOCK_SIZE;
+        cbData  -= 16 * SYMCRYPT_AES_BLOCK_SIZE;
+    }
+
+    //
+    // The lower lane of chain holds the next counter value
+    //
+    chain = _mm256_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+    _mm_storeu_si128( (__m128i *) pbChainingValue, _mm256_castsi256_si128( chain ) );
+
+    if( cbData >= SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        SYMCRYPT_AesCtrMsbXxXmm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    }
+}
+
+VOID
+SYMCRYPT_CALL
+SYMCRYPT_AesCtrMsbXxZmm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData )
+{
+    __m512i chain;
+    __m512i c0, c1, c2, c3, c4, c5, c6, c7;
+
+    __m512i BYTE_REVERSE_ORDER = _mm512_broadcast_i32x4( _mm_set_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 ) );
+
+    //
+    // Each register holds four consecutive counter values; only the lower counter-width
+    // bits of each 128-bit lane are incremented.
+    //
+    __m512i chainIncrement4  = _mm512_set_epi64( 0, 4, 0, 4, 0, 4, 0, 4 );
+    __m512i chainIncrement8  = _mm512_set_epi64( 0, 8, 0, 8, 0, 8, 0, 8 );
+
+    chain = _mm512_broadcast_i32x4( _mm_loadu_si128( (__m128i *) pbChainingValue ) );
+    chain = _mm512_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+    chain = MM512_ADD_EPIXX( chain, _mm512_set_epi64( 0, 3, 0, 2, 0, 1, 0, 0 ) );
+
+    while( cbData >= 32 * SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        c0 = chain;
+        c1 = MM512_ADD_EPIXX( chain, chainIncrement4 );
+        c2 = MM512_ADD_EPIXX( chain, chainIncrement8 );
+        c3 = MM512_ADD_EPIXX( c1, chainIncrement8 );
+        c4 = MM512_ADD_EPIXX( c2, chainIncrement8 );
+        c5 = MM512_ADD_EPIXX( c3, chainIncrement8 );
+        c6 = MM512_ADD_EPIXX( c4, chainIncrement8 );
+        c7 = MM512_ADD_EPIXX( c5, chainIncrement8 );
+        chain = MM512_ADD_EPIXX( c6, chainIncrement8 );
+
+        c0 = _mm512_shuffle_epi8( c0, BYTE_REVERSE_ORDER );
+        c1 = _mm512_shuffle_epi8( c1, BYTE_REVERSE_ORDER );
+        c2 = _mm512_shuffle_epi8( c2, BYTE_REVERSE_ORDER );
+        c3 = _mm512_shuffle_epi8( c3, BYTE_REVERSE_ORDER );
+        c4 = _mm512_shuffle_epi8( c4, BYTE_REVERSE_ORDER );
+        c5 = _mm512_shuffle_epi8( c5, BYTE_REVERSE_ORDER );
+        c6 = _mm512_shuffle_epi8( c6, BYTE_REVERSE_ORDER );
+        c7 = _mm512_shuffle_epi8( c7, BYTE_REVERSE_ORDER );
+
+        AES_ENCRYPT_ZMM_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );
+
+        _mm512_storeu_si512( pbDst +   0, _mm512_xor_si512( c0, _mm512_loadu_si512( pbSrc +   0 ) ) );
+        _mm512_storeu_si512( pbDst +  64, _mm512_xor_si512( c1, _mm512_loadu_si512( pbSrc +  64 ) ) );
+        _mm512_storeu_si512( pbDst + 128, _mm512_xor_si512( c2, _mm512_loadu_si512( pbSrc + 128 ) ) );
+        _mm512_storeu_si512( pbDst + 192, _mm512_xor_si512( c3, _mm512_loadu_si512( pbSrc + 192 ) ) );
+        _mm512_storeu_si512( pbDst + 256, _mm512_xor_si512( c4, _mm512_loadu_si512( pbSrc + 256 ) ) );
+        _mm512_storeu_si512( pbDst + 320, _mm512_xor_si512( c5, _mm512_loadu_si512( pbSrc + 320 ) ) );
+        _mm512_storeu_si512( pbDst + 384, _mm512_xor_si512( c6, _mm512_loadu_si512( pbSrc + 384 ) ) );
+        _mm512_storeu_si512( pbDst + 448, _mm512_xor_si512( c7, _mm512_loadu_si512( pbSrc + 448 ) ) );
+
+        pbSrc   += 32 * SYMCRYPT_AES_BLOCK_SIZE;
+        pbDst   += 32 * SYMCRYPT_AES_BLOCK_SIZE;
+        cbData  -= 32 * SYMCRYPT_AES_BLOCK_SIZE;
+    }
+
+    //
+    // The lowest lane of chain holds the next counter value
+    //
+    chain = _mm512_shuffle_epi8( chain, BYTE_REVERSE_ORDER );
+    _mm_storeu_si128( (__m128i *) pbChainingValue, _mm512_castsi512_si128( chain ) );
+
+    if( cbData >= SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        SYMCRYPT_AesCtrMsbXxYmm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    }
+}
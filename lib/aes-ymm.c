@@ -0,0 +1,473 @@
+//
+// aes-ymm.c   code for AES implementation
+//
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+// All VAES code for AES operations, using YMM (256-bit) and ZMM (512-bit) registers.
+// Each register holds 2 (YMM) or 4 (ZMM) independent AES blocks, so the 8-register loops
+// process 16 or 32 blocks per iteration.
+// The tail of each request that does not fill a full iteration is handled by the XMM code.
+//
+// This code is only used on AMD64; the x86 platform has too few registers, and the
+// wide register state is too expensive to save in the environments that need it.
+//
+
+#include "precomp.h"
+
+#if SYMCRYPT_CPU_AMD64
+
+//
+// Round loops for 8 YMM registers
+//
+#define AES_ENCRYPT_YMM_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 ) \
+{ \
+    const BYTE (*keyPtr)[4][4]; \
+    const BYTE (*keyLimit)[4][4]; \
+    __m256i roundkey; \
+\
+    keyPtr = &pExpandedKey->RoundKey[0]; \
+    keyLimit = pExpandedKey->lastEncRoundKey; \
+\
+    roundkey = _mm256_broadcastsi128_si256( _mm_loadu_si128( (__m128i *) keyPtr ) ); \
+    keyPtr ++; \
+\
+    c0 = _mm256_xor_si256( c0, roundkey ); \
+    c1 = _mm256_xor_si256( c1, roundkey ); \
+    c2 = _mm256_xor_si256( c2, roundkey ); \
+    c3 = _mm256_xor_si256( c3, roundkey ); \
+    c4 = _mm256_xor_si256( c4, roundkey ); \
+    c5 = _mm256_xor_si256( c5, roundkey ); \
+    c6 = _mm256_xor_si256( c6, roundkey ); \
+    c7 = _mm256_xor_si256( c7, roundkey ); \
+\
+    while( keyPtr < keyLimit ) \
+    { \
+        roundkey = _mm256_broadcastsi128_si256( _mm_loadu_si128( (__m128i *) keyPtr ) ); \
+        keyPtr ++; \
+        c0 = _mm256_aesenc_epi128( c0, roundkey ); \
+        c1 = _mm256_aesenc_epi128( c1, roundkey ); \
+        c2 = _mm256_aesenc_epi128( c2, roundkey ); \
+        c3 = _mm256_aesenc_epi128( c3, roundkey ); \
+        c4 = _mm256_aesenc_epi128( c4, roundkey ); \
+        c5 = _mm256_aesenc_epi128( c5, roundkey ); \
+        c6 = _mm256_aesenc_epi128( c6, roundkey ); \
+        c7 = _mm256_aesenc_epi128( c7, roundkey ); \
+    } \
+\
+    roundkey = _mm256_broadcastsi128_si256( _mm_loadu_si128( (__m128i *) keyPtr ) ); \
+\
+    c0 = _mm256_aesenclast_epi128( c0, roundkey ); \
+    c1 = _mm256_aesenclast_epi128( c1, roundkey ); \
+    c2 = _mm256_aesenclast_epi128( c2, roundkey ); \
+    c3 = _mm256_aesenclast_epi128( c3, roundkey ); \
+    c4 = _mm256_aesenclast_epi128( c4, roundkey ); \
+    c5 = _mm256_aesenclast_epi128( c5, roundkey ); \
+    c6 = _mm256_aesenclast_epi128( c6, roundkey ); \
+    c7 = _mm256_aesenclast_epi128( c7, roundkey ); \
+};
+
+#define AES_DECRYPT_YMM_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 ) \
+{ \
+    const BYTE (*keyPtr)[4][4]; \
+    const BYTE (*keyLimit)[4][4]; \
+    __m256i roundkey; \
+\
+    keyPtr = pExpandedKey->lastEncRoundKey; \
+    keyLimit = pExpandedKey->lastDecRoundKey; \
+\
+    roundkey = _mm256_broadcastsi128_si256( _mm_loadu_si128( (__m128i *) keyPtr ) ); \
+    keyPtr ++; \
+\
+    c0 = _mm256_xor_si256( c0, roundkey ); \
+    c1 = _mm256_xor_si256( c1, roundkey ); \
+    c2 = _mm256_xor_si256( c2, roundkey ); \
+    c3 = _mm256_xor_si256( c3, roundkey ); \
+    c4 = _mm256_xor_si256( c4, roundkey ); \
+    c5 = _mm256_xor_si256( c5, roundkey ); \
+    c6 = _mm256_xor_si256( c6, roundkey ); \
+    c7 = _mm256_xor_si256( c7, roundkey ); \
+\
+    while( keyPtr < keyLimit ) \
+    { \
+        roundkey = _mm256_broadcastsi128_si256( _mm_loadu_si128( (__m128i *) keyPtr ) ); \
+        keyPtr ++; \
+        c0 = _mm256_aesdec_epi128( c0, roundkey ); \
+        c1 = _mm256_aesdec_epi128( c1, roundkey ); \
+        c2 = _mm256_aesdec_epi128( c2, roundkey ); \
+        c3 = _mm256_aesdec_epi128( c3, roundkey ); \
+        c4 = _mm256_aesdec_epi128( c4, roundkey ); \
+        c5 = _mm256_aesdec_epi128( c5, roundkey ); \
+        c6 = _mm256_aesdec_epi128( c6, roundkey ); \
+        c7 = _mm256_aesdec_epi128( c7, roundkey ); \
+    } \
+\
+    roundkey = _mm256_broadcastsi128_si256( _mm_loadu_si128( (__m128i *) keyPtr ) ); \
+\
+    c0 = _mm256_aesdeclast_epi128( c0, roundkey ); \
+    c1 = _mm256_aesdeclast_epi128( c1, roundkey ); \
+    c2 = _mm256_aesdeclast_epi128( c2, roundkey ); \
+    c3 = _mm256_aesdeclast_epi128( c3, roundkey ); \
+    c4 = _mm256_aesdeclast_epi128( c4, roundkey ); \
+    c5 = _mm256_aesdeclast_epi128( c5, roundkey ); \
+    c6 = _mm256_aesdeclast_epi128( c6, roundkey ); \
+    c7 = _mm256_aesdeclast_epi128( c7, roundkey ); \
+};
+
+//
+// Round loops for 8 ZMM registers
+//
+#define AES_ENCRYPT_ZMM_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 ) \
+{ \
+    const BYTE (*keyPtr)[4][4]; \
+    const BYTE (*keyLimit)[4][4]; \
+    __m512i roundkey; \
+\
+    keyPtr = &pExpandedKey->RoundKey[0]; \
+    keyLimit = pExpandedKey->lastEncRoundKey; \
+\
+    roundkey = _mm512_broadcast_i32x4( _mm_loadu_si128( (__m128i *) keyPtr ) ); \
+    keyPtr ++; \
+\
+    c0 = _mm512_xor_si512( c0, roundkey ); \
+    c1 = _mm512_xor_si512( c1, roundkey ); \
+    c2 = _mm512_xor_si512( c2, roundkey ); \
+    c3 = _mm512_xor_si512( c3, roundkey ); \
+    c4 = _mm512_xor_si512( c4, roundkey ); \
+    c5 = _mm512_xor_si512( c5, roundkey ); \
+    c6 = _mm512_xor_si512( c6, roundkey ); \
+    c7 = _mm512_xor_si512( c7, roundkey ); \
+\
+    while( keyPtr < keyLimit ) \
+    { \
+        roundkey = _mm512_broadcast_i32x4( _mm_loadu_si128( (__m128i *) keyPtr ) ); \
+        keyPtr ++; \
+        c0 = _mm512_aesenc_epi128( c0, roundkey ); \
+        c1 = _mm512_aesenc_epi128( c1, roundkey ); \
+        c2 = _mm512_aesenc_epi128( c2, roundkey ); \
+        c3 = _mm512_aesenc_epi128( c3, roundkey ); \
+        c4 = _mm512_aesenc_epi128( c4, roundkey ); \
+        c5 = _mm512_aesenc_epi128( c5, roundkey ); \
+        c6 = _mm512_aesenc_epi128( c6, roundkey ); \
+        c7 = _mm512_aesenc_epi128( c7, roundkey ); \
+    } \
+\
+    roundkey = _mm512_broadcast_i32x4( _mm_loadu_si128( (__m128i *) keyPtr ) ); \
+\
+    c0 = _mm512_aesenclast_epi128( c0, roundkey ); \
+    c1 = _mm512_aesenclast_epi128( c1, roundkey ); \
+    c2 = _mm512_aesenclast_epi128( c2, roundkey ); \
+    c3 = _mm512_aesenclast_epi128( c3, roundkey ); \
+    c4 = _mm512_aesenclast_epi128( c4, roundkey ); \
+    c5 = _mm512_aesenclast_epi128( c5, roundkey ); \
+    c6 = _mm512_aesenclast_epi128( c6, roundkey ); \
+    c7 = _mm512_aesenclast_epi128( c7, roundkey ); \
+};
+
+#define AES_DECRYPT_ZMM_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 ) \
+{ \
+    const BYTE (*keyPtr)[4][4]; \
+    const BYTE (*keyLimit)[4][4]; \
+    __m512i roundkey; \
+\
+    keyPtr = pExpandedKey->lastEncRoundKey; \
+    keyLimit = pExpandedKey->lastDecRoundKey; \
+\
+    roundkey = _mm512_broadcast_i32x4( _mm_loadu_si128( (__m128i *) keyPtr ) ); \
+    keyPtr ++; \
+\
+    c0 = _mm512_xor_si512( c0, roundkey ); \
+    c1 = _mm512_xor_si512( c1, roundkey ); \
+    c2 = _mm512_xor_si512( c2, roundkey ); \
+    c3 = _mm512_xor_si512( c3, roundkey ); \
+    c4 = _mm512_xor_si512( c4, roundkey ); \
+    c5 = _mm512_xor_si512( c5, roundkey ); \
+    c6 = _mm512_xor_si512( c6, roundkey ); \
+    c7 = _mm512_xor_si512( c7, roundkey ); \
+\
+    while( keyPtr < keyLimit ) \
+    { \
+        roundkey = _mm512_broadcast_i32x4( _mm_loadu_si128( (__m128i *) keyPtr ) ); \
+        keyPtr ++; \
+        c0 = _mm512_aesdec_epi128( c0, roundkey ); \
+        c1 = _mm512_aesdec_epi128( c1, roundkey ); \
+        c2 = _mm512_aesdec_epi128( c2, roundkey ); \
+        c3 = _mm512_aesdec_epi128( c3, roundkey ); \
+        c4 = _mm512_aesdec_epi128( c4, roundkey ); \
+        c5 = _mm512_aesdec_epi128( c5, roundkey ); \
+        c6 = _mm512_aesdec_epi128( c6, roundkey ); \
+        c7 = _mm512_aesdec_epi128( c7, roundkey ); \
+    } \
+\
+    roundkey = _mm512_broadcast_i32x4( _mm_loadu_si128( (__m128i *) keyPtr ) ); \
+\
+    c0 = _mm512_aesdeclast_epi128( c0, roundkey ); \
+    c1 = _mm512_aesdeclast_epi128( c1, roundkey ); \
+    c2 = _mm512_aesdeclast_epi128( c2, roundkey ); \
+    c3 = _mm512_aesdeclast_epi128( c3, roundkey ); \
+    c4 = _mm512_aesdeclast_epi128( c4, roundkey ); \
+    c5 = _mm512_aesdeclast_epi128( c5, roundkey ); \
+    c6 = _mm512_aesdeclast_epi128( c6, roundkey ); \
+    c7 = _mm512_aesdeclast_epi128( c7, roundkey ); \
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+// YMM (256-bit VAES) implementations
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesEcbEncryptYmm(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData )
+{
+    __m256i c0, c1, c2, c3, c4, c5, c6, c7;
+
+    while( cbData >= 16 * SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        c0 = _mm256_loadu_si256( (__m256i *) (pbSrc +   0 ) );
+        c1 = _mm256_loadu_si256( (__m256i *) (pbSrc +  32 ) );
+        c2 = _mm256_loadu_si256( (__m256i *) (pbSrc +  64 ) );
+        c3 = _mm256_loadu_si256( (__m256i *) (pbSrc +  96 ) );
+        c4 = _mm256_loadu_si256( (__m256i *) (pbSrc + 128 ) );
+        c5 = _mm256_loadu_si256( (__m256i *) (pbSrc + 160 ) );
+        c6 = _mm256_loadu_si256( (__m256i *) (pbSrc + 192 ) );
+        c7 = _mm256_loadu_si256( (__m256i *) (pbSrc + 224 ) );
+
+        AES_ENCRYPT_YMM_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );
+
+        _mm256_storeu_si256( (__m256i *) (pbDst +   0 ), c0 );
+        _mm256_storeu_si256( (__m256i *) (pbDst +  32 ), c1 );
+        _mm256_storeu_si256( (__m256i *) (pbDst +  64 ), c2 );
+        _mm256_storeu_si256( (__m256i *) (pbDst +  96 ), c3 );
+        _mm256_storeu_si256( (__m256i *) (pbDst + 128 ), c4 );
+        _mm256_storeu_si256( (__m256i *) (pbDst + 160 ), c5 );
+        _mm256_storeu_si256( (__m256i *) (pbDst + 192 ), c6 );
+        _mm256_storeu_si256( (__m256i *) (pbDst + 224 ), c7 );
+
+        pbSrc   += 16 * SYMCRYPT_AES_BLOCK_SIZE;
+        pbDst   += 16 * SYMCRYPT_AES_BLOCK_SIZE;
+        cbData  -= 16 * SYMCRYPT_AES_BLOCK_SIZE;
+    }
+
+    if( cbData >= SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        SymCryptAesEcbEncryptXmm( pExpandedKey, pbSrc, pbDst, cbData );
+    }
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCbcDecryptYmm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData )
+{
+    __m128i chain;
+    __m256i c0, c1, c2, c3, c4, c5, c6, c7;
+    __m256i d0, d1, d2, d3, d4, d5, d6, d7;
+
+    chain = _mm_loadu_si128( (__m128i *) pbChainingValue );
+
+    while( cbData >= 16 * SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        c0 = _mm256_loadu_si256( (__m256i *) (pbSrc +   0 ) );
+        c1 = _mm256_loadu_si256( (__m256i *) (pbSrc +  32 ) );
+        c2 = _mm256_loadu_si256( (__m256i *) (pbSrc +  64 ) );
+        c3 = _mm256_loadu_si256( (__m256i *) (pbSrc +  96 ) );
+        c4 = _mm256_loadu_si256( (__m256i *) (pbSrc + 128 ) );
+        c5 = _mm256_loadu_si256( (__m256i *) (pbSrc + 160 ) );
+        c6 = _mm256_loadu_si256( (__m256i *) (pbSrc + 192 ) );
+        c7 = _mm256_loadu_si256( (__m256i *) (pbSrc + 224 ) );
+
+        //
+        // The value to xor into each plaintext block is the previous ciphertext block,
+        // which we load with an offset of one block.
+        // All loads happen before any stores, so in-place decryption works.
+        //
+        d0 = _mm256_inserti128_si256( _mm256_castsi128_si256( chain ), _mm_loadu_si128( (__m128i *) pbSrc ), 1 );
+        d1 = _mm256_loadu_si256( (__m256i *) (pbSrc +  16 ) );
+        d2 = _mm256_loadu_si256( (__m256i *) (pbSrc +  48 ) );
+        d3 = _mm256_loadu_si256( (__m256i *) (pbSrc +  80 ) );
+        d4 = _mm256_loadu_si256( (__m256i *) (pbSrc + 112 ) );
+        d5 = _mm256_loadu_si256( (__m256i *) (pbSrc + 144 ) );
+        d6 = _mm256_loadu_si256( (__m256i *) (pbSrc + 176 ) );
+        d7 = _mm256_loadu_si256( (__m256i *) (pbSrc + 208 ) );
+        chain = _mm_loadu_si128( (__m128i *) (pbSrc + 240 ) );
+
+        AES_DECRYPT_YMM_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );
+
+        _mm256_storeu_si256( (__m256i *) (pbDst +   0 ), _mm256_xor_si256( c0, d0 ) );
+        _mm256_storeu_si256( (__m256i *) (pbDst +  32 ), _mm256_xor_si256( c1, d1 ) );
+        _mm256_storeu_si256( (__m256i *) (pbDst +  64 ), _mm256_xor_si256( c2, d2 ) );
+        _mm256_storeu_si256( (__m256i *) (pbDst +  96 ), _mm256_xor_si256( c3, d3 ) );
+        _mm256_storeu_si256( (__m256i *) (pbDst + 128 ), _mm256_xor_si256( c4, d4 ) );
+        _mm256_storeu_si256( (__m256i *) (pbDst + 160 ), _mm256_xor_si256( c5, d5 ) );
+        _mm256_storeu_si256( (__m256i *) (pbDst + 192 ), _mm256_xor_si256( c6, d6 ) );
+        _mm256_storeu_si256( (__m256i *) (pbDst + 224 ), _mm256_xor_si256( c7, d7 ) );
+
+        pbSrc   += 16 * SYMCRYPT_AES_BLOCK_SIZE;
+        pbDst   += 16 * SYMCRYPT_AES_BLOCK_SIZE;
+        cbData  -= 16 * SYMCRYPT_AES_BLOCK_SIZE;
+    }
+
+    _mm_storeu_si128( (__m128i *) pbChainingValue, chain );
+
+    if( cbData >= SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        SymCryptAesCbcDecryptXmm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+// ZMM (512-bit VAES) implementations
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesEcbEncryptZmm(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData )
+{
+    __m512i c0, c1, c2, c3, c4, c5, c6, c7;
+
+    while( cbData >= 32 * SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        c0 = _mm512_loadu_si512( pbSrc +   0 );
+        c1 = _mm512_loadu_si512( pbSrc +  64 );
+        c2 = _mm512_loadu_si512( pbSrc + 128 );
+        c3 = _mm512_loadu_si512( pbSrc + 192 );
+        c4 = _mm512_loadu_si512( pbSrc + 256 );
+        c5 = _mm512_loadu_si512( pbSrc + 320 );
+        c6 = _mm512_loadu_si512( pbSrc + 384 );
+        c7 = _mm512_loadu_si512( pbSrc + 448 );
+
+        AES_ENCRYPT_ZMM_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );
+
+        _mm512_storeu_si512( pbDst +   0, c0 );
+        _mm512_storeu_si512( pbDst +  64, c1 );
+        _mm512_storeu_si512( pbDst + 128, c2 );
+        _mm512_storeu_si512( pbDst + 192, c3 );
+        _mm512_storeu_si512( pbDst + 256, c4 );
+        _mm512_storeu_si512( pbDst + 320, c5 );
+        _mm512_storeu_si512( pbDst + 384, c6 );
+        _mm512_storeu_si512( pbDst + 448, c7 );
+
+        pbSrc   += 32 * SYMCRYPT_AES_BLOCK_SIZE;
+        pbDst   += 32 * SYMCRYPT_AES_BLOCK_SIZE;
+        cbData  -= 32 * SYMCRYPT_AES_BLOCK_SIZE;
+    }
+
+    if( cbData >= SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        SymCryptAesEcbEncryptYmm( pExpandedKey, pbSrc, pbDst, cbData );
+    }
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCbcDecryptZmm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData )
+{
+    __m128i chain;
+    __m512i c0, c1, c2, c3, c4, c5, c6, c7;
+    __m512i d0, d1, d2, d3, d4, d5, d6, d7;
+
+    chain = _mm_loadu_si128( (__m128i *) pbChainingValue );
+
+    while( cbData >= 32 * SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        c0 = _mm512_loadu_si512( pbSrc +   0 );
+        c1 = _mm512_loadu_si512( pbSrc +  64 );
+        c2 = _mm512_loadu_si512( pbSrc + 128 );
+        c3 = _mm512_loadu_si512( pbSrc + 192 );
+        c4 = _mm512_loadu_si512( pbSrc + 256 );
+        c5 = _mm512_loadu_si512( pbSrc + 320 );
+        c6 = _mm512_loadu_si512( pbSrc + 384 );
+        c7 = _mm512_loadu_si512( pbSrc + 448 );
+
+        //
+        // Previous ciphertext blocks, loaded at an offset of one block.
+        // The first register gets the chaining value in its lowest lane.
+        //
+        d0 = _mm512_inserti32x4( _mm512_castsi128_si512( chain ), _mm_loadu_si128( (__m128i *) (pbSrc +  0) ), 1 );
+        d0 = _mm512_inserti32x4( d0, _mm_loadu_si128( (__m128i *) (pbSrc + 16) ), 2 );
+        d0 = _mm512_inserti32x4( d0, _mm_loadu_si128( (__m128i *) (pbSrc + 32) ), 3 );
+        d1 = _mm512_loadu_si512( pbSrc +  48 );
+        d2 = _mm512_loadu_si512( pbSrc + 112 );
+        d3 = _mm512_loadu_si512( pbSrc + 176 );
+        d4 = _mm512_loadu_si512( pbSrc + 240 );
+        d5 = _mm512_loadu_si512( pbSrc + 304 );
+        d6 = _mm512_loadu_si512( pbSrc + 368 );
+        d7 = _mm512_loadu_si512( pbSrc + 432 );
+        chain = _mm_loadu_si128( (__m128i *) (pbSrc + 496 ) );
+
+        AES_DECRYPT_ZMM_8( pExpandedKey, c0, c1, c2, c3, c4, c5, c6, c7 );
+
+        _mm512_storeu_si512( pbDst +   0, _mm512_xor_si512( c0, d0 ) );
+        _mm512_storeu_si512( pbDst +  64, _mm512_xor_si512( c1, d1 ) );
+        _mm512_storeu_si512( pbDst + 128, _mm512_xor_si512( c2, d2 ) );
+        _mm512_storeu_si512( pbDst + 192, _mm512_xor_si512( c3, d3 ) );
+        _mm512_storeu_si512( pbDst + 256, _mm512_xor_si512( c4, d4 ) );
+        _mm512_storeu_si512( pbDst + 320, _mm512_xor_si512( c5, d5 ) );
+        _mm512_storeu_si512( pbDst + 384, _mm512_xor_si512( c6, d6 ) );
+        _mm512_storeu_si512( pbDst + 448, _mm512_xor_si512( c7, d7 ) );
+
+        pbSrc   += 32 * SYMCRYPT_AES_BLOCK_SIZE;
+        pbDst   += 32 * SYMCRYPT_AES_BLOCK_SIZE;
+        cbData  -= 32 * SYMCRYPT_AES_BLOCK_SIZE;
+    }
+
+    _mm_storeu_si128( (__m128i *) pbChainingValue, chain );
+
+    if( cbData >= SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        SymCryptAesCbcDecryptYmm( pExpandedKey, pbChainingValue, pbSrc, pbDst, cbData );
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////
+// CTR mode, for both counter widths
+//
+
+#define SYMCRYPT_AesCtrMsbXxYmm     SymCryptAesCtrMsb64Ymm
+#define SYMCRYPT_AesCtrMsbXxZmm     SymCryptAesCtrMsb64Zmm
+#define SYMCRYPT_AesCtrMsbXxXmm     SymCryptAesCtrMsb64Xmm
+#define MM256_ADD_EPIXX             _mm256_add_epi64
+#define MM512_ADD_EPIXX             _mm512_add_epi64
+
+#include "aes-ymm-pattern.c"
+
+#undef MM512_ADD_EPIXX
+#undef MM256_ADD_EPIXX
+#undef SYMCRYPT_AesCtrMsbXxXmm
+#undef SYMCRYPT_AesCtrMsbXxZmm
+#undef SYMCRYPT_AesCtrMsbXxYmm
+
+#define SYMCRYPT_AesCtrMsbXxYmm     SymCryptAesCtrMsb32Ymm
+#define SYMCRYPT_AesCtrMsbXxZmm     SymCryptAesCtrMsb32Zmm
+#define SYMCRYPT_AesCtrMsbXxXmm     SymCryptAesCtrMsb32Xmm
+#define MM256_ADD_EPIXX             _mm256_add_epi32
+#define MM512_ADD_EPIXX             _mm512_add_epi32
+
+#include "aes-ymm-pattern.c"
+
+#undef MM512_ADD_EPIXX
+#undef MM256_ADD_EPIXX
+#undef SYMCRYPT_AesCtrMsbXxXmm
+#undef SYMCRYPT_AesCtrMsbXxZmm
+#undef SYMCRYPT_AesCtrMsbXxYmm
+
+#endif // CPU_AMD64
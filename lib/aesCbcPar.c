@@ -0,0 +1,159 @@
+//
+// AesCbcPar.c
+//
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+
+//
+// This module contains the routines to implement AES-CBC encryption of multiple independent messages in parallel.
+//
+// CBC encryption of a single message is serial; each block has to wait for the previous ciphertext block.
+// With AES-NI the AESENC instruction has a latency of several cycles, but a throughput of one or more per cycle,
+// so a single CBC chain uses only a fraction of the AES hardware.
+// By interleaving up to 8 independent chains we keep the pipeline full.
+//
+// The scheduling is modelled on the parallel hash code in parhash.c. We keep a small set of lanes, each holding the
+// remaining work of one operation. We process the minimum remaining length of all lanes in one call
+// to the parallel kernel, and then refill any lane that has finished with the next operation.
+// All lanes in one kernel call must use the same number of AES rounds, so the operations are processed in
+// one pass per AES key size.
+//
+
+#include "precomp.h"
+
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+
+#define MAX_PARALLEL    8
+
+C_ASSERT( MAX_PARALLEL == SYMCRYPT_PARALLEL_AES_CBC_MAX_PARALLELISM );
+
+//
+// Find the next operation with the specified number of rounds and at least one block of data,
+// starting at *piNext. Returns FALSE if there is none.
+//
+BOOLEAN
+SYMCRYPT_CALL
+SymCryptParallelAesCbcNextOperation(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_AES_CBC_OPERATION   pOperations,
+                                SIZE_T                                  nOperations,
+    _Inout_                     SIZE_T *                                piNext,
+                                SIZE_T                                  nRounds,
+    _Out_                       PSYMCRYPT_PARALLEL_AES_CBC_OPERATION    pLane )
+{
+    PCSYMCRYPT_PARALLEL_AES_CBC_OPERATION pOp;
+
+    while( *piNext < nOperations )
+    {
+        pOp = &pOperations[ *piNext ];
+        (*piNext)++;
+
+        if( pOp->cbData >= SYMCRYPT_AES_BLOCK_SIZE &&
+            (SIZE_T)(pOp->pExpandedKey->lastEncRoundKey - &pOp->pExpandedKey->RoundKey[0]) == nRounds )
+        {
+            *pLane = *pOp;
+            pLane->cbData &= ~(SIZE_T)(SYMCRYPT_AES_BLOCK_SIZE - 1);
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelAesCbcEncryptXmmSchedule(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_AES_CBC_OPERATION   pOperations,
+                                SIZE_T                                  nOperations )
+{
+    SYMCRYPT_PARALLEL_AES_CBC_OPERATION lanes[MAX_PARALLEL];
+    SIZE_T  nPar;
+    SIZE_T  iNext;
+    SIZE_T  nRounds;
+    SIZE_T  todo;
+    SIZE_T  i;
+
+    for( nRounds = 10; nRounds <= 14; nRounds += 2 )
+    {
+        iNext = 0;
+        nPar = 0;
+
+#pragma warning( suppress: 4127 )       // conditional expression is constant
+        while( TRUE )
+        {
+            while( nPar < MAX_PARALLEL &&
+                   SymCryptParallelAesCbcNextOperation( pOperations, nOperations, &iNext, nRounds, &lanes[nPar] ) )
+            {
+                nPar++;
+            }
+
+            if( nPar == 0 )
+            {
+                break;
+            }
+
+            if( nPar == 1 )
+            {
+                //
+                // No more operations to interleave with; the single-chain code is faster here.
+                //
+                SymCryptAesCbcEncryptXmm( lanes[0].pExpandedKey, lanes[0].pbChainingValue, lanes[0].pbSrc, lanes[0].pbDst, lanes[0].cbData );
+                break;
+            }
+
+            todo = lanes[0].cbData;
+            for( i=1; i<nPar; i++ )
+            {
+                todo = min( todo, lanes[i].cbData );
+            }
+
+            SymCryptParallelAesCbcEncryptXmm( lanes, nPar, todo );
+
+            //
+            // Drop the lanes that are done; they are refilled at the top of the loop.
+            //
+            i = 0;
+            while( i < nPar )
+            {
+                if( lanes[i].cbData == 0 )
+                {
+                    lanes[i] = lanes[--nPar];
+                } else {
+                    i++;
+                }
+            }
+        }
+    }
+
+    SymCryptWipeKnownSize( lanes, sizeof( lanes ) );
+}
+
+#endif
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelAesCbcEncrypt(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_AES_CBC_OPERATION   pOperations,
+                                SIZE_T                                  nOperations )
+{
+    SIZE_T i;
+
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+    SYMCRYPT_EXTENDED_SAVE_DATA SaveState;
+
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) && SymCryptSaveXmm( &SaveState ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptParallelAesCbcEncryptXmmSchedule( pOperations, nOperations );
+        SymCryptRestoreXmm( &SaveState );
+        return;
+    }
+#endif
+
+    for( i=0; i<nOperations; i++ )
+    {
+        SymCryptAesCbcEncrypt(  pOperations[i].pExpandedKey,
+                                pOperations[i].pbChainingValue,
+                                pOperations[i].pbSrc,
+                                pOperations[i].pbDst,
+                                pOperations[i].cbData & ~(SIZE_T)(SYMCRYPT_AES_BLOCK_SIZE - 1) );
+    }
+}
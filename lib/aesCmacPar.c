@@ -0,0 +1,256 @@
+//
+// AesCmacPar.c
+//
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+
+//
+// This module contains the routines to implement AES-CMAC of multiple independent messages in parallel.
+//
+// CMAC is a CBC-MAC with a modified last block, so a single CMAC computation has the same
+// latency problem as CBC encryption. We use the same lane scheduling as aesCbcPar.c.
+// Each lane first processes all but the last block of its message directly from the caller's buffer,
+// and then the padded and masked last block from a local buffer. For short messages the last
+// block is a large part of the work, so it also goes through the parallel kernel.
+//
+
+#include "precomp.h"
+
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+
+#define MAX_PARALLEL    8
+
+C_ASSERT( MAX_PARALLEL == SYMCRYPT_PARALLEL_AES_CMAC_MAX_PARALLELISM );
+
+typedef struct _SYMCRYPT_PARALLEL_AES_CMAC_LANE
+{
+    PCSYMCRYPT_PARALLEL_AES_CMAC_OPERATION  pOp;
+    BOOLEAN                                 bLastBlock;     // lastBlock is being processed
+    SYMCRYPT_ALIGN BYTE                     chain[SYMCRYPT_AES_BLOCK_SIZE];
+    SYMCRYPT_ALIGN BYTE                     lastBlock[SYMCRYPT_AES_BLOCK_SIZE];
+} SYMCRYPT_PARALLEL_AES_CMAC_LANE, *PSYMCRYPT_PARALLEL_AES_CMAC_LANE;
+
+//
+// Compute the padded and masked last block of the message of a lane
+//
+VOID
+SYMCRYPT_CALL
+SymCryptParallelAesCmacPrepareLastBlock( _Inout_ PSYMCRYPT_PARALLEL_AES_CMAC_LANE pLaneState )
+{
+    PCSYMCRYPT_PARALLEL_AES_CMAC_OPERATION pOp = pLaneState->pOp;
+    SIZE_T cbLast;
+
+    //
+    // The last block has 1..16 bytes, except for the empty message.
+    //
+    cbLast = pOp->cbData == 0 ? 0 : ((pOp->cbData - 1) & (SYMCRYPT_AES_BLOCK_SIZE - 1)) + 1;
+
+    if( cbLast == SYMCRYPT_AES_BLOCK_SIZE )
+    {
+        SymCryptXorBytes( &pOp->pbData[pOp->cbData - cbLast], &pOp->pExpandedKey->K1[0], &pLaneState->lastBlock[0], SYMCRYPT_AES_BLOCK_SIZE );
+    } else {
+        SymCryptWipeKnownSize( &pLaneState->lastBlock[0], SYMCRYPT_AES_BLOCK_SIZE );
+        memcpy( &pLaneState->lastBlock[0], &pOp->pbData[pOp->cbData - cbLast], cbLast );
+        pLaneState->lastBlock[cbLast] = 0x80;
+        SymCryptXorBytes( &pLaneState->lastBlock[0], &pOp->pExpandedKey->K2[0], &pLaneState->lastBlock[0], SYMCRYPT_AES_BLOCK_SIZE );
+    }
+
+    pLaneState->bLastBlock = TRUE;
+}
+
+//
+// Set up the CBC-MAC work of a lane: the message without its last block,
+// or the last block if the rest of the message has been done.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptParallelAesCmacSetupLane(
+    _Inout_ PSYMCRYPT_PARALLEL_AES_CMAC_LANE        pLaneState,
+    _Out_   PSYMCRYPT_PARALLEL_AES_CBC_OPERATION    pLane )
+{
+    PCSYMCRYPT_PARALLEL_AES_CMAC_OPERATION pOp = pLaneState->pOp;
+
+    pLane->pExpandedKey = &pOp->pExpandedKey->aesKey;
+    pLane->pbChainingValue = &pLaneState->chain[0];
+    pLane->pbDst = NULL;
+
+    if( !pLaneState->bLastBlock )
+    {
+        pLane->pbSrc = pOp->pbData;
+        pLane->cbData = pOp->cbData == 0 ? 0 : (pOp->cbData - 1) & ~(SIZE_T)(SYMCRYPT_AES_BLOCK_SIZE - 1);
+        if( pLane->cbData > 0 )
+        {
+            return;
+        }
+        SymCryptParallelAesCmacPrepareLastBlock( pLaneState );
+    }
+
+    pLane->pbSrc = &pLaneState->lastBlock[0];
+    pLane->cbData = SYMCRYPT_AES_BLOCK_SIZE;
+}
+
+//
+// Find the next operation with the specified number of rounds, starting at *piNext,
+// and start it in the lane. Returns FALSE if there is none.
+//
+BOOLEAN
+SYMCRYPT_CALL
+SymCryptParallelAesCmacNextOperation(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_AES_CMAC_OPERATION  pOperations,
+                                SIZE_T                                  nOperations,
+    _Inout_                     SIZE_T *                                piNext,
+                                SIZE_T                                  nRounds,
+    _Out_                       PSYMCRYPT_PARALLEL_AES_CMAC_LANE        pLaneState,
+    _Out_                       PSYMCRYPT_PARALLEL_AES_CBC_OPERATION    pLane )
+{
+    PCSYMCRYPT_PARALLEL_AES_CMAC_OPERATION pOp;
+
+    while( *piNext < nOperations )
+    {
+        pOp = &pOperations[ *piNext ];
+        (*piNext)++;
+
+        SYMCRYPT_CHECK_MAGIC( pOp->pExpandedKey );
+
+        if( (SIZE_T)(pOp->pExpandedKey->aesKey.lastEncRoundKey - &pOp->pExpandedKey->aesKey.RoundKey[0]) == nRounds )
+        {
+            pLaneState->pOp = pOp;
+            pLaneState->bLastBlock = FALSE;
+            SymCryptWipeKnownSize( &pLaneState->chain[0], SYMCRYPT_AES_BLOCK_SIZE );
+            SymCryptParallelAesCmacSetupLane( pLaneState, pLane );
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelAesCmacXmmSchedule(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_AES_CMAC_OPERATION  pOperations,
+                                SIZE_T                                  nOperations )
+{
+    SYMCRYPT_PARALLEL_AES_CBC_OPERATION lanes[MAX_PARALLEL];
+    SYMCRYPT_PARALLEL_AES_CMAC_LANE     laneStates[MAX_PARALLEL];
+    SIZE_T  nPar;
+    SIZE_T  iNext;
+    SIZE_T  nRounds;
+    SIZE_T  todo;
+    SIZE_T  i;
+
+    for( nRounds = 10; nRounds <= 14; nRounds += 2 )
+    {
+        iNext = 0;
+        nPar = 0;
+
+#pragma warning( suppress: 4127 )       // conditional expression is constant
+        while( TRUE )
+        {
+            while( nPar < MAX_PARALLEL &&
+                   SymCryptParallelAesCmacNextOperation( pOperations, nOperations, &iNext, nRounds, &laneStates[nPar], &lanes[nPar] ) )
+            {
+                nPar++;
+            }
+
+            if( nPar == 0 )
+            {
+                break;
+            }
+
+            if( nPar == 1 )
+            {
+                //
+                // No more operations to interleave with; the single-chain code is faster here.
+                //
+                SymCryptAesCbcMacXmm( lanes[0].pExpandedKey, &laneStates[0].chain[0], lanes[0].pbSrc, lanes[0].cbData );
+                if( !laneStates[0].bLastBlock )
+                {
+                    SymCryptParallelAesCmacPrepareLastBlock( &laneStates[0] );
+                    SymCryptAesCbcMacXmm( lanes[0].pExpandedKey, &laneStates[0].chain[0], &laneStates[0].lastBlock[0], SYMCRYPT_AES_BLOCK_SIZE );
+                }
+                memcpy( laneStates[0].pOp->pbResult, &laneStates[0].chain[0], SYMCRYPT_AES_CMAC_RESULT_SIZE );
+                break;
+            }
+
+            todo = lanes[0].cbData;
+            for( i=1; i<nPar; i++ )
+            {
+                todo = min( todo, lanes[i].cbData );
+            }
+
+            SymCryptParallelAesCbcMacXmm( lanes, nPar, todo );
+
+            //
+            // Lanes that finished the body of their message continue with the last block.
+            // Lanes that finished the last block are done; they are refilled at the top of the loop.
+            //
+            i = 0;
+            while( i < nPar )
+            {
+                if( lanes[i].cbData != 0 )
+                {
+                    i++;
+                } else if( !laneStates[i].bLastBlock )
+                {
+                    SymCryptParallelAesCmacPrepareLastBlock( &laneStates[i] );
+                    SymCryptParallelAesCmacSetupLane( &laneStates[i], &lanes[i] );
+                    i++;
+                } else {
+                    memcpy( laneStates[i].pOp->pbResult, &laneStates[i].chain[0], SYMCRYPT_AES_CMAC_RESULT_SIZE );
+
+                    //
+                    // Move the last lane into this slot; the lane descriptor points into the lane state
+                    // so we have to set it up again.
+                    //
+                    nPar--;
+                    if( i < nPar )
+                    {
+                        laneStates[i] = laneStates[nPar];
+                        lanes[i] = lanes[nPar];
+                        lanes[i].pbChainingValue = &laneStates[i].chain[0];
+                        if( laneStates[i].bLastBlock )
+                        {
+                            lanes[i].pbSrc = &laneStates[i].lastBlock[SYMCRYPT_AES_BLOCK_SIZE - lanes[i].cbData];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    SymCryptWipeKnownSize( lanes, sizeof( lanes ) );
+    SymCryptWipeKnownSize( laneStates, sizeof( laneStates ) );
+}
+
+#endif
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelAesCmac(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_AES_CMAC_OPERATION  pOperations,
+                                SIZE_T                                  nOperations )
+{
+    SYMCRYPT_AES_CMAC_STATE state;
+    SIZE_T i;
+
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+    SYMCRYPT_EXTENDED_SAVE_DATA SaveState;
+
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) && SymCryptSaveXmm( &SaveState ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptParallelAesCmacXmmSchedule( pOperations, nOperations );
+        SymCryptRestoreXmm( &SaveState );
+        return;
+    }
+#endif
+
+    for( i=0; i<nOperations; i++ )
+    {
+        SymCryptAesCmacInit( &state, pOperations[i].pExpandedKey );
+        SymCryptAesCmacAppend( &state, pOperations[i].pbData, pOperations[i].cbData );
+        SymCryptAesCmacResult( &state, pOperations[i].pbResult );
+    }
+
+    SymCryptWipeKnownSize( &state, sizeof( state ) );
+}
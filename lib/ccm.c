@@ -439,6 +439,7 @@ SymCryptCcmEncryptPart(
                               SIZE_T              cbData )
 {
     UINT64 bytesProcessedAfterThisCall;
+    SIZE_T bytesToProcess;
 
     SYMCRYPT_CHECK_MAGIC( pState );
 
@@ -458,6 +459,37 @@ SymCryptCcmEncryptPart(
     // We are revealing the key stream anyway (from the plaintext and ciphertext) and
     // the exact byte value that we xor the key stream into is irrelevant.
     // 
+    if( pState->pBlockCipher->ccmEncryptPartFunc != NULL )
+    {
+        //
+        // The block cipher has an optimized CCM implementation, which only processes
+        // whole blocks starting at a block boundary.
+        // We first complete any partial block using the generic code.
+        // The MAC block and the key stream are always at the same offset, as the
+        // MAC data was padded to a block boundary before the first data byte.
+        //
+        bytesToProcess = min( cbData, (SIZE_T)(0 - pState->bytesProcessed) & CCM_BLOCK_MOD_MASK );
+        if( bytesToProcess > 0 )
+        {
+            SymCryptCcmAddMacData( pState, pbSrc, bytesToProcess );
+            SymCryptCcmEncryptDecryptPart( pState, pbSrc, pbDst, bytesToProcess );
+            pbSrc += bytesToProcess;
+            pbDst += bytesToProcess;
+            cbData -= bytesToProcess;
+        }
+
+        bytesToProcess = cbData & CCM_BLOCK_ROUND_MASK;
+        if( bytesToProcess > 0 )
+        {
+            SYMCRYPT_ASSERT( pState->bytesInMacBlock == 0 );
+            pState->pBlockCipher->ccmEncryptPartFunc( pState, pbSrc, pbDst, bytesToProcess );
+            pState->bytesProcessed += bytesToProcess;
+            pbSrc += bytesToProcess;
+            pbDst += bytesToProcess;
+            cbData -= bytesToProcess;
+        }
+    }
+
     SymCryptCcmAddMacData( pState, pbSrc, cbData );
 
     SymCryptCcmEncryptDecryptPart( pState, pbSrc, pbDst, cbData );
@@ -506,6 +538,7 @@ SymCryptCcmDecryptPart( _Inout_                 PSYMCRYPT_CCM_STATE pState,
                                               SIZE_T              cbData )
 {
     UINT64 bytesProcessedAfterThisCall;
+    SIZE_T bytesToProcess;
 
     SYMCRYPT_CHECK_MAGIC( pState );
 
@@ -530,6 +563,34 @@ SymCryptCcmDecryptPart( _Inout_                 PSYMCRYPT_CCM_STATE pState,
     // Note that this would not safe in general, it is only safe because CTR mode decryption already
     // reveals the key stream.
     //
+    if( pState->pBlockCipher->ccmDecryptPartFunc != NULL )
+    {
+        //
+        // Complete any partial block with the generic code, then let the
+        // optimized implementation process the whole blocks.
+        //
+        bytesToProcess = min( cbData, (SIZE_T)(0 - pState->bytesProcessed) & CCM_BLOCK_MOD_MASK );
+        if( bytesToProcess > 0 )
+        {
+            SymCryptCcmEncryptDecryptPart( pState, pbSrc, pbDst, bytesToProcess );
+            SymCryptCcmAddMacData( pState, pbDst, bytesToProcess );
+            pbSrc += bytesToProcess;
+            pbDst += bytesToProcess;
+            cbData -= bytesToProcess;
+        }
+
+        bytesToProcess = cbData & CCM_BLOCK_ROUND_MASK;
+        if( bytesToProcess > 0 )
+        {
+            SYMCRYPT_ASSERT( pState->bytesInMacBlock == 0 );
+            pState->pBlockCipher->ccmDecryptPartFunc( pState, pbSrc, pbDst, bytesToProcess );
+            pState->bytesProcessed += bytesToProcess;
+            pbSrc += bytesToProcess;
+            pbDst += bytesToProcess;
+            cbData -= bytesToProcess;
+        }
+    }
+
     SymCryptCcmEncryptDecryptPart( pState, pbSrc, pbDst, cbData );
     SymCryptCcmAddMacData( pState, pbDst, cbData );
 
@@ -572,6 +633,316 @@ SymCryptCcmDecryptFinal( _In_                     PSYMCRYPT_CCM_STATE pState,
 }
 
 
+//
+// Scatter/gather versions; SymCryptIovecCrypt passes whole blocks to the Part functions
+// so that they can use the bulk code.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptCcmEncryptIovecFunc( PVOID pContext, PCBYTE pbSrc, PBYTE pbDst, SIZE_T cbData )
+{
+    SymCryptCcmEncryptPart( (PSYMCRYPT_CCM_STATE) pContext, pbSrc, pbDst, cbData );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptCcmDecryptIovecFunc( PVOID pContext, PCBYTE pbSrc, PBYTE pbDst, SIZE_T cbData )
+{
+    SymCryptCcmDecryptPart( (PSYMCRYPT_CCM_STATE) pContext, pbSrc, pbDst, cbData );
+}
+
+SYMCRYPT_NOINLINE
+VOID
+SYMCRYPT_CALL
+SymCryptCcmEncryptIovec(
+    _In_                            PCSYMCRYPT_BLOCKCIPHER  pBlockCipher,
+    _In_                            PCVOID                  pExpandedKey,
+    _In_reads_( cbNonce )           PCBYTE                  pbNonce,
+                                    SIZE_T                  cbNonce,
+    _In_reads_opt_( cbAuthData )    PCBYTE                  pbAuthData,
+                                    SIZE_T                  cbAuthData,
+    _In_reads_( nSrc )              PCSYMCRYPT_IOVEC        pSrc,
+                                    SIZE_T                  nSrc,
+    _In_reads_( nDst )              PCSYMCRYPT_IOVEC        pDst,
+                                    SIZE_T                  nDst,
+    _Out_writes_( cbTag )           PBYTE                   pbTag,
+                                    SIZE_T                  cbTag )
+{
+    SYMCRYPT_CCM_STATE  state;
+
+    SymCryptCcmInit(    &state, 
+                        pBlockCipher,
+                        pExpandedKey,
+                        pbNonce, cbNonce,
+                        pbAuthData, cbAuthData,
+                        SymCryptIovecLength( pSrc, nSrc ), cbTag );
+
+    SymCryptIovecCrypt( pSrc, nSrc, pDst, nDst, SYMCRYPT_CCM_BLOCK_SIZE, &SymCryptCcmEncryptIovecFunc, &state );
+
+    SymCryptCcmEncryptFinal( &state, pbTag, cbTag );
+
+    SymCryptWipeKnownSize( &state, sizeof( state ) );
+}
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_NOINLINE
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptCcmDecryptIovec(
+    _In_                            PCSYMCRYPT_BLOCKCIPHER  pBlockCipher,
+    _In_                            PCVOID                  pExpandedKey,
+    _In_reads_( cbNonce )           PCBYTE                  pbNonce,
+                                    SIZE_T                  cbNonce,
+    _In_reads_opt_( cbAuthData )    PCBYTE                  pbAuthData,
+                                    SIZE_T                  cbAuthData,
+    _In_reads_( nSrc )              PCSYMCRYPT_IOVEC        pSrc,
+                                    SIZE_T                  nSrc,
+    _In_reads_( nDst )              PCSYMCRYPT_IOVEC        pDst,
+                                    SIZE_T                  nDst,
+    _In_reads_( cbTag )             PCBYTE                  pbTag,
+                                    SIZE_T                  cbTag )
+{
+    SYMCRYPT_CCM_STATE  state;
+    SYMCRYPT_ERROR      status;
+
+    SymCryptCcmInit(    &state, 
+                        pBlockCipher,
+                        pExpandedKey,
+                        pbNonce, cbNonce,
+                        pbAuthData, cbAuthData,
+                        SymCryptIovecLength( pSrc, nSrc ), cbTag );
+
+    SymCryptIovecCrypt( pSrc, nSrc, pDst, nDst, SYMCRYPT_CCM_BLOCK_SIZE, &SymCryptCcmDecryptIovecFunc, &state );
+
+    status = SymCryptCcmDecryptFinal( &state, pbTag, cbTag );
+    if( status != SYMCRYPT_NO_ERROR )
+    {
+        SymCryptIovecWipe( pDst, nDst );
+    }
+
+    SymCryptWipeKnownSize( &state, sizeof( state ) );
+
+    return status;
+}
+
+//
+// Batched record processing
+//
+// The CBC-MAC of a single record is serial; each block cipher call has to wait for the result of the previous one.
+// We run the CBC-MAC over the payload of up to 8 records side by side. In each step the MAC blocks of all
+// active records are encrypted with a single ECB call, which the AES implementations process in parallel.
+// The scheduling follows the parallel AES-CBC code: we process the minimum remaining length of all lanes,
+// and then finish the records that are done and refill their lanes.
+// The formatting blocks (B0 and the associated data) are processed by SymCryptCcmInit, and the
+// CTR part uses the normal code which is already parallel.
+//
+#define CCM_BATCH_MAX_LANES     (8)
+
+typedef struct _SYMCRYPT_CCM_BATCH_LANE {
+    SYMCRYPT_CCM_STATE          state;
+    SIZE_T                      iRecord;
+    PCBYTE                      pbMacData;      // next payload byte to MAC
+    SIZE_T                      cbMacData;      // # payload bytes left to MAC
+} SYMCRYPT_CCM_BATCH_LANE, *PSYMCRYPT_CCM_BATCH_LANE;
+
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptCcmBatchFinishLane(
+    _Inout_                         PSYMCRYPT_CCM_BATCH_LANE    pLane,
+    _In_reads_( SYMCRYPT_CCM_BLOCK_SIZE ) PCBYTE                pbMac,
+    _In_                            PCSYMCRYPT_AUTHENC_RECORD   pRec,
+                                    BOOLEAN                     bEncrypt )
+{
+    SYMCRYPT_ERROR status = SYMCRYPT_NO_ERROR;
+
+    memcpy( &pLane->state.macBlock[0], pbMac, SYMCRYPT_CCM_BLOCK_SIZE );
+
+    //
+    // The last lane might still have data left to MAC, which we do with the single-record code.
+    //
+    SymCryptCcmAddMacData( &pLane->state, pLane->pbMacData, pLane->cbMacData );
+
+    if( bEncrypt )
+    {
+        SymCryptCcmEncryptDecryptPart( &pLane->state, pRec->pbSrc, pRec->pbDst, pRec->cbData );
+        SymCryptCcmEncryptFinal( &pLane->state, pRec->pbTag, pRec->cbTag );
+    } else {
+        status = SymCryptCcmDecryptFinal( &pLane->state, pRec->pbTag, pRec->cbTag );
+        if( status != SYMCRYPT_NO_ERROR )
+        {
+            SymCryptWipe( pRec->pbDst, pRec->cbData );
+        }
+    }
+
+    return status;
+}
+
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptCcmBatchCrypt(
+    _In_                            PCSYMCRYPT_BLOCKCIPHER      pBlockCipher,
+    _In_                            PCVOID                      pExpandedKey,
+    _In_reads_( nRecords )          PCSYMCRYPT_AUTHENC_RECORD   pRecords,
+                                    SIZE_T                      nRecords,
+                                    BOOLEAN                     bEncrypt,
+    _Out_writes_opt_( nRecords )    SYMCRYPT_ERROR *            pResults )
+{
+    SYMCRYPT_CCM_BATCH_LANE     lanes[CCM_BATCH_MAX_LANES];
+    SYMCRYPT_ALIGN BYTE         macBlocks[CCM_BATCH_MAX_LANES * SYMCRYPT_CCM_BLOCK_SIZE];
+    PSYMCRYPT_CCM_BATCH_LANE    pLane;
+    PCSYMCRYPT_AUTHENC_RECORD   pRec;
+    SYMCRYPT_ERROR              status = SYMCRYPT_NO_ERROR;
+    SYMCRYPT_ERROR              recordStatus;
+    SIZE_T                      nLanes;
+    SIZE_T                      iNext;
+    SIZE_T                      nSteps;
+    SIZE_T                      cbBlock;
+    SIZE_T                      i;
+    SIZE_T                      j;
+
+    SYMCRYPT_ASSERT( pBlockCipher->blockSize == SYMCRYPT_CCM_BLOCK_SIZE );
+
+    nLanes = 0;
+    iNext = 0;
+
+#pragma warning( suppress: 4127 )       // conditional expression is constant
+    while( TRUE )
+    {
+        while( nLanes < CCM_BATCH_MAX_LANES && iNext < nRecords )
+        {
+            pLane = &lanes[nLanes];
+            pRec = &pRecords[iNext];
+
+            SymCryptCcmInit(    &pLane->state,
+                                pBlockCipher,
+                                pExpandedKey,
+                                pRec->pbNonce, pRec->cbNonce,
+                                pRec->pbAuthData, pRec->cbAuthData,
+                                pRec->cbData, pRec->cbTag );
+
+            if( bEncrypt )
+            {
+                pLane->pbMacData = pRec->pbSrc;
+            } else {
+                //
+                // Decrypt first and MAC the plaintext in pbDst; see SymCryptCcmDecryptPart for why this is safe.
+                //
+                SymCryptCcmEncryptDecryptPart( &pLane->state, pRec->pbSrc, pRec->pbDst, pRec->cbData );
+                pLane->pbMacData = pRec->pbDst;
+            }
+            pLane->cbMacData = pRec->cbData;
+            pLane->iRecord = iNext;
+
+            memcpy( &macBlocks[nLanes * SYMCRYPT_CCM_BLOCK_SIZE], &pLane->state.macBlock[0], SYMCRYPT_CCM_BLOCK_SIZE );
+
+            nLanes++;
+            iNext++;
+        }
+
+        if( nLanes == 0 )
+        {
+            break;
+        }
+
+        if( nLanes > 1 )
+        {
+            //
+            // Run all lanes for as many blocks as the shortest one has left.
+            // A final partial block is xorred in as is, which is the same as padding it with zeroes.
+            //
+            nSteps = (SIZE_T)-1;
+            for( j=0; j<nLanes; j++ )
+            {
+                nSteps = min( nSteps, (lanes[j].cbMacData + SYMCRYPT_CCM_BLOCK_SIZE - 1) / SYMCRYPT_CCM_BLOCK_SIZE );
+            }
+
+            for( i=0; i<nSteps; i++ )
+            {
+                for( j=0; j<nLanes; j++ )
+                {
+                    pLane = &lanes[j];
+                    cbBlock = min( pLane->cbMacData, SYMCRYPT_CCM_BLOCK_SIZE );
+                    SymCryptXorBytes(   &macBlocks[j * SYMCRYPT_CCM_BLOCK_SIZE], 
+                                        pLane->pbMacData, 
+                                        &macBlocks[j * SYMCRYPT_CCM_BLOCK_SIZE], 
+                                        cbBlock );
+                    pLane->pbMacData += cbBlock;
+                    pLane->cbMacData -= cbBlock;
+                }
+
+                SymCryptEcbEncrypt( pBlockCipher, pExpandedKey, macBlocks, macBlocks, nLanes * SYMCRYPT_CCM_BLOCK_SIZE );
+            }
+        }
+
+        //
+        // Finish the records that are done. If only one lane is left it is finished with the 
+        // single-record code, which is faster than running one lane.
+        //
+        j = 0;
+        while( j < nLanes )
+        {
+            pLane = &lanes[j];
+            if( pLane->cbMacData == 0 || nLanes == 1 )
+            {
+                recordStatus = SymCryptCcmBatchFinishLane(  pLane,
+                                                            &macBlocks[j * SYMCRYPT_CCM_BLOCK_SIZE],
+                                                            &pRecords[pLane->iRecord],
+                                                            bEncrypt );
+                if( recordStatus != SYMCRYPT_NO_ERROR )
+                {
+                    status = recordStatus;
+                }
+                if( !bEncrypt && pResults != NULL )
+                {
+                    pResults[pLane->iRecord] = recordStatus;
+                }
+
+                nLanes--;
+                if( j < nLanes )
+                {
+                    lanes[j] = lanes[nLanes];
+                    SYMCRYPT_SET_MAGIC( &lanes[j].state );
+                    memcpy( &macBlocks[j * SYMCRYPT_CCM_BLOCK_SIZE], &macBlocks[nLanes * SYMCRYPT_CCM_BLOCK_SIZE], SYMCRYPT_CCM_BLOCK_SIZE );
+                }
+            } else {
+                j++;
+            }
+        }
+    }
+
+    SymCryptWipeKnownSize( lanes, sizeof( lanes ) );
+    SymCryptWipeKnownSize( macBlocks, sizeof( macBlocks ) );
+
+    return status;
+}
+
+SYMCRYPT_NOINLINE
+VOID
+SYMCRYPT_CALL
+SymCryptCcmEncryptBatch(
+    _In_                            PCSYMCRYPT_BLOCKCIPHER      pBlockCipher,
+    _In_                            PCVOID                      pExpandedKey,
+    _In_reads_( nRecords )          PCSYMCRYPT_AUTHENC_RECORD   pRecords,
+                                    SIZE_T                      nRecords )
+{
+    SymCryptCcmBatchCrypt( pBlockCipher, pExpandedKey, pRecords, nRecords, TRUE, NULL );
+}
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_NOINLINE
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptCcmDecryptBatch(
+    _In_                            PCSYMCRYPT_BLOCKCIPHER      pBlockCipher,
+    _In_                            PCVOID                      pExpandedKey,
+    _In_reads_( nRecords )          PCSYMCRYPT_AUTHENC_RECORD   pRecords,
+                                    SIZE_T                      nRecords,
+    _Out_writes_opt_( nRecords )    SYMCRYPT_ERROR *            pResults )
+{
+    return SymCryptCcmBatchCrypt( pBlockCipher, pExpandedKey, pRecords, nRecords, FALSE, pResults );
+}
+
+
 static const BYTE SymCryptCcmSelftestResult[3 + SYMCRYPT_AES_BLOCK_SIZE ] =
 {
     0x42, 0xd7, 0xda, 
@@ -145,6 +145,25 @@ SymCryptChaCha20Crypt(
     }
 }
 
+VOID
+SYMCRYPT_CALL
+SymCryptChaCha20IovecFunc( PVOID pContext, PCBYTE pbSrc, PBYTE pbDst, SIZE_T cbData )
+{
+    SymCryptChaCha20Crypt( (PSYMCRYPT_CHACHA20_STATE) pContext, pbSrc, pbDst, cbData );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptChaCha20CryptIovec(
+    _Inout_                 PSYMCRYPT_CHACHA20_STATE    pState,
+    _In_reads_( nSrc )      PCSYMCRYPT_IOVEC            pSrc,
+                            SIZE_T                      nSrc,
+    _In_reads_( nDst )      PCSYMCRYPT_IOVEC            pDst,
+                            SIZE_T                      nDst )
+{
+    SymCryptIovecCrypt( pSrc, nSrc, pDst, nDst, 64, &SymCryptChaCha20IovecFunc, pState );
+}
+
 #define CHACHA_QUARTERROUND( a, b, c, d ) { \
     a += b; d ^= a; d = ROL32( d, 16 ); \
     c += d; b ^= c; b = ROL32( b, 12 ); \
@@ -246,6 +265,233 @@ SymCryptChaCha20CryptBlocks(
     }
 }
  
+//
+// QUIC header protection (RFC 9001 section 5.4.4)
+// The sample provides the block counter (first 4 bytes) and the nonce (remaining 12 bytes);
+// the mask is the first 5 bytes of the resulting key stream block.
+// Only the first two state words are needed for the output.
+//
+
+static
+VOID
+SYMCRYPT_CALL
+SymCryptChaCha20QuicHpMaskC(
+    _In_reads_( 8 )                                 const UINT32 *  pKey,
+    _In_reads_( SYMCRYPT_QUIC_HP_SAMPLE_SIZE )      PCBYTE          pbSample,
+    _Out_writes_( SYMCRYPT_QUIC_HP_MASK_SIZE )      PBYTE           pbMask )
+{
+    UINT32 s0, s1, s2, s3, s4, s5, s6, s7, s8, s9, s10, s11, s12, s13, s14, s15;
+    int i;
+
+    s0  = 0x61707865;
+    s1  = 0x3320646e;
+    s2  = 0x79622d32;
+    s3  = 0x6b206574;
+    s4  = pKey[0];
+    s5  = pKey[1];
+    s6  = pKey[2];
+    s7  = pKey[3];
+    s8  = pKey[4];
+    s9  = pKey[5];
+    s10 = pKey[6];
+    s11 = pKey[7];
+    s12 = SYMCRYPT_LOAD_LSBFIRST32( pbSample +  0 );
+    s13 = SYMCRYPT_LOAD_LSBFIRST32( pbSample +  4 );
+    s14 = SYMCRYPT_LOAD_LSBFIRST32( pbSample +  8 );
+    s15 = SYMCRYPT_LOAD_LSBFIRST32( pbSample + 12 );
+
+    for( i=0; i<10; i++ )
+    {
+        CHACHA_QUARTERROUND( s0 , s4 , s8 , s12 );
+        CHACHA_QUARTERROUND( s1 , s5 , s9 , s13 );
+        CHACHA_QUARTERROUND( s2 , s6 , s10, s14 );
+        CHACHA_QUARTERROUND( s3 , s7 , s11, s15 );
+
+        CHACHA_QUARTERROUND( s0 , s5 , s10, s15 );
+        CHACHA_QUARTERROUND( s1 , s6 , s11, s12 );
+        CHACHA_QUARTERROUND( s2 , s7 , s8 , s13 );
+        CHACHA_QUARTERROUND( s3 , s4 , s9 , s14 );
+    }
+
+    s0 += 0x61707865;
+    s1 += 0x3320646e;
+
+    SYMCRYPT_STORE_LSBFIRST32( pbMask, s0 );
+    pbMask[4] = (BYTE) s1;
+}
+
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+
+#define CHACHA_XMM_ROL( x, n )  _mm_or_si128( _mm_slli_epi32( x, n ), _mm_srli_epi32( x, 32 - (n) ) )
+
+#define CHACHA_XMM_QUARTERROUND( a, b, c, d ) { \
+    a = _mm_add_epi32( a, b ); d = _mm_xor_si128( d, a ); d = _mm_shuffle_epi8( d, rol16 ); \
+    c = _mm_add_epi32( c, d ); b = _mm_xor_si128( b, c ); b = CHACHA_XMM_ROL( b, 12 ); \
+    a = _mm_add_epi32( a, b ); d = _mm_xor_si128( d, a ); d = _mm_shuffle_epi8( d, rol8 ); \
+    c = _mm_add_epi32( c, d ); b = _mm_xor_si128( b, c ); b = CHACHA_XMM_ROL( b, 7 ); \
+}
+
+static
+VOID
+SYMCRYPT_CALL
+SymCryptChaCha20QuicHpMasksXmm(
+    _In_reads_( 8 )                                         const UINT32 *  pKey,
+    _In_reads_( nSamples * SYMCRYPT_QUIC_HP_SAMPLE_SIZE )   PCBYTE          pbSamples,
+    _Out_writes_( nSamples * SYMCRYPT_QUIC_HP_MASK_SIZE )   PBYTE           pbMasks,
+                                                            SIZE_T          nSamples )
+//
+// Computes the masks for 4 samples at a time, one sample per 32-bit lane.
+// nSamples must be a multiple of 4.
+//
+{
+    const __m128i rol16 = _mm_set_epi8( 13, 12, 15, 14,  9,  8, 11, 10,  5,  4,  7,  6,  1,  0,  3,  2 );
+    const __m128i rol8  = _mm_set_epi8( 14, 13, 12, 15, 10,  9,  8, 11,  6,  5,  4,  7,  2,  1,  0,  3 );
+    __m128i s0, s1, s2, s3, s4, s5, s6, s7, s8, s9, s10, s11, s12, s13, s14, s15;
+    __m128i t0, t1, t2, t3;
+    SYMCRYPT_ALIGN UINT32 w0[4];
+    SYMCRYPT_ALIGN UINT32 w1[4];
+    int i;
+
+    SYMCRYPT_ASSERT( (nSamples & 3) == 0 );
+
+    while( nSamples >= 4 )
+    {
+        //
+        // Transpose the 4 samples so that s12..s15 each hold one word of all 4 samples
+        //
+        t0 = _mm_loadu_si128( (__m128i *) (pbSamples +  0) );
+        t1 = _mm_loadu_si128( (__m128i *) (pbSamples + 16) );
+        t2 = _mm_loadu_si128( (__m128i *) (pbSamples + 32) );
+        t3 = _mm_loadu_si128( (__m128i *) (pbSamples + 48) );
+
+        s12 = _mm_unpacklo_epi32( t0, t1 );
+        s13 = _mm_unpacklo_epi32( t2, t3 );
+        s14 = _mm_unpackhi_epi32( t0, t1 );
+        s15 = _mm_unpackhi_epi32( t2, t3 );
+
+        t0 = _mm_unpacklo_epi64( s12, s13 );
+        t1 = _mm_unpackhi_epi64( s12, s13 );
+        t2 = _mm_unpacklo_epi64( s14, s15 );
+        t3 = _mm_unpackhi_epi64( s14, s15 );
+
+        s12 = t0;
+        s13 = t1;
+        s14 = t2;
+        s15 = t3;
+
+        s0  = _mm_set1_epi32( 0x61707865 );
+        s1  = _mm_set1_epi32( 0x3320646e );
+        s2  = _mm_set1_epi32( 0x79622d32 );
+        s3  = _mm_set1_epi32( 0x6b206574 );
+        s4  = _mm_set1_epi32( pKey[0] );
+        s5  = _mm_set1_epi32( pKey[1] );
+        s6  = _mm_set1_epi32( pKey[2] );
+        s7  = _mm_set1_epi32( pKey[3] );
+        s8  = _mm_set1_epi32( pKey[4] );
+        s9  = _mm_set1_epi32( pKey[5] );
+        s10 = _mm_set1_epi32( pKey[6] );
+        s11 = _mm_set1_epi32( pKey[7] );
+
+        for( i=0; i<10; i++ )
+        {
+            CHACHA_XMM_QUARTERROUND( s0 , s4 , s8 , s12 );
+            CHACHA_XMM_QUARTERROUND( s1 , s5 , s9 , s13 );
+            CHACHA_XMM_QUARTERROUND( s2 , s6 , s10, s14 );
+            CHACHA_XMM_QUARTERROUND( s3 , s7 , s11, s15 );
+
+            CHACHA_XMM_QUARTERROUND( s0 , s5 , s10, s15 );
+            CHACHA_XMM_QUARTERROUND( s1 , s6 , s11, s12 );
+            CHACHA_XMM_QUARTERROUND( s2 , s7 , s8 , s13 );
+            CHACHA_XMM_QUARTERROUND( s3 , s4 , s9 , s14 );
+        }
+
+        s0 = _mm_add_epi32( s0, _mm_set1_epi32( 0x61707865 ) );
+        s1 = _mm_add_epi32( s1, _mm_set1_epi32( 0x3320646e ) );
+
+        _mm_store_si128( (__m128i *) &w0[0], s0 );
+        _mm_store_si128( (__m128i *) &w1[0], s1 );
+
+        for( i=0; i<4; i++ )
+        {
+            SYMCRYPT_STORE_LSBFIRST32( pbMasks, w0[i] );
+            pbMasks[4] = (BYTE) w1[i];
+            pbMasks += SYMCRYPT_QUIC_HP_MASK_SIZE;
+        }
+
+        pbSamples += 4 * SYMCRYPT_QUIC_HP_SAMPLE_SIZE;
+        nSamples -= 4;
+    }
+
+    SymCryptWipeKnownSize( w0, sizeof( w0 ) );
+    SymCryptWipeKnownSize( w1, sizeof( w1 ) );
+}
+
+#endif
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptChaCha20QuicHeaderProtectionMasks(
+    _In_reads_( cbKey )                                     PCBYTE  pbKey,
+                                                            SIZE_T  cbKey,
+    _In_reads_( nSamples * SYMCRYPT_QUIC_HP_SAMPLE_SIZE )   PCBYTE  pbSamples,
+    _Out_writes_( nSamples * SYMCRYPT_QUIC_HP_MASK_SIZE )   PBYTE   pbMasks,
+                                                            SIZE_T  nSamples )
+{
+    SYMCRYPT_ERROR  scError = SYMCRYPT_NO_ERROR;
+    UINT32          key[8];
+    SIZE_T          nParallel;
+#if SYMCRYPT_CPU_X86
+    SYMCRYPT_EXTENDED_SAVE_DATA SaveData;
+#endif
+
+    if( cbKey != 32 )
+    {
+        scError = SYMCRYPT_WRONG_KEY_SIZE;
+        goto cleanup;
+    }
+
+    SymCryptLsbFirstToUint32( pbKey, &key[0], 8 );
+
+    nParallel = nSamples & ~(SIZE_T)3;
+
+#if SYMCRYPT_CPU_AMD64
+    if( nParallel > 0 && SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_SSSE3 ) )
+    {
+        SymCryptChaCha20QuicHpMasksXmm( key, pbSamples, pbMasks, nParallel );
+        pbSamples += nParallel * SYMCRYPT_QUIC_HP_SAMPLE_SIZE;
+        pbMasks += nParallel * SYMCRYPT_QUIC_HP_MASK_SIZE;
+        nSamples -= nParallel;
+    }
+#elif SYMCRYPT_CPU_X86
+    if( nParallel > 0 &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_SSSE3 ) &&
+        SymCryptSaveXmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptChaCha20QuicHpMasksXmm( key, pbSamples, pbMasks, nParallel );
+        SymCryptRestoreXmm( &SaveData );
+        pbSamples += nParallel * SYMCRYPT_QUIC_HP_SAMPLE_SIZE;
+        pbMasks += nParallel * SYMCRYPT_QUIC_HP_MASK_SIZE;
+        nSamples -= nParallel;
+    }
+#else
+    UNREFERENCED_PARAMETER( nParallel );
+#endif
+
+    while( nSamples > 0 )
+    {
+        SymCryptChaCha20QuicHpMaskC( key, pbSamples, pbMasks );
+        pbSamples += SYMCRYPT_QUIC_HP_SAMPLE_SIZE;
+        pbMasks += SYMCRYPT_QUIC_HP_MASK_SIZE;
+        nSamples--;
+    }
+
+    SymCryptWipeKnownSize( key, sizeof( key ) );
+
+cleanup:
+    return scError;
+}
+
 static const BYTE   chacha20KatAnswer[ 3 ] = { 0xb5, 0xe0, 0x54 };
 
 VOID
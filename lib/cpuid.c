@@ -31,6 +31,12 @@
 #define CPUID_70_EBX_SHANI_BIT      29
 #define CPUID_70_EBX_ADX_BIT        19
 #define CPUID_70_EBX_BMI2_BIT       8
+#define CPUID_70_EBX_AVX512F_BIT    16
+#define CPUID_70_EBX_AVX512DQ_BIT   17
+#define CPUID_70_EBX_AVX512BW_BIT   30
+#define CPUID_70_EBX_AVX512VL_BIT   31
+#define CPUID_70_ECX_VAES_BIT       9
+#define CPUID_70_ECX_VPCLMULQDQ_BIT 10
 
 
 #define CPUID_1_ECX_OSXSAVE_BIT     27     
@@ -58,12 +64,18 @@ CPUID_BIT_INFO  cpuidBitInfo[] = {
     {1, WORD_EDX, CPUID_1_EDX_SSE2_BIT,         SYMCRYPT_CPU_FEATURE_SSE2 | SYMCRYPT_CPU_FEATURE_SSSE3 },
     {1, WORD_ECX, CPUID_1_ECX_SSE3_BIT,         SYMCRYPT_CPU_FEATURE_SSSE3 },
     {1, WORD_ECX, CPUID_1_ECX_SSSE3_BIT,        SYMCRYPT_CPU_FEATURE_SSSE3 },
-    {1, WORD_ECX, CPUID_1_ECX_AVX_BIT,          SYMCRYPT_CPU_FEATURE_AVX2 },
+    {1, WORD_ECX, CPUID_1_ECX_AVX_BIT,          SYMCRYPT_CPU_FEATURE_AVX2 | SYMCRYPT_CPU_FEATURE_VAES | SYMCRYPT_CPU_FEATURE_VPCLMULQDQ | SYMCRYPT_CPU_FEATURE_AVX512 },
     {7, WORD_EBX, CPUID_70_EBX_AVX2_BIT,        SYMCRYPT_CPU_FEATURE_AVX2 },
     {7, WORD_EBX, CPUID_70_EBX_RDSEED_BIT,      SYMCRYPT_CPU_FEATURE_RDSEED },
     {7, WORD_EBX, CPUID_70_EBX_SHANI_BIT,       SYMCRYPT_CPU_FEATURE_SHANI },
     {7, WORD_EBX, CPUID_70_EBX_ADX_BIT,         SYMCRYPT_CPU_FEATURE_ADX },
     {7, WORD_EBX, CPUID_70_EBX_BMI2_BIT,        SYMCRYPT_CPU_FEATURE_BMI2 },
+    {7, WORD_EBX, CPUID_70_EBX_AVX512F_BIT,     SYMCRYPT_CPU_FEATURE_AVX512 },
+    {7, WORD_EBX, CPUID_70_EBX_AVX512DQ_BIT,    SYMCRYPT_CPU_FEATURE_AVX512 },
+    {7, WORD_EBX, CPUID_70_EBX_AVX512BW_BIT,    SYMCRYPT_CPU_FEATURE_AVX512 },
+    {7, WORD_EBX, CPUID_70_EBX_AVX512VL_BIT,    SYMCRYPT_CPU_FEATURE_AVX512 },
+    {7, WORD_ECX, CPUID_70_ECX_VAES_BIT,        SYMCRYPT_CPU_FEATURE_VAES },
+    {7, WORD_ECX, CPUID_70_ECX_VPCLMULQDQ_BIT,  SYMCRYPT_CPU_FEATURE_VPCLMULQDQ },
 };
 
 extern void __cpuid( _Out_writes_(4) int a[4], int b);          // Add SAL annotation to intrinsic declaration to keep Prefast happy.
@@ -78,6 +90,7 @@ SymCryptDetectCpuFeaturesByCpuid( UINT32 flags )
     int     maxInfoType;
     int     i;
     BOOLEAN allowYmm;
+    BOOLEAN allowZmm;
     __int64 xGetBvResult;
 
     //
@@ -93,7 +106,10 @@ SymCryptDetectCpuFeaturesByCpuid( UINT32 flags )
         SYMCRYPT_CPU_FEATURE_BMI2       |
         SYMCRYPT_CPU_FEATURE_ADX        |
         SYMCRYPT_CPU_FEATURE_RDRAND     |
-        SYMCRYPT_CPU_FEATURE_RDSEED
+        SYMCRYPT_CPU_FEATURE_RDSEED     |
+        SYMCRYPT_CPU_FEATURE_VAES       |
+        SYMCRYPT_CPU_FEATURE_VPCLMULQDQ |
+        SYMCRYPT_CPU_FEATURE_AVX512
         );
 
     InfoType = 0; 
@@ -125,8 +141,10 @@ SymCryptDetectCpuFeaturesByCpuid( UINT32 flags )
         // Use XGETBV and check that XCR0[2:1] = '11b' signalign that both XMM and YMM are enabled by OS
         // Note that we only disable the AVX2 usage; AESNI & XMM registers are used independent of OS support, because
         // all our (known) OSes have it.
+        // The ZMM registers additionally require XCR0[7:5] = '111b' for the opmask and the upper ZMM state.
         //
         allowYmm = FALSE;
+        allowZmm = FALSE;
         SymCryptCpuidExFunc( CPUInfo, 1, 0 );
 
         if( (CPUInfo[WORD_ECX] & (1 << CPUID_1_ECX_OSXSAVE_BIT)) != 0 )
@@ -138,15 +156,33 @@ SymCryptDetectCpuFeaturesByCpuid( UINT32 flags )
             if( (xGetBvResult & 0x6) == 0x6)
             {
                 allowYmm = TRUE;
+
+                // Check that bits 5, 6, and 7 are set, corresponding to the opmask and ZMM register state
+                if( (xGetBvResult & 0xe0) == 0xe0 )
+                {
+                    allowZmm = TRUE;
+                }
             }
         }
 
         if( !allowYmm )
         {
             // Disallow the AVX2-dependent code because we don't have OS YMM support.
-            result |= SYMCRYPT_CPU_FEATURE_AVX2;
+            result |= SYMCRYPT_CPU_FEATURE_AVX2 | SYMCRYPT_CPU_FEATURE_VAES | SYMCRYPT_CPU_FEATURE_VPCLMULQDQ;
+        }
+
+        if( !allowZmm )
+        {
+            result |= SYMCRYPT_CPU_FEATURE_AVX512;
         }
     }
+    else
+    {
+        //
+        // Without the OS check we don't know whether the ZMM state is saved, so we don't use it.
+        //
+        result |= SYMCRYPT_CPU_FEATURE_AVX512;
+    }
 
 
     if( (result & SYMCRYPT_CPU_FEATURE_AESNI) == 0 )    // thus, if AES-NI is present according to CPUID
@@ -12,7 +12,7 @@ VOID SYMCRYPT_CALL SymCryptCpuidExCallback( int cpuInfo[4], int function_id, int
 SYMCRYPT_CPU_FEATURES SYMCRYPT_CALL SymCryptCpuFeaturesNeverPresentEnvWin10Sgx()
 {
 #if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64 
-    return SYMCRYPT_CPU_FEATURE_AVX2;
+    return SYMCRYPT_CPU_FEATURE_AVX2 | SYMCRYPT_CPU_FEATURE_VAES | SYMCRYPT_CPU_FEATURE_VPCLMULQDQ | SYMCRYPT_CPU_FEATURE_AVX512;
 #else
     return 0;
 #endif    
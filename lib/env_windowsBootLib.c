@@ -24,8 +24,9 @@ SYMCRYPT_CPU_FEATURES SYMCRYPT_CALL SymCryptCpuFeaturesNeverPresentEnvWindowsBoo
     // hashing, so the performance loss is quite small.
     // We considered locking out AES-NI as well; that would reduce codesize, but slow down BitLocker boot on
     // x86 which is an important mobile scenario.
+    // The VAES, VPCLMULQDQ, and AVX512 code is AMD64-only, so we lock it out as well.
     //
-    return SYMCRYPT_CPU_FEATURE_AVX2;
+    return SYMCRYPT_CPU_FEATURE_AVX2 | SYMCRYPT_CPU_FEATURE_VAES | SYMCRYPT_CPU_FEATURE_VPCLMULQDQ | SYMCRYPT_CPU_FEATURE_AVX512;
 #elif SYMCRYPT_CPU_ARM | SYMCRYPT_CPU_ARM64 | SYMCRYPT_CPU_AMD64
     return 0;
 #endif
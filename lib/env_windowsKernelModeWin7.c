@@ -74,9 +74,14 @@ SymCryptInitEnvWindowsKernelmodeWin7nLater()
 
     if( !(FeatureMask & XSTATE_MASK_AVX ) )
     {
-        g_SymCryptCpuFeaturesNotPresent |= SYMCRYPT_CPU_FEATURE_AVX2;
+        g_SymCryptCpuFeaturesNotPresent |= SYMCRYPT_CPU_FEATURE_AVX2 | SYMCRYPT_CPU_FEATURE_VAES | SYMCRYPT_CPU_FEATURE_VPCLMULQDQ;
     }
 
+    //
+    // Our SaveYmm function only saves the AVX state, so we can't use the ZMM registers.
+    //
+    g_SymCryptCpuFeaturesNotPresent |= SYMCRYPT_CPU_FEATURE_AVX512;
+
 #elif SYMCRYPT_CPU_ARM | SYMCRYPT_CPU_ARM64
 
     SymCryptDetectCpuFeaturesFromRegisters();
@@ -21,8 +21,9 @@ SYMCRYPT_CPU_FEATURES SYMCRYPT_CALL SymCryptCpuFeaturesNeverPresentEnvWindowsUse
     // which creates a dependency on a DLL that is absent in some of our SKUs.
     // As AVX2 is only used in parallel hashing, it isn't worth the effort to use it in earlier Windows versions.
     // We only use AVX2 if the binary is targeted at Win8.1 and later.
+    // The same applies to the other features that use the YMM and ZMM registers.
     //
-    return SYMCRYPT_CPU_FEATURE_AVX2;
+    return SYMCRYPT_CPU_FEATURE_AVX2 | SYMCRYPT_CPU_FEATURE_VAES | SYMCRYPT_CPU_FEATURE_VPCLMULQDQ | SYMCRYPT_CPU_FEATURE_AVX512;
 
 #else
 
@@ -47,7 +48,7 @@ SymCryptInitEnvWindowsUsermodeWin7nLater()
     // 
     SymCryptDetectCpuFeaturesByCpuid( SYMCRYPT_CPUID_DETECT_FLAG_CHECK_OS_SUPPORT_FOR_YMM );
 
-    g_SymCryptCpuFeaturesNotPresent |= SYMCRYPT_CPU_FEATURE_AVX2;
+    g_SymCryptCpuFeaturesNotPresent |= SYMCRYPT_CPU_FEATURE_AVX2 | SYMCRYPT_CPU_FEATURE_VAES | SYMCRYPT_CPU_FEATURE_VPCLMULQDQ | SYMCRYPT_CPU_FEATURE_AVX512;
 
     //
     // Our SaveXmm function never fails because it doesn't have to do anything in User mode.
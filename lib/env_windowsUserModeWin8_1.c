@@ -33,7 +33,15 @@ SymCryptInitEnvWindowsUsermodeWin8_1nLater()
         //
         // Don't use Ymm registers if the OS doesn't report them as available.
         //
-        g_SymCryptCpuFeaturesNotPresent |= SYMCRYPT_CPU_FEATURE_AVX2;
+        g_SymCryptCpuFeaturesNotPresent |= SYMCRYPT_CPU_FEATURE_AVX2 | SYMCRYPT_CPU_FEATURE_VAES | SYMCRYPT_CPU_FEATURE_VPCLMULQDQ;
+    }
+
+    if( (GetEnabledXStateFeatures() & XSTATE_MASK_AVX512) != XSTATE_MASK_AVX512 )
+    {
+        //
+        // Same for the Zmm registers
+        //
+        g_SymCryptCpuFeaturesNotPresent |= SYMCRYPT_CPU_FEATURE_AVX512;
     }
 
     //
@@ -6,7 +6,7 @@
 
 #include "precomp.h"
 
-#define GCM_REQUIRED_NONCE_SIZE     (12)
+#define GCM_DEFAULT_NONCE_SIZE      (12)
 #define GCM_MAX_DATA_SIZE           (((UINT64)1 << 36) - 32)
 #define GCM_MIN_TAG_SIZE            (12)
 #define GCM_MAX_TAG_SIZE            (16)
@@ -32,9 +32,10 @@ SymCryptGcmValidateParameters(
     }
 
     //
-    // We only support 12-byte nonces, are per SP800-38D recommendations.
+    // SP800-38D allows nonces of 1 to 2^64 - 1 bits; we support any whole number of bytes in that range.
+    // 12-byte nonces are recommended by SP800-38D and are the most efficient.
     //
-    if( cbNonce != GCM_REQUIRED_NONCE_SIZE )
+    if( cbNonce == 0 || ((UINT64)cbNonce >> 61) > 0 )
     {
         return SYMCRYPT_WRONG_NONCE_SIZE;
     }
@@ -168,20 +169,13 @@ SymCryptGcmEncryptDecryptPart(
         bytesToProcess = cbData & GCM_BLOCK_ROUND_MASK;
 
         //
-        // We use the CTR mode function that increments 64 bits, rather than the 32 bits that GCM requires.
-        // As we only support 12-byte nonces, the 32-bit counter never overflows, and we can safely use
-        // the 64-bit incrementing primitive. 
-        // If we ever support other nonce sizes this is going to be a big problem.
-        // You can't fake a 32-bit counter using a 64-bit counter function without side-channels that expose
-        // information about the current counter value. 
-        // With other nonce sizes the actual counter value itself is not public, so we can't expose that. 
-        // We can do two things: 
-        // - create SymCryptCtrMsb32
-        // - Accept that we leak information about the counter value; after all it is not treated as a 
-        //   secret when the nonce is 12 bytes.
+        // GCM uses a 32-bit counter. With 12-byte nonces the counter starts at 2 and never wraps, 
+        // but with other nonce sizes the initial counter value is derived from GHASH and is not public.
+        // SymCryptCtrMsb32 wraps the counter in constant time, so we don't leak any information
+        // about the counter value.
         //
         SYMCRYPT_ASSERT( pState->pKey->pBlockCipher->blockSize == SYMCRYPT_GCM_BLOCK_SIZE );
-        SymCryptCtrMsb64(   pState->pKey->pBlockCipher, 
+        SymCryptCtrMsb32(   pState->pKey->pBlockCipher, 
                             &pState->pKey->blockcipherKey,
                             &pState->counterBlock[0],
                             pbSrc,
@@ -198,7 +192,7 @@ SymCryptGcmEncryptDecryptPart(
         SymCryptWipeKnownSize( &pState->keystreamBlock[0], SYMCRYPT_GCM_BLOCK_SIZE );
 
         SYMCRYPT_ASSERT( pState->pKey->pBlockCipher->blockSize == SYMCRYPT_GCM_BLOCK_SIZE );
-        SymCryptCtrMsb64(   pState->pKey->pBlockCipher, 
+        SymCryptCtrMsb32(   pState->pKey->pBlockCipher, 
                             &pState->pKey->blockcipherKey,
                             &pState->counterBlock[0],
                             &pState->keystreamBlock[0],
@@ -217,6 +211,29 @@ SymCryptGcmEncryptDecryptPart(
 
 
 
+VOID
+SYMCRYPT_CALL
+SymCryptGcmComputeGhash(  
+    _Inout_                                 PSYMCRYPT_GCM_STATE pState,
+    _Out_writes_( SYMCRYPT_GCM_BLOCK_SIZE ) PBYTE               pbResult )
+{
+    //
+    // Add the padding and the length block, and return the final GHASH value as an array of bytes.
+    // The result still has to be encrypted with the J0 key stream block to get the tag.
+    //
+    SymCryptGcmPadMacData( pState );
+
+    SYMCRYPT_STORE_MSBFIRST64( &pbResult[0], pState->cbAuthData * 8 );
+    SYMCRYPT_STORE_MSBFIRST64( &pbResult[8], pState->cbData * 8 );
+
+    SymCryptGcmAddMacData( pState, pbResult, SYMCRYPT_GCM_BLOCK_SIZE );
+
+    SYMCRYPT_STORE_MSBFIRST64( &pbResult[0], pState->ghashState.ull[1] );
+    SYMCRYPT_STORE_MSBFIRST64( &pbResult[8], pState->ghashState.ull[0] );
+}
+
+
+
 VOID
 SYMCRYPT_CALL
 SymCryptGcmComputeTag(  
@@ -224,37 +241,22 @@ SymCryptGcmComputeTag(
     _Out_writes_( SYMCRYPT_GCM_BLOCK_SIZE ) PBYTE               pbTag )
 {
     SYMCRYPT_ALIGN BYTE  buf[SYMCRYPT_GCM_BLOCK_SIZE];
-    UINT64   cntLow;
+    UINT32   cntLow;
     
-    SymCryptGcmPadMacData( pState );
-
-    SYMCRYPT_STORE_MSBFIRST64( &buf[0], pState->cbAuthData * 8 );
-    SYMCRYPT_STORE_MSBFIRST64( &buf[8], pState->cbData * 8 );
-
-    SymCryptGcmAddMacData( pState, buf, SYMCRYPT_GCM_BLOCK_SIZE );
+    SymCryptGcmComputeGhash( pState, buf );
 
     //
-    // Set up the correct counter block value 
-    // This is a bit tricky. Normally all we have to do is set the last
-    // 4 bytes to 00000001. But if the message is 2^36+32 bytes then 
-    // our use of a 64-bit incrementing CTR function has incremented bytes
-    // 8-11 of the nonce. (The 4-byte counter has overflowed, and 
-    // the carry went into the next byte(s).)
-    // We resolve this by decrementing the 8-byte value first,
-    // and then setting the proper bits.
+    // Set up the counter block value J0 that is used to encrypt the tag.
+    // The counter was incremented once in SymCryptGcmInit and once for each (partial)
+    // data block. The 32-bit counter wraps modulo 2^32, so we subtract the same 
+    // amount modulo 2^32. This does not depend on the counter value, which might be secret.
     //
-    cntLow = SYMCRYPT_LOAD_MSBFIRST64( &pState->counterBlock[8] );
-    cntLow = ((cntLow - 1) & 0xffffffff00000000) | 1;
-    SYMCRYPT_STORE_MSBFIRST64( &pState->counterBlock[8], cntLow );
+    cntLow = SYMCRYPT_LOAD_MSBFIRST32( &pState->counterBlock[12] );
+    cntLow -= 1 + (UINT32)((pState->cbData + SYMCRYPT_GCM_BLOCK_SIZE - 1) / SYMCRYPT_GCM_BLOCK_SIZE);
+    SYMCRYPT_STORE_MSBFIRST32( &pState->counterBlock[12], cntLow );
 
-    //
-    // Conver the GHash state to an array of bytes
-    //
-    SYMCRYPT_STORE_MSBFIRST64( &buf[0], pState->ghashState.ull[1] );
-    SYMCRYPT_STORE_MSBFIRST64( &buf[8], pState->ghashState.ull[0] );
-    
     SYMCRYPT_ASSERT( pState->pKey->pBlockCipher->blockSize == SYMCRYPT_GCM_BLOCK_SIZE );
-    SymCryptCtrMsb64(   pState->pKey->pBlockCipher, 
+    SymCryptCtrMsb32(   pState->pKey->pBlockCipher, 
                         &pState->pKey->blockcipherKey,
                         &pState->counterBlock[0],
                         buf,
@@ -338,19 +340,15 @@ SymCryptGcmKeyCopy( _In_ PCSYMCRYPT_GCM_EXPANDED_KEY pSrc, _Out_ PSYMCRYPT_GCM_E
 
 
 
-SYMCRYPT_NOINLINE
 VOID
 SYMCRYPT_CALL
-SymCryptGcmInit( 
+SymCryptGcmResetState( 
     _Out_                       PSYMCRYPT_GCM_STATE         pState,
-    _In_                        PCSYMCRYPT_GCM_EXPANDED_KEY pExpandedKey,
-    _In_reads_( cbNonce )      PCBYTE                      pbNonce,
-                                SIZE_T                      cbNonce )
+    _In_                        PCSYMCRYPT_GCM_EXPANDED_KEY pExpandedKey )
 {
-    UNREFERENCED_PARAMETER( cbNonce );          // It is used in an ASSERT, but only in CHKed builds.
-
-    SYMCRYPT_ASSERT( cbNonce == GCM_REQUIRED_NONCE_SIZE );
-
+    //
+    // Set up everything except the counter block
+    //
     SYMCRYPT_CHECK_MAGIC( pExpandedKey );
     
     pState->pKey = pExpandedKey;
@@ -358,13 +356,53 @@ SymCryptGcmInit(
     pState->cbAuthData = 0;
     pState->bytesInMacBlock = 0;
     SymCryptWipeKnownSize( &pState->ghashState, sizeof( pState->ghashState ) );
+}
+
+
+
+SYMCRYPT_NOINLINE
+VOID
+SYMCRYPT_CALL
+SymCryptGcmInit( 
+    _Out_                       PSYMCRYPT_GCM_STATE         pState,
+    _In_                        PCSYMCRYPT_GCM_EXPANDED_KEY pExpandedKey,
+    _In_reads_( cbNonce )      PCBYTE                      pbNonce,
+                                SIZE_T                      cbNonce )
+{
+    SYMCRYPT_ALIGN BYTE buf[SYMCRYPT_GCM_BLOCK_SIZE];
+
+    SYMCRYPT_ASSERT( cbNonce > 0 );
+
+    SymCryptGcmResetState( pState, pExpandedKey );
 
     //
-    // Set up the counter block value
+    // Set up the counter block value.
+    // The counter block starts at J0 + 1; J0 is used for the tag.
     //
-    memcpy( &pState->counterBlock[0], pbNonce, GCM_REQUIRED_NONCE_SIZE );
-    SymCryptWipeKnownSize( &pState->counterBlock[12], 4 );
-    pState->counterBlock[15] = 2;
+    if( cbNonce == GCM_DEFAULT_NONCE_SIZE )
+    {
+        memcpy( &pState->counterBlock[0], pbNonce, GCM_DEFAULT_NONCE_SIZE );
+        SymCryptWipeKnownSize( &pState->counterBlock[12], 4 );
+        pState->counterBlock[15] = 2;
+    } else {
+        //
+        // J0 = GHASH( nonce || zero padding || [0]_64 || [len(nonce)]_64 ), see SP800-38D section 7.1.
+        // We use the GHASH state of the GCM computation, which is reset afterwards.
+        //
+        SymCryptGcmAddMacData( pState, pbNonce, cbNonce );
+        SymCryptGcmPadMacData( pState );
+
+        SymCryptWipeKnownSize( &buf[0], 8 );
+        SYMCRYPT_STORE_MSBFIRST64( &buf[8], (UINT64)cbNonce * 8 );
+        SymCryptGcmAddMacData( pState, buf, SYMCRYPT_GCM_BLOCK_SIZE );
+
+        SYMCRYPT_STORE_MSBFIRST64( &pState->counterBlock[0], pState->ghashState.ull[1] );
+        SYMCRYPT_STORE_MSBFIRST64( &pState->counterBlock[8], pState->ghashState.ull[0] );
+        SYMCRYPT_STORE_MSBFIRST32( &pState->counterBlock[12], 1 + SYMCRYPT_LOAD_MSBFIRST32( &pState->counterBlock[12] ) );
+
+        SymCryptWipeKnownSize( &pState->ghashState, sizeof( pState->ghashState ) );
+        SymCryptWipeKnownSize( buf, sizeof( buf ) );
+    }
 
     SYMCRYPT_SET_MAGIC( pState );
 }
@@ -413,6 +451,8 @@ SymCryptGcmEncryptPart(
     _Out_writes_( cbData )  PBYTE               pbDst,
                             SIZE_T              cbData )
 {
+    SIZE_T bytesToProcess;
+
     if( pState->cbData == 0 )
     {
         //
@@ -421,6 +461,35 @@ SymCryptGcmEncryptPart(
         SymCryptGcmPadMacData( pState );
     }
 
+    if( pState->pKey->pBlockCipher->gcmEncryptPartFunc != NULL )
+    {
+        //
+        // The block cipher has an optimized GCM implementation, which only processes
+        // whole blocks starting at a block boundary.
+        // We first complete any partial block using the generic code.
+        //
+        bytesToProcess = min( cbData, (SIZE_T)(0 - pState->cbData) & GCM_BLOCK_MOD_MASK );
+        if( bytesToProcess > 0 )
+        {
+            SymCryptGcmEncryptDecryptPart( pState, pbSrc, pbDst, bytesToProcess );
+            SymCryptGcmAddMacData( pState, pbDst, bytesToProcess );
+            pbSrc += bytesToProcess;
+            pbDst += bytesToProcess;
+            cbData -= bytesToProcess;
+        }
+
+        bytesToProcess = cbData & GCM_BLOCK_ROUND_MASK;
+        if( bytesToProcess > 0 )
+        {
+            SYMCRYPT_ASSERT( pState->cbData + bytesToProcess <= GCM_MAX_DATA_SIZE );
+            pState->pKey->pBlockCipher->gcmEncryptPartFunc( pState, pbSrc, pbDst, bytesToProcess );
+            pState->cbData += bytesToProcess;
+            pbSrc += bytesToProcess;
+            pbDst += bytesToProcess;
+            cbData -= bytesToProcess;
+        }
+    }
+
     //
     // Do the actual encryption
     //
@@ -453,6 +522,8 @@ SymCryptGcmDecryptPart(
     _Out_writes_( cbData )  PBYTE               pbDst,
                             SIZE_T              cbData )
 {
+    SIZE_T bytesToProcess;
+
     if( pState->cbData == 0 )
     {
         //
@@ -461,6 +532,34 @@ SymCryptGcmDecryptPart(
         SymCryptGcmPadMacData( pState );
     }
 
+    if( pState->pKey->pBlockCipher->gcmDecryptPartFunc != NULL )
+    {
+        //
+        // Complete any partial block with the generic code, then let the 
+        // optimized implementation process the whole blocks.
+        //
+        bytesToProcess = min( cbData, (SIZE_T)(0 - pState->cbData) & GCM_BLOCK_MOD_MASK );
+        if( bytesToProcess > 0 )
+        {
+            SymCryptGcmAddMacData( pState, pbSrc, bytesToProcess );
+            SymCryptGcmEncryptDecryptPart( pState, pbSrc, pbDst, bytesToProcess );
+            pbSrc += bytesToProcess;
+            pbDst += bytesToProcess;
+            cbData -= bytesToProcess;
+        }
+
+        bytesToProcess = cbData & GCM_BLOCK_ROUND_MASK;
+        if( bytesToProcess > 0 )
+        {
+            SYMCRYPT_ASSERT( pState->cbData + bytesToProcess <= GCM_MAX_DATA_SIZE );
+            pState->pKey->pBlockCipher->gcmDecryptPartFunc( pState, pbSrc, pbDst, bytesToProcess );
+            pState->cbData += bytesToProcess;
+            pbSrc += bytesToProcess;
+            pbDst += bytesToProcess;
+            cbData -= bytesToProcess;
+        }
+    }
+
     SymCryptGcmAddMacData( pState, pbSrc, cbData );
     
     //
@@ -587,6 +686,509 @@ SymCryptGcmDecrypt(
 }
 
 
+//
+// Scatter/gather versions; SymCryptIovecCrypt passes whole blocks to the Part functions
+// so that they can use the bulk code.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptGcmEncryptIovecFunc( PVOID pContext, PCBYTE pbSrc, PBYTE pbDst, SIZE_T cbData )
+{
+    SymCryptGcmEncryptPart( (PSYMCRYPT_GCM_STATE) pContext, pbSrc, pbDst, cbData );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptGcmDecryptIovecFunc( PVOID pContext, PCBYTE pbSrc, PBYTE pbDst, SIZE_T cbData )
+{
+    SymCryptGcmDecryptPart( (PSYMCRYPT_GCM_STATE) pContext, pbSrc, pbDst, cbData );
+}
+
+SYMCRYPT_NOINLINE
+VOID
+SYMCRYPT_CALL
+SymCryptGcmEncryptIovec(
+    _In_                            PCSYMCRYPT_GCM_EXPANDED_KEY pExpandedKey,
+    _In_reads_( cbNonce )           PCBYTE                      pbNonce,
+                                    SIZE_T                      cbNonce,
+    _In_reads_opt_( cbAuthData )    PCBYTE                      pbAuthData,
+                                    SIZE_T                      cbAuthData,
+    _In_reads_( nSrc )              PCSYMCRYPT_IOVEC            pSrc,
+                                    SIZE_T                      nSrc,
+    _In_reads_( nDst )              PCSYMCRYPT_IOVEC            pDst,
+                                    SIZE_T                      nDst,
+    _Out_writes_( cbTag )           PBYTE                       pbTag,
+                                    SIZE_T                      cbTag )
+{
+    SYMCRYPT_GCM_STATE  state;
+
+    SymCryptGcmInit( &state, pExpandedKey, pbNonce, cbNonce );
+    SymCryptGcmAuthPart( &state, pbAuthData, cbAuthData );
+    SymCryptIovecCrypt( pSrc, nSrc, pDst, nDst, SYMCRYPT_GCM_BLOCK_SIZE, &SymCryptGcmEncryptIovecFunc, &state );
+    SymCryptGcmEncryptFinal( &state, pbTag, cbTag );
+}
+
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_NOINLINE
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptGcmDecryptIovec(
+    _In_                            PCSYMCRYPT_GCM_EXPANDED_KEY pExpandedKey,
+    _In_reads_( cbNonce )           PCBYTE                      pbNonce,
+                                    SIZE_T                      cbNonce,
+    _In_reads_opt_( cbAuthData )    PCBYTE                      pbAuthData,
+                                    SIZE_T                      cbAuthData,
+    _In_reads_( nSrc )              PCSYMCRYPT_IOVEC            pSrc,
+                                    SIZE_T                      nSrc,
+    _In_reads_( nDst )              PCSYMCRYPT_IOVEC            pDst,
+                                    SIZE_T                      nDst,
+    _In_reads_( cbTag )             PCBYTE                      pbTag,
+                                    SIZE_T                      cbTag )
+{
+    SYMCRYPT_ERROR      status;
+    SYMCRYPT_GCM_STATE  state;
+
+    SymCryptGcmInit( &state, pExpandedKey, pbNonce, cbNonce );
+    SymCryptGcmAuthPart( &state, pbAuthData, cbAuthData );
+    SymCryptIovecCrypt( pSrc, nSrc, pDst, nDst, SYMCRYPT_GCM_BLOCK_SIZE, &SymCryptGcmDecryptIovecFunc, &state );
+
+    status = SymCryptGcmDecryptFinal( &state, pbTag, cbTag );
+    if( status != SYMCRYPT_NO_ERROR )
+    {
+        SymCryptIovecWipe( pDst, nDst );
+    }
+
+    return status;
+}
+
+
+//
+// Batched record processing
+//
+// Most of the block cipher work of a long record is done in 8-block chunks by the bulk code,
+// which keeps the block cipher pipeline full. For short records, such as those of a TLS or QUIC 
+// record layer, most of the work is the J0 block that encrypts the tag, and the 0-7 whole blocks
+// and final partial block that do not fill a chunk. Each of those is too small to keep the pipeline busy.
+// We collect these counter blocks for a group of records in a buffer and encrypt them with
+// a single ECB call, which the AES implementations process 8 blocks at a time across record boundaries.
+// Each record is then processed as usual, using the precomputed key stream for its tail and tag.
+//
+#define GCM_BATCH_MAX_RECORDS       (8)
+#define GCM_BATCH_BUFFER_BLOCKS     (32)
+#define GCM_BATCH_CHUNK_SIZE        (8 * SYMCRYPT_GCM_BLOCK_SIZE)
+
+C_ASSERT( GCM_BATCH_BUFFER_BLOCKS >= 1 + GCM_BATCH_CHUNK_SIZE / SYMCRYPT_GCM_BLOCK_SIZE );
+
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptGcmBatchCrypt(
+    _In_                            PCSYMCRYPT_GCM_EXPANDED_KEY pExpandedKey,
+    _In_reads_( nRecords )          PCSYMCRYPT_AUTHENC_RECORD   pRecords,
+                                    SIZE_T                      nRecords,
+                                    BOOLEAN                     bEncrypt,
+    _Out_writes_opt_( nRecords )    SYMCRYPT_ERROR *            pResults )
+{
+    SYMCRYPT_GCM_STATE          state;
+    SYMCRYPT_ALIGN BYTE         counterBlocks[GCM_BATCH_MAX_RECORDS][SYMCRYPT_GCM_BLOCK_SIZE];
+    SYMCRYPT_ALIGN BYTE         keystream[GCM_BATCH_BUFFER_BLOCKS * SYMCRYPT_GCM_BLOCK_SIZE];
+    SYMCRYPT_ALIGN BYTE         buf[SYMCRYPT_GCM_BLOCK_SIZE];
+    PCSYMCRYPT_AUTHENC_RECORD   pRec;
+    PBYTE                       pbKeystream;
+    SYMCRYPT_ERROR              status = SYMCRYPT_NO_ERROR;
+    SYMCRYPT_ERROR              recordStatus;
+    SIZE_T                      iFirst;
+    SIZE_T                      nGroup;
+    SIZE_T                      nBlocks;
+    SIZE_T                      nBlocksUsed = 0;
+    SIZE_T                      nTailBlocks;
+    SIZE_T                      cbBulk;
+    SIZE_T                      cbTail;
+    SIZE_T                      i;
+    SIZE_T                      j;
+    UINT32                      cntLow;
+
+    SYMCRYPT_ASSERT( pExpandedKey->pBlockCipher->blockSize == SYMCRYPT_GCM_BLOCK_SIZE );
+
+    iFirst = 0;
+    while( iFirst < nRecords )
+    {
+        //
+        // Set up the J0 and tail counter blocks for as many records as fit in the buffer.
+        //
+        nGroup = 0;
+        nBlocks = 0;
+        while( iFirst + nGroup < nRecords && nGroup < GCM_BATCH_MAX_RECORDS )
+        {
+            pRec = &pRecords[iFirst + nGroup];
+
+            SYMCRYPT_ASSERT( SymCryptGcmValidateParameters( pExpandedKey->pBlockCipher, 
+                                                            pRec->cbNonce, 
+                                                            pRec->cbAuthData, 
+                                                            pRec->cbData, 
+                                                            pRec->cbTag ) == SYMCRYPT_NO_ERROR );
+
+            nTailBlocks = (pRec->cbData % GCM_BATCH_CHUNK_SIZE + SYMCRYPT_GCM_BLOCK_SIZE - 1) / SYMCRYPT_GCM_BLOCK_SIZE;
+            if( nBlocks + 1 + nTailBlocks > GCM_BATCH_BUFFER_BLOCKS )
+            {
+                break;
+            }
+
+            SymCryptGcmInit( &state, pExpandedKey, pRec->pbNonce, pRec->cbNonce );
+            memcpy( &counterBlocks[nGroup][0], &state.counterBlock[0], SYMCRYPT_GCM_BLOCK_SIZE );
+
+            //
+            // The counter block is J0 + 1. The 32-bit counter wraps modulo 2^32, see SymCryptGcmComputeTag.
+            //
+            pbKeystream = &keystream[nBlocks * SYMCRYPT_GCM_BLOCK_SIZE];
+            cntLow = SYMCRYPT_LOAD_MSBFIRST32( &state.counterBlock[12] );
+            memcpy( pbKeystream, &state.counterBlock[0], 12 );
+            SYMCRYPT_STORE_MSBFIRST32( &pbKeystream[12], cntLow - 1 );
+
+            cntLow += (UINT32)(pRec->cbData / GCM_BATCH_CHUNK_SIZE) * (GCM_BATCH_CHUNK_SIZE / SYMCRYPT_GCM_BLOCK_SIZE);
+            for( j=1; j<=nTailBlocks; j++ )
+            {
+                memcpy( &pbKeystream[j * SYMCRYPT_GCM_BLOCK_SIZE], &state.counterBlock[0], 12 );
+                SYMCRYPT_STORE_MSBFIRST32( &pbKeystream[j * SYMCRYPT_GCM_BLOCK_SIZE + 12], cntLow );
+                cntLow++;
+            }
+
+            nBlocks += 1 + nTailBlocks;
+            nGroup++;
+        }
+
+        nBlocksUsed = max( nBlocksUsed, nBlocks );
+        SymCryptEcbEncrypt( pExpandedKey->pBlockCipher, 
+                            &pExpandedKey->blockcipherKey, 
+                            keystream, 
+                            keystream, 
+                            nBlocks * SYMCRYPT_GCM_BLOCK_SIZE );
+
+        //
+        // Process each record; the bulk code handles the whole chunks, and the tail and 
+        // tag use the key stream from the buffer.
+        //
+        pbKeystream = &keystream[0];
+        for( i=0; i<nGroup; i++ )
+        {
+            pRec = &pRecords[iFirst + i];
+            cbTail = pRec->cbData % GCM_BATCH_CHUNK_SIZE;
+            cbBulk = pRec->cbData - cbTail;
+
+            SymCryptGcmResetState( &state, pExpandedKey );
+            memcpy( &state.counterBlock[0], &counterBlocks[i][0], SYMCRYPT_GCM_BLOCK_SIZE );
+            SYMCRYPT_SET_MAGIC( &state );
+
+            SymCryptGcmAuthPart( &state, pRec->pbAuthData, pRec->cbAuthData );
+            SymCryptGcmPadMacData( &state );
+
+            //
+            // The read-once/write-once considerations are the same as for SymCryptGcmEncryptPart
+            // and SymCryptGcmDecryptPart.
+            //
+            if( bEncrypt )
+            {
+                SymCryptGcmEncryptPart( &state, pRec->pbSrc, pRec->pbDst, cbBulk );
+                SymCryptXorBytes( &pbKeystream[SYMCRYPT_GCM_BLOCK_SIZE], &pRec->pbSrc[cbBulk], &pRec->pbDst[cbBulk], cbTail );
+                SymCryptGcmAddMacData( &state, &pRec->pbDst[cbBulk], cbTail );
+            } else {
+                SymCryptGcmDecryptPart( &state, pRec->pbSrc, pRec->pbDst, cbBulk );
+                SymCryptGcmAddMacData( &state, &pRec->pbSrc[cbBulk], cbTail );
+                SymCryptXorBytes( &pbKeystream[SYMCRYPT_GCM_BLOCK_SIZE], &pRec->pbSrc[cbBulk], &pRec->pbDst[cbBulk], cbTail );
+            }
+            state.cbData += cbTail;
+
+            SymCryptGcmComputeGhash( &state, buf );
+            SymCryptXorBytes( pbKeystream, buf, buf, SYMCRYPT_GCM_BLOCK_SIZE );
+
+            SYMCRYPT_ASSERT( pRec->cbTag >= GCM_MIN_TAG_SIZE && pRec->cbTag <= GCM_MAX_TAG_SIZE );
+            if( bEncrypt )
+            {
+                memcpy( pRec->pbTag, buf, pRec->cbTag );
+            } else {
+                recordStatus = SYMCRYPT_NO_ERROR;
+                if( !SymCryptEqual( pRec->pbTag, buf, pRec->cbTag ) )
+                {
+                    recordStatus = SYMCRYPT_AUTHENTICATION_FAILURE;
+                    status = SYMCRYPT_AUTHENTICATION_FAILURE;
+                    SymCryptWipe( pRec->pbDst, pRec->cbData );
+                }
+
+                if( pResults != NULL )
+                {
+                    pResults[iFirst + i] = recordStatus;
+                }
+            }
+
+            pbKeystream += (1 + (cbTail + SYMCRYPT_GCM_BLOCK_SIZE - 1) / SYMCRYPT_GCM_BLOCK_SIZE) * SYMCRYPT_GCM_BLOCK_SIZE;
+        }
+
+        iFirst += nGroup;
+    }
+
+    SymCryptWipeKnownSize( &state, sizeof( state ) );
+    SymCryptWipeKnownSize( counterBlocks, sizeof( counterBlocks ) );
+    SymCryptWipe( keystream, nBlocksUsed * SYMCRYPT_GCM_BLOCK_SIZE );
+    SymCryptWipeKnownSize( buf, sizeof( buf ) );
+
+    return status;
+}
+
+
+SYMCRYPT_NOINLINE
+VOID
+SYMCRYPT_CALL
+SymCryptGcmEncryptBatch(
+    _In_                            PCSYMCRYPT_GCM_EXPANDED_KEY pExpandedKey,
+    _In_reads_( nRecords )          PCSYMCRYPT_AUTHENC_RECORD   pRecords,
+                                    SIZE_T                      nRecords )
+{
+    SymCryptGcmBatchCrypt( pExpandedKey, pRecords, nRecords, TRUE, NULL );
+}
+
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_NOINLINE
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptGcmDecryptBatch(
+    _In_                            PCSYMCRYPT_GCM_EXPANDED_KEY pExpandedKey,
+    _In_reads_( nRecords )          PCSYMCRYPT_AUTHENC_RECORD   pRecords,
+                                    SIZE_T                      nRecords,
+    _Out_writes_opt_( nRecords )    SYMCRYPT_ERROR *            pResults )
+{
+    return SymCryptGcmBatchCrypt( pExpandedKey, pRecords, nRecords, FALSE, pResults );
+}
+
+
+//
+// Multi-threaded GCM for large buffers.
+//
+// The CTR encryption of different parts of the message is independent. GHASH is a polynomial
+// in H, so if the message blocks are split in segments S_1, ..., S_n, and G_i is the GHASH
+// of S_i starting from a zero state, then the GHASH state after the message is computed by
+//      Y := Y * H^(# blocks in S_i) + G_i      for i = 1, ..., n
+// starting with the GHASH state Y after the authenticated data.
+// Each segment is processed by the normal EncryptPart/DecryptPart code (including the
+// stitched AES-GCM code) on a state that starts at the segment's counter value and a zero
+// GHASH state. Only the recombination and the final partial block are done serially.
+// All segments except the last have the same length, so we need only two powers of H.
+//
+#define GCM_PARALLEL_SEGMENT_GRANULARITY    (256)       // multiple of the 8-block bulk size
+
+typedef struct _SYMCRYPT_GCM_PARALLEL_WORK_ITEM
+{
+    PCSYMCRYPT_GCM_EXPANDED_KEY pKey;
+    PCBYTE                      pbSrc;
+    PBYTE                       pbDst;
+    SIZE_T                      cbData;
+    BOOLEAN                     bEncrypt;
+    SYMCRYPT_ALIGN BYTE         counterBlock[SYMCRYPT_GCM_BLOCK_SIZE];
+    SYMCRYPT_GF128_ELEMENT      ghashState;     // GHASH of the segment's ciphertext
+} SYMCRYPT_GCM_PARALLEL_WORK_ITEM, *PSYMCRYPT_GCM_PARALLEL_WORK_ITEM;
+
+VOID
+SYMCRYPT_CALL
+SymCryptGcmParallelWorkItem( PVOID pWorkItem )
+{
+    PSYMCRYPT_GCM_PARALLEL_WORK_ITEM    pItem = (PSYMCRYPT_GCM_PARALLEL_WORK_ITEM) pWorkItem;
+    SYMCRYPT_GCM_STATE                  state;
+
+    SymCryptGcmResetState( &state, pItem->pKey );
+    memcpy( &state.counterBlock[0], &pItem->counterBlock[0], SYMCRYPT_GCM_BLOCK_SIZE );
+    SYMCRYPT_SET_MAGIC( &state );
+
+    if( pItem->bEncrypt )
+    {
+        SymCryptGcmEncryptPart( &state, pItem->pbSrc, pItem->pbDst, pItem->cbData );
+    } else {
+        SymCryptGcmDecryptPart( &state, pItem->pbSrc, pItem->pbDst, pItem->cbData );
+    }
+
+    pItem->ghashState = state.ghashState;
+
+    SymCryptWipeKnownSize( &state, sizeof( state ) );
+}
+
+//
+// Encrypt or decrypt the data and compute the full tag into pbComputedTag.
+// The callers produce or verify the tag.
+//
+static
+VOID
+SYMCRYPT_CALL
+SymCryptGcmParallelCrypt(
+    _In_                            PCSYMCRYPT_GCM_EXPANDED_KEY     pExpandedKey,
+    _In_reads_( cbNonce )           PCBYTE                          pbNonce,
+                                    SIZE_T                          cbNonce,
+    _In_reads_opt_( cbAuthData )    PCBYTE                          pbAuthData,
+                                    SIZE_T                          cbAuthData,
+    _In_reads_( cbData )            PCBYTE                          pbSrc,
+    _Out_writes_( cbData )          PBYTE                           pbDst,
+                                    SIZE_T                          cbData,
+    _Out_writes_( SYMCRYPT_GCM_BLOCK_SIZE ) PBYTE                   pbComputedTag,
+                                    BOOLEAN                         bEncrypt,
+                                    SIZE_T                          nSegments,
+                                    PSYMCRYPT_DISPATCH_WORK_FUNC    pfnDispatch,
+    _In_opt_                        PVOID                           pDispatchContext )
+{
+    SYMCRYPT_GCM_STATE              state;
+    SYMCRYPT_GCM_PARALLEL_WORK_ITEM workItems[SYMCRYPT_GCM_MAX_PARALLEL_SEGMENTS];
+    PVOID                           ppWorkItems[SYMCRYPT_GCM_MAX_PARALLEL_SEGMENTS];
+    SYMCRYPT_GF128_ELEMENT          H;
+    SYMCRYPT_GF128_ELEMENT          Hseg;
+    SYMCRYPT_GF128_ELEMENT          Hlast;
+    SYMCRYPT_ALIGN BYTE             buf[SYMCRYPT_GCM_BLOCK_SIZE];
+    SIZE_T                          cbBulk = 0;
+    SIZE_T                          cbSegment;
+    SIZE_T                          i;
+    UINT32                          cntLow;
+
+    SymCryptGcmInit( &state, pExpandedKey, pbNonce, cbNonce );
+    SymCryptGcmAuthPart( &state, pbAuthData, cbAuthData );
+    SymCryptGcmPadMacData( &state );
+
+    nSegments = min( nSegments, SYMCRYPT_GCM_MAX_PARALLEL_SEGMENTS );
+    nSegments = min( nSegments, cbData / SYMCRYPT_GCM_MIN_PARALLEL_SEGMENT_SIZE );
+
+    if( nSegments > 1 )
+    {
+        cbSegment = (cbData / nSegments) & ~(SIZE_T)(GCM_PARALLEL_SEGMENT_GRANULARITY - 1);
+        cbBulk = cbData & GCM_BLOCK_ROUND_MASK;
+
+        //
+        // The 32-bit counter wraps modulo 2^32, see SymCryptGcmComputeTag.
+        //
+        cntLow = SYMCRYPT_LOAD_MSBFIRST32( &state.counterBlock[12] );
+        for( i=0; i<nSegments; i++ )
+        {
+            workItems[i].pKey = pExpandedKey;
+            workItems[i].pbSrc = pbSrc + i * cbSegment;
+            workItems[i].pbDst = pbDst + i * cbSegment;
+            workItems[i].cbData = (i < nSegments - 1) ? cbSegment : cbBulk - i * cbSegment;
+            workItems[i].bEncrypt = bEncrypt;
+            memcpy( &workItems[i].counterBlock[0], &state.counterBlock[0], 12 );
+            SYMCRYPT_STORE_MSBFIRST32( &workItems[i].counterBlock[12], cntLow + (UINT32)(i * (cbSegment / SYMCRYPT_GCM_BLOCK_SIZE)) );
+            ppWorkItems[i] = &workItems[i];
+        }
+
+        pfnDispatch( pDispatchContext, &SymCryptGcmParallelWorkItem, ppWorkItems, nSegments );
+
+        //
+        // Combine the GHASH values of the segments
+        //
+        SYMCRYPT_ASSERT( pExpandedKey->pBlockCipher->blockSize == SYMCRYPT_GCM_BLOCK_SIZE );
+        SymCryptWipeKnownSize( buf, sizeof( buf ) );
+        pExpandedKey->pBlockCipher->encryptFunc( &pExpandedKey->blockcipherKey, buf, buf );
+        H.ull[1] = SYMCRYPT_LOAD_MSBFIRST64( &buf[0] );
+        H.ull[0] = SYMCRYPT_LOAD_MSBFIRST64( &buf[8] );
+
+        SymCryptGf128Power( &H, cbSegment / SYMCRYPT_GCM_BLOCK_SIZE, &Hseg );
+        SymCryptGf128Power( &H, workItems[nSegments - 1].cbData / SYMCRYPT_GCM_BLOCK_SIZE, &Hlast );
+
+        for( i=0; i<nSegments; i++ )
+        {
+            SymCryptGf128Multiply( &state.ghashState, (i < nSegments - 1) ? &Hseg : &Hlast, &state.ghashState );
+            state.ghashState.ull[0] ^= workItems[i].ghashState.ull[0];
+            state.ghashState.ull[1] ^= workItems[i].ghashState.ull[1];
+        }
+
+        state.cbData = cbBulk;
+        SYMCRYPT_STORE_MSBFIRST32( &state.counterBlock[12], cntLow + (UINT32)(cbBulk / SYMCRYPT_GCM_BLOCK_SIZE) );
+
+        SymCryptWipe( workItems, nSegments * sizeof( workItems[0] ) );
+        SymCryptWipeKnownSize( &H, sizeof( H ) );
+        SymCryptWipeKnownSize( &Hseg, sizeof( Hseg ) );
+        SymCryptWipeKnownSize( &Hlast, sizeof( Hlast ) );
+        SymCryptWipeKnownSize( buf, sizeof( buf ) );
+    }
+
+    //
+    // The rest is at most one partial block, or the whole message if it is too small to split.
+    //
+    if( bEncrypt )
+    {
+        SymCryptGcmEncryptPart( &state, pbSrc + cbBulk, pbDst + cbBulk, cbData - cbBulk );
+    } else {
+        SymCryptGcmDecryptPart( &state, pbSrc + cbBulk, pbDst + cbBulk, cbData - cbBulk );
+    }
+
+    SymCryptGcmComputeTag( &state, pbComputedTag );
+
+    SymCryptWipeKnownSize( &state, sizeof( state ) );
+}
+
+
+SYMCRYPT_NOINLINE
+VOID
+SYMCRYPT_CALL
+SymCryptGcmEncryptParallel(
+    _In_                            PCSYMCRYPT_GCM_EXPANDED_KEY     pExpandedKey,
+    _In_reads_( cbNonce )           PCBYTE                          pbNonce,
+                                    SIZE_T                          cbNonce,
+    _In_reads_opt_( cbAuthData )    PCBYTE                          pbAuthData,
+                                    SIZE_T                          cbAuthData,
+    _In_reads_( cbData )            PCBYTE                          pbSrc,
+    _Out_writes_( cbData )          PBYTE                           pbDst,
+                                    SIZE_T                          cbData,
+    _Out_writes_( cbTag )           PBYTE                           pbTag,
+                                    SIZE_T                          cbTag,
+                                    SIZE_T                          nSegments,
+                                    PSYMCRYPT_DISPATCH_WORK_FUNC    pfnDispatch,
+    _In_opt_                        PVOID                           pDispatchContext )
+{
+    SYMCRYPT_ALIGN BYTE buf[SYMCRYPT_GCM_BLOCK_SIZE];
+
+    SYMCRYPT_ASSERT( cbTag >= GCM_MIN_TAG_SIZE && cbTag <= GCM_MAX_TAG_SIZE );
+
+    SymCryptGcmParallelCrypt(   pExpandedKey, pbNonce, cbNonce, pbAuthData, cbAuthData, pbSrc, pbDst, cbData, 
+                                buf, TRUE, nSegments, pfnDispatch, pDispatchContext );
+
+    memcpy( pbTag, buf, cbTag );
+
+    SymCryptWipeKnownSize( buf, sizeof( buf ) );
+}
+
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_NOINLINE
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptGcmDecryptParallel(
+    _In_                            PCSYMCRYPT_GCM_EXPANDED_KEY     pExpandedKey,
+    _In_reads_( cbNonce )           PCBYTE                          pbNonce,
+                                    SIZE_T                          cbNonce,
+    _In_reads_opt_( cbAuthData )    PCBYTE                          pbAuthData,
+                                    SIZE_T                          cbAuthData,
+    _In_reads_( cbData )            PCBYTE                          pbSrc,
+    _Out_writes_( cbData )          PBYTE                           pbDst,
+                                    SIZE_T                          cbData,
+    _In_reads_( cbTag )             PCBYTE                          pbTag,
+                                    SIZE_T                          cbTag,
+                                    SIZE_T                          nSegments,
+                                    PSYMCRYPT_DISPATCH_WORK_FUNC    pfnDispatch,
+    _In_opt_                        PVOID                           pDispatchContext )
+{
+    SYMCRYPT_ALIGN BYTE buf[SYMCRYPT_GCM_BLOCK_SIZE];
+    SYMCRYPT_ERROR      status = SYMCRYPT_NO_ERROR;
+
+    SYMCRYPT_ASSERT( cbTag >= GCM_MIN_TAG_SIZE && cbTag <= GCM_MAX_TAG_SIZE );
+
+    SymCryptGcmParallelCrypt(   pExpandedKey, pbNonce, cbNonce, pbAuthData, cbAuthData, pbSrc, pbDst, cbData, 
+                                buf, FALSE, nSegments, pfnDispatch, pDispatchContext );
+
+    if( !SymCryptEqual( pbTag, buf, cbTag ) )
+    {
+        status = SYMCRYPT_AUTHENTICATION_FAILURE;
+        SymCryptWipe( pbDst, cbData );
+    }
+
+    SymCryptWipeKnownSize( buf, sizeof( buf ) );
+
+    return status;
+}
+
+
 static const BYTE SymCryptGcmSelftestResult[3 + SYMCRYPT_AES_BLOCK_SIZE ] =
 {
     0xa5, 0x4c, 0x60, 
@@ -11,8 +11,7 @@
 //
 
 #include "precomp.h" 
-
-#define CPU_FEATURES_FOR_PCLMULQDQ  (SYMCRYPT_CPU_FEATURE_PCLMULQDQ | SYMCRYPT_CPU_FEATURE_SSSE3 | SYMCRYPT_CPU_FEATURE_SAVEXMM_NOFAIL )
+#include "ghash_definitions.h"
 
 //////////////////////////////////////////////////////////////////////////////
 // Constants & globals
@@ -122,6 +121,86 @@ SymCryptGHashResult(
     SYMCRYPT_STORE_MSBFIRST64( pbResult + 8, pState->ull[0] );
 }
 
+//
+// Gf128Multiply
+// Generic multiplication of two field elements in the GHASH state representation.
+// This processes one bit of A at a time; it is only used for the few multiplications
+// needed to combine GHASH values of message segments.
+// pResult may be the same as pA or pB.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptGf128Multiply(
+    _In_    PCSYMCRYPT_GF128_ELEMENT    pA,
+    _In_    PCSYMCRYPT_GF128_ELEMENT    pB,
+    _Out_   PSYMCRYPT_GF128_ELEMENT     pResult )
+{
+    UINT64 V0, V1, R0, R1, a, t, mask;
+    int i,j;
+
+    V0 = pB->ull[0];
+    V1 = pB->ull[1];
+    R0 = R1 = 0;
+
+    //
+    // The MSbit of A is the coefficient of x^0, see SP800-38D section 6.3.
+    //
+    for( i=1; i>=0; i-- )
+    {
+        a = pA->ull[i];
+        for( j=63; j>=0; j-- )
+        {
+            mask = UINT64_NEG( (a >> j) & 1 );
+            R0 ^= V0 & mask;
+            R1 ^= V1 & mask;
+
+            t =  UINT64_NEG(V0 & 1) & ((UINT64)GF128_FIELD_R_BYTE << (8 * ( sizeof( UINT64 ) - 1 )) ) ;
+            V0 = (V0 >> 1) | (V1 << 63);
+            V1 = (V1 >> 1) ^ t;
+        }
+    }
+
+    pResult->ull[0] = R0;
+    pResult->ull[1] = R1;
+}
+
+//
+// Gf128Power
+// Compute pBase^n. The exponent is public.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptGf128Power(
+    _In_    PCSYMCRYPT_GF128_ELEMENT    pBase,
+            UINT64                      n,
+    _Out_   PSYMCRYPT_GF128_ELEMENT     pResult )
+{
+    SYMCRYPT_GF128_ELEMENT  b;
+
+    b = *pBase;
+
+    //
+    // The field element 1 is the polynomial x^0
+    //
+    pResult->ull[0] = 0;
+    pResult->ull[1] = (UINT64)1 << 63;
+
+    while( n != 0 )
+    {
+        if( (n & 1) != 0 )
+        {
+            SymCryptGf128Multiply( pResult, &b, pResult );
+        }
+        n >>= 1;
+        if( n != 0 )
+        {
+            SymCryptGf128Multiply( &b, &b, &b );
+        }
+    }
+
+    SymCryptWipeKnownSize( &b, sizeof( b ) );
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 // XMM code
 //
@@ -506,115 +585,6 @@ with the modulo reduction.
 
 #if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64    
 
-#define SYMCRYPT_GHASH_PCLMULQDQ_HPOWERS    16
-
-//
-// We define a few macros
-//
-
-//
-// CLMUL_4 multiplies two operands into three intermediate results using 4 pclmulqdq instructions
-//
-#define CLMUL_4( opA, opB, resl, resm, resh ) \
-{ \
-    resl = _mm_clmulepi64_si128( opA, opB, 0x00 ); \
-    resm = _mm_xor_si128( _mm_clmulepi64_si128( opA, opB, 0x01 ), _mm_clmulepi64_si128( opA, opB, 0x10 ) ); \
-    resh = _mm_clmulepi64_si128( opA, opB, 0x11 ); \
-};
-
-//
-// CLMUL_3 multiplies two operands into three intermediate results using 3 pclmulqdq instructions.
-// The second operand has a pre-computed difference of the two halves.
-// This uses Karatsuba, but we delay xorring the high and low piece into the middle piece.
-//
-#define CLMUL_3( opA, opB, opBx, resl, resm, resh ) \
-{ \
-    __m128i _tmpA; \
-    resl = _mm_clmulepi64_si128( opA, opB, 0x00 ); \
-    resh = _mm_clmulepi64_si128( opA, opB, 0x11 ); \
-    _tmpA = _mm_xor_si128( opA, _mm_srli_si128( opA, 8 ) ); \
-    resm = _mm_clmulepi64_si128( _tmpA, opBx, 0x00 ); \
-};
-
-//
-// Post-process the CLMUL_3 result to be compatible with the CLMUL_4
-//
-#define CLMUL_3_POST( resl, resm, resh ) \
-    resm = _mm_xor_si128( resm, _mm_xor_si128( resl, resh ) );
-
-//
-// Multiply-accumulate using CLMUL_4
-//
-#define CLMUL_ACC_4( opA, opB, resl, resm, resh ) \
-{\
-    __m128i _tmpl, _tmpm, _tmph;\
-    CLMUL_4( opA, opB, _tmpl, _tmpm, _tmph );\
-    resl = _mm_xor_si128( resl, _tmpl ); \
-    resm = _mm_xor_si128( resm, _tmpm ); \
-    resh = _mm_xor_si128( resh, _tmph ); \
-};
-
-//
-// Multiply-accumulate using CLMUL_3
-//
-#define CLMUL_ACC_3( opA, opB, opBx, resl, resm, resh ) \
-{\
-    __m128i _tmpl, _tmpm, _tmph;\
-    CLMUL_3( opA, opB, opBx, _tmpl, _tmpm, _tmph );\
-    resl = _mm_xor_si128( resl, _tmpl ); \
-    resm = _mm_xor_si128( resm, _tmpm ); \
-    resh = _mm_xor_si128( resh, _tmph ); \
-};
-
-
-//
-// Convert the 3 intermediate results to a 256-bit result,
-// and do the modulo reduction.
-// See the large comment above on how this is done.
-//
-#define MODREDUCE( rl, rm, rh, res ) \
-{\
-    __m128i _T0, _T1, _T2, _Q0, _Q1; \
-    rl = _mm_xor_si128( rl, _mm_slli_si128( rm, 8 ) ); \
-    rh = _mm_xor_si128( rh, _mm_srli_si128( rm, 8 ) ); \
-\
-    _Q0 = _mm_slli_epi32( rl, 1 ); \
-    _Q1 = _mm_slli_epi32( rh, 1 ); \
-\
-    _T0 = _mm_srli_epi32( rl, 31 ); \
-    _T1 = _mm_srli_epi32( rh, 31 ); \
-\
-    _T2 = _mm_srli_si128( _T0, 12 ); \
-    _T0 = _mm_slli_si128( _T0, 4 ); \
-    _T1 = _mm_slli_si128( _T1, 4 ); \
-\
-    _Q0 = _mm_xor_si128( _Q0, _T0 ); \
-    _Q1 = _mm_xor_si128( _Q1, _T2 ); \
-    _Q1 = _mm_xor_si128( _Q1, _T1 ); \
-\
-    _T0 = _mm_slli_epi32( _Q0, 31 ); \
-    _T1 = _mm_slli_epi32( _Q0, 30 ); \
-    _T2 = _mm_slli_epi32( _Q0, 25 ); \
-    _T0 = _mm_xor_si128( _T0, _T1 ); \
-    _T0 = _mm_xor_si128( _T0, _T2 ); \
-\
-    _T1 = _mm_slli_si128( _T0, 12 ); \
-\
-    _T2 = _mm_xor_si128( _Q0, _T1 ); \
-\
-    res = _mm_xor_si128( _Q1, _T2 ); \
-    _T1 = _mm_srli_si128( _T0, 4 ); \
-    res = _mm_xor_si128(  res, _T1 ); \
-\
-    _T0 = _mm_srli_epi32( _T2, 1 ); \
-    _T1 = _mm_srli_epi32( _T2, 2 ); \
-    _T2 = _mm_srli_epi32( _T2, 7 ); \
-\
-    _T1 = _mm_xor_si128( _T0, _T1 ); \
-    res = _mm_xor_si128( res, _T2 ); \
-    res = _mm_xor_si128( res, _T1 ); \
-};
-
 VOID
 SYMCRYPT_CALL
 SymCryptGHashExpandKeyPclmulqdq( 
@@ -725,6 +695,113 @@ SymCryptGHashAppendDataPclmulqdq(
 
 #endif  // CPU_X86 || CPU_AMD64
 
+#if SYMCRYPT_CPU_AMD64
+
+//
+// VPCLMULQDQ implementation
+//
+// This uses the same expanded key table as the Pclmulqdq code, and the same math.
+// Each 512-bit register holds 4 data blocks, so 16 blocks are multiplied by
+// H^16, H^15, ..., H^1 with 4 register-wide multiplications. The products are accumulated
+// unreduced, the 4 lanes are folded together, and a single modulo reduction is done.
+// Any remaining blocks are processed by the Pclmulqdq code.
+//
+// The caller must have saved the YMM state.
+//
+
+//
+// Load 4 powers of H from the table into one register, highest power in the lowest lane.
+// For the block at position j (0..15) in a group of 16 we need H^(16-j), which is at table entry 2*(15-j).
+//
+#define LOAD_HPOWERS_4( expandedKeyTable, j ) \
+    _mm512_inserti32x4( _mm512_inserti32x4( _mm512_inserti32x4( \
+        _mm512_castsi128_si512( _mm_load_si128( &expandedKeyTable[2*(15 - (j)    )].m128i ) ), \
+                                _mm_load_si128( &expandedKeyTable[2*(15 - (j) - 1)].m128i ), 1 ), \
+                                _mm_load_si128( &expandedKeyTable[2*(15 - (j) - 2)].m128i ), 2 ), \
+                                _mm_load_si128( &expandedKeyTable[2*(15 - (j) - 3)].m128i ), 3 )
+
+#define CLMUL_ACC_4_ZMM( opA, opB, resl, resm, resh ) \
+{ \
+    resl = _mm512_xor_si512( resl, _mm512_clmulepi64_epi128( opA, opB, 0x00 ) ); \
+    resm = _mm512_xor_si512( resm, _mm512_clmulepi64_epi128( opA, opB, 0x01 ) ); \
+    resm = _mm512_xor_si512( resm, _mm512_clmulepi64_epi128( opA, opB, 0x10 ) ); \
+    resh = _mm512_xor_si512( resh, _mm512_clmulepi64_epi128( opA, opB, 0x11 ) ); \
+};
+
+#define FOLD_LANES_ZMM( z, x ) \
+{ \
+    __m256i _t; \
+    _t = _mm256_xor_si256( _mm512_castsi512_si256( z ), _mm512_extracti64x4_epi64( z, 1 ) ); \
+    x = _mm_xor_si128( _mm256_castsi256_si128( _t ), _mm256_extracti128_si256( _t, 1 ) ); \
+};
+
+VOID
+SYMCRYPT_CALL
+SymCryptGHashAppendDataVpclmulqdq(
+    _In_reads_( SYMCRYPT_GF128_FIELD_SIZE ) PCSYMCRYPT_GF128_ELEMENT    expandedKeyTable,
+    _Inout_                                 PSYMCRYPT_GF128_ELEMENT     pState,
+    _In_reads_( cbData )                    PCBYTE                      pbData,
+    _In_                                    SIZE_T                      cbData )
+{
+    __m128i state;
+    __m128i a0, a1, a2;
+    __m512i d0, d1, d2, d3;
+    __m512i h0, h1, h2, h3;
+    __m512i r0, r1, r2;
+
+    __m512i BYTE_REVERSE_ORDER = _mm512_broadcast_i32x4( _mm_set_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 ) );
+
+    C_ASSERT( SYMCRYPT_GHASH_PCLMULQDQ_HPOWERS == 16 );
+
+    h0 = LOAD_HPOWERS_4( expandedKeyTable,  0 );
+    h1 = LOAD_HPOWERS_4( expandedKeyTable,  4 );
+    h2 = LOAD_HPOWERS_4( expandedKeyTable,  8 );
+    h3 = LOAD_HPOWERS_4( expandedKeyTable, 12 );
+
+    state = _mm_loadu_si128( (__m128i *) pState );
+
+    while( cbData >= 16 * SYMCRYPT_GF128_BLOCK_SIZE )
+    {
+        d0 = _mm512_shuffle_epi8( _mm512_loadu_si512( pbData +   0 ), BYTE_REVERSE_ORDER );
+        d1 = _mm512_shuffle_epi8( _mm512_loadu_si512( pbData +  64 ), BYTE_REVERSE_ORDER );
+        d2 = _mm512_shuffle_epi8( _mm512_loadu_si512( pbData + 128 ), BYTE_REVERSE_ORDER );
+        d3 = _mm512_shuffle_epi8( _mm512_loadu_si512( pbData + 192 ), BYTE_REVERSE_ORDER );
+
+        //
+        // The state is xorred into the first block
+        //
+        d0 = _mm512_xor_si512( d0, _mm512_inserti32x4( _mm512_setzero_si512(), state, 0 ) );
+
+        r0 = _mm512_setzero_si512();
+        r1 = _mm512_setzero_si512();
+        r2 = _mm512_setzero_si512();
+
+        CLMUL_ACC_4_ZMM( d0, h0, r0, r1, r2 );
+        CLMUL_ACC_4_ZMM( d1, h1, r0, r1, r2 );
+        CLMUL_ACC_4_ZMM( d2, h2, r0, r1, r2 );
+        CLMUL_ACC_4_ZMM( d3, h3, r0, r1, r2 );
+
+        FOLD_LANES_ZMM( r0, a0 );
+        FOLD_LANES_ZMM( r1, a1 );
+        FOLD_LANES_ZMM( r2, a2 );
+
+        MODREDUCE( a0, a1, a2, state );
+
+        pbData += 16 * SYMCRYPT_GF128_BLOCK_SIZE;
+        cbData -= 16 * SYMCRYPT_GF128_BLOCK_SIZE;
+    }
+
+    _mm_storeu_si128((__m128i *)pState, state );
+
+    if( cbData >= SYMCRYPT_GF128_BLOCK_SIZE )
+    {
+        SymCryptGHashAppendDataPclmulqdq( expandedKeyTable, pState, pbData, cbData );
+    }
+}
+
+#endif  // CPU_AMD64
+
 #if SYMCRYPT_CPU_ARM64
 
 #define SYMCRYPT_GHASH_PMULL_HPOWERS    16
@@ -977,7 +1054,7 @@ SymCryptGHashExpandKey(
 
     pExpandedKeyTable = (PSYMCRYPT_GF128_ELEMENT)&expandedKey->tableSpace[expandedKey->tableOffset];
 
-    if( SYMCRYPT_CPU_FEATURES_PRESENT( CPU_FEATURES_FOR_PCLMULQDQ ) )
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_PCLMULQDQ_CODE ) )
     {
         //
         // We can only use the PCLMULQDQ data representation if the SaveXmm never fails.
@@ -1002,7 +1079,7 @@ SymCryptGHashExpandKey(
     PSYMCRYPT_GF128_ELEMENT pExpandedKeyTable;
     pExpandedKeyTable = &expandedKey->table[0];
 
-    if( SYMCRYPT_CPU_FEATURES_PRESENT( CPU_FEATURES_FOR_PCLMULQDQ ) )
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_PCLMULQDQ_CODE ) )
     {
         SymCryptGHashExpandKeyPclmulqdq( pExpandedKeyTable, pH );
     } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_SSE2 ) )
@@ -1042,7 +1119,7 @@ SymCryptGHashAppendData(
 
     pExpandedKeyTable = (PSYMCRYPT_GF128_ELEMENT)&expandedKey->tableSpace[expandedKey->tableOffset];
 
-    if( SYMCRYPT_CPU_FEATURES_PRESENT( CPU_FEATURES_FOR_PCLMULQDQ ) )
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_PCLMULQDQ_CODE ) )
     {
         if( SymCryptSaveXmm( &SaveData ) != SYMCRYPT_NO_ERROR )
         {
@@ -1061,8 +1138,16 @@ SymCryptGHashAppendData(
 #elif SYMCRYPT_CPU_AMD64
     PCSYMCRYPT_GF128_ELEMENT pExpandedKeyTable;
 
+    SYMCRYPT_EXTENDED_SAVE_DATA  SaveData;
+
     pExpandedKeyTable = &expandedKey->table[0];
-    if( SYMCRYPT_CPU_FEATURES_PRESENT( CPU_FEATURES_FOR_PCLMULQDQ ) )
+    if( cbData >= 16 * SYMCRYPT_GF128_BLOCK_SIZE &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_VPCLMULQDQ_CODE ) &&
+        SymCryptSaveYmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptGHashAppendDataVpclmulqdq( pExpandedKeyTable, pState, pbData, cbData );
+        SymCryptRestoreYmm( &SaveData );
+    } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_PCLMULQDQ_CODE ) )
     {
         SymCryptGHashAppendDataPclmulqdq( pExpandedKeyTable, pState, pbData, cbData );
     } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_SSE2 ) )
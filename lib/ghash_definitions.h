@@ -0,0 +1,123 @@
+//
+// ghash_definitions.h
+//
+// Macros for the PCLMULQDQ-based GHASH implementation.
+// These are shared between the GHASH code and the AES-GCM code that
+// interleaves the GHASH computation with the AES-CTR encryption.
+// See ghash.c for a description of the multiplication and modulo reduction.
+//
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+
+#define SYMCRYPT_GHASH_PCLMULQDQ_HPOWERS    16
+
+//
+// We define a few macros
+//
+
+//
+// CLMUL_4 multiplies two operands into three intermediate results using 4 pclmulqdq instructions
+//
+#define CLMUL_4( opA, opB, resl, resm, resh ) \
+{ \
+    resl = _mm_clmulepi64_si128( opA, opB, 0x00 ); \
+    resm = _mm_xor_si128( _mm_clmulepi64_si128( opA, opB, 0x01 ), _mm_clmulepi64_si128( opA, opB, 0x10 ) ); \
+    resh = _mm_clmulepi64_si128( opA, opB, 0x11 ); \
+};
+
+//
+// CLMUL_3 multiplies two operands into three intermediate results using 3 pclmulqdq instructions.
+// The second operand has a pre-computed difference of the two halves.
+// This uses Karatsuba, but we delay xorring the high and low piece into the middle piece.
+//
+#define CLMUL_3( opA, opB, opBx, resl, resm, resh ) \
+{ \
+    __m128i _tmpA; \
+    resl = _mm_clmulepi64_si128( opA, opB, 0x00 ); \
+    resh = _mm_clmulepi64_si128( opA, opB, 0x11 ); \
+    _tmpA = _mm_xor_si128( opA, _mm_srli_si128( opA, 8 ) ); \
+    resm = _mm_clmulepi64_si128( _tmpA, opBx, 0x00 ); \
+};
+
+//
+// Post-process the CLMUL_3 result to be compatible with the CLMUL_4
+//
+#define CLMUL_3_POST( resl, resm, resh ) \
+    resm = _mm_xor_si128( resm, _mm_xor_si128( resl, resh ) );
+
+//
+// Multiply-accumulate using CLMUL_4
+//
+#define CLMUL_ACC_4( opA, opB, resl, resm, resh ) \
+{\
+    __m128i _tmpl, _tmpm, _tmph;\
+    CLMUL_4( opA, opB, _tmpl, _tmpm, _tmph );\
+    resl = _mm_xor_si128( resl, _tmpl ); \
+    resm = _mm_xor_si128( resm, _tmpm ); \
+    resh = _mm_xor_si128( resh, _tmph ); \
+};
+
+//
+// Multiply-accumulate using CLMUL_3
+//
+#define CLMUL_ACC_3( opA, opB, opBx, resl, resm, resh ) \
+{\
+    __m128i _tmpl, _tmpm, _tmph;\
+    CLMUL_3( opA, opB, opBx, _tmpl, _tmpm, _tmph );\
+    resl = _mm_xor_si128( resl, _tmpl ); \
+    resm = _mm_xor_si128( resm, _tmpm ); \
+    resh = _mm_xor_si128( resh, _tmph ); \
+};
+
+
+//
+// Convert the 3 intermediate results to a 256-bit result,
+// and do the modulo reduction.
+// See the large comment above on how this is done.
+//
+#define MODREDUCE( rl, rm, rh, res ) \
+{\
+    __m128i _T0, _T1, _T2, _Q0, _Q1; \
+    rl = _mm_xor_si128( rl, _mm_slli_si128( rm, 8 ) ); \
+    rh = _mm_xor_si128( rh, _mm_srli_si128( rm, 8 ) ); \
+\
+    _Q0 = _mm_slli_epi32( rl, 1 ); \
+    _Q1 = _mm_slli_epi32( rh, 1 ); \
+\
+    _T0 = _mm_srli_epi32( rl, 31 ); \
+    _T1 = _mm_srli_epi32( rh, 31 ); \
+\
+    _T2 = _mm_srli_si128( _T0, 12 ); \
+    _T0 = _mm_slli_si128( _T0, 4 ); \
+    _T1 = _mm_slli_si128( _T1, 4 ); \
+\
+    _Q0 = _mm_xor_si128( _Q0, _T0 ); \
+    _Q1 = _mm_xor_si128( _Q1, _T2 ); \
+    _Q1 = _mm_xor_si128( _Q1, _T1 ); \
+\
+    _T0 = _mm_slli_epi32( _Q0, 31 ); \
+    _T1 = _mm_slli_epi32( _Q0, 30 ); \
+    _T2 = _mm_slli_epi32( _Q0, 25 ); \
+    _T0 = _mm_xor_si128( _T0, _T1 ); \
+    _T0 = _mm_xor_si128( _T0, _T2 ); \
+\
+    _T1 = _mm_slli_si128( _T0, 12 ); \
+\
+    _T2 = _mm_xor_si128( _Q0, _T1 ); \
+\
+    res = _mm_xor_si128( _Q1, _T2 ); \
+    _T1 = _mm_srli_si128( _T0, 4 ); \
+    res = _mm_xor_si128(  res, _T1 ); \
+\
+    _T0 = _mm_srli_epi32( _T2, 1 ); \
+    _T1 = _mm_srli_epi32( _T2, 2 ); \
+    _T2 = _mm_srli_epi32( _T2, 7 ); \
+\
+    _T1 = _mm_xor_si128( _T0, _T1 ); \
+    res = _mm_xor_si128( res, _T2 ); \
+    res = _mm_xor_si128( res, _T1 ); \
+};
+
+#endif  // CPU_X86 || CPU_AMD64
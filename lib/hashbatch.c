@@ -0,0 +1,277 @@
+//
+// hashbatch.c   Hashing of many independent messages
+//
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+
+//
+// For short messages most of the time of SymCryptHash is spent outside the compression function:
+// state initialization, buffering in the Append function, and padding in the Result function.
+// SymCryptHashBatch pads each message once in the scratch space and passes the input blocks
+// directly to the append-blocks function, or to the parallel code for up to SYMCRYPT_HASH_BATCH_LANES
+// messages at a time.
+//
+
+#include "precomp.h"
+
+//
+// The hash functions we pad ourselves, with the size of the message length field and
+// the size and byte order of the chaining state words.
+//
+typedef struct _SYMCRYPT_HASH_BATCH_ALGORITHM {
+    const PCSYMCRYPT_HASH *         ppHash;
+    PSYMCRYPT_PARALLEL_APPEND_FUNC  appendLanesFunc;    // NULL if there is no parallel implementation
+    UINT32                          cbLength;
+    UINT32                          cbWord;
+    BOOLEAN                         msbFirst;
+} SYMCRYPT_HASH_BATCH_ALGORITHM, *PSYMCRYPT_HASH_BATCH_ALGORITHM;
+typedef const SYMCRYPT_HASH_BATCH_ALGORITHM *PCSYMCRYPT_HASH_BATCH_ALGORITHM;
+
+static const SYMCRYPT_HASH_BATCH_ALGORITHM SymCryptHashBatchAlgorithms[] = {
+    { &SymCryptMd4Algorithm,    NULL,                                    8, 4, FALSE },
+    { &SymCryptMd5Algorithm,    &SymCryptParallelMd5AppendLanes,         8, 4, FALSE },
+    { &SymCryptSha1Algorithm,   &SymCryptParallelSha1AppendLanes,        8, 4, TRUE  },
+    { &SymCryptSha256Algorithm, &SymCryptParallelSha256AppendLanes,      8, 4, TRUE  },
+    { &SymCryptSha384Algorithm, &SymCryptParallelSha512AppendLanes,     16, 8, TRUE  },     // SHA-384 has the same chaining state as SHA-512
+    { &SymCryptSha512Algorithm, &SymCryptParallelSha512AppendLanes,     16, 8, TRUE  },
+};
+
+//
+// Initialize the hash state and the lane for a message.
+// The whole blocks of the message are processed from the caller's buffer; the rest of
+// the message and the padding are copied to the tail buffer of the lane.
+//
+static
+VOID
+SYMCRYPT_CALL
+SymCryptHashBatchStartLane(
+    _In_                        PCSYMCRYPT_HASH_BATCH_ALGORITHM pAlg,
+    _Out_                       PSYMCRYPT_HASH_BATCH_LANE       pLane,
+    _Out_                       PSYMCRYPT_HASH_STATE            pState,
+                                SIZE_T                          iMessage,
+    _In_reads_( cbData )        PCBYTE                          pbData,
+                                SIZE_T                          cbData )
+{
+    PCSYMCRYPT_HASH pHash = *pAlg->ppHash;
+    SIZE_T          cbBlock = pHash->inputBlockSize;
+    SIZE_T          cbRest = cbData & (cbBlock - 1);
+    SIZE_T          cbTail;
+
+    (*pHash->initFunc)( pState );
+
+    pLane->iMessage = iMessage;
+    pLane->pbData = pbData;
+    pLane->cbData = cbData - cbRest;
+
+    cbTail = cbRest + 1 + pAlg->cbLength <= cbBlock ? cbBlock : 2 * cbBlock;
+    SYMCRYPT_ASSERT( cbTail <= sizeof( pLane->rbTail ) );
+
+    memcpy( &pLane->rbTail[0], pbData + cbData - cbRest, cbRest );
+    pLane->rbTail[cbRest] = 0x80;
+    SymCryptWipe( &pLane->rbTail[cbRest + 1], cbTail - cbRest - 1 );
+
+    //
+    // The length field is the message length in bits. For the 16-byte length fields
+    // the upper half is zero except for (impossibly) long messages.
+    //
+    if( pAlg->msbFirst )
+    {
+        SYMCRYPT_STORE_MSBFIRST64( &pLane->rbTail[cbTail - 8], (UINT64) cbData * 8 );
+        if( pAlg->cbLength == 16 )
+        {
+            SYMCRYPT_STORE_MSBFIRST64( &pLane->rbTail[cbTail - 16], (UINT64) cbData >> 61 );
+        }
+    } else {
+        SYMCRYPT_STORE_LSBFIRST64( &pLane->rbTail[cbTail - 8], (UINT64) cbData * 8 );
+    }
+
+    pLane->cbTail = cbTail;
+    pLane->cbTailDone = 0;
+}
+
+static
+VOID
+SYMCRYPT_CALL
+SymCryptHashBatchLaneResult(
+    _In_                                    PCSYMCRYPT_HASH_BATCH_ALGORITHM pAlg,
+    _In_                                    PCSYMCRYPT_HASH_STATE           pState,
+    _Out_writes_( (*pAlg->ppHash)->resultSize ) PBYTE                       pbResult )
+{
+    PCSYMCRYPT_HASH pHash = *pAlg->ppHash;
+    PCBYTE          pbChain = (PCBYTE) pState + pHash->chainOffset;
+
+    if( pAlg->cbWord == 8 )
+    {
+        SymCryptUint64ToMsbFirst( (PCUINT64) pbChain, pbResult, pHash->resultSize / 8 );
+    } else if( pAlg->msbFirst )
+    {
+        SymCryptUint32ToMsbFirst( (PCUINT32) pbChain, pbResult, pHash->resultSize / 4 );
+    } else {
+        SymCryptUint32ToLsbFirst( (PCUINT32) pbChain, pbResult, pHash->resultSize / 4 );
+    }
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptHashBatch(
+    _In_                                            PCSYMCRYPT_HASH pHash,
+    _In_reads_( nMessages )                         const PCBYTE *  ppbData,
+    _In_reads_( nMessages )                         const SIZE_T *  pcbData,
+                                                    SIZE_T          nMessages,
+    _Out_writes_( nMessages * pHash->resultSize )   PBYTE           pbResult,
+    _Out_writes_( cbScratch )                       PBYTE           pbScratch,
+                                                    SIZE_T          cbScratch )
+{
+    PCSYMCRYPT_HASH_BATCH_ALGORITHM         pAlg;
+    PSYMCRYPT_HASH_STATE                    pStates;
+    PSYMCRYPT_HASH_BATCH_LANE               pLanes;
+    PSYMCRYPT_HASH_BATCH_LANE               pLane;
+    PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE   pScratchStates;
+    PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork;
+    PBYTE                                   pbHashScratch;
+    SIZE_T                                  cbHashScratch;
+    SIZE_T                                  cbResult = pHash->resultSize;
+    SIZE_T                                  cbBlock = pHash->inputBlockSize;
+    SIZE_T                                  cbRemaining;
+    SIZE_T                                  iMessage;
+    SIZE_T                                  nLanes;
+    SIZE_T                                  nWork;
+    SIZE_T                                  nBytes;
+    SIZE_T                                  i;
+
+    if( cbScratch < SYMCRYPT_HASH_BATCH_SCRATCH )
+    {
+        SymCryptFatal( 'hbsc' );
+    }
+
+    pAlg = NULL;
+    for( i=0; i<SYMCRYPT_ARRAY_SIZE( SymCryptHashBatchAlgorithms ); i++ )
+    {
+        if( pHash == *SymCryptHashBatchAlgorithms[i].ppHash )
+        {
+            pAlg = &SymCryptHashBatchAlgorithms[i];
+            break;
+        }
+    }
+
+    if( pAlg == NULL )
+    {
+        for( iMessage=0; iMessage<nMessages; iMessage++ )
+        {
+            SymCryptHash( pHash, ppbData[iMessage], pcbData[iMessage], pbResult + iMessage * cbResult, cbResult );
+        }
+        return;
+    }
+
+    if( nMessages == 0 )
+    {
+        return;
+    }
+
+    //
+    // Scratch layout: hash states, lane bookkeeping, parallel hash scratch states, work array,
+    // and the fixed scratch of the parallel hash code.
+    //
+    pStates = (PSYMCRYPT_HASH_STATE) SYMCRYPT_ALIGN_UP( pbScratch );
+    pLanes = (PSYMCRYPT_HASH_BATCH_LANE) &pStates[SYMCRYPT_HASH_BATCH_LANES];
+    pScratchStates = (PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE) &pLanes[SYMCRYPT_HASH_BATCH_LANES];
+    pWork = (PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE *) &pScratchStates[SYMCRYPT_HASH_BATCH_LANES];
+    pbHashScratch = (PBYTE) &pWork[SYMCRYPT_HASH_BATCH_LANES];
+    cbHashScratch = SYMCRYPT_PARALLEL_SHA512_FIXED_SCRATCH;
+
+    SYMCRYPT_ASSERT( pbHashScratch + cbHashScratch <= pbScratch + cbScratch );
+
+    if( pAlg->appendLanesFunc == NULL || nMessages == 1 )
+    {
+        //
+        // Serial code: process the whole blocks and then the padded tail of each message
+        //
+        for( iMessage=0; iMessage<nMessages; iMessage++ )
+        {
+            SymCryptHashBatchStartLane( pAlg, &pLanes[0], &pStates[0], iMessage, ppbData[iMessage], pcbData[iMessage] );
+            if( pLanes[0].cbData > 0 )
+            {
+                (*pHash->appendBlockFunc)( (PBYTE) &pStates[0] + pHash->chainOffset, pLanes[0].pbData, pLanes[0].cbData, &cbRemaining );
+            }
+            (*pHash->appendBlockFunc)( (PBYTE) &pStates[0] + pHash->chainOffset, pLanes[0].rbTail, pLanes[0].cbTail, &cbRemaining );
+            SymCryptHashBatchLaneResult( pAlg, &pStates[0], pbResult + iMessage * cbResult );
+        }
+
+        SymCryptWipeKnownSize( &pStates[0], sizeof( pStates[0] ) );
+        SymCryptWipeKnownSize( &pLanes[0], sizeof( pLanes[0] ) );
+        return;
+    }
+
+    nLanes = SYMCRYPT_MIN( nMessages, SYMCRYPT_HASH_BATCH_LANES );
+    for( i=0; i<nLanes; i++ )
+    {
+        SymCryptHashBatchStartLane( pAlg, &pLanes[i], &pStates[i], i, ppbData[i], pcbData[i] );
+        pScratchStates[i].hashState = &pStates[i];
+        pWork[i] = &pScratchStates[i];
+    }
+    iMessage = nLanes;
+    nWork = nLanes;
+
+    while( nWork > 0 )
+    {
+        //
+        // Each lane processes the next nBytes of either its whole blocks or its padded tail.
+        // For equal-length messages this is a single call per part.
+        //
+        nBytes = (SIZE_T) -1;
+        for( i=0; i<nWork; i++ )
+        {
+            pLane = &pLanes[ (PSYMCRYPT_HASH_STATE) pWork[i]->hashState - pStates ];
+            if( pLane->cbData > 0 )
+            {
+                nBytes = SYMCRYPT_MIN( nBytes, pLane->cbData );
+            } else {
+                nBytes = SYMCRYPT_MIN( nBytes, pLane->cbTail - pLane->cbTailDone );
+            }
+        }
+
+        for( i=0; i<nWork; i++ )
+        {
+            pLane = &pLanes[ (PSYMCRYPT_HASH_STATE) pWork[i]->hashState - pStates ];
+            if( pLane->cbData > 0 )
+            {
+                pWork[i]->pbData = pLane->pbData;
+                pLane->pbData += nBytes;
+                pLane->cbData -= nBytes;
+            } else {
+                pWork[i]->pbData = &pLane->rbTail[pLane->cbTailDone];
+                pLane->cbTailDone += nBytes;
+            }
+            pWork[i]->cbData = nBytes;
+        }
+
+        (*pAlg->appendLanesFunc)( pWork, nWork, nBytes, pbHashScratch, cbHashScratch );
+
+        //
+        // Finished lanes write their result and start on the next message, or leave the work array.
+        //
+        for( i=0; i<nWork; i++ )
+        {
+            pLane = &pLanes[ (PSYMCRYPT_HASH_STATE) pWork[i]->hashState - pStates ];
+            if( pLane->cbData > 0 || pLane->cbTailDone < pLane->cbTail )
+            {
+                continue;
+            }
+
+            SymCryptHashBatchLaneResult( pAlg, (PCSYMCRYPT_HASH_STATE) pWork[i]->hashState, pbResult + pLane->iMessage * cbResult );
+
+            if( iMessage < nMessages )
+            {
+                SymCryptHashBatchStartLane( pAlg, pLane, (PSYMCRYPT_HASH_STATE) pWork[i]->hashState, iMessage, ppbData[iMessage], pcbData[iMessage] );
+                iMessage++;
+            } else {
+                pWork[i] = pWork[--nWork];
+                i--;
+            }
+        }
+    }
+
+    SymCryptWipe( pStates, nLanes * sizeof( pStates[0] ) );
+    SymCryptWipe( pLanes, nLanes * sizeof( pLanes[0] ) );
+    SymCryptWipe( pbHashScratch, cbHashScratch );
+}
@@ -10,6 +10,7 @@
 #define Alg Sha256
 #define SET_DATALENGTH( state, len )    {state.dataLengthL = len;}
 #include "hmac_pattern.c"
+#include "parhmac_pattern.c"
 #undef SET_DATALENGTH
 #undef Alg
 #undef ALG
@@ -59,3 +60,38 @@ SymCryptHmacSha256Selftest()
     //
 }
 
+
+#define N_PARALLEL_SELFTEST_OPERATIONS  3
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelHmacSha256Selftest()
+{
+    SYMCRYPT_HMAC_SHA256_EXPANDED_KEY     xKey;
+    SYMCRYPT_PARALLEL_HMAC_SHA256_OPERATION   op[N_PARALLEL_SELFTEST_OPERATIONS];
+    BYTE                                    res[N_PARALLEL_SELFTEST_OPERATIONS][SYMCRYPT_HMAC_SHA256_RESULT_SIZE];
+    BYTE                                    scratch[SYMCRYPT_PARALLEL_HMAC_SHA256_FIXED_SCRATCH + N_PARALLEL_SELFTEST_OPERATIONS * SYMCRYPT_PARALLEL_HMAC_SHA256_PER_OPERATION_SCRATCH];
+    SIZE_T                                  i;
+
+    SymCryptHmacSha256ExpandKey( &xKey, SymCryptTestKey32, 16 );
+
+    for( i=0; i<N_PARALLEL_SELFTEST_OPERATIONS; i++ )
+    {
+        op[i].pExpandedKey = &xKey;
+        op[i].pbData = SymCryptTestMsg3;
+        op[i].cbData = sizeof( SymCryptTestMsg3 );
+        op[i].pbResult = &res[i][0];
+    }
+
+    SymCryptParallelHmacSha256( op, N_PARALLEL_SELFTEST_OPERATIONS, scratch, sizeof( scratch ) );
+
+    SymCryptInjectError( &res[0][0], sizeof( res ) );
+
+    for( i=0; i<N_PARALLEL_SELFTEST_OPERATIONS; i++ )
+    {
+        if( memcmp( &res[i][0], hmacSha256Kat, SYMCRYPT_HMAC_SHA256_RESULT_SIZE ) != 0 )
+        {
+            SymCryptFatal( 'phs2' );
+        }
+    }
+}
@@ -12,6 +12,7 @@
 #define Alg Sha384
 #define SET_DATALENGTH( state, len )    {state.dataLengthL = len; state.dataLengthH = 0;}
 #include "hmac_pattern.c"
+#include "parhmac_pattern.c"
 #undef SET_DATALENGTH
 #undef Alg
 #undef ALG
@@ -58,3 +59,38 @@ SymCryptHmacSha384Selftest()
     //
 }
 
+
+#define N_PARALLEL_SELFTEST_OPERATIONS  3
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelHmacSha384Selftest()
+{
+    SYMCRYPT_HMAC_SHA384_EXPANDED_KEY     xKey;
+    SYMCRYPT_PARALLEL_HMAC_SHA384_OPERATION   op[N_PARALLEL_SELFTEST_OPERATIONS];
+    BYTE                                    res[N_PARALLEL_SELFTEST_OPERATIONS][SYMCRYPT_HMAC_SHA384_RESULT_SIZE];
+    BYTE                                    scratch[SYMCRYPT_PARALLEL_HMAC_SHA384_FIXED_SCRATCH + N_PARALLEL_SELFTEST_OPERATIONS * SYMCRYPT_PARALLEL_HMAC_SHA384_PER_OPERATION_SCRATCH];
+    SIZE_T                                  i;
+
+    SymCryptHmacSha384ExpandKey( &xKey, SymCryptTestKey32, 16 );
+
+    for( i=0; i<N_PARALLEL_SELFTEST_OPERATIONS; i++ )
+    {
+        op[i].pExpandedKey = &xKey;
+        op[i].pbData = SymCryptTestMsg3;
+        op[i].cbData = sizeof( SymCryptTestMsg3 );
+        op[i].pbResult = &res[i][0];
+    }
+
+    SymCryptParallelHmacSha384( op, N_PARALLEL_SELFTEST_OPERATIONS, scratch, sizeof( scratch ) );
+
+    SymCryptInjectError( &res[0][0], sizeof( res ) );
+
+    for( i=0; i<N_PARALLEL_SELFTEST_OPERATIONS; i++ )
+    {
+        if( memcmp( &res[i][0], hmacSha384Kat, SYMCRYPT_HMAC_SHA384_RESULT_SIZE ) != 0 )
+        {
+            SymCryptFatal( 'phs3' );
+        }
+    }
+}
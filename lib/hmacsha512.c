@@ -10,6 +10,7 @@
 #define Alg Sha512
 #define SET_DATALENGTH( state, len )    {state.dataLengthL = len; state.dataLengthH = 0;}
 #include "hmac_pattern.c"
+#include "parhmac_pattern.c"
 #undef SET_DATALENGTH
 #undef Alg
 #undef ALG
@@ -58,3 +59,38 @@ SymCryptHmacSha512Selftest()
     //
 }
 
+
+#define N_PARALLEL_SELFTEST_OPERATIONS  3
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelHmacSha512Selftest()
+{
+    SYMCRYPT_HMAC_SHA512_EXPANDED_KEY     xKey;
+    SYMCRYPT_PARALLEL_HMAC_SHA512_OPERATION   op[N_PARALLEL_SELFTEST_OPERATIONS];
+    BYTE                                    res[N_PARALLEL_SELFTEST_OPERATIONS][SYMCRYPT_HMAC_SHA512_RESULT_SIZE];
+    BYTE                                    scratch[SYMCRYPT_PARALLEL_HMAC_SHA512_FIXED_SCRATCH + N_PARALLEL_SELFTEST_OPERATIONS * SYMCRYPT_PARALLEL_HMAC_SHA512_PER_OPERATION_SCRATCH];
+    SIZE_T                                  i;
+
+    SymCryptHmacSha512ExpandKey( &xKey, SymCryptTestKey32, 16 );
+
+    for( i=0; i<N_PARALLEL_SELFTEST_OPERATIONS; i++ )
+    {
+        op[i].pExpandedKey = &xKey;
+        op[i].pbData = SymCryptTestMsg3;
+        op[i].cbData = sizeof( SymCryptTestMsg3 );
+        op[i].pbResult = &res[i][0];
+    }
+
+    SymCryptParallelHmacSha512( op, N_PARALLEL_SELFTEST_OPERATIONS, scratch, sizeof( scratch ) );
+
+    SymCryptInjectError( &res[0][0], sizeof( res ) );
+
+    for( i=0; i<N_PARALLEL_SELFTEST_OPERATIONS; i++ )
+    {
+        if( memcmp( &res[i][0], hmacSha512Kat, SYMCRYPT_HMAC_SHA512_RESULT_SIZE ) != 0 )
+        {
+            SymCryptFatal( 'phs5' );
+        }
+    }
+}
@@ -0,0 +1,196 @@
+//
+// iovec.c   Helper functions for scatter/gather (iovec) data buffers
+//
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+
+//
+// The iovec versions of the cipher modes process data that is stored in a list of fragments.
+// The optimized implementations of the modes are fastest on whole blocks; a fragment that is not a 
+// multiple of the block size would force the mode to use its partial-block code for the last
+// bytes of the fragment, and again for the first bytes of the next fragment.
+// SymCryptIovecCrypt walks the source and destination fragment lists in parallel and passes
+// all the data to the mode function in whole blocks. Long runs of data that are contiguous in both the
+// source and the destination are passed directly. Shorter pieces are gathered into a local buffer,
+// processed, and scattered to the destination. This handles blocks that straddle a fragment boundary,
+// and ensures that small fragments are processed in chunks that are large enough for the
+// optimized code to be efficient.
+// Only the final block of the data can be partial.
+//
+
+#include "precomp.h"
+
+SIZE_T
+SYMCRYPT_CALL
+SymCryptIovecLength(
+    _In_reads_( nFragments )    PCSYMCRYPT_IOVEC    pFragments,
+                                SIZE_T              nFragments )
+{
+    SIZE_T  cbTotal = 0;
+    SIZE_T  i;
+
+    for( i=0; i<nFragments; i++ )
+    {
+        cbTotal += pFragments[i].cb;
+    }
+
+    return cbTotal;
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptIovecWipe(
+    _In_reads_( nFragments )    PCSYMCRYPT_IOVEC    pFragments,
+                                SIZE_T              nFragments )
+{
+    SIZE_T  i;
+
+    for( i=0; i<nFragments; i++ )
+    {
+        SymCryptWipe( pFragments[i].pb, pFragments[i].cb );
+    }
+}
+
+//
+// Position in a fragment list
+//
+typedef struct _SYMCRYPT_IOVEC_CURSOR {
+    PCSYMCRYPT_IOVEC    pFragment;
+    PCSYMCRYPT_IOVEC    pEnd;
+    SIZE_T              offset;         // offset into *pFragment
+} SYMCRYPT_IOVEC_CURSOR, *PSYMCRYPT_IOVEC_CURSOR;
+
+//
+// Skip to the next non-empty fragment if the current one is exhausted, and return
+// the number of bytes left in the current fragment (0 at the end of the list).
+//
+SIZE_T
+SYMCRYPT_CALL
+SymCryptIovecCursorAvailable( _Inout_ PSYMCRYPT_IOVEC_CURSOR pCursor )
+{
+    while( pCursor->pFragment < pCursor->pEnd && pCursor->offset >= pCursor->pFragment->cb )
+    {
+        pCursor->pFragment++;
+        pCursor->offset = 0;
+    }
+
+    if( pCursor->pFragment >= pCursor->pEnd )
+    {
+        return 0;
+    }
+
+    return pCursor->pFragment->cb - pCursor->offset;
+}
+
+//
+// Copy up to cbData bytes between the fragment list and a buffer, and return the number of bytes copied.
+//
+SIZE_T
+SYMCRYPT_CALL
+SymCryptIovecCursorCopy(
+    _Inout_                 PSYMCRYPT_IOVEC_CURSOR  pCursor,
+    _Inout_updates_( cbData )   PBYTE               pbBuf,
+                            SIZE_T                  cbData,
+                            BOOLEAN                 bToBuffer )
+{
+    SIZE_T  cbDone = 0;
+    SIZE_T  cbChunk;
+
+    while( cbDone < cbData )
+    {
+        cbChunk = min( cbData - cbDone, SymCryptIovecCursorAvailable( pCursor ) );
+        if( cbChunk == 0 )
+        {
+            break;
+        }
+
+        if( bToBuffer )
+        {
+            memcpy( &pbBuf[cbDone], &pCursor->pFragment->pb[pCursor->offset], cbChunk );
+        } else {
+            memcpy( &pCursor->pFragment->pb[pCursor->offset], &pbBuf[cbDone], cbChunk );
+        }
+
+        cbDone += cbChunk;
+        pCursor->offset += cbChunk;
+    }
+
+    return cbDone;
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptIovecCrypt(
+    _In_reads_( nSrc )          PCSYMCRYPT_IOVEC            pSrc,
+                                SIZE_T                      nSrc,
+    _In_reads_( nDst )          PCSYMCRYPT_IOVEC            pDst,
+                                SIZE_T                      nDst,
+                                SIZE_T                      cbBlock,
+    _In_                        PSYMCRYPT_IOVEC_CRYPT_FUNC  pfnCrypt,
+    _Inout_                     PVOID                       pContext )
+{
+    SYMCRYPT_ALIGN BYTE     buf[SYMCRYPT_IOVEC_BUFFER_SIZE];
+    SYMCRYPT_IOVEC_CURSOR   src;
+    SYMCRYPT_IOVEC_CURSOR   dst;
+    SIZE_T                  cbSrc;
+    SIZE_T                  cbDst;
+    SIZE_T                  cbData;
+    SIZE_T                  cbRemaining;
+    SIZE_T                  cbBufUsed = 0;
+
+    SYMCRYPT_ASSERT( cbBlock <= SYMCRYPT_IOVEC_MAX_BLOCK_SIZE && (cbBlock & (cbBlock - 1)) == 0 );
+
+    cbRemaining = SymCryptIovecLength( pSrc, nSrc );
+    SYMCRYPT_ASSERT( cbRemaining == SymCryptIovecLength( pDst, nDst ) );
+
+    src.pFragment = pSrc;
+    src.pEnd = pSrc + nSrc;
+    src.offset = 0;
+
+    dst.pFragment = pDst;
+    dst.pEnd = pDst + nDst;
+    dst.offset = 0;
+
+#pragma warning( suppress: 4127 )       // conditional expression is constant
+    while( TRUE )
+    {
+        cbSrc = SymCryptIovecCursorAvailable( &src );
+        cbDst = SymCryptIovecCursorAvailable( &dst );
+        if( cbSrc == 0 || cbDst == 0 )
+        {
+            break;
+        }
+
+        cbData = min( cbSrc, cbDst );
+        if( cbData != cbRemaining )
+        {
+            cbData &= ~(cbBlock - 1);
+        }
+
+        if( cbData >= SYMCRYPT_IOVEC_BUFFER_SIZE || cbData == cbRemaining )
+        {
+            //
+            // Whole blocks that are contiguous in both the source and the destination,
+            // or all the remaining data if that is contiguous.
+            //
+            (*pfnCrypt)(    pContext, 
+                            &src.pFragment->pb[src.offset], 
+                            &dst.pFragment->pb[dst.offset], 
+                            cbData );
+            src.offset += cbData;
+            dst.offset += cbData;
+        } else {
+            //
+            // Gather a buffer full of data; only the end of the data can leave a partial block.
+            //
+            cbData = SymCryptIovecCursorCopy( &src, buf, SYMCRYPT_IOVEC_BUFFER_SIZE, TRUE );
+            (*pfnCrypt)( pContext, buf, buf, cbData );
+            SymCryptIovecCursorCopy( &dst, buf, cbData, FALSE );
+            cbBufUsed = max( cbBufUsed, cbData );
+        }
+
+        cbRemaining -= cbData;
+    }
+
+    SymCryptWipe( buf, cbBufUsed );
+}
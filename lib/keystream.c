@@ -0,0 +1,189 @@
+//
+// keystream.c   Precomputed key stream for AES-CTR and ChaCha20
+//
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+
+//
+// For short messages the latency of AES-CTR or ChaCha20 is dominated by the key stream generation;
+// the AES round chain or the ChaCha20 rounds have to complete before the first byte can be xorred.
+// A key stream buffer lets the caller generate the key stream ahead of time, for example when
+// a connection is idle. Encrypting a message from the buffer is then just an xor.
+//
+// Key stream is always generated in whole blocks of the underlying cipher. Long messages that
+// find the buffer empty bypass it and are processed directly by the bulk mode function.
+//
+
+#include "precomp.h"
+
+#define SYMCRYPT_KEYSTREAM_TYPE_AES_CTR_MSB64   (1)
+#define SYMCRYPT_KEYSTREAM_TYPE_CHACHA20        (2)
+
+#define SYMCRYPT_CHACHA20_BLOCK_SIZE            (64)
+
+C_ASSERT( SYMCRYPT_KEYSTREAM_BUFFER_SIZE % SYMCRYPT_CHACHA20_BLOCK_SIZE == 0 );
+C_ASSERT( SYMCRYPT_KEYSTREAM_BUFFER_SIZE % SYMCRYPT_AES_BLOCK_SIZE == 0 );
+
+VOID
+SYMCRYPT_CALL
+SymCryptKeystreamBufferInitAesCtrMsb64(
+    _Out_                                   PSYMCRYPT_KEYSTREAM_BUFFER  pBuffer,
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _In_reads_( SYMCRYPT_AES_BLOCK_SIZE )   PCBYTE                      pbChainingValue )
+{
+    pBuffer->type = SYMCRYPT_KEYSTREAM_TYPE_AES_CTR_MSB64;
+    pBuffer->iStart = 0;
+    pBuffer->iEnd = 0;
+
+    SymCryptAesKeyCopy( pExpandedKey, &pBuffer->source.aesCtr.key );
+    memcpy( pBuffer->source.aesCtr.counterBlock, pbChainingValue, SYMCRYPT_AES_BLOCK_SIZE );
+
+    SYMCRYPT_SET_MAGIC( pBuffer );
+}
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptKeystreamBufferInitChaCha20(
+    _Out_                   PSYMCRYPT_KEYSTREAM_BUFFER  pBuffer,
+    _In_reads_( cbKey )     PCBYTE                      pbKey,
+                            SIZE_T                      cbKey,
+    _In_reads_( cbNonce )   PCBYTE                      pbNonce,
+                            SIZE_T                      cbNonce,
+                            UINT64                      offset )
+{
+    SYMCRYPT_ERROR scError;
+
+    scError = SymCryptChaCha20Init( &pBuffer->source.chaCha20, pbKey, cbKey, pbNonce, cbNonce, offset );
+    if( scError != SYMCRYPT_NO_ERROR )
+    {
+        goto cleanup;
+    }
+
+    pBuffer->type = SYMCRYPT_KEYSTREAM_TYPE_CHACHA20;
+    pBuffer->iStart = 0;
+    pBuffer->iEnd = 0;
+
+    SYMCRYPT_SET_MAGIC( pBuffer );
+
+cleanup:
+    return scError;
+}
+
+//
+// Process whole blocks directly with the bulk mode function, bypassing the buffer.
+// Only valid when the buffer is empty. Returns the number of bytes processed.
+//
+SIZE_T
+SYMCRYPT_CALL
+SymCryptKeystreamBufferCryptDirect(
+    _Inout_                 PSYMCRYPT_KEYSTREAM_BUFFER  pBuffer,
+    _In_reads_( cbData )    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )  PBYTE                       pbDst,
+                            SIZE_T                      cbData )
+{
+    SYMCRYPT_ASSERT( pBuffer->iStart == pBuffer->iEnd );
+
+    if( pBuffer->type == SYMCRYPT_KEYSTREAM_TYPE_AES_CTR_MSB64 )
+    {
+        cbData &= ~(SIZE_T)(SYMCRYPT_AES_BLOCK_SIZE - 1);
+        SymCryptAesCtrMsb64( &pBuffer->source.aesCtr.key, pBuffer->source.aesCtr.counterBlock, pbSrc, pbDst, cbData );
+    } else {
+        cbData &= ~(SIZE_T)(SYMCRYPT_CHACHA20_BLOCK_SIZE - 1);
+        SymCryptChaCha20Crypt( &pBuffer->source.chaCha20, pbSrc, pbDst, cbData );
+    }
+
+    return cbData;
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptKeystreamBufferRefill(
+    _Inout_ PSYMCRYPT_KEYSTREAM_BUFFER  pBuffer )
+{
+    SIZE_T  cbUnused;
+    SIZE_T  cbNew;
+    PBYTE   pbNew;
+
+    SYMCRYPT_CHECK_MAGIC( pBuffer );
+
+    //
+    // Move the unused key stream to the front and fill the rest of the buffer with whole blocks.
+    // The rest of the buffer is wiped first; the new key stream is generated by encrypting zeroes,
+    // and the bytes beyond the last whole block must not keep a stale copy of the key stream.
+    //
+    cbUnused = pBuffer->iEnd - pBuffer->iStart;
+    memmove( &pBuffer->buffer[0], &pBuffer->buffer[pBuffer->iStart], cbUnused );
+    pBuffer->iStart = 0;
+    pBuffer->iEnd = cbUnused;
+
+    pbNew = &pBuffer->buffer[cbUnused];
+    SymCryptWipe( pbNew, SYMCRYPT_KEYSTREAM_BUFFER_SIZE - cbUnused );
+
+    if( pBuffer->type == SYMCRYPT_KEYSTREAM_TYPE_AES_CTR_MSB64 )
+    {
+        cbNew = (SYMCRYPT_KEYSTREAM_BUFFER_SIZE - cbUnused) & ~(SIZE_T)(SYMCRYPT_AES_BLOCK_SIZE - 1);
+        SymCryptAesCtrMsb64( &pBuffer->source.aesCtr.key, pBuffer->source.aesCtr.counterBlock, pbNew, pbNew, cbNew );
+    } else {
+        cbNew = (SYMCRYPT_KEYSTREAM_BUFFER_SIZE - cbUnused) & ~(SIZE_T)(SYMCRYPT_CHACHA20_BLOCK_SIZE - 1);
+        SymCryptChaCha20Crypt( &pBuffer->source.chaCha20, pbNew, pbNew, cbNew );
+    }
+
+    pBuffer->iEnd += cbNew;
+}
+
+SIZE_T
+SYMCRYPT_CALL
+SymCryptKeystreamBufferAvailable(
+    _In_    PCSYMCRYPT_KEYSTREAM_BUFFER pBuffer )
+{
+    SYMCRYPT_CHECK_MAGIC( pBuffer );
+
+    return pBuffer->iEnd - pBuffer->iStart;
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptKeystreamBufferCrypt(
+    _Inout_                 PSYMCRYPT_KEYSTREAM_BUFFER  pBuffer,
+    _In_reads_( cbData )    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )  PBYTE                       pbDst,
+                            SIZE_T                      cbData )
+{
+    SIZE_T  nBytes;
+
+    SYMCRYPT_CHECK_MAGIC( pBuffer );
+
+    while( cbData > 0 )
+    {
+        if( pBuffer->iStart == pBuffer->iEnd )
+        {
+            //
+            // Buffer is empty. Long messages are processed directly, which is faster than going
+            // through the buffer. Otherwise we refill the buffer.
+            //
+            if( cbData >= SYMCRYPT_KEYSTREAM_BUFFER_SIZE )
+            {
+                nBytes = SymCryptKeystreamBufferCryptDirect( pBuffer, pbSrc, pbDst, cbData );
+                pbSrc += nBytes;
+                pbDst += nBytes;
+                cbData -= nBytes;
+                continue;
+            }
+
+            SymCryptKeystreamBufferRefill( pBuffer );
+        }
+
+        //
+        // Key stream that has been used is wiped so that it cannot be recovered from the buffer later.
+        //
+        nBytes = SYMCRYPT_MIN( cbData, pBuffer->iEnd - pBuffer->iStart );
+        SymCryptXorBytes( pbSrc, &pBuffer->buffer[pBuffer->iStart], pbDst, nBytes );
+        SymCryptWipe( &pBuffer->buffer[pBuffer->iStart], nBytes );
+
+        pBuffer->iStart += nBytes;
+        pbSrc += nBytes;
+        pbDst += nBytes;
+        cbData -= nBytes;
+    }
+}
@@ -482,7 +482,7 @@ cleanup:
 // Simple test vector for FIPS module testing
 //
 
-static const BYTE   md5KATAnswer[ 16 ] = {
+const BYTE   SymCryptMd5KATAnswer[ 16 ] = {
     0x90, 0x01, 0x50, 0x98, 0x3c, 0xd2, 0x4f, 0xb0,
     0xd6, 0x96, 0x3f, 0x7d, 0x28, 0xe1, 0x7f, 0x72,
 } ;
@@ -497,7 +497,7 @@ SymCryptMd5Selftest()
 
     SymCryptInjectError( result, sizeof( result ) );
     
-    if( memcmp( result, md5KATAnswer, sizeof( result ) ) != 0 ) {
+    if( memcmp( result, SymCryptMd5KATAnswer, sizeof( result ) ) != 0 ) {
         SymCryptFatal( 'MD5t' );
     }
 }
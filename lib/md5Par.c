@@ -0,0 +1,756 @@
+//
+// Md5Par.c
+//
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+
+//
+// This module contains the routines to implement MD5 from RFC 1321 in parallel mode
+//
+// MD5 is not a secure hash function; it is only provided for compatibility with existing
+// protocols and for non-cryptographic uses such as deduplication.
+//
+
+#include "precomp.h"
+
+#define PAR_SCRATCH_ELEMENTS    (4+16)          // # scratch elements our parallel impementations need
+
+
+//
+// Not all CPU architectures support parallel code.
+//
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+
+#define SUPPORT_PARALLEL 1
+#define MIN_PARALLEL    2
+#define MAX_PARALLEL    8
+
+#else
+
+#define SUPPORT_PARALLEL 0
+
+#endif
+
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5AppendBytes_serial( 
+    _Inout_updates_( nPar )                 PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+    _In_range_(1, MAX_PARALLEL)             SIZE_T                                  nPar,
+                                            SIZE_T                                  nBytes );
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5Init(
+    _Out_writes_( nStates ) PSYMCRYPT_MD5_STATE pStates,
+                            SIZE_T              nStates )
+{
+    SIZE_T i;
+
+    for( i=0; i<nStates; i++ )
+    {
+        SymCryptMd5Init( &pStates[i] );
+    }
+}
+
+#if !SUPPORT_PARALLEL
+//
+// No parallel support on this CPU
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5Process(
+    _Inout_updates_( nStates )      PSYMCRYPT_MD5_STATE                 pStates,
+                                    SIZE_T                              nStates,
+    _Inout_updates_( nOperations )  PSYMCRYPT_PARALLEL_HASH_OPERATION   pOperations,
+                                    SIZE_T                              nOperations,
+    _Out_writes_( cbScratch )       PBYTE                               pbScratch,
+                                    SIZE_T                              cbScratch )
+{
+    SymCryptParallelHashProcess_serial( SymCryptParallelMd5Algorithm, pStates, nStates, pOperations, nOperations, pbScratch, cbScratch );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5AppendLanes(
+    _Inout_updates_( nWork )        PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+                                    SIZE_T                                  nWork,
+                                    SIZE_T                                  nBytes,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch )
+{
+    SymCryptParallelHashAppendLanes( SymCryptParallelMd5Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 1 );
+}
+#endif
+
+
+#if SUPPORT_PARALLEL
+
+//
+// The result functions are the same as for SHA-256, except that MD5 uses LSBfirst
+// byte order for the message length and the result.
+//
+
+BOOLEAN
+SYMCRYPT_CALL
+SymCryptParallelMd5Result1(
+    _In_    PCSYMCRYPT_PARALLEL_HASH pParHash, 
+    _Inout_ PSYMCRYPT_COMMON_HASH_STATE pState, 
+    _Inout_ PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE pScratch,    
+    _Out_   BOOLEAN *pRes)
+{
+    UINT32 bytesInBuffer = pState->bytesInBuffer;
+
+    UNREFERENCED_PARAMETER( pParHash );
+    //
+    // Function is called when a Result is requested from a parallel hashs state.
+    // Do the first step of the padding.
+    //
+    pState->buffer[bytesInBuffer++] = 0x80;
+    SymCryptWipe( &pState->buffer[bytesInBuffer], SYMCRYPT_MD5_INPUT_BLOCK_SIZE - bytesInBuffer );
+
+    pScratch->pbData = &pState->buffer[0];
+    pScratch->cbData = SYMCRYPT_MD5_INPUT_BLOCK_SIZE;
+
+    if( bytesInBuffer > SYMCRYPT_MD5_INPUT_BLOCK_SIZE - 8 )
+    {
+        // We need 2 blocks for the padding
+        pScratch->processingState = STATE_RESULT2;
+    } else {
+        SYMCRYPT_STORE_LSBFIRST64( &pState->buffer[SYMCRYPT_MD5_INPUT_BLOCK_SIZE - 8], pState->dataLengthL * 8 );
+        pScratch->processingState = STATE_RESULT_DONE;
+    }
+
+    *pRes = TRUE;        // return value from the SetWork function
+    return TRUE;        // Return from the SetWork function
+}
+
+
+BOOLEAN
+SYMCRYPT_CALL
+SymCryptParallelMd5Result2(
+    _In_    PCSYMCRYPT_PARALLEL_HASH                pParHash, 
+    _Inout_ PSYMCRYPT_COMMON_HASH_STATE             pState, 
+    _Inout_ PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE   pScratch,    
+    _Out_   BOOLEAN *pRes)
+{
+    UNREFERENCED_PARAMETER( pParHash );
+    //
+    // Called for the 2nd block of a long padding
+    //
+    SymCryptWipe( &pState->buffer[0], SYMCRYPT_MD5_INPUT_BLOCK_SIZE );
+    SYMCRYPT_STORE_LSBFIRST64( &pState->buffer[SYMCRYPT_MD5_INPUT_BLOCK_SIZE - 8], pState->dataLengthL * 8 );
+    pScratch->pbData = &pState->buffer[0];
+    pScratch->cbData = SYMCRYPT_MD5_INPUT_BLOCK_SIZE;
+    pScratch->processingState = STATE_RESULT_DONE;
+    *pRes = TRUE;
+    return TRUE;
+}
+
+VOID 
+SYMCRYPT_CALL 
+SymCryptParallelMd5ResultDone(
+    _In_    PCSYMCRYPT_PARALLEL_HASH            pParHash, 
+    _Inout_ PSYMCRYPT_COMMON_HASH_STATE         pState, 
+    _In_    PCSYMRYPT_PARALLEL_HASH_OPERATION   pOp)
+{
+    PSYMCRYPT_MD5_STATE  pMd5State = (PSYMCRYPT_MD5_STATE) pState;
+
+    UNREFERENCED_PARAMETER( pParHash );
+
+    SYMCRYPT_ASSERT( pOp->hashOperation == SYMCRYPT_HASH_OPERATION_RESULT );
+    SYMCRYPT_ASSERT( pOp->cbBuffer == SYMCRYPT_MD5_RESULT_SIZE );
+
+    SymCryptUint32ToLsbFirst( &pMd5State->chain.H[0], pOp->pbBuffer, 4 );
+    SymCryptWipeKnownSize( pMd5State, sizeof( *pMd5State ));
+    SymCryptMd5Init( pMd5State );
+}
+
+C_ASSERT( (SYMCRYPT_SIMD_ELEMENT_SIZE & (SYMCRYPT_SIMD_ELEMENT_SIZE - 1 )) == 0 );  // check that it is a power of 2
+
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5Process(
+    _Inout_updates_( nStates )      PSYMCRYPT_MD5_STATE                 pStates,
+                                    SIZE_T                              nStates,
+    _Inout_updates_( nOperations )  PSYMCRYPT_PARALLEL_HASH_OPERATION   pOperations,
+                                    SIZE_T                              nOperations,
+    _Out_writes_( cbScratch )       PBYTE                               pbScratch,
+                                    SIZE_T                              cbScratch )
+{
+    UINT32 maxParallel;
+    SYMCRYPT_EXTENDED_SAVE_DATA SaveState;
+
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 ) && SymCryptSaveYmm( &SaveState ) == SYMCRYPT_NO_ERROR )
+    {
+        maxParallel = 8;
+
+        SymCryptParallelHashProcess(    SymCryptParallelMd5Algorithm,
+                                        pStates,
+                                        nStates,
+                                        pOperations,
+                                        nOperations,
+                                        pbScratch,
+                                        cbScratch,
+                                        maxParallel );
+
+        SymCryptRestoreYmm( &SaveState );
+    } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_SSE2 ) && SymCryptSaveXmm( &SaveState ) == SYMCRYPT_NO_ERROR )
+    {
+        maxParallel = 4;
+        SymCryptParallelHashProcess(    SymCryptParallelMd5Algorithm,
+                                        pStates,
+                                        nStates,
+                                        pOperations,
+                                        nOperations,
+                                        pbScratch,
+                                        cbScratch,
+                                        maxParallel );
+        SymCryptRestoreXmm( &SaveState );
+    } else {
+        SymCryptParallelHashProcess_serial( SymCryptParallelMd5Algorithm, pStates, nStates, pOperations, nOperations, pbScratch, cbScratch );
+    }
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5AppendLanes(
+    _Inout_updates_( nWork )        PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+                                    SIZE_T                                  nWork,
+                                    SIZE_T                                  nBytes,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch )
+{
+    SYMCRYPT_EXTENDED_SAVE_DATA SaveState;
+
+    //
+    // Same CPU feature selection as SymCryptParallelMd5Process
+    //
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 ) && SymCryptSaveYmm( &SaveState ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptParallelHashAppendLanes( SymCryptParallelMd5Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 8 );
+        SymCryptRestoreYmm( &SaveState );
+    } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_SSE2 ) && SymCryptSaveXmm( &SaveState ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptParallelHashAppendLanes( SymCryptParallelMd5Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 4 );
+        SymCryptRestoreXmm( &SaveState );
+    } else {
+        SymCryptParallelHashAppendLanes( SymCryptParallelMd5Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 1 );
+    }
+}
+
+//
+// The 64 MD5 rounds from RFC 1321, in the order a, b, c, d, function, message word, constant, rotation.
+// Each kernel defines R as its round macro and passes its versions of the F, G, H, and I functions.
+//
+#define MD5_ROUNDS( R, F, G, H, I ) \
+    R( A, B, C, D, F,  0, 0xd76aa478,  7 ); \
+    R( D, A, B, C, F,  1, 0xe8c7b756, 12 ); \
+    R( C, D, A, B, F,  2, 0x242070db, 17 ); \
+    R( B, C, D, A, F,  3, 0xc1bdceee, 22 ); \
+    R( A, B, C, D, F,  4, 0xf57c0faf,  7 ); \
+    R( D, A, B, C, F,  5, 0x4787c62a, 12 ); \
+    R( C, D, A, B, F,  6, 0xa8304613, 17 ); \
+    R( B, C, D, A, F,  7, 0xfd469501, 22 ); \
+    R( A, B, C, D, F,  8, 0x698098d8,  7 ); \
+    R( D, A, B, C, F,  9, 0x8b44f7af, 12 ); \
+    R( C, D, A, B, F, 10, 0xffff5bb1, 17 ); \
+    R( B, C, D, A, F, 11, 0x895cd7be, 22 ); \
+    R( A, B, C, D, F, 12, 0x6b901122,  7 ); \
+    R( D, A, B, C, F, 13, 0xfd987193, 12 ); \
+    R( C, D, A, B, F, 14, 0xa679438e, 17 ); \
+    R( B, C, D, A, F, 15, 0x49b40821, 22 ); \
+    \
+    R( A, B, C, D, G,  1, 0xf61e2562,  5 ); \
+    R( D, A, B, C, G,  6, 0xc040b340,  9 ); \
+    R( C, D, A, B, G, 11, 0x265e5a51, 14 ); \
+    R( B, C, D, A, G,  0, 0xe9b6c7aa, 20 ); \
+    R( A, B, C, D, G,  5, 0xd62f105d,  5 ); \
+    R( D, A, B, C, G, 10, 0x02441453,  9 ); \
+    R( C, D, A, B, G, 15, 0xd8a1e681, 14 ); \
+    R( B, C, D, A, G,  4, 0xe7d3fbc8, 20 ); \
+    R( A, B, C, D, G,  9, 0x21e1cde6,  5 ); \
+    R( D, A, B, C, G, 14, 0xc33707d6,  9 ); \
+    R( C, D, A, B, G,  3, 0xf4d50d87, 14 ); \
+    R( B, C, D, A, G,  8, 0x455a14ed, 20 ); \
+    R( A, B, C, D, G, 13, 0xa9e3e905,  5 ); \
+    R( D, A, B, C, G,  2, 0xfcefa3f8,  9 ); \
+    R( C, D, A, B, G,  7, 0x676f02d9, 14 ); \
+    R( B, C, D, A, G, 12, 0x8d2a4c8a, 20 ); \
+    \
+    R( A, B, C, D, H,  5, 0xfffa3942,  4 ); \
+    R( D, A, B, C, H,  8, 0x8771f681, 11 ); \
+    R( C, D, A, B, H, 11, 0x6d9d6122, 16 ); \
+    R( B, C, D, A, H, 14, 0xfde5380c, 23 ); \
+    R( A, B, C, D, H,  1, 0xa4beea44,  4 ); \
+    R( D, A, B, C, H,  4, 0x4bdecfa9, 11 ); \
+    R( C, D, A, B, H,  7, 0xf6bb4b60, 16 ); \
+    R( B, C, D, A, H, 10, 0xbebfbc70, 23 ); \
+    R( A, B, C, D, H, 13, 0x289b7ec6,  4 ); \
+    R( D, A, B, C, H,  0, 0xeaa127fa, 11 ); \
+    R( C, D, A, B, H,  3, 0xd4ef3085, 16 ); \
+    R( B, C, D, A, H,  6, 0x04881d05, 23 ); \
+    R( A, B, C, D, H,  9, 0xd9d4d039,  4 ); \
+    R( D, A, B, C, H, 12, 0xe6db99e5, 11 ); \
+    R( C, D, A, B, H, 15, 0x1fa27cf8, 16 ); \
+    R( B, C, D, A, H,  2, 0xc4ac5665, 23 ); \
+    \
+    R( A, B, C, D, I,  0, 0xf4292244,  6 ); \
+    R( D, A, B, C, I,  7, 0x432aff97, 10 ); \
+    R( C, D, A, B, I, 14, 0xab9423a7, 15 ); \
+    R( B, C, D, A, I,  5, 0xfc93a039, 21 ); \
+    R( A, B, C, D, I, 12, 0x655b59c3,  6 ); \
+    R( D, A, B, C, I,  3, 0x8f0ccc92, 10 ); \
+    R( C, D, A, B, I, 10, 0xffeff47d, 15 ); \
+    R( B, C, D, A, I,  1, 0x85845dd1, 21 ); \
+    R( A, B, C, D, I,  8, 0x6fa87e4f,  6 ); \
+    R( D, A, B, C, I, 15, 0xfe2ce6e0, 10 ); \
+    R( C, D, A, B, I,  6, 0xa3014314, 15 ); \
+    R( B, C, D, A, I, 13, 0x4e0811a1, 21 ); \
+    R( A, B, C, D, I,  4, 0xf7537e82,  6 ); \
+    R( D, A, B, C, I, 11, 0xbd3af235, 10 ); \
+    R( C, D, A, B, I,  2, 0x2ad7d2bb, 15 ); \
+    R( B, C, D, A, I,  9, 0xeb86d391, 21 );
+
+//
+// Code that uses the XMM registers.
+// MD5 uses LSBfirst byte order, so the XMM code needs nothing beyond SSE2.
+//
+
+#define FXMM( x, y, z ) _mm_xor_si128( _mm_and_si128( _mm_xor_si128( z, y ), x ), z )
+#define GXMM( x, y, z ) FXMM( z, x, y )
+#define HXMM( x, y, z ) _mm_xor_si128( _mm_xor_si128( x, y ), z )
+#define IXMM( x, y, z ) _mm_xor_si128( y, _mm_or_si128( x, _mm_xor_si128( z, ONES ) ) )
+
+#define ROL32XMM( x, n ) _mm_or_si128( _mm_slli_epi32( x, n ), _mm_srli_epi32( x, 32 - (n) ) )
+
+//
+// Transpose macro, convert S0..S3 into R0..R3; R0 is the lane 0, R3 is lane 3.
+// S0 = S00, S01, S02, S03; S1 = S10, S11, S12, S13; S2 = S20, S21, S22, S23; S3 = S30, S31, S32, S33
+// T0 = S00, S10, S01, S11; T1 = S02, S12, S03, S13; T2 = S20, S30, S21, S31; T3 = S22, S32, S23, S33
+// R0 = S00, S10, S20, S30; R1 = S01, S11, S21, S31; R2 = S02, S12, S22, S32; R3 = S03, S13, S23, S33
+//
+#define XMM_TRANSPOSE_32( _R0, _R1, _R2, _R3, _S0, _S1, _S2, _S3 ) \
+    {\
+        __m128i _T0, _T1, _T2, _T3;\
+        _T0 = _mm_unpacklo_epi32( _S0, _S1 ); _T1 = _mm_unpackhi_epi32( _S0, _S1 );\
+        _T2 = _mm_unpacklo_epi32( _S2, _S3 ); _T3 = _mm_unpackhi_epi32( _S2, _S3 );\
+        _R0 = _mm_unpacklo_epi64( _T0, _T2 ); _R1 = _mm_unpackhi_epi64( _T0, _T2 );\
+        _R2 = _mm_unpacklo_epi64( _T1, _T3 ); _R3 = _mm_unpackhi_epi64( _T1, _T3 );\
+    }
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5AppendBlocks_xmm( 
+    _Inout_updates_( 4 )                                PSYMCRYPT_MD5_CHAINING_STATE      * pChain,
+    _Inout_updates_( 4 )                                PCBYTE                            * ppByte,
+                                                        SIZE_T                              nBytes,
+    _Out_writes_( PAR_SCRATCH_ELEMENTS )                __m128i                           * pScratch )
+{
+    //
+    // Implementation that uses 4 lanes in the XMM registers
+    //
+    __m128i * ha = pScratch;        // chaining state words a, b, c, d
+    __m128i * W = &pScratch[4];     // W are the 16 words of the input block
+    __m128i A, B, C, D;
+    __m128i T0, T1, T2, T3;
+    __m128i ONES;
+    int r;
+
+    ONES = _mm_set1_epi32( -1 );
+
+    T0 = _mm_loadu_si128( (__m128i *)&pChain[0]->H[0] );
+    T1 = _mm_loadu_si128( (__m128i *)&pChain[1]->H[0] );
+    T2 = _mm_loadu_si128( (__m128i *)&pChain[2]->H[0] );
+    T3 = _mm_loadu_si128( (__m128i *)&pChain[3]->H[0] );
+
+    XMM_TRANSPOSE_32( ha[0], ha[1], ha[2], ha[3], T0, T1, T2, T3 );
+
+    while( nBytes >= 64 )
+    {
+        //
+        // Capture the input into W[0..15]
+        // Each message byte is read exactly once.
+        //
+        for( r=0; r<16; r += 4 )
+        {
+            T0 = _mm_loadu_si128( (__m128i *) ppByte[0] ); ppByte[0] += 16;
+            T1 = _mm_loadu_si128( (__m128i *) ppByte[1] ); ppByte[1] += 16;
+            T2 = _mm_loadu_si128( (__m128i *) ppByte[2] ); ppByte[2] += 16;
+            T3 = _mm_loadu_si128( (__m128i *) ppByte[3] ); ppByte[3] += 16;
+
+            XMM_TRANSPOSE_32( W[r], W[r+1], W[r+2], W[r+3], T0, T1, T2, T3 );
+        }
+
+        A = ha[0];
+        B = ha[1];
+        C = ha[2];
+        D = ha[3];
+
+        //
+        // Macro to compute one round
+        //
+        #define DO_ROUND( a, b, c, d, Func, i, K, s ) \
+            a = _mm_add_epi32( _mm_add_epi32( a, Func( b, c, d ) ), _mm_add_epi32( W[i], _mm_set1_epi32( K ) ) ); \
+            a = _mm_add_epi32( b, ROL32XMM( a, s ) );
+
+        MD5_ROUNDS( DO_ROUND, FXMM, GXMM, HXMM, IXMM );
+
+        #undef DO_ROUND
+
+        ha[0] = _mm_add_epi32( ha[0], A );
+        ha[1] = _mm_add_epi32( ha[1], B );
+        ha[2] = _mm_add_epi32( ha[2], C );
+        ha[3] = _mm_add_epi32( ha[3], D );
+
+        nBytes -= 64;
+    }
+
+    //
+    // Copy the chaining state back into the hash structure
+    //
+    XMM_TRANSPOSE_32( T0, T1, T2, T3, ha[0], ha[1], ha[2], ha[3] );
+    _mm_storeu_si128( (__m128i *)&pChain[0]->H[0], T0 );
+    _mm_storeu_si128( (__m128i *)&pChain[1]->H[0], T1 );
+    _mm_storeu_si128( (__m128i *)&pChain[2]->H[0], T2 );
+    _mm_storeu_si128( (__m128i *)&pChain[3]->H[0], T3 );
+}
+
+#undef FXMM
+#undef GXMM
+#undef HXMM
+#undef IXMM
+#undef ROL32XMM
+
+
+//
+// Code that uses the YMM registers.
+//
+
+#define FYMM( x, y, z ) _mm256_xor_si256( _mm256_and_si256( _mm256_xor_si256( z, y ), x ), z )
+#define GYMM( x, y, z ) FYMM( z, x, y )
+#define HYMM( x, y, z ) _mm256_xor_si256( _mm256_xor_si256( x, y ), z )
+#define IYMM( x, y, z ) _mm256_xor_si256( y, _mm256_or_si256( x, _mm256_xor_si256( z, ONES ) ) )
+
+#define ROL32YMM( x, n ) _mm256_or_si256( _mm256_slli_epi32( x, n ), _mm256_srli_epi32( x, 32 - (n) ) )
+
+//
+// Transpose macro, convert S0..S7 into R0..R7; R0 is the lane 0, R7 is lane 7.
+// See sha256Par.c for a description of the data movement.
+//
+#define YMM_TRANSPOSE_32( _R0, _R1, _R2, _R3, _R4, _R5, _R6, _R7, _S0, _S1, _S2, _S3, _S4, _S5, _S6, _S7 ) \
+    {\
+        __m256i _T0, _T1, _T2, _T3, _T4, _T5, _T6, _T7;\
+        __m256i _U0, _U1, _U2, _U3, _U4, _U5, _U6, _U7;\
+        _T0 = _mm256_unpacklo_epi32( _S0, _S1 );  _T1 = _mm256_unpackhi_epi32( _S0, _S1 );\
+        _T2 = _mm256_unpacklo_epi32( _S2, _S3 );  _T3 = _mm256_unpackhi_epi32( _S2, _S3 );\
+        _T4 = _mm256_unpacklo_epi32( _S4, _S5 );  _T5 = _mm256_unpackhi_epi32( _S4, _S5 );\
+        _T6 = _mm256_unpacklo_epi32( _S6, _S7 );  _T7 = _mm256_unpackhi_epi32( _S6, _S7 );\
+        \
+        _U0 = _mm256_unpacklo_epi64( _T0, _T2 );  _U1 = _mm256_unpackhi_epi64( _T0, _T2 );\
+        _U2 = _mm256_unpacklo_epi64( _T1, _T3 );  _U3 = _mm256_unpackhi_epi64( _T1, _T3 );\
+        _U4 = _mm256_unpacklo_epi64( _T4, _T6 );  _U5 = _mm256_unpackhi_epi64( _T4, _T6 );\
+        _U6 = _mm256_unpacklo_epi64( _T5, _T7 );  _U7 = _mm256_unpackhi_epi64( _T5, _T7 );\
+        \
+        _R0 = _mm256_permute2x128_si256( _U0, _U4, 0x20 );  _R1 = _mm256_permute2x128_si256( _U1, _U5, 0x20);\
+        _R2 = _mm256_permute2x128_si256( _U2, _U6, 0x20 );  _R3 = _mm256_permute2x128_si256( _U3, _U7, 0x20);\
+        _R4 = _mm256_permute2x128_si256( _U0, _U4, 0x31 );  _R5 = _mm256_permute2x128_si256( _U1, _U5, 0x31);\
+        _R6 = _mm256_permute2x128_si256( _U2, _U6, 0x31 );  _R7 = _mm256_permute2x128_si256( _U3, _U7, 0x31);\
+    }
+
+//
+// Combine two XMM values into one YMM value; _L goes into lanes 0-3 and _H into lanes 4-7.
+//
+#define YMM_FROM_XMM( _L, _H )  _mm256_inserti128_si256( _mm256_castsi128_si256( _L ), _H, 1 )
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5AppendBlocks_ymm( 
+    _Inout_updates_( 8 )                                PSYMCRYPT_MD5_CHAINING_STATE      * pChain,
+    _Inout_updates_( 8 )                                PCBYTE                            * ppByte,
+                                                        SIZE_T                              nBytes,
+    _Out_writes_( PAR_SCRATCH_ELEMENTS )                __m256i                           * pScratch )
+{
+    //
+    // Implementation that uses 8 lanes in the YMM registers
+    //
+    __m256i * ha = pScratch;        // chaining state words a, b, c, d
+    __m256i * W = &pScratch[4];     // W are the 16 words of the input block
+    __m256i A, B, C, D;
+    __m256i T0, T1, T2, T3, T4, T5, T6, T7;
+    __m128i L0, L1, L2, L3;
+    __m128i H0, H1, H2, H3;
+    __m256i ONES;
+    int r;
+
+    _mm256_zeroupper();
+    ONES = _mm256_set1_epi32( -1 );
+
+    //
+    // The chaining state is only 16 bytes per lane, so we transpose each group of 4 lanes
+    // in XMM registers and combine the results.
+    //
+    L0 = _mm_loadu_si128( (__m128i *)&pChain[0]->H[0] );
+    L1 = _mm_loadu_si128( (__m128i *)&pChain[1]->H[0] );
+    L2 = _mm_loadu_si128( (__m128i *)&pChain[2]->H[0] );
+    L3 = _mm_loadu_si128( (__m128i *)&pChain[3]->H[0] );
+    XMM_TRANSPOSE_32( L0, L1, L2, L3, L0, L1, L2, L3 );
+
+    H0 = _mm_loadu_si128( (__m128i *)&pChain[4]->H[0] );
+    H1 = _mm_loadu_si128( (__m128i *)&pChain[5]->H[0] );
+    H2 = _mm_loadu_si128( (__m128i *)&pChain[6]->H[0] );
+    H3 = _mm_loadu_si128( (__m128i *)&pChain[7]->H[0] );
+    XMM_TRANSPOSE_32( H0, H1, H2, H3, H0, H1, H2, H3 );
+
+    ha[0] = YMM_FROM_XMM( L0, H0 );
+    ha[1] = YMM_FROM_XMM( L1, H1 );
+    ha[2] = YMM_FROM_XMM( L2, H2 );
+    ha[3] = YMM_FROM_XMM( L3, H3 );
+
+    while( nBytes >= 64 )
+    {
+        //
+        // Capture the input into W[0..15]
+        // Each message byte is read exactly once.
+        //
+        for( r=0; r<16; r += 8 )
+        {
+            T0 = _mm256_loadu_si256( (__m256i *) ppByte[0] ); ppByte[0] += 32;
+            T1 = _mm256_loadu_si256( (__m256i *) ppByte[1] ); ppByte[1] += 32;
+            T2 = _mm256_loadu_si256( (__m256i *) ppByte[2] ); ppByte[2] += 32;
+            T3 = _mm256_loadu_si256( (__m256i *) ppByte[3] ); ppByte[3] += 32;
+            T4 = _mm256_loadu_si256( (__m256i *) ppByte[4] ); ppByte[4] += 32;
+            T5 = _mm256_loadu_si256( (__m256i *) ppByte[5] ); ppByte[5] += 32;
+            T6 = _mm256_loadu_si256( (__m256i *) ppByte[6] ); ppByte[6] += 32;
+            T7 = _mm256_loadu_si256( (__m256i *) ppByte[7] ); ppByte[7] += 32;
+
+            YMM_TRANSPOSE_32( W[r], W[r+1], W[r+2], W[r+3], W[r+4], W[r+5], W[r+6], W[r+7], T0, T1, T2, T3, T4, T5, T6, T7 );
+        }
+
+        A = ha[0];
+        B = ha[1];
+        C = ha[2];
+        D = ha[3];
+
+        //
+        // Macro to compute one round
+        //
+        #define DO_ROUND( a, b, c, d, Func, i, K, s ) \
+            a = _mm256_add_epi32( _mm256_add_epi32( a, Func( b, c, d ) ), _mm256_add_epi32( W[i], _mm256_set1_epi32( K ) ) ); \
+            a = _mm256_add_epi32( b, ROL32YMM( a, s ) );
+
+        MD5_ROUNDS( DO_ROUND, FYMM, GYMM, HYMM, IYMM );
+
+        #undef DO_ROUND
+
+        ha[0] = _mm256_add_epi32( ha[0], A );
+        ha[1] = _mm256_add_epi32( ha[1], B );
+        ha[2] = _mm256_add_epi32( ha[2], C );
+        ha[3] = _mm256_add_epi32( ha[3], D );
+
+        nBytes -= 64;
+    }
+
+    //
+    // Copy the chaining state back into the hash structure
+    //
+    L0 = _mm256_castsi256_si128( ha[0] );
+    L1 = _mm256_castsi256_si128( ha[1] );
+    L2 = _mm256_castsi256_si128( ha[2] );
+    L3 = _mm256_castsi256_si128( ha[3] );
+    XMM_TRANSPOSE_32( L0, L1, L2, L3, L0, L1, L2, L3 );
+    _mm_storeu_si128( (__m128i *)&pChain[0]->H[0], L0 );
+    _mm_storeu_si128( (__m128i *)&pChain[1]->H[0], L1 );
+    _mm_storeu_si128( (__m128i *)&pChain[2]->H[0], L2 );
+    _mm_storeu_si128( (__m128i *)&pChain[3]->H[0], L3 );
+
+    H0 = _mm256_extracti128_si256( ha[0], 1 );
+    H1 = _mm256_extracti128_si256( ha[1], 1 );
+    H2 = _mm256_extracti128_si256( ha[2], 1 );
+    H3 = _mm256_extracti128_si256( ha[3], 1 );
+    XMM_TRANSPOSE_32( H0, H1, H2, H3, H0, H1, H2, H3 );
+    _mm_storeu_si128( (__m128i *)&pChain[4]->H[0], H0 );
+    _mm_storeu_si128( (__m128i *)&pChain[5]->H[0], H1 );
+    _mm_storeu_si128( (__m128i *)&pChain[6]->H[0], H2 );
+    _mm_storeu_si128( (__m128i *)&pChain[7]->H[0], H3 );
+
+    _mm256_zeroupper();
+}
+
+#undef FYMM
+#undef GYMM
+#undef HYMM
+#undef IYMM
+#undef ROL32YMM
+#undef YMM_FROM_XMM
+#undef MD5_ROUNDS
+
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5AppendBytes_serial( 
+    _Inout_updates_( nPar )                 PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+    _In_range_(1, MAX_PARALLEL)             SIZE_T                                  nPar,
+                                            SIZE_T                                  nBytes )
+{
+    SIZE_T i;
+    SIZE_T tmp;
+
+    SYMCRYPT_ASSERT( nBytes % SYMCRYPT_MD5_INPUT_BLOCK_SIZE == 0 );
+    SYMCRYPT_ASSERT( nPar >= 1 && nPar <= MAX_PARALLEL );
+
+    for( i=0; i < nPar; i++ )
+    {
+        SYMCRYPT_ASSERT( pWork[i]->cbData >= nBytes );
+        SymCryptMd5AppendBlocks( & ((PSYMCRYPT_MD5_STATE)(pWork[i]->hashState))->chain, pWork[i]->pbData, nBytes, &tmp );
+        pWork[i]->pbData += nBytes;
+        pWork[i]->cbData -= nBytes;
+    }
+    return;
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5Append( 
+    _Inout_updates_( nPar )                 PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+    _In_range_(1, MAX_PARALLEL)             SIZE_T                                  nPar,
+                                            SIZE_T                                  nBytes,
+    _Out_writes_to_( SYMCRYPT_SIMD_ELEMENT_SIZE * PAR_SCRATCH_ELEMENTS, 0 ) 
+                                            PBYTE                                   pbSimdScratch,
+                                            SIZE_T                                  cbSimdScratch )
+{
+    PSYMCRYPT_MD5_CHAINING_STATE    apChain[MAX_PARALLEL];
+    PCBYTE                          apData[MAX_PARALLEL];
+    SIZE_T                          i;
+    UINT32                          maxParallel;
+
+    UNREFERENCED_PARAMETER( cbSimdScratch );        // not referenced on FRE builds 
+    SYMCRYPT_ASSERT( cbSimdScratch >= PAR_SCRATCH_ELEMENTS * SYMCRYPT_SIMD_ELEMENT_SIZE );
+    SYMCRYPT_ASSERT( ((UINT_PTR)pbSimdScratch & (SYMCRYPT_SIMD_ELEMENT_SIZE - 1)) == 0 );
+
+    //
+    // Compute maxParallel; this is 4 if nPar <= 4, and 8 if nPar = 5, ..., 8.
+    // This is how many parameter sets we have to set up.
+    //
+    maxParallel = (nPar + 3) & ~3;
+    SYMCRYPT_ASSERT( maxParallel == 4 || (maxParallel == 8 && SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 )) );
+
+    SYMCRYPT_ASSERT( nPar >= 1 && nPar <= maxParallel );
+
+    if( nPar < MIN_PARALLEL )
+    {
+        SymCryptParallelMd5AppendBytes_serial( pWork, nPar, nBytes );
+
+        // Done with this function.
+        goto cleanup;
+    }
+
+    //
+    // Our parallel code expects exactly four or eight parallel computations.
+    // We simply duplicate the first one if we get fewer parallel ones.
+    // That means we write the result multiple times, but it saves a lot of
+    // extra if()s in the main codeline.
+    //
+
+    i = 0;
+    while( i < nPar )
+    {
+            SYMCRYPT_ASSERT( pWork[i]->cbData >= nBytes );
+            apChain[i] =  & ((PSYMCRYPT_MD5_STATE)(pWork[i]->hashState))->chain;
+            apData[i] = pWork[i]->pbData;
+            pWork[i]->pbData += nBytes;
+            pWork[i]->cbData -= nBytes;
+            i++;
+    }
+
+    while( i < maxParallel )
+    {
+            apChain[i] = apChain[0];
+            apData[i] = apData[0];
+            i++;
+    }
+
+    if( maxParallel == 8 )
+    {
+        SymCryptParallelMd5AppendBlocks_ymm(  &apChain[0], &apData[0], nBytes, (__m256i *)pbSimdScratch );
+    } else {
+        SymCryptParallelMd5AppendBlocks_xmm(  &apChain[0], &apData[0], nBytes, (__m128i *)pbSimdScratch );
+    }
+
+cleanup:
+    ;// no cleanup at this moment.
+}
+
+#endif // SUPPORT_PARALLEL
+
+#if SUPPORT_PARALLEL
+
+const SYMCRYPT_PARALLEL_HASH SymCryptParallelMd5Algorithm_default = {
+    &SymCryptMd5Algorithm_default,
+    PAR_SCRATCH_ELEMENTS * SYMCRYPT_SIMD_ELEMENT_SIZE,
+    &SymCryptParallelMd5Result1,
+    &SymCryptParallelMd5Result2,
+    &SymCryptParallelMd5ResultDone,
+    &SymCryptParallelMd5Append,
+};
+
+#else
+
+//
+// For platforms that do not have a parallel hash implementation
+// we use this structure to provide the necessary data to the _serial
+// implementation of the function.
+//
+const SYMCRYPT_PARALLEL_HASH SymCryptParallelMd5Algorithm_default = {
+    &SymCryptMd5Algorithm_default,
+    PAR_SCRATCH_ELEMENTS * SYMCRYPT_SIMD_ELEMENT_SIZE,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+};
+
+#endif
+
+const PCSYMCRYPT_PARALLEL_HASH SymCryptParallelMd5Algorithm = &SymCryptParallelMd5Algorithm_default;
+
+
+#define N_SELFTEST_STATES   5      // Just enough to trigger YMM useage
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5Selftest()
+{
+    SYMCRYPT_MD5_STATE                  states[N_SELFTEST_STATES];
+    BYTE                                result[N_SELFTEST_STATES][SYMCRYPT_MD5_RESULT_SIZE];
+    SYMCRYPT_PARALLEL_HASH_OPERATION    op[2*N_SELFTEST_STATES];
+    BYTE                                scratch[SYMCRYPT_PARALLEL_MD5_FIXED_SCRATCH + N_SELFTEST_STATES * SYMCRYPT_PARALLEL_HASH_PER_STATE_SCRATCH];
+    int                                 i;
+
+    SymCryptParallelMd5Init( &states[0], N_SELFTEST_STATES );
+
+    for( i=0; i<N_SELFTEST_STATES; i++ )
+    {
+        op[2*i    ].iHash = i;
+        op[2*i    ].hashOperation = SYMCRYPT_HASH_OPERATION_APPEND;
+        op[2*i    ].pbBuffer = (PBYTE) SymCryptTestMsg3;
+        op[2*i    ].cbBuffer = sizeof(SymCryptTestMsg3);
+        op[2*i + 1].iHash = i;
+        op[2*i + 1].hashOperation = SYMCRYPT_HASH_OPERATION_RESULT;
+        op[2*i + 1].pbBuffer = &result[i][0];
+        op[2*i + 1].cbBuffer = SYMCRYPT_MD5_RESULT_SIZE;
+    }
+
+    SymCryptParallelMd5Process( &states[0], N_SELFTEST_STATES, op, 2*N_SELFTEST_STATES, scratch, sizeof( scratch ) );
+
+    for( i=0; i<N_SELFTEST_STATES; i++ )
+    {
+        SymCryptInjectError( &result[i][0], SYMCRYPT_MD5_RESULT_SIZE );
+
+        if( memcmp( &result[i][0], SymCryptMd5KATAnswer, SYMCRYPT_MD5_RESULT_SIZE ) != 0 ) {
+            SymCryptFatal( 'PMD5' );
+        }
+    }
+}
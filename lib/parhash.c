@@ -502,3 +502,60 @@ SymCryptParallelHashProcess(
     }
     SymCryptWipe( pbFixedScratch, cbFixedScratch );
 }
+
+//
+// Process nBytes of data on each of nWork scratch states, using up to maxParallel lanes of
+// the parallel code at a time; maxParallel <= 1 uses the serial append-blocks function.
+// The caller sets the hashState, pbData and cbData fields; nBytes must be a multiple of the block
+// size and no larger than any of the cbData fields.
+// This bypasses the operation lists and the padding logic of SymCryptParallelHashProcess. It is
+// meant for callers that do their own padding and run many short fixed-size hashes, such as PBKDF2.
+// The caller is responsible for saving the extended register state when maxParallel > 1.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptParallelHashAppendLanes(
+    _In_                            PCSYMCRYPT_PARALLEL_HASH                pParHash,
+    _Inout_updates_( nWork )        PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+                                    SIZE_T                                  nWork,
+                                    SIZE_T                                  nBytes,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch,
+                                    UINT32                                  maxParallel )
+{
+    PCSYMCRYPT_HASH pHash;
+    PBYTE           pbFixedScratch;
+    SIZE_T          nPar;
+    SIZE_T          cbRemaining;
+    SIZE_T          i;
+
+    pHash = pParHash->pHash;
+
+    SYMCRYPT_ASSERT( (nBytes & (pHash->inputBlockSize - 1)) == 0 );
+
+    if( maxParallel <= 1 )
+    {
+        for( i=0; i<nWork; i++ )
+        {
+            SYMCRYPT_ASSERT( pWork[i]->cbData >= nBytes );
+            (*pHash->appendBlockFunc)( (PBYTE)pWork[i]->hashState + pHash->chainOffset, pWork[i]->pbData, nBytes, &cbRemaining );
+            pWork[i]->pbData += nBytes;
+            pWork[i]->cbData -= nBytes;
+        }
+        return;
+    }
+
+    pbFixedScratch = (PBYTE)((((UINT_PTR)pbScratch) + SYMCRYPT_SIMD_ELEMENT_SIZE - 1) & ~(SYMCRYPT_SIMD_ELEMENT_SIZE - 1));
+    if( pbFixedScratch + pParHash->parScratchFixed > pbScratch + cbScratch )
+    {
+        SymCryptFatal( 'ps2l' );
+    }
+
+    while( nWork > 0 )
+    {
+        nPar = SYMCRYPT_MIN( nWork, maxParallel );
+        (*pParHash->parAppendFunc)( pWork, nPar, nBytes, pbFixedScratch, pParHash->parScratchFixed );
+        pWork += nPar;
+        nWork -= nPar;
+    }
+}
@@ -0,0 +1,97 @@
+//
+// parhmac_pattern.c
+// Parallel HMAC on top of the parallel hash code.
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+// The HMAC of a message is computed in two parallel hash passes.
+// The first pass computes the inner hash of each message, starting from the ipad chaining
+// state in the expanded key. The inner hash result is written to the caller's result buffer.
+// The second pass hashes the inner result starting from the opad chaining state.
+//
+
+VOID
+SYMCRYPT_CALL
+SYMCRYPT_ParallelHmacXxx(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_HMAC_XXX_OPERATION  pOperations,
+                                SIZE_T                                  nOperations,
+    _Out_writes_( cbScratch )   PBYTE                                   pbScratch,
+                                SIZE_T                                  cbScratch )
+{
+    PSYMCRYPT_XXX_STATE                 pStates;
+    PSYMCRYPT_PARALLEL_HASH_OPERATION   pHashOps;
+    PBYTE                               pbHashScratch;
+    SIZE_T                              cbHashScratch;
+    SIZE_T                              i;
+
+    if( cbScratch < SYMCRYPT_PARALLEL_HMAC_XXX_FIXED_SCRATCH + nOperations * SYMCRYPT_PARALLEL_HMAC_XXX_PER_OPERATION_SCRATCH )
+    {
+        SymCryptFatal( 'phms' );
+    }
+
+    if( nOperations == 0 )
+    {
+        return;
+    }
+
+    //
+    // Scratch layout: the hash states, then two hash operations per message, then the
+    // scratch space of the parallel hash function.
+    // The hash states are a multiple of SYMCRYPT_ALIGN_VALUE in size so everything stays aligned.
+    //
+    pStates = (PSYMCRYPT_XXX_STATE) SYMCRYPT_ALIGN_UP( pbScratch );
+    pHashOps = (PSYMCRYPT_PARALLEL_HASH_OPERATION) &pStates[nOperations];
+    pbHashScratch = (PBYTE) &pHashOps[2 * nOperations];
+    cbHashScratch = SYMCRYPT_PARALLEL_XXX_FIXED_SCRATCH + nOperations * SYMCRYPT_PARALLEL_HASH_PER_STATE_SCRATCH;
+
+    SYMCRYPT_ASSERT( pbHashScratch + cbHashScratch <= pbScratch + cbScratch );
+
+    //
+    // Inner hash: state starts after the ipad block, and the result goes into the
+    // caller's result buffer.
+    //
+    for( i=0; i<nOperations; i++ )
+    {
+        SYMCRYPT_CHECK_MAGIC( pOperations[i].pExpandedKey );
+
+        SYMCRYPT_SET_MAGIC( &pStates[i] );
+        pStates[i].chain = pOperations[i].pExpandedKey->innerState;
+        SET_DATALENGTH( pStates[i], SYMCRYPT_XXX_INPUT_BLOCK_SIZE );
+        pStates[i].bytesInBuffer = 0;
+
+        pHashOps[2*i].iHash = i;
+        pHashOps[2*i].hashOperation = SYMCRYPT_HASH_OPERATION_APPEND;
+        pHashOps[2*i].pbBuffer = (PBYTE) pOperations[i].pbData;
+        pHashOps[2*i].cbBuffer = pOperations[i].cbData;
+
+        pHashOps[2*i + 1].iHash = i;
+        pHashOps[2*i + 1].hashOperation = SYMCRYPT_HASH_OPERATION_RESULT;
+        pHashOps[2*i + 1].pbBuffer = pOperations[i].pbResult;
+        pHashOps[2*i + 1].cbBuffer = SYMCRYPT_XXX_RESULT_SIZE;
+    }
+
+    SYMCRYPT_ParallelXxxProcess( pStates, nOperations, pHashOps, 2 * nOperations, pbHashScratch, cbHashScratch );
+
+    //
+    // Outer hash: the inner result is put directly in the state buffer, as in SymCryptHmacXxxResult.
+    // The Result operation of the first pass has re-initialized each state.
+    //
+    for( i=0; i<nOperations; i++ )
+    {
+        pStates[i].chain = pOperations[i].pExpandedKey->outerState;
+        memcpy( &pStates[i].buffer[0], pOperations[i].pbResult, SYMCRYPT_XXX_RESULT_SIZE );
+        SET_DATALENGTH( pStates[i], SYMCRYPT_XXX_INPUT_BLOCK_SIZE + SYMCRYPT_XXX_RESULT_SIZE );
+        pStates[i].bytesInBuffer = SYMCRYPT_XXX_RESULT_SIZE;
+
+        pHashOps[i].iHash = i;
+        pHashOps[i].hashOperation = SYMCRYPT_HASH_OPERATION_RESULT;
+        pHashOps[i].pbBuffer = pOperations[i].pbResult;
+        pHashOps[i].cbBuffer = SYMCRYPT_XXX_RESULT_SIZE;
+    }
+
+    SYMCRYPT_ParallelXxxProcess( pStates, nOperations, pHashOps, nOperations, pbHashScratch, cbHashScratch );
+
+    //
+    // The Result operations wipe the hash states, so there is nothing secret left in
+    // the states. The operation array only contains pointers.
+    //
+}
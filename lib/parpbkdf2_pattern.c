@@ -0,0 +1,263 @@
+//
+// parpbkdf2_pattern.c
+// Parallel PBKDF2 with HMAC on top of the parallel hash code.
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+// Each output block of each derivation is an independent chain of iterationCnt HMAC computations.
+// We run these chains as lanes of the parallel hash code, as many as the scratch space has room for
+// but at most SYMCRYPT_PARALLEL_PBKDF2_LANES, and start the next pending output block on a lane as soon
+// as its chain is finished.
+//
+// After the first iteration every HMAC computation hashes one block of inner or outer pad, which
+// is in the chaining states of the expanded key, followed by a single message block consisting of
+// a hash result and the padding. The padding is the same for the inner and outer hash, so each
+// lane keeps the padded message block in its hash state buffer and we only replace the first
+// SYMCRYPT_XXX_RESULT_SIZE bytes between the compression function calls.
+// The first iteration hashes the salt and block index and uses the normal HMAC code.
+//
+
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SYMCRYPT_ParallelPbkdf2HmacXxxInternal(
+    _In_reads_( nOperations )       PCSYMCRYPT_PARALLEL_PBKDF2_OPERATION    pOperations,
+                                    SIZE_T                                  nOperations,
+                                    BOOLEAN                                 bVerify,
+    _Out_writes_opt_( nOperations ) SYMCRYPT_ERROR *                        pResults,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch )
+{
+    SYMCRYPT_ERROR                          scError = SYMCRYPT_NO_ERROR;
+    PSYMCRYPT_XXX_STATE                     pStates;
+    PSYMCRYPT_XXX_STATE                     pState;
+    PSYMCRYPT_HMAC_XXX_EXPANDED_KEY         pKeys;
+    PSYMCRYPT_PARALLEL_PBKDF2_LANE          pLanes;
+    PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE   pScratchStates;
+    PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork;
+    PBYTE                                   pbHashScratch;
+    SIZE_T                                  cbHashScratch;
+    SYMCRYPT_HMAC_XXX_STATE                 hmacState;
+    PCSYMCRYPT_PARALLEL_PBKDF2_OPERATION    pOp;
+    SIZE_T                                  iOperation;
+    SIZE_T                                  cbAssigned;
+    SIZE_T                                  nWork;
+    SIZE_T                                  nLanes;
+    SIZE_T                                  cbBlock;
+    SIZE_T                                  i;
+    BYTE                                    blockIndex[4];
+
+    if( cbScratch < SYMCRYPT_PARALLEL_PBKDF2_HMAC_XXX_FIXED_SCRATCH + SYMCRYPT_PARALLEL_PBKDF2_HMAC_XXX_PER_LANE_SCRATCH )
+    {
+        SymCryptFatal( 'ppbs' );
+    }
+
+    nLanes = SYMCRYPT_MIN( SYMCRYPT_PARALLEL_PBKDF2_LANES,
+                           (cbScratch - SYMCRYPT_PARALLEL_PBKDF2_HMAC_XXX_FIXED_SCRATCH) / SYMCRYPT_PARALLEL_PBKDF2_HMAC_XXX_PER_LANE_SCRATCH );
+
+    for( i=0; i<nOperations; i++ )
+    {
+        if( pOperations[i].iterationCnt == 0 )
+        {
+            scError = SYMCRYPT_WRONG_ITERATION_COUNT;
+        }
+    }
+
+    //
+    // If the batch is rejected nothing is verified, so every operation gets the error.
+    //
+    if( pResults != NULL )
+    {
+        for( i=0; i<nOperations; i++ )
+        {
+            pResults[i] = scError;
+        }
+    }
+
+    if( scError != SYMCRYPT_NO_ERROR )
+    {
+        return scError;
+    }
+
+    //
+    // Scratch layout: hash states, HMAC keys, lane bookkeeping, parallel hash scratch states, work array,
+    // and the fixed scratch of the parallel hash code.
+    // The structures are all SYMCRYPT_ALIGN'ed so everything stays aligned.
+    //
+    pStates = (PSYMCRYPT_XXX_STATE) SYMCRYPT_ALIGN_UP( pbScratch );
+    pKeys = (PSYMCRYPT_HMAC_XXX_EXPANDED_KEY) &pStates[nLanes];
+    pLanes = (PSYMCRYPT_PARALLEL_PBKDF2_LANE) &pKeys[nLanes];
+    pScratchStates = (PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE) &pLanes[nLanes];
+    pWork = (PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE *) &pScratchStates[nLanes];
+    pbHashScratch = (PBYTE) &pWork[nLanes];
+    cbHashScratch = SYMCRYPT_PARALLEL_XXX_FIXED_SCRATCH;
+
+    SYMCRYPT_ASSERT( pbHashScratch + cbHashScratch <= pbScratch + cbScratch );
+
+    for( i=0; i<nLanes; i++ )
+    {
+        pLanes[i].iterationsLeft = 0;
+        pScratchStates[i].hashState = &pStates[i];
+    }
+
+    iOperation = 0;
+    cbAssigned = 0;
+    while( iOperation < nOperations && pOperations[iOperation].cbResult == 0 )
+    {
+        iOperation++;
+    }
+
+    for(;;)
+    {
+        //
+        // Start the next output blocks on the idle lanes
+        //
+        for( i=0; i<nLanes && iOperation < nOperations; i++ )
+        {
+            if( pLanes[i].iterationsLeft != 0 )
+            {
+                continue;
+            }
+
+            pOp = &pOperations[iOperation];
+
+            SYMCRYPT_HmacXxxExpandKey( &pKeys[i], pOp->pbPassword, pOp->cbPassword );
+
+            SYMCRYPT_STORE_MSBFIRST32( blockIndex, (UINT32)(cbAssigned / SYMCRYPT_XXX_RESULT_SIZE + 1) );
+            SYMCRYPT_HmacXxxInit( &hmacState, &pKeys[i] );
+            SYMCRYPT_HmacXxxAppend( &hmacState, pOp->pbSalt, pOp->cbSalt );
+            SYMCRYPT_HmacXxxAppend( &hmacState, blockIndex, sizeof( blockIndex ) );
+            SYMCRYPT_HmacXxxResult( &hmacState, &pStates[i].buffer[0] );
+
+            memcpy( &pLanes[i].rbBlockResult[0], &pStates[i].buffer[0], SYMCRYPT_XXX_RESULT_SIZE );
+            pLanes[i].iOperation = iOperation;
+            pLanes[i].cbOffset = cbAssigned;
+            pLanes[i].iterationsLeft = pOp->iterationCnt;
+
+            //
+            // Padding for a message of one pad block plus one hash result.
+            // For SHA-512 the upper half of the 128-bit length field is zero.
+            //
+            pStates[i].buffer[SYMCRYPT_XXX_RESULT_SIZE] = 0x80;
+            SymCryptWipe( &pStates[i].buffer[SYMCRYPT_XXX_RESULT_SIZE + 1], SYMCRYPT_XXX_INPUT_BLOCK_SIZE - SYMCRYPT_XXX_RESULT_SIZE - 1 );
+            SYMCRYPT_STORE_MSBFIRST64(  &pStates[i].buffer[SYMCRYPT_XXX_INPUT_BLOCK_SIZE - 8],
+                                        (SYMCRYPT_XXX_INPUT_BLOCK_SIZE + SYMCRYPT_XXX_RESULT_SIZE) * 8 );
+
+            cbAssigned += SYMCRYPT_XXX_RESULT_SIZE;
+            if( cbAssigned >= pOp->cbResult )
+            {
+                cbAssigned = 0;
+                do {
+                    iOperation++;
+                } while( iOperation < nOperations && pOperations[iOperation].cbResult == 0 );
+            }
+        }
+
+        //
+        // Finish the lanes that are done and collect the others
+        //
+        nWork = 0;
+        for( i=0; i<nLanes; i++ )
+        {
+            if( pLanes[i].iterationsLeft == 0 )
+            {
+                continue;
+            }
+
+            pLanes[i].iterationsLeft--;
+            if( pLanes[i].iterationsLeft > 0 )
+            {
+                pWork[nWork++] = &pScratchStates[i];
+                continue;
+            }
+
+            pOp = &pOperations[pLanes[i].iOperation];
+            cbBlock = SYMCRYPT_MIN( pOp->cbResult - pLanes[i].cbOffset, SYMCRYPT_XXX_RESULT_SIZE );
+
+            if( !bVerify )
+            {
+                memcpy( pOp->pbResult + pLanes[i].cbOffset, &pLanes[i].rbBlockResult[0], cbBlock );
+            }
+            else if( !SymCryptEqual( pOp->pbResult + pLanes[i].cbOffset, &pLanes[i].rbBlockResult[0], cbBlock ) )
+            {
+                scError = SYMCRYPT_AUTHENTICATION_FAILURE;
+                if( pResults != NULL )
+                {
+                    pResults[pLanes[i].iOperation] = SYMCRYPT_AUTHENTICATION_FAILURE;
+                }
+            }
+        }
+
+        if( nWork == 0 )
+        {
+            if( iOperation < nOperations )
+            {
+                // All lanes finished in their first iteration; start new ones
+                continue;
+            }
+            break;
+        }
+
+        //
+        // One PBKDF2 iteration on each busy lane: the inner hash, then the outer hash
+        //
+        for( i=0; i<nWork; i++ )
+        {
+            pState = (PSYMCRYPT_XXX_STATE) pWork[i]->hashState;
+            pState->chain = pKeys[pState - pStates].innerState;
+            pWork[i]->pbData = &pState->buffer[0];
+            pWork[i]->cbData = SYMCRYPT_XXX_INPUT_BLOCK_SIZE;
+        }
+
+        SYMCRYPT_ParallelXxxAppendLanes( pWork, nWork, SYMCRYPT_XXX_INPUT_BLOCK_SIZE, pbHashScratch, cbHashScratch );
+
+        for( i=0; i<nWork; i++ )
+        {
+            pState = (PSYMCRYPT_XXX_STATE) pWork[i]->hashState;
+            STORE_CHAIN( &pState->buffer[0], &pState->chain );
+            pState->chain = pKeys[pState - pStates].outerState;
+            pWork[i]->pbData = &pState->buffer[0];
+            pWork[i]->cbData = SYMCRYPT_XXX_INPUT_BLOCK_SIZE;
+        }
+
+        SYMCRYPT_ParallelXxxAppendLanes( pWork, nWork, SYMCRYPT_XXX_INPUT_BLOCK_SIZE, pbHashScratch, cbHashScratch );
+
+        for( i=0; i<nWork; i++ )
+        {
+            pState = (PSYMCRYPT_XXX_STATE) pWork[i]->hashState;
+            STORE_CHAIN( &pState->buffer[0], &pState->chain );
+            SymCryptXorBytes(   &pState->buffer[0],
+                                &pLanes[pState - pStates].rbBlockResult[0],
+                                &pLanes[pState - pStates].rbBlockResult[0],
+                                SYMCRYPT_XXX_RESULT_SIZE );
+        }
+    }
+
+    SymCryptWipeKnownSize( &hmacState, sizeof( hmacState ) );
+    SymCryptWipe( pbScratch, SYMCRYPT_PARALLEL_PBKDF2_HMAC_XXX_FIXED_SCRATCH + nLanes * SYMCRYPT_PARALLEL_PBKDF2_HMAC_XXX_PER_LANE_SCRATCH );
+
+    return scError;
+}
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SYMCRYPT_ParallelPbkdf2HmacXxx(
+    _In_reads_( nOperations )   PCSYMCRYPT_PARALLEL_PBKDF2_OPERATION    pOperations,
+                                SIZE_T                                  nOperations,
+    _Out_writes_( cbScratch )   PBYTE                                   pbScratch,
+                                SIZE_T                                  cbScratch )
+{
+    return SYMCRYPT_ParallelPbkdf2HmacXxxInternal( pOperations, nOperations, FALSE, NULL, pbScratch, cbScratch );
+}
+
+_Success_(return == SYMCRYPT_NO_ERROR)
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SYMCRYPT_ParallelPbkdf2HmacXxxVerify(
+    _In_reads_( nOperations )       PCSYMCRYPT_PARALLEL_PBKDF2_OPERATION    pOperations,
+                                    SIZE_T                                  nOperations,
+    _Out_writes_opt_( nOperations ) SYMCRYPT_ERROR *                        pResults,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch )
+{
+    return SYMCRYPT_ParallelPbkdf2HmacXxxInternal( pOperations, nOperations, TRUE, pResults, pbScratch, cbScratch );
+}
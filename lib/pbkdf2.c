@@ -11,6 +11,85 @@
 
 #include "precomp.h"
 
+//
+// The iteration code below finds the inner chaining state at the start of the HMAC expanded key.
+//
+C_ASSERT( SYMCRYPT_FIELD_OFFSET( SYMCRYPT_HMAC_SHA1_EXPANDED_KEY, innerState ) == 0 );
+C_ASSERT( SYMCRYPT_FIELD_OFFSET( SYMCRYPT_HMAC_SHA256_EXPANDED_KEY, innerState ) == 0 );
+C_ASSERT( SYMCRYPT_FIELD_OFFSET( SYMCRYPT_HMAC_SHA384_EXPANDED_KEY, innerState ) == 0 );
+C_ASSERT( SYMCRYPT_FIELD_OFFSET( SYMCRYPT_HMAC_SHA512_EXPANDED_KEY, innerState ) == 0 );
+
+//
+// Run the PBKDF2 iterations 2..iterationCnt of one output block for HMAC with a SHA-family hash,
+// i.e., a MAC with a non-zero outerChainingStateOffset.
+//
+// Each of these HMAC computations hashes the inner or outer pad, whose chaining states are in the
+// expanded key, followed by one block that consists of a hash result and the padding.
+// The padding is the same for every inner and outer hash, so we build the block once and call
+// the append-blocks function of the hash twice per iteration. This avoids the state copies and
+// buffer management of the Init/Append/Result functions.
+//
+// pbWork contains U_1 on entry, pbBlockResult contains U_1 on entry and the XOR of all U_i on exit.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptPbkdf2HmacIterate(
+    _In_                                        PCSYMCRYPT_MAC              pMacAlgorithm,
+    _In_                                        PCSYMCRYPT_MAC_EXPANDED_KEY pMacKey,
+    _In_reads_( pMacAlgorithm->resultSize )     PCBYTE                      pbWork,
+    _Inout_updates_( pMacAlgorithm->resultSize )PBYTE                       pbBlockResult,
+                                                UINT64                      nIterations )
+{
+    PCSYMCRYPT_HASH         pHash = *(pMacAlgorithm->ppHashAlgorithm);
+    PCBYTE                  pbInnerChain = (PCBYTE) pMacKey;
+    PCBYTE                  pbOuterChain = (PCBYTE) pMacKey + pMacAlgorithm->outerChainingStateOffset;
+    SIZE_T                  cbResult = pMacAlgorithm->resultSize;
+    SIZE_T                  cbBlock = pHash->inputBlockSize;
+    SIZE_T                  cbChain = pHash->chainSize;
+    SIZE_T                  cbRemaining;
+    SYMCRYPT_ALIGN UINT64   chain[8];
+    SYMCRYPT_ALIGN BYTE     block[SYMCRYPT_SHA512_INPUT_BLOCK_SIZE];
+
+    SYMCRYPT_ASSERT( cbChain <= sizeof( chain ) && cbBlock <= sizeof( block ) && cbResult <= cbChain );
+
+    memcpy( block, pbWork, cbResult );
+    block[cbResult] = 0x80;
+    SymCryptWipe( &block[cbResult + 1], cbBlock - cbResult - 1 );
+    SYMCRYPT_STORE_MSBFIRST64( &block[cbBlock - 8], (cbBlock + cbResult) * 8 );
+
+    while( nIterations > 0 )
+    {
+        memcpy( chain, pbInnerChain, cbChain );
+        (*pHash->appendBlockFunc)( chain, block, cbBlock, &cbRemaining );
+
+        //
+        // The chaining state words are in native format, the hash result is MSB first
+        //
+        if( cbResult <= 32 )
+        {
+            SymCryptUint32ToMsbFirst( (PCUINT32) chain, block, cbResult / 4 );
+        } else {
+            SymCryptUint64ToMsbFirst( chain, block, cbResult / 8 );
+        }
+
+        memcpy( chain, pbOuterChain, cbChain );
+        (*pHash->appendBlockFunc)( chain, block, cbBlock, &cbRemaining );
+
+        if( cbResult <= 32 )
+        {
+            SymCryptUint32ToMsbFirst( (PCUINT32) chain, block, cbResult / 4 );
+        } else {
+            SymCryptUint64ToMsbFirst( chain, block, cbResult / 8 );
+        }
+
+        SymCryptXorBytes( block, pbBlockResult, pbBlockResult, cbResult );
+        nIterations--;
+    }
+
+    SymCryptWipeKnownSize( chain, sizeof( chain ) );
+    SymCryptWipeKnownSize( block, sizeof( block ) );
+}
+
 _Success_(return == SYMCRYPT_NO_ERROR)
 SYMCRYPT_ERROR
 SYMCRYPT_CALL
@@ -52,12 +131,19 @@ SymCryptPbkdf2Derive(
 
 #pragma warning(suppress: 22105)
         memcpy( rbBlockResult, rbWorkBuffer, blockSize );
-        for( iterations = 1; iterations < iterationCnt; iterations++ )
+        if( pExpandedKey->macAlg->outerChainingStateOffset != 0 )
+        {
+            SymCryptPbkdf2HmacIterate( pExpandedKey->macAlg, &pExpandedKey->macKey, rbWorkBuffer, rbBlockResult, iterationCnt - 1 );
+        }
+        else
         {
-            pExpandedKey->macAlg->initFunc  ( &macState, &pExpandedKey->macKey );
-            pExpandedKey->macAlg->appendFunc( &macState, rbWorkBuffer, blockSize );
-            pExpandedKey->macAlg->resultFunc( &macState, rbWorkBuffer );
-            SymCryptXorBytes( &rbWorkBuffer[0], &rbBlockResult[0], &rbBlockResult[0], blockSize );
+            for( iterations = 1; iterations < iterationCnt; iterations++ )
+            {
+                pExpandedKey->macAlg->initFunc  ( &macState, &pExpandedKey->macKey );
+                pExpandedKey->macAlg->appendFunc( &macState, rbWorkBuffer, blockSize );
+                pExpandedKey->macAlg->resultFunc( &macState, rbWorkBuffer );
+                SymCryptXorBytes( &rbWorkBuffer[0], &rbBlockResult[0], &rbBlockResult[0], blockSize );
+            }
         }
         
         bytes = min( cbResult, blockSize );
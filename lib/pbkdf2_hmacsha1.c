@@ -6,6 +6,14 @@
 
 #include "precomp.h"
 
+#define ALG SHA1
+#define Alg Sha1
+#define STORE_CHAIN( pb, pChain )   SymCryptUint32ToMsbFirst( &(pChain)->H[0], (pb), 5 )
+#include "parpbkdf2_pattern.c"
+#undef STORE_CHAIN
+#undef Alg
+#undef ALG
+
 
 //
 // The PBKDF SHA-1 test 
@@ -41,3 +49,38 @@ SymCryptPbkdf2_HmacSha1SelfTest()
     }
 }
 
+
+#define N_PARALLEL_SELFTEST_OPERATIONS  2
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelPbkdf2HmacSha1Selftest()
+{
+    SYMCRYPT_PARALLEL_PBKDF2_OPERATION  op[N_PARALLEL_SELFTEST_OPERATIONS];
+    BYTE                                res[N_PARALLEL_SELFTEST_OPERATIONS][sizeof( pbkdf2_sha1Answer )];
+    BYTE                                scratch[SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA1_FIXED_SCRATCH + N_PARALLEL_SELFTEST_OPERATIONS * SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA1_PER_LANE_SCRATCH];
+    SIZE_T                              i;
+
+    for( i=0; i<N_PARALLEL_SELFTEST_OPERATIONS; i++ )
+    {
+        op[i].pbPassword = &SymCryptTestKey32[0];
+        op[i].cbPassword = 8;
+        op[i].pbSalt = &SymCryptTestKey32[16];
+        op[i].cbSalt = 16;
+        op[i].iterationCnt = pbkdf2_IterationCnt;
+        op[i].pbResult = &res[i][0];
+        op[i].cbResult = sizeof( pbkdf2_sha1Answer );
+    }
+
+    SymCryptParallelPbkdf2HmacSha1( op, N_PARALLEL_SELFTEST_OPERATIONS, scratch, sizeof( scratch ) );
+
+    SymCryptInjectError( &res[0][0], sizeof( res ) );
+
+    for( i=0; i<N_PARALLEL_SELFTEST_OPERATIONS; i++ )
+    {
+        if( memcmp( &res[i][0], pbkdf2_sha1Answer, sizeof( pbkdf2_sha1Answer ) ) != 0 )
+        {
+            SymCryptFatal( 'ppk1' );
+        }
+    }
+}
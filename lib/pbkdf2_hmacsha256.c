@@ -6,6 +6,14 @@
 
 #include "precomp.h"
 
+#define ALG SHA256
+#define Alg Sha256
+#define STORE_CHAIN( pb, pChain )   SymCryptUint32ToMsbFirst( &(pChain)->H[0], (pb), 8 )
+#include "parpbkdf2_pattern.c"
+#undef STORE_CHAIN
+#undef Alg
+#undef ALG
+
 //
 // The PBKDF SHA-256 test 
 // This is in a separate module to avoid pullingin SHA-1 whenever we use PBKDF-SHA-1
@@ -39,3 +47,38 @@ SymCryptPbkdf2_HmacSha256SelfTest()
         SymCryptFatal('Pbk2');
     }
 }
+
+#define N_PARALLEL_SELFTEST_OPERATIONS  2
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelPbkdf2HmacSha256Selftest()
+{
+    SYMCRYPT_PARALLEL_PBKDF2_OPERATION  op[N_PARALLEL_SELFTEST_OPERATIONS];
+    BYTE                                res[N_PARALLEL_SELFTEST_OPERATIONS][sizeof( pbkdf2_sha256Answer )];
+    BYTE                                scratch[SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA256_FIXED_SCRATCH + N_PARALLEL_SELFTEST_OPERATIONS * SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA256_PER_LANE_SCRATCH];
+    SIZE_T                              i;
+
+    for( i=0; i<N_PARALLEL_SELFTEST_OPERATIONS; i++ )
+    {
+        op[i].pbPassword = &SymCryptTestKey32[0];
+        op[i].cbPassword = 8;
+        op[i].pbSalt = &SymCryptTestKey32[16];
+        op[i].cbSalt = 16;
+        op[i].iterationCnt = pbkdf2_IterationCnt;
+        op[i].pbResult = &res[i][0];
+        op[i].cbResult = sizeof( pbkdf2_sha256Answer );
+    }
+
+    SymCryptParallelPbkdf2HmacSha256( op, N_PARALLEL_SELFTEST_OPERATIONS, scratch, sizeof( scratch ) );
+
+    SymCryptInjectError( &res[0][0], sizeof( res ) );
+
+    for( i=0; i<N_PARALLEL_SELFTEST_OPERATIONS; i++ )
+    {
+        if( memcmp( &res[i][0], pbkdf2_sha256Answer, sizeof( pbkdf2_sha256Answer ) ) != 0 )
+        {
+            SymCryptFatal( 'ppk2' );
+        }
+    }
+}
@@ -0,0 +1,62 @@
+//
+// pbkdf2_hmacsha512.c
+//
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+
+#include "precomp.h"
+
+#define ALG SHA512
+#define Alg Sha512
+#define STORE_CHAIN( pb, pChain )   SymCryptUint64ToMsbFirst( &(pChain)->H[0], (pb), 8 )
+#include "parpbkdf2_pattern.c"
+#undef STORE_CHAIN
+#undef Alg
+#undef ALG
+
+//
+// The parallel PBKDF2 HMAC-SHA512 test.
+// We have no serial PBKDF2 self test for HMAC-SHA512, so the answer is in this module.
+//
+
+static const UINT64 pbkdf2_IterationCnt = 5;
+
+static const BYTE    pbkdf2_sha512Answer[] =
+{
+    0xeb, 0x16, 0x69, 0x1f, 0xcf, 0x6b, 0x34, 0x2d,
+};
+
+#define N_PARALLEL_SELFTEST_OPERATIONS  2
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelPbkdf2HmacSha512Selftest()
+{
+    SYMCRYPT_PARALLEL_PBKDF2_OPERATION  op[N_PARALLEL_SELFTEST_OPERATIONS];
+    BYTE                                res[N_PARALLEL_SELFTEST_OPERATIONS][sizeof( pbkdf2_sha512Answer )];
+    BYTE                                scratch[SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA512_FIXED_SCRATCH + N_PARALLEL_SELFTEST_OPERATIONS * SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA512_PER_LANE_SCRATCH];
+    SIZE_T                              i;
+
+    for( i=0; i<N_PARALLEL_SELFTEST_OPERATIONS; i++ )
+    {
+        op[i].pbPassword = &SymCryptTestKey32[0];
+        op[i].cbPassword = 8;
+        op[i].pbSalt = &SymCryptTestKey32[16];
+        op[i].cbSalt = 16;
+        op[i].iterationCnt = pbkdf2_IterationCnt;
+        op[i].pbResult = &res[i][0];
+        op[i].cbResult = sizeof( pbkdf2_sha512Answer );
+    }
+
+    SymCryptParallelPbkdf2HmacSha512( op, N_PARALLEL_SELFTEST_OPERATIONS, scratch, sizeof( scratch ) );
+
+    SymCryptInjectError( &res[0][0], sizeof( res ) );
+
+    for( i=0; i<N_PARALLEL_SELFTEST_OPERATIONS; i++ )
+    {
+        if( memcmp( &res[i][0], pbkdf2_sha512Answer, sizeof( pbkdf2_sha512Answer ) ) != 0 )
+        {
+            SymCryptFatal( 'ppk5' );
+        }
+    }
+}
@@ -14,12 +14,16 @@
     #include <windows.h>
 
     #define ATOMIC_OR32(_dest, _val)     InterlockedOr( (volatile LONG *)(_dest), (LONG)(_val) )
+    #define ATOMIC_CAS_PTR(_dest, _new, _old)   (InterlockedCompareExchangePointer( (PVOID volatile *)(_dest), (PVOID)(_new), (PVOID)(_old) ) == (PVOID)(_old))
+    #define SYMCRYPT_MEMORY_BARRIER()    MemoryBarrier()
 
 #elif defined(__APPLE_CC__)
 
     #include "precomp_iOS.h"
 
     #define ATOMIC_OR32(_dest, _val)     OSAtomicOr32Barrier( (uint32_t)(_val), (volatile uint32_t *)(_dest) )
+    #define ATOMIC_CAS_PTR(_dest, _new, _old)   OSAtomicCompareAndSwapPtrBarrier( (void *)(_old), (void *)(_new), (void * volatile *)(_dest) )
+    #define SYMCRYPT_MEMORY_BARRIER()    OSMemoryBarrier()
 
 #else
 
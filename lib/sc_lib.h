@@ -66,6 +66,14 @@
 #define SYMCRYPT_HmacXxxAppend          CONCAT3( SymCryptHmac, Alg, Append )
 #define SYMCRYPT_HmacXxxResult          CONCAT3( SymCryptHmac, Alg, Result )
 
+#define SYMCRYPT_ParallelXxxProcess     CONCAT3( SymCryptParallel, Alg, Process )
+#define SYMCRYPT_ParallelHmacXxx        CONCAT2( SymCryptParallelHmac, Alg )
+#define SYMCRYPT_ParallelXxxAppendLanes CONCAT3( SymCryptParallel, Alg, AppendLanes )
+
+#define SYMCRYPT_ParallelPbkdf2HmacXxx          CONCAT2( SymCryptParallelPbkdf2Hmac, Alg )
+#define SYMCRYPT_ParallelPbkdf2HmacXxxVerify    CONCAT3( SymCryptParallelPbkdf2Hmac, Alg, Verify )
+#define SYMCRYPT_ParallelPbkdf2HmacXxxInternal  CONCAT3( SymCryptParallelPbkdf2Hmac, Alg, Internal )
+
 
 #define SYMCRYPT_XXX_INPUT_BLOCK_SIZE   CONCAT3( SYMCRYPT_, ALG, _INPUT_BLOCK_SIZE )
 #define SYMCRYPT_XXX_RESULT_SIZE        CONCAT3( SYMCRYPT_, ALG, _RESULT_SIZE )
@@ -79,6 +87,15 @@
 #define PSYMCRYPT_HMAC_XXX_STATE            CONCAT3( PSYMCRYPT_HMAC_, ALG, _STATE )
 #define PCSYMCRYPT_HMAC_XXX_STATE            CONCAT3( PCSYMCRYPT_HMAC_, ALG, _STATE )
 
+#define PSYMCRYPT_XXX_STATE                             CONCAT3( PSYMCRYPT_, ALG, _STATE )
+#define SYMCRYPT_PARALLEL_XXX_FIXED_SCRATCH             CONCAT3( SYMCRYPT_PARALLEL_, ALG, _FIXED_SCRATCH )
+#define SYMCRYPT_PARALLEL_HMAC_XXX_FIXED_SCRATCH        CONCAT3( SYMCRYPT_PARALLEL_HMAC_, ALG, _FIXED_SCRATCH )
+#define SYMCRYPT_PARALLEL_HMAC_XXX_PER_OPERATION_SCRATCH CONCAT3( SYMCRYPT_PARALLEL_HMAC_, ALG, _PER_OPERATION_SCRATCH )
+#define PCSYMCRYPT_PARALLEL_HMAC_XXX_OPERATION          CONCAT3( PCSYMCRYPT_PARALLEL_HMAC_, ALG, _OPERATION )
+#define SYMCRYPT_PARALLEL_PBKDF2_HMAC_XXX_SCRATCH       CONCAT3( SYMCRYPT_PARALLEL_PBKDF2_HMAC_, ALG, _SCRATCH )
+#define SYMCRYPT_PARALLEL_PBKDF2_HMAC_XXX_FIXED_SCRATCH CONCAT3( SYMCRYPT_PARALLEL_PBKDF2_HMAC_, ALG, _FIXED_SCRATCH )
+#define SYMCRYPT_PARALLEL_PBKDF2_HMAC_XXX_PER_LANE_SCRATCH CONCAT3( SYMCRYPT_PARALLEL_PBKDF2_HMAC_, ALG, _PER_LANE_SCRATCH )
+
 
 //==============================================================================================
 //  PLATFORM SPECIFICS
@@ -465,6 +482,14 @@ SymCryptSha1AppendBlocks(
                             SIZE_T                          cbData,
     _Out_                   SIZE_T                        * pcbRemaining );
 
+VOID
+SYMCRYPT_CALL
+SymCryptSha1AppendBlocks_ul( 
+    _Inout_                 SYMCRYPT_SHA1_CHAINING_STATE  * pChain,
+    _In_reads_( cbData )    PCBYTE                          pbData,
+                            SIZE_T                          cbData,
+    _Out_                   SIZE_T                        * pcbRemaining );
+
 //
 // SymCryptSha256AppendBlocks
 //
@@ -686,6 +711,11 @@ XorByteIntoBuffer( _Inout_updates_( 8*cqBuf ) PBYTE pbBuf, SIZE_T cqBuf, BYTE v
 // GHASH
 //
 
+#define SYMCRYPT_CPU_FEATURES_FOR_PCLMULQDQ_CODE    (SYMCRYPT_CPU_FEATURE_PCLMULQDQ | SYMCRYPT_CPU_FEATURE_SSSE3 | SYMCRYPT_CPU_FEATURE_SAVEXMM_NOFAIL )
+
+// The 512-bit GHASH code uses AVX-512 registers but reads the same key table as the PCLMULQDQ code
+#define SYMCRYPT_CPU_FEATURES_FOR_VPCLMULQDQ_CODE   (SYMCRYPT_CPU_FEATURES_FOR_PCLMULQDQ_CODE | SYMCRYPT_CPU_FEATURE_VPCLMULQDQ | SYMCRYPT_CPU_FEATURE_AVX512 )
+
 VOID
 SYMCRYPT_CALL
 SymCryptGHashExpandKey(
@@ -758,6 +788,14 @@ SymCryptGHashAppendDataPclmulqdq(
     _In_reads_( cbData )                    PCBYTE                      pbData,
     _In_                                    SIZE_T                      cbData );
 
+VOID
+SYMCRYPT_CALL
+SymCryptGHashAppendDataVpclmulqdq(
+    _In_reads_( SYMCRYPT_GF128_FIELD_SIZE ) PCSYMCRYPT_GF128_ELEMENT    expandedKeyTable,
+    _Inout_                                 PSYMCRYPT_GF128_ELEMENT     pState,
+    _In_reads_( cbData )                    PCBYTE                      pbData,
+    _In_                                    SIZE_T                      cbData );
+
 
 VOID
 SYMCRYPT_CALL
@@ -765,6 +803,27 @@ SymCryptGHashResult(
     _In_                                        PCSYMCRYPT_GF128_ELEMENT    pState,
     _Out_writes_( SYMCRYPT_GF128_BLOCK_SIZE )   PBYTE                       pbResult );
 
+VOID
+SYMCRYPT_CALL
+SymCryptGf128Multiply(
+    _In_    PCSYMCRYPT_GF128_ELEMENT    pA,
+    _In_    PCSYMCRYPT_GF128_ELEMENT    pB,
+    _Out_   PSYMCRYPT_GF128_ELEMENT     pResult );
+//
+// Multiply two GF(2^128) elements in the GHASH state representation, in constant time.
+// Slow; for the occasional multiplication outside the GHASH bulk code.
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptGf128Power(
+    _In_    PCSYMCRYPT_GF128_ELEMENT    pBase,
+            UINT64                      n,
+    _Out_   PSYMCRYPT_GF128_ELEMENT     pResult );
+//
+// Compute pBase^n. The running time depends on n.
+//
+
 
 VOID
 SYMCRYPT_CALL
@@ -930,6 +989,34 @@ C_ASSERT( sizeof( SYMCRYPT_SHA512_STATE_EXPORT_BLOB ) == SYMCRYPT_SHA512_STATE_E
 // AES internal functions
 
 #define SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE (SYMCRYPT_CPU_FEATURE_SSSE3 | SYMCRYPT_CPU_FEATURE_AESNI)   // The SSSE3 implies SSE, SSE2, and SSE3
+#define SYMCRYPT_CPU_FEATURES_FOR_VAES_256_CODE (SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE | SYMCRYPT_CPU_FEATURE_AVX2 | SYMCRYPT_CPU_FEATURE_VAES)
+#define SYMCRYPT_CPU_FEATURES_FOR_VAES_512_CODE (SYMCRYPT_CPU_FEATURES_FOR_VAES_256_CODE | SYMCRYPT_CPU_FEATURE_AVX512)
+
+//
+// Minimum request sizes for which the wide VAES code is used.
+// Below these the cost of saving the YMM state and the XMM tail dominate.
+//
+#define SYMCRYPT_AES_VAES_256_MIN_BYTES     (16 * SYMCRYPT_AES_BLOCK_SIZE)
+#define SYMCRYPT_AES_VAES_512_MIN_BYTES     (32 * SYMCRYPT_AES_BLOCK_SIZE)
+
+#if SYMCRYPT_CPU_AMD64
+//
+// Bitsliced AES, used on AMD64 CPUs without AES-NI (see aes-bitslice.c).
+// It processes SYMCRYPT_AES_BITSLICE_BLOCKS blocks at a time and converts the round keys
+// on every call, so it is only used for requests of at least SYMCRYPT_AES_BITSLICE_MIN_BYTES.
+//
+#define SYMCRYPT_CPU_FEATURES_FOR_AES_BITSLICE_CODE     (SYMCRYPT_CPU_FEATURE_SSSE3)
+
+#define SYMCRYPT_AES_BITSLICE_BLOCKS        (8)
+#define SYMCRYPT_AES_BITSLICE_MIN_BYTES     (8 * SYMCRYPT_AES_BLOCK_SIZE)
+
+typedef struct _SYMCRYPT_AES_BITSLICE_KEY {
+    __m128i roundKey[15][8];        // Encryption round keys in bitsliced form
+    SIZE_T  nRounds;
+} SYMCRYPT_AES_BITSLICE_KEY, *PSYMCRYPT_AES_BITSLICE_KEY;
+typedef const SYMCRYPT_AES_BITSLICE_KEY * PCSYMCRYPT_AES_BITSLICE_KEY;
+#endif
+
 extern const SYMCRYPT_BLOCKCIPHER SymCryptAesBlockCipherNoOpt;
 
 VOID
@@ -964,6 +1051,32 @@ SymCryptAesCreateDecryptionRoundKey(
     _Out_writes_(16)    PBYTE   pDecryptionRoundKey,
                         BOOL    UseSimd );
 
+VOID
+SYMCRYPT_CALL
+SymCryptAesCreateDecryptionRoundKeys( _In_ PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey );
+    //
+    // Create the decryption round keys of an expanded key. The key is logically const;
+    // the decryption round keys are a cache that is filled in on first use.
+    // Several threads may call this at the same time for the same key: only one of them writes
+    // the round keys into the key, and all of them return once the round keys are published.
+    // This does not make concurrent use safe on CPUs other than x86/AMD64, where readers of
+    // lastDecRoundKey have no barrier; see SymCryptAesExpandKeyEncryptOnly.
+    //
+
+FORCEINLINE
+VOID
+SYMCRYPT_CALL
+SymCryptAesEnsureDecryptionRoundKeys( _In_ PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey )
+{
+    BYTE (*pLastDecRoundKey)[4][4] = *(BYTE (* const volatile *)[4][4]) &pExpandedKey->lastDecRoundKey;
+
+    // &RoundKey[0] means another thread is writing the decryption round keys
+    if( pLastDecRoundKey == NULL || pLastDecRoundKey == &pExpandedKey->RoundKey[0] )
+    {
+        SymCryptAesCreateDecryptionRoundKeys( pExpandedKey );
+    }
+}
+
 VOID
 SYMCRYPT_CALL
 SymCryptAesCreateDecryptionRoundKeyC( 
@@ -1100,6 +1213,29 @@ SymCryptAesCbcEncryptXmm(
     _Out_writes_( cbData )                  PBYTE                       pbDst,
                                             SIZE_T                      cbData );
 
+//
+// Encrypt cbData bytes of each of nLanes (1..8) independent CBC operations.
+// All lanes must have at least cbData bytes and keys with the same number of rounds.
+// The chaining values are updated, and the pbSrc/pbDst/cbData fields of each lane are advanced.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptParallelAesCbcEncryptXmm(
+    _Inout_updates_( nLanes )   PSYMCRYPT_PARALLEL_AES_CBC_OPERATION    pLanes,
+                                SIZE_T                                  nLanes,
+                                SIZE_T                                  cbData );
+
+//
+// Same as SymCryptParallelAesCbcEncryptXmm, but only computes the CBC-MAC of each lane.
+// The pbDst fields of the lanes are not used.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptParallelAesCbcMacXmm(
+    _Inout_updates_( nLanes )   PSYMCRYPT_PARALLEL_AES_CBC_OPERATION    pLanes,
+                                SIZE_T                                  nLanes,
+                                SIZE_T                                  cbData );
+
 VOID
 SYMCRYPT_CALL
 SymCryptAesCbcEncryptNeon( 
@@ -1170,6 +1306,26 @@ SymCryptAesCbcMacNeon(
     _In_reads_( cbData )                        PCBYTE                      pbData,
                                                 SIZE_T                      cbData );
 
+VOID
+SYMCRYPT_CALL
+SymCryptAesCfbEncryptXmm(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+                                                SIZE_T                      cbShift,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCfbDecryptXmm(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+                                                SIZE_T                      cbShift,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData );
+
 VOID
 SYMCRYPT_CALL
 SymCryptAesCtrMsb64Asm( 
@@ -1183,7 +1339,151 @@ VOID
 SYMCRYPT_CALL
 SymCryptAesCtrMsb64Xmm( 
     _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
-    _In_reads_( SYMCRYPT_AES_BLOCK_SIZE )   PBYTE                       pbChainingValue,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData );
+
+#if SYMCRYPT_CPU_AMD64
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceExpandKey(
+    _In_    PCSYMCRYPT_AES_EXPANDED_KEY     pExpandedKey,
+    _Out_   PSYMCRYPT_AES_BITSLICE_KEY      pBitsliceKey );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceEcbEncrypt(
+    _In_                    PCSYMCRYPT_AES_BITSLICE_KEY pBitsliceKey,
+    _In_reads_( cbData )    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )  PBYTE                       pbDst,
+                            SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesBitsliceEcbDecrypt(
+    _In_                    PCSYMCRYPT_AES_BITSLICE_KEY pBitsliceKey,
+    _In_reads_( cbData )    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )  PBYTE                       pbDst,
+                            SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesEcbEncryptBitslice(
+    _In_                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _In_reads_( cbData )    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )  PBYTE                       pbDst,
+                            SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCbcDecryptBitslice(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb64Bitslice(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb32Bitslice(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData );
+#endif
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb32Xmm( 
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData );
+
+//
+// VAES implementations, AMD64 only.
+// Callers must have saved the YMM state (SymCryptSaveYmm).
+// The Ymm functions use 256-bit registers; the Zmm functions use 512-bit registers.
+// Each function processes requests of any whole number of blocks.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptAesEcbEncryptYmm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesEcbEncryptZmm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCbcDecryptYmm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCbcDecryptZmm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb64Ymm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb64Zmm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb32Ymm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb32Zmm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
     _In_reads_( cbData )                    PCBYTE                      pbSrc,
     _Out_writes_( cbData )                  PBYTE                       pbDst,
                                             SIZE_T                      cbData );
@@ -1192,7 +1492,16 @@ VOID
 SYMCRYPT_CALL
 SymCryptAesCtrMsb64Neon( 
     _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
-    _In_reads_( SYMCRYPT_AES_BLOCK_SIZE )   PBYTE                       pbChainingValue,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCtrMsb32Neon( 
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
     _In_reads_( cbData )                    PCBYTE                      pbSrc,
     _Out_writes_( cbData )                  PBYTE                       pbDst,
                                             SIZE_T                      cbData );
@@ -1206,6 +1515,153 @@ SymCryptAesCtrMsb64SaveXmm(
     _Out_writes_( cbData )                  PBYTE                       pbDst,
                                             SIZE_T                      cbData );
 
+//
+// AES-GCM bulk data functions.
+// These are the gcmEncryptPartFunc/gcmDecryptPartFunc of the AES block cipher descriptor.
+// They are only called on whole blocks when the GCM state is at a block boundary
+// (no partial key stream block and no partial MAC block). They update the
+// counter block and the GHASH state; the caller updates the data length.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptAesGcmEncryptPart(
+    _Inout_                 PVOID   pState,
+    _In_reads_( cbData )    PCBYTE  pbSrc,
+    _Out_writes_( cbData )  PBYTE   pbDst,
+                            SIZE_T  cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesGcmDecryptPart(
+    _Inout_                 PVOID   pState,
+    _In_reads_( cbData )    PCBYTE  pbSrc,
+    _Out_writes_( cbData )  PBYTE   pbDst,
+                            SIZE_T  cbData );
+
+//
+// AES-CCM bulk data functions.
+// These are the ccmEncryptPartFunc/ccmDecryptPartFunc of the AES block cipher descriptor.
+// They are only called on whole blocks when the CCM state is at a block boundary
+// (no partial key stream block and no partial MAC block). They update the
+// counter block and the MAC block; the caller updates bytesProcessed.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptAesCcmEncryptPart(
+    _Inout_                 PVOID   pState,
+    _In_reads_( cbData )    PCBYTE  pbSrc,
+    _Out_writes_( cbData )  PBYTE   pbDst,
+                            SIZE_T  cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCcmDecryptPart(
+    _Inout_                 PVOID   pState,
+    _In_reads_( cbData )    PCBYTE  pbSrc,
+    _Out_writes_( cbData )  PBYTE   pbDst,
+                            SIZE_T  cbData );
+
+//
+// Stitched AES-CTR + CBC-MAC implementations for CCM.
+// These use the 64-bit counter increment.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptAesCcmEncryptStitchedXmm(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbMacBlock,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesCcmDecryptStitchedXmm(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbChainingValue,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                       pbMacBlock,
+    _In_reads_( cbData )                        PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                      PBYTE                       pbDst,
+                                                SIZE_T                      cbData );
+
+//
+// Stitched AES-CTR + GHASH implementations.
+// These use the 32-bit counter increment of GCM.
+// The GHASH expanded key table must be in the PCLMULQDQ format.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptAesGcmEncryptStitchedXmm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( SYMCRYPT_GF128_FIELD_SIZE ) PCSYMCRYPT_GF128_ELEMENT    expandedKeyTable,
+    _Inout_                                 PSYMCRYPT_GF128_ELEMENT     pState,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData );
+
+VOID
+SYMCRYPT_CALL
+SymCryptAesGcmDecryptStitchedXmm(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+    _Inout_updates_( SYMCRYPT_AES_BLOCK_SIZE )  PBYTE                   pbChainingValue,
+    _In_reads_( SYMCRYPT_GF128_FIELD_SIZE ) PCSYMCRYPT_GF128_ELEMENT    expandedKeyTable,
+    _Inout_                                 PSYMCRYPT_GF128_ELEMENT     pState,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData );
+
+//
+// 3DES CBC decryption that processes several blocks at once; the cbcDecryptFunc of
+// SymCrypt3DesBlockCipher. See 3des.c
+//
+VOID
+SYMCRYPT_CALL
+SymCrypt3DesCbcDecryptMultiBlock(
+    _In_                                        PCSYMCRYPT_3DES_EXPANDED_KEY    pExpandedKey,
+    _Inout_updates_( SYMCRYPT_3DES_BLOCK_SIZE ) PBYTE                           pbChainingValue,
+    _In_reads_( cbData )                        PCBYTE                          pbSrc,
+    _Out_writes_( cbData )                      PBYTE                           pbDst,
+                                                SIZE_T                          cbData );
+
+//
+// Scatter/gather helpers for the iovec versions of the cipher modes, see iovec.c
+//
+#define SYMCRYPT_IOVEC_MAX_BLOCK_SIZE   (64)        // ChaCha20 block size
+#define SYMCRYPT_IOVEC_BUFFER_SIZE      (256)       // gather buffer, multiple of SYMCRYPT_IOVEC_MAX_BLOCK_SIZE
+
+typedef VOID (SYMCRYPT_CALL * PSYMCRYPT_IOVEC_CRYPT_FUNC)( PVOID pContext, PCBYTE pbSrc, PBYTE pbDst, SIZE_T cbData );
+
+SIZE_T
+SYMCRYPT_CALL
+SymCryptIovecLength(
+    _In_reads_( nFragments )    PCSYMCRYPT_IOVEC    pFragments,
+                                SIZE_T              nFragments );
+
+VOID
+SYMCRYPT_CALL
+SymCryptIovecWipe(
+    _In_reads_( nFragments )    PCSYMCRYPT_IOVEC    pFragments,
+                                SIZE_T              nFragments );
+
+VOID
+SYMCRYPT_CALL
+SymCryptIovecCrypt(
+    _In_reads_( nSrc )          PCSYMCRYPT_IOVEC            pSrc,
+                                SIZE_T                      nSrc,
+    _In_reads_( nDst )          PCSYMCRYPT_IOVEC            pDst,
+                                SIZE_T                      nDst,
+                                SIZE_T                      cbBlock,
+    _In_                        PSYMCRYPT_IOVEC_CRYPT_FUNC  pfnCrypt,
+    _Inout_                     PVOID                       pContext );
+//
+// Process the data in the pSrc fragments into the pDst fragments by calling pfnCrypt( pContext, pbSrc, pbDst, cbData ).
+// The source and destination lists must have the same total length, but can be fragmented differently.
+// cbBlock is a power of 2 and at most SYMCRYPT_IOVEC_MAX_BLOCK_SIZE. Each call to pfnCrypt processes
+// a multiple of cbBlock bytes, except the last call which processes the remainder of the data.
+//
+
 VOID
 SYMCRYPT_CALL
 SymCryptXtsAesEncryptDataUnitC(
@@ -1278,6 +1734,22 @@ SymCryptXtsAesDecryptDataUnitNeon(
     _Out_writes_( cbData )                  PBYTE                       pbDst,
                                             SIZE_T                      cbData );
 
+VOID
+SYMCRYPT_CALL
+SymCryptXtsAesEncrypt8DataUnitsXmm(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY     pExpandedKey,
+    _In_reads_( 8 * SYMCRYPT_AES_BLOCK_SIZE )   PCBYTE                          pbTweakBlocks,
+    _In_reads_( 8 )                             PCSYMCRYPT_XTS_AES_DATA_UNIT    pDataUnits,
+                                                SIZE_T                          cbDataUnit );
+
+VOID
+SYMCRYPT_CALL
+SymCryptXtsAesDecrypt8DataUnitsXmm(
+    _In_                                        PCSYMCRYPT_AES_EXPANDED_KEY     pExpandedKey,
+    _In_reads_( 8 * SYMCRYPT_AES_BLOCK_SIZE )   PCBYTE                          pbTweakBlocks,
+    _In_reads_( 8 )                             PCSYMCRYPT_XTS_AES_DATA_UNIT    pDataUnits,
+                                                SIZE_T                          cbDataUnit );
+
 PSYMCRYPT_BLOCKCIPHER_CRYPT_XTS
 SYMCRYPT_CALL
 SymCryptXtsAesGetBlockEncFunc();
@@ -1328,6 +1800,59 @@ SymCryptParallelHashProcess(
     _Out_writes_( cbScratch )                                       PBYTE                               pbScratch,
                                                                     SIZE_T                              cbScratch,
                                                                     UINT32                              maxParallel );
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelHashAppendLanes(
+    _In_                            PCSYMCRYPT_PARALLEL_HASH                pParHash,
+    _Inout_updates_( nWork )        PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+                                    SIZE_T                                  nWork,
+                                    SIZE_T                                  nBytes,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch,
+                                    UINT32                                  maxParallel );
+
+//
+// SymCryptParallelXxxAppendLanes
+// Process nBytes of pre-padded data on each of nWork scratch states with the fastest parallel code
+// available on this CPU. The hashState fields point to hash states of the corresponding type.
+// cbScratch must be at least SYMCRYPT_PARALLEL_XXX_FIXED_SCRATCH.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1AppendLanes(
+    _Inout_updates_( nWork )        PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+                                    SIZE_T                                  nWork,
+                                    SIZE_T                                  nBytes,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch );
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha256AppendLanes(
+    _Inout_updates_( nWork )        PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+                                    SIZE_T                                  nWork,
+                                    SIZE_T                                  nBytes,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch );
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha512AppendLanes(
+    _Inout_updates_( nWork )        PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+                                    SIZE_T                                  nWork,
+                                    SIZE_T                                  nBytes,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch );
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelMd5AppendLanes(
+    _Inout_updates_( nWork )        PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+                                    SIZE_T                                  nWork,
+                                    SIZE_T                                  nBytes,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch );
                                                                     
 VOID
 SYMCRYPT_CALL
@@ -1347,11 +1872,15 @@ SymCryptHashCommonPaddingMd4Style(
 extern const PCSYMCRYPT_PARALLEL_HASH SymCryptParallelSha256Algorithm;
 extern const PCSYMCRYPT_PARALLEL_HASH SymCryptParallelSha384Algorithm;
 extern const PCSYMCRYPT_PARALLEL_HASH SymCryptParallelSha512Algorithm;
+extern const PCSYMCRYPT_PARALLEL_HASH SymCryptParallelSha1Algorithm;
+extern const PCSYMCRYPT_PARALLEL_HASH SymCryptParallelMd5Algorithm;
 
 
 extern const SYMCRYPT_HASH SymCryptSha256Algorithm_default;
 extern const SYMCRYPT_HASH SymCryptSha384Algorithm_default;
 extern const SYMCRYPT_HASH SymCryptSha512Algorithm_default;
+extern const SYMCRYPT_HASH SymCryptSha1Algorithm_default;
+extern const SYMCRYPT_HASH SymCryptMd5Algorithm_default;
 
 VOID
 SYMCRYPT_CALL
@@ -1360,6 +1889,8 @@ SymCryptFatalIntercept( UINT32 fatalCode );
 extern const BYTE SymCryptSha256KATAnswer[32];
 extern const BYTE SymCryptSha384KATAnswer[48];
 extern const BYTE SymCryptSha512KATAnswer[64];
+extern const BYTE SymCryptSha1KATAnswer[20];
+extern const BYTE SymCryptMd5KATAnswer[16];
 
 #define SYMCRYPT_CPU_FEATURES_FOR_SHANI_CODE (SYMCRYPT_CPU_FEATURE_SSSE3 | SYMCRYPT_CPU_FEATURE_SHANI)   // The SSSE3 implies SSE, SSE2, and SSE3
 
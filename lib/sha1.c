@@ -226,7 +226,7 @@ SymCryptSha1Result(
 
 VOID
 SYMCRYPT_CALL
-SymCryptSha1AppendBlocks( 
+SymCryptSha1AppendBlocks_ul( 
     _Inout_                 SYMCRYPT_SHA1_CHAINING_STATE *  pChain,
     _In_reads_( cbData )    PCBYTE                          pbData,
                             SIZE_T                          cbData,
@@ -364,6 +364,189 @@ SymCryptSha1AppendBlocks(
     SYMCRYPT_FORCE_WRITE32( &Wt, 0 );
 }
 
+#undef MAJ
+#undef CH
+#undef PARITY
+#undef CROUND
+#undef IROUND
+#undef FROUND
+
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+
+//
+// SHA-1 using the SHA instruction set extension.
+//
+// The state is kept as ABCD in one register (A in the most significant word) and E in the
+// most significant word of a second register.
+// _mm_sha1rnds4_epu32 performs 4 rounds; its immediate selects the round function and constant.
+// _mm_sha1nexte_epu32 computes the E value for the next 4 rounds (ROL(A,30) of the state four
+// rounds back) and adds it to the next 4 message words.
+// The message schedule W_t = ROL( W_(t-3) ^ W_(t-8) ^ W_(t-14) ^ W_(t-16), 1 ) is computed
+// 4 words at a time by _mm_sha1msg1_epu32 (W_(t-16) ^ W_(t-14)), an xor with W_(t-8),
+// and _mm_sha1msg2_epu32 (the W_(t-3) term and the rotation).
+//
+// Four rounds t..t+3 (t = 4*i) with the message words M0 = W_(t..t+3).
+// At the same time we advance the schedule: M1 receives its final msg2 step, M3 its msg1 step,
+// and M2 the W_(t-8) term.
+// Ecur holds E for these rounds, Enext receives the state for the E of the next 4 rounds.
+//
+#define SHANI_ROUNDS4( Ecur, Enext, M0, M1, M2, M3, f ) \
+    Ecur  = _mm_sha1nexte_epu32( Ecur, M0 );        \
+    Enext = ABCD;                                   \
+    M1 = _mm_sha1msg2_epu32( M1, M0 );              \
+    ABCD = _mm_sha1rnds4_epu32( ABCD, Ecur, f );    \
+    M3 = _mm_sha1msg1_epu32( M3, M0 );              \
+    M2 = _mm_xor_si128( M2, M0 );
+
+VOID
+SYMCRYPT_CALL
+SymCryptSha1AppendBlocks_shani( 
+    _Inout_                 SYMCRYPT_SHA1_CHAINING_STATE *  pChain,
+    _In_reads_( cbData )    PCBYTE                          pbData,
+                            SIZE_T                          cbData,
+    _Out_                   SIZE_T                        * pcbRemaining )
+{
+    const __m128i BYTE_REVERSE_128 = _mm_set_epi8( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
+    __m128i ABCD;
+    __m128i ABCD_start;
+    __m128i E0;
+    __m128i E0_start;
+    __m128i E1;
+    __m128i MSG0;
+    __m128i MSG1;
+    __m128i MSG2;
+    __m128i MSG3;
+
+    ABCD = _mm_loadu_si128( (__m128i *)&pChain->H[0] );             // (D, C, B, A)
+    ABCD = _mm_shuffle_epi32( ABCD, 0x1b );                         // (A, B, C, D)
+    E0 = _mm_set_epi32( pChain->H[4], 0, 0, 0 );                    // (E, 0, 0, 0)
+
+    while( cbData >= 64 )
+    {
+        ABCD_start = ABCD;
+        E0_start = E0;
+
+        // The byte reversal of the whole register also puts W_t in the most significant word
+        MSG0 = _mm_shuffle_epi8( _mm_loadu_si128( (__m128i *)&pbData[ 0] ), BYTE_REVERSE_128 );
+        MSG1 = _mm_shuffle_epi8( _mm_loadu_si128( (__m128i *)&pbData[16] ), BYTE_REVERSE_128 );
+        MSG2 = _mm_shuffle_epi8( _mm_loadu_si128( (__m128i *)&pbData[32] ), BYTE_REVERSE_128 );
+        MSG3 = _mm_shuffle_epi8( _mm_loadu_si128( (__m128i *)&pbData[48] ), BYTE_REVERSE_128 );
+
+        // Rounds 0-3
+        E0 = _mm_add_epi32( E0, MSG0 );
+        E1 = ABCD;
+        ABCD = _mm_sha1rnds4_epu32( ABCD, E0, 0 );
+
+        // Rounds 4-7
+        E1 = _mm_sha1nexte_epu32( E1, MSG1 );
+        E0 = ABCD;
+        ABCD = _mm_sha1rnds4_epu32( ABCD, E1, 0 );
+        MSG0 = _mm_sha1msg1_epu32( MSG0, MSG1 );
+
+        // Rounds 8-11
+        E0 = _mm_sha1nexte_epu32( E0, MSG2 );
+        E1 = ABCD;
+        ABCD = _mm_sha1rnds4_epu32( ABCD, E0, 0 );
+        MSG1 = _mm_sha1msg1_epu32( MSG1, MSG2 );
+        MSG0 = _mm_xor_si128( MSG0, MSG2 );
+
+        // Rounds 12-67
+        SHANI_ROUNDS4( E1, E0, MSG3, MSG0, MSG1, MSG2, 0 );
+        SHANI_ROUNDS4( E0, E1, MSG0, MSG1, MSG2, MSG3, 0 );
+        SHANI_ROUNDS4( E1, E0, MSG1, MSG2, MSG3, MSG0, 1 );
+        SHANI_ROUNDS4( E0, E1, MSG2, MSG3, MSG0, MSG1, 1 );
+        SHANI_ROUNDS4( E1, E0, MSG3, MSG0, MSG1, MSG2, 1 );
+        SHANI_ROUNDS4( E0, E1, MSG0, MSG1, MSG2, MSG3, 1 );
+        SHANI_ROUNDS4( E1, E0, MSG1, MSG2, MSG3, MSG0, 1 );
+        SHANI_ROUNDS4( E0, E1, MSG2, MSG3, MSG0, MSG1, 2 );
+        SHANI_ROUNDS4( E1, E0, MSG3, MSG0, MSG1, MSG2, 2 );
+        SHANI_ROUNDS4( E0, E1, MSG0, MSG1, MSG2, MSG3, 2 );
+        SHANI_ROUNDS4( E1, E0, MSG1, MSG2, MSG3, MSG0, 2 );
+        SHANI_ROUNDS4( E0, E1, MSG2, MSG3, MSG0, MSG1, 2 );
+        SHANI_ROUNDS4( E1, E0, MSG3, MSG0, MSG1, MSG2, 3 );
+        SHANI_ROUNDS4( E0, E1, MSG0, MSG1, MSG2, MSG3, 3 );
+
+        // Rounds 68-71
+        E1 = _mm_sha1nexte_epu32( E1, MSG1 );
+        E0 = ABCD;
+        MSG2 = _mm_sha1msg2_epu32( MSG2, MSG1 );
+        ABCD = _mm_sha1rnds4_epu32( ABCD, E1, 3 );
+        MSG3 = _mm_xor_si128( MSG3, MSG1 );
+
+        // Rounds 72-75
+        E0 = _mm_sha1nexte_epu32( E0, MSG2 );
+        E1 = ABCD;
+        MSG3 = _mm_sha1msg2_epu32( MSG3, MSG2 );
+        ABCD = _mm_sha1rnds4_epu32( ABCD, E0, 3 );
+
+        // Rounds 76-79
+        E1 = _mm_sha1nexte_epu32( E1, MSG3 );
+        E0 = ABCD;
+        ABCD = _mm_sha1rnds4_epu32( ABCD, E1, 3 );
+
+        // Feed-forward
+        E0 = _mm_sha1nexte_epu32( E0, E0_start );
+        ABCD = _mm_add_epi32( ABCD, ABCD_start );
+
+        pbData += 64;
+        cbData -= 64;
+    }
+
+    ABCD = _mm_shuffle_epi32( ABCD, 0x1b );
+    _mm_storeu_si128( (__m128i *)&pChain->H[0], ABCD );
+    pChain->H[4] = _mm_cvtsi128_si32( _mm_srli_si128( E0, 12 ) );
+
+    *pcbRemaining = cbData;
+
+    //
+    // Wipe the variables
+    //
+    SymCryptWipeKnownSize( &ABCD, sizeof( ABCD ) );
+    SymCryptWipeKnownSize( &ABCD_start, sizeof( ABCD_start ) );
+    SymCryptWipeKnownSize( &E0, sizeof( E0 ) );
+    SymCryptWipeKnownSize( &E0_start, sizeof( E0_start ) );
+    SymCryptWipeKnownSize( &E1, sizeof( E1 ) );
+    SymCryptWipeKnownSize( &MSG0, sizeof( MSG0 ) );
+    SymCryptWipeKnownSize( &MSG1, sizeof( MSG1 ) );
+    SymCryptWipeKnownSize( &MSG2, sizeof( MSG2 ) );
+    SymCryptWipeKnownSize( &MSG3, sizeof( MSG3 ) );
+}
+
+#undef SHANI_ROUNDS4
+
+#endif  // SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+
+VOID
+SYMCRYPT_CALL
+SymCryptSha1AppendBlocks( 
+    _Inout_                 SYMCRYPT_SHA1_CHAINING_STATE *  pChain,
+    _In_reads_( cbData )    PCBYTE                          pbData,
+                            SIZE_T                          cbData,
+    _Out_                   SIZE_T                        * pcbRemaining )
+{
+#if SYMCRYPT_CPU_AMD64
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_SHANI_CODE ) )
+    {
+        SymCryptSha1AppendBlocks_shani( pChain, pbData, cbData, pcbRemaining );
+    } else {
+        SymCryptSha1AppendBlocks_ul( pChain, pbData, cbData, pcbRemaining );
+    }
+#elif SYMCRYPT_CPU_X86
+    SYMCRYPT_EXTENDED_SAVE_DATA  SaveData;
+
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_SHANI_CODE | SYMCRYPT_CPU_FEATURE_SAVEXMM_NOFAIL ) &&
+        SymCryptSaveXmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptSha1AppendBlocks_shani( pChain, pbData, cbData, pcbRemaining );
+        SymCryptRestoreXmm( &SaveData );
+    } else {
+        SymCryptSha1AppendBlocks_ul( pChain, pbData, cbData, pcbRemaining );
+    }
+#else
+    SymCryptSha1AppendBlocks_ul( pChain, pbData, cbData, pcbRemaining );
+#endif
+}
+
 
 VOID
 SYMCRYPT_CALL
@@ -448,7 +631,7 @@ cleanup:
 // Simple test vector for FIPS module testing
 //
 
-static const BYTE sha1KATAnswer[ 20 ] = {
+const BYTE SymCryptSha1KATAnswer[ 20 ] = {
     0xa9, 0x99, 0x3e, 0x36,
     0x47, 0x06, 0x81, 0x6a,
     0xba, 0x3e, 0x25, 0x71,
@@ -466,7 +649,7 @@ SymCryptSha1Selftest()
 
     SymCryptInjectError( result, sizeof( result ) );
     
-    if( memcmp( result, sha1KATAnswer, sizeof( result ) ) != 0 ) {
+    if( memcmp( result, SymCryptSha1KATAnswer, sizeof( result ) ) != 0 ) {
         SymCryptFatal( 'SHA1' );
     }
 }
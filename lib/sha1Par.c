@@ -0,0 +1,788 @@
+//
+// Sha1Par.c
+//
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+
+//
+// This module contains the routines to implement SHA-1 from FIPS 180-2 in parallel mode
+//
+
+#include "precomp.h"
+
+#define PAR_SCRATCH_ELEMENTS    (5+80)          // # scratch elements our parallel impementations need
+
+
+//
+// Not all CPU architectures support parallel code.
+//
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+
+#define SUPPORT_PARALLEL 1
+#define MIN_PARALLEL    2
+#define MAX_PARALLEL    8
+
+#else
+
+#define SUPPORT_PARALLEL 0
+
+#endif
+
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1AppendBytes_serial( 
+    _Inout_updates_( nPar )                 PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+    _In_range_(1, MAX_PARALLEL)             SIZE_T                                  nPar,
+                                            SIZE_T                                  nBytes );
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1Init(
+    _Out_writes_( nStates ) PSYMCRYPT_SHA1_STATE pStates,
+                            SIZE_T               nStates )
+{
+    SIZE_T i;
+
+    for( i=0; i<nStates; i++ )
+    {
+        SymCryptSha1Init( &pStates[i] );
+    }
+}
+
+#if !SUPPORT_PARALLEL
+//
+// No parallel support on this CPU
+//
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1Process(
+    _Inout_updates_( nStates )      PSYMCRYPT_SHA1_STATE                pStates,
+                                    SIZE_T                              nStates,
+    _Inout_updates_( nOperations )  PSYMCRYPT_PARALLEL_HASH_OPERATION   pOperations,
+                                    SIZE_T                              nOperations,
+    _Out_writes_( cbScratch )       PBYTE                               pbScratch,
+                                    SIZE_T                              cbScratch )
+{
+    SymCryptParallelHashProcess_serial( SymCryptParallelSha1Algorithm, pStates, nStates, pOperations, nOperations, pbScratch, cbScratch );
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1AppendLanes(
+    _Inout_updates_( nWork )        PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+                                    SIZE_T                                  nWork,
+                                    SIZE_T                                  nBytes,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch )
+{
+    SymCryptParallelHashAppendLanes( SymCryptParallelSha1Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 1 );
+}
+#endif
+
+
+#if SUPPORT_PARALLEL
+
+//
+// This function looks at a state and decides what to do.
+// If it returns FALSE, then this state is done and no further processing is required.
+// If it returns TRUE, the pbData/cbData have to be processed in parallel.
+// This function is called again on the same state after the pbData/cbData have been processed.
+//
+
+BOOLEAN
+SYMCRYPT_CALL
+SymCryptParallelSha1Result1(
+    _In_    PCSYMCRYPT_PARALLEL_HASH pParHash, 
+    _Inout_ PSYMCRYPT_COMMON_HASH_STATE pState, 
+    _Inout_ PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE pScratch,    
+    _Out_   BOOLEAN *pRes)
+{
+    UINT32 bytesInBuffer = pState->bytesInBuffer;
+
+    UNREFERENCED_PARAMETER( pParHash );
+    //
+    // Function is called when a Result is requested from a parallel hashs state.
+    // Do the first step of the padding.
+    //
+    pState->buffer[bytesInBuffer++] = 0x80;
+    SymCryptWipe( &pState->buffer[bytesInBuffer], SYMCRYPT_SHA1_INPUT_BLOCK_SIZE - bytesInBuffer );
+
+    pScratch->pbData = &pState->buffer[0];
+    pScratch->cbData = SYMCRYPT_SHA1_INPUT_BLOCK_SIZE;
+
+    if( bytesInBuffer > SYMCRYPT_SHA1_INPUT_BLOCK_SIZE - 8 )
+    {
+        // We need 2 blocks for the padding
+        pScratch->processingState = STATE_RESULT2;
+    } else {
+        SYMCRYPT_STORE_MSBFIRST64( &pState->buffer[SYMCRYPT_SHA1_INPUT_BLOCK_SIZE - 8], pState->dataLengthL * 8 );
+        pScratch->processingState = STATE_RESULT_DONE;
+    }
+
+    *pRes = TRUE;        // return value from the SetWork function
+    return TRUE;        // Return from the SetWork function
+}
+
+
+BOOLEAN
+SYMCRYPT_CALL
+SymCryptParallelSha1Result2(
+    _In_    PCSYMCRYPT_PARALLEL_HASH                pParHash, 
+    _Inout_ PSYMCRYPT_COMMON_HASH_STATE             pState, 
+    _Inout_ PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE   pScratch,    
+    _Out_   BOOLEAN *pRes)
+{
+    UNREFERENCED_PARAMETER( pParHash );
+    //
+    // Called for the 2nd block of a long padding
+    //
+    SymCryptWipe( &pState->buffer[0], SYMCRYPT_SHA1_INPUT_BLOCK_SIZE );
+    SYMCRYPT_STORE_MSBFIRST64( &pState->buffer[SYMCRYPT_SHA1_INPUT_BLOCK_SIZE - 8], pState->dataLengthL * 8 );
+    pScratch->pbData = &pState->buffer[0];
+    pScratch->cbData = SYMCRYPT_SHA1_INPUT_BLOCK_SIZE;
+    pScratch->processingState = STATE_RESULT_DONE;
+    *pRes = TRUE;
+    return TRUE;
+}
+
+VOID 
+SYMCRYPT_CALL 
+SymCryptParallelSha1ResultDone(
+    _In_    PCSYMCRYPT_PARALLEL_HASH            pParHash, 
+    _Inout_ PSYMCRYPT_COMMON_HASH_STATE         pState, 
+    _In_    PCSYMRYPT_PARALLEL_HASH_OPERATION   pOp)
+{
+    PSYMCRYPT_SHA1_STATE  pSha1State = (PSYMCRYPT_SHA1_STATE) pState;
+
+    UNREFERENCED_PARAMETER( pParHash );
+
+    SYMCRYPT_ASSERT( pOp->hashOperation == SYMCRYPT_HASH_OPERATION_RESULT );
+    SYMCRYPT_ASSERT( pOp->cbBuffer == SYMCRYPT_SHA1_RESULT_SIZE );
+
+    SymCryptUint32ToMsbFirst( &pSha1State->chain.H[0], pOp->pbBuffer, 5 );
+    SymCryptWipeKnownSize( pSha1State, sizeof( *pSha1State ));
+    SymCryptSha1Init( pSha1State );
+}
+
+C_ASSERT( (SYMCRYPT_SIMD_ELEMENT_SIZE & (SYMCRYPT_SIMD_ELEMENT_SIZE - 1 )) == 0 );  // check that it is a power of 2
+
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1Process(
+    _Inout_updates_( nStates )      PSYMCRYPT_SHA1_STATE                pStates,
+                                    SIZE_T                              nStates,
+    _Inout_updates_( nOperations )  PSYMCRYPT_PARALLEL_HASH_OPERATION   pOperations,
+                                    SIZE_T                              nOperations,
+    _Out_writes_( cbScratch )       PBYTE                               pbScratch,
+                                    SIZE_T                              cbScratch )
+{
+    UINT32 maxParallel;
+    SYMCRYPT_EXTENDED_SAVE_DATA SaveState;
+
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 ) && SymCryptSaveYmm( &SaveState ) == SYMCRYPT_NO_ERROR )
+    {
+        maxParallel = 8;
+
+        SymCryptParallelHashProcess(    SymCryptParallelSha1Algorithm,
+                                        pStates,
+                                        nStates,
+                                        pOperations,
+                                        nOperations,
+                                        pbScratch,
+                                        cbScratch,
+                                        maxParallel );
+
+        SymCryptRestoreYmm( &SaveState );
+    } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_SSE2 ) && 
+               !SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_SHANI_CODE ) &&
+               SymCryptSaveXmm( &SaveState ) == SYMCRYPT_NO_ERROR )
+    {
+        //
+        // The 4-lane SSE2 code is slower than the SHA-NI single-stream code, so we only use it
+        // on CPUs that do not have the SHA instructions.
+        //
+        maxParallel = 4;
+        SymCryptParallelHashProcess(    SymCryptParallelSha1Algorithm,
+                                        pStates,
+                                        nStates,
+                                        pOperations,
+                                        nOperations,
+                                        pbScratch,
+                                        cbScratch,
+                                        maxParallel );
+        SymCryptRestoreXmm( &SaveState );
+    } else {
+        SymCryptParallelHashProcess_serial( SymCryptParallelSha1Algorithm, pStates, nStates, pOperations, nOperations, pbScratch, cbScratch );
+    }
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1AppendLanes(
+    _Inout_updates_( nWork )        PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+                                    SIZE_T                                  nWork,
+                                    SIZE_T                                  nBytes,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch )
+{
+    SYMCRYPT_EXTENDED_SAVE_DATA SaveState;
+
+    //
+    // Same CPU feature selection as SymCryptParallelSha1Process
+    //
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 ) && SymCryptSaveYmm( &SaveState ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptParallelHashAppendLanes( SymCryptParallelSha1Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 8 );
+        SymCryptRestoreYmm( &SaveState );
+    } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_SSE2 ) &&
+               !SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_SHANI_CODE ) &&
+               SymCryptSaveXmm( &SaveState ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptParallelHashAppendLanes( SymCryptParallelSha1Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 4 );
+        SymCryptRestoreXmm( &SaveState );
+    } else {
+        SymCryptParallelHashAppendLanes( SymCryptParallelSha1Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 1 );
+    }
+}
+
+
+//
+// Code that uses the XMM registers.
+// The XMM code uses only SSE2; the byte reversal is done with 16-bit shifts and shuffles
+// rather than the SSSE3 PSHUFB instruction.
+//
+
+#define CHXMM( x, y, z )        _mm_xor_si128( _mm_and_si128( _mm_xor_si128( z, y ), x ), z )
+#define PARITYXMM( x, y, z )    _mm_xor_si128( _mm_xor_si128( x, y ), z )
+#define MAJXMM( x, y, z )       _mm_or_si128( _mm_and_si128( _mm_or_si128( z, y ), x ), _mm_and_si128( z, y ))
+
+#define ROL32XMM( x, n ) _mm_or_si128( _mm_slli_epi32( x, n ), _mm_srli_epi32( x, 32 - (n) ) )
+
+#define BYTE_REVERSE_32_SSE2( x ) \
+    _mm_shufflehi_epi16( _mm_shufflelo_epi16( _mm_or_si128( _mm_slli_epi16( x, 8 ), _mm_srli_epi16( x, 8 ) ), 0xb1 ), 0xb1 )
+
+//
+// Transpose macro, convert S0..S3 into R0..R3; R0 is the lane 0, R3 is lane 3.
+// S0 = S00, S01, S02, S03; S1 = S10, S11, S12, S13; S2 = S20, S21, S22, S23; S3 = S30, S31, S32, S33
+// T0 = S00, S10, S01, S11; T1 = S02, S12, S03, S13; T2 = S20, S30, S21, S31; T3 = S22, S32, S23, S33
+// R0 = S00, S10, S20, S30; R1 = S01, S11, S21, S31; R2 = S02, S12, S22, S32; R3 = S03, S13, S23, S33
+//
+#define XMM_TRANSPOSE_32( _R0, _R1, _R2, _R3, _S0, _S1, _S2, _S3 ) \
+    {\
+        __m128i _T0, _T1, _T2, _T3;\
+        _T0 = _mm_unpacklo_epi32( _S0, _S1 ); _T1 = _mm_unpackhi_epi32( _S0, _S1 );\
+        _T2 = _mm_unpacklo_epi32( _S2, _S3 ); _T3 = _mm_unpackhi_epi32( _S2, _S3 );\
+        _R0 = _mm_unpacklo_epi64( _T0, _T2 ); _R1 = _mm_unpackhi_epi64( _T0, _T2 );\
+        _R2 = _mm_unpacklo_epi64( _T1, _T3 ); _R3 = _mm_unpackhi_epi64( _T1, _T3 );\
+    }
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1AppendBlocks_xmm( 
+    _Inout_updates_( 4 )                                PSYMCRYPT_SHA1_CHAINING_STATE     * pChain,
+    _Inout_updates_( 4 )                                PCBYTE                            * ppByte,
+                                                        SIZE_T                              nBytes,
+    _Out_writes_( PAR_SCRATCH_ELEMENTS )                __m128i                           * pScratch )
+{
+    //
+    // Implementation that uses 4 lanes in the XMM registers
+    //
+    __m128i * ha = pScratch;        // chaining state words a, b, c, d, e
+    __m128i * W = &pScratch[5];     // W are the 80 words of the expanded input
+    __m128i A, B, C, D, E, K;
+    __m128i T0, T1, T2, T3;
+    int r;
+
+    //
+    // The chaining state is 5 words; we transpose the first 4 and gather the last one.
+    //
+    T0 = _mm_loadu_si128( (__m128i *)&pChain[0]->H[0] );
+    T1 = _mm_loadu_si128( (__m128i *)&pChain[1]->H[0] );
+    T2 = _mm_loadu_si128( (__m128i *)&pChain[2]->H[0] );
+    T3 = _mm_loadu_si128( (__m128i *)&pChain[3]->H[0] );
+
+    XMM_TRANSPOSE_32( ha[0], ha[1], ha[2], ha[3], T0, T1, T2, T3 );
+    ha[4] = _mm_set_epi32( pChain[3]->H[4], pChain[2]->H[4], pChain[1]->H[4], pChain[0]->H[4] );
+
+    while( nBytes >= 64 )
+    {
+        //
+        // Capture the input into W[0..15]
+        //
+        for( r=0; r<16; r += 4 )
+        {
+            T0 = _mm_loadu_si128( (__m128i *) ppByte[0] ); ppByte[0] += 16;
+            T1 = _mm_loadu_si128( (__m128i *) ppByte[1] ); ppByte[1] += 16;
+            T2 = _mm_loadu_si128( (__m128i *) ppByte[2] ); ppByte[2] += 16;
+            T3 = _mm_loadu_si128( (__m128i *) ppByte[3] ); ppByte[3] += 16;
+
+            T0 = BYTE_REVERSE_32_SSE2( T0 );
+            T1 = BYTE_REVERSE_32_SSE2( T1 );
+            T2 = BYTE_REVERSE_32_SSE2( T2 );
+            T3 = BYTE_REVERSE_32_SSE2( T3 );
+
+            XMM_TRANSPOSE_32( W[r], W[r+1], W[r+2], W[r+3], T0, T1, T2, T3 );
+        }
+
+        //
+        // Expand the message
+        //
+        for( r=16; r<80; r++ )
+        {
+            T0 = _mm_xor_si128( _mm_xor_si128( W[r-3], W[r-8] ), _mm_xor_si128( W[r-14], W[r-16] ) );
+            W[r] = ROL32XMM( T0, 1 );
+        }
+
+        A = ha[0];
+        B = ha[1];
+        C = ha[2];
+        D = ha[3];
+        E = ha[4];
+
+        //
+        // Macro to compute one round
+        // On exit e is the new a value and b has been rotated to become the new c.
+        // The caller rotates the register names between rounds.
+        //
+        #define DO_ROUND( a, b, c, d, e, r, Func ) \
+            e = _mm_add_epi32( e, ROL32XMM( a, 5 ) ); \
+            e = _mm_add_epi32( e, Func( b, c, d ) ); \
+            e = _mm_add_epi32( e, _mm_add_epi32( W[r], K ) ); \
+            b = ROL32XMM( b, 30 );
+
+        #define DO_ROUNDS( Func, rStart ) \
+            for( r=rStart; r<rStart+20; r += 5 ) \
+            { \
+                DO_ROUND( A, B, C, D, E, r  , Func ); \
+                DO_ROUND( E, A, B, C, D, r+1, Func ); \
+                DO_ROUND( D, E, A, B, C, r+2, Func ); \
+                DO_ROUND( C, D, E, A, B, r+3, Func ); \
+                DO_ROUND( B, C, D, E, A, r+4, Func ); \
+            }
+
+        K = _mm_set1_epi32( 0x5a827999 );
+        DO_ROUNDS( CHXMM, 0 );
+        K = _mm_set1_epi32( 0x6ed9eba1 );
+        DO_ROUNDS( PARITYXMM, 20 );
+        K = _mm_set1_epi32( 0x8f1bbcdc );
+        DO_ROUNDS( MAJXMM, 40 );
+        K = _mm_set1_epi32( 0xca62c1d6 );
+        DO_ROUNDS( PARITYXMM, 60 );
+
+        #undef DO_ROUNDS
+        #undef DO_ROUND
+
+        ha[0] = _mm_add_epi32( ha[0], A );
+        ha[1] = _mm_add_epi32( ha[1], B );
+        ha[2] = _mm_add_epi32( ha[2], C );
+        ha[3] = _mm_add_epi32( ha[3], D );
+        ha[4] = _mm_add_epi32( ha[4], E );
+
+        nBytes -= 64;
+    }
+
+    //
+    // Copy the chaining state back into the hash structure
+    //
+    XMM_TRANSPOSE_32( T0, T1, T2, T3, ha[0], ha[1], ha[2], ha[3] );
+    _mm_storeu_si128( (__m128i *)&pChain[0]->H[0], T0 );
+    _mm_storeu_si128( (__m128i *)&pChain[1]->H[0], T1 );
+    _mm_storeu_si128( (__m128i *)&pChain[2]->H[0], T2 );
+    _mm_storeu_si128( (__m128i *)&pChain[3]->H[0], T3 );
+
+    T0 = ha[4];
+    pChain[0]->H[4] = (UINT32) _mm_cvtsi128_si32( T0 );
+    pChain[1]->H[4] = (UINT32) _mm_cvtsi128_si32( _mm_shuffle_epi32( T0, 0x55 ) );
+    pChain[2]->H[4] = (UINT32) _mm_cvtsi128_si32( _mm_shuffle_epi32( T0, 0xaa ) );
+    pChain[3]->H[4] = (UINT32) _mm_cvtsi128_si32( _mm_shuffle_epi32( T0, 0xff ) );
+}
+
+#undef CHXMM
+#undef PARITYXMM
+#undef MAJXMM
+#undef ROL32XMM
+#undef BYTE_REVERSE_32_SSE2
+
+
+//
+// Code that uses the YMM registers.
+//
+
+#define CHYMM( x, y, z )        _mm256_xor_si256( _mm256_and_si256( _mm256_xor_si256( z, y ), x ), z )
+#define PARITYYMM( x, y, z )    _mm256_xor_si256( _mm256_xor_si256( x, y ), z )
+#define MAJYMM( x, y, z )       _mm256_or_si256( _mm256_and_si256( _mm256_or_si256( z, y ), x ), _mm256_and_si256( z, y ))
+
+#define ROL32YMM( x, n ) _mm256_or_si256( _mm256_slli_epi32( x, n ), _mm256_srli_epi32( x, 32 - (n) ) )
+
+//
+// Transpose macro, convert S0..S7 into R0..R7; R0 is the lane 0, R7 is lane 7.
+// See sha256Par.c for a description of the data movement.
+//
+#define YMM_TRANSPOSE_32( _R0, _R1, _R2, _R3, _R4, _R5, _R6, _R7, _S0, _S1, _S2, _S3, _S4, _S5, _S6, _S7 ) \
+    {\
+        __m256i _T0, _T1, _T2, _T3, _T4, _T5, _T6, _T7;\
+        __m256i _U0, _U1, _U2, _U3, _U4, _U5, _U6, _U7;\
+        _T0 = _mm256_unpacklo_epi32( _S0, _S1 );  _T1 = _mm256_unpackhi_epi32( _S0, _S1 );\
+        _T2 = _mm256_unpacklo_epi32( _S2, _S3 );  _T3 = _mm256_unpackhi_epi32( _S2, _S3 );\
+        _T4 = _mm256_unpacklo_epi32( _S4, _S5 );  _T5 = _mm256_unpackhi_epi32( _S4, _S5 );\
+        _T6 = _mm256_unpacklo_epi32( _S6, _S7 );  _T7 = _mm256_unpackhi_epi32( _S6, _S7 );\
+        \
+        _U0 = _mm256_unpacklo_epi64( _T0, _T2 );  _U1 = _mm256_unpackhi_epi64( _T0, _T2 );\
+        _U2 = _mm256_unpacklo_epi64( _T1, _T3 );  _U3 = _mm256_unpackhi_epi64( _T1, _T3 );\
+        _U4 = _mm256_unpacklo_epi64( _T4, _T6 );  _U5 = _mm256_unpackhi_epi64( _T4, _T6 );\
+        _U6 = _mm256_unpacklo_epi64( _T5, _T7 );  _U7 = _mm256_unpackhi_epi64( _T5, _T7 );\
+        \
+        _R0 = _mm256_permute2x128_si256( _U0, _U4, 0x20 );  _R1 = _mm256_permute2x128_si256( _U1, _U5, 0x20);\
+        _R2 = _mm256_permute2x128_si256( _U2, _U6, 0x20 );  _R3 = _mm256_permute2x128_si256( _U3, _U7, 0x20);\
+        _R4 = _mm256_permute2x128_si256( _U0, _U4, 0x31 );  _R5 = _mm256_permute2x128_si256( _U1, _U5, 0x31);\
+        _R6 = _mm256_permute2x128_si256( _U2, _U6, 0x31 );  _R7 = _mm256_permute2x128_si256( _U3, _U7, 0x31);\
+    }
+
+//
+// Combine two XMM values into one YMM value; _L goes into lanes 0-3 and _H into lanes 4-7.
+//
+#define YMM_FROM_XMM( _L, _H )  _mm256_inserti128_si256( _mm256_castsi128_si256( _L ), _H, 1 )
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1AppendBlocks_ymm( 
+    _Inout_updates_( 8 )                                PSYMCRYPT_SHA1_CHAINING_STATE     * pChain,
+    _Inout_updates_( 8 )                                PCBYTE                            * ppByte,
+                                                        SIZE_T                              nBytes,
+    _Out_writes_( PAR_SCRATCH_ELEMENTS )                __m256i                           * pScratch )
+{
+    //
+    // Implementation that uses 8 lanes in the YMM registers
+    //
+    __m256i * ha = pScratch;        // chaining state words a, b, c, d, e
+    __m256i * W = &pScratch[5];     // W are the 80 words of the expanded input
+    __m256i A, B, C, D, E, K;
+    __m256i T0, T1, T2, T3, T4, T5, T6, T7;
+    __m128i L0, L1, L2, L3;
+    __m128i H0, H1, H2, H3;
+    __m256i BYTE_REVERSE_32;
+    int r;
+
+    _mm256_zeroupper();
+    BYTE_REVERSE_32 = _mm256_set_epi8( 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3 );
+
+    //
+    // The chaining state is 5 words; we transpose the first 4 of each group of 4 lanes
+    // in XMM registers and gather the last one.
+    //
+    L0 = _mm_loadu_si128( (__m128i *)&pChain[0]->H[0] );
+    L1 = _mm_loadu_si128( (__m128i *)&pChain[1]->H[0] );
+    L2 = _mm_loadu_si128( (__m128i *)&pChain[2]->H[0] );
+    L3 = _mm_loadu_si128( (__m128i *)&pChain[3]->H[0] );
+    XMM_TRANSPOSE_32( L0, L1, L2, L3, L0, L1, L2, L3 );
+
+    H0 = _mm_loadu_si128( (__m128i *)&pChain[4]->H[0] );
+    H1 = _mm_loadu_si128( (__m128i *)&pChain[5]->H[0] );
+    H2 = _mm_loadu_si128( (__m128i *)&pChain[6]->H[0] );
+    H3 = _mm_loadu_si128( (__m128i *)&pChain[7]->H[0] );
+    XMM_TRANSPOSE_32( H0, H1, H2, H3, H0, H1, H2, H3 );
+
+    ha[0] = YMM_FROM_XMM( L0, H0 );
+    ha[1] = YMM_FROM_XMM( L1, H1 );
+    ha[2] = YMM_FROM_XMM( L2, H2 );
+    ha[3] = YMM_FROM_XMM( L3, H3 );
+    ha[4] = _mm256_set_epi32(   pChain[7]->H[4], pChain[6]->H[4], pChain[5]->H[4], pChain[4]->H[4],
+                                pChain[3]->H[4], pChain[2]->H[4], pChain[1]->H[4], pChain[0]->H[4] );
+
+    while( nBytes >= 64 )
+    {
+        //
+        // Capture the input into W[0..15]
+        //
+        for( r=0; r<16; r += 8 )
+        {
+            T0 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[0] ), BYTE_REVERSE_32 ); ppByte[0] += 32;
+            T1 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[1] ), BYTE_REVERSE_32 ); ppByte[1] += 32;
+            T2 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[2] ), BYTE_REVERSE_32 ); ppByte[2] += 32;
+            T3 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[3] ), BYTE_REVERSE_32 ); ppByte[3] += 32;
+            T4 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[4] ), BYTE_REVERSE_32 ); ppByte[4] += 32;
+            T5 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[5] ), BYTE_REVERSE_32 ); ppByte[5] += 32;
+            T6 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[6] ), BYTE_REVERSE_32 ); ppByte[6] += 32;
+            T7 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[7] ), BYTE_REVERSE_32 ); ppByte[7] += 32;
+
+            YMM_TRANSPOSE_32( W[r], W[r+1], W[r+2], W[r+3], W[r+4], W[r+5], W[r+6], W[r+7], T0, T1, T2, T3, T4, T5, T6, T7 );
+        }
+
+        //
+        // Expand the message
+        //
+        for( r=16; r<80; r++ )
+        {
+            T0 = _mm256_xor_si256( _mm256_xor_si256( W[r-3], W[r-8] ), _mm256_xor_si256( W[r-14], W[r-16] ) );
+            W[r] = ROL32YMM( T0, 1 );
+        }
+
+        A = ha[0];
+        B = ha[1];
+        C = ha[2];
+        D = ha[3];
+        E = ha[4];
+
+        //
+        // Macro to compute one round
+        // On exit e is the new a value and b has been rotated to become the new c.
+        // The caller rotates the register names between rounds.
+        //
+        #define DO_ROUND( a, b, c, d, e, r, Func ) \
+            e = _mm256_add_epi32( e, ROL32YMM( a, 5 ) ); \
+            e = _mm256_add_epi32( e, Func( b, c, d ) ); \
+            e = _mm256_add_epi32( e, _mm256_add_epi32( W[r], K ) ); \
+            b = ROL32YMM( b, 30 );
+
+        #define DO_ROUNDS( Func, rStart ) \
+            for( r=rStart; r<rStart+20; r += 5 ) \
+            { \
+                DO_ROUND( A, B, C, D, E, r  , Func ); \
+                DO_ROUND( E, A, B, C, D, r+1, Func ); \
+                DO_ROUND( D, E, A, B, C, r+2, Func ); \
+                DO_ROUND( C, D, E, A, B, r+3, Func ); \
+                DO_ROUND( B, C, D, E, A, r+4, Func ); \
+            }
+
+        K = _mm256_set1_epi32( 0x5a827999 );
+        DO_ROUNDS( CHYMM, 0 );
+        K = _mm256_set1_epi32( 0x6ed9eba1 );
+        DO_ROUNDS( PARITYYMM, 20 );
+        K = _mm256_set1_epi32( 0x8f1bbcdc );
+        DO_ROUNDS( MAJYMM, 40 );
+        K = _mm256_set1_epi32( 0xca62c1d6 );
+        DO_ROUNDS( PARITYYMM, 60 );
+
+        #undef DO_ROUNDS
+        #undef DO_ROUND
+
+        ha[0] = _mm256_add_epi32( ha[0], A );
+        ha[1] = _mm256_add_epi32( ha[1], B );
+        ha[2] = _mm256_add_epi32( ha[2], C );
+        ha[3] = _mm256_add_epi32( ha[3], D );
+        ha[4] = _mm256_add_epi32( ha[4], E );
+
+        nBytes -= 64;
+    }
+
+    //
+    // Copy the chaining state back into the hash structure
+    //
+    L0 = _mm256_castsi256_si128( ha[0] );
+    L1 = _mm256_castsi256_si128( ha[1] );
+    L2 = _mm256_castsi256_si128( ha[2] );
+    L3 = _mm256_castsi256_si128( ha[3] );
+    XMM_TRANSPOSE_32( L0, L1, L2, L3, L0, L1, L2, L3 );
+    _mm_storeu_si128( (__m128i *)&pChain[0]->H[0], L0 );
+    _mm_storeu_si128( (__m128i *)&pChain[1]->H[0], L1 );
+    _mm_storeu_si128( (__m128i *)&pChain[2]->H[0], L2 );
+    _mm_storeu_si128( (__m128i *)&pChain[3]->H[0], L3 );
+
+    H0 = _mm256_extracti128_si256( ha[0], 1 );
+    H1 = _mm256_extracti128_si256( ha[1], 1 );
+    H2 = _mm256_extracti128_si256( ha[2], 1 );
+    H3 = _mm256_extracti128_si256( ha[3], 1 );
+    XMM_TRANSPOSE_32( H0, H1, H2, H3, H0, H1, H2, H3 );
+    _mm_storeu_si128( (__m128i *)&pChain[4]->H[0], H0 );
+    _mm_storeu_si128( (__m128i *)&pChain[5]->H[0], H1 );
+    _mm_storeu_si128( (__m128i *)&pChain[6]->H[0], H2 );
+    _mm_storeu_si128( (__m128i *)&pChain[7]->H[0], H3 );
+
+    L0 = _mm256_castsi256_si128( ha[4] );
+    H0 = _mm256_extracti128_si256( ha[4], 1 );
+    pChain[0]->H[4] = (UINT32) _mm_cvtsi128_si32( L0 );
+    pChain[1]->H[4] = (UINT32) _mm_cvtsi128_si32( _mm_shuffle_epi32( L0, 0x55 ) );
+    pChain[2]->H[4] = (UINT32) _mm_cvtsi128_si32( _mm_shuffle_epi32( L0, 0xaa ) );
+    pChain[3]->H[4] = (UINT32) _mm_cvtsi128_si32( _mm_shuffle_epi32( L0, 0xff ) );
+    pChain[4]->H[4] = (UINT32) _mm_cvtsi128_si32( H0 );
+    pChain[5]->H[4] = (UINT32) _mm_cvtsi128_si32( _mm_shuffle_epi32( H0, 0x55 ) );
+    pChain[6]->H[4] = (UINT32) _mm_cvtsi128_si32( _mm_shuffle_epi32( H0, 0xaa ) );
+    pChain[7]->H[4] = (UINT32) _mm_cvtsi128_si32( _mm_shuffle_epi32( H0, 0xff ) );
+
+    _mm256_zeroupper();
+}
+
+#undef CHYMM
+#undef PARITYYMM
+#undef MAJYMM
+#undef ROL32YMM
+#undef YMM_FROM_XMM
+
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1AppendBytes_serial( 
+    _Inout_updates_( nPar )                 PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+    _In_range_(1, MAX_PARALLEL)             SIZE_T                                  nPar,
+                                            SIZE_T                                  nBytes )
+{
+    SIZE_T i;
+    SIZE_T tmp;
+
+    SYMCRYPT_ASSERT( nBytes % SYMCRYPT_SHA1_INPUT_BLOCK_SIZE == 0 );
+    SYMCRYPT_ASSERT( nPar >= 1 && nPar <= MAX_PARALLEL );
+
+    for( i=0; i < nPar; i++ )
+    {
+        SYMCRYPT_ASSERT( pWork[i]->cbData >= nBytes );
+#if SYMCRYPT_CPU_X86
+        //
+        // On X86 the Sha1 append blocks function can save the XMM registers again, which is not allowed at DISPATCH level.
+        // We call the C implementation directly; the XMM registers are already saved when we get here.
+        //
+        SymCryptSha1AppendBlocks_ul( & ((PSYMCRYPT_SHA1_STATE)(pWork[i]->hashState))->chain, pWork[i]->pbData, nBytes, &tmp );
+#else
+        SymCryptSha1AppendBlocks( & ((PSYMCRYPT_SHA1_STATE)(pWork[i]->hashState))->chain, pWork[i]->pbData, nBytes, &tmp );
+#endif
+        pWork[i]->pbData += nBytes;
+        pWork[i]->cbData -= nBytes;
+    }
+    return;
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1Append( 
+    _Inout_updates_( nPar )                 PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+    _In_range_(1, MAX_PARALLEL)             SIZE_T                                  nPar,
+                                            SIZE_T                                  nBytes,
+    _Out_writes_to_( SYMCRYPT_SIMD_ELEMENT_SIZE * PAR_SCRATCH_ELEMENTS, 0 ) 
+                                            PBYTE                                   pbSimdScratch,
+                                            SIZE_T                                  cbSimdScratch )
+{
+    PSYMCRYPT_SHA1_CHAINING_STATE   apChain[MAX_PARALLEL];
+    PCBYTE                          apData[MAX_PARALLEL];
+    SIZE_T                          i;
+    UINT32                          maxParallel;
+
+    UNREFERENCED_PARAMETER( cbSimdScratch );        // not referenced on FRE builds 
+    SYMCRYPT_ASSERT( cbSimdScratch >= PAR_SCRATCH_ELEMENTS * SYMCRYPT_SIMD_ELEMENT_SIZE );
+    SYMCRYPT_ASSERT( ((UINT_PTR)pbSimdScratch & (SYMCRYPT_SIMD_ELEMENT_SIZE - 1)) == 0 );
+
+    //
+    // Compute maxParallel; this is 4 if nPar <= 4, and 8 if nPar = 5, ..., 8.
+    // This is how many parameter sets we have to set up.
+    //
+    maxParallel = (nPar + 3) & ~3;
+    SYMCRYPT_ASSERT( maxParallel == 4 || (maxParallel == 8 && SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 )) );
+
+    SYMCRYPT_ASSERT( nPar >= 1 && nPar <= maxParallel );
+
+    if( nPar < MIN_PARALLEL )
+    {
+        SymCryptParallelSha1AppendBytes_serial( pWork, nPar, nBytes );
+
+        // Done with this function.
+        goto cleanup;
+    }
+
+    //
+    // Our parallel code expects exactly four or eight parallel computations.
+    // We simply duplicate the first one if we get fewer parallel ones.
+    // That means we write the result multiple times, but it saves a lot of
+    // extra if()s in the main codeline.
+    //
+
+    i = 0;
+    while( i < nPar )
+    {
+            SYMCRYPT_ASSERT( pWork[i]->cbData >= nBytes );
+            apChain[i] =  & ((PSYMCRYPT_SHA1_STATE)(pWork[i]->hashState))->chain;
+            apData[i] = pWork[i]->pbData;
+            pWork[i]->pbData += nBytes;
+            pWork[i]->cbData -= nBytes;
+            i++;
+    }
+
+    while( i < maxParallel )
+    {
+            apChain[i] = apChain[0];
+            apData[i] = apData[0];
+            i++;
+    }
+
+    if( maxParallel == 8 )
+    {
+        SymCryptParallelSha1AppendBlocks_ymm(  &apChain[0], &apData[0], nBytes, (__m256i *)pbSimdScratch );
+    } else {
+        SymCryptParallelSha1AppendBlocks_xmm(  &apChain[0], &apData[0], nBytes, (__m128i *)pbSimdScratch );
+    }
+
+cleanup:
+    ;// no cleanup at this moment.
+}
+
+#endif // SUPPORT_PARALLEL
+
+#if SUPPORT_PARALLEL
+
+const SYMCRYPT_PARALLEL_HASH SymCryptParallelSha1Algorithm_default = {
+    &SymCryptSha1Algorithm_default,
+    PAR_SCRATCH_ELEMENTS * SYMCRYPT_SIMD_ELEMENT_SIZE,
+    &SymCryptParallelSha1Result1,
+    &SymCryptParallelSha1Result2,
+    &SymCryptParallelSha1ResultDone,
+    &SymCryptParallelSha1Append,
+};
+
+#else
+
+//
+// For platforms that do not have a parallel hash implementation
+// we use this structure to provide the necessary data to the _serial
+// implementation of the function.
+//
+const SYMCRYPT_PARALLEL_HASH SymCryptParallelSha1Algorithm_default = {
+    &SymCryptSha1Algorithm_default,
+    PAR_SCRATCH_ELEMENTS * SYMCRYPT_SIMD_ELEMENT_SIZE,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+};
+
+#endif
+
+const PCSYMCRYPT_PARALLEL_HASH SymCryptParallelSha1Algorithm = &SymCryptParallelSha1Algorithm_default;
+
+
+#define N_SELFTEST_STATES   5      // Just enough to trigger YMM useage
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha1Selftest()
+{
+    SYMCRYPT_SHA1_STATE                  states[N_SELFTEST_STATES];
+    BYTE                                result[N_SELFTEST_STATES][SYMCRYPT_SHA1_RESULT_SIZE];
+    SYMCRYPT_PARALLEL_HASH_OPERATION    op[2*N_SELFTEST_STATES];
+    BYTE                                scratch[SYMCRYPT_PARALLEL_SHA1_FIXED_SCRATCH + N_SELFTEST_STATES * SYMCRYPT_PARALLEL_HASH_PER_STATE_SCRATCH];
+    int                                 i;
+
+    SymCryptParallelSha1Init( &states[0], N_SELFTEST_STATES );
+
+    for( i=0; i<N_SELFTEST_STATES; i++ )
+    {
+        op[2*i    ].iHash = i;
+        op[2*i    ].hashOperation = SYMCRYPT_HASH_OPERATION_APPEND;
+        op[2*i    ].pbBuffer = (PBYTE) SymCryptTestMsg3;
+        op[2*i    ].cbBuffer = sizeof(SymCryptTestMsg3);
+        op[2*i + 1].iHash = i;
+        op[2*i + 1].hashOperation = SYMCRYPT_HASH_OPERATION_RESULT;
+        op[2*i + 1].pbBuffer = &result[i][0];
+        op[2*i + 1].cbBuffer = SYMCRYPT_SHA1_RESULT_SIZE;
+    }
+
+    SymCryptParallelSha1Process( &states[0], N_SELFTEST_STATES, op, 2*N_SELFTEST_STATES, scratch, sizeof( scratch ) );
+
+    for( i=0; i<N_SELFTEST_STATES; i++ )
+    {
+        SymCryptInjectError( &result[i][0], SYMCRYPT_SHA1_RESULT_SIZE );
+
+        if( memcmp( &result[i][0], SymCryptSha1KATAnswer, SYMCRYPT_SHA1_RESULT_SIZE ) != 0 ) {
+            SymCryptFatal( 'PSH1' );
+        }
+    }
+}
@@ -19,7 +19,13 @@ extern __declspec( align( 256 ) ) const UINT32 SymCryptSha256K[64];
 //
 // Not all CPU architectures support parallel code.
 //
-#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+#if SYMCRYPT_CPU_AMD64
+
+#define SUPPORT_PARALLEL 1
+#define MIN_PARALLEL    2
+#define MAX_PARALLEL    16
+
+#elif SYMCRYPT_CPU_X86
 
 #define SUPPORT_PARALLEL 1
 #define MIN_PARALLEL    2
@@ -80,6 +86,18 @@ SymCryptParallelSha256Process(
 {
     SymCryptParallelHashProcess_serial( SymCryptParallelSha256Algorithm, pStates, nStates, pOperations, nOperations, pbScratch, cbScratch );
 }
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha256AppendLanes(
+    _Inout_updates_( nWork )        PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+                                    SIZE_T                                  nWork,
+                                    SIZE_T                                  nBytes,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch )
+{
+    SymCryptParallelHashAppendLanes( SymCryptParallelSha256Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 1 );
+}
 #endif
 
 
@@ -534,6 +552,15 @@ SymCryptParallelSha256Process(
     if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 ) && SymCryptSaveYmm( &SaveState ) == SYMCRYPT_NO_ERROR )
     {
         maxParallel = 8;
+#if SYMCRYPT_CPU_AMD64
+        if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX512 ) )
+        {
+            //
+            // SymCryptSaveYmm also saves the ZMM state when AVX512 is present
+            //
+            maxParallel = 16;
+        }
+#endif
 
         SymCryptParallelHashProcess(    SymCryptParallelSha256Algorithm,
                                         pStates,
@@ -582,6 +609,53 @@ SymCryptParallelSha256Process(
 #endif
 }
 
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha256AppendLanes(
+    _Inout_updates_( nWork )        PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+                                    SIZE_T                                  nWork,
+                                    SIZE_T                                  nBytes,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch )
+{
+    //
+    // Same CPU feature selection as SymCryptParallelSha256Process
+    //
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+    SYMCRYPT_EXTENDED_SAVE_DATA SaveState;
+    UINT32                      maxParallel;
+
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 ) && SymCryptSaveYmm( &SaveState ) == SYMCRYPT_NO_ERROR )
+    {
+        maxParallel = 8;
+#if SYMCRYPT_CPU_AMD64
+        if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX512 ) )
+        {
+            maxParallel = 16;
+        }
+#endif
+        SymCryptParallelHashAppendLanes( SymCryptParallelSha256Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, maxParallel );
+        SymCryptRestoreYmm( &SaveState );
+    } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_SSSE3 ) && SymCryptSaveXmm( &SaveState ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptParallelHashAppendLanes( SymCryptParallelSha256Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 4 );
+        SymCryptRestoreXmm( &SaveState );
+    } else {
+        SymCryptParallelHashAppendLanes( SymCryptParallelSha256Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 1 );
+    }
+
+#elif SYMCRYPT_CPU_ARM
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_NEON ) )
+    {
+        SymCryptParallelHashAppendLanes( SymCryptParallelSha256Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, MAX_PARALLEL );
+    } else {
+        SymCryptParallelHashAppendLanes( SymCryptParallelSha256Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 1 );
+    }
+#else
+    SymCryptParallelHashAppendLanes( SymCryptParallelSha256Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 1 );
+#endif
+}
+
 
 #if  SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64 
 //
@@ -1020,6 +1094,247 @@ SymCryptParallelSha256AppendBlocks_ymm(
 
 #endif // CPU_X86_X64
 
+#if SYMCRYPT_CPU_AMD64
+//
+// Code that uses the ZMM registers.
+// AVX-512 gives us 32-bit rotates and three-input logic, so the sigma, CH, and MAJ
+// functions take far fewer instructions than in the XMM/YMM code above.
+// Like the other ZMM code in the library this is AMD64-only.
+//
+
+#define MAJZMM( x, y, z ) _mm512_ternarylogic_epi32( x, y, z, 0xe8 )
+#define CHZMM( x, y, z )  _mm512_ternarylogic_epi32( x, y, z, 0xca )
+
+#define CSIGMA0ZMM( x ) _mm512_ternarylogic_epi32( _mm512_ror_epi32(x,  2), _mm512_ror_epi32(x, 13), _mm512_ror_epi32(x, 22), 0x96 )
+#define CSIGMA1ZMM( x ) _mm512_ternarylogic_epi32( _mm512_ror_epi32(x,  6), _mm512_ror_epi32(x, 11), _mm512_ror_epi32(x, 25), 0x96 )
+#define LSIGMA0ZMM( x ) _mm512_ternarylogic_epi32( _mm512_ror_epi32(x,  7), _mm512_ror_epi32(x, 18), _mm512_srli_epi32(x,  3), 0x96 )
+#define LSIGMA1ZMM( x ) _mm512_ternarylogic_epi32( _mm512_ror_epi32(x, 17), _mm512_ror_epi32(x, 19), _mm512_srli_epi32(x, 10), 0x96 )
+
+//
+// Combine two YMM values into one ZMM value; _L goes into lanes 0-7 and _H into lanes 8-15.
+//
+#define ZMM_FROM_YMM( _L, _H )  _mm512_inserti64x4( _mm512_castsi256_si512( _L ), _H, 1 )
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha256AppendBlocks_zmm( 
+    _Inout_updates_( 16 )                               PSYMCRYPT_SHA256_CHAINING_STATE   * pChain,
+    _Inout_updates_( 16 )                               PCBYTE                            * ppByte,
+                                                        SIZE_T                              nBytes,
+    _Out_writes_( PAR_SCRATCH_ELEMENTS )                __m512i                           * pScratch )
+{
+    //
+    // Implementation that uses 16 lanes in the ZMM registers
+    // The transposes are done as two 8x8 YMM transposes, one for lanes 0-7 and one for lanes 8-15.
+    //
+    __m512i * buf = pScratch;
+    __m512i * W = &buf[4 + 8];
+    __m512i * ha = &buf[4]; // initial state words, in order h, g, ..., b, a
+    __m512i A, B, C, D, T;
+    __m256i T0, T1, T2, T3, T4, T5, T6, T7;
+    __m256i L0, L1, L2, L3, L4, L5, L6, L7;
+    __m256i H0, H1, H2, H3, H4, H5, H6, H7;
+    __m256i BYTE_REVERSE_32;
+    int r;
+    int i;
+
+    _mm256_zeroupper();
+    BYTE_REVERSE_32 = _mm256_set_epi8( 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3 );
+
+    //
+    // The chaining state can be unaligned on x86, so we use unalgned loads
+    //
+
+    T0 = _mm256_loadu_si256( (__m256i *)&pChain[0]->H[0] );
+    T1 = _mm256_loadu_si256( (__m256i *)&pChain[1]->H[0] );
+    T2 = _mm256_loadu_si256( (__m256i *)&pChain[2]->H[0] );
+    T3 = _mm256_loadu_si256( (__m256i *)&pChain[3]->H[0] );
+    T4 = _mm256_loadu_si256( (__m256i *)&pChain[4]->H[0] );
+    T5 = _mm256_loadu_si256( (__m256i *)&pChain[5]->H[0] );
+    T6 = _mm256_loadu_si256( (__m256i *)&pChain[6]->H[0] );
+    T7 = _mm256_loadu_si256( (__m256i *)&pChain[7]->H[0] );
+    YMM_TRANSPOSE_32( L0, L1, L2, L3, L4, L5, L6, L7, T0, T1, T2, T3, T4, T5, T6, T7 );
+
+    T0 = _mm256_loadu_si256( (__m256i *)&pChain[ 8]->H[0] );
+    T1 = _mm256_loadu_si256( (__m256i *)&pChain[ 9]->H[0] );
+    T2 = _mm256_loadu_si256( (__m256i *)&pChain[10]->H[0] );
+    T3 = _mm256_loadu_si256( (__m256i *)&pChain[11]->H[0] );
+    T4 = _mm256_loadu_si256( (__m256i *)&pChain[12]->H[0] );
+    T5 = _mm256_loadu_si256( (__m256i *)&pChain[13]->H[0] );
+    T6 = _mm256_loadu_si256( (__m256i *)&pChain[14]->H[0] );
+    T7 = _mm256_loadu_si256( (__m256i *)&pChain[15]->H[0] );
+    YMM_TRANSPOSE_32( H0, H1, H2, H3, H4, H5, H6, H7, T0, T1, T2, T3, T4, T5, T6, T7 );
+
+    ha[7] = ZMM_FROM_YMM( L0, H0 );
+    ha[6] = ZMM_FROM_YMM( L1, H1 );
+    ha[5] = ZMM_FROM_YMM( L2, H2 );
+    ha[4] = ZMM_FROM_YMM( L3, H3 );
+    ha[3] = ZMM_FROM_YMM( L4, H4 );
+    ha[2] = ZMM_FROM_YMM( L5, H5 );
+    ha[1] = ZMM_FROM_YMM( L6, H6 );
+    ha[0] = ZMM_FROM_YMM( L7, H7 );
+
+    buf[0] = ha[4];
+    buf[1] = ha[5];
+    buf[2] = ha[6];
+    buf[3] = ha[7];
+
+    while( nBytes >= 64 )
+    {
+
+        //
+        // Capture the input into W[0..15]
+        //
+        for( r=0; r<16; r += 8 )
+        {
+            T0 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[0] ), BYTE_REVERSE_32 );
+            T1 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[1] ), BYTE_REVERSE_32 );
+            T2 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[2] ), BYTE_REVERSE_32 );
+            T3 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[3] ), BYTE_REVERSE_32 );
+            T4 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[4] ), BYTE_REVERSE_32 );
+            T5 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[5] ), BYTE_REVERSE_32 );
+            T6 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[6] ), BYTE_REVERSE_32 );
+            T7 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[7] ), BYTE_REVERSE_32 );
+            YMM_TRANSPOSE_32( L0, L1, L2, L3, L4, L5, L6, L7, T0, T1, T2, T3, T4, T5, T6, T7 );
+
+            T0 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[ 8] ), BYTE_REVERSE_32 );
+            T1 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[ 9] ), BYTE_REVERSE_32 );
+            T2 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[10] ), BYTE_REVERSE_32 );
+            T3 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[11] ), BYTE_REVERSE_32 );
+            T4 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[12] ), BYTE_REVERSE_32 );
+            T5 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[13] ), BYTE_REVERSE_32 );
+            T6 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[14] ), BYTE_REVERSE_32 );
+            T7 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[15] ), BYTE_REVERSE_32 );
+            YMM_TRANSPOSE_32( H0, H1, H2, H3, H4, H5, H6, H7, T0, T1, T2, T3, T4, T5, T6, T7 );
+
+            for( i=0; i<16; i++ )
+            {
+                ppByte[i] += 32;
+            }
+
+            W[r  ] = ZMM_FROM_YMM( L0, H0 );
+            W[r+1] = ZMM_FROM_YMM( L1, H1 );
+            W[r+2] = ZMM_FROM_YMM( L2, H2 );
+            W[r+3] = ZMM_FROM_YMM( L3, H3 );
+            W[r+4] = ZMM_FROM_YMM( L4, H4 );
+            W[r+5] = ZMM_FROM_YMM( L5, H5 );
+            W[r+6] = ZMM_FROM_YMM( L6, H6 );
+            W[r+7] = ZMM_FROM_YMM( L7, H7 );
+        }
+
+        //
+        // Expand the message
+        //
+        A = W[15];
+        B = W[14];
+        D = W[0];
+        for( r=16; r<64; r+= 2 )
+        {
+            // Loop invariant: A=W[r-1], B = W[r-2], D = W[r-16]
+
+            //
+            // Macro for one word of message expansion.
+            // Invariant: 
+            // on entry: a = W[r-1], b = W[r-2], d = W[r-16]
+            // on exit:  W[r] computed, a = W[r-1], b = W[r], c = W[r-15]
+            //
+            #define EXPAND( a, b, c, d, r ) \
+                        c = W[r-15]; \
+                        b = _mm512_add_epi32( _mm512_add_epi32( _mm512_add_epi32( d, LSIGMA1ZMM( b ) ), W[r-7] ), LSIGMA0ZMM( c ) ); \
+                        W[r] = b; \
+
+            EXPAND( A, B, C, D, r );
+            EXPAND( B, A, D, C, (r+1));
+
+            #undef EXPAND
+        }
+
+        A = ha[7];
+        B = ha[6];
+        C = ha[5];
+        D = ha[4];
+
+        for( r=0; r<64; r += 4 )
+        {
+            //
+            // Loop invariant: 
+            // A, B, C, and D are the a,b,c,d values of the current state.
+            // W[r] is the next expanded message word to be processed.
+            // W[r-8 .. r-5] contain the current state words h, g, f, e. 
+            //
+
+            //
+            // Macro to compute one round
+            // 
+            #define DO_ROUND( a, b, c, d, t, r ) \
+                t = W[r]; \
+                t = _mm512_add_epi32( t, CSIGMA1ZMM( W[r-5] ) ); \
+                t = _mm512_add_epi32( t, W[r-8] ); \
+                t = _mm512_add_epi32( t, CHZMM( W[r-5], W[r-6], W[r-7] ) ); \
+                t = _mm512_add_epi32( t, _mm512_set1_epi32( SymCryptSha256K[r] )); \
+                W[r-4] = _mm512_add_epi32( t, d ); \
+                d = _mm512_add_epi32( t, CSIGMA0ZMM( a ) ); \
+                d = _mm512_add_epi32( d, MAJZMM( c, b, a ) );
+
+            DO_ROUND( A, B, C, D, T, r );
+            DO_ROUND( D, A, B, C, T, (r+1) );
+            DO_ROUND( C, D, A, B, T, (r+2) );
+            DO_ROUND( B, C, D, A, T, (r+3) );
+            #undef DO_ROUND
+        }
+
+        buf[3] = ha[7] = _mm512_add_epi32( buf[3], A );
+        buf[2] = ha[6] = _mm512_add_epi32( buf[2], B );
+        buf[1] = ha[5] = _mm512_add_epi32( buf[1], C );
+        buf[0] = ha[4] = _mm512_add_epi32( buf[0], D );
+        ha[3] = _mm512_add_epi32( ha[3], W[r-5] );
+        ha[2] = _mm512_add_epi32( ha[2], W[r-6] );
+        ha[1] = _mm512_add_epi32( ha[1], W[r-7] );
+        ha[0] = _mm512_add_epi32( ha[0], W[r-8] );
+
+        nBytes -= 64;
+    }
+
+    //
+    // Copy the chaining state back into the hash structure
+    //
+    YMM_TRANSPOSE_32( T0, T1, T2, T3, T4, T5, T6, T7,
+        _mm512_castsi512_si256( ha[7] ), _mm512_castsi512_si256( ha[6] ), _mm512_castsi512_si256( ha[5] ), _mm512_castsi512_si256( ha[4] ),
+        _mm512_castsi512_si256( ha[3] ), _mm512_castsi512_si256( ha[2] ), _mm512_castsi512_si256( ha[1] ), _mm512_castsi512_si256( ha[0] ) );
+    _mm256_storeu_si256( (__m256i *)&pChain[0]->H[0], T0 );
+    _mm256_storeu_si256( (__m256i *)&pChain[1]->H[0], T1 );
+    _mm256_storeu_si256( (__m256i *)&pChain[2]->H[0], T2 );
+    _mm256_storeu_si256( (__m256i *)&pChain[3]->H[0], T3 );
+    _mm256_storeu_si256( (__m256i *)&pChain[4]->H[0], T4 );
+    _mm256_storeu_si256( (__m256i *)&pChain[5]->H[0], T5 );
+    _mm256_storeu_si256( (__m256i *)&pChain[6]->H[0], T6 );
+    _mm256_storeu_si256( (__m256i *)&pChain[7]->H[0], T7 );
+
+    YMM_TRANSPOSE_32( T0, T1, T2, T3, T4, T5, T6, T7,
+        _mm512_extracti64x4_epi64( ha[7], 1 ), _mm512_extracti64x4_epi64( ha[6], 1 ), _mm512_extracti64x4_epi64( ha[5], 1 ), _mm512_extracti64x4_epi64( ha[4], 1 ),
+        _mm512_extracti64x4_epi64( ha[3], 1 ), _mm512_extracti64x4_epi64( ha[2], 1 ), _mm512_extracti64x4_epi64( ha[1], 1 ), _mm512_extracti64x4_epi64( ha[0], 1 ) );
+    _mm256_storeu_si256( (__m256i *)&pChain[ 8]->H[0], T0 );
+    _mm256_storeu_si256( (__m256i *)&pChain[ 9]->H[0], T1 );
+    _mm256_storeu_si256( (__m256i *)&pChain[10]->H[0], T2 );
+    _mm256_storeu_si256( (__m256i *)&pChain[11]->H[0], T3 );
+    _mm256_storeu_si256( (__m256i *)&pChain[12]->H[0], T4 );
+    _mm256_storeu_si256( (__m256i *)&pChain[13]->H[0], T5 );
+    _mm256_storeu_si256( (__m256i *)&pChain[14]->H[0], T6 );
+    _mm256_storeu_si256( (__m256i *)&pChain[15]->H[0], T7 );
+
+    _mm256_zeroupper();
+}
+
+#undef MAJZMM
+#undef CHZMM
+#undef CSIGMA0ZMM
+#undef CSIGMA1ZMM
+#undef LSIGMA0ZMM
+#undef LSIGMA1ZMM
+#undef ZMM_FROM_YMM
+
+#endif // CPU_AMD64
+
 #if  SYMCRYPT_CPU_ARM
 //
 // Code that uses the Neon registers.
@@ -1309,13 +1624,19 @@ SymCryptParallelSha256Append(
     SYMCRYPT_ASSERT( ((UINT_PTR)pbSimdScratch & (SYMCRYPT_SIMD_ELEMENT_SIZE - 1)) == 0 );
 
     //
-    // Compute maxParallel; this is 4 if nPar <= 4, and 8 if nPar = 5, ..., 8.
+    // Compute maxParallel; this is 4 if nPar <= 4, 8 if nPar = 5, ..., 8, and 16 if nPar = 9, ..., 16.
     // This is how many parameter sets we have to set up.
     //
 #if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
 
     maxParallel = (nPar + 3) & ~3;
-    SYMCRYPT_ASSERT( maxParallel == 4 || (maxParallel == 8 && SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 )) );
+    if( maxParallel > 8 )
+    {
+        maxParallel = 16;
+    }
+    SYMCRYPT_ASSERT( maxParallel == 4 || 
+                    (maxParallel == 8 && SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 )) ||
+                    (maxParallel == 16 && SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 | SYMCRYPT_CPU_FEATURE_AVX512 )) );
 
 #elif SYMCRYPT_CPU_ARM
 
@@ -1334,7 +1655,7 @@ SymCryptParallelSha256Append(
     }
 
     //
-    // Our parallel code expects exactly four or eight parallel computations.
+    // Our parallel code expects exactly four, eight, or sixteen parallel computations.
     // We simply duplicate the first one if we get fewer parallel ones.
     // That means we write the result multiple times, but it saves a lot of
     // extra if()s in the main codeline.
@@ -1359,11 +1680,19 @@ SymCryptParallelSha256Append(
     }
 
 #if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
-    if( maxParallel == 8 )
+    switch( maxParallel )
     {
+#if SYMCRYPT_CPU_AMD64
+    case 16:
+        SymCryptParallelSha256AppendBlocks_zmm(  &apChain[0], &apData[0], nBytes, (__m512i *)pbSimdScratch );
+        break;
+#endif
+    case 8:
         SymCryptParallelSha256AppendBlocks_ymm(  &apChain[0], &apData[0], nBytes, (__m256i *)pbSimdScratch );
-    } else {
+        break;
+    default:
         SymCryptParallelSha256AppendBlocks_xmm(  &apChain[0], &apData[0], nBytes, (__m128i *)pbSimdScratch );
+        break;
     }
 #elif SYMCRYPT_CPU_ARM
     SymCryptParallelSha256AppendBlocks_neon( &apChain[0], &apData[0], nBytes, (__n128 *) pbSimdScratch );
@@ -1434,7 +1763,7 @@ const SYMCRYPT_PARALLEL_HASH SymCryptParallelSha256Algorithm_default = {
 const PCSYMCRYPT_PARALLEL_HASH SymCryptParallelSha256Algorithm = &SymCryptParallelSha256Algorithm_default;
 
 
-#define N_SELFTEST_STATES   5      // Just enough to trigger YMM useage
+#define N_SELFTEST_STATES   9      // Just enough to trigger ZMM useage
 
 VOID
 SYMCRYPT_CALL
@@ -1194,6 +1194,238 @@ SymCryptSha512AppendBlocks_xmm(
 
 #endif
 
+
+//======================================================================================
+// Implementation using Ymm registers for the message expansion and BMI2 for the rounds
+//
+// The message expansion computes 2 consecutive words at a time; W[t] and W[t+1] only depend
+// on words that are at least 2 positions back. Each 128-bit lane of a Ymm register holds such
+// a pair of words, one lane for each of two consecutive blocks, so the expansion of two
+// blocks runs in parallel. The expanded words plus round constants are stored in a buffer.
+// The rounds are inherently serial and run on 64-bit registers, first for one block and then
+// for the other. RORX has a separate destination and does not affect the flags, which saves
+// a register copy for each rotation.
+//
+#if SYMCRYPT_CPU_AMD64
+
+#define YMMADD( _a, _b ) _mm256_add_epi64((_a), (_b))
+#define YMMROR( _a, _n ) _mm256_xor_si256( _mm256_slli_epi64( (_a), 64-(_n)), _mm256_srli_epi64( (_a), (_n)) )
+#define YMMSHR( _a, _n ) _mm256_srli_epi64((_a), (_n))
+#define YMMXOR( _a, _b ) _mm256_xor_si256((_a), (_b))
+
+#define YMMLSIGMA0( x )    YMMXOR( YMMXOR( YMMROR((x),  1), YMMROR((x),  8)), YMMSHR((x), 7))
+#define YMMLSIGMA1( x )    YMMXOR( YMMXOR( YMMROR((x), 19), YMMROR((x), 61)), YMMSHR((x), 6))
+
+#define RORX64( x, n )      _rorx_u64( (x), (n) )
+
+#define MAJ( x, y, z )  ((((z) | (y)) & (x) ) | ((z) & (y)))
+#define CH( x, y, z )  ((((z) ^ (y)) & (x)) ^ (z))
+#define CSIGMA0( x )    (RORX64((x), 28) ^ RORX64((x), 34) ^ RORX64((x), 39))
+#define CSIGMA1( x )    (RORX64((x), 14) ^ RORX64((x), 18) ^ RORX64((x), 41))
+
+//
+// Compute the next pair of message words for both blocks.
+// W[0..7] is a circular buffer of the last 16 message words of each block; j is the index
+// of the pair W[t-16], W[t-15] which is replaced by W[t], W[t+1].
+// rb is the pair index of W[t-16] in the expanded message buffer.
+//
+#define YMMEXPAND( j, rb ) { \
+    Wt = YMMADD( YMMADD( YMMADD(    YMMLSIGMA1( W[(j + 7) & 7] ), \
+                                    _mm256_alignr_epi8( W[(j + 5) & 7], W[(j + 4) & 7], 8 ) ), \
+                                    YMMLSIGMA0( _mm256_alignr_epi8( W[(j + 1) & 7], W[j], 8 ) ) ), \
+                                    W[j] ); \
+    W[j] = Wt; \
+    WK[rb + j + 8] = YMMADD( Wt, _mm256_broadcastsi128_si256( _mm_load_si128( (__m128i *)&SymCryptSha512K[2*(rb + j + 8)] ) ) ); \
+}
+
+//
+// One round, using word r + r8 of the expanded message of the block that pWK points to.
+// In the expanded message buffer W[t] and W[t+1] (t even) of one block are adjacent,
+// and the next pair of that block is 4 words further.
+//
+#define BMI2ROUND( a, b, c, d, e, f, g, h, r, r8 ) { \
+    h += pWK[2*(r) + (r8) + ((r8) & ~1)] + CSIGMA1( e ) + CH( e, f, g ); \
+    d += h; \
+    h += CSIGMA0( a ) + MAJ( a, b, c ); \
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptSha512AppendBlocks_ymm(
+    _Inout_                 SYMCRYPT_SHA512_CHAINING_STATE  *   pChain,
+    _In_reads_(cbData)      PCBYTE                              pbData,
+                            SIZE_T                              cbData,
+    _Out_                   SIZE_T                            * pcbRemaining )
+{
+    SYMCRYPT_ALIGN __m256i W[8];     // message words of two blocks; each lane holds 2 consecutive UINT64s of one block
+    SYMCRYPT_ALIGN __m256i WK[40];   // expanded message plus round constants of two blocks
+    UINT64 * pWK;
+    UINT64 A, B, C, D, E, F, G, H;
+    PCBYTE pbNext;
+    SIZE_T nBlocks;
+    int round;
+    int j;
+    __m256i Wt;
+    const __m256i BYTE_REVERSE_64 = _mm256_set_epi8( 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7,
+                                                     8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7 );
+
+    while( cbData >= 128 )
+    {
+        //
+        // Expand one or two blocks. With a single block the second lane just duplicates the work.
+        //
+        nBlocks = cbData >= 256 ? 2 : 1;
+        pbNext = pbData + 128 * (nBlocks - 1);
+
+        for( j=0; j<8; j++ )
+        {
+            Wt = _mm256_inserti128_si256(   _mm256_castsi128_si256( _mm_loadu_si128( (__m128i *)&pbData[16*j] ) ),
+                                            _mm_loadu_si128( (__m128i *)&pbNext[16*j] ), 1 );
+            Wt = _mm256_shuffle_epi8( Wt, BYTE_REVERSE_64 );
+            W[j] = Wt;
+            WK[j] = YMMADD( Wt, _mm256_broadcastsi128_si256( _mm_load_si128( (__m128i *)&SymCryptSha512K[2*j] ) ) );
+        }
+
+        //
+        // Rounds of the first block, interleaved with the rest of the message expansion for both blocks.
+        // The expansion runs on the vector units while the rounds use the integer units.
+        // Pair 8+j+round/2 is computed at round round+2*j, well before round 16+2*j+round where it is first used.
+        //
+        pWK = (UINT64 *) &WK[0];
+
+        A = pChain->H[0];
+        B = pChain->H[1];
+        C = pChain->H[2];
+        D = pChain->H[3];
+        E = pChain->H[4];
+        F = pChain->H[5];
+        G = pChain->H[6];
+        H = pChain->H[7];
+
+        for( round=0; round<64; round += 16 )
+        {
+            BMI2ROUND( A, B, C, D, E, F, G, H, round, 0 );
+            BMI2ROUND( H, A, B, C, D, E, F, G, round, 1 );
+            YMMEXPAND( 0, round/2 );
+            BMI2ROUND( G, H, A, B, C, D, E, F, round, 2 );
+            BMI2ROUND( F, G, H, A, B, C, D, E, round, 3 );
+            YMMEXPAND( 1, round/2 );
+            BMI2ROUND( E, F, G, H, A, B, C, D, round, 4 );
+            BMI2ROUND( D, E, F, G, H, A, B, C, round, 5 );
+            YMMEXPAND( 2, round/2 );
+            BMI2ROUND( C, D, E, F, G, H, A, B, round, 6 );
+            BMI2ROUND( B, C, D, E, F, G, H, A, round, 7 );
+            YMMEXPAND( 3, round/2 );
+            BMI2ROUND( A, B, C, D, E, F, G, H, round + 8, 0 );
+            BMI2ROUND( H, A, B, C, D, E, F, G, round + 8, 1 );
+            YMMEXPAND( 4, round/2 );
+            BMI2ROUND( G, H, A, B, C, D, E, F, round + 8, 2 );
+            BMI2ROUND( F, G, H, A, B, C, D, E, round + 8, 3 );
+            YMMEXPAND( 5, round/2 );
+            BMI2ROUND( E, F, G, H, A, B, C, D, round + 8, 4 );
+            BMI2ROUND( D, E, F, G, H, A, B, C, round + 8, 5 );
+            YMMEXPAND( 6, round/2 );
+            BMI2ROUND( C, D, E, F, G, H, A, B, round + 8, 6 );
+            BMI2ROUND( B, C, D, E, F, G, H, A, round + 8, 7 );
+            YMMEXPAND( 7, round/2 );
+        }
+
+        for( ; round<80; round += 8 )
+        {
+            BMI2ROUND( A, B, C, D, E, F, G, H, round, 0 );
+            BMI2ROUND( H, A, B, C, D, E, F, G, round, 1 );
+            BMI2ROUND( G, H, A, B, C, D, E, F, round, 2 );
+            BMI2ROUND( F, G, H, A, B, C, D, E, round, 3 );
+            BMI2ROUND( E, F, G, H, A, B, C, D, round, 4 );
+            BMI2ROUND( D, E, F, G, H, A, B, C, round, 5 );
+            BMI2ROUND( C, D, E, F, G, H, A, B, round, 6 );
+            BMI2ROUND( B, C, D, E, F, G, H, A, round, 7 );
+        }
+
+        pChain->H[0] += A;
+        pChain->H[1] += B;
+        pChain->H[2] += C;
+        pChain->H[3] += D;
+        pChain->H[4] += E;
+        pChain->H[5] += F;
+        pChain->H[6] += G;
+        pChain->H[7] += H;
+
+        if( nBlocks == 2 )
+        {
+            //
+            // The second block uses the other lane of the expanded message
+            //
+            pWK = (UINT64 *) &WK[0] + 2;
+
+            A = pChain->H[0];
+            B = pChain->H[1];
+            C = pChain->H[2];
+            D = pChain->H[3];
+            E = pChain->H[4];
+            F = pChain->H[5];
+            G = pChain->H[6];
+            H = pChain->H[7];
+
+            for( round=0; round<80; round += 8 )
+            {
+                BMI2ROUND( A, B, C, D, E, F, G, H, round, 0 );
+                BMI2ROUND( H, A, B, C, D, E, F, G, round, 1 );
+                BMI2ROUND( G, H, A, B, C, D, E, F, round, 2 );
+                BMI2ROUND( F, G, H, A, B, C, D, E, round, 3 );
+                BMI2ROUND( E, F, G, H, A, B, C, D, round, 4 );
+                BMI2ROUND( D, E, F, G, H, A, B, C, round, 5 );
+                BMI2ROUND( C, D, E, F, G, H, A, B, round, 6 );
+                BMI2ROUND( B, C, D, E, F, G, H, A, round, 7 );
+            }
+
+            pChain->H[0] += A;
+            pChain->H[1] += B;
+            pChain->H[2] += C;
+            pChain->H[3] += D;
+            pChain->H[4] += E;
+            pChain->H[5] += F;
+            pChain->H[6] += G;
+            pChain->H[7] += H;
+        }
+
+        pbData += 128 * nBlocks;
+        cbData -= 128 * nBlocks;
+    }
+
+    *pcbRemaining = cbData;
+
+    //
+    // Wipe the variables;
+    //
+    SymCryptWipeKnownSize( W, sizeof( W ) );
+    SymCryptWipeKnownSize( WK, sizeof( WK ) );
+    SymCryptWipeKnownSize( &Wt, sizeof( Wt ) );
+    SYMCRYPT_FORCE_WRITE64( &A, 0 );
+    SYMCRYPT_FORCE_WRITE64( &B, 0 );
+    SYMCRYPT_FORCE_WRITE64( &C, 0 );
+    SYMCRYPT_FORCE_WRITE64( &D, 0 );
+    SYMCRYPT_FORCE_WRITE64( &E, 0 );
+    SYMCRYPT_FORCE_WRITE64( &F, 0 );
+    SYMCRYPT_FORCE_WRITE64( &G, 0 );
+    SYMCRYPT_FORCE_WRITE64( &H, 0 );
+}
+
+#undef YMMADD
+#undef YMMROR
+#undef YMMSHR
+#undef YMMXOR
+#undef YMMLSIGMA0
+#undef YMMLSIGMA1
+#undef RORX64
+#undef MAJ
+#undef CH
+#undef CSIGMA0
+#undef CSIGMA1
+#undef YMMEXPAND
+#undef BMI2ROUND
+
+#endif
     
     
 //======================================================================================
@@ -1357,9 +1589,17 @@ SymCryptSha512AppendBlocks(
 {
 #if SYMCRYPT_CPU_AMD64
 
-    SymCryptSha512AppendBlocks_ull( pChain, pbData, cbData, pcbRemaining );       // core2: 10.66 c/B
-    //SymCryptSha512AppendBlocks_ull2( pChain, pbData, cbData, pcbRemaining );      // core2: 11.53 c/B  
-    //SymCryptSha512AppendBlocks_ull3( pChain, pbData, cbData, pcbRemaining );      // core2: 11.07 c/B
+    SYMCRYPT_EXTENDED_SAVE_DATA SaveData;
+
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 | SYMCRYPT_CPU_FEATURE_BMI2 ) && SymCryptSaveYmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptSha512AppendBlocks_ymm( pChain, pbData, cbData, pcbRemaining );
+        SymCryptRestoreYmm( &SaveData );
+    } else {
+        SymCryptSha512AppendBlocks_ull( pChain, pbData, cbData, pcbRemaining );       // core2: 10.66 c/B
+        //SymCryptSha512AppendBlocks_ull2( pChain, pbData, cbData, pcbRemaining );      // core2: 11.53 c/B  
+        //SymCryptSha512AppendBlocks_ull3( pChain, pbData, cbData, pcbRemaining );      // core2: 11.07 c/B
+    }
 
 #elif SYMCRYPT_CPU_ARM
 
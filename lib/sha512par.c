@@ -18,7 +18,14 @@ extern __declspec( align( 64 ) ) const UINT64 SymCryptSha512K[81];
 //
 // Not all CPU architectures support parallel code.
 //
-#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+#if SYMCRYPT_CPU_AMD64
+
+#define SUPPORT_PARALLEL 1
+
+#define MIN_PARALLEL    2
+#define MAX_PARALLEL    8
+
+#elif SYMCRYPT_CPU_X86
 
 #define SUPPORT_PARALLEL 1
 
@@ -119,6 +126,18 @@ SymCryptParallelSha384Process(
     SymCryptParallelHashProcess_serial( SymCryptParallelSha384Algorithm, pStates, nStates, pOperations, nOperations, pbScratch, cbScratch );
 }
 
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha512AppendLanes(
+    _Inout_updates_( nWork )        PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+                                    SIZE_T                                  nWork,
+                                    SIZE_T                                  nBytes,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch )
+{
+    SymCryptParallelHashAppendLanes( SymCryptParallelSha512Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 1 );
+}
+
 #endif
 
 
@@ -257,6 +276,15 @@ SymCryptParallelSha512Sha384Process(
     if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 | SYMCRYPT_CPU_FEATURE_SSSE3 ) && SymCryptSaveYmm( &SaveState ) == SYMCRYPT_NO_ERROR )
     {
         maxParallel = 4;
+#if SYMCRYPT_CPU_AMD64
+        if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX512 ) )
+        {
+            //
+            // SymCryptSaveYmm also saves the ZMM state when AVX512 is present
+            //
+            maxParallel = 8;
+        }
+#endif
 
         SymCryptParallelHashProcess(    pParHash,
                                         pStates,
@@ -332,6 +360,53 @@ SymCryptParallelSha384Process(
     SymCryptParallelSha512Sha384Process( SymCryptParallelSha384Algorithm, pStates, nStates, pOperations, nOperations, pbScratch, cbScratch );
 }
 
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha512AppendLanes(
+    _Inout_updates_( nWork )        PSYMCRYPT_PARALLEL_HASH_SCRATCH_STATE * pWork,
+                                    SIZE_T                                  nWork,
+                                    SIZE_T                                  nBytes,
+    _Out_writes_( cbScratch )       PBYTE                                   pbScratch,
+                                    SIZE_T                                  cbScratch )
+{
+    //
+    // Same CPU feature selection as SymCryptParallelSha512Sha384Process
+    //
+#if SYMCRYPT_CPU_AMD64 | SYMCRYPT_CPU_X86
+    SYMCRYPT_EXTENDED_SAVE_DATA SaveState;
+    UINT32                      maxParallel;
+
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 | SYMCRYPT_CPU_FEATURE_SSSE3 ) && SymCryptSaveYmm( &SaveState ) == SYMCRYPT_NO_ERROR )
+    {
+        maxParallel = 4;
+#if SYMCRYPT_CPU_AMD64
+        if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX512 ) )
+        {
+            maxParallel = 8;
+        }
+#endif
+        SymCryptParallelHashAppendLanes( SymCryptParallelSha512Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, maxParallel );
+        SymCryptRestoreYmm( &SaveState );
+    } else if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_SSSE3 ) && SymCryptSaveXmm( &SaveState ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptParallelHashAppendLanes( SymCryptParallelSha512Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 2 );
+        SymCryptRestoreXmm( &SaveState );
+    } else {
+        SymCryptParallelHashAppendLanes( SymCryptParallelSha512Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 1 );
+    }
+
+#elif SYMCRYPT_CPU_ARM
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_NEON ) )
+    {
+        SymCryptParallelHashAppendLanes( SymCryptParallelSha512Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, MAX_PARALLEL );
+    } else {
+        SymCryptParallelHashAppendLanes( SymCryptParallelSha512Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 1 );
+    }
+#else
+    SymCryptParallelHashAppendLanes( SymCryptParallelSha512Algorithm, pWork, nWork, nBytes, pbScratch, cbScratch, 1 );
+#endif
+}
+
 
 #if  SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64 
 //
@@ -729,6 +804,218 @@ SymCryptParallelSha512AppendBlocks_ymm(
 
 #endif // CPU_X86_X64
 
+#if SYMCRYPT_CPU_AMD64
+//
+// Code that uses the ZMM registers.
+// AVX-512 gives us 64-bit rotates and three-input logic, which removes most of the
+// shift/xor work of the XMM/YMM code. Like the other ZMM code in the library this is AMD64-only.
+//
+
+#define MAJZMM( x, y, z ) _mm512_ternarylogic_epi64( x, y, z, 0xe8 )
+#define CHZMM( x, y, z )  _mm512_ternarylogic_epi64( x, y, z, 0xca )
+
+#define CSIGMA0ZMM( x ) _mm512_ternarylogic_epi64( _mm512_ror_epi64(x, 28), _mm512_ror_epi64(x, 34), _mm512_ror_epi64(x, 39), 0x96 )
+#define CSIGMA1ZMM( x ) _mm512_ternarylogic_epi64( _mm512_ror_epi64(x, 14), _mm512_ror_epi64(x, 18), _mm512_ror_epi64(x, 41), 0x96 )
+#define LSIGMA0ZMM( x ) _mm512_ternarylogic_epi64( _mm512_ror_epi64(x,  1), _mm512_ror_epi64(x,  8), _mm512_srli_epi64(x,  7), 0x96 )
+#define LSIGMA1ZMM( x ) _mm512_ternarylogic_epi64( _mm512_ror_epi64(x, 19), _mm512_ror_epi64(x, 61), _mm512_srli_epi64(x,  6), 0x96 )
+
+//
+// Combine two YMM values into one ZMM value; _L goes into lanes 0-3 and _H into lanes 4-7.
+//
+#define ZMM_FROM_YMM( _L, _H )  _mm512_inserti64x4( _mm512_castsi256_si512( _L ), _H, 1 )
+
+VOID
+SYMCRYPT_CALL
+SymCryptParallelSha512AppendBlocks_zmm( 
+    _Inout_updates_( 8 )                                PSYMCRYPT_SHA512_CHAINING_STATE   * pChain,
+    _Inout_updates_( 8 )                                PCBYTE                            * ppByte,
+                                                        SIZE_T                              nBytes,
+    _Out_writes_( PAR_SCRATCH_ELEMENTS )                __m512i                           * pScratch )
+{
+    //
+    // Implementation that uses 8 lanes in the ZMM registers
+    // The transposes are done as pairs of 4x4 YMM transposes, one for lanes 0-3 and one for lanes 4-7.
+    //
+    __m512i * buf = pScratch;       // chaining state concatenated with the expanded input block
+    __m512i * W = &buf[4 + 8];      // W are the 80 words of the expanded input
+    __m512i * ha = &buf[4];         // initial state words, in order h, g, ..., b, a
+    __m512i A, B, C, D, T;
+    __m256i T0, T1, T2, T3;
+    __m256i L0, L1, L2, L3;
+    __m256i H0, H1, H2, H3;
+    int r;
+    int i;
+    __m256i BYTE_REVERSE_64;
+
+    _mm256_zeroupper();
+    BYTE_REVERSE_64 = _mm256_set_epi8( 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7 );
+
+    //
+    // The chaining state can be unaligned on x86, so we use unalgned loads
+    //
+
+    for( r=0; r<8; r += 4 )
+    {
+        T0 = _mm256_loadu_si256( (__m256i *)&pChain[0]->H[r] );
+        T1 = _mm256_loadu_si256( (__m256i *)&pChain[1]->H[r] );
+        T2 = _mm256_loadu_si256( (__m256i *)&pChain[2]->H[r] );
+        T3 = _mm256_loadu_si256( (__m256i *)&pChain[3]->H[r] );
+        YMM_TRANSPOSE_64( L0, L1, L2, L3, T0, T1, T2, T3 );
+
+        T0 = _mm256_loadu_si256( (__m256i *)&pChain[4]->H[r] );
+        T1 = _mm256_loadu_si256( (__m256i *)&pChain[5]->H[r] );
+        T2 = _mm256_loadu_si256( (__m256i *)&pChain[6]->H[r] );
+        T3 = _mm256_loadu_si256( (__m256i *)&pChain[7]->H[r] );
+        YMM_TRANSPOSE_64( H0, H1, H2, H3, T0, T1, T2, T3 );
+
+        ha[7-r] = ZMM_FROM_YMM( L0, H0 );
+        ha[6-r] = ZMM_FROM_YMM( L1, H1 );
+        ha[5-r] = ZMM_FROM_YMM( L2, H2 );
+        ha[4-r] = ZMM_FROM_YMM( L3, H3 );
+    }
+
+    buf[0] = ha[4];
+    buf[1] = ha[5];
+    buf[2] = ha[6];
+    buf[3] = ha[7];
+
+    while( nBytes >= 128 )
+    {
+
+        //
+        // Capture the input into W[0..15]
+        //
+        for( r=0; r<16; r += 4 )
+        {
+            T0 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[0] ), BYTE_REVERSE_64 );
+            T1 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[1] ), BYTE_REVERSE_64 );
+            T2 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[2] ), BYTE_REVERSE_64 );
+            T3 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[3] ), BYTE_REVERSE_64 );
+            YMM_TRANSPOSE_64( L0, L1, L2, L3, T0, T1, T2, T3 );
+
+            T0 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[4] ), BYTE_REVERSE_64 );
+            T1 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[5] ), BYTE_REVERSE_64 );
+            T2 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[6] ), BYTE_REVERSE_64 );
+            T3 = _mm256_shuffle_epi8( _mm256_loadu_si256( (__m256i *) ppByte[7] ), BYTE_REVERSE_64 );
+            YMM_TRANSPOSE_64( H0, H1, H2, H3, T0, T1, T2, T3 );
+
+            for( i=0; i<8; i++ )
+            {
+                ppByte[i] += 32;
+            }
+
+            W[r  ] = ZMM_FROM_YMM( L0, H0 );
+            W[r+1] = ZMM_FROM_YMM( L1, H1 );
+            W[r+2] = ZMM_FROM_YMM( L2, H2 );
+            W[r+3] = ZMM_FROM_YMM( L3, H3 );
+        }
+
+        //
+        // Expand the message
+        //
+        A = W[15];
+        B = W[14];
+        D = W[0];
+        for( r=16; r<80; r+= 2 )
+        {
+            // Loop invariant: A=W[r-1], B = W[r-2], D = W[r-16]
+
+            //
+            // Macro for one word of message expansion.
+            // Invariant: 
+            // on entry: a = W[r-1], b = W[r-2], d = W[r-16]
+            // on exit:  W[r] computed, a = W[r-1], b = W[r], c = W[r-15]
+            //
+            #define EXPAND( a, b, c, d, r ) \
+                        c = W[r-15]; \
+                        b = _mm512_add_epi64( _mm512_add_epi64( _mm512_add_epi64( d, LSIGMA1ZMM( b ) ), W[r-7] ), LSIGMA0ZMM( c ) ); \
+                        W[r] = b; \
+
+            EXPAND( A, B, C, D, r );
+            EXPAND( B, A, D, C, (r+1));
+
+            #undef EXPAND
+        }
+
+        A = ha[7];
+        B = ha[6];
+        C = ha[5];
+        D = ha[4];
+
+        for( r=0; r<80; r += 4 )
+        {
+            //
+            // Loop invariant: 
+            // A, B, C, and D are the a,b,c,d values of the current state.
+            // W[r] is the next expanded message word to be processed.
+            // W[r-8 .. r-5] contain the current state words h, g, f, e. 
+            //
+
+            //
+            // Macro to compute one round
+            //
+            #define DO_ROUND( a, b, c, d, t, r ) \
+                t = W[r]; \
+                t = _mm512_add_epi64( t, CSIGMA1ZMM( W[r-5] ) ); \
+                t = _mm512_add_epi64( t, W[r-8] ); \
+                t = _mm512_add_epi64( t, CHZMM( W[r-5], W[r-6], W[r-7] ) ); \
+                t = _mm512_add_epi64( t, _mm512_set1_epi64( SymCryptSha512K[r] )); \
+                W[r-4] = _mm512_add_epi64( t, d ); \
+                d = _mm512_add_epi64( t, CSIGMA0ZMM( a ) ); \
+                d = _mm512_add_epi64( d, MAJZMM( c, b, a ) );
+
+            DO_ROUND( A, B, C, D, T, r );
+            DO_ROUND( D, A, B, C, T, (r+1) );
+            DO_ROUND( C, D, A, B, T, (r+2) );
+            DO_ROUND( B, C, D, A, T, (r+3) );
+            #undef DO_ROUND
+        }
+
+        buf[3] = ha[7] = _mm512_add_epi64( buf[3], A );
+        buf[2] = ha[6] = _mm512_add_epi64( buf[2], B );
+        buf[1] = ha[5] = _mm512_add_epi64( buf[1], C );
+        buf[0] = ha[4] = _mm512_add_epi64( buf[0], D );
+        ha[3] = _mm512_add_epi64( ha[3], W[r-5] );
+        ha[2] = _mm512_add_epi64( ha[2], W[r-6] );
+        ha[1] = _mm512_add_epi64( ha[1], W[r-7] );
+        ha[0] = _mm512_add_epi64( ha[0], W[r-8] );
+
+        nBytes -= 128;
+    }
+
+    //
+    // Copy the chaining state back into the hash structure
+    //
+    for( r=0; r<8; r += 4 )
+    {
+        YMM_TRANSPOSE_64( T0, T1, T2, T3,
+            _mm512_castsi512_si256( ha[7-r] ), _mm512_castsi512_si256( ha[6-r] ), _mm512_castsi512_si256( ha[5-r] ), _mm512_castsi512_si256( ha[4-r] ) );
+        _mm256_storeu_si256( (__m256i *)&pChain[0]->H[r], T0 );
+        _mm256_storeu_si256( (__m256i *)&pChain[1]->H[r], T1 );
+        _mm256_storeu_si256( (__m256i *)&pChain[2]->H[r], T2 );
+        _mm256_storeu_si256( (__m256i *)&pChain[3]->H[r], T3 );
+
+        YMM_TRANSPOSE_64( T0, T1, T2, T3,
+            _mm512_extracti64x4_epi64( ha[7-r], 1 ), _mm512_extracti64x4_epi64( ha[6-r], 1 ), _mm512_extracti64x4_epi64( ha[5-r], 1 ), _mm512_extracti64x4_epi64( ha[4-r], 1 ) );
+        _mm256_storeu_si256( (__m256i *)&pChain[4]->H[r], T0 );
+        _mm256_storeu_si256( (__m256i *)&pChain[5]->H[r], T1 );
+        _mm256_storeu_si256( (__m256i *)&pChain[6]->H[r], T2 );
+        _mm256_storeu_si256( (__m256i *)&pChain[7]->H[r], T3 );
+    }
+
+    _mm256_zeroupper();
+}
+
+#undef MAJZMM
+#undef CHZMM
+#undef CSIGMA0ZMM
+#undef CSIGMA1ZMM
+#undef LSIGMA0ZMM
+#undef LSIGMA1ZMM
+#undef ZMM_FROM_YMM
+
+#endif // CPU_AMD64
+
 #if  SYMCRYPT_CPU_ARM
 
 
@@ -789,13 +1076,19 @@ SymCryptParallelSha512Append(
     SYMCRYPT_ASSERT( ((UINT_PTR)pbSimdScratch & (SYMCRYPT_SIMD_ELEMENT_SIZE - 1)) == 0 );
 
     //
-    // Compute maxParallel; this is 2 if nPar <= 2, and 4 if nPar = 3,4.
+    // Compute maxParallel; this is 2 if nPar <= 2, 4 if nPar = 3,4, and 8 if nPar = 5, ..., 8.
     // This is how many parameter sets we have to set up.
     //
 #if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
 
     maxParallel = (nPar + 1) & ~1;
-    SYMCRYPT_ASSERT( maxParallel == 2 || (maxParallel == 4 && SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 )) );
+    if( maxParallel > 4 )
+    {
+        maxParallel = 8;
+    }
+    SYMCRYPT_ASSERT( maxParallel == 2 || 
+                    (maxParallel == 4 && SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 )) ||
+                    (maxParallel == 8 && SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_AVX2 | SYMCRYPT_CPU_FEATURE_AVX512 )) );
 
 #elif SYMCRYPT_CPU_ARM
 
@@ -814,7 +1107,7 @@ SymCryptParallelSha512Append(
     }
 
     //
-    // Our parallel code expects exactly 2 or 4 parallel computations.
+    // Our parallel code expects exactly 2, 4, or 8 parallel computations.
     // We simply duplicate the first one if we get fewer parallel ones.
     // That means we write the result multiple times, but it saves a lot of
     // extra if()s in the main codeline.
@@ -839,11 +1132,19 @@ SymCryptParallelSha512Append(
     }
 
 #if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
-    if( maxParallel == 4 )
+    switch( maxParallel )
     {
+#if SYMCRYPT_CPU_AMD64
+    case 8:
+        SymCryptParallelSha512AppendBlocks_zmm(  &apChain[0], &apData[0], nBytes, (__m512i *)pbSimdScratch );
+        break;
+#endif
+    case 4:
         SymCryptParallelSha512AppendBlocks_ymm(  &apChain[0], &apData[0], nBytes, (__m256i *)pbSimdScratch );
-    } else {
+        break;
+    default:
         SymCryptParallelSha512AppendBlocks_xmm(  &apChain[0], &apData[0], nBytes, (__m128i *)pbSimdScratch );
+        break;
     }
 #elif SYMCRYPT_CPU_ARM
     UNREFERENCED_PARAMETER( pbSimdScratch );
@@ -910,7 +1211,7 @@ const PCSYMCRYPT_PARALLEL_HASH SymCryptParallelSha384Algorithm = &SymCryptParall
 const PCSYMCRYPT_PARALLEL_HASH SymCryptParallelSha512Algorithm = &SymCryptParallelSha512Algorithm_default;
 
 
-#define N_SELFTEST_STATES   3      // Just enough to trigger YMM useage
+#define N_SELFTEST_STATES   5      // Just enough to trigger ZMM useage
 
 VOID
 SYMCRYPT_CALL
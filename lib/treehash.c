@@ -0,0 +1,456 @@
+//
+// treehash.c   Tree (Merkle) hashing with SHA-256
+//
+// Copyright (c) Microsoft Corporation. Licensed under the MIT license.
+//
+
+//
+// A tree hash over a large amount of data consists mostly of independent leaf hashes,
+// and each level of interior nodes is again a set of independent hashes.
+// We feed these to the parallel SHA-256 code in batches of SYMCRYPT_SHA256_TREE_HASH_BATCH nodes.
+//
+// The incremental interface cannot keep whole levels in memory. It hashes the leaves in
+// parallel batches, and builds the interior nodes with one running hash state per level.
+// Interior nodes are a small fraction of the work unless the leaves are very short.
+//
+
+#include "precomp.h"
+
+#define TREE_HASH_LEAF_PREFIX   (0x00)
+#define TREE_HASH_NODE_PREFIX   (0x01)
+
+BOOLEAN
+SYMCRYPT_CALL
+SymCryptTreeHashParamsValid( _In_ PCSYMCRYPT_TREE_HASH_PARAMS pParams )
+{
+    return  pParams->cbLeaf > 0 &&
+            pParams->fanOut >= 2 &&
+            pParams->fanOut <= SYMCRYPT_SHA256_TREE_HASH_MAX_FANOUT &&
+            (pParams->flags & ~SYMCRYPT_FLAG_TREE_HASH_DOMAIN_PREFIX) == 0;
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptSha256TreeHashInitNode(
+    _In_    PCSYMCRYPT_TREE_HASH_PARAMS pParams,
+            BYTE                        prefix,
+    _Out_   PSYMCRYPT_SHA256_STATE      pState )
+{
+    SymCryptSha256Init( pState );
+    if( (pParams->flags & SYMCRYPT_FLAG_TREE_HASH_DOMAIN_PREFIX) != 0 )
+    {
+        SymCryptSha256Append( pState, &prefix, 1 );
+    }
+}
+
+//
+// Hash nNodes consecutive pieces of the data; each piece is cbNode bytes except that the last one
+// consists of whatever data is left.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptSha256TreeHashNodes(
+    _In_                                                    PCSYMCRYPT_TREE_HASH_PARAMS pParams,
+                                                            BYTE                        prefix,
+    _In_reads_( cbData )                                    PCBYTE                      pbData,
+                                                            SIZE_T                      cbData,
+                                                            SIZE_T                      cbNode,
+                                                            SIZE_T                      nNodes,
+    _Out_writes_( nNodes * SYMCRYPT_SHA256_RESULT_SIZE )    PBYTE                       pbResult,
+    _Out_writes_( SYMCRYPT_SHA256_TREE_HASH_SCRATCH )       PBYTE                       pbScratch )
+{
+    PSYMCRYPT_SHA256_STATE              pStates;
+    PSYMCRYPT_PARALLEL_HASH_OPERATION   pOps;
+    PBYTE                               pbHashScratch;
+    SIZE_T                              nBatch;
+    SIZE_T                              cbNodeData;
+    SIZE_T                              i;
+
+    //
+    // Scratch layout: hash states, two hash operations per state, and the parallel hash scratch.
+    //
+    pStates = (PSYMCRYPT_SHA256_STATE) SYMCRYPT_ALIGN_UP( pbScratch );
+    pOps = (PSYMCRYPT_PARALLEL_HASH_OPERATION) &pStates[SYMCRYPT_SHA256_TREE_HASH_BATCH];
+    pbHashScratch = (PBYTE) &pOps[2 * SYMCRYPT_SHA256_TREE_HASH_BATCH];
+
+    while( nNodes > 0 )
+    {
+        nBatch = SYMCRYPT_MIN( nNodes, SYMCRYPT_SHA256_TREE_HASH_BATCH );
+
+        for( i=0; i<nBatch; i++ )
+        {
+            cbNodeData = SYMCRYPT_MIN( cbNode, cbData );
+
+            SymCryptSha256TreeHashInitNode( pParams, prefix, &pStates[i] );
+
+            pOps[2*i].iHash = i;
+            pOps[2*i].hashOperation = SYMCRYPT_HASH_OPERATION_APPEND;
+            pOps[2*i].pbBuffer = (PBYTE) pbData;
+            pOps[2*i].cbBuffer = cbNodeData;
+
+            pOps[2*i + 1].iHash = i;
+            pOps[2*i + 1].hashOperation = SYMCRYPT_HASH_OPERATION_RESULT;
+            pOps[2*i + 1].pbBuffer = pbResult;
+            pOps[2*i + 1].cbBuffer = SYMCRYPT_SHA256_RESULT_SIZE;
+
+            pbData += cbNodeData;
+            cbData -= cbNodeData;
+            pbResult += SYMCRYPT_SHA256_RESULT_SIZE;
+        }
+
+        SymCryptParallelSha256Process(  pStates,
+                                        nBatch,
+                                        pOps,
+                                        2 * nBatch,
+                                        pbHashScratch,
+                                        SYMCRYPT_PARALLEL_SHA256_FIXED_SCRATCH + nBatch * SYMCRYPT_PARALLEL_HASH_PER_STATE_SCRATCH );
+
+        nNodes -= nBatch;
+    }
+}
+
+SIZE_T
+SYMCRYPT_CALL
+SymCryptSha256TreeHashLevelsSize(
+    _In_    PCSYMCRYPT_TREE_HASH_PARAMS     pParams,
+            SIZE_T                          cbData )
+{
+    UINT64  nNodes;
+    UINT64  nTotal;
+
+    if( !SymCryptTreeHashParamsValid( pParams ) )
+    {
+        return 0;
+    }
+
+    nNodes = cbData / pParams->cbLeaf + (cbData % pParams->cbLeaf != 0);
+    if( nNodes == 0 )
+    {
+        nNodes = 1;
+    }
+
+    nTotal = nNodes;
+    while( nNodes > 1 )
+    {
+        nNodes = (nNodes + pParams->fanOut - 1) / pParams->fanOut;
+        nTotal += nNodes;
+    }
+
+    if( nTotal > ((SIZE_T) -1) / SYMCRYPT_SHA256_RESULT_SIZE )
+    {
+        // The result would not fit in a SIZE_T
+        return 0;
+    }
+
+    return (SIZE_T) nTotal * SYMCRYPT_SHA256_RESULT_SIZE;
+}
+
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptSha256TreeHashLevels(
+    _In_                        PCSYMCRYPT_TREE_HASH_PARAMS     pParams,
+    _In_reads_( cbData )        PCBYTE                          pbData,
+                                SIZE_T                          cbData,
+    _Out_writes_( cbLevels )    PBYTE                           pbLevels,
+                                SIZE_T                          cbLevels,
+    _Out_writes_( cbScratch )   PBYTE                           pbScratch,
+                                SIZE_T                          cbScratch )
+{
+    SIZE_T  cbNeeded;
+    SIZE_T  nNodes;
+    SIZE_T  nNext;
+    SIZE_T  nHashed;
+    SIZE_T  cbNode;
+    PBYTE   pbLevel;
+    PBYTE   pbNext;
+
+    cbNeeded = SymCryptSha256TreeHashLevelsSize( pParams, cbData );
+    if( cbNeeded == 0 )
+    {
+        return SYMCRYPT_INVALID_ARGUMENT;
+    }
+
+    if( cbLevels < cbNeeded )
+    {
+        return SYMCRYPT_BUFFER_TOO_SMALL;
+    }
+
+    if( cbScratch < SYMCRYPT_SHA256_TREE_HASH_SCRATCH )
+    {
+        SymCryptFatal( 'thsc' );
+    }
+
+    //
+    // The leaves
+    //
+    nNodes = cbData / pParams->cbLeaf + (cbData % pParams->cbLeaf != 0);
+    if( nNodes == 0 )
+    {
+        nNodes = 1;
+    }
+
+    pbLevel = pbLevels;
+    SymCryptSha256TreeHashNodes( pParams, TREE_HASH_LEAF_PREFIX, pbData, cbData, pParams->cbLeaf, nNodes, pbLevel, pbScratch );
+
+    //
+    // Each interior level hashes groups of fanOut consecutive nodes from the level below;
+    // a final group with a single node is copied instead.
+    //
+    cbNode = (SIZE_T) pParams->fanOut * SYMCRYPT_SHA256_RESULT_SIZE;
+    while( nNodes > 1 )
+    {
+        nNext = (nNodes + pParams->fanOut - 1) / pParams->fanOut;
+        pbNext = pbLevel + nNodes * SYMCRYPT_SHA256_RESULT_SIZE;
+
+        nHashed = nNext;
+        if( nNodes % pParams->fanOut == 1 )
+        {
+            nHashed--;
+            memcpy( pbNext + nHashed * SYMCRYPT_SHA256_RESULT_SIZE, pbLevel + (nNodes - 1) * SYMCRYPT_SHA256_RESULT_SIZE, SYMCRYPT_SHA256_RESULT_SIZE );
+        }
+
+        SymCryptSha256TreeHashNodes(    pParams,
+                                        TREE_HASH_NODE_PREFIX,
+                                        pbLevel,
+                                        SYMCRYPT_MIN( nNodes * SYMCRYPT_SHA256_RESULT_SIZE, nHashed * cbNode ),
+                                        cbNode,
+                                        nHashed,
+                                        pbNext,
+                                        pbScratch );
+
+        pbLevel = pbNext;
+        nNodes = nNext;
+    }
+
+    SYMCRYPT_ASSERT( pbLevel + SYMCRYPT_SHA256_RESULT_SIZE == pbLevels + cbNeeded );
+
+    return SYMCRYPT_NO_ERROR;
+}
+
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptSha256TreeHashInit(
+    _Out_   PSYMCRYPT_SHA256_TREE_HASH_STATE    pState,
+    _In_    PCSYMCRYPT_TREE_HASH_PARAMS         pParams )
+{
+    UINT32  i;
+
+    if( !SymCryptTreeHashParamsValid( pParams ) )
+    {
+        return SYMCRYPT_INVALID_ARGUMENT;
+    }
+
+    pState->params = *pParams;
+    SymCryptSha256TreeHashInitNode( pParams, TREE_HASH_LEAF_PREFIX, &pState->leaf );
+    pState->cbLeafData = 0;
+    pState->nLeaves = 0;
+    pState->nLevels = 0;
+
+    //
+    // The level hash states are initialized when their first child arrives.
+    //
+    for( i=0; i<SYMCRYPT_SHA256_TREE_HASH_MAX_LEVELS; i++ )
+    {
+        pState->level[i].nChildren = 0;
+    }
+
+    SYMCRYPT_SET_MAGIC( pState );
+
+    return SYMCRYPT_NO_ERROR;
+}
+
+//
+// Add a completed leaf hash to the tree, and propagate any interior nodes that are completed by it.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptSha256TreeHashAddLeaf(
+    _Inout_                                         PSYMCRYPT_SHA256_TREE_HASH_STATE    pState,
+    _In_reads_( SYMCRYPT_SHA256_RESULT_SIZE )       PCBYTE                              pbLeafHash )
+{
+    SYMCRYPT_SHA256_TREE_HASH_LEVEL   * pLevel;
+    BYTE                                node[SYMCRYPT_SHA256_RESULT_SIZE];
+    UINT32                              iLevel;
+
+    memcpy( node, pbLeafHash, SYMCRYPT_SHA256_RESULT_SIZE );
+    pState->nLeaves++;
+
+    for( iLevel = 0; ; iLevel++ )
+    {
+        //
+        // The caller has checked that the tree does not grow beyond the maximum depth.
+        //
+        SYMCRYPT_ASSERT( iLevel < SYMCRYPT_SHA256_TREE_HASH_MAX_LEVELS );
+        pLevel = &pState->level[iLevel];
+
+        if( pLevel->nChildren == 0 )
+        {
+            SymCryptSha256TreeHashInitNode( &pState->params, TREE_HASH_NODE_PREFIX, &pLevel->node );
+            memcpy( pLevel->firstChild, node, SYMCRYPT_SHA256_RESULT_SIZE );
+        }
+
+        SymCryptSha256Append( &pLevel->node, node, SYMCRYPT_SHA256_RESULT_SIZE );
+        pLevel->nChildren++;
+
+        if( iLevel >= pState->nLevels )
+        {
+            pState->nLevels = iLevel + 1;
+        }
+
+        if( pLevel->nChildren < pState->params.fanOut )
+        {
+            break;
+        }
+
+        SymCryptSha256Result( &pLevel->node, node );
+        pLevel->nChildren = 0;
+    }
+}
+
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptSha256TreeHashAppend(
+    _Inout_                     PSYMCRYPT_SHA256_TREE_HASH_STATE    pState,
+    _In_reads_( cbData )        PCBYTE                              pbData,
+                                SIZE_T                              cbData,
+    _Out_writes_( cbScratch )   PBYTE                               pbScratch,
+                                SIZE_T                              cbScratch )
+{
+    BYTE    leafHashes[SYMCRYPT_SHA256_TREE_HASH_BATCH * SYMCRYPT_SHA256_RESULT_SIZE];
+    SIZE_T  cbLeaf;
+    SIZE_T  todo;
+    SIZE_T  nBatch;
+    SIZE_T  i;
+    UINT64  nLeaves;
+
+    SYMCRYPT_CHECK_MAGIC( pState );
+
+    if( cbScratch < SYMCRYPT_SHA256_TREE_HASH_SCRATCH )
+    {
+        SymCryptFatal( 'thsc' );
+    }
+
+    cbLeaf = pState->params.cbLeaf;
+
+    //
+    // Check that the completed leaves fit in a tree of the maximum depth.
+    // A node is added to the level beyond the last one when the number of leaves reaches fanOut^MAX_LEVELS.
+    //
+    nLeaves = pState->nLeaves + cbData / cbLeaf + (cbData % cbLeaf >= cbLeaf - pState->cbLeafData);
+    for( i=0; i<SYMCRYPT_SHA256_TREE_HASH_MAX_LEVELS; i++ )
+    {
+        nLeaves /= pState->params.fanOut;
+    }
+    if( nLeaves != 0 )
+    {
+        return SYMCRYPT_INVALID_ARGUMENT;
+    }
+
+    //
+    // Complete the current partial leaf
+    //
+    if( pState->cbLeafData > 0 )
+    {
+        todo = SYMCRYPT_MIN( cbData, cbLeaf - pState->cbLeafData );
+        SymCryptSha256Append( &pState->leaf, pbData, todo );
+        pbData += todo;
+        cbData -= todo;
+        pState->cbLeafData += todo;
+
+        if( pState->cbLeafData == cbLeaf )
+        {
+            SymCryptSha256Result( &pState->leaf, leafHashes );
+            SymCryptSha256TreeHashInitNode( &pState->params, TREE_HASH_LEAF_PREFIX, &pState->leaf );
+            pState->cbLeafData = 0;
+            SymCryptSha256TreeHashAddLeaf( pState, leafHashes );
+        }
+    }
+
+    //
+    // Whole leaves are hashed in parallel
+    //
+    while( cbData >= cbLeaf )
+    {
+        nBatch = SYMCRYPT_MIN( cbData / cbLeaf, SYMCRYPT_SHA256_TREE_HASH_BATCH );
+
+        SymCryptSha256TreeHashNodes( &pState->params, TREE_HASH_LEAF_PREFIX, pbData, nBatch * cbLeaf, cbLeaf, nBatch, leafHashes, pbScratch );
+
+        for( i=0; i<nBatch; i++ )
+        {
+            SymCryptSha256TreeHashAddLeaf( pState, &leafHashes[i * SYMCRYPT_SHA256_RESULT_SIZE] );
+        }
+
+        pbData += nBatch * cbLeaf;
+        cbData -= nBatch * cbLeaf;
+    }
+
+    //
+    // The rest starts a new leaf
+    //
+    if( cbData > 0 )
+    {
+        SymCryptSha256Append( &pState->leaf, pbData, cbData );
+        pState->cbLeafData = cbData;
+    }
+
+    return SYMCRYPT_NO_ERROR;
+}
+
+VOID
+SYMCRYPT_CALL
+SymCryptSha256TreeHashResult(
+    _In_                                        PCSYMCRYPT_SHA256_TREE_HASH_STATE   pState,
+    _Out_writes_( SYMCRYPT_SHA256_RESULT_SIZE ) PBYTE                               pbResult )
+{
+    SYMCRYPT_SHA256_STATE                   hashState;
+    const SYMCRYPT_SHA256_TREE_HASH_LEVEL * pLevel;
+    BYTE                                    node[SYMCRYPT_SHA256_RESULT_SIZE];
+    BOOLEAN                                 haveNode;
+    UINT32                                  iLevel;
+
+    SYMCRYPT_CHECK_MAGIC( pState );
+
+    //
+    // We finish the tree bottom-up without modifying the state.
+    // At each level, the last group consists of the running node's children plus the node
+    // carried up from the level below, if any.
+    //
+    haveNode = FALSE;
+    if( pState->cbLeafData > 0 || pState->nLeaves == 0 )
+    {
+        SymCryptSha256StateCopy( &pState->leaf, &hashState );
+        SymCryptSha256Result( &hashState, node );
+        haveNode = TRUE;
+    }
+
+    for( iLevel = 0; iLevel < pState->nLevels; iLevel++ )
+    {
+        pLevel = &pState->level[iLevel];
+
+        if( pLevel->nChildren == 0 )
+        {
+            // Either nothing to do at this level, or a single node that is promoted.
+            continue;
+        }
+
+        if( pLevel->nChildren == 1 && !haveNode )
+        {
+            memcpy( node, pLevel->firstChild, SYMCRYPT_SHA256_RESULT_SIZE );
+            haveNode = TRUE;
+            continue;
+        }
+
+        SymCryptSha256StateCopy( &pLevel->node, &hashState );
+        if( haveNode )
+        {
+            SymCryptSha256Append( &hashState, node, SYMCRYPT_SHA256_RESULT_SIZE );
+        }
+        SymCryptSha256Result( &hashState, node );
+        haveNode = TRUE;
+    }
+
+    SYMCRYPT_ASSERT( haveNode );
+    memcpy( pbResult, node, SYMCRYPT_SHA256_RESULT_SIZE );
+
+    SymCryptWipeKnownSize( &hashState, sizeof( hashState ) );
+}
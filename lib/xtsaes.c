@@ -510,6 +510,8 @@ SymCryptXtsAesDecrypt(
     _Out_writes_( cbData )  PBYTE                           pbDst,
                             SIZE_T                          cbData )
 {
+    SymCryptAesEnsureDecryptionRoundKeys( &pExpandedKey->key1 );
+
 #if SYMCRYPT_CPU_AMD64
     if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
     {
@@ -542,6 +544,161 @@ SymCryptXtsAesDecrypt(
 #endif
 }
 
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+//
+// Encrypt or decrypt data units with AES-NI. The tweaks are always encrypted, with key2; 
+// bEncrypt selects the direction of the data unit kernels, which use key1.
+//
+static
+VOID
+SYMCRYPT_CALL
+SymCryptXtsAesDataUnitsXmm(
+    _In_                            PCSYMCRYPT_XTS_AES_EXPANDED_KEY pExpandedKey,
+                                    SIZE_T                          cbDataUnit,
+    _In_reads_( nDataUnits )        PCSYMCRYPT_XTS_AES_DATA_UNIT    pDataUnits,
+                                    SIZE_T                          nDataUnits,
+                                    BOOLEAN                         bEncrypt )
+{
+    SYMCRYPT_ALIGN BYTE     tweakBuf[N_PARALLEL_TWEAKS * SYMCRYPT_AES_BLOCK_SIZE];
+    SIZE_T                  nTweaks;
+    SIZE_T                  i;
+
+    SYMCRYPT_ASSERT( (cbDataUnit & (SYMCRYPT_AES_BLOCK_SIZE - 1)) == 0 );
+
+    cbDataUnit &= ~(SYMCRYPT_AES_BLOCK_SIZE - 1);
+
+    while( nDataUnits > 0 )
+    {
+        //
+        // Encrypt the tweaks of up to N_PARALLEL_TWEAKS data units in parallel.
+        //
+        nTweaks = min( nDataUnits, N_PARALLEL_TWEAKS );
+        for( i=0; i<nTweaks; i++ )
+        {
+            SYMCRYPT_STORE_LSBFIRST64(&tweakBuf[i * SYMCRYPT_AES_BLOCK_SIZE    ], pDataUnits[i].tweak);
+            SYMCRYPT_STORE_LSBFIRST64(&tweakBuf[i * SYMCRYPT_AES_BLOCK_SIZE + 8], 0);
+        }
+
+        SymCryptAesEcbEncryptXmm( &pExpandedKey->key2, &tweakBuf[0], &tweakBuf[0], nTweaks * SYMCRYPT_AES_BLOCK_SIZE );
+
+        //
+        // Groups of 8 data units are processed side by side; any remaining ones one at a time.
+        //
+        i = 0;
+        while( i + 8 <= nTweaks )
+        {
+            if( bEncrypt )
+            {
+                SymCryptXtsAesEncrypt8DataUnitsXmm( &pExpandedKey->key1, &tweakBuf[i * SYMCRYPT_AES_BLOCK_SIZE], &pDataUnits[i], cbDataUnit );
+            } else {
+                SymCryptXtsAesDecrypt8DataUnitsXmm( &pExpandedKey->key1, &tweakBuf[i * SYMCRYPT_AES_BLOCK_SIZE], &pDataUnits[i], cbDataUnit );
+            }
+            i += 8;
+        }
+
+        while( i < nTweaks )
+        {
+            if( bEncrypt )
+            {
+                SymCryptXtsAesEncryptDataUnitXmm( &pExpandedKey->key1, &tweakBuf[i * SYMCRYPT_AES_BLOCK_SIZE], pDataUnits[i].pbSrc, pDataUnits[i].pbDst, cbDataUnit );
+            } else {
+                SymCryptXtsAesDecryptDataUnitXmm( &pExpandedKey->key1, &tweakBuf[i * SYMCRYPT_AES_BLOCK_SIZE], pDataUnits[i].pbSrc, pDataUnits[i].pbDst, cbDataUnit );
+            }
+            i++;
+        }
+
+        pDataUnits += nTweaks;
+        nDataUnits -= nTweaks;
+    }
+
+    SymCryptWipeKnownSize( tweakBuf, sizeof( tweakBuf ) );
+}
+#endif
+
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptXtsAesEncryptDataUnits(
+    _In_                            PCSYMCRYPT_XTS_AES_EXPANDED_KEY pExpandedKey,
+                                    SIZE_T                          cbDataUnit,
+    _In_reads_( nDataUnits )        PCSYMCRYPT_XTS_AES_DATA_UNIT    pDataUnits,
+                                    SIZE_T                          nDataUnits )
+{
+    SIZE_T i;
+
+    if( cbDataUnit < SYMCRYPT_AES_BLOCK_SIZE || (cbDataUnit & (SYMCRYPT_AES_BLOCK_SIZE - 1)) != 0 )
+    {
+        return SYMCRYPT_WRONG_DATA_SIZE;
+    }
+
+#if SYMCRYPT_CPU_AMD64
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
+    {
+        SymCryptXtsAesDataUnitsXmm( pExpandedKey, cbDataUnit, pDataUnits, nDataUnits, TRUE );
+        return SYMCRYPT_NO_ERROR;
+    }
+#elif SYMCRYPT_CPU_X86
+    SYMCRYPT_EXTENDED_SAVE_DATA  SaveData;
+
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) &&
+        SymCryptSaveXmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptXtsAesDataUnitsXmm( pExpandedKey, cbDataUnit, pDataUnits, nDataUnits, TRUE );
+        SymCryptRestoreXmm( &SaveData );
+        return SYMCRYPT_NO_ERROR;
+    }
+#endif
+
+    for( i=0; i<nDataUnits; i++ )
+    {
+        SymCryptXtsAesEncrypt( pExpandedKey, cbDataUnit, pDataUnits[i].tweak, pDataUnits[i].pbSrc, pDataUnits[i].pbDst, cbDataUnit );
+    }
+
+    return SYMCRYPT_NO_ERROR;
+}
+
+SYMCRYPT_ERROR
+SYMCRYPT_CALL
+SymCryptXtsAesDecryptDataUnits(
+    _In_                            PCSYMCRYPT_XTS_AES_EXPANDED_KEY pExpandedKey,
+                                    SIZE_T                          cbDataUnit,
+    _In_reads_( nDataUnits )        PCSYMCRYPT_XTS_AES_DATA_UNIT    pDataUnits,
+                                    SIZE_T                          nDataUnits )
+{
+    SIZE_T i;
+
+    if( cbDataUnit < SYMCRYPT_AES_BLOCK_SIZE || (cbDataUnit & (SYMCRYPT_AES_BLOCK_SIZE - 1)) != 0 )
+    {
+        return SYMCRYPT_WRONG_DATA_SIZE;
+    }
+
+    SymCryptAesEnsureDecryptionRoundKeys( &pExpandedKey->key1 );
+
+#if SYMCRYPT_CPU_AMD64
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) )
+    {
+        SymCryptXtsAesDataUnitsXmm( pExpandedKey, cbDataUnit, pDataUnits, nDataUnits, FALSE );
+        return SYMCRYPT_NO_ERROR;
+    }
+#elif SYMCRYPT_CPU_X86
+    SYMCRYPT_EXTENDED_SAVE_DATA  SaveData;
+
+    if( SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) &&
+        SymCryptSaveXmm( &SaveData ) == SYMCRYPT_NO_ERROR )
+    {
+        SymCryptXtsAesDataUnitsXmm( pExpandedKey, cbDataUnit, pDataUnits, nDataUnits, FALSE );
+        SymCryptRestoreXmm( &SaveData );
+        return SYMCRYPT_NO_ERROR;
+    }
+#endif
+
+    for( i=0; i<nDataUnits; i++ )
+    {
+        SymCryptXtsAesDecrypt( pExpandedKey, cbDataUnit, pDataUnits[i].tweak, pDataUnits[i].pbSrc, pDataUnits[i].pbDst, cbDataUnit );
+    }
+
+    return SYMCRYPT_NO_ERROR;
+}
+
 VOID
 SYMCRYPT_CALL
 SymCryptXtsUpdateTweak(
@@ -639,6 +796,63 @@ SymCryptXtsDecryptDataUnit(
     }
 }
 
+#if SYMCRYPT_CPU_AMD64
+//
+// XTS on one data unit using the bitsliced AES code, for CPUs without AES-NI.
+// The tweak values of 8 blocks are computed first, then the blocks are processed together.
+//
+VOID
+SYMCRYPT_CALL
+SymCryptXtsAesDataUnitBitslice(
+    _In_                                    PCSYMCRYPT_AES_EXPANDED_KEY pExpandedKey,
+                                            BOOLEAN                     bEncrypt,
+    _Inout_updates_(SYMCRYPT_AES_BLOCK_SIZE)PBYTE                       pbTweakBlock,
+    _In_reads_( cbData )                    PCBYTE                      pbSrc,
+    _Out_writes_( cbData )                  PBYTE                       pbDst,
+                                            SIZE_T                      cbData )
+{
+    SYMCRYPT_AES_BITSLICE_KEY   bsKey;
+    BYTE                        tweaks[SYMCRYPT_AES_BITSLICE_BLOCKS * SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                        buf[SYMCRYPT_AES_BITSLICE_BLOCKS * SYMCRYPT_AES_BLOCK_SIZE];
+    SIZE_T                      cbChunk;
+    SIZE_T                      i;
+
+    SymCryptAesBitsliceExpandKey( pExpandedKey, &bsKey );
+
+    cbData &= ~(SIZE_T)(SYMCRYPT_AES_BLOCK_SIZE - 1);
+
+    while( cbData > 0 )
+    {
+        cbChunk = min( cbData, sizeof( buf ) );
+
+        for( i=0; i<cbChunk; i += SYMCRYPT_AES_BLOCK_SIZE )
+        {
+            memcpy( &tweaks[i], pbTweakBlock, SYMCRYPT_AES_BLOCK_SIZE );
+            SymCryptXtsUpdateTweak( pbTweakBlock );
+        }
+
+        SymCryptXorBytes( pbSrc, tweaks, buf, cbChunk );
+
+        if( bEncrypt )
+        {
+            SymCryptAesBitsliceEcbEncrypt( &bsKey, buf, buf, cbChunk );
+        } else {
+            SymCryptAesBitsliceEcbDecrypt( &bsKey, buf, buf, cbChunk );
+        }
+
+        SymCryptXorBytes( buf, tweaks, pbDst, cbChunk );
+
+        pbSrc += cbChunk;
+        pbDst += cbChunk;
+        cbData -= cbChunk;
+    }
+
+    SymCryptWipeKnownSize( &bsKey, sizeof( bsKey ) );
+    SymCryptWipeKnownSize( tweaks, sizeof( tweaks ) );
+    SymCryptWipeKnownSize( buf, sizeof( buf ) );
+}
+#endif
+
 VOID
 SYMCRYPT_CALL
 SymCryptXtsAesEncryptDataUnitAsm(
@@ -648,6 +862,15 @@ SymCryptXtsAesEncryptDataUnitAsm(
     _Out_writes_( cbData )                  PBYTE                       pbDst,
                                             SIZE_T                      cbData )
 {
+#if SYMCRYPT_CPU_AMD64
+    if( cbData >= SYMCRYPT_AES_BITSLICE_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AES_BITSLICE_CODE ) )
+    {
+        SymCryptXtsAesDataUnitBitslice( pExpandedKey, TRUE, pbTweakBlock, pbSrc, pbDst, cbData );
+        return;
+    }
+#endif
+
     SYMCRYPT_ASSERT( SymCryptAesBlockCipherNoOpt.blockSize == SYMCRYPT_AES_BLOCK_SIZE ); // keep Prefast happy
     SymCryptXtsEncryptDataUnit( 
             &SymCryptAesBlockCipherNoOpt,
@@ -667,6 +890,15 @@ SymCryptXtsAesDecryptDataUnitAsm(
     _Out_writes_( cbData )                  PBYTE                       pbDst,
                                             SIZE_T                      cbData )
 {
+#if SYMCRYPT_CPU_AMD64
+    if( cbData >= SYMCRYPT_AES_BITSLICE_MIN_BYTES &&
+        SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AES_BITSLICE_CODE ) )
+    {
+        SymCryptXtsAesDataUnitBitslice( pExpandedKey, FALSE, pbTweakBlock, pbSrc, pbDst, cbData );
+        return;
+    }
+#endif
+
     SYMCRYPT_ASSERT( SymCryptAesBlockCipherNoOpt.blockSize == SYMCRYPT_AES_BLOCK_SIZE ); // keep Prefast happy
     SymCryptXtsDecryptDataUnit( 
             &SymCryptAesBlockCipherNoOpt,
@@ -76,6 +76,8 @@ public:
 };
 
 BString katParseData( KAT_ITEM & item, LPCSTR name );
+
+BString katParseData( String data, LONGLONG line );
     //
     // Turn a string notation into a binary string.
     // There are several encodings used:
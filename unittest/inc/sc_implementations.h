@@ -99,6 +99,20 @@ public:
     _Field_range_(0, MAX_PARALLEL_HASH_STATES)  SIZE_T                      nHashes;
 };
 
+template<>
+class ParallelHashImpState<ImpSc, AlgParallelSha1> {
+public:
+                                                SYMCRYPT_SHA1_STATE         sc[MAX_PARALLEL_HASH_STATES];
+    _Field_range_(0, MAX_PARALLEL_HASH_STATES)  SIZE_T                      nHashes;
+};
+
+template<>
+class ParallelHashImpState<ImpSc, AlgParallelMd5> {
+public:
+                                                SYMCRYPT_MD5_STATE          sc[MAX_PARALLEL_HASH_STATES];
+    _Field_range_(0, MAX_PARALLEL_HASH_STATES)  SIZE_T                      nHashes;
+};
+
 
 template<>
 class MacImpState<ImpSc, AlgHmacMd5> {
@@ -471,6 +471,18 @@ public:
     static WCHAR * pwstrBasename;
 };
 
+class AlgParallelSha1{
+public:
+    static char * name;
+    static WCHAR * pwstrBasename;
+};
+
+class AlgParallelMd5{
+public:
+    static char * name;
+    static WCHAR * pwstrBasename;
+};
+
 class AlgPbkdf2{
 public:
     static char * name;
@@ -607,6 +619,31 @@ public:
     static char * name;
 };
 
+class AlgParallelAesCmac{
+public:
+    static char * name;
+};
+
+class AlgSha256Batch{
+public:
+    static char * name;
+};
+
+class AlgSha256Loop{
+public:
+    static char * name;
+};
+
+class AlgAesDecryptionKey{
+public:
+    static char * name;
+};
+
+class AlgAesCompactKey{
+public:
+    static char * name;
+};
+
 class AlgIEEE802_11SaeCustom{
 public:
     static char * name;
@@ -948,6 +985,16 @@ randomTestGetSubstringPosition( _In_reads_( bufSize )  PCBYTE buf,
                                 _Out_                   SIZE_T * pos,
                                 _Out_                   SIZE_T * len );
 
+SIZE_T
+randomIovec(
+    _In_reads_( cbData )            PBYTE           pbData,
+                                    SIZE_T          cbData,
+    _Out_writes_( maxFragments )    PSYMCRYPT_IOVEC pFragments,
+                                    SIZE_T          maxFragments );
+//
+// Split a buffer into a random list of fragments, some of which may be empty.
+// Returns the number of fragments used.
+//
 
 VOID measurePerf( AlgorithmImplementation * pAlgImp );
 
@@ -102,6 +102,12 @@ WCHAR * AlgParallelSha384::pwstrBasename = L"SHA384";
 char * AlgParallelSha512::name = "ParSha512";
 WCHAR * AlgParallelSha512::pwstrBasename = L"SHA512";
 
+char * AlgParallelSha1::name = "ParSha1";
+WCHAR * AlgParallelSha1::pwstrBasename = L"SHA1";
+
+char * AlgParallelMd5::name = "ParMd5";
+WCHAR * AlgParallelMd5::pwstrBasename = L"MD5";
+
 char * AlgPbkdf2::name = "Pbkdf2";
 
 char * AlgSp800_108::name = "Sp800_108";
@@ -144,6 +150,16 @@ char * AlgModExp::name = "ModExp";
 
 char * AlgScsTable::name = "ScsTable";
 
+char * AlgParallelAesCmac::name = "ParAesCmac";
+
+char * AlgSha256Batch::name = "Sha256Batch";
+
+char * AlgSha256Loop::name = "Sha256Loop";
+
+char * AlgAesDecryptionKey::name = "AesDecKey";
+
+char * AlgAesCompactKey::name = "AesCompactKey";
+
 char * AlgIEEE802_11SaeCustom::name = "IEEE802_11SaeCustom";
 
 char * AlgTrialDivision::name = "TrialDivision";
@@ -458,6 +474,8 @@ char * g_algorithmNames[] = {
     AlgParallelSha256::name,
     AlgParallelSha384::name,
     AlgParallelSha512::name,
+    AlgParallelSha1::name,
+    AlgParallelMd5::name,
     AlgPbkdf2::name,
     AlgSp800_108::name,
     AlgTlsPrf1_1::name,
@@ -479,6 +497,11 @@ char * g_algorithmNames[] = {
     AlgModInv::name,
     AlgModExp::name,
     AlgScsTable::name,
+    AlgParallelAesCmac::name,
+    AlgSha256Batch::name,
+    AlgSha256Loop::name,
+    AlgAesDecryptionKey::name,
+    AlgAesCompactKey::name,
     AlgIEEE802_11SaeCustom::name,
     AlgTrialDivision::name,
     AlgTrialDivisionContext::name,
@@ -611,6 +634,9 @@ const CPU_FEATURE_DATA g_cpuFeatureData[] =
     { "shani", SYMCRYPT_CPU_FEATURE_SHANI },
     { "adx", SYMCRYPT_CPU_FEATURE_ADX },
     { "bmi2", SYMCRYPT_CPU_FEATURE_BMI2 },
+    { "vaes", SYMCRYPT_CPU_FEATURE_VAES },
+    { "vpclmulqdq", SYMCRYPT_CPU_FEATURE_VPCLMULQDQ },
+    { "avx512", SYMCRYPT_CPU_FEATURE_AVX512 },
 #elif SYMCRYPT_CPU_ARM64
     { "neon", SYMCRYPT_CPU_FEATURE_NEON },
     { "i_aes", SYMCRYPT_CPU_FEATURE_NEON_AES },
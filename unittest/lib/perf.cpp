@@ -184,7 +184,7 @@ const ALG_MEASURE_PARAMS g_algMeasureParams[] =
     "Md2"                   , 0, {}, {64, 128, 256, 512, 1024, (1<<13) },
     "Md4"                   , 0, {}, {64, 128, 256, 512, 1024, (1<<14) },
     "Md5"                   , 0, {}, {64, 128, 256, 512, 1024, (1<<14) },
-    "Sha1"                  , 0, {}, {64, 128, 256, 512, 1024, (1<<14) },
+    "Sha1"                  , 0, {}, {20, 64, 128, 256, 512, 1024, 4096, (1<<14) },   // run with -shani to compare against the scalar code
     "Sha256"                , 0, {}, {64, 128, 256, 512, 1024, (1<<13) },
     "Sha384"                , 0, {}, {128, 256, 512, 1024, (1<<13) },
     "Sha512"                , 0, {}, {128, 256, 512, 1024, (1<<13) },
@@ -198,6 +198,8 @@ const ALG_MEASURE_PARAMS g_algMeasureParams[] =
     "AesEcb"                , 0, {16,24,32}, {112, 512, 1024, 2048, 4096,},
     "AesCbc"                , 0, {16,24,32}, {128, 256, 512, 1024, 2048, 4096,}, // start at 128 bytes as that is the breaking point on SaveXmm save/restore
     "AesCfb"                , 0, {16,24,32}, {16, 32, 48, 64, 128, 256, 512, 1024,},
+    "AesDecKey"             , 0, {16,24,32}, {},                        // key expansion including decryption round keys
+    "AesCompactKey"         , 0, {16,24,32}, {16, 64, 256},             // fixed cost is the compact key load
     "DesEcb"                , 0, {8}, {8,16,24,32,64,128,256,1024},
     "DesCbc"                , 0, {8}, {8,16,24,32,64,128,256,1024},
     "DesCfb"                , 0, {8}, {8,16,24,32,64,128,256,1024},
@@ -223,6 +225,9 @@ const ALG_MEASURE_PARAMS g_algMeasureParams[] =
     "ParSha256"             , 0, {}, {1024,1 << 14},
     "ParSha384"             , 0, {}, {1024,1 << 14},
     "ParSha512"             , 0, {}, {1024,1 << 14},
+    "ParAesCmac"            , 0, {16,24,32}, {128, 256, 512, 1024},    // total over 8 messages
+    "Sha256Batch"           , 0, {}, {512, 1024, 2048},                 // total over 16 messages
+    "Sha256Loop"            , 0, {}, {512, 1024, 2048},                 // same messages with separate SymCryptSha256 calls
     "Pbkdf2HmacMd5"         , 0, {32}, {16, 128, 512},
     "Pbkdf2HmacSha1"        , 0, {32}, {20, 100, 500},
     "Pbkdf2HmacSha256"      , 0, {32}, {32, 128, 512},
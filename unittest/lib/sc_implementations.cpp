@@ -2416,6 +2416,322 @@ ParallelHashImp<ImpSc, AlgParallelSha512>::initWithLongMessage( ULONGLONG nBytes
 }
 
 
+template<>
+VOID
+algImpKeyPerfFunction<ImpSc,AlgParallelSha1>( PBYTE buf1, PBYTE buf2, PBYTE buf3, SIZE_T dataSize )
+{
+    UNREFERENCED_PARAMETER( buf2 );
+    UNREFERENCED_PARAMETER( buf3 );
+    UNREFERENCED_PARAMETER( dataSize );
+
+    SymCryptParallelSha1Init( (PSYMCRYPT_SHA1_STATE) buf1, N_PARALLEL_FOR_PERF );
+}
+
+template<>
+VOID
+algImpCleanPerfFunction<ImpSc,AlgParallelSha1>( PBYTE buf1, PBYTE buf2, PBYTE buf3 )
+{
+    UNREFERENCED_PARAMETER( buf1 );
+    UNREFERENCED_PARAMETER( buf2 );
+    UNREFERENCED_PARAMETER( buf3 );
+}
+
+template<>
+VOID
+algImpDataPerfFunction<ImpSc,AlgParallelSha1>( PBYTE buf1, PBYTE buf2, PBYTE buf3, SIZE_T dataSize )
+{
+    int i;
+    PSYMCRYPT_SHA1_STATE pState = (PSYMCRYPT_SHA1_STATE) buf1;
+    PSYMCRYPT_PARALLEL_HASH_OPERATION pOperations = (PSYMCRYPT_PARALLEL_HASH_OPERATION) buf2;
+    PSYMCRYPT_PARALLEL_HASH_OPERATION pOp = pOperations;
+
+    PBYTE pSrc = buf3;
+    PBYTE pDst = buf3 + PERF_BUFFER_SIZE / 2;
+
+    for( i=0; i<N_PARALLEL_FOR_PERF; i++ )
+    {
+        pOp->iHash = i;
+        pOp->hashOperation = SYMCRYPT_HASH_OPERATION_APPEND;
+        pOp->pbBuffer = pSrc;
+        pOp->cbBuffer = dataSize / N_PARALLEL_FOR_PERF;
+
+        pOp++;
+        pSrc += dataSize / N_PARALLEL_FOR_PERF;
+
+        pOp->iHash = i;
+        pOp->hashOperation = SYMCRYPT_HASH_OPERATION_RESULT;
+        pOp->pbBuffer = pDst;
+        pOp->cbBuffer = 20;
+
+        pOp++;
+        pDst += 20;
+    }
+    SymCryptParallelSha1Process( pState, N_PARALLEL_FOR_PERF, pOperations, 2*N_PARALLEL_FOR_PERF, buf1 + PERF_BUFFER_SIZE / 2, PERF_BUFFER_SIZE / 2 );
+}
+
+template<>
+ParallelHashImp<ImpSc, AlgParallelSha1>::ParallelHashImp() 
+{
+    m_perfDataFunction = &algImpDataPerfFunction <ImpSc, AlgParallelSha1>;
+    m_perfKeyFunction  = &algImpKeyPerfFunction  <ImpSc, AlgParallelSha1>;
+    m_perfCleanFunction= &algImpCleanPerfFunction<ImpSc, AlgParallelSha1>;
+
+    state.nHashes = 0;
+};
+
+template<>
+ParallelHashImp<ImpSc, AlgParallelSha1>::~ParallelHashImp() {};
+
+template<>
+PCSYMCRYPT_HASH
+ParallelHashImp<ImpSc, AlgParallelSha1>::SymCryptHash()
+{
+    return SymCryptSha1Algorithm;
+}
+
+template<>
+SIZE_T ParallelHashImp<ImpSc, AlgParallelSha1>::resultLen() 
+{
+    return SYMCRYPT_SHA1_RESULT_SIZE;
+}
+
+template<>
+SIZE_T ParallelHashImp<ImpSc, AlgParallelSha1>::inputBlockLen() 
+{
+    return SYMCRYPT_SHA1_INPUT_BLOCK_SIZE;
+}
+
+
+template<>
+VOID
+ParallelHashImp<ImpSc, AlgParallelSha1>::init( SIZE_T nHashes ) 
+{
+    CHECK( nHashes <= MAX_PARALLEL_HASH_STATES, "Too many hash states requested" );
+    state.nHashes = nHashes;
+
+    initYmmRegisters();
+    SymCryptParallelSha1Init( &state.sc[0], nHashes );
+    verifyYmmRegisters();
+}
+
+template<>
+VOID
+ParallelHashImp<ImpSc, AlgParallelSha1>::process( 
+        _In_reads_( nOperations )   BCRYPT_MULTI_HASH_OPERATION *   pOperations,
+                                    SIZE_T                          nOperations )
+{
+    SYMCRYPT_PARALLEL_HASH_OPERATION    op[MAX_PARALLEL_HASH_OPERATIONS];
+    BYTE                                scratch[SYMCRYPT_PARALLEL_SHA1_FIXED_SCRATCH + SYMCRYPT_PARALLEL_HASH_PER_STATE_SCRATCH * MAX_PARALLEL_HASH_STATES + 128];
+
+    CHECK( nOperations <= MAX_PARALLEL_HASH_OPERATIONS, "Too many operations" );
+
+    for( SIZE_T i=0; i<nOperations; i++ )
+    {
+        op[i].iHash = pOperations[i].iHash;
+        op[i].hashOperation = pOperations[i].hashOperation == BCRYPT_HASH_OPERATION_HASH_DATA ? SYMCRYPT_HASH_OPERATION_APPEND : SYMCRYPT_HASH_OPERATION_RESULT;
+        op[i].pbBuffer = pOperations[i].pbBuffer;
+        op[i].cbBuffer = pOperations[i].cbBuffer;
+
+        CHECK( op[i].iHash < state.nHashes, "?" );
+    }
+
+    SIZE_T scratchOffset = g_rng.sizet( 64 );
+    BYTE sentinel = g_rng.byte();
+    SIZE_T nScratch = SYMCRYPT_PARALLEL_SHA1_FIXED_SCRATCH + state.nHashes * SYMCRYPT_PARALLEL_HASH_PER_STATE_SCRATCH;
+    CHECK( nScratch + scratchOffset <= sizeof( scratch ), "?" );
+    _Analysis_assume_( nScratch + scratchOffset < sizeof( scratch ) );
+
+    scratch[scratchOffset + nScratch] = sentinel;
+
+    _Analysis_assume_( state.nHashes <= MAX_PARALLEL_HASH_STATES );
+    initYmmRegisters();
+    SymCryptParallelSha1Process( &state.sc[0],
+                                    state.nHashes,
+                                    &op[0],
+                                    nOperations,
+                                    &scratch[scratchOffset],
+                                    nScratch );
+    verifyYmmRegisters();
+    CHECK( scratch[scratchOffset + nScratch] == sentinel, "Parallel SHA1 used too much scratch space" );
+}
+
+template<>
+NTSTATUS
+ParallelHashImp<ImpSc, AlgParallelSha1>::initWithLongMessage( ULONGLONG nBytes )
+{
+    CHECK( nBytes % 64 == 0, "Odd bytes in initWithLongMessage" );
+    CHECK( state.nHashes <= MAX_PARALLEL_HASH_STATES, "?" );
+
+    for( SIZE_T i=0; i<state.nHashes; i++ )
+    {
+        memset( &state.sc[i].chain, 'b', sizeof( state.sc[i].chain ) );
+        state.sc[i].dataLengthL = nBytes;
+        state.sc[i].dataLengthH = 0;
+        state.sc[i].bytesInBuffer = 0;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+
+template<>
+VOID
+algImpKeyPerfFunction<ImpSc,AlgParallelMd5>( PBYTE buf1, PBYTE buf2, PBYTE buf3, SIZE_T dataSize )
+{
+    UNREFERENCED_PARAMETER( buf2 );
+    UNREFERENCED_PARAMETER( buf3 );
+    UNREFERENCED_PARAMETER( dataSize );
+
+    SymCryptParallelMd5Init( (PSYMCRYPT_MD5_STATE) buf1, N_PARALLEL_FOR_PERF );
+}
+
+template<>
+VOID
+algImpCleanPerfFunction<ImpSc,AlgParallelMd5>( PBYTE buf1, PBYTE buf2, PBYTE buf3 )
+{
+    UNREFERENCED_PARAMETER( buf1 );
+    UNREFERENCED_PARAMETER( buf2 );
+    UNREFERENCED_PARAMETER( buf3 );
+}
+
+template<>
+VOID
+algImpDataPerfFunction<ImpSc,AlgParallelMd5>( PBYTE buf1, PBYTE buf2, PBYTE buf3, SIZE_T dataSize )
+{
+    int i;
+    PSYMCRYPT_MD5_STATE pState = (PSYMCRYPT_MD5_STATE) buf1;
+    PSYMCRYPT_PARALLEL_HASH_OPERATION pOperations = (PSYMCRYPT_PARALLEL_HASH_OPERATION) buf2;
+    PSYMCRYPT_PARALLEL_HASH_OPERATION pOp = pOperations;
+
+    PBYTE pSrc = buf3;
+    PBYTE pDst = buf3 + PERF_BUFFER_SIZE / 2;
+
+    for( i=0; i<N_PARALLEL_FOR_PERF; i++ )
+    {
+        pOp->iHash = i;
+        pOp->hashOperation = SYMCRYPT_HASH_OPERATION_APPEND;
+        pOp->pbBuffer = pSrc;
+        pOp->cbBuffer = dataSize / N_PARALLEL_FOR_PERF;
+
+        pOp++;
+        pSrc += dataSize / N_PARALLEL_FOR_PERF;
+
+        pOp->iHash = i;
+        pOp->hashOperation = SYMCRYPT_HASH_OPERATION_RESULT;
+        pOp->pbBuffer = pDst;
+        pOp->cbBuffer = 16;
+
+        pOp++;
+        pDst += 16;
+    }
+    SymCryptParallelMd5Process( pState, N_PARALLEL_FOR_PERF, pOperations, 2*N_PARALLEL_FOR_PERF, buf1 + PERF_BUFFER_SIZE / 2, PERF_BUFFER_SIZE / 2 );
+}
+
+template<>
+ParallelHashImp<ImpSc, AlgParallelMd5>::ParallelHashImp() 
+{
+    m_perfDataFunction = &algImpDataPerfFunction <ImpSc, AlgParallelMd5>;
+    m_perfKeyFunction  = &algImpKeyPerfFunction  <ImpSc, AlgParallelMd5>;
+    m_perfCleanFunction= &algImpCleanPerfFunction<ImpSc, AlgParallelMd5>;
+
+    state.nHashes = 0;
+};
+
+template<>
+ParallelHashImp<ImpSc, AlgParallelMd5>::~ParallelHashImp() {};
+
+template<>
+PCSYMCRYPT_HASH
+ParallelHashImp<ImpSc, AlgParallelMd5>::SymCryptHash()
+{
+    return SymCryptMd5Algorithm;
+}
+
+template<>
+SIZE_T ParallelHashImp<ImpSc, AlgParallelMd5>::resultLen() 
+{
+    return SYMCRYPT_MD5_RESULT_SIZE;
+}
+
+template<>
+SIZE_T ParallelHashImp<ImpSc, AlgParallelMd5>::inputBlockLen() 
+{
+    return SYMCRYPT_MD5_INPUT_BLOCK_SIZE;
+}
+
+
+template<>
+VOID
+ParallelHashImp<ImpSc, AlgParallelMd5>::init( SIZE_T nHashes ) 
+{
+    CHECK( nHashes <= MAX_PARALLEL_HASH_STATES, "Too many hash states requested" );
+    state.nHashes = nHashes;
+
+    initYmmRegisters();
+    SymCryptParallelMd5Init( &state.sc[0], nHashes );
+    verifyYmmRegisters();
+}
+
+template<>
+VOID
+ParallelHashImp<ImpSc, AlgParallelMd5>::process( 
+        _In_reads_( nOperations )   BCRYPT_MULTI_HASH_OPERATION *   pOperations,
+                                    SIZE_T                          nOperations )
+{
+    SYMCRYPT_PARALLEL_HASH_OPERATION    op[MAX_PARALLEL_HASH_OPERATIONS];
+    BYTE                                scratch[SYMCRYPT_PARALLEL_MD5_FIXED_SCRATCH + SYMCRYPT_PARALLEL_HASH_PER_STATE_SCRATCH * MAX_PARALLEL_HASH_STATES + 128];
+
+    CHECK( nOperations <= MAX_PARALLEL_HASH_OPERATIONS, "Too many operations" );
+
+    for( SIZE_T i=0; i<nOperations; i++ )
+    {
+        op[i].iHash = pOperations[i].iHash;
+        op[i].hashOperation = pOperations[i].hashOperation == BCRYPT_HASH_OPERATION_HASH_DATA ? SYMCRYPT_HASH_OPERATION_APPEND : SYMCRYPT_HASH_OPERATION_RESULT;
+        op[i].pbBuffer = pOperations[i].pbBuffer;
+        op[i].cbBuffer = pOperations[i].cbBuffer;
+
+        CHECK( op[i].iHash < state.nHashes, "?" );
+    }
+
+    SIZE_T scratchOffset = g_rng.sizet( 64 );
+    BYTE sentinel = g_rng.byte();
+    SIZE_T nScratch = SYMCRYPT_PARALLEL_MD5_FIXED_SCRATCH + state.nHashes * SYMCRYPT_PARALLEL_HASH_PER_STATE_SCRATCH;
+    CHECK( nScratch + scratchOffset <= sizeof( scratch ), "?" );
+    _Analysis_assume_( nScratch + scratchOffset < sizeof( scratch ) );
+
+    scratch[scratchOffset + nScratch] = sentinel;
+
+    _Analysis_assume_( state.nHashes <= MAX_PARALLEL_HASH_STATES );
+    initYmmRegisters();
+    SymCryptParallelMd5Process( &state.sc[0],
+                                    state.nHashes,
+                                    &op[0],
+                                    nOperations,
+                                    &scratch[scratchOffset],
+                                    nScratch );
+    verifyYmmRegisters();
+    CHECK( scratch[scratchOffset + nScratch] == sentinel, "Parallel MD5 used too much scratch space" );
+}
+
+template<>
+NTSTATUS
+ParallelHashImp<ImpSc, AlgParallelMd5>::initWithLongMessage( ULONGLONG nBytes )
+{
+    CHECK( nBytes % 64 == 0, "Odd bytes in initWithLongMessage" );
+    CHECK( state.nHashes <= MAX_PARALLEL_HASH_STATES, "?" );
+
+    for( SIZE_T i=0; i<state.nHashes; i++ )
+    {
+        memset( &state.sc[i].chain, 'b', sizeof( state.sc[i].chain ) );
+        state.sc[i].dataLengthL = nBytes;
+        state.sc[i].dataLengthH = 0;
+        state.sc[i].bytesInBuffer = 0;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 //  XTS-AES
@@ -3495,6 +3811,222 @@ ArithImp<ImpSc, AlgScsTable>::~ArithImp()
 {
 }
 
+//============================
+// The data size is the total over N_PARALLEL_FOR_PERF messages, as for the parallel hashes.
+template<>
+VOID
+algImpKeyPerfFunction<ImpSc, AlgParallelAesCmac>( PBYTE buf1, PBYTE buf2, PBYTE buf3, SIZE_T keySize )
+{
+    UNREFERENCED_PARAMETER( buf2 );
+
+    SymCryptAesCmacExpandKey( (PSYMCRYPT_AES_CMAC_EXPANDED_KEY) buf1, buf3, keySize );
+}
+
+template<>
+VOID
+algImpCleanPerfFunction<ImpSc,AlgParallelAesCmac>( PBYTE buf1, PBYTE buf2, PBYTE buf3 )
+{
+    UNREFERENCED_PARAMETER( buf2 );
+    UNREFERENCED_PARAMETER( buf3 );
+
+    SymCryptWipeKnownSize( buf1, sizeof( SYMCRYPT_AES_CMAC_EXPANDED_KEY ) );
+}
+
+template<>
+VOID
+algImpDataPerfFunction< ImpSc, AlgParallelAesCmac>( PBYTE buf1, PBYTE buf2, PBYTE buf3, SIZE_T dataSize )
+{
+    PSYMCRYPT_PARALLEL_AES_CMAC_OPERATION pOps = (PSYMCRYPT_PARALLEL_AES_CMAC_OPERATION) buf2;
+    SIZE_T cbMsg = dataSize / N_PARALLEL_FOR_PERF;
+
+    for( SIZE_T i=0; i<N_PARALLEL_FOR_PERF; i++ )
+    {
+        pOps[i].pExpandedKey = (PCSYMCRYPT_AES_CMAC_EXPANDED_KEY) buf1;
+        pOps[i].pbData = buf3 + i * cbMsg;
+        pOps[i].cbData = cbMsg;
+        pOps[i].pbResult = buf3 + PERF_BUFFER_SIZE/2 + i * SYMCRYPT_AES_CMAC_RESULT_SIZE;
+    }
+
+    SymCryptParallelAesCmac( pOps, N_PARALLEL_FOR_PERF );
+}
+
+template<>
+ArithImp<ImpSc, AlgParallelAesCmac>::ArithImp()
+{
+    m_perfDataFunction      = &algImpDataPerfFunction <ImpSc, AlgParallelAesCmac>;
+    m_perfDecryptFunction   = NULL;
+    m_perfKeyFunction       = &algImpKeyPerfFunction  <ImpSc, AlgParallelAesCmac>;
+    m_perfCleanFunction     = &algImpCleanPerfFunction<ImpSc, AlgParallelAesCmac>;
+}
+
+template<>
+ArithImp<ImpSc, AlgParallelAesCmac>::~ArithImp()
+{
+}
+
+//============================
+// Key setup cost of an AES key that is used for decryption, i.e. including the creation
+// of the decryption round keys. Compare with the key cost of plain AES.
+template<>
+VOID
+algImpKeyPerfFunction<ImpSc, AlgAesDecryptionKey>( PBYTE buf1, PBYTE buf2, PBYTE buf3, SIZE_T keySize )
+{
+    SymCryptAesExpandKey( (PSYMCRYPT_AES_EXPANDED_KEY) buf1, buf3, keySize );
+    SymCryptAesDecrypt( (PCSYMCRYPT_AES_EXPANDED_KEY) buf1, buf2, buf2 );
+}
+
+template<>
+VOID
+algImpCleanPerfFunction<ImpSc,AlgAesDecryptionKey>( PBYTE buf1, PBYTE buf2, PBYTE buf3 )
+{
+    UNREFERENCED_PARAMETER( buf2 );
+    UNREFERENCED_PARAMETER( buf3 );
+
+    SymCryptWipeKnownSize( buf1, sizeof( SYMCRYPT_AES_EXPANDED_KEY ) );
+}
+
+template<>
+ArithImp<ImpSc, AlgAesDecryptionKey>::ArithImp()
+{
+    m_perfDataFunction      = NULL;
+    m_perfDecryptFunction   = NULL;
+    m_perfKeyFunction       = &algImpKeyPerfFunction  <ImpSc, AlgAesDecryptionKey>;
+    m_perfCleanFunction     = &algImpCleanPerfFunction<ImpSc, AlgAesDecryptionKey>;
+}
+
+template<>
+ArithImp<ImpSc, AlgAesDecryptionKey>::~ArithImp()
+{
+}
+
+//============================
+// The key is a compact key; the data function loads it into an expanded key and
+// encrypts the data, so the fixed cost is the cost of loading a compact key.
+template<>
+VOID
+algImpKeyPerfFunction<ImpSc, AlgAesCompactKey>( PBYTE buf1, PBYTE buf2, PBYTE buf3, SIZE_T keySize )
+{
+    UNREFERENCED_PARAMETER( buf2 );
+
+    SymCryptAesExpandKeyCompact( (PSYMCRYPT_AES_COMPACT_EXPANDED_KEY) buf1, buf3, keySize );
+}
+
+template<>
+VOID
+algImpCleanPerfFunction<ImpSc,AlgAesCompactKey>( PBYTE buf1, PBYTE buf2, PBYTE buf3 )
+{
+    UNREFERENCED_PARAMETER( buf3 );
+
+    SymCryptWipeKnownSize( buf1, sizeof( SYMCRYPT_AES_COMPACT_EXPANDED_KEY ) );
+    SymCryptWipeKnownSize( buf2, sizeof( SYMCRYPT_AES_EXPANDED_KEY ) );
+}
+
+template<>
+VOID
+algImpDataPerfFunction< ImpSc, AlgAesCompactKey>( PBYTE buf1, PBYTE buf2, PBYTE buf3, SIZE_T dataSize )
+{
+    SymCryptAesCompactKeyLoad( (PCSYMCRYPT_AES_COMPACT_EXPANDED_KEY) buf1, (PSYMCRYPT_AES_EXPANDED_KEY) buf2 );
+    SymCryptAesEcbEncrypt( (PCSYMCRYPT_AES_EXPANDED_KEY) buf2, buf3, buf3, dataSize );
+}
+
+template<>
+ArithImp<ImpSc, AlgAesCompactKey>::ArithImp()
+{
+    m_perfDataFunction      = &algImpDataPerfFunction <ImpSc, AlgAesCompactKey>;
+    m_perfDecryptFunction   = NULL;
+    m_perfKeyFunction       = &algImpKeyPerfFunction  <ImpSc, AlgAesCompactKey>;
+    m_perfCleanFunction     = &algImpCleanPerfFunction<ImpSc, AlgAesCompactKey>;
+}
+
+template<>
+ArithImp<ImpSc, AlgAesCompactKey>::~ArithImp()
+{
+}
+
+//============================
+// SymCryptHashBatch on N_HASH_BATCH_FOR_PERF messages, and the same messages hashed with separate
+// SymCryptSha256 calls for comparison. The data size is the total over all messages.
+#define N_HASH_BATCH_FOR_PERF   SYMCRYPT_HASH_BATCH_LANES
+
+template<>
+VOID
+algImpKeyPerfFunction<ImpSc, AlgSha256Batch>( PBYTE buf1, PBYTE buf2, PBYTE buf3, SIZE_T keySize )
+{
+    UNREFERENCED_PARAMETER( buf1 );
+    UNREFERENCED_PARAMETER( buf2 );
+    UNREFERENCED_PARAMETER( buf3 );
+    UNREFERENCED_PARAMETER( keySize );
+}
+
+template<>
+VOID
+algImpCleanPerfFunction<ImpSc,AlgSha256Batch>( PBYTE buf1, PBYTE buf2, PBYTE buf3 )
+{
+    UNREFERENCED_PARAMETER( buf1 );
+    UNREFERENCED_PARAMETER( buf2 );
+    UNREFERENCED_PARAMETER( buf3 );
+}
+
+template<>
+VOID
+algImpDataPerfFunction< ImpSc, AlgSha256Batch>( PBYTE buf1, PBYTE buf2, PBYTE buf3, SIZE_T dataSize )
+{
+    PCBYTE * ppbData = (PCBYTE *) buf2;
+    SIZE_T * pcbData = (SIZE_T *) (buf2 + N_HASH_BATCH_FOR_PERF * sizeof( PCBYTE ));
+    SIZE_T cbMsg = dataSize / N_HASH_BATCH_FOR_PERF;
+
+    for( SIZE_T i=0; i<N_HASH_BATCH_FOR_PERF; i++ )
+    {
+        ppbData[i] = buf3 + i * cbMsg;
+        pcbData[i] = cbMsg;
+    }
+
+    SymCryptHashBatch( SymCryptSha256Algorithm, ppbData, pcbData, N_HASH_BATCH_FOR_PERF, buf3 + PERF_BUFFER_SIZE/2, buf1, SYMCRYPT_HASH_BATCH_SCRATCH );
+}
+
+template<>
+ArithImp<ImpSc, AlgSha256Batch>::ArithImp()
+{
+    m_perfDataFunction      = &algImpDataPerfFunction <ImpSc, AlgSha256Batch>;
+    m_perfDecryptFunction   = NULL;
+    m_perfKeyFunction       = &algImpKeyPerfFunction  <ImpSc, AlgSha256Batch>;
+    m_perfCleanFunction     = &algImpCleanPerfFunction<ImpSc, AlgSha256Batch>;
+}
+
+template<>
+ArithImp<ImpSc, AlgSha256Batch>::~ArithImp()
+{
+}
+
+template<>
+VOID
+algImpDataPerfFunction< ImpSc, AlgSha256Loop>( PBYTE buf1, PBYTE buf2, PBYTE buf3, SIZE_T dataSize )
+{
+    SIZE_T cbMsg = dataSize / N_HASH_BATCH_FOR_PERF;
+
+    UNREFERENCED_PARAMETER( buf1 );
+    UNREFERENCED_PARAMETER( buf2 );
+
+    for( SIZE_T i=0; i<N_HASH_BATCH_FOR_PERF; i++ )
+    {
+        SymCryptSha256( buf3 + i * cbMsg, cbMsg, buf3 + PERF_BUFFER_SIZE/2 + i * SYMCRYPT_SHA256_RESULT_SIZE );
+    }
+}
+
+template<>
+ArithImp<ImpSc, AlgSha256Loop>::ArithImp()
+{
+    m_perfDataFunction      = &algImpDataPerfFunction <ImpSc, AlgSha256Loop>;
+    m_perfDecryptFunction   = NULL;
+    m_perfKeyFunction       = &algImpKeyPerfFunction  <ImpSc, AlgSha256Batch>;
+    m_perfCleanFunction     = &algImpCleanPerfFunction<ImpSc, AlgSha256Batch>;
+}
+
+template<>
+ArithImp<ImpSc, AlgSha256Loop>::~ArithImp()
+{
+}
+
 //============================
 // The DeveloperTest algorithm is just for tests during active development.
 
@@ -5609,6 +6141,8 @@ addSymCryptAlgs()
     addImplementationToGlobalList<ParallelHashImp<ImpSc, AlgParallelSha256>>();
     addImplementationToGlobalList<ParallelHashImp<ImpSc, AlgParallelSha384>>();
     addImplementationToGlobalList<ParallelHashImp<ImpSc, AlgParallelSha512>>();
+    addImplementationToGlobalList<ParallelHashImp<ImpSc, AlgParallelSha1>>();
+    addImplementationToGlobalList<ParallelHashImp<ImpSc, AlgParallelMd5>>();
 
     addImplementationToGlobalList<XtsImp<ImpSc, AlgXtsAes>>();
 
@@ -5655,6 +6189,11 @@ addSymCryptAlgs()
     addImplementationToGlobalList<ArithImp<ImpSc, AlgModInv>>();
 
     addImplementationToGlobalList<ArithImp<ImpSc, AlgScsTable>>();
+    addImplementationToGlobalList<ArithImp<ImpSc, AlgParallelAesCmac>>();
+    addImplementationToGlobalList<ArithImp<ImpSc, AlgSha256Batch>>();
+    addImplementationToGlobalList<ArithImp<ImpSc, AlgSha256Loop>>();
+    addImplementationToGlobalList<ArithImp<ImpSc, AlgAesDecryptionKey>>();
+    addImplementationToGlobalList<ArithImp<ImpSc, AlgAesCompactKey>>();
 
     addImplementationToGlobalList<RsaImp<ImpSc, AlgRsaEncRaw>>();
     addImplementationToGlobalList<RsaImp<ImpSc, AlgRsaDecRaw>>();
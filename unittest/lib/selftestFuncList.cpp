@@ -51,6 +51,9 @@ const SELFTEST_INFO g_selfTests[] =
     {&SymCryptRngAesGenerateSelftest, "AesCtrDrbgGenerate"},
     {&SymCryptPbkdf2_HmacSha1SelfTest, "Pbkdf2_HmacSha1"},
     {&SymCryptPbkdf2_HmacSha256SelfTest, "Pbkdf2_HmacSha256"},
+    {&SymCryptParallelPbkdf2HmacSha1Selftest, "ParallelPbkdf2HmacSha1"},
+    {&SymCryptParallelPbkdf2HmacSha256Selftest, "ParallelPbkdf2HmacSha256"},
+    {&SymCryptParallelPbkdf2HmacSha512Selftest, "ParallelPbkdf2HmacSha512"},
     {&SymCryptSp800_108_HmacSha1SelfTest, "SP800-108_HmacSha1" },
     {&SymCryptSp800_108_HmacSha256SelfTest, "SP800-108_HmacSha256" },
     {&SymCryptTlsPrf1_1SelfTest, "TLS PRF 1.1" },
@@ -60,6 +63,11 @@ const SELFTEST_INFO g_selfTests[] =
     {&SymCryptParallelSha256Selftest, "ParallelSha256" },
     {&SymCryptParallelSha384Selftest, "ParallelSha384" },
     {&SymCryptParallelSha512Selftest, "ParallelSha512" },
+    {&SymCryptParallelSha1Selftest, "ParallelSha1" },
+    {&SymCryptParallelMd5Selftest, "ParallelMd5" },
+    {&SymCryptParallelHmacSha256Selftest, "ParallelHmacSha256" },
+    {&SymCryptParallelHmacSha384Selftest, "ParallelHmacSha384" },
+    {&SymCryptParallelHmacSha512Selftest, "ParallelHmacSha512" },
     
     {NULL, NULL},
 };
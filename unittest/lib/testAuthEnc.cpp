@@ -573,10 +573,656 @@ testAuthEncKats()
     }
 }
 
+//
+// GCM test cases with nonces that are not 12 bytes long, from
+// "The Galois/Counter Mode of Operation (GCM)" by David McGrew & John Viega, test cases 5, 6, 11, 12, 17, and 18.
+// These are not in the KAT file as most of the other implementations only support 12-byte nonces.
+//
+typedef struct _GCM_NONCE_TEST_CASE {
+    PCSTR   key;
+    PCSTR   nonce;
+    PCSTR   ciphertext;
+    PCSTR   tag;
+} GCM_NONCE_TEST_CASE;
+
+const GCM_NONCE_TEST_CASE g_gcmNonceTestCases[] = {
+    {   "feffe9928665731c6d6a8f9467308308",
+        "cafebabefacedbad",
+        "61353b4c2806934a777ff51fa22a4755699b2a714fcdc6f83766e5f97b6c742373806900e49f24b22b097544d4896b424989b5e1ebac0f07c23f4598",
+        "3612d2e79e3b0785561be14aaca2fccb" },
+    {   "feffe9928665731c6d6a8f9467308308",
+        "9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318a728c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39b",
+        "8ce24998625615b603a033aca13fb894be9112a5c3a211a8ba262a3cca7e2ca701e4a9a4fba43c90ccdcb281d48c7c6fd62875d2aca417034c34aee5",
+        "619cc5aefffe0bfa462af43c1699d050" },
+    {   "feffe9928665731c6d6a8f9467308308feffe9928665731c",
+        "cafebabefacedbad",
+        "0f10f599ae14a154ed24b36e25324db8c566632ef2bbb34f8347280fc4507057fddc29df9a471f75c66541d4d4dad1c9e93a19a58e8b473fa0f062f7",
+        "65dcc57fcf623a24094fcca40d3533f8" },
+    {   "feffe9928665731c6d6a8f9467308308feffe9928665731c",
+        "9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318a728c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39b",
+        "d27e88681ce3243c4830165a8fdcf9ff1de9a1d8e6b447ef6ef7b79828666e4581e79012af34ddd9e2f037589b292db3e67c036745fa22e7e9b7373b",
+        "dcf566ff291c25bbb8568fc3d376a6d9" },
+    {   "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308",
+        "cafebabefacedbad",
+        "c3762df1ca787d32ae47c13bf19844cbaf1ae14d0b976afac52ff7d79bba9de0feb582d33934a4f0954cc2363bc73f7862ac430e64abe499f47c9b1f",
+        "3a337dbf46a792c45e454913fe2ea8f2" },
+    {   "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308",
+        "9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318a728c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39b",
+        "5a8def2f0c9e53f1f75d7853659e2a20eeb2b22aafde6419a058ab4f6f746bf40fc0c3b780f244452da3ebf1c5d82cdea2418997200ef82e44ae7e3f",
+        "a44a8266ee1c8eb0c8b5d4cf5ae9f19a" },
+};
+
+VOID
+testGcmNonceSizes()
+{
+    SYMCRYPT_GCM_EXPANDED_KEY   key;
+    SYMCRYPT_GCM_STATE          state;
+    BYTE                        buf[64];
+    BYTE                        tag[16];
+    SIZE_T                      i;
+    SIZE_T                      cbPart;
+
+    if( !isAlgorithmPresent( "AesGcm", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    GcmNonceSizes" );
+
+    BString plaintext = katParseData( "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39", 0 );
+    BString authData = katParseData( "feedfacedeadbeeffeedfacedeadbeefabaddad2", 0 );
+
+    CHECK( SymCryptGcmValidateParameters( SymCryptAesBlockCipher, 0, 0, 0, 16 ) == SYMCRYPT_WRONG_NONCE_SIZE, "Empty GCM nonce accepted" );
+
+    for( i=0; i<ARRAY_SIZE( g_gcmNonceTestCases ); i++ )
+    {
+        BString katKey = katParseData( g_gcmNonceTestCases[i].key, 0 );
+        BString katNonce = katParseData( g_gcmNonceTestCases[i].nonce, 0 );
+        BString katCiphertext = katParseData( g_gcmNonceTestCases[i].ciphertext, 0 );
+        BString katTag = katParseData( g_gcmNonceTestCases[i].tag, 0 );
+
+        CHECK( plaintext.size() <= sizeof( buf ) && katTag.size() == sizeof( tag ), "?" );
+        CHECK3( SymCryptGcmValidateParameters( SymCryptAesBlockCipher, katNonce.size(), authData.size(), plaintext.size(), katTag.size() ) == SYMCRYPT_NO_ERROR,
+                "GCM nonce size %d rejected", katNonce.size() );
+
+        CHECK( SymCryptGcmExpandKey( &key, SymCryptAesBlockCipher, katKey.data(), katKey.size() ) == SYMCRYPT_NO_ERROR, "?" );
+
+        SymCryptGcmEncrypt( &key, katNonce.data(), katNonce.size(), authData.data(), authData.size(),
+                            plaintext.data(), buf, plaintext.size(), tag, sizeof( tag ) );
+        CHECK3( memcmp( buf, katCiphertext.data(), katCiphertext.size() ) == 0, "GCM ciphertext mismatch in nonce test case %d", i );
+        CHECK3( memcmp( tag, katTag.data(), katTag.size() ) == 0, "GCM tag mismatch in nonce test case %d", i );
+
+        //
+        // Incremental decryption with a random split
+        //
+        cbPart = g_rng.sizet( katCiphertext.size() + 1 );
+        SymCryptGcmInit( &state, &key, katNonce.data(), katNonce.size() );
+        SymCryptGcmAuthPart( &state, authData.data(), authData.size() );
+        SymCryptGcmDecryptPart( &state, katCiphertext.data(), buf, cbPart );
+        SymCryptGcmDecryptPart( &state, katCiphertext.data() + cbPart, buf + cbPart, katCiphertext.size() - cbPart );
+        CHECK3( SymCryptGcmDecryptFinal( &state, katTag.data(), katTag.size() ) == SYMCRYPT_NO_ERROR, "GCM tag failure in nonce test case %d", i );
+        CHECK3( memcmp( buf, plaintext.data(), plaintext.size() ) == 0, "GCM plaintext mismatch in nonce test case %d", i );
+    }
+
+    iprint( "\n" );
+}
+
+#define BATCH_TEST_MAX_RECORDS  (12)
+#define BATCH_TEST_MAX_DATA     (300)
+
+const BYTE g_batchTestZeroes[BATCH_TEST_MAX_DATA] = { 0 };
+
+//
+// Test the batched record functions against the single-record functions.
+// We use more records than the batch code processes at once, and tamper with some records when decrypting.
+//
+VOID
+testAuthEncBatch( BOOL bGcm )
+{
+    SYMCRYPT_GCM_EXPANDED_KEY   gcmKey;
+    SYMCRYPT_AES_EXPANDED_KEY   aesKey;
+    SYMCRYPT_AUTHENC_RECORD     records[BATCH_TEST_MAX_RECORDS];
+    SYMCRYPT_ERROR              results[BATCH_TEST_MAX_RECORDS];
+    BOOL                        tampered[BATCH_TEST_MAX_RECORDS];
+    BYTE                        nonces[BATCH_TEST_MAX_RECORDS][16];
+    BYTE                        authData[BATCH_TEST_MAX_RECORDS][32];
+    BYTE                        plaintext[BATCH_TEST_MAX_RECORDS][BATCH_TEST_MAX_DATA];
+    BYTE                        ciphertext[BATCH_TEST_MAX_RECORDS][BATCH_TEST_MAX_DATA];
+    BYTE                        buf[BATCH_TEST_MAX_RECORDS][BATCH_TEST_MAX_DATA];
+    BYTE                        tags[BATCH_TEST_MAX_RECORDS][16];
+    BYTE                        batchTags[BATCH_TEST_MAX_RECORDS][16];
+    BYTE                        key[32];
+    SIZE_T                      cbKey;
+    SIZE_T                      nRecords;
+    SIZE_T                      i;
+    SIZE_T                      j;
+    SYMCRYPT_ERROR              status;
+    BOOL                        anyTampered;
+
+    if( !isAlgorithmPresent( bGcm ? "AesGcm" : "AesCcm", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( bGcm ? "    GcmBatch" : "    CcmBatch" );
+
+    for( j=0; j<100; j++ )
+    {
+        cbKey = 16 + 8 * g_rng.sizet( 3 );
+        GENRANDOM( key, (ULONG) cbKey );
+        CHECK( SymCryptAesExpandKey( &aesKey, key, cbKey ) == SYMCRYPT_NO_ERROR, "?" );
+        CHECK( SymCryptGcmExpandKey( &gcmKey, SymCryptAesBlockCipher, key, cbKey ) == SYMCRYPT_NO_ERROR, "?" );
+
+        nRecords = g_rng.sizet( BATCH_TEST_MAX_RECORDS + 1 );
+        for( i=0; i<nRecords; i++ )
+        {
+            records[i].cbNonce = bGcm ? 12 : 7 + g_rng.sizet( 7 );
+            records[i].cbAuthData = g_rng.sizet( sizeof( authData[i] ) + 1 );
+            records[i].cbData = g_rng.sizetNonUniform( BATCH_TEST_MAX_DATA + 1, 32, 1 );
+            records[i].cbTag = bGcm ? 12 + g_rng.sizet( 5 ) : 4 + 2 * g_rng.sizet( 7 );
+
+            GENRANDOM( nonces[i], (ULONG) records[i].cbNonce );
+            GENRANDOM( authData[i], (ULONG) records[i].cbAuthData );
+            GENRANDOM( plaintext[i], (ULONG) records[i].cbData );
+
+            if( bGcm )
+            {
+                SymCryptGcmEncrypt( &gcmKey, nonces[i], records[i].cbNonce, authData[i], records[i].cbAuthData,
+                                    plaintext[i], ciphertext[i], records[i].cbData, tags[i], records[i].cbTag );
+            } else {
+                SymCryptCcmEncrypt( SymCryptAesBlockCipher, &aesKey, nonces[i], records[i].cbNonce, authData[i], records[i].cbAuthData,
+                                    plaintext[i], ciphertext[i], records[i].cbData, tags[i], records[i].cbTag );
+            }
+
+            //
+            // Alternate between in-place and separate buffers
+            //
+            memcpy( buf[i], plaintext[i], records[i].cbData );
+            records[i].pbNonce = nonces[i];
+            records[i].pbAuthData = authData[i];
+            records[i].pbSrc = (i & 1) ? buf[i] : plaintext[i];
+            records[i].pbDst = buf[i];
+            records[i].pbTag = batchTags[i];
+        }
+
+        if( bGcm )
+        {
+            SymCryptGcmEncryptBatch( &gcmKey, records, nRecords );
+        } else {
+            SymCryptCcmEncryptBatch( SymCryptAesBlockCipher, &aesKey, records, nRecords );
+        }
+
+        anyTampered = FALSE;
+        for( i=0; i<nRecords; i++ )
+        {
+            CHECK3( memcmp( buf[i], ciphertext[i], records[i].cbData ) == 0, "Batch ciphertext mismatch in record %d", i );
+            CHECK3( memcmp( batchTags[i], tags[i], records[i].cbTag ) == 0, "Batch tag mismatch in record %d", i );
+
+            memcpy( buf[i], ciphertext[i], records[i].cbData );
+            records[i].pbSrc = buf[i];
+            records[i].pbTag = tags[i];
+
+            tampered[i] = g_rng.byte() < 32;
+            anyTampered |= tampered[i];
+            if( tampered[i] )
+            {
+                tags[i][ g_rng.sizet( records[i].cbTag ) ] ^= (BYTE)(1 + g_rng.sizet( 255 ));
+            }
+        }
+
+        if( bGcm )
+        {
+            status = SymCryptGcmDecryptBatch( &gcmKey, records, nRecords, results );
+        } else {
+            status = SymCryptCcmDecryptBatch( SymCryptAesBlockCipher, &aesKey, records, nRecords, results );
+        }
+
+        CHECK( (status == SYMCRYPT_NO_ERROR) == !anyTampered, "Wrong batch decryption result" );
+        for( i=0; i<nRecords; i++ )
+        {
+            if( tampered[i] )
+            {
+                CHECK3( results[i] == SYMCRYPT_AUTHENTICATION_FAILURE, "Tampered record %d accepted", i );
+                CHECK3( memcmp( buf[i], g_batchTestZeroes, records[i].cbData ) == 0, "Tampered record %d not wiped", i );
+            } else {
+                CHECK3( results[i] == SYMCRYPT_NO_ERROR, "Record %d rejected", i );
+                CHECK3( memcmp( buf[i], plaintext[i], records[i].cbData ) == 0, "Batch plaintext mismatch in record %d", i );
+            }
+        }
+    }
+
+    iprint( "\n" );
+}
+
+#define IOVEC_TEST_MAX_DATA         (600)
+#define IOVEC_TEST_MAX_FRAGMENTS    (40)
+
+//
+// Test the scatter/gather functions against the contiguous ones with random fragment lists.
+//
+VOID
+testAuthEncIovec( BOOL bGcm )
+{
+    SYMCRYPT_GCM_EXPANDED_KEY   gcmKey;
+    SYMCRYPT_AES_EXPANDED_KEY   aesKey;
+    SYMCRYPT_IOVEC              src[IOVEC_TEST_MAX_FRAGMENTS];
+    SYMCRYPT_IOVEC              dst[IOVEC_TEST_MAX_FRAGMENTS];
+    SIZE_T                      nSrc;
+    SIZE_T                      nDst;
+    BYTE                        plaintext[IOVEC_TEST_MAX_DATA];
+    BYTE                        ciphertext[IOVEC_TEST_MAX_DATA];
+    BYTE                        buf[IOVEC_TEST_MAX_DATA];
+    BYTE                        nonce[13];
+    BYTE                        authData[20];
+    BYTE                        tag[16];
+    BYTE                        iovecTag[16];
+    BYTE                        key[32];
+    SIZE_T                      cbKey;
+    SIZE_T                      cbNonce;
+    SIZE_T                      cbData;
+    SYMCRYPT_ERROR              status;
+    SIZE_T                      i;
+
+    if( !isAlgorithmPresent( bGcm ? "AesGcm" : "AesCcm", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( bGcm ? "    GcmIovec" : "    CcmIovec" );
+
+    for( i=0; i<200; i++ )
+    {
+        cbKey = 16 + 8 * g_rng.sizet( 3 );
+        GENRANDOM( key, (ULONG) cbKey );
+        CHECK( SymCryptAesExpandKey( &aesKey, key, cbKey ) == SYMCRYPT_NO_ERROR, "?" );
+        CHECK( SymCryptGcmExpandKey( &gcmKey, SymCryptAesBlockCipher, key, cbKey ) == SYMCRYPT_NO_ERROR, "?" );
+
+        cbNonce = bGcm ? 12 : 7 + g_rng.sizet( 7 );
+        cbData = g_rng.sizet( IOVEC_TEST_MAX_DATA + 1 );
+        GENRANDOM( nonce, sizeof( nonce ) );
+        GENRANDOM( authData, sizeof( authData ) );
+        GENRANDOM( plaintext, (ULONG) cbData );
+
+        if( bGcm )
+        {
+            SymCryptGcmEncrypt( &gcmKey, nonce, cbNonce, authData, sizeof( authData ), plaintext, ciphertext, cbData, tag, sizeof( tag ) );
+        } else {
+            SymCryptCcmEncrypt( SymCryptAesBlockCipher, &aesKey, nonce, cbNonce, authData, sizeof( authData ), 
+                                plaintext, ciphertext, cbData, tag, sizeof( tag ) );
+        }
+
+        //
+        // Encrypt either in place, or between independently fragmented buffers
+        //
+        if( g_rng.byte() & 1 )
+        {
+            memcpy( buf, plaintext, cbData );
+            nSrc = randomIovec( buf, cbData, src, ARRAY_SIZE( src ) );
+            memcpy( dst, src, nSrc * sizeof( src[0] ) );
+            nDst = nSrc;
+        } else {
+            nSrc = randomIovec( plaintext, cbData, src, ARRAY_SIZE( src ) );
+            nDst = randomIovec( buf, cbData, dst, ARRAY_SIZE( dst ) );
+        }
+
+        if( bGcm )
+        {
+            SymCryptGcmEncryptIovec( &gcmKey, nonce, cbNonce, authData, sizeof( authData ), src, nSrc, dst, nDst, iovecTag, sizeof( iovecTag ) );
+        } else {
+            SymCryptCcmEncryptIovec( SymCryptAesBlockCipher, &aesKey, nonce, cbNonce, authData, sizeof( authData ), 
+                                     src, nSrc, dst, nDst, iovecTag, sizeof( iovecTag ) );
+        }
+
+        CHECK( memcmp( buf, ciphertext, cbData ) == 0, "Iovec ciphertext mismatch" );
+        CHECK( memcmp( iovecTag, tag, sizeof( tag ) ) == 0, "Iovec tag mismatch" );
+
+        //
+        // Decrypt in place, possibly with a modified tag
+        //
+        nDst = randomIovec( buf, cbData, dst, ARRAY_SIZE( dst ) );
+        if( g_rng.byte() < 64 )
+        {
+            tag[ g_rng.sizet( sizeof( tag ) ) ] ^= (BYTE)(1 + g_rng.sizet( 255 ));
+            SymCryptWipe( plaintext, cbData );
+        }
+
+        if( bGcm )
+        {
+            status = SymCryptGcmDecryptIovec( &gcmKey, nonce, cbNonce, authData, sizeof( authData ), dst, nDst, dst, nDst, tag, sizeof( tag ) );
+        } else {
+            status = SymCryptCcmDecryptIovec( SymCryptAesBlockCipher, &aesKey, nonce, cbNonce, authData, sizeof( authData ), 
+                                              dst, nDst, dst, nDst, tag, sizeof( tag ) );
+        }
+
+        CHECK( (status == SYMCRYPT_NO_ERROR) == (memcmp( iovecTag, tag, sizeof( tag ) ) == 0), "Wrong iovec decryption result" );
+        CHECK( memcmp( buf, plaintext, cbData ) == 0, "Iovec plaintext mismatch" );
+    }
+
+    iprint( "\n" );
+}
+
+#define CCM_PARTS_TEST_MAX_DATA     (1000)
+
+//
+// Test the optimized AES-CCM part functions against the generic CCM code,
+// with the data split into random pieces.
+//
+VOID
+testAesCcmOptimizedParts()
+{
+    SYMCRYPT_AES_EXPANDED_KEY   key;
+    SYMCRYPT_BLOCKCIPHER        genericCipher;
+    SYMCRYPT_CCM_STATE          state;
+    BYTE                        keyBuf[32];
+    BYTE                        nonce[13];
+    BYTE                        authData[40];
+    BYTE                        plaintext[CCM_PARTS_TEST_MAX_DATA];
+    BYTE                        ciphertext[CCM_PARTS_TEST_MAX_DATA];
+    BYTE                        buf[CCM_PARTS_TEST_MAX_DATA];
+    BYTE                        tag[16];
+    BYTE                        partsTag[16];
+    SIZE_T                      cbNonce;
+    SIZE_T                      cbAuthData;
+    SIZE_T                      cbData;
+    SIZE_T                      offset;
+    SIZE_T                      cb;
+    BOOL                        bEncrypt;
+
+    if( !isAlgorithmPresent( "AesCcm", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    AesCcmParts" );
+
+    genericCipher = *SymCryptAesBlockCipher;
+    genericCipher.ccmEncryptPartFunc = NULL;
+    genericCipher.ccmDecryptPartFunc = NULL;
+
+    for( int iTest = 0; iTest < 1000; iTest++ )
+    {
+        GENRANDOM( keyBuf, sizeof( keyBuf ) );
+        SymCryptAesExpandKey( &key, keyBuf, 16 + 8 * g_rng.sizet( 3 ) );
+
+        cbNonce = 7 + g_rng.sizet( 7 );
+        cbAuthData = g_rng.sizet( sizeof( authData ) + 1 );
+        cbData = g_rng.sizetNonUniform( CCM_PARTS_TEST_MAX_DATA + 1, 32, 1 );
+        GENRANDOM( nonce, sizeof( nonce ) );
+        GENRANDOM( authData, sizeof( authData ) );
+        GENRANDOM( plaintext, (ULONG) cbData );
+
+        SymCryptCcmEncrypt( &genericCipher, &key, nonce, cbNonce, authData, cbAuthData, plaintext, ciphertext, cbData, tag, sizeof( tag ) );
+
+        //
+        // Encrypt or decrypt with the optimized functions, in random pieces.
+        // The last piece of a decryption is done in place.
+        //
+        bEncrypt = (g_rng.byte() & 1) != 0;
+        SymCryptCcmInit( &state, SymCryptAesBlockCipher, &key, nonce, cbNonce, authData, cbAuthData, cbData, sizeof( tag ) );
+        offset = 0;
+        while( offset < cbData )
+        {
+            cb = g_rng.sizetNonUniform( cbData - offset + 1, 16, 1 );
+            if( bEncrypt )
+            {
+                SymCryptCcmEncryptPart( &state, &plaintext[offset], &buf[offset], cb );
+            } else if( offset + cb < cbData )
+            {
+                SymCryptCcmDecryptPart( &state, &ciphertext[offset], &buf[offset], cb );
+            } else {
+                memcpy( &buf[offset], &ciphertext[offset], cb );
+                SymCryptCcmDecryptPart( &state, &buf[offset], &buf[offset], cb );
+            }
+            offset += cb;
+        }
+
+        if( bEncrypt )
+        {
+            SymCryptCcmEncryptFinal( &state, partsTag, sizeof( partsTag ) );
+            CHECK( memcmp( buf, ciphertext, cbData ) == 0, "AES-CCM ciphertext mismatch" );
+            CHECK( memcmp( partsTag, tag, sizeof( tag ) ) == 0, "AES-CCM tag mismatch" );
+        } else {
+            CHECK( SymCryptCcmDecryptFinal( &state, tag, sizeof( tag ) ) == SYMCRYPT_NO_ERROR, "AES-CCM tag mismatch" );
+            CHECK( memcmp( buf, plaintext, cbData ) == 0, "AES-CCM plaintext mismatch" );
+        }
+    }
+
+    iprint( "\n" );
+}
+
+#define GCM_PATHS_TEST_MAX_DATA     (3 * 4096 + 100)
+
+//
+// Sizes around the thresholds of the AES-GCM dispatch: the stitched kernel works on 16-block chunks,
+// the VAES/VPCLMULQDQ code starts at 32 blocks and runs in 4 kB chunks.
+//
+static const SIZE_T g_gcmPathsTestSizes[] = {
+    0, 1, 16, 100, 255, 256, 257, 511, 512, 513, 600, 4095, 4096, 4112, 5000, GCM_PATHS_TEST_MAX_DATA,
+};
+
+typedef struct _GCM_PATHS_TEST_PATH {
+    LPCSTR                  name;
+    SYMCRYPT_CPU_FEATURES   required;       // features the path needs to run
+    SYMCRYPT_CPU_FEATURES   disable;        // features we disable to force the path
+} GCM_PATHS_TEST_PATH;
+
+static const GCM_PATHS_TEST_PATH g_gcmPathsTestPaths[] = {
+    { "wide",       SYMCRYPT_CPU_FEATURES_FOR_VAES_512_CODE | SYMCRYPT_CPU_FEATURES_FOR_VPCLMULQDQ_CODE,    0 },
+    { "stitched",   SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE | SYMCRYPT_CPU_FEATURES_FOR_PCLMULQDQ_CODE,        SYMCRYPT_CPU_FEATURE_VAES },
+    { "separate",   0,                                                                                  SYMCRYPT_CPU_FEATURE_PCLMULQDQ },
+};
+
+//
+// Test each code path of the AES-GCM part functions against GCM over the generic block cipher.
+// The paths are forced by disabling CPU features; we print the ones this CPU can run.
+//
+VOID
+testAesGcmPaths()
+{
+    SYMCRYPT_GCM_EXPANDED_KEY   key;
+    SYMCRYPT_GCM_EXPANDED_KEY   genericKey;
+    SYMCRYPT_BLOCKCIPHER        genericCipher;
+    SYMCRYPT_CPU_FEATURES       savedFeatures;
+    BYTE                        keyBuf[32];
+    BYTE                        nonce[32];
+    BYTE                        authData[40];
+    BYTE                        tag[16];
+    BYTE                        pathTag[16];
+    PBYTE                       plaintext;
+    PBYTE                       ciphertext;
+    PBYTE                       buf;
+    SIZE_T                      cbKey;
+    SIZE_T                      cbNonce;
+    SIZE_T                      cbAuthData;
+    SIZE_T                      cbData;
+
+    if( !isAlgorithmPresent( "AesGcm", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    AesGcmPaths" );
+
+    genericCipher = *SymCryptAesBlockCipher;
+    genericCipher.gcmEncryptPartFunc = NULL;
+    genericCipher.gcmDecryptPartFunc = NULL;
+
+    plaintext = new BYTE[ GCM_PATHS_TEST_MAX_DATA ];
+    ciphertext = new BYTE[ GCM_PATHS_TEST_MAX_DATA ];
+    buf = new BYTE[ GCM_PATHS_TEST_MAX_DATA ];
+
+    savedFeatures = g_SymCryptCpuFeaturesNotPresent;
+
+    for( SIZE_T iPath = 0; iPath < ARRAY_SIZE( g_gcmPathsTestPaths ); iPath++ )
+    {
+        //
+        // Ugly hack, we directly manipulate the CPU features flags.
+        //
+        g_SymCryptCpuFeaturesNotPresent = savedFeatures | g_gcmPathsTestPaths[iPath].disable;
+
+        if( !SYMCRYPT_CPU_FEATURES_PRESENT( g_gcmPathsTestPaths[iPath].required ) )
+        {
+            continue;
+        }
+
+        iprint( " %s", g_gcmPathsTestPaths[iPath].name );
+
+        for( SIZE_T iSize = 0; iSize < ARRAY_SIZE( g_gcmPathsTestSizes ); iSize++ )
+        {
+            cbKey = 16 + 8 * (iSize % 3);
+            cbData = g_gcmPathsTestSizes[iSize];
+
+            GENRANDOM( keyBuf, sizeof( keyBuf ) );
+            CHECK( SymCryptGcmExpandKey( &key, SymCryptAesBlockCipher, keyBuf, cbKey ) == SYMCRYPT_NO_ERROR, "?" );
+            CHECK( SymCryptGcmExpandKey( &genericKey, &genericCipher, keyBuf, cbKey ) == SYMCRYPT_NO_ERROR, "?" );
+
+            //
+            // Nonces that are not 12 bytes long start the 32-bit counter at a random value,
+            // which eventually covers the counter wrap-around.
+            //
+            cbNonce = (iSize & 1) ? 12 : 1 + g_rng.sizet( sizeof( nonce ) );
+            cbAuthData = g_rng.sizet( sizeof( authData ) + 1 );
+            GENRANDOM( nonce, sizeof( nonce ) );
+            GENRANDOM( authData, sizeof( authData ) );
+            GENRANDOM( plaintext, (ULONG) cbData );
+
+            SymCryptGcmEncrypt( &genericKey, nonce, cbNonce, authData, cbAuthData, plaintext, ciphertext, cbData, tag, sizeof( tag ) );
+
+            SymCryptGcmEncrypt( &key, nonce, cbNonce, authData, cbAuthData, plaintext, buf, cbData, pathTag, sizeof( pathTag ) );
+            CHECK4( memcmp( buf, ciphertext, cbData ) == 0, "AES-GCM %s ciphertext mismatch, %d bytes", g_gcmPathsTestPaths[iPath].name, (int) cbData );
+            CHECK4( memcmp( pathTag, tag, sizeof( tag ) ) == 0, "AES-GCM %s tag mismatch, %d bytes", g_gcmPathsTestPaths[iPath].name, (int) cbData );
+
+            //
+            // In-place decryption
+            //
+            CHECK4( SymCryptGcmDecrypt( &key, nonce, cbNonce, authData, cbAuthData, buf, buf, cbData, tag, sizeof( tag ) ) == SYMCRYPT_NO_ERROR,
+                    "AES-GCM %s tag failure, %d bytes", g_gcmPathsTestPaths[iPath].name, (int) cbData );
+            CHECK4( memcmp( buf, plaintext, cbData ) == 0, "AES-GCM %s plaintext mismatch, %d bytes", g_gcmPathsTestPaths[iPath].name, (int) cbData );
+        }
+    }
+
+    g_SymCryptCpuFeaturesNotPresent = savedFeatures;
+
+    delete[] plaintext;
+    delete[] ciphertext;
+    delete[] buf;
+
+    iprint( "\n" );
+}
+
+#define GCM_PARALLEL_TEST_MAX_DATA  (20 * SYMCRYPT_GCM_MIN_PARALLEL_SEGMENT_SIZE + 100)
+
+//
+// Dispatch function that runs the work items on the calling thread, in reverse order.
+//
+VOID
+SYMCRYPT_CALL
+testGcmParallelDispatch( PVOID pDispatchContext, PSYMCRYPT_WORK_ITEM_FUNC pfnWorkItem, PVOID * ppWorkItems, SIZE_T nWorkItems )
+{
+    *(SIZE_T *) pDispatchContext += nWorkItems;
+
+    for( SIZE_T i = nWorkItems; i > 0; i-- )
+    {
+        (*pfnWorkItem)( ppWorkItems[i - 1] );
+    }
+}
+
+//
+// Test the multi-threaded GCM functions against SymCryptGcmEncrypt, including nonces that are not
+// 12 bytes long as they start the 32-bit counter at a random value.
+//
+VOID
+testGcmParallel()
+{
+    SYMCRYPT_GCM_EXPANDED_KEY   key;
+    BYTE                        keyBuf[32];
+    BYTE                        nonce[32];
+    BYTE                        authData[40];
+    BYTE                        tag[16];
+    BYTE                        parTag[16];
+    PBYTE                       plaintext;
+    PBYTE                       ciphertext;
+    PBYTE                       buf;
+    SIZE_T                      cbNonce;
+    SIZE_T                      cbAuthData;
+    SIZE_T                      cbData;
+    SIZE_T                      nSegments;
+    SIZE_T                      nWorkItems = 0;
+
+    if( !isAlgorithmPresent( "AesGcm", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    GcmParallel" );
+
+    plaintext = new BYTE[ GCM_PARALLEL_TEST_MAX_DATA ];
+    ciphertext = new BYTE[ GCM_PARALLEL_TEST_MAX_DATA ];
+    buf = new BYTE[ GCM_PARALLEL_TEST_MAX_DATA ];
+
+    for( int iTest = 0; iTest < 50; iTest++ )
+    {
+        GENRANDOM( keyBuf, sizeof( keyBuf ) );
+        CHECK( SymCryptGcmExpandKey( &key, SymCryptAesBlockCipher, keyBuf, 16 + 8 * g_rng.sizet( 3 ) ) == SYMCRYPT_NO_ERROR, "?" );
+
+        cbNonce = (g_rng.byte() & 1) ? 12 : 1 + g_rng.sizet( sizeof( nonce ) );
+        cbAuthData = g_rng.sizet( sizeof( authData ) + 1 );
+        cbData = g_rng.sizet( GCM_PARALLEL_TEST_MAX_DATA + 1 );
+        nSegments = 1 + g_rng.sizet( SYMCRYPT_GCM_MAX_PARALLEL_SEGMENTS + 4 );
+        GENRANDOM( nonce, sizeof( nonce ) );
+        GENRANDOM( authData, sizeof( authData ) );
+        GENRANDOM( plaintext, (ULONG) cbData );
+
+        SymCryptGcmEncrypt( &key, nonce, cbNonce, authData, cbAuthData, plaintext, ciphertext, cbData, tag, sizeof( tag ) );
+
+        SymCryptGcmEncryptParallel( &key, nonce, cbNonce, authData, cbAuthData, plaintext, buf, cbData, parTag, sizeof( parTag ),
+                                    nSegments, &testGcmParallelDispatch, &nWorkItems );
+        CHECK( memcmp( buf, ciphertext, cbData ) == 0, "Parallel GCM ciphertext mismatch" );
+        CHECK( memcmp( parTag, tag, sizeof( tag ) ) == 0, "Parallel GCM tag mismatch" );
+
+        //
+        // In-place decryption
+        //
+        CHECK( SymCryptGcmDecryptParallel(  &key, nonce, cbNonce, authData, cbAuthData, buf, buf, cbData, tag, sizeof( tag ),
+                                            nSegments, &testGcmParallelDispatch, &nWorkItems ) == SYMCRYPT_NO_ERROR, "Parallel GCM tag failure" );
+        CHECK( memcmp( buf, plaintext, cbData ) == 0, "Parallel GCM plaintext mismatch" );
+
+        if( cbData > 0 )
+        {
+            ciphertext[ g_rng.sizet( cbData ) ] ^= 1 << (g_rng.byte() & 7);
+            CHECK( SymCryptGcmDecryptParallel(  &key, nonce, cbNonce, authData, cbAuthData, ciphertext, buf, cbData, tag, sizeof( tag ),
+                                                nSegments, &testGcmParallelDispatch, &nWorkItems ) == SYMCRYPT_AUTHENTICATION_FAILURE, 
+                    "Parallel GCM accepted modified ciphertext" );
+        }
+    }
+
+    CHECK( nWorkItems > 0, "Parallel GCM never dispatched any work" );
+
+    delete[] plaintext;
+    delete[] ciphertext;
+    delete[] buf;
+
+    iprint( "\n" );
+}
+
 VOID
 testAuthEncAlgorithms()
 {
     testAuthEncKats();
+
+    testGcmNonceSizes();
+
+    testAuthEncBatch( TRUE );
+    testAuthEncBatch( FALSE );
+
+    testAuthEncIovec( TRUE );
+    testAuthEncIovec( FALSE );
+
+    testAesCcmOptimizedParts();
+
+    testGcmParallel();
+
+    testAesGcmPaths();
 }
 
 
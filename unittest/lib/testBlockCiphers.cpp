@@ -451,10 +451,690 @@ testBlockCipherKats()
     }
 }
 
+#define PAR_CBC_MAX_OPS     20
+#define PAR_CBC_MAX_LEN     (32 * SYMCRYPT_AES_BLOCK_SIZE)
+
+VOID
+testParallelAesCbc()
+{
+    SYMCRYPT_AES_EXPANDED_KEY           keys[3];
+    SYMCRYPT_PARALLEL_AES_CBC_OPERATION ops[PAR_CBC_MAX_OPS];
+    BYTE                                keyBuf[32];
+    BYTE                                src[PAR_CBC_MAX_OPS][PAR_CBC_MAX_LEN];
+    BYTE                                dst[PAR_CBC_MAX_OPS][PAR_CBC_MAX_LEN];
+    BYTE                                ref[PAR_CBC_MAX_OPS][PAR_CBC_MAX_LEN];
+    BYTE                                chain[PAR_CBC_MAX_OPS][SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                                refChain[PAR_CBC_MAX_OPS][SYMCRYPT_AES_BLOCK_SIZE];
+    SIZE_T                              i;
+    SIZE_T                              nOps;
+    BOOLEAN                             inPlace;
+
+    if( !isAlgorithmPresent( "Aes", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    ParallelAesCbc" );
+
+    for( i=0; i<3; i++ )
+    {
+        GENRANDOM( keyBuf, sizeof( keyBuf ) );
+        SymCryptAesExpandKey( &keys[i], keyBuf, 16 + 8*i );
+    }
+
+    for( int iTest = 0; iTest < 1000; iTest++ )
+    {
+        nOps = g_rng.sizet( PAR_CBC_MAX_OPS + 1 );
+        inPlace = (g_rng.byte() & 1) != 0;
+
+        for( i=0; i<nOps; i++ )
+        {
+            ops[i].pExpandedKey = &keys[ g_rng.sizet( 3 ) ];
+            ops[i].cbData = g_rng.sizetNonUniform( PAR_CBC_MAX_LEN + 1, 32, 1 ) & ~(SYMCRYPT_AES_BLOCK_SIZE - 1);
+            GENRANDOM( src[i], (ULONG) ops[i].cbData );
+            GENRANDOM( chain[i], SYMCRYPT_AES_BLOCK_SIZE );
+            memcpy( refChain[i], chain[i], SYMCRYPT_AES_BLOCK_SIZE );
+
+            SymCryptAesCbcEncrypt( ops[i].pExpandedKey, refChain[i], src[i], ref[i], ops[i].cbData );
+
+            if( inPlace )
+            {
+                memcpy( dst[i], src[i], ops[i].cbData );
+                ops[i].pbSrc = dst[i];
+            } else {
+                ops[i].pbSrc = src[i];
+            }
+            ops[i].pbDst = dst[i];
+            ops[i].pbChainingValue = chain[i];
+        }
+
+        SymCryptParallelAesCbcEncrypt( ops, nOps );
+
+        for( i=0; i<nOps; i++ )
+        {
+            CHECK3( memcmp( dst[i], ref[i], ops[i].cbData ) == 0, "Parallel AES-CBC ciphertext mismatch in operation %d", i );
+            CHECK3( memcmp( chain[i], refChain[i], SYMCRYPT_AES_BLOCK_SIZE ) == 0, "Parallel AES-CBC chaining value mismatch in operation %d", i );
+        }
+    }
+
+    iprint( "\n" );
+}
+
+#define CTR32_MAX_LEN       (40 * SYMCRYPT_AES_BLOCK_SIZE)
+
+VOID
+testAesCtrMsb32()
+{
+    SYMCRYPT_AES_EXPANDED_KEY   key;
+    SYMCRYPT_BLOCKCIPHER        genericCipher;
+    BYTE                        keyBuf[32];
+    BYTE                        src[CTR32_MAX_LEN];
+    BYTE                        dst[CTR32_MAX_LEN];
+    BYTE                        ref[CTR32_MAX_LEN];
+    BYTE                        chain[SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                        refChain[SYMCRYPT_AES_BLOCK_SIZE];
+    SIZE_T                      cbData;
+
+    if( !isAlgorithmPresent( "Aes", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    AesCtrMsb32" );
+
+    //
+    // The generic CTR code with the optimized CTR functions removed is our reference.
+    //
+    genericCipher = *SymCryptAesBlockCipher;
+    genericCipher.ctrMsb64Func = NULL;
+    genericCipher.ctrMsb32Func = NULL;
+
+    for( int iTest = 0; iTest < 1000; iTest++ )
+    {
+        GENRANDOM( keyBuf, sizeof( keyBuf ) );
+        SymCryptAesExpandKey( &key, keyBuf, 16 + 8 * g_rng.sizet( 3 ) );
+
+        cbData = g_rng.sizetNonUniform( CTR32_MAX_LEN + 1, 32, 1 ) & ~(SYMCRYPT_AES_BLOCK_SIZE - 1);
+        GENRANDOM( src, (ULONG) cbData );
+        GENRANDOM( chain, sizeof( chain ) );
+
+        //
+        // Half of the tests start close to the 32-bit wrap-around of the counter.
+        //
+        if( (g_rng.byte() & 1) != 0 )
+        {
+            SYMCRYPT_STORE_MSBFIRST32( &chain[12], (UINT32) 0 - (UINT32) g_rng.sizet( 48 ) );
+        }
+        memcpy( refChain, chain, sizeof( chain ) );
+
+        SymCryptCtrMsb32( &genericCipher, &key, refChain, src, ref, cbData );
+
+        if( (g_rng.byte() & 1) != 0 )
+        {
+            memcpy( dst, src, cbData );
+            SymCryptAesCtrMsb32( &key, chain, dst, dst, cbData );
+        } else {
+            SymCryptAesCtrMsb32( &key, chain, src, dst, cbData );
+        }
+
+        CHECK( memcmp( dst, ref, cbData ) == 0, "AES-CTR-MSB32 output mismatch" );
+        CHECK( memcmp( chain, refChain, sizeof( chain ) ) == 0, "AES-CTR-MSB32 chaining value mismatch" );
+    }
+
+    iprint( "\n" );
+}
+
+#define CTR_IOVEC_MAX_FRAGMENTS     (32)
+
+VOID
+testAesCtrMsb64Iovec()
+{
+    SYMCRYPT_AES_EXPANDED_KEY   key;
+    SYMCRYPT_IOVEC              srcFragments[CTR_IOVEC_MAX_FRAGMENTS];
+    SYMCRYPT_IOVEC              dstFragments[CTR_IOVEC_MAX_FRAGMENTS];
+    SIZE_T                      nSrc;
+    SIZE_T                      nDst;
+    BYTE                        keyBuf[32];
+    BYTE                        src[CTR32_MAX_LEN];
+    BYTE                        dst[CTR32_MAX_LEN];
+    BYTE                        ref[CTR32_MAX_LEN];
+    BYTE                        chain[SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                        refChain[SYMCRYPT_AES_BLOCK_SIZE];
+    SIZE_T                      cbData;
+
+    if( !isAlgorithmPresent( "Aes", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    AesCtrMsb64Iovec" );
+
+    for( int iTest = 0; iTest < 1000; iTest++ )
+    {
+        GENRANDOM( keyBuf, sizeof( keyBuf ) );
+        SymCryptAesExpandKey( &key, keyBuf, 16 + 8 * g_rng.sizet( 3 ) );
+
+        cbData = g_rng.sizetNonUniform( CTR32_MAX_LEN + 1, 32, 1 ) & ~(SYMCRYPT_AES_BLOCK_SIZE - 1);
+        GENRANDOM( src, (ULONG) cbData );
+        GENRANDOM( chain, sizeof( chain ) );
+        memcpy( refChain, chain, sizeof( chain ) );
+
+        SymCryptAesCtrMsb64( &key, refChain, src, ref, cbData );
+
+        if( (g_rng.byte() & 1) != 0 )
+        {
+            memcpy( dst, src, cbData );
+            nSrc = randomIovec( dst, cbData, srcFragments, ARRAY_SIZE( srcFragments ) );
+            SymCryptAesCtrMsb64Iovec( &key, chain, srcFragments, nSrc, srcFragments, nSrc );
+        } else {
+            nSrc = randomIovec( src, cbData, srcFragments, ARRAY_SIZE( srcFragments ) );
+            nDst = randomIovec( dst, cbData, dstFragments, ARRAY_SIZE( dstFragments ) );
+            SymCryptAesCtrMsb64Iovec( &key, chain, srcFragments, nSrc, dstFragments, nDst );
+        }
+
+        CHECK( memcmp( dst, ref, cbData ) == 0, "AES-CTR iovec output mismatch" );
+        CHECK( memcmp( chain, refChain, sizeof( chain ) ) == 0, "AES-CTR iovec chaining value mismatch" );
+    }
+
+    iprint( "\n" );
+}
+
+#define AES_KEY_FORMS_MAX_LEN   (8 * SYMCRYPT_AES_BLOCK_SIZE)
+
+//
+// Decryption round keys are created on first use, and compact keys are loaded into expanded keys.
+// Check that decryption works for every way of obtaining an expanded key.
+//
+VOID
+testAesKeyForms()
+{
+    SYMCRYPT_AES_EXPANDED_KEY           key;
+    SYMCRYPT_AES_EXPANDED_KEY           tmpKey;
+    SYMCRYPT_AES_COMPACT_EXPANDED_KEY   compactKey;
+    BYTE                                keyBuf[32];
+    BYTE                                plain[AES_KEY_FORMS_MAX_LEN];
+    BYTE                                cipher[AES_KEY_FORMS_MAX_LEN];
+    BYTE                                dst[AES_KEY_FORMS_MAX_LEN];
+    BYTE                                chain[SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                                iv[SYMCRYPT_AES_BLOCK_SIZE];
+    SIZE_T                              cbKey;
+    SIZE_T                              cbData;
+
+    if( !isAlgorithmPresent( "Aes", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    AesKeyForms" );
+
+    for( int iTest = 0; iTest < 1000; iTest++ )
+    {
+        GENRANDOM( keyBuf, sizeof( keyBuf ) );
+        cbKey = 16 + 8 * g_rng.sizet( 3 );
+        cbData = SYMCRYPT_AES_BLOCK_SIZE * (1 + g_rng.sizet( AES_KEY_FORMS_MAX_LEN / SYMCRYPT_AES_BLOCK_SIZE ));
+        GENRANDOM( plain, (ULONG) cbData );
+        GENRANDOM( iv, sizeof( iv ) );
+
+        CHECK( SymCryptAesExpandKey( &tmpKey, keyBuf, cbKey ) == SYMCRYPT_NO_ERROR, "AES key expansion failed" );
+        memcpy( chain, iv, sizeof( iv ) );
+        SymCryptAesCbcEncrypt( &tmpKey, chain, plain, cipher, cbData );
+
+        switch( g_rng.byte() % 5 )
+        {
+        case 0:
+            CHECK( SymCryptAesExpandKey( &key, keyBuf, cbKey ) == SYMCRYPT_NO_ERROR, "AES key expansion failed" );
+            break;
+        case 1:
+            CHECK( SymCryptAesExpandKeyEncryptOnly( &key, keyBuf, cbKey ) == SYMCRYPT_NO_ERROR, "AES key expansion failed" );
+            break;
+        case 2:
+            // Copy of a key that has not been used for decryption yet
+            SymCryptAesKeyCopy( &tmpKey, &key );
+            break;
+        case 3:
+            // Copy of a key that has been used for decryption
+            SymCryptAesDecrypt( &tmpKey, cipher, dst );
+            SymCryptAesKeyCopy( &tmpKey, &key );
+            break;
+        case 4:
+            CHECK( SymCryptAesExpandKeyCompact( &compactKey, keyBuf, cbKey ) == SYMCRYPT_NO_ERROR, "AES compact key expansion failed" );
+            SymCryptAesCompactKeyLoad( &compactKey, &key );
+            break;
+        }
+
+        memcpy( chain, iv, sizeof( iv ) );
+        if( (g_rng.byte() & 1) != 0 )
+        {
+            SymCryptAesCbcDecrypt( &key, chain, cipher, dst, cbData );
+        } else {
+            SymCryptAesCbcEncrypt( &key, chain, plain, dst, cbData );
+            CHECK( memcmp( dst, cipher, cbData ) == 0, "AES key forms encryption mismatch" );
+
+            memcpy( chain, iv, sizeof( iv ) );
+            SymCryptAesCbcDecrypt( &key, chain, cipher, dst, cbData );
+        }
+        CHECK( memcmp( dst, plain, cbData ) == 0, "AES key forms decryption mismatch" );
+
+        // Second use of the key, now with the decryption round keys present
+        SymCryptAesDecrypt( &key, cipher, dst );
+        SymCryptXorBytes( dst, iv, dst, SYMCRYPT_AES_BLOCK_SIZE );
+        CHECK( memcmp( dst, plain, SYMCRYPT_AES_BLOCK_SIZE ) == 0, "AES key forms block decryption mismatch" );
+    }
+
+    iprint( "\n" );
+}
+
+#define AES_KEY_COPY_MAX_LEN    (40 * SYMCRYPT_AES_BLOCK_SIZE)
+
+typedef enum _AES_KEY_COPY_DECRYPT {
+    AesKeyCopyDecrypt,
+    AesKeyCopyEcbDecrypt,
+    AesKeyCopyCbcDecrypt,
+    AesKeyCopyGenericEcbDecrypt,
+    AesKeyCopyGenericCbcDecrypt,
+    AesKeyCopyNDecrypts,
+} AES_KEY_COPY_DECRYPT;
+
+//
+// Decrypt with a copy of a key that was made before the key was first used for decryption.
+// Each decryption function is the first decryption of its own copy, and the source key must not
+// be modified by the copy creating its decryption round keys.
+// We also copy a key whose decryption round keys are being created by another thread.
+//
+VOID
+testAesKeyCopyDecrypt()
+{
+    SYMCRYPT_AES_EXPANDED_KEY   key;
+    SYMCRYPT_AES_EXPANDED_KEY   keyCopy;
+    BYTE                        keyBuf[32];
+    BYTE                        plain[AES_KEY_COPY_MAX_LEN];
+    BYTE                        cipher[AES_KEY_COPY_MAX_LEN];
+    BYTE                        dst[AES_KEY_COPY_MAX_LEN];
+    BYTE                        chain[SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                        iv[SYMCRYPT_AES_BLOCK_SIZE];
+    SIZE_T                      cbKey;
+    SIZE_T                      cbData;
+
+    if( !isAlgorithmPresent( "Aes", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    AesKeyCopyDecrypt" );
+
+    for( int iTest = 0; iTest < 300; iTest++ )
+    {
+        GENRANDOM( keyBuf, sizeof( keyBuf ) );
+        cbKey = 16 + 8 * (iTest % 3);
+        cbData = SYMCRYPT_AES_BLOCK_SIZE * (1 + g_rng.sizet( AES_KEY_COPY_MAX_LEN / SYMCRYPT_AES_BLOCK_SIZE ));
+        GENRANDOM( plain, (ULONG) cbData );
+        GENRANDOM( iv, sizeof( iv ) );
+
+        CHECK( SymCryptAesExpandKey( &key, keyBuf, cbKey ) == SYMCRYPT_NO_ERROR, "AES key expansion failed" );
+        memcpy( chain, iv, sizeof( iv ) );
+        SymCryptAesCbcEncrypt( &key, chain, plain, cipher, cbData );
+
+        for( int iDecrypt = 0; iDecrypt < AesKeyCopyNDecrypts; iDecrypt++ )
+        {
+            SymCryptAesKeyCopy( &key, &keyCopy );
+
+            memcpy( chain, iv, sizeof( iv ) );
+            switch( iDecrypt )
+            {
+            case AesKeyCopyDecrypt:
+                SymCryptAesDecrypt( &keyCopy, cipher, dst );
+                SymCryptXorBytes( dst, iv, dst, SYMCRYPT_AES_BLOCK_SIZE );
+                break;
+            case AesKeyCopyEcbDecrypt:
+                SymCryptAesEcbDecrypt( &keyCopy, cipher, dst, SYMCRYPT_AES_BLOCK_SIZE );
+                SymCryptXorBytes( dst, iv, dst, SYMCRYPT_AES_BLOCK_SIZE );
+                break;
+            case AesKeyCopyCbcDecrypt:
+                SymCryptAesCbcDecrypt( &keyCopy, chain, cipher, dst, cbData );
+                break;
+            case AesKeyCopyGenericEcbDecrypt:
+                SymCryptEcbDecrypt( SymCryptAesBlockCipher, &keyCopy, cipher, dst, SYMCRYPT_AES_BLOCK_SIZE );
+                SymCryptXorBytes( dst, iv, dst, SYMCRYPT_AES_BLOCK_SIZE );
+                break;
+            case AesKeyCopyGenericCbcDecrypt:
+                SymCryptCbcDecrypt( SymCryptAesBlockCipher, &keyCopy, chain, cipher, dst, cbData );
+                break;
+            }
+
+            CHECK3( memcmp( dst, plain, iDecrypt == AesKeyCopyCbcDecrypt || iDecrypt == AesKeyCopyGenericCbcDecrypt ? cbData : SYMCRYPT_AES_BLOCK_SIZE ) == 0,
+                    "AES decryption with key copy mismatch, function %d", iDecrypt );
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+            CHECK( key.lastDecRoundKey == NULL, "AES key copy modified its source" );
+#endif
+        }
+
+#if SYMCRYPT_CPU_X86 | SYMCRYPT_CPU_AMD64
+        //
+        // Ugly hack: put the source key in the state it has while another thread writes
+        // its decryption round keys. The copy must not depend on them.
+        //
+        key.lastDecRoundKey = &key.RoundKey[0];
+        SymCryptAesKeyCopy( &key, &keyCopy );
+        key.lastDecRoundKey = NULL;
+
+        memcpy( chain, iv, sizeof( iv ) );
+        SymCryptAesCbcDecrypt( &keyCopy, chain, cipher, dst, cbData );
+        CHECK( memcmp( dst, plain, cbData ) == 0, "AES decryption with key copied during decryption key creation mismatch" );
+#endif
+
+        // The source key still decrypts after its copies did
+        memcpy( chain, iv, sizeof( iv ) );
+        SymCryptAesCbcDecrypt( &key, chain, cipher, dst, cbData );
+        CHECK( memcmp( dst, plain, cbData ) == 0, "AES decryption with source key mismatch" );
+    }
+
+    iprint( "\n" );
+}
+
+#define AES_CFB_MAX_LEN     (40 * SYMCRYPT_AES_BLOCK_SIZE)
+
+//
+// Test the AES-CFB functions against the generic CFB code, for both shift sizes.
+// The lengths are chosen to cover the 8-block/8-byte parallel code and the tails.
+//
+VOID
+testAesCfb()
+{
+    SYMCRYPT_BLOCKCIPHER        genericCipher;
+    SYMCRYPT_AES_EXPANDED_KEY   key;
+    BYTE                        keyBuf[32];
+    BYTE                        src[AES_CFB_MAX_LEN];
+    BYTE                        ref[AES_CFB_MAX_LEN];
+    BYTE                        dst[AES_CFB_MAX_LEN];
+    BYTE                        iv[SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                        refChain[SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                        chain[SYMCRYPT_AES_BLOCK_SIZE];
+    SIZE_T                      cbShift;
+    SIZE_T                      cbData;
+
+    if( !isAlgorithmPresent( "Aes", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    AesCfb" );
+
+    genericCipher = *SymCryptAesBlockCipher;
+    genericCipher.cfbEncryptFunc = NULL;
+    genericCipher.cfbDecryptFunc = NULL;
+
+    for( int iTest = 0; iTest < 1000; iTest++ )
+    {
+        GENRANDOM( keyBuf, sizeof( keyBuf ) );
+        CHECK( SymCryptAesExpandKey( &key, keyBuf, 16 + 8 * g_rng.sizet( 3 ) ) == SYMCRYPT_NO_ERROR, "AES key expansion failed" );
+
+        cbShift = (g_rng.byte() & 1) ? 1 : SYMCRYPT_AES_BLOCK_SIZE;
+        cbData = cbShift * g_rng.sizet( AES_CFB_MAX_LEN / cbShift + 1 );
+        GENRANDOM( src, (ULONG) cbData );
+        GENRANDOM( iv, sizeof( iv ) );
+
+        memcpy( refChain, iv, sizeof( iv ) );
+        memcpy( chain, iv, sizeof( iv ) );
+        memcpy( dst, src, cbData );
+
+        if( (g_rng.byte() & 1) != 0 )
+        {
+            SymCryptCfbEncrypt( &genericCipher, cbShift, &key, refChain, src, ref, cbData );
+            SymCryptAesCfbEncrypt( &key, cbShift, chain, dst, dst, cbData );
+        } else {
+            SymCryptCfbDecrypt( &genericCipher, cbShift, &key, refChain, src, ref, cbData );
+            SymCryptAesCfbDecrypt( &key, cbShift, chain, dst, dst, cbData );
+        }
+
+        CHECK( memcmp( dst, ref, cbData ) == 0, "AES-CFB output mismatch" );
+        CHECK( memcmp( chain, refChain, sizeof( chain ) ) == 0, "AES-CFB chaining value mismatch" );
+    }
+
+    iprint( "\n" );
+}
+
+#define DES3_PARALLEL_MAX_BLOCKS    (13)
+
+//
+// ECB and CBC decryption of 3DES process 4 blocks at a time.
+// Compare them to the generic one-block-at-a-time mode code for every length up to
+// 3 full batches plus a partial one, in place and out of place.
+// The random data gives each lane of a batch a different block.
+//
+VOID
+test3DesParallel()
+{
+    SYMCRYPT_3DES_EXPANDED_KEY  key;
+    SYMCRYPT_BLOCKCIPHER        genericCipher;
+    BYTE                        keyBuf[24];
+    BYTE                        src[DES3_PARALLEL_MAX_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE];
+    BYTE                        ref[DES3_PARALLEL_MAX_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE];
+    BYTE                        dst[DES3_PARALLEL_MAX_BLOCKS * SYMCRYPT_3DES_BLOCK_SIZE];
+    BYTE                        iv[SYMCRYPT_3DES_BLOCK_SIZE];
+    BYTE                        refChain[SYMCRYPT_3DES_BLOCK_SIZE];
+    BYTE                        chain[SYMCRYPT_3DES_BLOCK_SIZE];
+    SIZE_T                      cbData;
+    BOOLEAN                     bInPlace;
+
+    if( !isAlgorithmPresent( "Des3", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    3DesParallel" );
+
+    genericCipher = *SymCrypt3DesBlockCipher;
+    genericCipher.ecbEncryptFunc = NULL;
+    genericCipher.ecbDecryptFunc = NULL;
+    genericCipher.cbcDecryptFunc = NULL;
+
+    GENRANDOM( keyBuf, sizeof( keyBuf ) );
+    CHECK( SymCrypt3DesExpandKey( &key, keyBuf, sizeof( keyBuf ) ) == SYMCRYPT_NO_ERROR, "3DES key expansion failed" );
+
+    for( SIZE_T nBlocks = 0; nBlocks <= DES3_PARALLEL_MAX_BLOCKS; nBlocks++ )
+    {
+        cbData = nBlocks * SYMCRYPT_3DES_BLOCK_SIZE;
+        bInPlace = (nBlocks & 1) != 0;
+
+        GENRANDOM( src, (ULONG) cbData );
+        GENRANDOM( iv, sizeof( iv ) );
+
+        SymCryptEcbEncrypt( &genericCipher, &key, src, ref, cbData );
+        memcpy( dst, src, cbData );
+        SymCrypt3DesEcbEncrypt( &key, bInPlace ? dst : src, dst, cbData );
+        CHECK3( memcmp( dst, ref, cbData ) == 0, "3DES-ECB encryption mismatch, %d blocks", (int) nBlocks );
+
+        SymCryptEcbDecrypt( &genericCipher, &key, src, ref, cbData );
+        memcpy( dst, src, cbData );
+        SymCrypt3DesEcbDecrypt( &key, bInPlace ? dst : src, dst, cbData );
+        CHECK3( memcmp( dst, ref, cbData ) == 0, "3DES-ECB decryption mismatch, %d blocks", (int) nBlocks );
+
+        memcpy( refChain, iv, sizeof( iv ) );
+        memcpy( chain, iv, sizeof( iv ) );
+        SymCryptCbcDecrypt( &genericCipher, &key, refChain, src, ref, cbData );
+        memcpy( dst, src, cbData );
+        SymCrypt3DesCbcDecrypt( &key, chain, bInPlace ? dst : src, dst, cbData );
+        CHECK3( memcmp( dst, ref, cbData ) == 0, "3DES-CBC decryption mismatch, %d blocks", (int) nBlocks );
+        CHECK3( memcmp( chain, refChain, sizeof( chain ) ) == 0, "3DES-CBC chaining value mismatch, %d blocks", (int) nBlocks );
+    }
+
+    iprint( "\n" );
+}
+
+#define AES_BITSLICE_MAX_BLOCKS (40)
+
+//
+// Request sizes for the bitslice comparison: a single block (below the bitslice threshold),
+// partial and full batches of 8 blocks, and several batches.
+//
+const SIZE_T g_aesBitsliceBlocks[] = { 1, 7, 8, 9, 16, 23, AES_BITSLICE_MAX_BLOCKS };
+
+//
+// FIPS 197 appendix C.1
+//
+const BYTE g_aesBitsliceKatKey[]   = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+const BYTE g_aesBitsliceKatPlain[] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff };
+const BYTE g_aesBitsliceKatCipher[]= { 0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a };
+
+typedef enum _AES_BITSLICE_MODE {
+    AesBitsliceEcbEncrypt,
+    AesBitsliceCbcDecrypt,
+    AesBitsliceCtrMsb64,
+    AesBitsliceCtrMsb32,
+    AesBitsliceXtsEncrypt,
+    AesBitsliceXtsDecrypt,
+    AesBitsliceNModes,
+} AES_BITSLICE_MODE;
+
+//
+// On AMD64 CPUs without AES-NI the bulk modes use bitsliced AES.
+// Compare each mode against the AES-NI code by disabling AES-NI for the second computation.
+//
+VOID
+testAesBitslice()
+{
+#if SYMCRYPT_CPU_AMD64
+    SYMCRYPT_AES_EXPANDED_KEY       key;
+    SYMCRYPT_XTS_AES_EXPANDED_KEY   xtsKey;
+    BYTE                            keyBuf[64];
+    BYTE                            src[AES_BITSLICE_MAX_BLOCKS * SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                            ref[AES_BITSLICE_MAX_BLOCKS * SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                            dst[AES_BITSLICE_MAX_BLOCKS * SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                            iv[SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                            refChain[SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                            chain[SYMCRYPT_AES_BLOCK_SIZE];
+    SYMCRYPT_CPU_FEATURES           savedFeatures;
+    SIZE_T                          cbKey;
+    SIZE_T                          cbData;
+    UINT64                          tweak;
+
+    if( !isAlgorithmPresent( "Aes", FALSE ) ||
+        !SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURES_FOR_AESNI_CODE ) ||
+        !SYMCRYPT_CPU_FEATURES_PRESENT( SYMCRYPT_CPU_FEATURE_SSSE3 ) )
+    {
+        return;
+    }
+
+    iprint( "    AesBitslice" );
+
+    savedFeatures = g_SymCryptCpuFeaturesNotPresent;
+
+    //
+    // Known answer through the bitslice code: 9 copies of the FIPS 197 block fill one full
+    // batch and one partial batch.
+    //
+    for( SIZE_T i = 0; i < 9; i++ )
+    {
+        memcpy( &src[i * SYMCRYPT_AES_BLOCK_SIZE], g_aesBitsliceKatPlain, SYMCRYPT_AES_BLOCK_SIZE );
+    }
+
+    CHECK( SymCryptAesExpandKey( &key, g_aesBitsliceKatKey, sizeof( g_aesBitsliceKatKey ) ) == SYMCRYPT_NO_ERROR, "AES key expansion failed" );
+
+    g_SymCryptCpuFeaturesNotPresent |= SYMCRYPT_CPU_FEATURE_AESNI;
+    SymCryptAesEcbEncrypt( &key, src, dst, 9 * SYMCRYPT_AES_BLOCK_SIZE );
+    g_SymCryptCpuFeaturesNotPresent = savedFeatures;
+
+    for( SIZE_T i = 0; i < 9; i++ )
+    {
+        CHECK( memcmp( &dst[i * SYMCRYPT_AES_BLOCK_SIZE], g_aesBitsliceKatCipher, SYMCRYPT_AES_BLOCK_SIZE ) == 0, "AES bitslice known answer mismatch" );
+    }
+
+    for( int mode = 0; mode < AesBitsliceNModes; mode++ )
+    {
+        for( SIZE_T iSize = 0; iSize < ARRAY_SIZE( g_aesBitsliceBlocks ); iSize++ )
+        {
+            cbKey = 16 + 8 * (iSize % 3);
+            cbData = g_aesBitsliceBlocks[iSize] * SYMCRYPT_AES_BLOCK_SIZE;
+
+            GENRANDOM( keyBuf, sizeof( keyBuf ) );
+            GENRANDOM( src, (ULONG) cbData );
+            GENRANDOM( iv, sizeof( iv ) );
+
+            //
+            // Start the counters just below their wrap-around so the carry out of
+            // the counter is covered.
+            //
+            if( mode == AesBitsliceCtrMsb64 )
+            {
+                SYMCRYPT_STORE_MSBFIRST64( &iv[8], (UINT64) 0 - 5 );
+            }
+            if( mode == AesBitsliceCtrMsb32 )
+            {
+                SYMCRYPT_STORE_MSBFIRST32( &iv[12], (UINT32) 0 - 5 );
+            }
+            tweak = SYMCRYPT_LOAD_LSBFIRST64( iv );
+
+            CHECK( SymCryptAesExpandKey( &key, keyBuf, cbKey ) == SYMCRYPT_NO_ERROR, "AES key expansion failed" );
+            CHECK( SymCryptXtsAesExpandKey( &xtsKey, keyBuf, 2 * cbKey ) == SYMCRYPT_NO_ERROR, "XTS-AES key expansion failed" );
+
+            for( int iPass = 0; iPass < 2; iPass++ )
+            {
+                PBYTE pbDst = iPass == 0 ? ref : dst;
+                PBYTE pbChain = iPass == 0 ? refChain : chain;
+
+                if( iPass == 1 )
+                {
+                    //
+                    // Ugly hack, we directly manipulate the CPU features flags.
+                    //
+                    g_SymCryptCpuFeaturesNotPresent |= SYMCRYPT_CPU_FEATURE_AESNI;
+                }
+
+                memcpy( pbChain, iv, sizeof( iv ) );
+                switch( mode )
+                {
+                case AesBitsliceEcbEncrypt:
+                    SymCryptAesEcbEncrypt( &key, src, pbDst, cbData );
+                    break;
+                case AesBitsliceCbcDecrypt:
+                    SymCryptAesCbcDecrypt( &key, pbChain, src, pbDst, cbData );
+                    break;
+                case AesBitsliceCtrMsb64:
+                    SymCryptAesCtrMsb64( &key, pbChain, src, pbDst, cbData );
+                    break;
+                case AesBitsliceCtrMsb32:
+                    SymCryptAesCtrMsb32( &key, pbChain, src, pbDst, cbData );
+                    break;
+                case AesBitsliceXtsEncrypt:
+                    SymCryptXtsAesEncrypt( &xtsKey, cbData, tweak, src, pbDst, cbData );
+                    break;
+                case AesBitsliceXtsDecrypt:
+                    SymCryptXtsAesDecrypt( &xtsKey, cbData, tweak, src, pbDst, cbData );
+                    break;
+                }
+
+                g_SymCryptCpuFeaturesNotPresent = savedFeatures;
+            }
+
+            CHECK4( memcmp( dst, ref, cbData ) == 0, "AES bitslice output mismatch, mode %d, %d blocks", mode, (int) g_aesBitsliceBlocks[iSize] );
+            CHECK4( memcmp( chain, refChain, sizeof( chain ) ) == 0, "AES bitslice chaining value mismatch, mode %d, %d blocks", mode, (int) g_aesBitsliceBlocks[iSize] );
+        }
+    }
+
+    iprint( "\n" );
+#endif
+}
+
 VOID
 testBlockCipherAlgorithms()
 {
     testBlockCipherKats();
+
+    testParallelAesCbc();
+
+    testAesCtrMsb32();
+
+    testAesCtrMsb64Iovec();
+
+    testAesKeyForms();
+
+    testAesKeyCopyDecrypt();
+
+    testAesCfb();
+
+    testAesBitslice();
+
+    test3DesParallel();
 }
 
 
@@ -429,10 +429,240 @@ testKdfKats()
     }
 }
 
+#define PAR_PBKDF2_N_ITERATIONS     4
+#define PAR_PBKDF2_N_RESULTS        6
+#define PAR_PBKDF2_MAX_OPS          (PAR_PBKDF2_N_ITERATIONS * PAR_PBKDF2_N_RESULTS)
+#define PAR_PBKDF2_MAX_PASSWORD     (SYMCRYPT_HMAC_SHA512_INPUT_BLOCK_SIZE + 1)
+#define PAR_PBKDF2_MAX_SALT         64
+#define PAR_PBKDF2_MAX_RESULT       (3 * SYMCRYPT_HMAC_SHA512_RESULT_SIZE)
+
+//
+// Iteration counts of the batch test; more operations than lanes and different counts
+// make lanes pick up new output blocks while others are still busy.
+//
+const UINT64 g_parPbkdf2IterationCnts[PAR_PBKDF2_N_ITERATIONS] = { 1, 2, 17, 1000 };
+
+//
+// Known answer: P = "password", S = "salt", c = 2, dkLen = hLen + 5 (RFC 6070 for SHA-1, extended to two blocks)
+//
+const BYTE g_parPbkdf2KatPassword[] = { 'p', 'a', 's', 's', 'w', 'o', 'r', 'd' };
+const BYTE g_parPbkdf2KatSalt[] = { 's', 'a', 'l', 't' };
+
+VOID
+testParallelPbkdf2(
+    _In_    char *          algName,
+            PCSYMCRYPT_MAC  macAlgorithm,
+            SIZE_T          cbInputBlock,
+            SIZE_T          cbFixedScratch,
+            SIZE_T          cbPerLaneScratch,
+    _In_    PCBYTE          pbKatResult,
+            SYMCRYPT_ERROR  (SYMCRYPT_CALL * pfParallelPbkdf2)( PCSYMCRYPT_PARALLEL_PBKDF2_OPERATION, SIZE_T, PBYTE, SIZE_T ),
+            SYMCRYPT_ERROR  (SYMCRYPT_CALL * pfParallelPbkdf2Verify)( PCSYMCRYPT_PARALLEL_PBKDF2_OPERATION, SIZE_T, SYMCRYPT_ERROR *, PBYTE, SIZE_T ) )
+{
+    SYMCRYPT_PARALLEL_PBKDF2_OPERATION  ops[PAR_PBKDF2_MAX_OPS];
+    SYMCRYPT_ERROR                      results[PAR_PBKDF2_MAX_OPS];
+    BYTE                                password[PAR_PBKDF2_MAX_PASSWORD];
+    BYTE                                salt[PAR_PBKDF2_MAX_SALT + PAR_PBKDF2_MAX_OPS];
+    BYTE                                res[PAR_PBKDF2_MAX_OPS][PAR_PBKDF2_MAX_RESULT];
+    BYTE                                ref[PAR_PBKDF2_MAX_RESULT];
+    SIZE_T                              cbPasswords[4];
+    SIZE_T                              cbResults[PAR_PBKDF2_N_RESULTS];
+    SIZE_T                              cbResult = macAlgorithm->resultSize;
+    SIZE_T                              cbKat = cbResult + 5;
+    SIZE_T                              cbScratch = cbFixedScratch + SYMCRYPT_PARALLEL_PBKDF2_LANES * cbPerLaneScratch;
+    SIZE_T                              cbSmallScratch;
+    SIZE_T                              nOps;
+    SIZE_T                              i;
+
+    if( !isAlgorithmPresent( algName, FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    ParallelPbkdf2%s", algName );
+
+    PBYTE pbScratch = new BYTE[ cbScratch + 1 ];
+    CHECK( pbScratch != NULL, "Out of memory" );
+
+    //
+    // Passwords that are shorter than, equal to, and longer than the HMAC input block size.
+    // Results of zero bytes, one byte, around one hash block, and three hash blocks.
+    //
+    cbPasswords[0] = 0;
+    cbPasswords[1] = cbInputBlock - 1;
+    cbPasswords[2] = cbInputBlock;
+    cbPasswords[3] = cbInputBlock + 1;
+
+    cbResults[0] = 0;
+    cbResults[1] = 1;
+    cbResults[2] = cbResult - 1;
+    cbResults[3] = cbResult;
+    cbResults[4] = cbResult + 1;
+    cbResults[5] = 3 * cbResult;
+
+    GENRANDOM( password, sizeof( password ) );
+    GENRANDOM( salt, sizeof( salt ) );
+
+    //
+    // No operations
+    //
+    CHECK( (*pfParallelPbkdf2)( ops, 0, pbScratch, cbScratch ) == SYMCRYPT_NO_ERROR, "Parallel PBKDF2 with no operations failed" );
+    CHECK( (*pfParallelPbkdf2Verify)( ops, 0, results, pbScratch, cbScratch ) == SYMCRYPT_NO_ERROR, "Parallel PBKDF2 verify with no operations failed" );
+
+    //
+    // A single operation: the known answer, and its verification
+    //
+    ops[0].pbPassword = g_parPbkdf2KatPassword;
+    ops[0].cbPassword = sizeof( g_parPbkdf2KatPassword );
+    ops[0].pbSalt = g_parPbkdf2KatSalt;
+    ops[0].cbSalt = sizeof( g_parPbkdf2KatSalt );
+    ops[0].iterationCnt = 2;
+    ops[0].pbResult = res[0];
+    ops[0].cbResult = cbKat;
+
+    CHECK( (*pfParallelPbkdf2)( ops, 1, pbScratch, cbScratch ) == SYMCRYPT_NO_ERROR, "Parallel PBKDF2 failed" );
+    CHECK( memcmp( res[0], pbKatResult, cbKat ) == 0, "Parallel PBKDF2 known answer mismatch" );
+
+    results[0] = SYMCRYPT_AUTHENTICATION_FAILURE;
+    CHECK( (*pfParallelPbkdf2Verify)( ops, 1, results, pbScratch, cbScratch ) == SYMCRYPT_NO_ERROR, "Parallel PBKDF2 verify of known answer failed" );
+    CHECK( results[0] == SYMCRYPT_NO_ERROR, "Parallel PBKDF2 verify result wrong" );
+
+    res[0][cbKat - 1] ^= 0x80;
+    CHECK( (*pfParallelPbkdf2Verify)( ops, 1, NULL, pbScratch, cbScratch ) == SYMCRYPT_AUTHENTICATION_FAILURE, "Parallel PBKDF2 verify accepted a wrong result" );
+
+    //
+    // All iteration count and result size combinations in one call, cycling through the password sizes.
+    // Adjacent operations use different salts as they start at different offsets.
+    // The scratch space is exactly the documented size, followed by a sentinel byte.
+    //
+    nOps = 0;
+    for( SIZE_T iIter = 0; iIter < PAR_PBKDF2_N_ITERATIONS; iIter++ )
+    {
+        for( SIZE_T iRes = 0; iRes < PAR_PBKDF2_N_RESULTS; iRes++ )
+        {
+            ops[nOps].pbPassword = password;
+            ops[nOps].cbPassword = cbPasswords[nOps % ARRAY_SIZE( cbPasswords )];
+            ops[nOps].pbSalt = &salt[nOps];
+            ops[nOps].cbSalt = (nOps * 7) % (PAR_PBKDF2_MAX_SALT + 1);
+            ops[nOps].iterationCnt = g_parPbkdf2IterationCnts[iIter];
+            ops[nOps].pbResult = res[nOps];
+            ops[nOps].cbResult = cbResults[iRes];
+            nOps++;
+        }
+    }
+
+    pbScratch[cbScratch] = 0xa5;
+
+    CHECK( (*pfParallelPbkdf2)( ops, nOps, pbScratch, cbScratch ) == SYMCRYPT_NO_ERROR, "Parallel PBKDF2 failed" );
+
+    CHECK( pbScratch[cbScratch] == 0xa5, "Parallel PBKDF2 used too much scratch space" );
+
+    for( i=0; i<nOps; i++ )
+    {
+        if( ops[i].cbResult == 0 )
+        {
+            continue;
+        }
+        CHECK( SymCryptPbkdf2(  macAlgorithm,
+                                ops[i].pbPassword, ops[i].cbPassword,
+                                ops[i].pbSalt, ops[i].cbSalt,
+                                ops[i].iterationCnt,
+                                ref, ops[i].cbResult ) == SYMCRYPT_NO_ERROR, "?" );
+        CHECK3( memcmp( res[i], ref, ops[i].cbResult ) == 0, "Parallel PBKDF2 result mismatch in operation %d", (int) i );
+    }
+
+    //
+    // Verify the batch, then with the first byte of operation 2 and the last byte of the final
+    // operation corrupted.
+    //
+    CHECK( (*pfParallelPbkdf2Verify)( ops, nOps, results, pbScratch, cbScratch ) == SYMCRYPT_NO_ERROR, "Parallel PBKDF2 verify failed" );
+    for( i=0; i<nOps; i++ )
+    {
+        CHECK3( results[i] == SYMCRYPT_NO_ERROR, "Parallel PBKDF2 verify result wrong for operation %d", (int) i );
+    }
+
+    //
+    // Scratch space for fewer lanes gives the same results.
+    //
+    for( SIZE_T nLanes = 1; nLanes < SYMCRYPT_PARALLEL_PBKDF2_LANES; nLanes += 6 )
+    {
+        cbSmallScratch = cbFixedScratch + nLanes * cbPerLaneScratch;
+        pbScratch[cbSmallScratch] = 0xa5;
+
+        CHECK3( (*pfParallelPbkdf2Verify)( ops, nOps, NULL, pbScratch, cbSmallScratch ) == SYMCRYPT_NO_ERROR,
+                "Parallel PBKDF2 verify failed with scratch space for %d lanes", (int) nLanes );
+        CHECK3( pbScratch[cbSmallScratch] == 0xa5, "Parallel PBKDF2 used too much scratch space for %d lanes", (int) nLanes );
+    }
+
+    CHECK( ops[2].cbResult > 0 && ops[nOps - 1].cbResult > 0, "?" );
+    res[2][0] ^= 1;
+    res[nOps - 1][ops[nOps - 1].cbResult - 1] ^= 1;
+
+    CHECK( (*pfParallelPbkdf2Verify)( ops, nOps, results, pbScratch, cbScratch ) == SYMCRYPT_AUTHENTICATION_FAILURE, "Parallel PBKDF2 verify result wrong" );
+    for( i=0; i<nOps; i++ )
+    {
+        CHECK3( results[i] == ((i == 2 || i == nOps - 1) ? SYMCRYPT_AUTHENTICATION_FAILURE : SYMCRYPT_NO_ERROR),
+                "Parallel PBKDF2 verify result wrong for operation %d", (int) i );
+    }
+
+    //
+    // An iteration count of 0 rejects the whole batch without writing any result.
+    //
+    ops[4].iterationCnt = 0;
+    memset( res[3], 0x5a, ops[3].cbResult );
+
+    CHECK( (*pfParallelPbkdf2)( &ops[3], 2, pbScratch, cbScratch ) == SYMCRYPT_WRONG_ITERATION_COUNT, "Parallel PBKDF2 accepted an iteration count of 0" );
+    CHECK( res[3][0] == 0x5a, "Parallel PBKDF2 wrote a result for a rejected batch" );
+
+    results[0] = SYMCRYPT_NO_ERROR;
+    results[1] = SYMCRYPT_NO_ERROR;
+    CHECK( (*pfParallelPbkdf2Verify)( &ops[3], 2, results, pbScratch, cbScratch ) == SYMCRYPT_WRONG_ITERATION_COUNT, "Parallel PBKDF2 verify accepted an iteration count of 0" );
+    CHECK( results[0] == SYMCRYPT_WRONG_ITERATION_COUNT && results[1] == SYMCRYPT_WRONG_ITERATION_COUNT, "Parallel PBKDF2 verify results not set for a rejected batch" );
+
+    delete[] pbScratch;
+
+    iprint( "\n" );
+}
+
+//
+// Parallel PBKDF2 known answers
+//
+const BYTE g_parPbkdf2HmacSha1KatResult[] = {
+    0xea, 0x6c, 0x01, 0x4d, 0xc7, 0x2d, 0x6f, 0x8c, 0xcd, 0x1e, 0xd9, 0x2a, 0xce, 0x1d, 0x41, 0xf0,
+    0xd8, 0xde, 0x89, 0x57, 0xca, 0xe9, 0x31, 0x36, 0x26,
+};
+
+const BYTE g_parPbkdf2HmacSha256KatResult[] = {
+    0xae, 0x4d, 0x0c, 0x95, 0xaf, 0x6b, 0x46, 0xd3, 0x2d, 0x0a, 0xdf, 0xf9, 0x28, 0xf0, 0x6d, 0xd0,
+    0x2a, 0x30, 0x3f, 0x8e, 0xf3, 0xc2, 0x51, 0xdf, 0xd6, 0xe2, 0xd8, 0x5a, 0x95, 0x47, 0x4c, 0x43,
+    0x83, 0x06, 0x51, 0xaf, 0xcb,
+};
+
+const BYTE g_parPbkdf2HmacSha512KatResult[] = {
+    0xe1, 0xd9, 0xc1, 0x6a, 0xa6, 0x81, 0x70, 0x8a, 0x45, 0xf5, 0xc7, 0xc4, 0xe2, 0x15, 0xce, 0xb6,
+    0x6e, 0x01, 0x1a, 0x2e, 0x9f, 0x00, 0x40, 0x71, 0x3f, 0x18, 0xae, 0xfd, 0xb8, 0x66, 0xd5, 0x3c,
+    0xf7, 0x6c, 0xab, 0x28, 0x68, 0xa3, 0x9b, 0x9f, 0x78, 0x40, 0xed, 0xce, 0x4f, 0xef, 0x5a, 0x82,
+    0xbe, 0x67, 0x33, 0x5c, 0x77, 0xa6, 0x06, 0x8e, 0x04, 0x11, 0x27, 0x54, 0xf2, 0x7c, 0xcf, 0x4e,
+    0x47, 0x3e, 0x31, 0x1a, 0xd8,
+};
+
 VOID
 testKdfAlgorithms()
 {
     testKdfKats();
+
+    testParallelPbkdf2( "HmacSha1", SymCryptHmacSha1Algorithm, SYMCRYPT_HMAC_SHA1_INPUT_BLOCK_SIZE,
+                        SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA1_FIXED_SCRATCH, SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA1_PER_LANE_SCRATCH,
+                        g_parPbkdf2HmacSha1KatResult,
+                        &SymCryptParallelPbkdf2HmacSha1, &SymCryptParallelPbkdf2HmacSha1Verify );
+    testParallelPbkdf2( "HmacSha256", SymCryptHmacSha256Algorithm, SYMCRYPT_HMAC_SHA256_INPUT_BLOCK_SIZE,
+                        SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA256_FIXED_SCRATCH, SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA256_PER_LANE_SCRATCH,
+                        g_parPbkdf2HmacSha256KatResult,
+                        &SymCryptParallelPbkdf2HmacSha256, &SymCryptParallelPbkdf2HmacSha256Verify );
+    testParallelPbkdf2( "HmacSha512", SymCryptHmacSha512Algorithm, SYMCRYPT_HMAC_SHA512_INPUT_BLOCK_SIZE,
+                        SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA512_FIXED_SCRATCH, SYMCRYPT_PARALLEL_PBKDF2_HMAC_SHA512_PER_LANE_SCRATCH,
+                        g_parPbkdf2HmacSha512KatResult,
+                        &SymCryptParallelPbkdf2HmacSha512, &SymCryptParallelPbkdf2HmacSha512Verify );
 }
 
 
@@ -529,6 +529,214 @@ testMacKats()
 }
 
 
+#define PAR_CMAC_MAX_OPS    20
+#define PAR_CMAC_MAX_LEN    (20 * SYMCRYPT_AES_BLOCK_SIZE)
+
+VOID
+testParallelAesCmac()
+{
+    SYMCRYPT_AES_CMAC_EXPANDED_KEY          keys[3];
+    SYMCRYPT_PARALLEL_AES_CMAC_OPERATION    ops[PAR_CMAC_MAX_OPS];
+    BYTE                                    keyBuf[32];
+    BYTE                                    msg[PAR_CMAC_MAX_OPS][PAR_CMAC_MAX_LEN];
+    BYTE                                    res[PAR_CMAC_MAX_OPS][SYMCRYPT_AES_CMAC_RESULT_SIZE];
+    BYTE                                    ref[PAR_CMAC_MAX_OPS][SYMCRYPT_AES_CMAC_RESULT_SIZE];
+    SIZE_T                                  i;
+    SIZE_T                                  nOps;
+    SIZE_T                                  iKey;
+
+    if( !isAlgorithmPresent( "AesCmac", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    ParallelAesCmac" );
+
+    for( i=0; i<3; i++ )
+    {
+        GENRANDOM( keyBuf, sizeof( keyBuf ) );
+        SymCryptAesCmacExpandKey( &keys[i], keyBuf, 16 + 8*i );
+    }
+
+    for( int iTest = 0; iTest < 1000; iTest++ )
+    {
+        nOps = g_rng.sizet( PAR_CMAC_MAX_OPS + 1 );
+
+        for( i=0; i<nOps; i++ )
+        {
+            iKey = g_rng.sizet( 3 );
+            ops[i].pExpandedKey = &keys[iKey];
+            ops[i].cbData = g_rng.sizetNonUniform( PAR_CMAC_MAX_LEN + 1, 32, 1 );
+            ops[i].pbData = msg[i];
+            ops[i].pbResult = res[i];
+            GENRANDOM( msg[i], (ULONG) ops[i].cbData );
+
+            SymCryptAesCmac( &keys[iKey], msg[i], ops[i].cbData, ref[i] );
+        }
+
+        SymCryptParallelAesCmac( ops, nOps );
+
+        for( i=0; i<nOps; i++ )
+        {
+            CHECK3( memcmp( res[i], ref[i], SYMCRYPT_AES_CMAC_RESULT_SIZE ) == 0, "Parallel AES-CMAC result mismatch in operation %d", i );
+        }
+    }
+
+    iprint( "\n" );
+}
+
+
+#define PAR_HMAC_N_KEYS     3
+#define PAR_HMAC_N_LENGTHS  12
+#define PAR_HMAC_MAX_OPS    (PAR_HMAC_N_KEYS * PAR_HMAC_N_LENGTHS)
+#define PAR_HMAC_MAX_LEN    (3 * SYMCRYPT_HMAC_SHA512_INPUT_BLOCK_SIZE + 8)
+#define PAR_HMAC_SCRATCH    (SYMCRYPT_PARALLEL_HMAC_SHA512_FIXED_SCRATCH + PAR_HMAC_MAX_OPS * SYMCRYPT_PARALLEL_HMAC_SHA512_PER_OPERATION_SCRATCH + 1)
+
+//
+// RFC 4231 test case 2
+//
+const BYTE g_parHmacKatKey[] = { 'J', 'e', 'f', 'e' };
+const char g_parHmacKatData[] = "what do ya want for nothing?";
+
+template< class KEY, class OP >
+VOID
+testParallelHmac(
+    _In_    char *  algName,
+            SIZE_T  cbResult,
+            SIZE_T  cbInputBlock,
+            SIZE_T  cbFixedScratch,
+            SIZE_T  cbPerOperationScratch,
+    _In_    PCBYTE  pbKatResult,
+            SYMCRYPT_ERROR  (SYMCRYPT_CALL * pfExpandKey)( KEY *, PCBYTE, SIZE_T ),
+            VOID            (SYMCRYPT_CALL * pfHmac)( const KEY *, PCBYTE, SIZE_T, PBYTE ),
+            VOID            (SYMCRYPT_CALL * pfParallelHmac)( const OP *, SIZE_T, PBYTE, SIZE_T ) )
+{
+    KEY     keys[PAR_HMAC_N_KEYS];
+    KEY     katKey;
+    OP      ops[PAR_HMAC_MAX_OPS];
+    BYTE    keyBuf[2 * SYMCRYPT_HMAC_SHA512_INPUT_BLOCK_SIZE];
+    BYTE    msg[PAR_HMAC_MAX_LEN + PAR_HMAC_N_KEYS];
+    BYTE    res[PAR_HMAC_MAX_OPS][SYMCRYPT_HMAC_SHA512_RESULT_SIZE];
+    BYTE    ref[SYMCRYPT_HMAC_SHA512_RESULT_SIZE];
+    BYTE    scratch[PAR_HMAC_SCRATCH];
+    SIZE_T  cbLengths[PAR_HMAC_N_LENGTHS];
+    SIZE_T  cbScratch;
+    SIZE_T  nOps;
+    SIZE_T  i;
+
+    if( !isAlgorithmPresent( algName, FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    Parallel%s", algName );
+
+    //
+    // Use keys that are shorter than, equal to, and longer than the input block size.
+    //
+    GENRANDOM( keyBuf, sizeof( keyBuf ) );
+    CHECK( (*pfExpandKey)( &keys[0], keyBuf, cbInputBlock - 1 ) == SYMCRYPT_NO_ERROR, "?" );
+    CHECK( (*pfExpandKey)( &keys[1], keyBuf, cbInputBlock     ) == SYMCRYPT_NO_ERROR, "?" );
+    CHECK( (*pfExpandKey)( &keys[2], keyBuf, cbInputBlock + 1 ) == SYMCRYPT_NO_ERROR, "?" );
+    CHECK( (*pfExpandKey)( &katKey, g_parHmacKatKey, sizeof( g_parHmacKatKey ) ) == SYMCRYPT_NO_ERROR, "?" );
+
+    //
+    // Message lengths around the padding boundaries (8- and 16-byte length fields) and the
+    // block boundaries of the inner hash.
+    //
+    cbLengths[ 0] = 0;
+    cbLengths[ 1] = 1;
+    cbLengths[ 2] = cbInputBlock - 17;
+    cbLengths[ 3] = cbInputBlock - 16;
+    cbLengths[ 4] = cbInputBlock - 9;
+    cbLengths[ 5] = cbInputBlock - 8;
+    cbLengths[ 6] = cbInputBlock - 1;
+    cbLengths[ 7] = cbInputBlock;
+    cbLengths[ 8] = cbInputBlock + 1;
+    cbLengths[ 9] = 2 * cbInputBlock;
+    cbLengths[10] = 3 * cbInputBlock - 9;
+    cbLengths[11] = 3 * cbInputBlock + 8;
+
+    GENRANDOM( msg, sizeof( msg ) );
+
+    //
+    // No operations: nothing is written, not even to the scratch space.
+    //
+    memset( scratch, 0x5a, sizeof( scratch ) );
+    (*pfParallelHmac)( ops, 0, scratch, cbFixedScratch );
+    for( i=0; i<sizeof( scratch ); i++ )
+    {
+        CHECK( scratch[i] == 0x5a, "Parallel HMAC with no operations wrote to the scratch space" );
+    }
+
+    //
+    // A single operation: the known answer.
+    //
+    ops[0].pExpandedKey = &katKey;
+    ops[0].pbData = (PCBYTE) g_parHmacKatData;
+    ops[0].cbData = sizeof( g_parHmacKatData ) - 1;
+    ops[0].pbResult = res[0];
+
+    (*pfParallelHmac)( ops, 1, scratch, cbFixedScratch + cbPerOperationScratch );
+
+    CHECK( memcmp( res[0], pbKatResult, cbResult ) == 0, "Parallel HMAC known answer mismatch" );
+
+    //
+    // All key and length combinations in one call.
+    // Adjacent operations use different keys, and different data as they start at different offsets.
+    // The scratch space is exactly the documented size, followed by a sentinel byte.
+    //
+    nOps = 0;
+    for( SIZE_T iLen = 0; iLen < PAR_HMAC_N_LENGTHS; iLen++ )
+    {
+        for( SIZE_T iKey = 0; iKey < PAR_HMAC_N_KEYS; iKey++ )
+        {
+            ops[nOps].pExpandedKey = &keys[iKey];
+            ops[nOps].pbData = &msg[iKey];
+            ops[nOps].cbData = cbLengths[iLen];
+            ops[nOps].pbResult = res[nOps];
+            nOps++;
+        }
+    }
+
+    cbScratch = cbFixedScratch + nOps * cbPerOperationScratch;
+    CHECK( cbScratch < sizeof( scratch ), "?" );
+    scratch[cbScratch] = 0xa5;
+
+    (*pfParallelHmac)( ops, nOps, scratch, cbScratch );
+
+    CHECK( scratch[cbScratch] == 0xa5, "Parallel HMAC used too much scratch space" );
+
+    for( i=0; i<nOps; i++ )
+    {
+        (*pfHmac)( ops[i].pExpandedKey, ops[i].pbData, ops[i].cbData, ref );
+        CHECK4( memcmp( res[i], ref, cbResult ) == 0, "Parallel HMAC result mismatch, key %d, length %d", (int) (i % PAR_HMAC_N_KEYS), (int) ops[i].cbData );
+    }
+
+    iprint( "\n" );
+}
+
+//
+// RFC 4231 test case 2 results
+//
+const BYTE g_parHmacSha256KatResult[] = {
+    0x5b, 0xdc, 0xc1, 0x46, 0xbf, 0x60, 0x75, 0x4e, 0x6a, 0x04, 0x24, 0x26, 0x08, 0x95, 0x75, 0xc7,
+    0x5a, 0x00, 0x3f, 0x08, 0x9d, 0x27, 0x39, 0x83, 0x9d, 0xec, 0x58, 0xb9, 0x64, 0xec, 0x38, 0x43,
+};
+
+const BYTE g_parHmacSha384KatResult[] = {
+    0xaf, 0x45, 0xd2, 0xe3, 0x76, 0x48, 0x40, 0x31, 0x61, 0x7f, 0x78, 0xd2, 0xb5, 0x8a, 0x6b, 0x1b,
+    0x9c, 0x7e, 0xf4, 0x64, 0xf5, 0xa0, 0x1b, 0x47, 0xe4, 0x2e, 0xc3, 0x73, 0x63, 0x22, 0x44, 0x5e,
+    0x8e, 0x22, 0x40, 0xca, 0x5e, 0x69, 0xe2, 0xc7, 0x8b, 0x32, 0x39, 0xec, 0xfa, 0xb2, 0x16, 0x49,
+};
+
+const BYTE g_parHmacSha512KatResult[] = {
+    0x16, 0x4b, 0x7a, 0x7b, 0xfc, 0xf8, 0x19, 0xe2, 0xe3, 0x95, 0xfb, 0xe7, 0x3b, 0x56, 0xe0, 0xa3,
+    0x87, 0xbd, 0x64, 0x22, 0x2e, 0x83, 0x1f, 0xd6, 0x10, 0x27, 0x0c, 0xd7, 0xea, 0x25, 0x05, 0x54,
+    0x97, 0x58, 0xbf, 0x75, 0xc0, 0x5a, 0x99, 0x4a, 0x6d, 0x03, 0x4f, 0x65, 0xf8, 0xf0, 0xe6, 0xfd,
+    0xca, 0xea, 0xb1, 0xa3, 0x4d, 0x4a, 0x6b, 0x4b, 0x63, 0x6e, 0x07, 0x0a, 0x38, 0xbc, 0xe7, 0x37,
+};
+
 VOID
 testMacAlgorithms()
 {
@@ -550,5 +758,22 @@ testMacAlgorithms()
         FATAL( "Wrong result for default seeded Marvin API" );
     }
 
+    testParallelAesCmac();
+
+    testParallelHmac<SYMCRYPT_HMAC_SHA256_EXPANDED_KEY, SYMCRYPT_PARALLEL_HMAC_SHA256_OPERATION>(
+        "HmacSha256", SYMCRYPT_HMAC_SHA256_RESULT_SIZE, SYMCRYPT_HMAC_SHA256_INPUT_BLOCK_SIZE,
+        SYMCRYPT_PARALLEL_HMAC_SHA256_FIXED_SCRATCH, SYMCRYPT_PARALLEL_HMAC_SHA256_PER_OPERATION_SCRATCH, g_parHmacSha256KatResult,
+        &SymCryptHmacSha256ExpandKey, &SymCryptHmacSha256, &SymCryptParallelHmacSha256 );
+
+    testParallelHmac<SYMCRYPT_HMAC_SHA384_EXPANDED_KEY, SYMCRYPT_PARALLEL_HMAC_SHA384_OPERATION>(
+        "HmacSha384", SYMCRYPT_HMAC_SHA384_RESULT_SIZE, SYMCRYPT_HMAC_SHA384_INPUT_BLOCK_SIZE,
+        SYMCRYPT_PARALLEL_HMAC_SHA384_FIXED_SCRATCH, SYMCRYPT_PARALLEL_HMAC_SHA384_PER_OPERATION_SCRATCH, g_parHmacSha384KatResult,
+        &SymCryptHmacSha384ExpandKey, &SymCryptHmacSha384, &SymCryptParallelHmacSha384 );
+
+    testParallelHmac<SYMCRYPT_HMAC_SHA512_EXPANDED_KEY, SYMCRYPT_PARALLEL_HMAC_SHA512_OPERATION>(
+        "HmacSha512", SYMCRYPT_HMAC_SHA512_RESULT_SIZE, SYMCRYPT_HMAC_SHA512_INPUT_BLOCK_SIZE,
+        SYMCRYPT_PARALLEL_HMAC_SHA512_FIXED_SCRATCH, SYMCRYPT_PARALLEL_HMAC_SHA512_PER_OPERATION_SCRATCH, g_parHmacSha512KatResult,
+        &SymCryptHmacSha512ExpandKey, &SymCryptHmacSha512, &SymCryptParallelHmacSha512 );
+
 }
 
@@ -449,10 +449,281 @@ testStreamCipherKats()
     }
 }
 
+#define CHACHA20_IOVEC_MAX_DATA         (1000)
+#define CHACHA20_IOVEC_MAX_FRAGMENTS    (32)
+
+VOID
+testChaCha20Iovec()
+{
+    SYMCRYPT_CHACHA20_STATE state;
+    SYMCRYPT_IOVEC          srcFragments[CHACHA20_IOVEC_MAX_FRAGMENTS];
+    SYMCRYPT_IOVEC          dstFragments[CHACHA20_IOVEC_MAX_FRAGMENTS];
+    SIZE_T                  nSrc;
+    SIZE_T                  nDst;
+    BYTE                    key[32];
+    BYTE                    nonce[12];
+    BYTE                    src[CHACHA20_IOVEC_MAX_DATA];
+    BYTE                    dst[CHACHA20_IOVEC_MAX_DATA];
+    BYTE                    ref[CHACHA20_IOVEC_MAX_DATA];
+    SIZE_T                  cbData;
+    UINT64                  offset;
+
+    if( !isAlgorithmPresent( "ChaCha20", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    ChaCha20Iovec" );
+
+    for( int iTest = 0; iTest < 1000; iTest++ )
+    {
+        GENRANDOM( key, sizeof( key ) );
+        GENRANDOM( nonce, sizeof( nonce ) );
+
+        //
+        // Random data length and key stream offset, so that the fragments are not block-aligned
+        //
+        cbData = g_rng.sizetNonUniform( CHACHA20_IOVEC_MAX_DATA + 1, 32, 1 );
+        offset = g_rng.sizet( 200 );
+        GENRANDOM( src, (ULONG) cbData );
+
+        CHECK( SymCryptChaCha20Init( &state, key, sizeof( key ), nonce, sizeof( nonce ), offset ) == SYMCRYPT_NO_ERROR, "?" );
+        SymCryptChaCha20Crypt( &state, src, ref, cbData );
+
+        SymCryptChaCha20SetOffset( &state, offset );
+        if( (g_rng.byte() & 1) != 0 )
+        {
+            memcpy( dst, src, cbData );
+            nSrc = randomIovec( dst, cbData, srcFragments, ARRAY_SIZE( srcFragments ) );
+            SymCryptChaCha20CryptIovec( &state, srcFragments, nSrc, srcFragments, nSrc );
+        } else {
+            nSrc = randomIovec( src, cbData, srcFragments, ARRAY_SIZE( srcFragments ) );
+            nDst = randomIovec( dst, cbData, dstFragments, ARRAY_SIZE( dstFragments ) );
+            SymCryptChaCha20CryptIovec( &state, srcFragments, nSrc, dstFragments, nDst );
+        }
+
+        CHECK( memcmp( dst, ref, cbData ) == 0, "ChaCha20 iovec output mismatch" );
+    }
+
+    iprint( "\n" );
+}
+
+#define KEYSTREAM_REFILL            ((SIZE_T) -1)
+#define KEYSTREAM_MAX_MESSAGES      (6)
+#define KEYSTREAM_BUFFER_MAX_DATA   (4 * SYMCRYPT_KEYSTREAM_BUFFER_SIZE)
+
+//
+// Message sequences for the key stream buffer; KEYSTREAM_REFILL is an explicit refill.
+// They cover single bytes, messages that end exactly at or just past the buffer contents,
+// long messages that find the buffer empty and bypass it, and refills with part of the
+// buffer still unused.
+//
+const SIZE_T g_keystreamSequences[][KEYSTREAM_MAX_MESSAGES] = {
+    { 1, 1, 1, 1, 1, 1 },
+    { SYMCRYPT_KEYSTREAM_BUFFER_SIZE, 1, SYMCRYPT_KEYSTREAM_BUFFER_SIZE - 1, 1 },
+    { SYMCRYPT_KEYSTREAM_BUFFER_SIZE + 1, 63, 65 },
+    { 3 * SYMCRYPT_KEYSTREAM_BUFFER_SIZE - 7, 7, SYMCRYPT_KEYSTREAM_BUFFER_SIZE },
+    { KEYSTREAM_REFILL, 100, KEYSTREAM_REFILL, 2 * SYMCRYPT_KEYSTREAM_BUFFER_SIZE },
+    { 17, KEYSTREAM_REFILL, KEYSTREAM_REFILL, 1000, 31, 500 },
+};
+
+//
+// SP 800-38A F.5.1 CTR-AES128.Encrypt, first two blocks
+//
+const BYTE g_keystreamAesKey[]      = { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+const BYTE g_keystreamAesCounter[]  = { 0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff };
+const BYTE g_keystreamAesPlain[]    = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+};
+const BYTE g_keystreamAesCipher[]   = {
+    0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+    0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+};
+
+VOID
+testKeystreamBuffer()
+{
+    SYMCRYPT_KEYSTREAM_BUFFER   ksBuf;
+    SYMCRYPT_CHACHA20_STATE     state;
+    SYMCRYPT_AES_EXPANDED_KEY   aesKey;
+    BYTE                        key[32];
+    BYTE                        nonce[12];
+    BYTE                        chain[SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                        src[KEYSTREAM_BUFFER_MAX_DATA + SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                        dst[KEYSTREAM_BUFFER_MAX_DATA];
+    BYTE                        ref[KEYSTREAM_BUFFER_MAX_DATA + SYMCRYPT_AES_BLOCK_SIZE];
+    BYTE                        refChain[SYMCRYPT_AES_BLOCK_SIZE];
+    SIZE_T                      cbData;
+    SIZE_T                      cbAes;
+    SIZE_T                      pos;
+    SIZE_T                      n;
+
+    if( !isAlgorithmPresent( "ChaCha20", FALSE ) || !isAlgorithmPresent( "Aes", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    KeystreamBuffer" );
+
+    //
+    // Known answer, as a 5-byte and a 27-byte message.
+    // The used key stream must be wiped from the buffer.
+    //
+    CHECK( SymCryptAesExpandKey( &aesKey, g_keystreamAesKey, sizeof( g_keystreamAesKey ) ) == SYMCRYPT_NO_ERROR, "?" );
+    SymCryptKeystreamBufferInitAesCtrMsb64( &ksBuf, &aesKey, g_keystreamAesCounter );
+
+    SymCryptKeystreamBufferCrypt( &ksBuf, &g_keystreamAesPlain[0], &dst[0], 5 );
+    SymCryptKeystreamBufferCrypt( &ksBuf, &g_keystreamAesPlain[5], &dst[5], sizeof( g_keystreamAesPlain ) - 5 );
+    CHECK( memcmp( dst, g_keystreamAesCipher, sizeof( g_keystreamAesCipher ) ) == 0, "Key stream buffer known answer mismatch" );
+
+    CHECK( SymCryptKeystreamBufferAvailable( &ksBuf ) == SYMCRYPT_KEYSTREAM_BUFFER_SIZE - sizeof( g_keystreamAesPlain ), "?" );
+    for( SIZE_T i = 0; i < sizeof( g_keystreamAesPlain ); i++ )
+    {
+        CHECK( ksBuf.buffer[i] == 0, "Key stream buffer did not wipe the used key stream" );
+    }
+
+    SymCryptWipeKnownSize( &ksBuf, sizeof( ksBuf ) );
+
+    //
+    // Each message sequence with both ciphers, against the mode functions.
+    // The AES counter starts just below the wrap-around of its lower 64 bits,
+    // which CtrMsb64 does not carry into the upper 64 bits.
+    //
+    GENRANDOM( key, sizeof( key ) );
+    GENRANDOM( nonce, sizeof( nonce ) );
+    GENRANDOM( chain, sizeof( chain ) );
+    SYMCRYPT_STORE_MSBFIRST64( &chain[8], (UINT64) 0 - 3 );
+    GENRANDOM( src, sizeof( src ) );
+
+    CHECK( SymCryptAesExpandKey( &aesKey, key, 16 ) == SYMCRYPT_NO_ERROR, "?" );
+
+    for( int useChaCha = 0; useChaCha < 2; useChaCha++ )
+    {
+        for( SIZE_T iSeq = 0; iSeq < ARRAY_SIZE( g_keystreamSequences ); iSeq++ )
+        {
+            cbData = 0;
+            for( SIZE_T i = 0; i < KEYSTREAM_MAX_MESSAGES; i++ )
+            {
+                if( g_keystreamSequences[iSeq][i] != KEYSTREAM_REFILL )
+                {
+                    cbData += g_keystreamSequences[iSeq][i];
+                }
+            }
+            CHECK( cbData <= KEYSTREAM_BUFFER_MAX_DATA, "?" );
+
+            if( useChaCha )
+            {
+                CHECK( SymCryptChaCha20Init( &state, key, sizeof( key ), nonce, sizeof( nonce ), 5 ) == SYMCRYPT_NO_ERROR, "?" );
+                SymCryptChaCha20Crypt( &state, src, ref, cbData );
+                CHECK( SymCryptKeystreamBufferInitChaCha20( &ksBuf, key, sizeof( key ), nonce, sizeof( nonce ), 5 ) == SYMCRYPT_NO_ERROR, "?" );
+            } else {
+                SymCryptKeystreamBufferInitAesCtrMsb64( &ksBuf, &aesKey, chain );
+
+                //
+                // Every sequence starts from the same counter value
+                //
+                memcpy( refChain, chain, sizeof( chain ) );
+                cbAes = (cbData + SYMCRYPT_AES_BLOCK_SIZE - 1) & ~(SIZE_T)(SYMCRYPT_AES_BLOCK_SIZE - 1);
+                SymCryptAesCtrMsb64( &aesKey, refChain, src, ref, cbAes );
+            }
+
+            memcpy( dst, src, cbData );
+            pos = 0;
+            for( SIZE_T i = 0; i < KEYSTREAM_MAX_MESSAGES; i++ )
+            {
+                n = g_keystreamSequences[iSeq][i];
+                if( n == KEYSTREAM_REFILL )
+                {
+                    SymCryptKeystreamBufferRefill( &ksBuf );
+                    CHECK( SymCryptKeystreamBufferAvailable( &ksBuf ) > SYMCRYPT_KEYSTREAM_BUFFER_SIZE - 64, "?" );
+                    continue;
+                }
+                SymCryptKeystreamBufferCrypt( &ksBuf, &dst[pos], &dst[pos], n );
+                pos += n;
+            }
+
+            CHECK4( memcmp( dst, ref, cbData ) == 0, "Key stream buffer output mismatch, cipher %d, sequence %d", useChaCha, (int) iSeq );
+
+            SymCryptWipeKnownSize( &ksBuf, sizeof( ksBuf ) );
+        }
+    }
+
+    iprint( "\n" );
+}
+
+#define QUIC_HP_MAX_SAMPLES     (40)
+
+VOID
+testQuicHeaderProtection()
+{
+    SYMCRYPT_AES_EXPANDED_KEY   aesKey;
+    SYMCRYPT_CHACHA20_STATE     state;
+    BYTE                        key[32];
+    BYTE                        samples[QUIC_HP_MAX_SAMPLES * SYMCRYPT_QUIC_HP_SAMPLE_SIZE];
+    BYTE                        masks[QUIC_HP_MAX_SAMPLES * SYMCRYPT_QUIC_HP_MASK_SIZE];
+    BYTE                        ref[QUIC_HP_MAX_SAMPLES * SYMCRYPT_QUIC_HP_MASK_SIZE];
+    BYTE                        block[SYMCRYPT_AES_BLOCK_SIZE];
+    SIZE_T                      nSamples;
+    SIZE_T                      i;
+
+    if( !isAlgorithmPresent( "ChaCha20", FALSE ) || !isAlgorithmPresent( "Aes", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    QuicHeaderProtection" );
+
+    for( int iTest = 0; iTest < 1000; iTest++ )
+    {
+        GENRANDOM( key, sizeof( key ) );
+        nSamples = g_rng.sizet( QUIC_HP_MAX_SAMPLES + 1 );
+        GENRANDOM( samples, (ULONG) (nSamples * SYMCRYPT_QUIC_HP_SAMPLE_SIZE) );
+
+        CHECK( SymCryptAesExpandKey( &aesKey, key, 16 + 8 * g_rng.sizet( 3 ) ) == SYMCRYPT_NO_ERROR, "?" );
+        SymCryptAesQuicHeaderProtectionMasks( &aesKey, samples, masks, nSamples );
+        for( i=0; i<nSamples; i++ )
+        {
+            SymCryptAesEncrypt( &aesKey, &samples[i * SYMCRYPT_QUIC_HP_SAMPLE_SIZE], block );
+            memcpy( &ref[i * SYMCRYPT_QUIC_HP_MASK_SIZE], block, SYMCRYPT_QUIC_HP_MASK_SIZE );
+        }
+        CHECK( memcmp( masks, ref, nSamples * SYMCRYPT_QUIC_HP_MASK_SIZE ) == 0, "AES QUIC header protection mismatch" );
+
+        //
+        // Keep the block counter small enough that the reference can set it as a stream offset
+        //
+        for( i=0; i<nSamples; i++ )
+        {
+            samples[i * SYMCRYPT_QUIC_HP_SAMPLE_SIZE + 3] &= 0x1f;
+        }
+
+        CHECK( SymCryptChaCha20QuicHeaderProtectionMasks( key, sizeof( key ), samples, masks, nSamples ) == SYMCRYPT_NO_ERROR, "?" );
+        for( i=0; i<nSamples; i++ )
+        {
+            CHECK( SymCryptChaCha20Init(    &state, key, sizeof( key ),
+                                            &samples[i * SYMCRYPT_QUIC_HP_SAMPLE_SIZE + 4], 12,
+                                            (UINT64) SYMCRYPT_LOAD_LSBFIRST32( &samples[i * SYMCRYPT_QUIC_HP_SAMPLE_SIZE] ) * 64 ) == SYMCRYPT_NO_ERROR, "?" );
+            SymCryptWipe( block, SYMCRYPT_QUIC_HP_MASK_SIZE );
+            SymCryptChaCha20Crypt( &state, block, &ref[i * SYMCRYPT_QUIC_HP_MASK_SIZE], SYMCRYPT_QUIC_HP_MASK_SIZE );
+        }
+        CHECK( memcmp( masks, ref, nSamples * SYMCRYPT_QUIC_HP_MASK_SIZE ) == 0, "ChaCha20 QUIC header protection mismatch" );
+    }
+
+    CHECK( SymCryptChaCha20QuicHeaderProtectionMasks( key, 16, samples, masks, 1 ) == SYMCRYPT_WRONG_KEY_SIZE, "?" );
+
+    iprint( "\n" );
+}
+
 VOID
 testStreamCipherAlgorithms()
 {
     testStreamCipherKats();
+
+    testChaCha20Iovec();
+
+    testKeystreamBuffer();
+
+    testQuicHeaderProtection();
 }
 
 
@@ -343,10 +343,104 @@ testXtsKats()
     }
 }
 
+#define XTS_DU_MAX_UNITS        20
+#define XTS_DU_MAX_UNIT_LEN     512
+
+VOID
+testXtsDataUnits()
+{
+    SYMCRYPT_XTS_AES_EXPANDED_KEY   key;
+    SYMCRYPT_XTS_AES_DATA_UNIT      units[XTS_DU_MAX_UNITS];
+    BYTE                            keyBuf[64];
+    BYTE                            src[XTS_DU_MAX_UNITS][XTS_DU_MAX_UNIT_LEN];
+    BYTE                            dst[XTS_DU_MAX_UNITS][XTS_DU_MAX_UNIT_LEN];
+    BYTE                            ref[XTS_DU_MAX_UNITS][XTS_DU_MAX_UNIT_LEN];
+    SIZE_T                          cbDataUnit;
+    SIZE_T                          nUnits;
+    SIZE_T                          i;
+    BOOL                            encrypt;
+
+    if( !isAlgorithmPresent( "XtsAes", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    XtsAesDataUnits" );
+
+    for( int iTest = 0; iTest < 1000; iTest++ )
+    {
+        GENRANDOM( keyBuf, sizeof( keyBuf ) );
+        CHECK( SymCryptXtsAesExpandKey( &key, keyBuf, 32 + 32 * (g_rng.byte() & 1) ) == SYMCRYPT_NO_ERROR, "XTS key expansion failed" );
+
+        cbDataUnit = SYMCRYPT_AES_BLOCK_SIZE * g_rng.sizet( 1, XTS_DU_MAX_UNIT_LEN / SYMCRYPT_AES_BLOCK_SIZE + 1 );
+        nUnits = g_rng.sizet( XTS_DU_MAX_UNITS + 1 );
+        encrypt = (g_rng.byte() & 1) != 0;
+
+        for( i=0; i<nUnits; i++ )
+        {
+            GENRANDOM( src[i], (ULONG) cbDataUnit );
+            GENRANDOM( &units[i].tweak, sizeof( units[i].tweak ) );
+            if( encrypt )
+            {
+                SymCryptXtsAesEncrypt( &key, cbDataUnit, units[i].tweak, src[i], ref[i], cbDataUnit );
+            } else {
+                SymCryptXtsAesDecrypt( &key, cbDataUnit, units[i].tweak, src[i], ref[i], cbDataUnit );
+            }
+
+            //
+            // Use in-place processing on some of the units
+            //
+            if( (g_rng.byte() & 1) != 0 )
+            {
+                memcpy( dst[i], src[i], cbDataUnit );
+                units[i].pbSrc = dst[i];
+            } else {
+                units[i].pbSrc = src[i];
+            }
+            units[i].pbDst = dst[i];
+        }
+
+        if( encrypt )
+        {
+            CHECK( SymCryptXtsAesEncryptDataUnits( &key, cbDataUnit, units, nUnits ) == SYMCRYPT_NO_ERROR, "XTS-AES data unit encryption failed" );
+        } else {
+            CHECK( SymCryptXtsAesDecryptDataUnits( &key, cbDataUnit, units, nUnits ) == SYMCRYPT_NO_ERROR, "XTS-AES data unit decryption failed" );
+        }
+
+        for( i=0; i<nUnits; i++ )
+        {
+            CHECK3( memcmp( dst[i], ref[i], cbDataUnit ) == 0, "XTS-AES data unit mismatch in unit %d", i );
+        }
+    }
+
+    //
+    // Data unit sizes that are not a non-zero multiple of the block size are rejected without writing any output.
+    //
+    static const SIZE_T badSizes[] = { 0, 8, 15, 17, 24, 100 };
+    for( i=0; i<ARRAY_SIZE( badSizes ); i++ )
+    {
+        memset( dst[0], 0x5a, XTS_DU_MAX_UNIT_LEN );
+        units[0].tweak = i;
+        units[0].pbSrc = src[0];
+        units[0].pbDst = dst[0];
+
+        CHECK3( SymCryptXtsAesEncryptDataUnits( &key, badSizes[i], units, 1 ) == SYMCRYPT_WRONG_DATA_SIZE, "XTS-AES data units accepted size %d", (int) badSizes[i] );
+        CHECK3( SymCryptXtsAesDecryptDataUnits( &key, badSizes[i], units, 1 ) == SYMCRYPT_WRONG_DATA_SIZE, "XTS-AES data units accepted size %d", (int) badSizes[i] );
+        for( SIZE_T j=0; j<XTS_DU_MAX_UNIT_LEN; j++ )
+        {
+            CHECK( dst[0][j] == 0x5a, "XTS-AES data units wrote output for a rejected size" );
+        }
+    }
+
+    iprint( "\n" );
+}
+
 VOID
 testXtsAlgorithms()
 {
     testXtsKats();
+
+    testXtsDataUnits();
 }
 
 
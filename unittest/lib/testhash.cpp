@@ -1189,6 +1189,420 @@ testParallelHash( String &sep, String algName )
 }
 
 
+#define TREE_HASH_MAX_DATA      (1 << 16)
+#define TREE_HASH_MAX_NODES     (2 * TREE_HASH_MAX_DATA + 2)
+
+//
+// Straightforward tree hash, one node at a time, to check the tree hash functions against.
+// Returns the total number of nodes.
+//
+SIZE_T
+treeHashReference(
+    _In_                        PCSYMCRYPT_TREE_HASH_PARAMS pParams,
+    _In_reads_( cbData )        PCBYTE                      pbData,
+                                SIZE_T                      cbData,
+    _Out_                       PBYTE                       pbLevels )
+{
+    SYMCRYPT_SHA256_STATE   state;
+    BOOLEAN                 prefix = (pParams->flags & SYMCRYPT_FLAG_TREE_HASH_DOMAIN_PREFIX) != 0;
+    BYTE                    b;
+    PBYTE                   pbLevel;
+    SIZE_T                  nNodes;
+    SIZE_T                  nTotal;
+    SIZE_T                  nNext;
+    SIZE_T                  cb;
+    SIZE_T                  i;
+
+    nNodes = (cbData + pParams->cbLeaf - 1) / pParams->cbLeaf;
+    nNodes = SYMCRYPT_MAX( nNodes, 1 );
+
+    for( i=0; i<nNodes; i++ )
+    {
+        cb = SYMCRYPT_MIN( pParams->cbLeaf, cbData - i * pParams->cbLeaf );
+        SymCryptSha256Init( &state );
+        if( prefix )
+        {
+            b = 0;
+            SymCryptSha256Append( &state, &b, 1 );
+        }
+        SymCryptSha256Append( &state, pbData + i * pParams->cbLeaf, cb );
+        SymCryptSha256Result( &state, pbLevels + i * SYMCRYPT_SHA256_RESULT_SIZE );
+    }
+
+    pbLevel = pbLevels;
+    nTotal = nNodes;
+    while( nNodes > 1 )
+    {
+        nNext = (nNodes + pParams->fanOut - 1) / pParams->fanOut;
+        for( i=0; i<nNext; i++ )
+        {
+            cb = SYMCRYPT_MIN( pParams->fanOut, nNodes - i * pParams->fanOut ) * SYMCRYPT_SHA256_RESULT_SIZE;
+            if( cb == SYMCRYPT_SHA256_RESULT_SIZE )
+            {
+                memcpy( pbLevels + (nTotal + i) * SYMCRYPT_SHA256_RESULT_SIZE, pbLevel + i * pParams->fanOut * SYMCRYPT_SHA256_RESULT_SIZE, cb );
+                continue;
+            }
+            SymCryptSha256Init( &state );
+            if( prefix )
+            {
+                b = 1;
+                SymCryptSha256Append( &state, &b, 1 );
+            }
+            SymCryptSha256Append( &state, pbLevel + i * pParams->fanOut * SYMCRYPT_SHA256_RESULT_SIZE, cb );
+            SymCryptSha256Result( &state, pbLevels + (nTotal + i) * SYMCRYPT_SHA256_RESULT_SIZE );
+        }
+        pbLevel = pbLevels + nTotal * SYMCRYPT_SHA256_RESULT_SIZE;
+        nTotal += nNext;
+        nNodes = nNext;
+    }
+
+    return nTotal;
+}
+
+//
+// Known answers for RFC 6962 trees (fanOut 2 with the domain prefix).
+// The root for 7 leaves of 4 bytes (data 00 01 ... 1b) follows from the RFC 6962 definition.
+// Empty data is a single empty leaf, not the RFC 6962 empty tree; its root is the
+// Certificate Transparency reference vector for a tree with one empty leaf.
+//
+const BYTE g_treeHashKat7Root[] = {
+    0x6a, 0x64, 0x8b, 0x43, 0x6a, 0x7b, 0xa0, 0x96, 0x6d, 0x61, 0xd0, 0x3e, 0x31, 0x03, 0x3b, 0x8e,
+    0x6a, 0x5d, 0x69, 0xdc, 0xbf, 0x73, 0x77, 0x7a, 0xfb, 0x50, 0x8a, 0xb1, 0xf0, 0x26, 0x0a, 0x63,
+};
+const BYTE g_treeHashKatEmptyRoot[] = {     // SHA-256( 0x00 )
+    0x6e, 0x34, 0x0b, 0x9c, 0xff, 0xb3, 0x7a, 0x98, 0x9c, 0xa5, 0x44, 0xe6, 0xbb, 0x78, 0x0a, 0x2c,
+    0x78, 0x90, 0x1d, 0x3f, 0xb3, 0x37, 0x38, 0x76, 0x85, 0x11, 0xa3, 0x06, 0x17, 0xaf, 0xa0, 0x1d,
+};
+
+typedef struct _TREE_HASH_TEST_CASE {
+    SIZE_T  cbLeaf;
+    UINT32  fanOut;
+    UINT32  flags;
+    SIZE_T  cbData;
+} TREE_HASH_TEST_CASE;
+
+#define TREE_HASH_PREFIX    SYMCRYPT_FLAG_TREE_HASH_DOMAIN_PREFIX
+
+const TREE_HASH_TEST_CASE g_treeHashTestCases[] = {
+    {   32,     2, TREE_HASH_PREFIX,       0 },     // empty data
+    {   32,     2, 0,                      1 },     // one short leaf
+    {   32,     2, TREE_HASH_PREFIX,      32 },     // one full leaf
+    {   32,     2, TREE_HASH_PREFIX,      33 },     // second leaf of 1 byte
+    {   16,     2, TREE_HASH_PREFIX, 16 * 64 },     // complete binary tree
+    {   16,     2, TREE_HASH_PREFIX, 16 * 65 },     // last leaf promoted through every level
+    {   16,     3, 0,                16 * 27 },     // complete ternary tree
+    {   16,     3, 0,           16 * 28 - 5 },     // ternary, short last leaf
+    {   64,     2, TREE_HASH_PREFIX, 64 * SYMCRYPT_SHA256_TREE_HASH_BATCH },         // one full batch of leaves
+    {   64,     2, TREE_HASH_PREFIX, 64 * SYMCRYPT_SHA256_TREE_HASH_BATCH + 1 },     // one more leaf
+    {    1,    17, TREE_HASH_PREFIX, 17 * 17 + 1 },
+    {    7, SYMCRYPT_SHA256_TREE_HASH_MAX_FANOUT, TREE_HASH_PREFIX, 1000 },         // a single interior node
+    {    1, SYMCRYPT_SHA256_TREE_HASH_MAX_FANOUT, 0, TREE_HASH_MAX_DATA },          // the largest possible node
+    { 4096,   256, TREE_HASH_PREFIX, TREE_HASH_MAX_DATA },
+};
+
+VOID
+testSha256TreeHash()
+{
+    SYMCRYPT_TREE_HASH_PARAMS       params;
+    SYMCRYPT_SHA256_TREE_HASH_STATE state;
+    BYTE                            scratch[SYMCRYPT_SHA256_TREE_HASH_SCRATCH];
+    BYTE                            kat7Data[28];
+    BYTE                            root[SYMCRYPT_SHA256_RESULT_SIZE];
+    SIZE_T                          cbData;
+    SIZE_T                          cbLevels;
+    SIZE_T                          nNodes;
+    SIZE_T                          cbDone;
+    SIZE_T                          cb;
+
+    if( !isAlgorithmPresent( "Sha256", FALSE ) )
+    {
+        return;
+    }
+
+    iprint( "    Sha256TreeHash" );
+
+    PBYTE pbData = new BYTE[ TREE_HASH_MAX_DATA ];
+    PBYTE pbRef = new BYTE[ TREE_HASH_MAX_NODES * SYMCRYPT_SHA256_RESULT_SIZE ];
+    PBYTE pbLevels = new BYTE[ TREE_HASH_MAX_NODES * SYMCRYPT_SHA256_RESULT_SIZE ];
+    CHECK( pbData != NULL && pbRef != NULL && pbLevels != NULL, "Out of memory" );
+
+    //
+    // Known answers
+    //
+    params.fanOut = 2;
+    params.flags = SYMCRYPT_FLAG_TREE_HASH_DOMAIN_PREFIX;
+
+    for( SIZE_T i = 0; i < sizeof( kat7Data ); i++ )
+    {
+        kat7Data[i] = (BYTE) i;
+    }
+    params.cbLeaf = 4;
+    cbLevels = SymCryptSha256TreeHashLevelsSize( &params, sizeof( kat7Data ) );
+    CHECK( cbLevels == 14 * SYMCRYPT_SHA256_RESULT_SIZE, "Tree hash levels size mismatch, 7 leaves" );
+    CHECK( SymCryptSha256TreeHashLevels( &params, kat7Data, sizeof( kat7Data ), pbLevels, cbLevels, scratch, sizeof( scratch ) ) == SYMCRYPT_NO_ERROR,
+            "Tree hash levels failed" );
+    CHECK( memcmp( pbLevels + cbLevels - SYMCRYPT_SHA256_RESULT_SIZE, g_treeHashKat7Root, SYMCRYPT_SHA256_RESULT_SIZE ) == 0,
+            "Tree hash known answer mismatch, 7 leaves" );
+
+    CHECK( SymCryptSha256TreeHashInit( &state, &params ) == SYMCRYPT_NO_ERROR, "Tree hash init failed" );
+    CHECK( SymCryptSha256TreeHashAppend( &state, kat7Data, sizeof( kat7Data ), scratch, sizeof( scratch ) ) == SYMCRYPT_NO_ERROR,
+            "Tree hash append failed" );
+    SymCryptSha256TreeHashResult( &state, root );
+    CHECK( memcmp( root, g_treeHashKat7Root, sizeof( root ) ) == 0, "Tree hash known answer mismatch, 7 leaves" );
+
+    CHECK( SymCryptSha256TreeHashInit( &state, &params ) == SYMCRYPT_NO_ERROR, "Tree hash init failed" );
+    SymCryptSha256TreeHashResult( &state, root );
+    CHECK( memcmp( root, g_treeHashKatEmptyRoot, sizeof( root ) ) == 0, "Tree hash known answer mismatch, empty data" );
+
+    //
+    // Edge cases of the tree shape, compared against the one-node-at-a-time reference.
+    // The incremental interface gets the data in chunks that straddle the leaf boundaries,
+    // and the root is also checked halfway through.
+    //
+    GENRANDOM( pbData, TREE_HASH_MAX_DATA );
+
+    for( SIZE_T iCase = 0; iCase < ARRAY_SIZE( g_treeHashTestCases ); iCase++ )
+    {
+        params.cbLeaf = g_treeHashTestCases[iCase].cbLeaf;
+        params.fanOut = g_treeHashTestCases[iCase].fanOut;
+        params.flags = g_treeHashTestCases[iCase].flags;
+        cbData = g_treeHashTestCases[iCase].cbData;
+
+        nNodes = treeHashReference( &params, pbData, cbData, pbRef );
+
+        cbLevels = SymCryptSha256TreeHashLevelsSize( &params, cbData );
+        CHECK3( cbLevels == nNodes * SYMCRYPT_SHA256_RESULT_SIZE, "Tree hash levels size mismatch in case %d", (int) iCase );
+
+        CHECK3( SymCryptSha256TreeHashLevels( &params, pbData, cbData, pbLevels, cbLevels - 1, scratch, sizeof( scratch ) ) == SYMCRYPT_BUFFER_TOO_SMALL,
+                "Tree hash levels accepted a short buffer in case %d", (int) iCase );
+        CHECK3( SymCryptSha256TreeHashLevels( &params, pbData, cbData, pbLevels, cbLevels, scratch, sizeof( scratch ) ) == SYMCRYPT_NO_ERROR,
+                "Tree hash levels failed in case %d", (int) iCase );
+        CHECK3( memcmp( pbLevels, pbRef, cbLevels ) == 0, "Tree hash levels mismatch in case %d", (int) iCase );
+
+        CHECK( SymCryptSha256TreeHashInit( &state, &params ) == SYMCRYPT_NO_ERROR, "Tree hash init failed" );
+        cbDone = 0;
+        while( cbDone < cbData )
+        {
+            cb = SYMCRYPT_MIN( cbData - cbDone, (cbDone & 1) == 0 ? params.cbLeaf + 1 : 3 * params.cbLeaf - 1 );
+            CHECK( SymCryptSha256TreeHashAppend( &state, pbData + cbDone, cb, scratch, sizeof( scratch ) ) == SYMCRYPT_NO_ERROR,
+                    "Tree hash append failed" );
+            cbDone += cb;
+
+            if( cbDone - cb < cbData / 2 && cbDone >= cbData / 2 && cbDone < cbData )
+            {
+                nNodes = treeHashReference( &params, pbData, cbDone, pbLevels );
+                SymCryptSha256TreeHashResult( &state, root );
+                CHECK3( memcmp( root, pbLevels + (nNodes - 1) * SYMCRYPT_SHA256_RESULT_SIZE, SYMCRYPT_SHA256_RESULT_SIZE ) == 0,
+                        "Tree hash intermediate root mismatch in case %d", (int) iCase );
+            }
+        }
+
+        SymCryptSha256TreeHashResult( &state, root );
+        CHECK3( memcmp( root, pbRef + cbLevels - SYMCRYPT_SHA256_RESULT_SIZE, SYMCRYPT_SHA256_RESULT_SIZE ) == 0,
+                "Tree hash root mismatch in case %d", (int) iCase );
+    }
+
+    //
+    // Invalid parameters
+    //
+    params.cbLeaf = 0;
+    params.fanOut = 2;
+    params.flags = 0;
+    CHECK( SymCryptSha256TreeHashInit( &state, &params ) == SYMCRYPT_INVALID_ARGUMENT, "Tree hash accepted zero leaf size" );
+    CHECK( SymCryptSha256TreeHashLevelsSize( &params, 100 ) == 0, "Tree hash levels size accepted zero leaf size" );
+
+    params.cbLeaf = 32;
+    params.fanOut = 1;
+    CHECK( SymCryptSha256TreeHashInit( &state, &params ) == SYMCRYPT_INVALID_ARGUMENT, "Tree hash accepted fan-out 1" );
+
+    params.fanOut = SYMCRYPT_SHA256_TREE_HASH_MAX_FANOUT + 1;
+    CHECK( SymCryptSha256TreeHashInit( &state, &params ) == SYMCRYPT_INVALID_ARGUMENT, "Tree hash accepted a fan-out above the maximum" );
+
+    params.fanOut = 2;
+    params.flags = 0x80;
+    CHECK( SymCryptSha256TreeHashInit( &state, &params ) == SYMCRYPT_INVALID_ARGUMENT, "Tree hash accepted an unknown flag" );
+    CHECK( SymCryptSha256TreeHashLevels( &params, pbData, 100, pbLevels, TREE_HASH_MAX_NODES * SYMCRYPT_SHA256_RESULT_SIZE, scratch, sizeof( scratch ) ) == SYMCRYPT_INVALID_ARGUMENT,
+            "Tree hash levels accepted an unknown flag" );
+
+    delete[] pbData;
+    delete[] pbRef;
+    delete[] pbLevels;
+
+    iprint( "\n" );
+}
+
+#define HASH_BATCH_N_LENGTHS    11
+#define HASH_BATCH_N_OFFSETS    3
+#define HASH_BATCH_MAX_MESSAGES (HASH_BATCH_N_LENGTHS * HASH_BATCH_N_OFFSETS)
+#define HASH_BATCH_MAX_DATA     (5 * SYMCRYPT_SHA512_INPUT_BLOCK_SIZE + 3 + HASH_BATCH_N_OFFSETS)
+
+//
+// Known answers: the hash of "abc" (RFC 1319, RFC 1320, RFC 1321, FIPS 180-2)
+//
+const BYTE g_hashBatchKatData[] = { 'a', 'b', 'c' };
+
+const BYTE g_hashBatchMd2Kat[] = {
+    0xda, 0x85, 0x3b, 0x0d, 0x3f, 0x88, 0xd9, 0x9b, 0x30, 0x28, 0x3a, 0x69, 0xe6, 0xde, 0xd6, 0xbb,
+};
+
+const BYTE g_hashBatchMd4Kat[] = {
+    0xa4, 0x48, 0x01, 0x7a, 0xaf, 0x21, 0xd8, 0x52, 0x5f, 0xc1, 0x0a, 0xe8, 0x7a, 0xa6, 0x72, 0x9d,
+};
+
+const BYTE g_hashBatchMd5Kat[] = {
+    0x90, 0x01, 0x50, 0x98, 0x3c, 0xd2, 0x4f, 0xb0, 0xd6, 0x96, 0x3f, 0x7d, 0x28, 0xe1, 0x7f, 0x72,
+};
+
+const BYTE g_hashBatchSha1Kat[] = {
+    0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e, 0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c,
+    0x9c, 0xd0, 0xd8, 0x9d,
+};
+
+const BYTE g_hashBatchSha256Kat[] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+};
+
+const BYTE g_hashBatchSha384Kat[] = {
+    0xcb, 0x00, 0x75, 0x3f, 0x45, 0xa3, 0x5e, 0x8b, 0xb5, 0xa0, 0x3d, 0x69, 0x9a, 0xc6, 0x50, 0x07,
+    0x27, 0x2c, 0x32, 0xab, 0x0e, 0xde, 0xd1, 0x63, 0x1a, 0x8b, 0x60, 0x5a, 0x43, 0xff, 0x5b, 0xed,
+    0x80, 0x86, 0x07, 0x2b, 0xa1, 0xe7, 0xcc, 0x23, 0x58, 0xba, 0xec, 0xa1, 0x34, 0xc8, 0x25, 0xa7,
+};
+
+const BYTE g_hashBatchSha512Kat[] = {
+    0xdd, 0xaf, 0x35, 0xa1, 0x93, 0x61, 0x7a, 0xba, 0xcc, 0x41, 0x73, 0x49, 0xae, 0x20, 0x41, 0x31,
+    0x12, 0xe6, 0xfa, 0x4e, 0x89, 0xa9, 0x7e, 0xa2, 0x0a, 0x9e, 0xee, 0xe6, 0x4b, 0x55, 0xd3, 0x9a,
+    0x21, 0x92, 0x99, 0x2a, 0x27, 0x4f, 0xc1, 0xa8, 0x36, 0xba, 0x3c, 0x23, 0xa3, 0xfe, 0xeb, 0xbd,
+    0x45, 0x4d, 0x44, 0x23, 0x64, 0x3c, 0xe8, 0x0e, 0x2a, 0x9a, 0xc9, 0x4f, 0xa5, 0x4c, 0xa4, 0x9f,
+};
+
+VOID
+testHashBatch()
+{
+    struct {
+        char *          name;
+        PCSYMCRYPT_HASH pHash;
+        PCBYTE          pbKat;
+    } algs[] = {
+        { "Md2",    SymCryptMd2Algorithm,       g_hashBatchMd2Kat },
+        { "Md4",    SymCryptMd4Algorithm,       g_hashBatchMd4Kat },
+        { "Md5",    SymCryptMd5Algorithm,       g_hashBatchMd5Kat },
+        { "Sha1",   SymCryptSha1Algorithm,      g_hashBatchSha1Kat },
+        { "Sha256", SymCryptSha256Algorithm,    g_hashBatchSha256Kat },
+        { "Sha384", SymCryptSha384Algorithm,    g_hashBatchSha384Kat },
+        { "Sha512", SymCryptSha512Algorithm,    g_hashBatchSha512Kat },
+    };
+    PCBYTE  apbData[HASH_BATCH_MAX_MESSAGES];
+    SIZE_T  acbData[HASH_BATCH_MAX_MESSAGES];
+    BYTE    data[HASH_BATCH_MAX_DATA];
+    BYTE    results[HASH_BATCH_MAX_MESSAGES * SYMCRYPT_HASH_MAX_RESULT_SIZE];
+    BYTE    ref[SYMCRYPT_HASH_MAX_RESULT_SIZE];
+    BYTE    scratch[SYMCRYPT_HASH_BATCH_SCRATCH + 1];
+    SIZE_T  cbLengths[HASH_BATCH_N_LENGTHS];
+    SIZE_T  nMessages;
+    SIZE_T  cbResult;
+    SIZE_T  cbBlock;
+
+    iprint( "    HashBatch" );
+
+    GENRANDOM( data, sizeof( data ) );
+
+    for( SIZE_T iAlg = 0; iAlg < ARRAY_SIZE( algs ); iAlg++ )
+    {
+        if( !isAlgorithmPresent( algs[iAlg].name, FALSE ) )
+        {
+            continue;
+        }
+
+        cbResult = SymCryptHashResultSize( algs[iAlg].pHash );
+        cbBlock = SymCryptHashInputBlockSize( algs[iAlg].pHash );
+
+        //
+        // No messages: nothing is written.
+        //
+        memset( results, 0x5a, sizeof( results ) );
+        SymCryptHashBatch( algs[iAlg].pHash, apbData, acbData, 0, results, scratch, SYMCRYPT_HASH_BATCH_SCRATCH );
+        CHECK3( results[0] == 0x5a, "%s batch hash with no messages wrote a result", algs[iAlg].name );
+
+        //
+        // A single message: the known answer.
+        //
+        apbData[0] = g_hashBatchKatData;
+        acbData[0] = sizeof( g_hashBatchKatData );
+        SymCryptHashBatch( algs[iAlg].pHash, apbData, acbData, 1, results, scratch, SYMCRYPT_HASH_BATCH_SCRATCH );
+        CHECK3( memcmp( results, algs[iAlg].pbKat, cbResult ) == 0, "%s batch hash known answer mismatch", algs[iAlg].name );
+        CHECK3( results[cbResult] == 0x5a, "%s batch hash wrote past the result", algs[iAlg].name );
+
+        //
+        // Message lengths around the block boundaries and the padding boundaries (8- and 16-byte length fields).
+        // The padding boundaries are in the second block as MD2 has 16-byte blocks.
+        //
+        cbLengths[ 0] = 0;
+        cbLengths[ 1] = 1;
+        cbLengths[ 2] = cbBlock - 1;
+        cbLengths[ 3] = cbBlock;
+        cbLengths[ 4] = cbBlock + 1;
+        cbLengths[ 5] = 2 * cbBlock - 17;
+        cbLengths[ 6] = 2 * cbBlock - 16;
+        cbLengths[ 7] = 2 * cbBlock - 9;
+        cbLengths[ 8] = 2 * cbBlock - 8;
+        cbLengths[ 9] = 2 * cbBlock;
+        cbLengths[10] = 5 * cbBlock + 3;
+
+        //
+        // Batches of equal-length messages: one lane fewer than, exactly, and one more than the lanes available.
+        //
+        for( nMessages = SYMCRYPT_HASH_BATCH_LANES - 1; nMessages <= SYMCRYPT_HASH_BATCH_LANES + 1; nMessages++ )
+        {
+            for( SIZE_T i = 0; i < nMessages; i++ )
+            {
+                apbData[i] = &data[i % HASH_BATCH_N_OFFSETS];
+                acbData[i] = cbBlock + 1;
+            }
+
+            SymCryptHashBatch( algs[iAlg].pHash, apbData, acbData, nMessages, results, scratch, SYMCRYPT_HASH_BATCH_SCRATCH );
+
+            for( SIZE_T i = 0; i < nMessages; i++ )
+            {
+                SymCryptHash( algs[iAlg].pHash, apbData[i], acbData[i], ref, cbResult );
+                CHECK5( memcmp( ref, &results[i * cbResult], cbResult ) == 0, "%s batch hash mismatch, message %d of %d",
+                        algs[iAlg].name, (int) i, (int) nMessages );
+            }
+        }
+
+        //
+        // All lengths in one call, so lanes finish at different times and pick up new messages.
+        // Adjacent messages have different lengths and start at different offsets.
+        // The scratch space is exactly the documented size, followed by a sentinel byte.
+        //
+        nMessages = 0;
+        for( SIZE_T iOffset = 0; iOffset < HASH_BATCH_N_OFFSETS; iOffset++ )
+        {
+            for( SIZE_T iLen = 0; iLen < HASH_BATCH_N_LENGTHS; iLen++ )
+            {
+                apbData[nMessages] = &data[iOffset];
+                acbData[nMessages] = cbLengths[(iLen * 4 + iOffset) % HASH_BATCH_N_LENGTHS];
+                nMessages++;
+            }
+        }
+
+        scratch[SYMCRYPT_HASH_BATCH_SCRATCH] = 0xa5;
+
+        SymCryptHashBatch( algs[iAlg].pHash, apbData, acbData, nMessages, results, scratch, SYMCRYPT_HASH_BATCH_SCRATCH );
+
+        CHECK3( scratch[SYMCRYPT_HASH_BATCH_SCRATCH] == 0xa5, "%s batch hash used too much scratch space", algs[iAlg].name );
+
+        for( SIZE_T i = 0; i < nMessages; i++ )
+        {
+            SymCryptHash( algs[iAlg].pHash, apbData[i], acbData[i], ref, cbResult );
+            CHECK5( memcmp( ref, &results[i * cbResult], cbResult ) == 0, "%s batch hash mismatch, message %d of length %d",
+                    algs[iAlg].name, (int) i, (int) acbData[i] );
+        }
+    }
+
+    iprint( "\n" );
+}
+
 VOID
 testHashAlgorithms()
 {
@@ -1201,10 +1615,15 @@ testHashAlgorithms()
     doneAnything |= testParallelHash( sep, "ParSha256" );
     doneAnything |= testParallelHash( sep, "ParSha384" );
     doneAnything |= testParallelHash( sep, "ParSha512" );
+    doneAnything |= testParallelHash( sep, "ParSha1" );
+    doneAnything |= testParallelHash( sep, "ParMd5" );
     if( doneAnything )
     {
         iprint( "\n" );
     }
+
+    testSha256TreeHash();
+    testHashBatch();
 }
 
 #if 0
@@ -197,6 +197,38 @@ testUint64Gcd()
 }
 
 
+SIZE_T
+randomIovec(
+    _In_reads_( cbData )            PBYTE           pbData,
+                                    SIZE_T          cbData,
+    _Out_writes_( maxFragments )    PSYMCRYPT_IOVEC pFragments,
+                                    SIZE_T          maxFragments )
+{
+    SIZE_T  nFragments = 0;
+    SIZE_T  offset = 0;
+    SIZE_T  cb;
+
+    CHECK( maxFragments > 0, "?" );
+
+    while( offset < cbData && nFragments < maxFragments - 1 )
+    {
+        //
+        // Mostly short fragments, with the occasional empty or long one
+        //
+        cb = g_rng.byte() < 32 ? 0 : g_rng.sizetNonUniform( cbData - offset + 1, 32, 1 );
+        pFragments[nFragments].pb = &pbData[offset];
+        pFragments[nFragments].cb = cb;
+        offset += cb;
+        nFragments++;
+    }
+
+    pFragments[nFragments].pb = &pbData[offset];
+    pFragments[nFragments].cb = cbData - offset;
+    nFragments++;
+
+    return nFragments;
+}
+
 VOID
 testUtil()
 {